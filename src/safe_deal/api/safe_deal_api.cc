@@ -0,0 +1,55 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/api/safe_deal_api.h"
+
+#include <stdint.h>
+
+#include "base/command_line.h"
+#include "base/feature_list.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "third_party/flatbuffers/src/include/flatbuffers/flatbuffers.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr char kDefaultApiUrl[] = "https://api.safe-deal.com/";
+
+constexpr char kAcceptFlatBuffersOrJson[] =
+    "application/vnd.safe-deal.v1+flatbuffers, application/json;q=0.5";
+constexpr char kAcceptJson[] = "application/json";
+
+}  // namespace
+
+GURL GetSafeDealApiUrl(std::string_view path) {
+  GURL base_url(kDefaultApiUrl);
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+  if (command_line.HasSwitch(kSafeDealApiUrlSwitch)) {
+    GURL override_url(
+        command_line.GetSwitchValueASCII(kSafeDealApiUrlSwitch));
+    if (override_url.is_valid()) {
+      base_url = override_url;
+    }
+  }
+  return base_url.Resolve(path);
+}
+
+std::string_view GetSafeDealApiAcceptHeader() {
+  return base::FeatureList::IsEnabled(features::kSafeDealBinaryApi)
+             ? kAcceptFlatBuffersOrJson
+             : kAcceptJson;
+}
+
+const api::fb::Response* GetSafeDealApiResponse(std::string_view body) {
+  const auto* data = reinterpret_cast<const uint8_t*>(body.data());
+  flatbuffers::Verifier verifier(data, body.size());
+  if (!api::fb::VerifyResponseBuffer(verifier)) {
+    return nullptr;
+  }
+  return api::fb::GetResponse(data);
+}
+
+}  // namespace safe_deal
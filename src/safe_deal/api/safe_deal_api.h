@@ -0,0 +1,38 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_API_SAFE_DEAL_API_H_
+#define SAFE_DEAL_API_SAFE_DEAL_API_H_
+
+#include <string_view>
+
+#include "safe_deal/api/safe_deal_api_generated.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+// Overrides the Safe Deal API server, e.g. to test against a local server.
+inline constexpr char kSafeDealApiUrlSwitch[] = "safe-deal-api-url";
+
+// Media type of the responses defined in safe_deal_api.fbs.
+inline constexpr char kSafeDealApiFlatBuffersMimeType[] =
+    "application/vnd.safe-deal.v1+flatbuffers";
+
+// Returns the URL of |path|, relative to the Safe Deal API root, e.g.
+// "v1/sellers:batchGet".
+GURL GetSafeDealApiUrl(std::string_view path);
+
+// Value of the Accept header of API requests: FlatBuffers, with JSON as the
+// fallback, unless SafeDealBinaryApi is disabled. Response bodies are brotli
+// or zstd encoded as negotiated by the network service, which decodes them.
+std::string_view GetSafeDealApiAcceptHeader();
+
+// Returns the response in |body|, which must outlive it, if the body is a
+// well-formed safe_deal_api.fbs response. Nothing is copied: the response
+// is read from |body| in place once its offsets are verified.
+const api::fb::Response* GetSafeDealApiResponse(std::string_view body);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_API_SAFE_DEAL_API_H_
@@ -0,0 +1,49 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/https_upgrade_service_factory.h"
+
+#include "chrome/browser/history/history_service_factory.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/keyed_service/core/service_access_type.h"
+#include "safe_deal/browser/safe_deal_memory_budget_factory.h"
+#include "safe_deal/https_upgrade/browser/https_upgrade_service.h"
+
+namespace safe_deal {
+
+// static
+HttpsUpgradeService* HttpsUpgradeServiceFactory::GetForProfile(
+    Profile* profile) {
+  return static_cast<HttpsUpgradeService*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+}
+
+// static
+HttpsUpgradeServiceFactory* HttpsUpgradeServiceFactory::GetInstance() {
+  static base::NoDestructor<HttpsUpgradeServiceFactory> instance;
+  return instance.get();
+}
+
+HttpsUpgradeServiceFactory::HttpsUpgradeServiceFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealHttpsUpgradeService",
+          ProfileSelections::BuildRedirectedInIncognito()) {
+  DependsOn(HistoryServiceFactory::GetInstance());
+  DependsOn(SafeDealMemoryBudgetFactory::GetInstance());
+}
+
+HttpsUpgradeServiceFactory::~HttpsUpgradeServiceFactory() = default;
+
+std::unique_ptr<KeyedService>
+HttpsUpgradeServiceFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  Profile* profile = Profile::FromBrowserContext(context);
+  return std::make_unique<HttpsUpgradeService>(
+      HttpsUpgradeService::GetDefaultPreloadPath(), context->GetPath(),
+      SafeDealMemoryBudgetFactory::GetForProfile(profile),
+      HistoryServiceFactory::GetForProfile(
+          profile, ServiceAccessType::EXPLICIT_ACCESS));
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,44 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_HTTPS_UPGRADE_SERVICE_FACTORY_H_
+#define SAFE_DEAL_BROWSER_HTTPS_UPGRADE_SERVICE_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace safe_deal {
+
+class HttpsUpgradeService;
+
+// Creates the HttpsUpgradeService of regular profiles, which deletes its
+// learned decisions with the profile's history. Incognito profiles share it,
+// but SafeDealHttpsUpgradeThrottle does not learn from their navigations.
+class HttpsUpgradeServiceFactory : public ProfileKeyedServiceFactory {
+ public:
+  static HttpsUpgradeService* GetForProfile(Profile* profile);
+  static HttpsUpgradeServiceFactory* GetInstance();
+
+  HttpsUpgradeServiceFactory(const HttpsUpgradeServiceFactory&) = delete;
+  HttpsUpgradeServiceFactory& operator=(const HttpsUpgradeServiceFactory&) =
+      delete;
+
+ private:
+  friend base::NoDestructor<HttpsUpgradeServiceFactory>;
+
+  HttpsUpgradeServiceFactory();
+  ~HttpsUpgradeServiceFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_HTTPS_UPGRADE_SERVICE_FACTORY_H_
@@ -0,0 +1,39 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/price_history_service_factory.h"
+
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/browser_context.h"
+#include "safe_deal/price_history/price_history_service.h"
+
+namespace safe_deal {
+
+// static
+PriceHistoryService* PriceHistoryServiceFactory::GetForProfile(
+    Profile* profile) {
+  return static_cast<PriceHistoryService*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+}
+
+// static
+PriceHistoryServiceFactory* PriceHistoryServiceFactory::GetInstance() {
+  static base::NoDestructor<PriceHistoryServiceFactory> instance;
+  return instance.get();
+}
+
+PriceHistoryServiceFactory::PriceHistoryServiceFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealPriceHistoryService",
+          ProfileSelections::BuildForRegularProfile()) {}
+
+PriceHistoryServiceFactory::~PriceHistoryServiceFactory() = default;
+
+std::unique_ptr<KeyedService>
+PriceHistoryServiceFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  return std::make_unique<PriceHistoryService>(context->GetPath());
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,43 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_PRICE_HISTORY_SERVICE_FACTORY_H_
+#define SAFE_DEAL_BROWSER_PRICE_HISTORY_SERVICE_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace safe_deal {
+
+class PriceHistoryService;
+
+// Creates the PriceHistoryService of regular profiles. Incognito profiles do
+// not record price history.
+class PriceHistoryServiceFactory : public ProfileKeyedServiceFactory {
+ public:
+  static PriceHistoryService* GetForProfile(Profile* profile);
+  static PriceHistoryServiceFactory* GetInstance();
+
+  PriceHistoryServiceFactory(const PriceHistoryServiceFactory&) = delete;
+  PriceHistoryServiceFactory& operator=(const PriceHistoryServiceFactory&) =
+      delete;
+
+ private:
+  friend base::NoDestructor<PriceHistoryServiceFactory>;
+
+  PriceHistoryServiceFactory();
+  ~PriceHistoryServiceFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_PRICE_HISTORY_SERVICE_FACTORY_H_
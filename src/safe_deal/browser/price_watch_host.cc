@@ -0,0 +1,93 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/price_watch_host.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/render_frame_host.h"
+#include "safe_deal/browser/price_watch_scheduler_factory.h"
+#include "safe_deal/browser/safe_deal_component_extension.h"
+
+namespace safe_deal {
+
+namespace {
+
+bool IsValidListing(mojom::Marketplace marketplace,
+                    const std::string& product_id) {
+  return marketplace != mojom::Marketplace::kUnknown && !product_id.empty() &&
+         product_id.size() <= mojom::kMaxWatchedProductIdLength;
+}
+
+}  // namespace
+
+DOCUMENT_USER_DATA_KEY_IMPL(PriceWatchHost);
+
+PriceWatchHost::PriceWatchHost(content::RenderFrameHost* render_frame_host,
+                               PriceWatchScheduler* scheduler)
+    : DocumentUserData(render_frame_host), scheduler_(scheduler) {}
+
+PriceWatchHost::~PriceWatchHost() = default;
+
+// static
+void PriceWatchHost::BindReceiver(
+    content::RenderFrameHost* render_frame_host,
+    mojo::PendingReceiver<mojom::PriceWatchHost> receiver) {
+  if (!IsSafeDealExtensionDocument(render_frame_host)) {
+    return;
+  }
+  PriceWatchScheduler* scheduler = PriceWatchSchedulerFactory::GetForProfile(
+      Profile::FromBrowserContext(render_frame_host->GetBrowserContext()));
+  if (!scheduler) {
+    return;
+  }
+  PriceWatchHost* host =
+      GetOrCreateForCurrentDocument(render_frame_host, scheduler);
+  host->receiver_.reset();
+  host->receiver_.Bind(std::move(receiver));
+}
+
+void PriceWatchHost::Watch(mojom::Marketplace marketplace,
+                           const std::string& product_id,
+                           int64_t known_price_micros,
+                           base::Time last_check) {
+  if (!IsValidListing(marketplace, product_id) || known_price_micros < -1) {
+    receiver_.ReportBadMessage("Invalid watched listing");
+    return;
+  }
+  // A check in the future would never be due.
+  scheduler_->Watch(marketplace, product_id, known_price_micros,
+                    std::min(last_check, base::Time::Now()));
+}
+
+void PriceWatchHost::Unwatch(mojom::Marketplace marketplace,
+                             const std::string& product_id) {
+  if (!IsValidListing(marketplace, product_id)) {
+    receiver_.ReportBadMessage("Invalid watched listing");
+    return;
+  }
+  scheduler_->Unwatch(marketplace, product_id);
+}
+
+void PriceWatchHost::AddObserver(
+    mojo::PendingRemote<mojom::PriceWatchObserver> observer) {
+  observers_.Add(std::move(observer));
+  if (!scheduler_observation_.IsObserving()) {
+    scheduler_observation_.Observe(scheduler_.get());
+  }
+}
+
+void PriceWatchHost::OnPriceChanged(mojom::Marketplace marketplace,
+                                    const std::string& product_id,
+                                    int64_t old_price_micros,
+                                    int64_t new_price_micros) {
+  for (const auto& observer : observers_) {
+    observer->OnPriceChanged(marketplace, product_id, old_price_micros,
+                             new_price_micros);
+  }
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,82 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_PRICE_WATCH_HOST_H_
+#define SAFE_DEAL_BROWSER_PRICE_WATCH_HOST_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/memory/raw_ptr.h"
+#include "base/scoped_observation.h"
+#include "base/time/time.h"
+#include "content/public/browser/document_user_data.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/receiver.h"
+#include "mojo/public/cpp/bindings/remote_set.h"
+#include "safe_deal/common/price_watch.mojom.h"
+#include "safe_deal/price_watch/price_watch_scheduler.h"
+
+namespace content {
+class RenderFrameHost;
+}  // namespace content
+
+namespace safe_deal {
+
+// Browser side of the safeDealPriceWatch global of the Safe Deal extension's
+// pages (see PriceWatchBindings), through which the shopping assistant puts
+// its watchlist in the profile's PriceWatchScheduler and hears about price
+// changes for as long as the page is open.
+class PriceWatchHost : public content::DocumentUserData<PriceWatchHost>,
+                       public mojom::PriceWatchHost,
+                       public PriceWatchScheduler::Observer {
+ public:
+  PriceWatchHost(const PriceWatchHost&) = delete;
+  PriceWatchHost& operator=(const PriceWatchHost&) = delete;
+  ~PriceWatchHost() override;
+
+  // Binds |receiver| for the current document of |render_frame_host|.
+  // Requests from documents of anything but the Safe Deal component
+  // extension, and from profiles without price checks, are dropped.
+  static void BindReceiver(
+      content::RenderFrameHost* render_frame_host,
+      mojo::PendingReceiver<mojom::PriceWatchHost> receiver);
+
+  // mojom::PriceWatchHost:
+  void Watch(mojom::Marketplace marketplace,
+             const std::string& product_id,
+             int64_t known_price_micros,
+             base::Time last_check) override;
+  void Unwatch(mojom::Marketplace marketplace,
+               const std::string& product_id) override;
+  void AddObserver(
+      mojo::PendingRemote<mojom::PriceWatchObserver> observer) override;
+
+  // PriceWatchScheduler::Observer:
+  void OnPriceChanged(mojom::Marketplace marketplace,
+                      const std::string& product_id,
+                      int64_t old_price_micros,
+                      int64_t new_price_micros) override;
+
+ private:
+  friend DocumentUserData;
+  DOCUMENT_USER_DATA_KEY_DECL();
+
+  PriceWatchHost(content::RenderFrameHost* render_frame_host,
+                 PriceWatchScheduler* scheduler);
+
+  // The scheduler is a service of the document's profile, which outlives
+  // the document.
+  const raw_ptr<PriceWatchScheduler> scheduler_;
+  mojo::Receiver<mojom::PriceWatchHost> receiver_{this};
+  mojo::RemoteSet<mojom::PriceWatchObserver> observers_;
+  base::ScopedObservation<PriceWatchScheduler, PriceWatchScheduler::Observer>
+      scheduler_observation_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_PRICE_WATCH_HOST_H_
@@ -0,0 +1,52 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/price_watch_scheduler_factory.h"
+
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/storage_partition.h"
+#include "safe_deal/browser/price_history_service_factory.h"
+#include "safe_deal/browser/string_interner_factory.h"
+#include "safe_deal/price_watch/price_watch_api_fetcher.h"
+#include "safe_deal/price_watch/price_watch_scheduler.h"
+
+namespace safe_deal {
+
+// static
+PriceWatchScheduler* PriceWatchSchedulerFactory::GetForProfile(
+    Profile* profile) {
+  return static_cast<PriceWatchScheduler*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+}
+
+// static
+PriceWatchSchedulerFactory* PriceWatchSchedulerFactory::GetInstance() {
+  static base::NoDestructor<PriceWatchSchedulerFactory> instance;
+  return instance.get();
+}
+
+PriceWatchSchedulerFactory::PriceWatchSchedulerFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealPriceWatchScheduler",
+          ProfileSelections::BuildForRegularProfile()) {
+  DependsOn(PriceHistoryServiceFactory::GetInstance());
+  DependsOn(StringInternerFactory::GetInstance());
+}
+
+PriceWatchSchedulerFactory::~PriceWatchSchedulerFactory() = default;
+
+std::unique_ptr<KeyedService>
+PriceWatchSchedulerFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  Profile* profile = Profile::FromBrowserContext(context);
+  return std::make_unique<PriceWatchScheduler>(
+      std::make_unique<PriceWatchApiFetcher>(
+          context->GetDefaultStoragePartition()
+              ->GetURLLoaderFactoryForBrowserProcess()),
+      PriceHistoryServiceFactory::GetForProfile(profile),
+      StringInternerFactory::GetForProfile(profile));
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,44 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_PRICE_WATCH_SCHEDULER_FACTORY_H_
+#define SAFE_DEAL_BROWSER_PRICE_WATCH_SCHEDULER_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace safe_deal {
+
+class PriceWatchScheduler;
+
+// Creates the PriceWatchScheduler of regular profiles, which records the
+// prices it finds in the profile's PriceHistoryService. Incognito profiles
+// have no watchlist.
+class PriceWatchSchedulerFactory : public ProfileKeyedServiceFactory {
+ public:
+  static PriceWatchScheduler* GetForProfile(Profile* profile);
+  static PriceWatchSchedulerFactory* GetInstance();
+
+  PriceWatchSchedulerFactory(const PriceWatchSchedulerFactory&) = delete;
+  PriceWatchSchedulerFactory& operator=(const PriceWatchSchedulerFactory&) =
+      delete;
+
+ private:
+  friend base::NoDestructor<PriceWatchSchedulerFactory>;
+
+  PriceWatchSchedulerFactory();
+  ~PriceWatchSchedulerFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_PRICE_WATCH_SCHEDULER_FACTORY_H_
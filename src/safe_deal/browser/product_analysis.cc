@@ -0,0 +1,122 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/product_analysis.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "base/check.h"
+#include "base/feature_list.h"
+#include "base/functional/bind.h"
+#include "base/time/time.h"
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/render_frame_host.h"
+#include "content/public/browser/web_contents.h"
+#include "safe_deal/browser/price_history_service_factory.h"
+#include "safe_deal/browser/product_matching_service_factory.h"
+#include "safe_deal/browser/safe_deal_pipeline.h"
+#include "safe_deal/browser/seller_reputation_cache_factory.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/page_extractor/common/page_extractor.mojom.h"
+#include "safe_deal/price_history/price_history_service.h"
+#include "safe_deal/product_matching/product_matching_service.h"
+#include "safe_deal/seller_reputation/browser/seller_reputation_cache.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Covers the sales cycles marketplaces inflate list prices around.
+constexpr base::TimeDelta kRecentPriceWindow = base::Days(90);
+
+constexpr size_t kMaxMatches = 5;
+
+// Results of the lookups, merged on the tab's sequence as they come in.
+struct Lookups {
+  std::optional<SellerReputation> seller_reputation;
+  std::vector<PricePoint> price_history;
+  std::vector<ProductMatch> matches;
+};
+
+ProductAnalysis Summarize(const std::string& currency_code, Lookups lookups) {
+  ProductAnalysis analysis;
+  analysis.seller_reputation = lookups.seller_reputation;
+  if (!lookups.price_history.empty()) {
+    auto [lowest, highest] = std::ranges::minmax(lookups.price_history, {},
+                                                 &PricePoint::price_micros);
+    analysis.lowest_recent_price_micros = lowest.price_micros;
+    analysis.highest_recent_price_micros = highest.price_micros;
+  }
+  for (const ProductMatch& match : lookups.matches) {
+    if (match.price_micros < 0 || currency_code.empty() ||
+        match.currency_code != currency_code) {
+      continue;
+    }
+    if (!analysis.cheapest_match ||
+        match.price_micros < analysis.cheapest_match->price_micros) {
+      analysis.cheapest_match = match;
+    }
+  }
+  analysis.matches = std::move(lookups.matches);
+  return analysis;
+}
+
+}  // namespace
+
+ProductAnalysis::ProductAnalysis() = default;
+ProductAnalysis::ProductAnalysis(ProductAnalysis&&) = default;
+ProductAnalysis& ProductAnalysis::operator=(ProductAnalysis&&) = default;
+ProductAnalysis::~ProductAnalysis() = default;
+
+void AnalyzeProduct(content::RenderFrameHost* render_frame_host,
+                    const mojom::ProductData& product,
+                    ProductAnalysisCallback callback) {
+  DCHECK(render_frame_host->IsInPrimaryMainFrame());
+  Profile* profile =
+      Profile::FromBrowserContext(render_frame_host->GetBrowserContext());
+  SafeDealPipeline<Lookups> pipeline(
+      content::WebContents::FromRenderFrameHost(render_frame_host),
+      "ProductAnalysis");
+
+  SellerReputationCache* seller_reputation_cache =
+      SellerReputationCacheFactory::GetForProfile(profile);
+  if (seller_reputation_cache && !product.seller_id.empty()) {
+    seller_reputation_cache->GetReputation(
+        product.marketplace, product.seller_id,
+        pipeline.AddStage(base::BindOnce(
+            [](Lookups& lookups, std::optional<SellerReputation> reputation) {
+              lookups.seller_reputation = reputation;
+            })));
+  }
+  PriceHistoryService* price_history =
+      PriceHistoryServiceFactory::GetForProfile(profile);
+  if (price_history && !product.product_id.empty()) {
+    price_history->GetPriceHistoryOnStoreSequence(
+        product.marketplace, product.product_id,
+        base::Time::Now() - kRecentPriceWindow,
+        pipeline.AddStage(base::BindOnce(
+            [](Lookups& lookups, std::vector<PricePoint> points) {
+              lookups.price_history = std::move(points);
+            })));
+  }
+  ProductMatchingService* product_matching =
+      base::FeatureList::IsEnabled(features::kSafeDealProductMatching)
+          ? ProductMatchingServiceFactory::GetForProfile(profile)
+          : nullptr;
+  if (product_matching && !product.title.empty()) {
+    product_matching->FindMatchesOnStoreSequence(
+        product.marketplace, product.title, kMaxMatches,
+        pipeline.AddStage(base::BindOnce(
+            [](Lookups& lookups, std::vector<ProductMatch> matches) {
+              lookups.matches = std::move(matches);
+            })));
+  }
+
+  std::move(pipeline).Then(base::BindOnce(&Summarize, product.currency_code),
+                           std::move(callback));
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,57 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_PRODUCT_ANALYSIS_H_
+#define SAFE_DEAL_BROWSER_PRODUCT_ANALYSIS_H_
+
+#include <stdint.h>
+
+#include <optional>
+#include <vector>
+
+#include "base/functional/callback.h"
+#include "safe_deal/page_extractor/common/page_extractor.mojom-forward.h"
+#include "safe_deal/product_matching/product_matching_store.h"
+#include "safe_deal/seller_reputation/common/seller_reputation.h"
+
+namespace content {
+class RenderFrameHost;
+}  // namespace content
+
+namespace safe_deal {
+
+// What the profile's Safe Deal services know about one listing.
+struct ProductAnalysis {
+  ProductAnalysis();
+  ProductAnalysis(ProductAnalysis&&);
+  ProductAnalysis& operator=(ProductAnalysis&&);
+  ~ProductAnalysis();
+
+  // nullopt if the listing has no seller or it could not be looked up.
+  std::optional<SellerReputation> seller_reputation;
+  // Lowest and highest price in the listing's recent price history, or -1
+  // if it has none.
+  int64_t lowest_recent_price_micros = -1;
+  int64_t highest_recent_price_micros = -1;
+  // Listings of the same item on the other marketplaces, most similar first.
+  std::vector<ProductMatch> matches;
+  // The cheapest of |matches| priced in the listing's currency.
+  std::optional<ProductMatch> cheapest_match;
+};
+
+using ProductAnalysisCallback = base::OnceCallback<void(ProductAnalysis)>;
+
+// Looks up the seller's reputation, the listing's price history and the
+// listings of the same item on the other marketplaces concurrently, as one
+// SafeDealPipeline of the tab. |callback| runs on the UI thread once every
+// lookup is in, unless the tab navigates or closes first. Lookups of
+// services the profile does not have are skipped. |render_frame_host| must
+// be the primary main frame.
+void AnalyzeProduct(content::RenderFrameHost* render_frame_host,
+                    const mojom::ProductData& product,
+                    ProductAnalysisCallback callback);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_PRODUCT_ANALYSIS_H_
@@ -0,0 +1,37 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/product_cache_factory.h"
+
+#include "chrome/browser/profiles/profile.h"
+#include "safe_deal/product_cache/browser/product_cache.h"
+
+namespace safe_deal {
+
+// static
+ProductCache* ProductCacheFactory::GetForProfile(Profile* profile) {
+  return static_cast<ProductCache*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+}
+
+// static
+ProductCacheFactory* ProductCacheFactory::GetInstance() {
+  static base::NoDestructor<ProductCacheFactory> instance;
+  return instance.get();
+}
+
+ProductCacheFactory::ProductCacheFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealProductCache",
+          ProfileSelections::BuildForRegularAndIncognito()) {}
+
+ProductCacheFactory::~ProductCacheFactory() = default;
+
+std::unique_ptr<KeyedService>
+ProductCacheFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  return std::make_unique<ProductCache>();
+}
+
+}  // namespace safe_deal
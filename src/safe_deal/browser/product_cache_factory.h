@@ -0,0 +1,43 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_PRODUCT_CACHE_FACTORY_H_
+#define SAFE_DEAL_BROWSER_PRODUCT_CACHE_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace safe_deal {
+
+class ProductCache;
+
+// Creates the ProductCache of regular and incognito profiles. Each incognito
+// profile gets its own cache so listings seen in it do not show up in the
+// regular profile's renderers.
+class ProductCacheFactory : public ProfileKeyedServiceFactory {
+ public:
+  static ProductCache* GetForProfile(Profile* profile);
+  static ProductCacheFactory* GetInstance();
+
+  ProductCacheFactory(const ProductCacheFactory&) = delete;
+  ProductCacheFactory& operator=(const ProductCacheFactory&) = delete;
+
+ private:
+  friend base::NoDestructor<ProductCacheFactory>;
+
+  ProductCacheFactory();
+  ~ProductCacheFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_PRODUCT_CACHE_FACTORY_H_
@@ -0,0 +1,39 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/product_matching_service_factory.h"
+
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/browser_context.h"
+#include "safe_deal/product_matching/product_matching_service.h"
+
+namespace safe_deal {
+
+// static
+ProductMatchingService* ProductMatchingServiceFactory::GetForProfile(
+    Profile* profile) {
+  return static_cast<ProductMatchingService*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+}
+
+// static
+ProductMatchingServiceFactory* ProductMatchingServiceFactory::GetInstance() {
+  static base::NoDestructor<ProductMatchingServiceFactory> instance;
+  return instance.get();
+}
+
+ProductMatchingServiceFactory::ProductMatchingServiceFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealProductMatchingService",
+          ProfileSelections::BuildForRegularProfile()) {}
+
+ProductMatchingServiceFactory::~ProductMatchingServiceFactory() = default;
+
+std::unique_ptr<KeyedService>
+ProductMatchingServiceFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  return std::make_unique<ProductMatchingService>(context->GetPath());
+}
+
+}  // namespace safe_deal
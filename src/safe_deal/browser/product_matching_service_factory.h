@@ -0,0 +1,44 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_PRODUCT_MATCHING_SERVICE_FACTORY_H_
+#define SAFE_DEAL_BROWSER_PRODUCT_MATCHING_SERVICE_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace safe_deal {
+
+class ProductMatchingService;
+
+// Creates the ProductMatchingService of regular profiles. Incognito profiles
+// do not index the listings they visit.
+class ProductMatchingServiceFactory : public ProfileKeyedServiceFactory {
+ public:
+  static ProductMatchingService* GetForProfile(Profile* profile);
+  static ProductMatchingServiceFactory* GetInstance();
+
+  ProductMatchingServiceFactory(const ProductMatchingServiceFactory&) =
+      delete;
+  ProductMatchingServiceFactory& operator=(
+      const ProductMatchingServiceFactory&) = delete;
+
+ private:
+  friend base::NoDestructor<ProductMatchingServiceFactory>;
+
+  ProductMatchingServiceFactory();
+  ~ProductMatchingServiceFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_PRODUCT_MATCHING_SERVICE_FACTORY_H_
@@ -0,0 +1,143 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/review_verdict_tab_helper.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/feature_list.h"
+#include "base/functional/bind.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/strings/escape.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/render_frame_host.h"
+#include "content/public/browser/storage_partition.h"
+#include "content/public/browser/visibility.h"
+#include "content/public/browser/web_contents.h"
+#include "safe_deal/browser/product_cache_factory.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/page_extractor/common/page_extractor.mojom.h"
+#include "safe_deal/product_cache/browser/product_cache.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom-shared.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Review pages scored per listing. Marketplaces sort the most helpful
+// reviews first, and those are the ones shoppers read.
+constexpr size_t kMaxReviewPages = 5;
+
+constexpr size_t kAmazonReviewsPerPage = 10;
+
+// Returns the review pages of the listing, best first. Only Amazon serves its
+// reviews as pages of a listing; eBay's are per catalog product rather than
+// per listing, and AliExpress loads them from an API.
+std::vector<GURL> GetReviewPageUrls(const GURL& product_url,
+                                    const mojom::ProductData& product) {
+  std::vector<GURL> urls;
+  if (product.marketplace != mojom::Marketplace::kAmazon ||
+      product.product_id.empty() || !product.review_count) {
+    return urls;
+  }
+  size_t page_count =
+      std::min<size_t>(kMaxReviewPages, (product.review_count +
+                                         kAmazonReviewsPerPage - 1) /
+                                            kAmazonReviewsPerPage);
+  std::string path =
+      base::StrCat({"/product-reviews/",
+                    base::EscapeAllExceptUnreserved(product.product_id),
+                    "?pageNumber="});
+  for (size_t page = 1; page <= page_count; ++page) {
+    urls.push_back(
+        product_url.Resolve(base::StrCat({path, base::NumberToString(page)})));
+  }
+  return urls;
+}
+
+}  // namespace
+
+// static
+void ReviewVerdictTabHelper::MaybeScoreReviews(
+    content::RenderFrameHost* render_frame_host,
+    const mojom::ProductData& product) {
+  if (!base::FeatureList::IsEnabled(features::kSafeDealReviewVerdicts) ||
+      !render_frame_host->IsInPrimaryMainFrame()) {
+    return;
+  }
+  content::WebContents* web_contents =
+      content::WebContents::FromRenderFrameHost(render_frame_host);
+  CreateForWebContents(web_contents);
+  FromWebContents(web_contents)
+      ->ScoreReviews(render_frame_host->GetLastCommittedURL(), product);
+}
+
+ReviewVerdictTabHelper::ReviewVerdictTabHelper(
+    content::WebContents* web_contents)
+    : content::WebContentsObserver(web_contents),
+      content::WebContentsUserData<ReviewVerdictTabHelper>(*web_contents) {}
+
+ReviewVerdictTabHelper::~ReviewVerdictTabHelper() = default;
+
+void ReviewVerdictTabHelper::PrimaryPageChanged(content::Page& page) {
+  pipeline_.reset();
+  marketplace_ = mojom::Marketplace::kUnknown;
+  product_id_.clear();
+}
+
+void ReviewVerdictTabHelper::ScoreReviews(const GURL& product_url,
+                                          const mojom::ProductData& product) {
+  // Pages that update the listing in place report it again.
+  if (product.marketplace == marketplace_ &&
+      product.product_id == product_id_) {
+    return;
+  }
+  pipeline_.reset();
+  marketplace_ = product.marketplace;
+  product_id_ = product.product_id;
+  std::vector<GURL> page_urls = GetReviewPageUrls(product_url, product);
+  if (page_urls.empty()) {
+    return;
+  }
+  mojom::ReviewPriority priority =
+      web_contents()->GetVisibility() == content::Visibility::VISIBLE
+          ? mojom::ReviewPriority::kForeground
+          : mojom::ReviewPriority::kBackground;
+  pipeline_ = std::make_unique<ReviewPagePipeline>(
+      web_contents()
+          ->GetBrowserContext()
+          ->GetDefaultStoragePartition()
+          ->GetURLLoaderFactoryForBrowserProcess(),
+      marketplace_, priority, std::move(page_urls),
+      base::BindRepeating(&ReviewVerdictTabHelper::OnVerdictUpdated,
+                          base::Unretained(this)));
+}
+
+void ReviewVerdictTabHelper::OnVerdictUpdated(
+    const ReviewPagePipeline::Verdict& verdict) {
+  if (verdict.model_missing) {
+    pipeline_.reset();
+    return;
+  }
+  if (ProductCache* product_cache = ProductCacheFactory::GetForProfile(
+          Profile::FromBrowserContext(web_contents()->GetBrowserContext()))) {
+    product_cache->SetReviewVerdict(
+        marketplace_, product_id_,
+        base::saturated_cast<uint16_t>(verdict.reviews_scored),
+        base::saturated_cast<uint16_t>(verdict.likely_fake),
+        verdict.complete());
+  }
+  if (verdict.complete()) {
+    pipeline_.reset();
+  }
+}
+
+WEB_CONTENTS_USER_DATA_KEY_IMPL(ReviewVerdictTabHelper);
+
+}  // namespace safe_deal
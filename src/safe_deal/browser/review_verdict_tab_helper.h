@@ -0,0 +1,64 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_REVIEW_VERDICT_TAB_HELPER_H_
+#define SAFE_DEAL_BROWSER_REVIEW_VERDICT_TAB_HELPER_H_
+
+#include <memory>
+#include <string>
+
+#include "content/public/browser/web_contents_observer.h"
+#include "content/public/browser/web_contents_user_data.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/page_extractor/common/page_extractor.mojom-forward.h"
+#include "safe_deal/review_scorer/browser/review_page_pipeline.h"
+
+namespace content {
+class Page;
+class RenderFrameHost;
+}  // namespace content
+
+namespace safe_deal {
+
+// Scores the reviews of the listing shown in a tab and publishes the running
+// verdict in the profile's ProductCache, where content scripts read it
+// through safeDealProducts and can show it before the last review page has
+// downloaded. Leaving the page cancels scoring.
+class ReviewVerdictTabHelper
+    : public content::WebContentsObserver,
+      public content::WebContentsUserData<ReviewVerdictTabHelper> {
+ public:
+  // Starts scoring the reviews of |product|, extracted from
+  // |render_frame_host|, unless features::kSafeDealReviewVerdicts is
+  // disabled, the frame is not a primary main frame or the tab already
+  // scores the listing.
+  static void MaybeScoreReviews(content::RenderFrameHost* render_frame_host,
+                                const mojom::ProductData& product);
+
+  ReviewVerdictTabHelper(const ReviewVerdictTabHelper&) = delete;
+  ReviewVerdictTabHelper& operator=(const ReviewVerdictTabHelper&) = delete;
+  ~ReviewVerdictTabHelper() override;
+
+  // content::WebContentsObserver:
+  void PrimaryPageChanged(content::Page& page) override;
+
+ private:
+  friend class content::WebContentsUserData<ReviewVerdictTabHelper>;
+
+  explicit ReviewVerdictTabHelper(content::WebContents* web_contents);
+
+  void ScoreReviews(const GURL& product_url, const mojom::ProductData& product);
+  void OnVerdictUpdated(const ReviewPagePipeline::Verdict& verdict);
+
+  // The listing being scored, or last scored, on the current page.
+  mojom::Marketplace marketplace_ = mojom::Marketplace::kUnknown;
+  std::string product_id_;
+  std::unique_ptr<ReviewPagePipeline> pipeline_;
+
+  WEB_CONTENTS_USER_DATA_KEY_DECL();
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_REVIEW_VERDICT_TAB_HELPER_H_
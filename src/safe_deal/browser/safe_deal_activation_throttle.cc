@@ -0,0 +1,119 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_activation_throttle.h"
+
+#include <memory>
+
+#include "base/feature_list.h"
+#include "base/functional/bind.h"
+#include "base/metrics/histogram_functions.h"
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/navigation_handle.h"
+#include "content/public/browser/navigation_throttle_registry.h"
+#include "content/public/browser/web_contents.h"
+#include "safe_deal/browser/safe_deal_extension_activator.h"
+#include "safe_deal/browser/safe_deal_extension_activator_factory.h"
+#include "safe_deal/common/marketplace_origin_matcher.h"
+#include "safe_deal/common/safe_deal_features.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Loading the scripts from resources.pak takes a few milliseconds; this only
+// bounds the delay if something goes wrong.
+constexpr base::TimeDelta kMaxResponseDeferral = base::Milliseconds(500);
+
+}  // namespace
+
+// static
+void SafeDealActivationThrottle::MaybeCreateAndAdd(
+    content::NavigationThrottleRegistry& registry) {
+  if (!base::FeatureList::IsEnabled(features::kSafeDealExtension) ||
+      !base::FeatureList::IsEnabled(features::kSafeDealLazyActivation)) {
+    return;
+  }
+  content::NavigationHandle& handle = registry.GetNavigationHandle();
+  if (!handle.IsInPrimaryMainFrame()) {
+    return;
+  }
+  SafeDealExtensionActivator* activator =
+      SafeDealExtensionActivatorFactory::GetForProfile(
+          Profile::FromBrowserContext(
+              handle.GetWebContents()->GetBrowserContext()));
+  if (!activator || activator->scripts_ready()) {
+    return;
+  }
+  registry.AddThrottle(
+      std::make_unique<SafeDealActivationThrottle>(registry, activator));
+}
+
+SafeDealActivationThrottle::SafeDealActivationThrottle(
+    content::NavigationThrottleRegistry& registry,
+    SafeDealExtensionActivator* activator)
+    : content::NavigationThrottle(registry), activator_(activator) {}
+
+SafeDealActivationThrottle::~SafeDealActivationThrottle() = default;
+
+content::NavigationThrottle::ThrottleCheckResult
+SafeDealActivationThrottle::WillStartRequest() {
+  // Activating before the request goes out lets the extension load while the
+  // network is busy with the page.
+  MaybeActivate();
+  return PROCEED;
+}
+
+content::NavigationThrottle::ThrottleCheckResult
+SafeDealActivationThrottle::WillRedirectRequest() {
+  MaybeActivate();
+  return PROCEED;
+}
+
+content::NavigationThrottle::ThrottleCheckResult
+SafeDealActivationThrottle::WillProcessResponse() {
+  if (!activated_ || activator_->scripts_ready()) {
+    return PROCEED;
+  }
+  deferred_ = true;
+  activator_->RunWhenScriptsReady(
+      base::BindOnce(&SafeDealActivationThrottle::ResumeIfDeferred,
+                     weak_factory_.GetWeakPtr()));
+  deferral_timer_.Start(
+      FROM_HERE, kMaxResponseDeferral,
+      base::BindOnce(&SafeDealActivationThrottle::ResumeIfDeferred,
+                     weak_factory_.GetWeakPtr()));
+  return DEFER;
+}
+
+const char* SafeDealActivationThrottle::GetNameForLogging() {
+  return "SafeDealActivationThrottle";
+}
+
+void SafeDealActivationThrottle::MaybeActivate() {
+  if (activated_) {
+    return;
+  }
+  const MarketplaceOriginMatcher& matcher =
+      MarketplaceOriginMatcher::GetInstance();
+  if (matcher.Match(navigation_handle()->GetURL()) ==
+      mojom::Marketplace::kUnknown) {
+    return;
+  }
+  activated_ = true;
+  activator_->Activate();
+}
+
+void SafeDealActivationThrottle::ResumeIfDeferred() {
+  if (!deferred_) {
+    return;
+  }
+  deferred_ = false;
+  base::UmaHistogramBoolean("SafeDeal.LazyActivation.ResponseDeferralTimedOut",
+                            !activator_->scripts_ready());
+  deferral_timer_.Stop();
+  Resume();
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,56 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_ACTIVATION_THROTTLE_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_ACTIVATION_THROTTLE_H_
+
+#include "base/memory/raw_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/timer/timer.h"
+#include "content/public/browser/navigation_throttle.h"
+
+namespace content {
+class NavigationThrottleRegistry;
+}  // namespace content
+
+namespace safe_deal {
+
+class SafeDealExtensionActivator;
+
+// Activates the Safe Deal extension when a primary main frame navigation to
+// a marketplace starts, and holds the response back until the extension's
+// content scripts have reached the renderers so that the first marketplace
+// page gets them like any later one. Only added while the extension of the
+// profile is not active yet.
+class SafeDealActivationThrottle : public content::NavigationThrottle {
+ public:
+  static void MaybeCreateAndAdd(content::NavigationThrottleRegistry& registry);
+
+  SafeDealActivationThrottle(content::NavigationThrottleRegistry& registry,
+                             SafeDealExtensionActivator* activator);
+  SafeDealActivationThrottle(const SafeDealActivationThrottle&) = delete;
+  SafeDealActivationThrottle& operator=(const SafeDealActivationThrottle&) =
+      delete;
+  ~SafeDealActivationThrottle() override;
+
+  // content::NavigationThrottle:
+  ThrottleCheckResult WillStartRequest() override;
+  ThrottleCheckResult WillRedirectRequest() override;
+  ThrottleCheckResult WillProcessResponse() override;
+  const char* GetNameForLogging() override;
+
+ private:
+  void MaybeActivate();
+  void ResumeIfDeferred();
+
+  const raw_ptr<SafeDealExtensionActivator> activator_;
+  bool activated_ = false;
+  bool deferred_ = false;
+  base::OneShotTimer deferral_timer_;
+  base::WeakPtrFactory<SafeDealActivationThrottle> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_ACTIVATION_THROTTLE_H_
@@ -0,0 +1,30 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_browser_interface_binders.h"
+
+#include "base/functional/bind.h"
+#include "safe_deal/browser/price_watch_host.h"
+#include "safe_deal/browser/safe_deal_product_handler.h"
+#include "safe_deal/browser/safe_deal_settings_host.h"
+#include "safe_deal/common/price_watch.mojom.h"
+#include "safe_deal/common/safe_deal_settings.mojom.h"
+#include "safe_deal/page_extractor/browser/safe_deal_page_extractor.h"
+#include "safe_deal/page_extractor/common/page_extractor.mojom.h"
+
+namespace safe_deal {
+
+void PopulateSafeDealFrameBinders(
+    content::RenderFrameHost* render_frame_host,
+    mojo::BinderMapWithContext<content::RenderFrameHost*>* map) {
+  map->Add<mojom::PageExtractorHost>(
+      base::BindRepeating(&SafeDealPageExtractor::BindReceiver,
+                          base::BindRepeating(&HandleExtractedProduct)));
+  map->Add<mojom::PriceWatchHost>(
+      base::BindRepeating(&PriceWatchHost::BindReceiver));
+  map->Add<mojom::SafeDealSettingsHost>(
+      base::BindRepeating(&SafeDealSettingsHost::BindReceiver));
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,24 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_BROWSER_INTERFACE_BINDERS_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_BROWSER_INTERFACE_BINDERS_H_
+
+#include "mojo/public/cpp/bindings/binder_map.h"
+
+namespace content {
+class RenderFrameHost;
+}  // namespace content
+
+namespace safe_deal {
+
+// Registers the Safe Deal interfaces renderers may request from a frame.
+// Called from chrome::internal::PopulateChromeFrameBinders().
+void PopulateSafeDealFrameBinders(
+    content::RenderFrameHost* render_frame_host,
+    mojo::BinderMapWithContext<content::RenderFrameHost*>* map);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_BROWSER_INTERFACE_BINDERS_H_
@@ -0,0 +1,26 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_browser_main_extra_parts.h"
+
+#include "safe_deal/browser/safe_deal_renderer_updater.h"
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+
+namespace safe_deal {
+
+SafeDealBrowserMainExtraParts::SafeDealBrowserMainExtraParts() = default;
+SafeDealBrowserMainExtraParts::~SafeDealBrowserMainExtraParts() = default;
+
+void SafeDealBrowserMainExtraParts::PreMainMessageLoopRun() {
+  SafeDealStartupMetrics::Scope scope(
+      "SafeDealBrowserMainExtraParts::PreMainMessageLoopRun");
+  // Before the first renderer is created, so none misses the ruleset.
+  renderer_updater_ = std::make_unique<SafeDealRendererUpdater>();
+}
+
+void SafeDealBrowserMainExtraParts::PostMainMessageLoopRun() {
+  renderer_updater_.reset();
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,37 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_BROWSER_MAIN_EXTRA_PARTS_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_BROWSER_MAIN_EXTRA_PARTS_H_
+
+#include <memory>
+
+#include "chrome/browser/chrome_browser_main_extra_parts.h"
+
+namespace safe_deal {
+
+class SafeDealRendererUpdater;
+
+// Owns the Safe Deal objects that live for the whole browser run. Added in
+// ChromeContentBrowserClient::CreateBrowserMainParts().
+class SafeDealBrowserMainExtraParts : public ChromeBrowserMainExtraParts {
+ public:
+  SafeDealBrowserMainExtraParts();
+  SafeDealBrowserMainExtraParts(const SafeDealBrowserMainExtraParts&) =
+      delete;
+  SafeDealBrowserMainExtraParts& operator=(
+      const SafeDealBrowserMainExtraParts&) = delete;
+  ~SafeDealBrowserMainExtraParts() override;
+
+  // ChromeBrowserMainExtraParts:
+  void PreMainMessageLoopRun() override;
+  void PostMainMessageLoopRun() override;
+
+ private:
+  std::unique_ptr<SafeDealRendererUpdater> renderer_updater_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_BROWSER_MAIN_EXTRA_PARTS_H_
@@ -0,0 +1,55 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_component_extension.h"
+
+#include "base/feature_list.h"
+#include "base/files/file_path.h"
+#include "chrome/browser/extensions/component_loader.h"
+#include "content/public/browser/render_frame_host.h"
+#include "extensions/browser/extension_registry.h"
+#include "extensions/common/constants.h"
+#include "extensions/common/extension.h"
+#include "safe_deal/common/safe_deal_extension.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+#include "safe_deal/extension_resources/grit/safe_deal_extension_resources.h"
+#include "safe_deal/extension_resources/grit/safe_deal_extension_resources_map.h"
+#include "url/origin.h"
+
+namespace safe_deal {
+
+void AddSafeDealComponentExtension(extensions::ComponentLoader* loader) {
+  SafeDealStartupMetrics::Scope scope("AddSafeDealComponentExtension");
+  if (base::FeatureList::IsEnabled(features::kSafeDealExtension) &&
+      !base::FeatureList::IsEnabled(features::kSafeDealLazyActivation)) {
+    LoadSafeDealComponentExtension(loader);
+  }
+}
+
+std::string LoadSafeDealComponentExtension(
+    extensions::ComponentLoader* loader) {
+  // Relative roots are resolved against DIR_RESOURCES.
+  return loader->Add(IDR_SAFE_DEAL_EXTENSION_MANIFEST_JSON,
+                     base::FilePath(kSafeDealExtensionRootDirectory));
+}
+
+bool IsSafeDealExtensionDocument(content::RenderFrameHost* render_frame_host) {
+  const url::Origin& origin = render_frame_host->GetLastCommittedOrigin();
+  if (origin.scheme() != extensions::kExtensionScheme) {
+    return false;
+  }
+  const extensions::Extension* extension =
+      extensions::ExtensionRegistry::Get(
+          render_frame_host->GetBrowserContext())
+          ->enabled_extensions()
+          .GetByID(origin.host());
+  return extension && IsSafeDealComponentExtension(*extension);
+}
+
+base::span<const webui::ResourcePath> GetSafeDealExtensionResources() {
+  return kSafeDealExtensionResources;
+}
+
+}  // namespace safe_deal
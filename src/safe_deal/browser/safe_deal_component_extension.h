@@ -0,0 +1,49 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_COMPONENT_EXTENSION_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_COMPONENT_EXTENSION_H_
+
+#include <string>
+
+#include "base/containers/span.h"
+#include "ui/base/webui/resource_path.h"
+
+namespace content {
+class RenderFrameHost;
+}  // namespace content
+
+namespace extensions {
+class ComponentLoader;
+}  // namespace extensions
+
+namespace safe_deal {
+
+// Registers the Safe Deal extension at startup, unless
+// features::kSafeDealLazyActivation defers that to the first marketplace
+// navigation (see SafeDealExtensionActivator) or features::kSafeDealExtension
+// is disabled. Called from
+// extensions::ComponentLoader::AddDefaultComponentExtensions().
+void AddSafeDealComponentExtension(extensions::ComponentLoader* loader);
+
+// Registers the Safe Deal extension as a component extension whose files are
+// all in resources.pak, and loads it if the extension system is ready.
+// Returns the extension ID, or an empty string if the manifest is invalid.
+std::string LoadSafeDealComponentExtension(
+    extensions::ComponentLoader* loader);
+
+// Returns true if the document of |render_frame_host| is one of the Safe Deal
+// extension's pages. Interfaces meant for the extension alone check this
+// before binding.
+bool IsSafeDealExtensionDocument(content::RenderFrameHost* render_frame_host);
+
+// Files of the extension, keyed by their path under DIR_RESOURCES. Added to
+// the component resources in ChromeComponentExtensionResourceManager::Data,
+// so that extension and content script loads are served from the
+// memory-mapped pak instead of the disk.
+base::span<const webui::ResourcePath> GetSafeDealExtensionResources();
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_COMPONENT_EXTENSION_H_
@@ -0,0 +1,115 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_extension_activator.h"
+
+#include <utility>
+
+#include "base/metrics/histogram_functions.h"
+#include "chrome/browser/extensions/component_loader.h"
+#include "chrome/browser/profiles/profile.h"
+#include "extensions/browser/extension_system.h"
+#include "extensions/browser/extension_user_script_loader.h"
+#include "extensions/browser/user_script_manager.h"
+#include "extensions/common/extension.h"
+#include "safe_deal/browser/safe_deal_component_extension.h"
+
+namespace safe_deal {
+
+SafeDealExtensionActivator::SafeDealExtensionActivator(Profile* profile)
+    : profile_(profile) {}
+
+SafeDealExtensionActivator::~SafeDealExtensionActivator() = default;
+
+void SafeDealExtensionActivator::Activate() {
+  if (!extension_id_.empty() || scripts_ready_) {
+    return;
+  }
+  activation_start_ = base::TimeTicks::Now();
+  extension_id_ =
+      LoadSafeDealComponentExtension(extensions::ComponentLoader::Get(profile_));
+  if (extension_id_.empty()) {
+    // Nothing to wait for; navigations must not be held up.
+    SetScriptsReady();
+    return;
+  }
+
+  // The component loader defers loading until the extension system is
+  // ready, e.g. for tabs restored at startup.
+  extensions::ExtensionRegistry* registry =
+      extensions::ExtensionRegistry::Get(profile_);
+  if (registry->ready_extensions().Contains(extension_id_)) {
+    ObserveScriptLoader();
+  } else {
+    registry_observation_.Observe(registry);
+  }
+}
+
+void SafeDealExtensionActivator::RunWhenScriptsReady(
+    base::OnceClosure callback) {
+  DCHECK(!extension_id_.empty() || scripts_ready_);
+  if (scripts_ready_) {
+    std::move(callback).Run();
+    return;
+  }
+  ready_callbacks_.push_back(std::move(callback));
+}
+
+void SafeDealExtensionActivator::Shutdown() {
+  registry_observation_.Reset();
+  script_loader_observation_.Reset();
+  ready_callbacks_.clear();
+}
+
+void SafeDealExtensionActivator::OnExtensionReady(
+    content::BrowserContext* browser_context,
+    const extensions::Extension* extension) {
+  if (extension->id() != extension_id_) {
+    return;
+  }
+  registry_observation_.Reset();
+  ObserveScriptLoader();
+}
+
+void SafeDealExtensionActivator::OnScriptsLoaded(
+    extensions::UserScriptLoader* loader,
+    content::BrowserContext* browser_context) {
+  SetScriptsReady();
+}
+
+void SafeDealExtensionActivator::OnUserScriptLoaderDestroyed(
+    extensions::UserScriptLoader* loader) {
+  // The extension was unloaded before its scripts were.
+  SetScriptsReady();
+}
+
+void SafeDealExtensionActivator::ObserveScriptLoader() {
+  extensions::UserScriptManager* manager =
+      extensions::ExtensionSystem::Get(profile_)->user_script_manager();
+  extensions::ExtensionUserScriptLoader* loader =
+      manager ? manager->GetUserScriptLoaderForExtension(extension_id_)
+              : nullptr;
+  if (!loader || loader->initial_load_complete()) {
+    SetScriptsReady();
+    return;
+  }
+  script_loader_observation_.Observe(loader);
+}
+
+void SafeDealExtensionActivator::SetScriptsReady() {
+  if (scripts_ready_) {
+    return;
+  }
+  scripts_ready_ = true;
+  script_loader_observation_.Reset();
+  if (!activation_start_.is_null()) {
+    base::UmaHistogramTimes("SafeDeal.LazyActivation.ActivationTime",
+                            base::TimeTicks::Now() - activation_start_);
+  }
+  for (base::OnceClosure& callback : std::exchange(ready_callbacks_, {})) {
+    std::move(callback).Run();
+  }
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,86 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_EXTENSION_ACTIVATOR_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_EXTENSION_ACTIVATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "base/functional/callback.h"
+#include "base/memory/raw_ptr.h"
+#include "base/scoped_observation.h"
+#include "base/time/time.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "extensions/browser/extension_registry.h"
+#include "extensions/browser/extension_registry_observer.h"
+#include "extensions/browser/user_script_loader.h"
+
+class Profile;
+
+namespace safe_deal {
+
+// Loads the Safe Deal extension of a profile on demand when
+// features::kSafeDealLazyActivation is enabled, so that profiles that never
+// visit a marketplace never start its service worker or register its content
+// scripts. UI thread only.
+class SafeDealExtensionActivator
+    : public KeyedService,
+      public extensions::ExtensionRegistryObserver,
+      public extensions::UserScriptLoader::Observer {
+ public:
+  explicit SafeDealExtensionActivator(Profile* profile);
+  SafeDealExtensionActivator(const SafeDealExtensionActivator&) = delete;
+  SafeDealExtensionActivator& operator=(const SafeDealExtensionActivator&) =
+      delete;
+  ~SafeDealExtensionActivator() override;
+
+  // Loads the extension unless that was already done.
+  void Activate();
+
+  // Whether the content scripts of the activated extension have reached the
+  // renderers, so documents that commit from now on get them injected.
+  bool scripts_ready() const { return scripts_ready_; }
+
+  // ID of the extension, or an empty string until Activate().
+  const std::string& extension_id() const { return extension_id_; }
+
+  // Runs |callback| once scripts_ready(). Must be called after Activate().
+  void RunWhenScriptsReady(base::OnceClosure callback);
+
+  // KeyedService:
+  void Shutdown() override;
+
+ private:
+  // extensions::ExtensionRegistryObserver:
+  void OnExtensionReady(content::BrowserContext* browser_context,
+                        const extensions::Extension* extension) override;
+
+  // extensions::UserScriptLoader::Observer:
+  void OnScriptsLoaded(extensions::UserScriptLoader* loader,
+                       content::BrowserContext* browser_context) override;
+  void OnUserScriptLoaderDestroyed(
+      extensions::UserScriptLoader* loader) override;
+
+  // Waits for the content scripts of the loaded extension.
+  void ObserveScriptLoader();
+  void SetScriptsReady();
+
+  const raw_ptr<Profile> profile_;
+  std::string extension_id_;
+  bool scripts_ready_ = false;
+  base::TimeTicks activation_start_;
+  std::vector<base::OnceClosure> ready_callbacks_;
+
+  base::ScopedObservation<extensions::ExtensionRegistry,
+                          extensions::ExtensionRegistryObserver>
+      registry_observation_{this};
+  base::ScopedObservation<extensions::UserScriptLoader,
+                          extensions::UserScriptLoader::Observer>
+      script_loader_observation_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_EXTENSION_ACTIVATOR_H_
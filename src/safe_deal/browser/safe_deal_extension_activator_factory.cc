@@ -0,0 +1,54 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_extension_activator_factory.h"
+
+#include "chrome/browser/profiles/profile.h"
+#include "extensions/browser/extension_registry_factory.h"
+#include "extensions/browser/extension_system_provider.h"
+#include "extensions/browser/extensions_browser_client.h"
+#include "safe_deal/browser/safe_deal_extension_activator.h"
+#include "safe_deal/browser/safe_deal_prefs.h"
+
+namespace safe_deal {
+
+// static
+SafeDealExtensionActivator* SafeDealExtensionActivatorFactory::GetForProfile(
+    Profile* profile) {
+  return static_cast<SafeDealExtensionActivator*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+}
+
+// static
+SafeDealExtensionActivatorFactory*
+SafeDealExtensionActivatorFactory::GetInstance() {
+  static base::NoDestructor<SafeDealExtensionActivatorFactory> instance;
+  return instance.get();
+}
+
+SafeDealExtensionActivatorFactory::SafeDealExtensionActivatorFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealExtensionActivator",
+          ProfileSelections::BuildRedirectedInIncognito()) {
+  DependsOn(extensions::ExtensionRegistryFactory::GetInstance());
+  DependsOn(
+      extensions::ExtensionsBrowserClient::Get()->GetExtensionSystemFactory());
+}
+
+SafeDealExtensionActivatorFactory::~SafeDealExtensionActivatorFactory() =
+    default;
+
+std::unique_ptr<KeyedService>
+SafeDealExtensionActivatorFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  return std::make_unique<SafeDealExtensionActivator>(
+      Profile::FromBrowserContext(context));
+}
+
+void SafeDealExtensionActivatorFactory::RegisterProfilePrefs(
+    user_prefs::PrefRegistrySyncable* registry) {
+  RegisterSafeDealProfilePrefs(registry);
+}
+
+}  // namespace safe_deal
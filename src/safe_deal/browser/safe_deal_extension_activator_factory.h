@@ -0,0 +1,51 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_EXTENSION_ACTIVATOR_FACTORY_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_EXTENSION_ACTIVATOR_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace user_prefs {
+class PrefRegistrySyncable;
+}  // namespace user_prefs
+
+namespace safe_deal {
+
+class SafeDealExtensionActivator;
+
+// Creates the SafeDealExtensionActivator of a profile. Incognito profiles
+// share the activator of their original profile, which owns the extension.
+// Also registers the profile prefs behind the extension's settings.
+class SafeDealExtensionActivatorFactory : public ProfileKeyedServiceFactory {
+ public:
+  static SafeDealExtensionActivator* GetForProfile(Profile* profile);
+  static SafeDealExtensionActivatorFactory* GetInstance();
+
+  SafeDealExtensionActivatorFactory(const SafeDealExtensionActivatorFactory&) =
+      delete;
+  SafeDealExtensionActivatorFactory& operator=(
+      const SafeDealExtensionActivatorFactory&) = delete;
+
+ private:
+  friend base::NoDestructor<SafeDealExtensionActivatorFactory>;
+
+  SafeDealExtensionActivatorFactory();
+  ~SafeDealExtensionActivatorFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+  void RegisterProfilePrefs(
+      user_prefs::PrefRegistrySyncable* registry) override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_EXTENSION_ACTIVATOR_FACTORY_H_
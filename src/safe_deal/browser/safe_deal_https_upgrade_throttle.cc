@@ -0,0 +1,130 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_https_upgrade_throttle.h"
+
+#include <memory>
+#include <string>
+
+#include "base/feature_list.h"
+#include "base/metrics/histogram_functions.h"
+#include "chrome/browser/profiles/profile.h"
+#include "chrome/browser/ssl/stateful_ssl_host_state_delegate_factory.h"
+#include "chrome/common/pref_names.h"
+#include "components/prefs/pref_service.h"
+#include "components/security_interstitials/content/stateful_ssl_host_state_delegate.h"
+#include "content/public/browser/navigation_handle.h"
+#include "content/public/browser/navigation_throttle_registry.h"
+#include "content/public/browser/render_frame_host.h"
+#include "content/public/browser/web_contents.h"
+#include "net/base/url_util.h"
+#include "safe_deal/browser/https_upgrade_service_factory.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/https_upgrade/browser/https_upgrade_service.h"
+#include "url/gurl.h"
+#include "url/url_constants.h"
+
+namespace safe_deal {
+
+namespace {
+
+// IP addresses and local hosts are never upgraded by Chrome.
+bool IsUpgradeable(const GURL& url) {
+  return !url.HostIsIPAddress() && !net::IsLocalhost(url) &&
+         !url.host_piece().empty();
+}
+
+content::StoragePartition* GetStoragePartition(
+    content::NavigationHandle* handle) {
+  return handle->GetWebContents()->GetPrimaryMainFrame()->GetStoragePartition();
+}
+
+}  // namespace
+
+// static
+void SafeDealHttpsUpgradeThrottle::MaybeCreateAndAdd(
+    content::NavigationThrottleRegistry& registry) {
+  if (!base::FeatureList::IsEnabled(features::kSafeDealHttpsUpgradeIndex)) {
+    return;
+  }
+  content::NavigationHandle& handle = registry.GetNavigationHandle();
+  if (!handle.IsInPrimaryMainFrame()) {
+    return;
+  }
+  Profile* profile = Profile::FromBrowserContext(
+      handle.GetWebContents()->GetBrowserContext());
+  HttpsUpgradeService* service =
+      HttpsUpgradeServiceFactory::GetForProfile(profile);
+  StatefulSSLHostStateDelegate* state =
+      StatefulSSLHostStateDelegateFactory::GetForProfile(profile);
+  if (!service || !state) {
+    return;
+  }
+  registry.AddThrottle(std::make_unique<SafeDealHttpsUpgradeThrottle>(
+      registry, service, state, /*learn=*/!profile->IsOffTheRecord(),
+      /*allow_fallback=*/
+      !profile->GetPrefs()->GetBoolean(prefs::kHttpsOnlyModeEnabled)));
+}
+
+SafeDealHttpsUpgradeThrottle::SafeDealHttpsUpgradeThrottle(
+    content::NavigationThrottleRegistry& registry,
+    HttpsUpgradeService* service,
+    StatefulSSLHostStateDelegate* state,
+    bool learn,
+    bool allow_fallback)
+    : content::NavigationThrottle(registry),
+      service_(service),
+      state_(state),
+      learn_(learn),
+      allow_fallback_(allow_fallback) {}
+
+SafeDealHttpsUpgradeThrottle::~SafeDealHttpsUpgradeThrottle() = default;
+
+content::NavigationThrottle::ThrottleCheckResult
+SafeDealHttpsUpgradeThrottle::WillStartRequest() {
+  const GURL& url = navigation_handle()->GetURL();
+  if (!url.SchemeIs(url::kHttpScheme) || !IsUpgradeable(url)) {
+    return PROCEED;
+  }
+  http_host_ = url.host();
+  HttpsUpgradeDecision decision = service_->GetDecision(url.host_piece());
+  base::UmaHistogramEnumeration("SafeDeal.HttpsUpgrade.Decision", decision);
+  if (decision != HttpsUpgradeDecision::kFallback || !allow_fallback_) {
+    return PROCEED;
+  }
+  // Chrome's upgrade runs after the start checks, so allowing HTTP now skips
+  // it for this navigation.
+  content::StoragePartition* storage_partition =
+      GetStoragePartition(navigation_handle());
+  if (!state_->IsHttpAllowedForHost(url.host(), storage_partition)) {
+    state_->AllowHttpForHost(url.host(), storage_partition);
+  }
+  applied_fallback_ = true;
+  return PROCEED;
+}
+
+content::NavigationThrottle::ThrottleCheckResult
+SafeDealHttpsUpgradeThrottle::WillProcessResponse() {
+  const GURL& url = navigation_handle()->GetURL();
+  // Only the host the navigation started on over HTTP is looked up, so
+  // nothing else is worth keeping.
+  if (!learn_ || applied_fallback_ || url.host_piece() != http_host_) {
+    return PROCEED;
+  }
+  if (url.SchemeIs(url::kHttpsScheme)) {
+    service_->LearnDecision(url.host_piece(), HttpsUpgradeDecision::kUpgrade);
+  } else if (url.SchemeIs(url::kHttpScheme) &&
+             state_->IsHttpAllowedForHost(
+                 url.host(), GetStoragePartition(navigation_handle()))) {
+    service_->LearnDecision(url.host_piece(),
+                            HttpsUpgradeDecision::kFallback);
+  }
+  return PROCEED;
+}
+
+const char* SafeDealHttpsUpgradeThrottle::GetNameForLogging() {
+  return "SafeDealHttpsUpgradeThrottle";
+}
+
+}  // namespace safe_deal
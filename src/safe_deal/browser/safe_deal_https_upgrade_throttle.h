@@ -0,0 +1,71 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_HTTPS_UPGRADE_THROTTLE_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_HTTPS_UPGRADE_THROTTLE_H_
+
+#include <string>
+
+#include "base/memory/raw_ptr.h"
+#include "content/public/browser/navigation_throttle.h"
+
+class StatefulSSLHostStateDelegate;
+
+namespace content {
+class NavigationThrottleRegistry;
+}  // namespace content
+
+namespace safe_deal {
+
+class HttpsUpgradeService;
+
+// Applies and learns HttpsUpgradeService decisions for primary main frame
+// navigations. Chrome upgrades http:// navigations to HTTPS and falls back
+// to HTTP if the upgrade fails, which costs a failed connection for every
+// host without HTTPS. Hosts the index knows to be HTTP only are allowed
+// HTTP before the request starts, so Chrome loads them without trying
+// HTTPS first; other hosts are left to Chrome's upgrade. Hosts are learned
+// from the responses of navigations that started over HTTP: HTTPS ones when
+// the response for the same host arrives over HTTPS after an upgrade or a
+// redirect, HTTP only ones when Chrome itself allowed HTTP for them, after a
+// fallback or a click through its warning. Navigations that start over
+// HTTPS teach nothing, so the learned hosts are not a log of every HTTPS
+// site visited. Neither do navigations the throttle allowed HTTP for, since
+// Chrome never tried HTTPS for them.
+class SafeDealHttpsUpgradeThrottle : public content::NavigationThrottle {
+ public:
+  static void MaybeCreateAndAdd(content::NavigationThrottleRegistry& registry);
+
+  SafeDealHttpsUpgradeThrottle(content::NavigationThrottleRegistry& registry,
+                               HttpsUpgradeService* service,
+                               StatefulSSLHostStateDelegate* state,
+                               bool learn,
+                               bool allow_fallback);
+  SafeDealHttpsUpgradeThrottle(const SafeDealHttpsUpgradeThrottle&) = delete;
+  SafeDealHttpsUpgradeThrottle& operator=(
+      const SafeDealHttpsUpgradeThrottle&) = delete;
+  ~SafeDealHttpsUpgradeThrottle() override;
+
+  // content::NavigationThrottle:
+  ThrottleCheckResult WillStartRequest() override;
+  ThrottleCheckResult WillProcessResponse() override;
+  const char* GetNameForLogging() override;
+
+ private:
+  const raw_ptr<HttpsUpgradeService> service_;
+  const raw_ptr<StatefulSSLHostStateDelegate> state_;
+  // False for incognito profiles.
+  const bool learn_;
+  // False in HTTPS-First Mode, where the user asked to be warned before
+  // every HTTP page.
+  const bool allow_fallback_;
+  // The host of the http:// URL the navigation started on, if upgradeable.
+  std::string http_host_;
+  // Whether WillStartRequest() applied a kFallback decision, allowing HTTP.
+  bool applied_fallback_ = false;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_HTTPS_UPGRADE_THROTTLE_H_
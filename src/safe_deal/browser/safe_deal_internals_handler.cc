@@ -0,0 +1,302 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_internals_handler.h"
+
+#include <stdint.h>
+
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "base/feature_list.h"
+#include "base/functional/bind.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/prefs/pref_service.h"
+#include "content/public/browser/histogram_fetcher.h"
+#include "content/public/browser/web_ui.h"
+#include "safe_deal/browser/https_upgrade_service_factory.h"
+#include "safe_deal/browser/price_history_service_factory.h"
+#include "safe_deal/browser/product_cache_factory.h"
+#include "safe_deal/browser/product_matching_service_factory.h"
+#include "safe_deal/browser/safe_deal_memory_budget_factory.h"
+#include "safe_deal/browser/safe_deal_prefs.h"
+#include "safe_deal/browser/safe_deal_renderer_updater.h"
+#include "safe_deal/browser/seller_reputation_cache_factory.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/common/safe_deal_memory_budget.h"
+#include "safe_deal/https_upgrade/browser/https_upgrade_service.h"
+#include "safe_deal/price_history/price_history_service.h"
+#include "safe_deal/product_cache/browser/product_cache.h"
+#include "safe_deal/product_matching/product_matching_service.h"
+#include "safe_deal/seller_reputation/browser/seller_reputation_cache.h"
+
+namespace safe_deal {
+
+namespace {
+
+// How long to wait for child processes to send their histograms. Processes
+// that are slower are left out of the current refresh.
+constexpr base::TimeDelta kHistogramFetchTimeout = base::Seconds(1);
+
+enum class Unit {
+  kMicroseconds,
+  kMilliseconds,
+};
+
+struct LatencyHistogram {
+  const char* label;
+  const char* name;
+  Unit unit;
+};
+
+constexpr LatencyHistogram kLatencyHistograms[] = {
+    {"Product extraction", "SafeDeal.PageExtractor.ExtractionTime",
+     Unit::kMicroseconds},
+    {"Review scoring, per batch", "SafeDeal.ReviewScorer.BatchTime",
+     Unit::kMicroseconds},
+    {"Review scoring, per page", "SafeDeal.ReviewScorer.JobTime",
+     Unit::kMilliseconds},
+    {"Review verdict, first scores", "SafeDeal.ReviewScorer.TimeToFirstScores",
+     Unit::kMilliseconds},
+    {"Review verdict, all pages", "SafeDeal.ReviewScorer.PipelineTime",
+     Unit::kMilliseconds},
+    {"Cross-marketplace match lookup", "SafeDeal.ProductMatching.LookupTime",
+     Unit::kMicroseconds},
+    {"Seller reputation lookup", "SafeDeal.SellerReputation.LookupTime",
+     Unit::kMicroseconds},
+    {"URL filter match", "SafeDeal.UrlFilter.MatchTime", Unit::kMicroseconds},
+    {"Extension activation", "SafeDeal.LazyActivation.ActivationTime",
+     Unit::kMilliseconds},
+    {"Product analysis, all lookups",
+     "SafeDeal.TaskRunner.PipelineTime.ProductAnalysis", Unit::kMicroseconds},
+    {"Analysis queueing, foreground tab",
+     "SafeDeal.TaskRunner.QueueTime.Foreground", Unit::kMicroseconds},
+    {"Analysis queueing, background tab",
+     "SafeDeal.TaskRunner.QueueTime.Background", Unit::kMicroseconds},
+};
+
+// Boolean histograms; the rate is the share of true samples.
+struct RateHistogram {
+  const char* label;
+  const char* name;
+};
+
+constexpr RateHistogram kRateHistograms[] = {
+    {"Review pages downloaded", "SafeDeal.ReviewScorer.PageDownloaded"},
+    {"Seller reputation cache hits", "SafeDeal.SellerReputation.CacheHit"},
+    {"Subresource requests blocked", "SafeDeal.UrlFilter.Blocked"},
+    {"Marketplace responses deferred past the timeout",
+     "SafeDeal.LazyActivation.ResponseDeferralTimedOut"},
+    {"Shopping predictor hits", "SafeDeal.ShoppingPredictor.PredictionHit"},
+    {"Prerendered shopping pages shown",
+     "SafeDeal.ShoppingPredictor.PrerenderActivated"},
+};
+
+constexpr double kPercentiles[] = {0.5, 0.95, 0.99};
+constexpr const char* kPercentileKeys[] = {"p50", "p95", "p99"};
+
+std::unique_ptr<base::HistogramSamples> SnapshotSamples(const char* name) {
+  base::HistogramBase* histogram =
+      base::StatisticsRecorder::FindHistogram(name);
+  return histogram ? histogram->SnapshotSamples() : nullptr;
+}
+
+// Percentiles are interpolated linearly within the bucket that holds them, so
+// they are only as precise as the bucket layout of the histogram. Samples in
+// the overflow bucket count as its lower bound.
+base::Value::Dict SummarizeLatency(const LatencyHistogram& latency) {
+  base::Value::Dict summary;
+  summary.Set("label", latency.label);
+  summary.Set("histogram", latency.name);
+  std::unique_ptr<base::HistogramSamples> samples =
+      SnapshotSamples(latency.name);
+  int64_t total = samples ? samples->TotalCount() : 0;
+  summary.Set("count", static_cast<double>(total));
+  if (total == 0) {
+    return summary;
+  }
+
+  const double to_milliseconds =
+      latency.unit == Unit::kMicroseconds ? 0.001 : 1.0;
+  size_t next = 0;
+  int64_t cumulative = 0;
+  for (std::unique_ptr<base::SampleCountIterator> it = samples->Iterator();
+       !it->Done() && next < std::size(kPercentiles); it->Next()) {
+    base::HistogramBase::Sample32 min;
+    int64_t max;
+    base::HistogramBase::Count32 count;
+    it->Get(&min, &max, &count);
+    if (max > base::HistogramBase::kSampleType_MAX) {
+      max = min;
+    }
+    while (next < std::size(kPercentiles) &&
+           cumulative + count >= kPercentiles[next] * total) {
+      double fraction = (kPercentiles[next] * total - cumulative) / count;
+      summary.Set(kPercentileKeys[next],
+                  (min + fraction * (max - min)) * to_milliseconds);
+      ++next;
+    }
+    cumulative += count;
+  }
+  return summary;
+}
+
+base::Value::Dict SummarizeRate(const RateHistogram& rate) {
+  base::Value::Dict summary;
+  summary.Set("label", rate.label);
+  summary.Set("histogram", rate.name);
+  std::unique_ptr<base::HistogramSamples> samples = SnapshotSamples(rate.name);
+  int64_t total = samples ? samples->TotalCount() : 0;
+  summary.Set("count", static_cast<double>(total));
+  if (total > 0) {
+    summary.Set("rate", static_cast<double>(samples->GetCount(1)) / total);
+  }
+  return summary;
+}
+
+base::Value::Dict MemoryEntry(const char* label, size_t bytes) {
+  base::Value::Dict entry;
+  entry.Set("label", label);
+  entry.Set("bytes", static_cast<double>(bytes));
+  return entry;
+}
+
+}  // namespace
+
+SafeDealInternalsHandler::SafeDealInternalsHandler() = default;
+SafeDealInternalsHandler::~SafeDealInternalsHandler() = default;
+
+void SafeDealInternalsHandler::RegisterMessages() {
+  web_ui()->RegisterMessageCallback(
+      "getSafeDealStats",
+      base::BindRepeating(&SafeDealInternalsHandler::HandleGetSafeDealStats,
+                          base::Unretained(this)));
+  web_ui()->RegisterMessageCallback(
+      "getSafeDealSettings",
+      base::BindRepeating(&SafeDealInternalsHandler::HandleGetSafeDealSettings,
+                          base::Unretained(this)));
+}
+
+void SafeDealInternalsHandler::OnJavascriptDisallowed() {
+  weak_factory_.InvalidateWeakPtrs();
+}
+
+void SafeDealInternalsHandler::HandleGetSafeDealStats(
+    const base::Value::List& args) {
+  AllowJavascript();
+  // Renderers and the review scorer record most of the histograms; pull
+  // their deltas into the browser's StatisticsRecorder first.
+  content::FetchHistogramsAsynchronously(
+      base::SequencedTaskRunner::GetCurrentDefault(),
+      base::BindOnce(&SafeDealInternalsHandler::OnHistogramsFetched,
+                     weak_factory_.GetWeakPtr(), args[0].Clone()),
+      kHistogramFetchTimeout);
+}
+
+void SafeDealInternalsHandler::HandleGetSafeDealSettings(
+    const base::Value::List& args) {
+  AllowJavascript();
+  base::Value::Dict settings;
+  settings.Set("leanShoppingAvailable",
+               base::FeatureList::IsEnabled(features::kSafeDealLeanShopping));
+  settings.Set("leanShopping",
+               Profile::FromWebUI(web_ui())->GetPrefs()->GetBoolean(
+                   prefs::kLeanShoppingEnabled));
+  ResolveJavascriptCallback(args[0], settings);
+}
+
+void SafeDealInternalsHandler::OnHistogramsFetched(base::Value callback_id) {
+  base::Value::List latencies;
+  for (const LatencyHistogram& latency : kLatencyHistograms) {
+    latencies.Append(SummarizeLatency(latency));
+  }
+  base::Value::List rates;
+  for (const RateHistogram& rate : kRateHistograms) {
+    rates.Append(SummarizeRate(rate));
+  }
+
+  base::Value::List memory;
+  if (SafeDealRendererUpdater* updater = SafeDealRendererUpdater::Get()) {
+    memory.Append(MemoryEntry("URL filter ruleset, mapped by each renderer",
+                              updater->url_filter_ruleset_size()));
+  }
+  Profile* profile = Profile::FromWebUI(web_ui());
+  // The heap caches register with the budget; get the services created so
+  // that they show up.
+  SellerReputationCache* seller_reputation_cache =
+      SellerReputationCacheFactory::GetForProfile(profile);
+  HttpsUpgradeService* https_upgrade =
+      HttpsUpgradeServiceFactory::GetForProfile(profile);
+  if (SafeDealMemoryBudget* budget =
+          SafeDealMemoryBudgetFactory::GetForProfile(profile)) {
+    for (const SafeDealMemoryBudget::ClientUsage& usage : budget->GetUsage()) {
+      memory.Append(MemoryEntry(usage.label, usage.bytes));
+    }
+    memory.Append(MemoryEntry("Heap caches, total", budget->GetTotalUsage()));
+    memory.Append(MemoryEntry("Heap caches, ceiling", budget->ceiling()));
+  }
+  if (seller_reputation_cache) {
+    memory.Append(
+        MemoryEntry("Seller reputation table, shared with renderers",
+                    seller_reputation_cache->table_size()));
+  }
+  if (ProductCache* cache = ProductCacheFactory::GetForProfile(profile)) {
+    memory.Append(MemoryEntry("Product table, shared with renderers",
+                              cache->table_size()));
+  }
+  if (https_upgrade) {
+    memory.Append(MemoryEntry("HTTPS preload index, mapped",
+                              https_upgrade->preload_size()));
+  }
+
+  base::Value::Dict stats;
+  stats.Set("latencies", std::move(latencies));
+  stats.Set("rates", std::move(rates));
+  stats.Set("memory", std::move(memory));
+
+  PriceHistoryService* price_history =
+      PriceHistoryServiceFactory::GetForProfile(profile);
+  if (!price_history) {
+    ResolveJavascriptCallback(callback_id, stats);
+    return;
+  }
+  price_history->GetMappedBytes(base::BindOnce(
+      &SafeDealInternalsHandler::OnPriceHistoryMappedBytes,
+      weak_factory_.GetWeakPtr(), std::move(callback_id), std::move(stats)));
+}
+
+void SafeDealInternalsHandler::OnPriceHistoryMappedBytes(
+    base::Value callback_id,
+    base::Value::Dict stats,
+    size_t mapped_bytes) {
+  stats.FindList("memory")->Append(
+      MemoryEntry("Price history, mapped", mapped_bytes));
+  ProductMatchingService* product_matching =
+      ProductMatchingServiceFactory::GetForProfile(
+          Profile::FromWebUI(web_ui()));
+  if (!product_matching) {
+    ResolveJavascriptCallback(callback_id, stats);
+    return;
+  }
+  product_matching->GetMappedBytes(base::BindOnce(
+      &SafeDealInternalsHandler::OnProductMatchingMappedBytes,
+      weak_factory_.GetWeakPtr(), std::move(callback_id), std::move(stats)));
+}
+
+void SafeDealInternalsHandler::OnProductMatchingMappedBytes(
+    base::Value callback_id,
+    base::Value::Dict stats,
+    size_t mapped_bytes) {
+  stats.FindList("memory")->Append(
+      MemoryEntry("Product matching index, mapped", mapped_bytes));
+  ResolveJavascriptCallback(callback_id, stats);
+}
+
+}  // namespace safe_deal
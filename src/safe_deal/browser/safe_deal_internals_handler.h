@@ -0,0 +1,49 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_INTERNALS_HANDLER_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_INTERNALS_HANDLER_H_
+
+#include <stddef.h>
+
+#include "base/memory/weak_ptr.h"
+#include "base/values.h"
+#include "content/public/browser/web_ui_message_handler.h"
+
+namespace safe_deal {
+
+// Answers "getSafeDealStats" from chrome://safe-deal-internals with the
+// latency percentiles and hit rates of the Safe Deal histograms, merged from
+// all processes, and the memory used by each component. Also shows the Safe
+// Deal settings of the profile through "getSafeDealSettings"; they are
+// changed from the shopping assistant's settings UI, not here.
+class SafeDealInternalsHandler : public content::WebUIMessageHandler {
+ public:
+  SafeDealInternalsHandler();
+  SafeDealInternalsHandler(const SafeDealInternalsHandler&) = delete;
+  SafeDealInternalsHandler& operator=(const SafeDealInternalsHandler&) =
+      delete;
+  ~SafeDealInternalsHandler() override;
+
+  // content::WebUIMessageHandler:
+  void RegisterMessages() override;
+  void OnJavascriptDisallowed() override;
+
+ private:
+  void HandleGetSafeDealStats(const base::Value::List& args);
+  void HandleGetSafeDealSettings(const base::Value::List& args);
+  void OnHistogramsFetched(base::Value callback_id);
+  void OnPriceHistoryMappedBytes(base::Value callback_id,
+                                 base::Value::Dict stats,
+                                 size_t mapped_bytes);
+  void OnProductMatchingMappedBytes(base::Value callback_id,
+                                    base::Value::Dict stats,
+                                    size_t mapped_bytes);
+
+  base::WeakPtrFactory<SafeDealInternalsHandler> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_INTERNALS_HANDLER_H_
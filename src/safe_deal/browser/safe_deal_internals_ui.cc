@@ -0,0 +1,34 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_internals_ui.h"
+
+#include <memory>
+
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/web_ui.h"
+#include "content/public/browser/web_ui_data_source.h"
+#include "content/public/common/url_constants.h"
+#include "safe_deal/browser/safe_deal_internals_handler.h"
+#include "safe_deal/internals_resources/grit/safe_deal_internals_resources.h"
+#include "safe_deal/internals_resources/grit/safe_deal_internals_resources_map.h"
+#include "ui/webui/webui_util.h"
+
+namespace safe_deal {
+
+SafeDealInternalsUIConfig::SafeDealInternalsUIConfig()
+    : DefaultWebUIConfig(content::kChromeUIScheme, kSafeDealInternalsHost) {}
+
+SafeDealInternalsUI::SafeDealInternalsUI(content::WebUI* web_ui)
+    : content::WebUIController(web_ui) {
+  content::WebUIDataSource* source = content::WebUIDataSource::CreateAndAdd(
+      Profile::FromWebUI(web_ui), kSafeDealInternalsHost);
+  webui::SetupWebUIDataSource(source, kSafeDealInternalsResources,
+                              IDR_SAFE_DEAL_INTERNALS_SAFE_DEAL_INTERNALS_HTML);
+  web_ui->AddMessageHandler(std::make_unique<SafeDealInternalsHandler>());
+}
+
+SafeDealInternalsUI::~SafeDealInternalsUI() = default;
+
+}  // namespace safe_deal
@@ -0,0 +1,35 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_INTERNALS_UI_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_INTERNALS_UI_H_
+
+#include "content/public/browser/web_ui_controller.h"
+#include "content/public/browser/webui_config.h"
+
+namespace safe_deal {
+
+inline constexpr char kSafeDealInternalsHost[] = "safe-deal-internals";
+
+class SafeDealInternalsUI;
+
+class SafeDealInternalsUIConfig
+    : public content::DefaultWebUIConfig<SafeDealInternalsUI> {
+ public:
+  SafeDealInternalsUIConfig();
+};
+
+// chrome://safe-deal-internals: latencies, cache hit rates and memory usage
+// of the Safe Deal components, for developers.
+class SafeDealInternalsUI : public content::WebUIController {
+ public:
+  explicit SafeDealInternalsUI(content::WebUI* web_ui);
+  SafeDealInternalsUI(const SafeDealInternalsUI&) = delete;
+  SafeDealInternalsUI& operator=(const SafeDealInternalsUI&) = delete;
+  ~SafeDealInternalsUI() override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_INTERNALS_UI_H_
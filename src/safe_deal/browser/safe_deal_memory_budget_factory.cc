@@ -0,0 +1,69 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_memory_budget_factory.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+
+#include "base/feature_list.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/common/safe_deal_memory_budget.h"
+
+namespace safe_deal {
+
+namespace {
+
+size_t GetCeiling() {
+  return static_cast<size_t>(
+             std::max(features::kMemoryBudgetCeilingKiB.Get(), 0)) *
+         1024;
+}
+
+class SafeDealMemoryBudgetService : public KeyedService {
+ public:
+  SafeDealMemoryBudgetService()
+      : budget_(GetCeiling(),
+                base::FeatureList::IsEnabled(features::kSafeDealMemoryBudget)) {
+  }
+
+  SafeDealMemoryBudget& budget() { return budget_; }
+
+ private:
+  SafeDealMemoryBudget budget_;
+};
+
+}  // namespace
+
+// static
+SafeDealMemoryBudget* SafeDealMemoryBudgetFactory::GetForProfile(
+    Profile* profile) {
+  auto* service = static_cast<SafeDealMemoryBudgetService*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+  return service ? &service->budget() : nullptr;
+}
+
+// static
+SafeDealMemoryBudgetFactory* SafeDealMemoryBudgetFactory::GetInstance() {
+  static base::NoDestructor<SafeDealMemoryBudgetFactory> instance;
+  return instance.get();
+}
+
+SafeDealMemoryBudgetFactory::SafeDealMemoryBudgetFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealMemoryBudget",
+          ProfileSelections::BuildForRegularAndIncognito()) {}
+
+SafeDealMemoryBudgetFactory::~SafeDealMemoryBudgetFactory() = default;
+
+std::unique_ptr<KeyedService>
+SafeDealMemoryBudgetFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  return std::make_unique<SafeDealMemoryBudgetService>();
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,45 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_MEMORY_BUDGET_FACTORY_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_MEMORY_BUDGET_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace safe_deal {
+
+class SafeDealMemoryBudget;
+
+// Owns the SafeDealMemoryBudget that the Safe Deal caches of a profile
+// register with. Incognito profiles get their own; services redirected to
+// the original profile register with its budget. Services that register
+// must depend on this factory.
+class SafeDealMemoryBudgetFactory : public ProfileKeyedServiceFactory {
+ public:
+  static SafeDealMemoryBudget* GetForProfile(Profile* profile);
+  static SafeDealMemoryBudgetFactory* GetInstance();
+
+  SafeDealMemoryBudgetFactory(const SafeDealMemoryBudgetFactory&) = delete;
+  SafeDealMemoryBudgetFactory& operator=(const SafeDealMemoryBudgetFactory&) =
+      delete;
+
+ private:
+  friend base::NoDestructor<SafeDealMemoryBudgetFactory>;
+
+  SafeDealMemoryBudgetFactory();
+  ~SafeDealMemoryBudgetFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_MEMORY_BUDGET_FACTORY_H_
@@ -0,0 +1,27 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_navigation_throttles.h"
+
+#include "safe_deal/browser/safe_deal_activation_throttle.h"
+#include "safe_deal/browser/safe_deal_https_upgrade_throttle.h"
+#include "safe_deal/browser/safe_deal_startup_observer.h"
+#include "safe_deal/browser/shopping_predictor_tab_helper.h"
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+
+namespace safe_deal {
+
+void CreateSafeDealNavigationThrottles(
+    content::NavigationThrottleRegistry& registry) {
+  SafeDealStartupMetrics::Scope scope("CreateSafeDealNavigationThrottles");
+  SafeDealActivationThrottle::MaybeCreateAndAdd(registry);
+  SafeDealHttpsUpgradeThrottle::MaybeCreateAndAdd(registry);
+  // Not a throttle, but needs to see navigations before their requests.
+  ShoppingPredictorTabHelper::MaybeCreateForNavigation(
+      registry.GetNavigationHandle());
+  SafeDealStartupObserver::MaybeCreateForNavigation(
+      registry.GetNavigationHandle());
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,21 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_NAVIGATION_THROTTLES_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_NAVIGATION_THROTTLES_H_
+
+namespace content {
+class NavigationThrottleRegistry;
+}  // namespace content
+
+namespace safe_deal {
+
+// Adds the Safe Deal throttles that apply to the navigation. Called from
+// ChromeContentBrowserClient::CreateThrottlesForNavigation().
+void CreateSafeDealNavigationThrottles(
+    content::NavigationThrottleRegistry& registry);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_NAVIGATION_THROTTLES_H_
@@ -0,0 +1,206 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_PIPELINE_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_PIPELINE_H_
+
+#include <stddef.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "base/check.h"
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/sequence_checker.h"
+#include "base/strings/strcat.h"
+#include "base/task/bind_post_task.h"
+#include "base/task/cancelable_task_tracker.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "safe_deal/browser/safe_deal_task_runner.h"
+
+namespace content {
+class WebContents;
+}  // namespace content
+
+namespace safe_deal {
+
+// One piece of asynchronous work for a tab, written as a pipeline instead of
+// a tree of callbacks. The stages are started on the UI thread and run
+// concurrently wherever the services that serve them live; each hands its
+// result straight to the tab's SafeDealTaskRunner sequence, which merges it
+// into a |State|. Once every stage has reported, the final step builds the
+// result on that sequence too, and only the reply runs on the UI thread.
+//
+//   auto pipeline = std::make_unique<SafeDealPipeline<Totals>>(
+//       web_contents, "PriceCheck");
+//   price_service->GetPrice(id, pipeline->AddStage(base::BindOnce(
+//       [](Totals& totals, int64_t price) { totals.price = price; })));
+//   std::move(*pipeline).Then(base::BindOnce(&Summarize),
+//                             base::BindOnce(&Show, weak_ptr));
+//
+// The pipeline is cancelled when the tab navigates to another page or
+// closes: results that arrive later are not merged, the final step is
+// skipped, and the reply is dropped, so it may refer to objects owned by the
+// tab. Stages can check is_canceled() before doing expensive work. A stage
+// whose callback is destroyed without running stalls the pipeline, which
+// then never replies.
+//
+// Records SafeDeal.TaskRunner.PipelineTime.<name>, from construction to the
+// reply, and SafeDeal.TaskRunner.QueueTime.<lane> for the final step.
+// Constructed, built and consumed on the UI thread.
+template <typename State>
+class SafeDealPipeline {
+ public:
+  SafeDealPipeline(content::WebContents* web_contents, std::string name)
+      : name_(std::move(name)) {
+    SafeDealTaskRunner::CreateForWebContents(web_contents);
+    SafeDealTaskRunner* tab = SafeDealTaskRunner::FromWebContents(web_contents);
+    task_runner_ = tab->task_runner();
+    lane_ = tab->lane();
+    is_canceled_ = tab->NewCancelationFlag();
+    core_ = base::MakeRefCounted<Core>(is_canceled_);
+  }
+  SafeDealPipeline(const SafeDealPipeline&) = delete;
+  SafeDealPipeline& operator=(const SafeDealPipeline&) = delete;
+  ~SafeDealPipeline() = default;
+
+  // Adds a stage and returns the callback it reports its result to, which
+  // may run on any sequence. |merge| runs on the tab's sequence.
+  template <typename T>
+  base::OnceCallback<void(T)> AddStage(
+      base::OnceCallback<void(State&, T)> merge) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    DCHECK(core_);
+    ++stage_count_;
+    return base::BindPostTask(
+        task_runner_, base::BindOnce(&Core::template MergeStage<T>, core_,
+                                     std::move(merge)));
+  }
+
+  // Callable on any sequence.
+  const base::CancelableTaskTracker::IsCanceledCallback& is_canceled() const {
+    return is_canceled_;
+  }
+
+  // Once every stage has reported, runs |finish| with the merged state on the
+  // tab's sequence, then |reply| with its result on the UI thread. |finish|
+  // must not block.
+  template <typename Result>
+  void Then(base::OnceCallback<Result(State)> finish,
+            base::OnceCallback<void(Result)> reply) && {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    DCHECK(core_);
+    auto run_finish = base::BindOnce(
+        [](base::OnceCallback<Result(State)> finish,
+           base::OnceCallback<void(Result)> reply, State state) {
+          std::move(reply).Run(std::move(finish).Run(std::move(state)));
+        },
+        std::move(finish),
+        base::BindPostTask(
+            base::SequencedTaskRunner::GetCurrentDefault(),
+            base::BindOnce(&Reply<Result>, is_canceled_, std::move(name_),
+                           started_, std::move(reply))));
+    task_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&Core::Start, std::move(core_), lane_,
+                       base::TimeTicks::Now(), stage_count_,
+                       std::move(run_finish)));
+  }
+
+ private:
+  // The part of the pipeline that lives on the tab's sequence.
+  class Core : public base::RefCountedThreadSafe<Core> {
+   public:
+    explicit Core(base::CancelableTaskTracker::IsCanceledCallback is_canceled)
+        : is_canceled_(std::move(is_canceled)) {
+      DETACH_FROM_SEQUENCE(sequence_checker_);
+    }
+    Core(const Core&) = delete;
+    Core& operator=(const Core&) = delete;
+
+    template <typename T>
+    void MergeStage(base::OnceCallback<void(State&, T)> merge, T result) {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+      if (!is_canceled_.Run()) {
+        std::move(merge).Run(state_, std::move(result));
+      }
+      ++reported_stages_;
+      MaybeFinish();
+    }
+
+    // Posted after the stages were started, so it may run before or after
+    // any of them reports. How long it waited shows how busy the tab's
+    // sequence was.
+    void Start(SafeDealTaskRunner::Lane lane,
+               base::TimeTicks posted,
+               size_t stage_count,
+               base::OnceCallback<void(State)> finish) {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+      SafeDealTaskRunner::RecordQueueTime(lane,
+                                          base::TimeTicks::Now() - posted);
+      stage_count_ = stage_count;
+      finish_ = std::move(finish);
+      MaybeFinish();
+    }
+
+   private:
+    friend class base::RefCountedThreadSafe<Core>;
+    ~Core() = default;
+
+    void MaybeFinish() {
+      if (!stage_count_ || reported_stages_ < *stage_count_ ||
+          is_canceled_.Run()) {
+        return;
+      }
+      std::move(finish_).Run(std::move(state_));
+    }
+
+    const base::CancelableTaskTracker::IsCanceledCallback is_canceled_;
+    State state_;
+    size_t reported_stages_ = 0;
+    std::optional<size_t> stage_count_;
+    base::OnceCallback<void(State)> finish_;
+
+    SEQUENCE_CHECKER(sequence_checker_);
+  };
+
+  template <typename Result>
+  static void Reply(
+      const base::CancelableTaskTracker::IsCanceledCallback& is_canceled,
+      const std::string& name,
+      base::TimeTicks started,
+      base::OnceCallback<void(Result)> reply,
+      Result result) {
+    // Checked again on the UI thread, where the tab is navigated or closed.
+    if (is_canceled.Run()) {
+      return;
+    }
+    base::UmaHistogramCustomMicrosecondsTimes(
+        base::StrCat({"SafeDeal.TaskRunner.PipelineTime.", name}),
+        base::TimeTicks::Now() - started, base::Microseconds(10),
+        base::Seconds(10), 50);
+    std::move(reply).Run(std::move(result));
+  }
+
+  std::string name_;
+  const base::TimeTicks started_ = base::TimeTicks::Now();
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  // The tab's lane when the pipeline was built.
+  SafeDealTaskRunner::Lane lane_;
+  base::CancelableTaskTracker::IsCanceledCallback is_canceled_;
+  scoped_refptr<Core> core_;
+  size_t stage_count_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_PIPELINE_H_
@@ -0,0 +1,15 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_prefs.h"
+
+#include "components/pref_registry/pref_registry_syncable.h"
+
+namespace safe_deal {
+
+void RegisterSafeDealProfilePrefs(user_prefs::PrefRegistrySyncable* registry) {
+  registry->RegisterBooleanPref(prefs::kLeanShoppingEnabled, false);
+}
+
+}  // namespace safe_deal
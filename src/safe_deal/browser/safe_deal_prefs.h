@@ -0,0 +1,31 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_PREFS_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_PREFS_H_
+
+namespace user_prefs {
+class PrefRegistrySyncable;
+}  // namespace user_prefs
+
+namespace safe_deal {
+
+namespace prefs {
+
+// Whether marketplace pages are loaded with lean shopping, which requests
+// smaller search result images.
+// Only has an effect while features::kSafeDealLeanShopping is enabled.
+inline constexpr char kLeanShoppingEnabled[] = "safe_deal.lean_shopping";
+
+}  // namespace prefs
+
+// Registers the Safe Deal profile preferences. Called by
+// SafeDealExtensionActivatorFactory, which is created by
+// EnsureSafeDealServiceFactoriesBuilt() before the profile prefs are
+// registered.
+void RegisterSafeDealProfilePrefs(user_prefs::PrefRegistrySyncable* registry);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_PREFS_H_
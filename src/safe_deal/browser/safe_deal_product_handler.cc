@@ -0,0 +1,105 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_product_handler.h"
+
+#include <algorithm>
+#include <string>
+
+#include "base/feature_list.h"
+#include "base/functional/bind.h"
+#include "base/time/time.h"
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/render_frame_host.h"
+#include "safe_deal/browser/price_history_service_factory.h"
+#include "safe_deal/browser/price_watch_scheduler_factory.h"
+#include "safe_deal/browser/product_analysis.h"
+#include "safe_deal/browser/product_cache_factory.h"
+#include "safe_deal/browser/product_matching_service_factory.h"
+#include "safe_deal/browser/review_verdict_tab_helper.h"
+#include "safe_deal/common/product_key.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/page_extractor/common/page_extractor.mojom.h"
+#include "safe_deal/price_history/price_history_service.h"
+#include "safe_deal/price_watch/price_watch_scheduler.h"
+#include "safe_deal/product_cache/browser/product_cache.h"
+#include "safe_deal/product_cache/common/product_record.h"
+#include "safe_deal/product_matching/product_matching_service.h"
+
+namespace safe_deal {
+
+namespace {
+
+void PublishPriceComparison(Profile* profile,
+                            mojom::Marketplace marketplace,
+                            const std::string& product_id,
+                            ProductAnalysis analysis) {
+  ProductCache* product_cache = ProductCacheFactory::GetForProfile(profile);
+  if (!product_cache) {
+    return;
+  }
+  const ProductMatch* cheapest_match =
+      analysis.cheapest_match ? &*analysis.cheapest_match : nullptr;
+  product_cache->SetPriceComparison(
+      marketplace, product_id, analysis.lowest_recent_price_micros,
+      cheapest_match ? cheapest_match->marketplace
+                     : mojom::Marketplace::kUnknown,
+      cheapest_match ? cheapest_match->price_micros : -1);
+}
+
+}  // namespace
+
+void HandleExtractedProduct(content::RenderFrameHost* render_frame_host,
+                            const mojom::ProductData& product) {
+  Profile* profile =
+      Profile::FromBrowserContext(render_frame_host->GetBrowserContext());
+  ProductCache* product_cache = ProductCacheFactory::GetForProfile(profile);
+  if (product_cache && !product.product_id.empty()) {
+    ProductRecord record;
+    if (product.price_micros >= 0) {
+      record.price_micros = product.price_micros;
+      record.price_time = base::Time::Now().ToTimeT();
+    }
+    if (!product.seller_id.empty()) {
+      record.seller_key =
+          ComputeSellerKeyHash(product.marketplace, product.seller_id);
+    }
+    record.review_count = product.review_count;
+    record.rating_x100 = product.rating_x100;
+    std::ranges::copy(product.currency_code, record.currency_code);
+    product_cache->Put(product.marketplace, product.product_id, record);
+  }
+  if (product.price_micros >= 0) {
+    if (PriceHistoryService* price_history =
+            PriceHistoryServiceFactory::GetForProfile(profile)) {
+      price_history->RecordPrice(product.marketplace, product.product_id,
+                                 base::Time::Now(), product.price_micros);
+    }
+    if (PriceWatchScheduler* price_watch =
+            PriceWatchSchedulerFactory::GetForProfile(profile)) {
+      price_watch->OnPriceSeen(product.marketplace, product.product_id,
+                               product.price_micros);
+    }
+  }
+  if (base::FeatureList::IsEnabled(features::kSafeDealProductMatching)) {
+    if (ProductMatchingService* product_matching =
+            ProductMatchingServiceFactory::GetForProfile(profile)) {
+      product_matching->AddProduct(product.marketplace, product.product_id,
+                                   product.title, product.price_micros,
+                                   product.currency_code, base::Time::Now());
+    }
+  }
+  ReviewVerdictTabHelper::MaybeScoreReviews(render_frame_host, product);
+  if (product_cache && !product.product_id.empty() &&
+      render_frame_host->IsInPrimaryMainFrame()) {
+    // The reply is dropped when the tab closes, before its profile is
+    // destroyed.
+    AnalyzeProduct(render_frame_host, product,
+                   base::BindOnce(&PublishPriceComparison,
+                                  base::Unretained(profile),
+                                  product.marketplace, product.product_id));
+  }
+}
+
+}  // namespace safe_deal
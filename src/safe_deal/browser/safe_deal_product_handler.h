@@ -0,0 +1,23 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_PRODUCT_HANDLER_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_PRODUCT_HANDLER_H_
+
+#include "safe_deal/page_extractor/common/page_extractor.mojom-forward.h"
+
+namespace content {
+class RenderFrameHost;
+}  // namespace content
+
+namespace safe_deal {
+
+// Fans a product reported by SafeDealPageExtractor out to the profile's Safe
+// Deal services.
+void HandleExtractedProduct(content::RenderFrameHost* render_frame_host,
+                            const mojom::ProductData& product);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_PRODUCT_HANDLER_H_
@@ -0,0 +1,154 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_renderer_updater.h"
+
+#include <memory>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/feature_list.h"
+#include "base/functional/bind.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/prefs/pref_change_registrar.h"
+#include "components/prefs/pref_service.h"
+#include "content/public/browser/render_process_host.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "safe_deal/browser/product_cache_factory.h"
+#include "safe_deal/browser/safe_deal_prefs.h"
+#include "safe_deal/browser/seller_reputation_cache_factory.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/common/safe_deal_renderer.mojom.h"
+#include "safe_deal/product_cache/browser/product_cache.h"
+#include "safe_deal/seller_reputation/browser/seller_reputation_cache.h"
+
+namespace safe_deal {
+
+namespace {
+
+SafeDealRendererUpdater* g_renderer_updater = nullptr;
+
+mojo::Remote<mojom::SafeDealRendererConfiguration> BindConfiguration(
+    content::RenderProcessHost* host) {
+  mojo::Remote<mojom::SafeDealRendererConfiguration> configuration;
+  host->BindReceiver(configuration.BindNewPipeAndPassReceiver());
+  return configuration;
+}
+
+}  // namespace
+
+SafeDealRendererUpdater::SafeDealRendererUpdater()
+    : url_filter_ruleset_service_(
+          url_filter::UrlFilterRulesetService::GetDefaultRulesetPath()) {
+  DCHECK(!g_renderer_updater);
+  g_renderer_updater = this;
+  // Unretained is safe: the service is owned by this object.
+  url_filter_ruleset_service_.Load(
+      base::BindOnce(&SafeDealRendererUpdater::OnUrlFilterRulesetReady,
+                     base::Unretained(this)));
+}
+
+SafeDealRendererUpdater::~SafeDealRendererUpdater() {
+  DCHECK_EQ(g_renderer_updater, this);
+  g_renderer_updater = nullptr;
+}
+
+// static
+SafeDealRendererUpdater* SafeDealRendererUpdater::Get() {
+  return g_renderer_updater;
+}
+
+void SafeDealRendererUpdater::OnRenderProcessHostCreated(
+    content::RenderProcessHost* host) {
+  if (url_filter_ruleset_service_.is_ready()) {
+    SendUrlFilterRuleset(host);
+  }
+  SendSellerReputationTable(host);
+  SendProductTable(host);
+  SendLeanShoppingEnabled(host);
+}
+
+void SafeDealRendererUpdater::OnProfileWillBeDestroyed(Profile* profile) {
+  profile_observations_.RemoveObservation(profile);
+  lean_shopping_registrars_.erase(profile);
+}
+
+void SafeDealRendererUpdater::OnUrlFilterRulesetReady() {
+  for (auto it = content::RenderProcessHost::AllHostsIterator(); !it.IsAtEnd();
+       it.Advance()) {
+    content::RenderProcessHost* host = it.GetCurrentValue();
+    if (host->IsInitializedAndNotDead()) {
+      SendUrlFilterRuleset(host);
+    }
+  }
+}
+
+void SafeDealRendererUpdater::SendUrlFilterRuleset(
+    content::RenderProcessHost* host) {
+  base::File file = url_filter_ruleset_service_.DuplicateRulesetFile();
+  if (file.IsValid()) {
+    BindConfiguration(host)->SetUrlFilterRuleset(std::move(file));
+  }
+}
+
+void SafeDealRendererUpdater::SendSellerReputationTable(
+    content::RenderProcessHost* host) {
+  SellerReputationCache* cache = SellerReputationCacheFactory::GetForProfile(
+      Profile::FromBrowserContext(host->GetBrowserContext()));
+  if (!cache) {
+    return;
+  }
+  base::ReadOnlySharedMemoryRegion table = cache->DuplicateTableRegion();
+  if (table.IsValid()) {
+    BindConfiguration(host)->SetSellerReputationTable(std::move(table));
+  }
+}
+
+void SafeDealRendererUpdater::SendProductTable(
+    content::RenderProcessHost* host) {
+  ProductCache* cache = ProductCacheFactory::GetForProfile(
+      Profile::FromBrowserContext(host->GetBrowserContext()));
+  if (!cache) {
+    return;
+  }
+  base::ReadOnlySharedMemoryRegion table = cache->DuplicateTableRegion();
+  if (table.IsValid()) {
+    BindConfiguration(host)->SetProductTable(std::move(table));
+  }
+}
+
+void SafeDealRendererUpdater::SendLeanShoppingEnabled(
+    content::RenderProcessHost* host) {
+  if (!base::FeatureList::IsEnabled(features::kSafeDealLeanShopping)) {
+    return;
+  }
+  Profile* profile = Profile::FromBrowserContext(host->GetBrowserContext());
+  if (!lean_shopping_registrars_.contains(profile)) {
+    auto registrar = std::make_unique<PrefChangeRegistrar>();
+    registrar->Init(profile->GetPrefs());
+    // Unretained is safe: the registrar is owned by this object and is
+    // destroyed before the profile.
+    registrar->Add(
+        prefs::kLeanShoppingEnabled,
+        base::BindRepeating(&SafeDealRendererUpdater::OnLeanShoppingPrefChanged,
+                            base::Unretained(this), profile));
+    lean_shopping_registrars_.emplace(profile, std::move(registrar));
+    profile_observations_.AddObservation(profile);
+  }
+  BindConfiguration(host)->SetLeanShoppingEnabled(
+      profile->GetPrefs()->GetBoolean(prefs::kLeanShoppingEnabled));
+}
+
+void SafeDealRendererUpdater::OnLeanShoppingPrefChanged(Profile* profile) {
+  for (auto it = content::RenderProcessHost::AllHostsIterator(); !it.IsAtEnd();
+       it.Advance()) {
+    content::RenderProcessHost* host = it.GetCurrentValue();
+    if (host->IsInitializedAndNotDead() &&
+        Profile::FromBrowserContext(host->GetBrowserContext()) == profile) {
+      SendLeanShoppingEnabled(host);
+    }
+  }
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,78 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_RENDERER_UPDATER_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_RENDERER_UPDATER_H_
+
+#include <stddef.h>
+
+#include <map>
+#include <memory>
+
+#include "base/scoped_multi_source_observation.h"
+#include "chrome/browser/profiles/profile_observer.h"
+#include "content/public/browser/render_process_host_creation_observer.h"
+#include "safe_deal/url_filter/browser/url_filter_ruleset_service.h"
+
+class PrefChangeRegistrar;
+class Profile;
+
+namespace content {
+class RenderProcessHost;
+}  // namespace content
+
+namespace safe_deal {
+
+// Pushes process-wide Safe Deal data to every renderer process through
+// mojom::SafeDealRendererConfiguration: to new processes when they are
+// created, and to all existing ones when the data becomes available. Data
+// that is per profile, like the seller reputation table, is taken from the
+// profile of the process, and per-profile settings are sent again to the
+// processes of the profile when they change.
+// Created once per browser run on the UI thread.
+class SafeDealRendererUpdater
+    : public content::RenderProcessHostCreationObserver,
+      public ProfileObserver {
+ public:
+  SafeDealRendererUpdater();
+  SafeDealRendererUpdater(const SafeDealRendererUpdater&) = delete;
+  SafeDealRendererUpdater& operator=(const SafeDealRendererUpdater&) = delete;
+  ~SafeDealRendererUpdater() override;
+
+  // Returns the instance of this browser run, or null before it is created
+  // and after shutdown.
+  static SafeDealRendererUpdater* Get();
+
+  // Size of the URL filter ruleset each renderer maps, 0 until it is loaded.
+  size_t url_filter_ruleset_size() const {
+    return url_filter_ruleset_service_.ruleset_size();
+  }
+
+  // content::RenderProcessHostCreationObserver:
+  void OnRenderProcessHostCreated(content::RenderProcessHost* host) override;
+
+  // ProfileObserver:
+  void OnProfileWillBeDestroyed(Profile* profile) override;
+
+ private:
+  void OnUrlFilterRulesetReady();
+  void SendUrlFilterRuleset(content::RenderProcessHost* host);
+  void SendSellerReputationTable(content::RenderProcessHost* host);
+  void SendProductTable(content::RenderProcessHost* host);
+  void SendLeanShoppingEnabled(content::RenderProcessHost* host);
+  void OnLeanShoppingPrefChanged(Profile* profile);
+
+  url_filter::UrlFilterRulesetService url_filter_ruleset_service_;
+
+  // Registrars watching the lean shopping setting of each profile that has had
+  // a render process, so that its processes get the new value.
+  std::map<Profile*, std::unique_ptr<PrefChangeRegistrar>>
+      lean_shopping_registrars_;
+  base::ScopedMultiSourceObservation<Profile, ProfileObserver>
+      profile_observations_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_RENDERER_UPDATER_H_
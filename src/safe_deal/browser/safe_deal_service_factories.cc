@@ -0,0 +1,35 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_service_factories.h"
+
+#include "safe_deal/browser/https_upgrade_service_factory.h"
+#include "safe_deal/browser/price_history_service_factory.h"
+#include "safe_deal/browser/price_watch_scheduler_factory.h"
+#include "safe_deal/browser/product_cache_factory.h"
+#include "safe_deal/browser/product_matching_service_factory.h"
+#include "safe_deal/browser/safe_deal_extension_activator_factory.h"
+#include "safe_deal/browser/safe_deal_memory_budget_factory.h"
+#include "safe_deal/browser/seller_reputation_cache_factory.h"
+#include "safe_deal/browser/shopping_predictor_service_factory.h"
+#include "safe_deal/browser/string_interner_factory.h"
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+
+namespace safe_deal {
+
+void EnsureSafeDealServiceFactoriesBuilt() {
+  SafeDealStartupMetrics::Scope scope("EnsureSafeDealServiceFactoriesBuilt");
+  HttpsUpgradeServiceFactory::GetInstance();
+  PriceHistoryServiceFactory::GetInstance();
+  PriceWatchSchedulerFactory::GetInstance();
+  ProductCacheFactory::GetInstance();
+  ProductMatchingServiceFactory::GetInstance();
+  SafeDealExtensionActivatorFactory::GetInstance();
+  SafeDealMemoryBudgetFactory::GetInstance();
+  SellerReputationCacheFactory::GetInstance();
+  ShoppingPredictorServiceFactory::GetInstance();
+  StringInternerFactory::GetInstance();
+}
+
+}  // namespace safe_deal
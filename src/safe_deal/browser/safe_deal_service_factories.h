@@ -0,0 +1,17 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_SERVICE_FACTORIES_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_SERVICE_FACTORIES_H_
+
+namespace safe_deal {
+
+// Instantiates the keyed service factories of all Safe Deal components.
+// Called from ChromeBrowserMainExtraPartsProfiles::
+// EnsureBrowserContextKeyedServiceFactoriesBuilt().
+void EnsureSafeDealServiceFactoriesBuilt();
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_SERVICE_FACTORIES_H_
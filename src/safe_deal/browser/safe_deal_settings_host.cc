@@ -0,0 +1,61 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_settings_host.h"
+
+#include <utility>
+
+#include "base/feature_list.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/prefs/pref_service.h"
+#include "content/public/browser/render_frame_host.h"
+#include "safe_deal/browser/safe_deal_component_extension.h"
+#include "safe_deal/browser/safe_deal_prefs.h"
+#include "safe_deal/common/safe_deal_features.h"
+
+namespace safe_deal {
+
+DOCUMENT_USER_DATA_KEY_IMPL(SafeDealSettingsHost);
+
+SafeDealSettingsHost::SafeDealSettingsHost(
+    content::RenderFrameHost* render_frame_host)
+    : DocumentUserData(render_frame_host) {}
+
+SafeDealSettingsHost::~SafeDealSettingsHost() = default;
+
+// static
+void SafeDealSettingsHost::BindReceiver(
+    content::RenderFrameHost* render_frame_host,
+    mojo::PendingReceiver<mojom::SafeDealSettingsHost> receiver) {
+  // Only the extension's own pages may change settings; marketplace pages
+  // and other extensions never get the interface.
+  if (!IsSafeDealExtensionDocument(render_frame_host)) {
+    return;
+  }
+  SafeDealSettingsHost* host =
+      GetOrCreateForCurrentDocument(render_frame_host);
+  host->receiver_.reset();
+  host->receiver_.Bind(std::move(receiver));
+}
+
+void SafeDealSettingsHost::GetSettings(GetSettingsCallback callback) {
+  std::move(callback).Run(mojom::SafeDealSettings::New(
+      base::FeatureList::IsEnabled(features::kSafeDealLeanShopping),
+      GetPrefs()->GetBoolean(prefs::kLeanShoppingEnabled)));
+}
+
+void SafeDealSettingsHost::SetLeanShopping(
+    bool enabled,
+    SetLeanShoppingCallback callback) {
+  // SafeDealRendererUpdater sends the change on to the renderers.
+  GetPrefs()->SetBoolean(prefs::kLeanShoppingEnabled, enabled);
+  std::move(callback).Run();
+}
+
+PrefService* SafeDealSettingsHost::GetPrefs() {
+  return Profile::FromBrowserContext(render_frame_host().GetBrowserContext())
+      ->GetPrefs();
+}
+
+}  // namespace safe_deal
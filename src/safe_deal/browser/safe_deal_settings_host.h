@@ -0,0 +1,57 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_SETTINGS_HOST_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_SETTINGS_HOST_H_
+
+#include "content/public/browser/document_user_data.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/receiver.h"
+#include "safe_deal/common/safe_deal_settings.mojom.h"
+
+class PrefService;
+
+namespace content {
+class RenderFrameHost;
+}  // namespace content
+
+namespace safe_deal {
+
+// Browser side of the safeDealSettings global of the Safe Deal extension's
+// pages (see SafeDealSettingsBindings), through which the shopping assistant
+// settings UI reads and changes the profile's Safe Deal prefs.
+class SafeDealSettingsHost
+    : public content::DocumentUserData<SafeDealSettingsHost>,
+      public mojom::SafeDealSettingsHost {
+ public:
+  SafeDealSettingsHost(const SafeDealSettingsHost&) = delete;
+  SafeDealSettingsHost& operator=(const SafeDealSettingsHost&) = delete;
+  ~SafeDealSettingsHost() override;
+
+  // Binds |receiver| for the current document of |render_frame_host|.
+  // Requests from documents of anything but the Safe Deal component
+  // extension are dropped.
+  static void BindReceiver(
+      content::RenderFrameHost* render_frame_host,
+      mojo::PendingReceiver<mojom::SafeDealSettingsHost> receiver);
+
+  // mojom::SafeDealSettingsHost:
+  void GetSettings(GetSettingsCallback callback) override;
+  void SetLeanShopping(bool enabled,
+                       SetLeanShoppingCallback callback) override;
+
+ private:
+  friend DocumentUserData;
+  DOCUMENT_USER_DATA_KEY_DECL();
+
+  explicit SafeDealSettingsHost(content::RenderFrameHost* render_frame_host);
+
+  PrefService* GetPrefs();
+
+  mojo::Receiver<mojom::SafeDealSettingsHost> receiver_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_SETTINGS_HOST_H_
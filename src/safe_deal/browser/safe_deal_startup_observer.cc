@@ -0,0 +1,38 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_startup_observer.h"
+
+#include "content/public/browser/navigation_handle.h"
+#include "content/public/browser/web_contents.h"
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+
+namespace safe_deal {
+
+// static
+void SafeDealStartupObserver::MaybeCreateForNavigation(
+    content::NavigationHandle& handle) {
+  if (!SafeDealStartupMetrics::GetInstance().is_counting() ||
+      !handle.IsInPrimaryMainFrame()) {
+    return;
+  }
+  CreateForWebContents(handle.GetWebContents());
+}
+
+SafeDealStartupObserver::SafeDealStartupObserver(
+    content::WebContents* web_contents)
+    : content::WebContentsObserver(web_contents),
+      content::WebContentsUserData<SafeDealStartupObserver>(*web_contents) {}
+
+SafeDealStartupObserver::~SafeDealStartupObserver() = default;
+
+void SafeDealStartupObserver::DidFirstVisuallyNonEmptyPaint() {
+  SafeDealStartupMetrics::GetInstance().RecordFirstPaint();
+  // Deletes |this|.
+  web_contents()->RemoveUserData(UserDataKey());
+}
+
+WEB_CONTENTS_USER_DATA_KEY_IMPL(SafeDealStartupObserver);
+
+}  // namespace safe_deal
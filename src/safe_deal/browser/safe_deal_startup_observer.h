@@ -0,0 +1,43 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_STARTUP_OBSERVER_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_STARTUP_OBSERVER_H_
+
+#include "content/public/browser/web_contents_observer.h"
+#include "content/public/browser/web_contents_user_data.h"
+
+namespace content {
+class NavigationHandle;
+}  // namespace content
+
+namespace safe_deal {
+
+// Ends SafeDealStartupMetrics at the first paint of the first tab that
+// navigates, which is what tools/bench/startup_perftest.mjs waits for.
+class SafeDealStartupObserver
+    : public content::WebContentsObserver,
+      public content::WebContentsUserData<SafeDealStartupObserver> {
+ public:
+  // Observes the tab of |handle| if the startup metrics are still counting.
+  static void MaybeCreateForNavigation(content::NavigationHandle& handle);
+
+  SafeDealStartupObserver(const SafeDealStartupObserver&) = delete;
+  SafeDealStartupObserver& operator=(const SafeDealStartupObserver&) = delete;
+  ~SafeDealStartupObserver() override;
+
+  // content::WebContentsObserver:
+  void DidFirstVisuallyNonEmptyPaint() override;
+
+ private:
+  friend class content::WebContentsUserData<SafeDealStartupObserver>;
+
+  explicit SafeDealStartupObserver(content::WebContents* web_contents);
+
+  WEB_CONTENTS_USER_DATA_KEY_DECL();
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_STARTUP_OBSERVER_H_
@@ -0,0 +1,86 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_task_runner.h"
+
+#include "base/metrics/histogram_functions.h"
+#include "base/strings/strcat.h"
+#include "base/task/thread_pool.h"
+#include "content/public/browser/visibility.h"
+#include "content/public/browser/web_contents.h"
+
+namespace safe_deal {
+
+namespace {
+
+const char* GetLaneSuffix(SafeDealTaskRunner::Lane lane) {
+  switch (lane) {
+    case SafeDealTaskRunner::Lane::kForegroundTab:
+      return "Foreground";
+    case SafeDealTaskRunner::Lane::kBackgroundTab:
+      return "Background";
+  }
+}
+
+base::TaskPriority GetTaskPriority(SafeDealTaskRunner::Lane lane) {
+  switch (lane) {
+    case SafeDealTaskRunner::Lane::kForegroundTab:
+      return base::TaskPriority::USER_BLOCKING;
+    case SafeDealTaskRunner::Lane::kBackgroundTab:
+      return base::TaskPriority::USER_VISIBLE;
+  }
+}
+
+SafeDealTaskRunner::Lane GetTabLane(content::Visibility visibility) {
+  // An occluded tab may still be partly on screen, but the user is not
+  // looking at it.
+  return visibility == content::Visibility::VISIBLE
+             ? SafeDealTaskRunner::Lane::kForegroundTab
+             : SafeDealTaskRunner::Lane::kBackgroundTab;
+}
+
+}  // namespace
+
+SafeDealTaskRunner::SafeDealTaskRunner(content::WebContents* web_contents)
+    : content::WebContentsObserver(web_contents),
+      content::WebContentsUserData<SafeDealTaskRunner>(*web_contents),
+      lane_(GetTabLane(web_contents->GetVisibility())),
+      // Work that has not started is useless once the browser shuts down.
+      task_runner_(base::ThreadPool::CreateUpdateableSequencedTaskRunner(
+          {GetTaskPriority(lane_),
+           base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN})) {}
+
+SafeDealTaskRunner::~SafeDealTaskRunner() = default;
+
+// static
+void SafeDealTaskRunner::RecordQueueTime(Lane lane,
+                                         base::TimeDelta queue_time) {
+  base::UmaHistogramCustomMicrosecondsTimes(
+      base::StrCat({"SafeDeal.TaskRunner.QueueTime.", GetLaneSuffix(lane)}),
+      queue_time, base::Microseconds(10), base::Seconds(10), 50);
+}
+
+base::CancelableTaskTracker::IsCanceledCallback
+SafeDealTaskRunner::NewCancelationFlag() {
+  base::CancelableTaskTracker::IsCanceledCallback is_canceled;
+  task_tracker_.NewTrackedTaskId(&is_canceled);
+  return is_canceled;
+}
+
+void SafeDealTaskRunner::OnVisibilityChanged(content::Visibility visibility) {
+  Lane lane = GetTabLane(visibility);
+  if (lane == lane_) {
+    return;
+  }
+  lane_ = lane;
+  task_runner_->UpdatePriority(GetTaskPriority(lane_));
+}
+
+void SafeDealTaskRunner::PrimaryPageChanged(content::Page& page) {
+  task_tracker_.TryCancelAll();
+}
+
+WEB_CONTENTS_USER_DATA_KEY_IMPL(SafeDealTaskRunner);
+
+}  // namespace safe_deal
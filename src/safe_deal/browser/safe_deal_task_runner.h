@@ -0,0 +1,72 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_TASK_RUNNER_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_TASK_RUNNER_H_
+
+#include "base/memory/scoped_refptr.h"
+#include "base/task/cancelable_task_tracker.h"
+#include "base/task/updateable_sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "content/public/browser/web_contents_observer.h"
+#include "content/public/browser/web_contents_user_data.h"
+
+namespace safe_deal {
+
+// The thread pool sequence the Safe Deal analysis of one tab runs on, off
+// the UI thread; SafeDealPipeline posts its work there. The sequence of the
+// visible tab runs at USER_BLOCKING priority and those of hidden tabs at
+// USER_VISIBLE, and a tab's queued work moves between the two when it is
+// shown or hidden, so the thread pool never runs background work while
+// foreground work is waiting. A tab's work runs in order, one task at a
+// time; the work of different tabs runs in parallel. UI thread only.
+class SafeDealTaskRunner
+    : public content::WebContentsObserver,
+      public content::WebContentsUserData<SafeDealTaskRunner> {
+ public:
+  enum class Lane {
+    kForegroundTab,
+    kBackgroundTab,
+  };
+
+  SafeDealTaskRunner(const SafeDealTaskRunner&) = delete;
+  SafeDealTaskRunner& operator=(const SafeDealTaskRunner&) = delete;
+  ~SafeDealTaskRunner() override;
+
+  // Records SafeDeal.TaskRunner.QueueTime.<lane>, the time work posted to
+  // a tab's sequence while it was in |lane| waited to run. Callable on any
+  // sequence.
+  static void RecordQueueTime(Lane lane, base::TimeDelta queue_time);
+
+  Lane lane() const { return lane_; }
+
+  // The sequence the tab's jobs run on, for work that continues there from
+  // other sequences. See SafeDealPipeline.
+  scoped_refptr<base::SequencedTaskRunner> task_runner() const {
+    return task_runner_;
+  }
+
+  // Returns a flag, callable on any sequence, that turns true when the tab
+  // navigates to another page or closes.
+  base::CancelableTaskTracker::IsCanceledCallback NewCancelationFlag();
+
+  // content::WebContentsObserver:
+  void OnVisibilityChanged(content::Visibility visibility) override;
+  void PrimaryPageChanged(content::Page& page) override;
+
+ private:
+  friend class content::WebContentsUserData<SafeDealTaskRunner>;
+
+  explicit SafeDealTaskRunner(content::WebContents* web_contents);
+
+  Lane lane_;
+  scoped_refptr<base::UpdateableSequencedTaskRunner> task_runner_;
+  base::CancelableTaskTracker task_tracker_;
+
+  WEB_CONTENTS_USER_DATA_KEY_DECL();
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_TASK_RUNNER_H_
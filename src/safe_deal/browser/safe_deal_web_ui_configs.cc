@@ -0,0 +1,19 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/safe_deal_web_ui_configs.h"
+
+#include <memory>
+
+#include "content/public/browser/webui_config_map.h"
+#include "safe_deal/browser/safe_deal_internals_ui.h"
+
+namespace safe_deal {
+
+void RegisterSafeDealWebUIConfigs() {
+  content::WebUIConfigMap::GetInstance().AddWebUIConfig(
+      std::make_unique<SafeDealInternalsUIConfig>());
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,16 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SAFE_DEAL_WEB_UI_CONFIGS_H_
+#define SAFE_DEAL_BROWSER_SAFE_DEAL_WEB_UI_CONFIGS_H_
+
+namespace safe_deal {
+
+// Registers the Safe Deal chrome:// pages. Called from
+// RegisterChromeWebUIConfigs().
+void RegisterSafeDealWebUIConfigs();
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SAFE_DEAL_WEB_UI_CONFIGS_H_
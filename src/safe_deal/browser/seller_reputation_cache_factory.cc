@@ -0,0 +1,52 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/seller_reputation_cache_factory.h"
+
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/storage_partition.h"
+#include "safe_deal/browser/safe_deal_memory_budget_factory.h"
+#include "safe_deal/browser/string_interner_factory.h"
+#include "safe_deal/seller_reputation/browser/seller_reputation_api_fetcher.h"
+#include "safe_deal/seller_reputation/browser/seller_reputation_cache.h"
+
+namespace safe_deal {
+
+// static
+SellerReputationCache* SellerReputationCacheFactory::GetForProfile(
+    Profile* profile) {
+  return static_cast<SellerReputationCache*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+}
+
+// static
+SellerReputationCacheFactory* SellerReputationCacheFactory::GetInstance() {
+  static base::NoDestructor<SellerReputationCacheFactory> instance;
+  return instance.get();
+}
+
+SellerReputationCacheFactory::SellerReputationCacheFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealSellerReputationCache",
+          ProfileSelections::BuildForRegularAndIncognito()) {
+  DependsOn(SafeDealMemoryBudgetFactory::GetInstance());
+  DependsOn(StringInternerFactory::GetInstance());
+}
+
+SellerReputationCacheFactory::~SellerReputationCacheFactory() = default;
+
+std::unique_ptr<KeyedService>
+SellerReputationCacheFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  Profile* profile = Profile::FromBrowserContext(context);
+  return std::make_unique<SellerReputationCache>(
+      std::make_unique<SellerReputationApiFetcher>(
+          context->GetDefaultStoragePartition()
+              ->GetURLLoaderFactoryForBrowserProcess()),
+      StringInternerFactory::GetForProfile(profile),
+      SafeDealMemoryBudgetFactory::GetForProfile(profile));
+}
+
+}  // namespace safe_deal
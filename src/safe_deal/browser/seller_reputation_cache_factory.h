@@ -0,0 +1,44 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SELLER_REPUTATION_CACHE_FACTORY_H_
+#define SAFE_DEAL_BROWSER_SELLER_REPUTATION_CACHE_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace safe_deal {
+
+class SellerReputationCache;
+
+// Creates the SellerReputationCache of regular and incognito profiles. Each
+// incognito profile gets its own cache so lookups do not leak into the
+// regular profile's renderers.
+class SellerReputationCacheFactory : public ProfileKeyedServiceFactory {
+ public:
+  static SellerReputationCache* GetForProfile(Profile* profile);
+  static SellerReputationCacheFactory* GetInstance();
+
+  SellerReputationCacheFactory(const SellerReputationCacheFactory&) = delete;
+  SellerReputationCacheFactory& operator=(
+      const SellerReputationCacheFactory&) = delete;
+
+ private:
+  friend base::NoDestructor<SellerReputationCacheFactory>;
+
+  SellerReputationCacheFactory();
+  ~SellerReputationCacheFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SELLER_REPUTATION_CACHE_FACTORY_H_
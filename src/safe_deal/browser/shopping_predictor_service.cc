@@ -0,0 +1,205 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/shopping_predictor_service.h"
+
+#include <utility>
+#include <vector>
+
+#include "chrome/browser/predictors/loading_predictor.h"
+#include "chrome/browser/predictors/preconnect_manager.h"
+#include "chrome/browser/preloading/preloading_prefs.h"
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/preloading.h"
+#include "content/public/browser/web_contents.h"
+#include "extensions/common/extension.h"
+#include "net/base/network_anonymization_key.h"
+#include "net/base/schemeful_site.h"
+#include "net/traffic_annotation/network_traffic_annotation.h"
+#include "safe_deal/api/safe_deal_api.h"
+#include "safe_deal/browser/safe_deal_extension_activator.h"
+#include "safe_deal/browser/safe_deal_extension_activator_factory.h"
+#include "safe_deal/browser/shopping_predictor_tab_helper.h"
+#include "safe_deal/common/marketplace_origin_matcher.h"
+#include "safe_deal/common/safe_deal_constants.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/shopping_predictor/core/shopping_page_type.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+#include "url/url_constants.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Links past this rank of NavigationPredictor's ranking are rarely clicked.
+constexpr size_t kMaxRankedLinks = 20;
+
+// Prerenders start on hover, and Chrome keeps two of them at a time.
+constexpr size_t kMaxPrerenderCandidates = 2;
+
+// Prefetches start right away, so they are limited to fewer links.
+constexpr size_t kMaxPrefetchCandidates = 2;
+
+// Search pages load dozens of images from each CDN.
+constexpr int kImageOriginSockets = 2;
+
+constexpr net::NetworkTrafficAnnotationTag kTrafficAnnotation =
+    net::DefineNetworkTrafficAnnotation("safe_deal_shopping_preconnect", R"(
+        semantics {
+          sender: "Safe Deal Shopping Predictor"
+          description:
+            "Opens connections to the image servers of a marketplace and to "
+            "the Safe Deal API while a marketplace page is loading, so the "
+            "page's images and the shopping assistant's requests do not wait "
+            "for a connection."
+          trigger:
+            "Navigating to a page of a supported marketplace."
+          data: "None. Only connections are opened."
+          destination: OTHER
+          destination_other:
+            "The image servers of the marketplace and the Safe Deal API."
+        }
+        policy {
+          cookies_allowed: NO
+          setting:
+            "Disabling 'Preload pages for faster browsing and searching' in "
+            "the performance settings."
+          policy_exception_justification: "Not implemented."
+        })");
+
+GURL RemoveRef(const GURL& url) {
+  GURL::Replacements replacements;
+  replacements.ClearRef();
+  return url.ReplaceComponents(replacements);
+}
+
+}  // namespace
+
+ShoppingPredictorService::ShoppingPredictorService(
+    Profile* profile,
+    NavigationPredictorKeyedService* navigation_predictor,
+    predictors::LoadingPredictor* loading_predictor)
+    : profile_(profile), loading_predictor_(loading_predictor) {
+  if (navigation_predictor) {
+    navigation_predictor_observation_.Observe(navigation_predictor);
+  }
+}
+
+ShoppingPredictorService::~ShoppingPredictorService() = default;
+
+void ShoppingPredictorService::OnMarketplaceNavigationStarting(
+    mojom::Marketplace marketplace,
+    const GURL& url) {
+  if (!loading_predictor_ || !IsPreloadingEnabled()) {
+    return;
+  }
+  const MarketplaceInfo* info = GetMarketplaceInfo(marketplace);
+  if (!info) {
+    return;
+  }
+  // Connections are only reused by requests with the same key: the page's
+  // site for its images, the extension's for the Safe Deal API.
+  const auto page_key =
+      net::NetworkAnonymizationKey::CreateSameSite(net::SchemefulSite(url));
+  std::vector<predictors::PreconnectRequest> requests;
+  for (const char* origin : info->image_origins) {
+    requests.emplace_back(url::Origin::Create(GURL(origin)),
+                          kImageOriginSockets, page_key);
+  }
+  SafeDealExtensionActivator* activator =
+      SafeDealExtensionActivatorFactory::GetForProfile(profile_);
+  if (activator && !activator->extension_id().empty()) {
+    requests.emplace_back(
+        url::Origin::Create(GetSafeDealApiUrl("")), /*num_sockets=*/1,
+        net::NetworkAnonymizationKey::CreateSameSite(net::SchemefulSite(
+            extensions::Extension::GetBaseURLFromExtensionId(
+                activator->extension_id()))));
+  }
+  loading_predictor_->preconnect_manager()->Start(url, std::move(requests),
+                                                  kTrafficAnnotation);
+}
+
+void ShoppingPredictorService::Shutdown() {
+  navigation_predictor_observation_.Reset();
+  loading_predictor_ = nullptr;
+}
+
+void ShoppingPredictorService::OnPredictionUpdated(
+    const NavigationPredictorKeyedService::Prediction& prediction) {
+  if (prediction.prediction_source() !=
+          NavigationPredictorKeyedService::PredictionSource::
+              kAnchorElementsParsedFromWebPage ||
+      !prediction.web_contents() || !prediction.source_document_url()) {
+    return;
+  }
+  const GURL& source = *prediction.source_document_url();
+  // The tab helper exists for tabs on a marketplace. A prediction for a page
+  // the tab has since left is stale.
+  auto* tab_helper =
+      ShoppingPredictorTabHelper::FromWebContents(prediction.web_contents());
+  if (!tab_helper ||
+      prediction.web_contents()->GetLastCommittedURL() != source ||
+      !source.SchemeIs(url::kHttpsScheme)) {
+    return;
+  }
+  mojom::Marketplace marketplace =
+      MarketplaceOriginMatcher::GetInstance().Match(source);
+  if (marketplace == mojom::Marketplace::kUnknown || !IsPreloadingEnabled()) {
+    return;
+  }
+
+  const ShoppingPageType from = ClassifyShoppingPage(marketplace, source);
+  const net::SchemefulSite source_site(source);
+  const GURL source_without_ref = RemoveRef(source);
+  const double prerender_threshold =
+      features::kShoppingPredictorPrerenderThreshold.Get();
+  const double prefetch_threshold =
+      features::kShoppingPredictorPrefetchThreshold.Get();
+  std::vector<GURL> prerender;
+  std::vector<GURL> prefetch;
+  size_t rank = 0;
+  for (const GURL& url : prediction.sorted_predicted_urls()) {
+    if (rank++ == kMaxRankedLinks) {
+      break;
+    }
+    // Chrome only prerenders same-site pages, and prefetching other sites
+    // would tell them about the user's browsing.
+    if (!url.SchemeIs(url::kHttpsScheme) ||
+        net::SchemefulSite(url) != source_site ||
+        RemoveRef(url) == source_without_ref) {
+      continue;
+    }
+    const ShoppingPageType to = ClassifyShoppingPage(marketplace, url);
+    if (to == ShoppingPageType::kOther) {
+      continue;
+    }
+    const double probability = model_.GetProbability(marketplace, from, to);
+    if (probability >= prerender_threshold &&
+        prerender.size() < kMaxPrerenderCandidates) {
+      prerender.push_back(url);
+    } else if (probability >= prefetch_threshold &&
+               prefetch.size() < kMaxPrefetchCandidates) {
+      prefetch.push_back(url);
+    }
+  }
+
+  // The LoadingPredictor knows which origins the pages of the marketplace
+  // load from, so the likeliest page can connect to them before it is
+  // prerendered.
+  if (loading_predictor_ && !prerender.empty()) {
+    loading_predictor_->PrepareForPageLoad(
+        url::Origin::Create(source), prerender.front(),
+        predictors::HintOrigin::NAVIGATION_PREDICTOR,
+        /*preconnectable=*/true);
+  }
+  tab_helper->SetCandidates(std::move(prerender), std::move(prefetch));
+}
+
+bool ShoppingPredictorService::IsPreloadingEnabled() const {
+  return prefetch::IsSomePreloadingEnabled(*profile_->GetPrefs()) ==
+         content::PreloadingEligibility::kEligible;
+}
+
+}  // namespace safe_deal
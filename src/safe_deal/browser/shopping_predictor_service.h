@@ -0,0 +1,76 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SHOPPING_PREDICTOR_SERVICE_H_
+#define SAFE_DEAL_BROWSER_SHOPPING_PREDICTOR_SERVICE_H_
+
+#include "base/memory/raw_ptr.h"
+#include "base/scoped_observation.h"
+#include "chrome/browser/navigation_predictor/navigation_predictor_keyed_service.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/shopping_predictor/core/shopping_transition_model.h"
+
+class GURL;
+class Profile;
+
+namespace predictors {
+class LoadingPredictor;
+}  // namespace predictors
+
+namespace safe_deal {
+
+// Speculates on the next page of the profile's shopping sessions. Chrome's
+// NavigationPredictor ranks the links of every page by how likely the user
+// is to click them; for marketplace pages, this reranks them with a
+// ShoppingTransitionModel of the profile's own sessions and hands the best
+// to the page as speculation rules (see ShoppingPredictorTabHelper). Links
+// to pages the model does not know, like carts or sign-in pages, are never
+// speculated on. Marketplace navigations also preconnect, through Chrome's
+// LoadingPredictor, to the marketplace's image CDNs and to the Safe Deal
+// API, which the page and the extension need before their first request
+// could open a connection. Nothing is speculated on when the user turned
+// preloading off. UI thread only.
+class ShoppingPredictorService
+    : public KeyedService,
+      public NavigationPredictorKeyedService::Observer {
+ public:
+  ShoppingPredictorService(
+      Profile* profile,
+      NavigationPredictorKeyedService* navigation_predictor,
+      predictors::LoadingPredictor* loading_predictor);
+  ShoppingPredictorService(const ShoppingPredictorService&) = delete;
+  ShoppingPredictorService& operator=(const ShoppingPredictorService&) =
+      delete;
+  ~ShoppingPredictorService() override;
+
+  // Called when a primary main frame navigation to a page of |marketplace|
+  // starts.
+  void OnMarketplaceNavigationStarting(mojom::Marketplace marketplace,
+                                       const GURL& url);
+
+  ShoppingTransitionModel& model() { return model_; }
+
+  // KeyedService:
+  void Shutdown() override;
+
+  // NavigationPredictorKeyedService::Observer:
+  void OnPredictionUpdated(
+      const NavigationPredictorKeyedService::Prediction& prediction) override;
+
+ private:
+  bool IsPreloadingEnabled() const;
+
+  const raw_ptr<Profile> profile_;
+  raw_ptr<predictors::LoadingPredictor> loading_predictor_;
+  ShoppingTransitionModel model_;
+
+  base::ScopedObservation<NavigationPredictorKeyedService,
+                          NavigationPredictorKeyedService::Observer>
+      navigation_predictor_observation_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SHOPPING_PREDICTOR_SERVICE_H_
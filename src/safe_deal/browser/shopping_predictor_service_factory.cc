@@ -0,0 +1,49 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/shopping_predictor_service_factory.h"
+
+#include "chrome/browser/navigation_predictor/navigation_predictor_keyed_service_factory.h"
+#include "chrome/browser/predictors/loading_predictor_factory.h"
+#include "chrome/browser/profiles/profile.h"
+#include "safe_deal/browser/safe_deal_extension_activator_factory.h"
+#include "safe_deal/browser/shopping_predictor_service.h"
+
+namespace safe_deal {
+
+// static
+ShoppingPredictorService* ShoppingPredictorServiceFactory::GetForProfile(
+    Profile* profile) {
+  return static_cast<ShoppingPredictorService*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+}
+
+// static
+ShoppingPredictorServiceFactory*
+ShoppingPredictorServiceFactory::GetInstance() {
+  static base::NoDestructor<ShoppingPredictorServiceFactory> instance;
+  return instance.get();
+}
+
+ShoppingPredictorServiceFactory::ShoppingPredictorServiceFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealShoppingPredictorService",
+          ProfileSelections::BuildForRegularAndIncognito()) {
+  DependsOn(NavigationPredictorKeyedServiceFactory::GetInstance());
+  DependsOn(predictors::LoadingPredictorFactory::GetInstance());
+  DependsOn(SafeDealExtensionActivatorFactory::GetInstance());
+}
+
+ShoppingPredictorServiceFactory::~ShoppingPredictorServiceFactory() = default;
+
+std::unique_ptr<KeyedService>
+ShoppingPredictorServiceFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  Profile* profile = Profile::FromBrowserContext(context);
+  return std::make_unique<ShoppingPredictorService>(
+      profile, NavigationPredictorKeyedServiceFactory::GetForProfile(profile),
+      predictors::LoadingPredictorFactory::GetForProfile(profile));
+}
+
+}  // namespace safe_deal
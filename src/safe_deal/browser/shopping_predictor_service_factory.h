@@ -0,0 +1,45 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SHOPPING_PREDICTOR_SERVICE_FACTORY_H_
+#define SAFE_DEAL_BROWSER_SHOPPING_PREDICTOR_SERVICE_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace safe_deal {
+
+class ShoppingPredictorService;
+
+// Creates the ShoppingPredictorService of regular and incognito profiles.
+// Each incognito profile learns its own transitions, which are forgotten
+// when it closes.
+class ShoppingPredictorServiceFactory : public ProfileKeyedServiceFactory {
+ public:
+  static ShoppingPredictorService* GetForProfile(Profile* profile);
+  static ShoppingPredictorServiceFactory* GetInstance();
+
+  ShoppingPredictorServiceFactory(const ShoppingPredictorServiceFactory&) =
+      delete;
+  ShoppingPredictorServiceFactory& operator=(
+      const ShoppingPredictorServiceFactory&) = delete;
+
+ private:
+  friend base::NoDestructor<ShoppingPredictorServiceFactory>;
+
+  ShoppingPredictorServiceFactory();
+  ~ShoppingPredictorServiceFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SHOPPING_PREDICTOR_SERVICE_FACTORY_H_
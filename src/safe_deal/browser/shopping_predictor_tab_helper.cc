@@ -0,0 +1,133 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/shopping_predictor_tab_helper.h"
+
+#include <utility>
+
+#include "base/containers/contains.h"
+#include "base/feature_list.h"
+#include "base/metrics/histogram_functions.h"
+#include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/navigation_handle.h"
+#include "content/public/browser/render_frame_host.h"
+#include "content/public/browser/web_contents.h"
+#include "safe_deal/browser/shopping_predictor_service.h"
+#include "safe_deal/browser/shopping_predictor_service_factory.h"
+#include "safe_deal/common/marketplace_origin_matcher.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "third_party/blink/public/common/associated_interfaces/associated_interface_provider.h"
+#include "ui/base/page_transition_types.h"
+
+namespace safe_deal {
+
+// static
+void ShoppingPredictorTabHelper::MaybeCreateForNavigation(
+    content::NavigationHandle& handle) {
+  if (!base::FeatureList::IsEnabled(features::kSafeDealShoppingPredictor) ||
+      !handle.IsInPrimaryMainFrame()) {
+    return;
+  }
+  mojom::Marketplace marketplace =
+      MarketplaceOriginMatcher::GetInstance().Match(handle.GetURL());
+  if (marketplace == mojom::Marketplace::kUnknown) {
+    return;
+  }
+  content::WebContents* web_contents = handle.GetWebContents();
+  ShoppingPredictorService* service =
+      ShoppingPredictorServiceFactory::GetForProfile(
+          Profile::FromBrowserContext(web_contents->GetBrowserContext()));
+  if (!service) {
+    return;
+  }
+  CreateForWebContents(web_contents, service);
+  service->OnMarketplaceNavigationStarting(marketplace, handle.GetURL());
+}
+
+ShoppingPredictorTabHelper::ShoppingPredictorTabHelper(
+    content::WebContents* web_contents,
+    ShoppingPredictorService* service)
+    : content::WebContentsObserver(web_contents),
+      content::WebContentsUserData<ShoppingPredictorTabHelper>(*web_contents),
+      service_(service) {}
+
+ShoppingPredictorTabHelper::~ShoppingPredictorTabHelper() = default;
+
+void ShoppingPredictorTabHelper::SetCandidates(std::vector<GURL> prerender,
+                                               std::vector<GURL> prefetch) {
+  // NavigationPredictor reports again as links scroll into view; most
+  // reports do not change the candidates.
+  if (prerender == prerender_candidates_ && prefetch == prefetch_candidates_) {
+    return;
+  }
+  prerender_candidates_ = std::move(prerender);
+  prefetch_candidates_ = std::move(prefetch);
+  if (!agent_) {
+    web_contents()
+        ->GetPrimaryMainFrame()
+        ->GetRemoteAssociatedInterfaces()
+        ->GetInterface(&agent_);
+  }
+  agent_->SetCandidates(prerender_candidates_, prefetch_candidates_);
+}
+
+void ShoppingPredictorTabHelper::DidFinishNavigation(
+    content::NavigationHandle* handle) {
+  if (!handle->IsInPrimaryMainFrame() || !handle->HasCommitted() ||
+      handle->IsSameDocument()) {
+    return;
+  }
+  const mojom::Marketplace marketplace =
+      handle->IsErrorPage()
+          ? mojom::Marketplace::kUnknown
+          : MarketplaceOriginMatcher::GetInstance().Match(handle->GetURL());
+  const ShoppingPageType page_type =
+      marketplace == mojom::Marketplace::kUnknown
+          ? ShoppingPageType::kOther
+          : ClassifyShoppingPage(marketplace, handle->GetURL());
+
+  // Only links and forms tell where shopping sessions go; history
+  // navigations and reloads revisit where they went.
+  const ui::PageTransition transition = handle->GetPageTransition();
+  const bool is_link = ui::PageTransitionCoreTypeIs(
+      transition, ui::PAGE_TRANSITION_LINK);
+  if ((transition & ui::PAGE_TRANSITION_FORWARD_BACK) == 0) {
+    if (is_link) {
+      RecordPredictionOutcome(*handle);
+    }
+    if (marketplace_ != mojom::Marketplace::kUnknown &&
+        marketplace == marketplace_ &&
+        (is_link || ui::PageTransitionCoreTypeIs(
+                        transition, ui::PAGE_TRANSITION_FORM_SUBMIT))) {
+      service_->model().RecordTransition(marketplace, page_type_, page_type);
+    }
+  }
+
+  marketplace_ = marketplace;
+  page_type_ = page_type;
+  prerender_candidates_.clear();
+  prefetch_candidates_.clear();
+  // The agent belongs to the previous document's frame.
+  agent_.reset();
+}
+
+void ShoppingPredictorTabHelper::RecordPredictionOutcome(
+    content::NavigationHandle& handle) {
+  if (prerender_candidates_.empty() && prefetch_candidates_.empty()) {
+    return;
+  }
+  const bool prerender_hit =
+      base::Contains(prerender_candidates_, handle.GetURL());
+  base::UmaHistogramBoolean(
+      "SafeDeal.ShoppingPredictor.PredictionHit",
+      prerender_hit || base::Contains(prefetch_candidates_, handle.GetURL()));
+  if (prerender_hit) {
+    base::UmaHistogramBoolean("SafeDeal.ShoppingPredictor.PrerenderActivated",
+                              handle.IsPrerenderedPageActivation());
+  }
+}
+
+WEB_CONTENTS_USER_DATA_KEY_IMPL(ShoppingPredictorTabHelper);
+
+}  // namespace safe_deal
@@ -0,0 +1,78 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_SHOPPING_PREDICTOR_TAB_HELPER_H_
+#define SAFE_DEAL_BROWSER_SHOPPING_PREDICTOR_TAB_HELPER_H_
+
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "content/public/browser/web_contents_observer.h"
+#include "content/public/browser/web_contents_user_data.h"
+#include "mojo/public/cpp/bindings/associated_remote.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/shopping_predictor/common/shopping_speculation.mojom.h"
+#include "safe_deal/shopping_predictor/core/shopping_page_type.h"
+#include "url/gurl.h"
+
+namespace content {
+class NavigationHandle;
+}  // namespace content
+
+namespace safe_deal {
+
+class ShoppingPredictorService;
+
+// Per-tab side of ShoppingPredictorService, created when the tab first
+// navigates to a marketplace. Sends the candidates of the current page to its
+// renderer, records the transitions between marketplace pages the user
+// makes in the profile's model, and for every link navigation from a page
+// with candidates:
+//  - SafeDeal.ShoppingPredictor.PredictionHit: whether the link was one of
+//    them.
+//  - SafeDeal.ShoppingPredictor.PrerenderActivated: for prerender
+//    candidates, whether Chrome showed the prerendered page.
+class ShoppingPredictorTabHelper
+    : public content::WebContentsObserver,
+      public content::WebContentsUserData<ShoppingPredictorTabHelper> {
+ public:
+  // Creates the tab helper of primary main frame navigations to marketplace
+  // pages unless features::kSafeDealShoppingPredictor is disabled, and
+  // starts their preconnects. Called for every navigation.
+  static void MaybeCreateForNavigation(content::NavigationHandle& handle);
+
+  ShoppingPredictorTabHelper(const ShoppingPredictorTabHelper&) = delete;
+  ShoppingPredictorTabHelper& operator=(const ShoppingPredictorTabHelper&) =
+      delete;
+  ~ShoppingPredictorTabHelper() override;
+
+  // Replaces the candidates of the current page.
+  void SetCandidates(std::vector<GURL> prerender, std::vector<GURL> prefetch);
+
+  // content::WebContentsObserver:
+  void DidFinishNavigation(content::NavigationHandle* handle) override;
+
+ private:
+  friend class content::WebContentsUserData<ShoppingPredictorTabHelper>;
+
+  ShoppingPredictorTabHelper(content::WebContents* web_contents,
+                             ShoppingPredictorService* service);
+
+  void RecordPredictionOutcome(content::NavigationHandle& handle);
+
+  const raw_ptr<ShoppingPredictorService> service_;
+
+  // The current page.
+  mojom::Marketplace marketplace_ = mojom::Marketplace::kUnknown;
+  ShoppingPageType page_type_ = ShoppingPageType::kOther;
+  std::vector<GURL> prerender_candidates_;
+  std::vector<GURL> prefetch_candidates_;
+  mojo::AssociatedRemote<mojom::ShoppingSpeculationAgent> agent_;
+
+  WEB_CONTENTS_USER_DATA_KEY_DECL();
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_SHOPPING_PREDICTOR_TAB_HELPER_H_
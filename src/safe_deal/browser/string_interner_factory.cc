@@ -0,0 +1,73 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/browser/string_interner_factory.h"
+
+#include <stddef.h>
+
+#include "base/memory/raw_ptr.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "safe_deal/browser/safe_deal_memory_budget_factory.h"
+#include "safe_deal/common/safe_deal_memory_budget.h"
+#include "safe_deal/common/string_interner.h"
+
+namespace safe_deal {
+
+namespace {
+
+class StringInternerService : public KeyedService,
+                              public SafeDealMemoryBudget::Client {
+ public:
+  explicit StringInternerService(SafeDealMemoryBudget* budget)
+      : budget_(budget) {
+    budget_->AddClient(this, MemoryEvictionPriority::kShared,
+                       "interned_strings", "Interned marketplace identifiers");
+  }
+  ~StringInternerService() override { budget_->RemoveClient(this); }
+
+  StringInterner& interner() { return interner_; }
+
+  // SafeDealMemoryBudget::Client:
+  size_t GetMemoryUsage() const override { return interner_.memory_usage(); }
+  void EvictMemory(size_t target_bytes) override { interner_.Trim(); }
+
+ private:
+  const raw_ptr<SafeDealMemoryBudget> budget_;
+  StringInterner interner_;
+};
+
+}  // namespace
+
+// static
+StringInterner* StringInternerFactory::GetForProfile(Profile* profile) {
+  auto* service = static_cast<StringInternerService*>(
+      GetInstance()->GetServiceForBrowserContext(profile, /*create=*/true));
+  return service ? &service->interner() : nullptr;
+}
+
+// static
+StringInternerFactory* StringInternerFactory::GetInstance() {
+  static base::NoDestructor<StringInternerFactory> instance;
+  return instance.get();
+}
+
+StringInternerFactory::StringInternerFactory()
+    : ProfileKeyedServiceFactory(
+          "SafeDealStringInterner",
+          ProfileSelections::BuildForRegularAndIncognito()) {
+  DependsOn(SafeDealMemoryBudgetFactory::GetInstance());
+}
+
+StringInternerFactory::~StringInternerFactory() = default;
+
+std::unique_ptr<KeyedService>
+StringInternerFactory::BuildServiceInstanceForBrowserContext(
+    content::BrowserContext* context) const {
+  return std::make_unique<StringInternerService>(
+      SafeDealMemoryBudgetFactory::GetForProfile(
+          Profile::FromBrowserContext(context)));
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,43 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_BROWSER_STRING_INTERNER_FACTORY_H_
+#define SAFE_DEAL_BROWSER_STRING_INTERNER_FACTORY_H_
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "chrome/browser/profiles/profile_keyed_service_factory.h"
+
+class Profile;
+
+namespace safe_deal {
+
+class StringInterner;
+
+// Owns the StringInterner that the Safe Deal caches of a profile keep their
+// marketplace identifiers in. Incognito profiles get their own. Services
+// that use it must depend on this factory.
+class StringInternerFactory : public ProfileKeyedServiceFactory {
+ public:
+  static StringInterner* GetForProfile(Profile* profile);
+  static StringInternerFactory* GetInstance();
+
+  StringInternerFactory(const StringInternerFactory&) = delete;
+  StringInternerFactory& operator=(const StringInternerFactory&) = delete;
+
+ private:
+  friend base::NoDestructor<StringInternerFactory>;
+
+  StringInternerFactory();
+  ~StringInternerFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceForBrowserContext(
+      content::BrowserContext* context) const override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_BROWSER_STRING_INTERNER_FACTORY_H_
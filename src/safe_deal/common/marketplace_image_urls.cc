@@ -0,0 +1,194 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/marketplace_image_urls.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include "base/containers/span.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "safe_deal/common/safe_deal_constants.h"
+#include "url/url_constants.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr std::string_view kHttpsOriginPrefix = "https://";
+
+// Widths the CDNs serve variants at, smallest first.
+constexpr int kAliExpressImageWidths[] = {120, 220, 350, 480, 640};
+constexpr int kEbayImageWidths[] = {64,  140, 225, 300,  400,
+                                    500, 640, 960, 1200, 1600};
+
+bool IsImageOrigin(const MarketplaceInfo& info, const GURL& url) {
+  if (!url.SchemeIs(url::kHttpsScheme) || url.has_port()) {
+    return false;
+  }
+  for (std::string_view origin : info.image_origins) {
+    if (base::StartsWith(origin, kHttpsOriginPrefix) &&
+        url.host_piece() == origin.substr(kHttpsOriginPrefix.size())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the smallest of |widths| that is at least |width|, or the largest.
+int PickWidth(base::span<const int> widths, int width) {
+  for (int candidate : widths) {
+    if (candidate >= width) {
+      return candidate;
+    }
+  }
+  return widths.back();
+}
+
+// Returns the decimal number |text| starts with, or 0.
+int ParseLeadingNumber(std::string_view text) {
+  size_t end = 0;
+  while (end < text.size() && base::IsAsciiDigit(text[end])) {
+    ++end;
+  }
+  int number = 0;
+  return base::StringToInt(text.substr(0, end), &number) ? number : 0;
+}
+
+std::string_view GetLastPathSegment(const GURL& url) {
+  std::string_view path = url.path_piece();
+  return path.substr(path.rfind('/') + 1);
+}
+
+GURL ReplaceLastPathSegment(const GURL& url, std::string_view segment) {
+  std::string_view path = url.path_piece();
+  std::string new_path =
+      base::StrCat({path.substr(0, path.rfind('/') + 1), segment});
+  GURL::Replacements replacements;
+  replacements.SetPathStr(new_path);
+  return url.ReplaceComponents(replacements);
+}
+
+// "/images/I/71x3Z6QWqLL._AC_SX679_.jpg": the modifiers between the first
+// and the last dot resize the original "/images/I/71x3Z6QWqLL.jpg".
+// "_UL<width>_" scales it to |width| keeping its aspect ratio. Images cropped
+// with "_CR<x>,<y>,<width>,<height>_" are left alone: the crop is in pixels
+// of the image the modifiers before it made, so it cannot be kept across a
+// resize.
+std::optional<GURL> GetSmallerAmazonImageUrl(const GURL& url, int width) {
+  if (!base::StartsWith(url.path_piece(), "/images/I/")) {
+    return std::nullopt;
+  }
+  std::string_view name = GetLastPathSegment(url);
+  size_t first_dot = name.find('.');
+  if (first_dot == std::string_view::npos || first_dot == 0) {
+    return std::nullopt;
+  }
+  size_t last_dot = name.rfind('.');
+  // The widest size a modifier asks for, 0 for the original image.
+  int current_width = 0;
+  for (std::string_view modifier : base::SplitStringPiece(
+           name.substr(first_dot + 1, last_dot - first_dot), "_",
+           base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    if (base::StartsWith(modifier, "CR")) {
+      return std::nullopt;
+    }
+    if (modifier.size() > 2 && (modifier[0] == 'S' || modifier[0] == 'U')) {
+      current_width =
+          std::max(current_width, ParseLeadingNumber(modifier.substr(2)));
+    }
+  }
+  if (current_width && current_width <= width) {
+    return std::nullopt;
+  }
+  return ReplaceLastPathSegment(
+      url, base::StrCat({name.substr(0, first_dot), "._AC_UL",
+                         base::NumberToString(width), "_",
+                         name.substr(last_dot)}));
+}
+
+// "/kf/S5c3b.jpg_480x480q75.jpg_.webp": the original "/kf/S5c3b.jpg" is
+// followed by the size of the variant, optionally turned into WebP.
+std::optional<GURL> GetSmallerAliExpressImageUrl(const GURL& url, int width) {
+  if (!base::StartsWith(url.path_piece(), "/kf/")) {
+    return std::nullopt;
+  }
+  std::string_view name = GetLastPathSegment(url);
+  size_t dot = name.find('.');
+  if (dot == std::string_view::npos || dot == 0) {
+    return std::nullopt;
+  }
+  std::string_view original = name.substr(0, name.find('_', dot));
+  std::string_view variant = name.substr(original.size());
+  int current_width =
+      variant.empty() ? 0 : ParseLeadingNumber(variant.substr(1));
+  int new_width = PickWidth(kAliExpressImageWidths, width);
+  if (current_width && current_width <= new_width) {
+    return std::nullopt;
+  }
+  std::string new_width_string = base::NumberToString(new_width);
+  return ReplaceLastPathSegment(
+      url, base::StrCat({original, "_", new_width_string, "x",
+                         new_width_string, original.substr(original.rfind('.')),
+                         base::EndsWith(name, "_.webp") ? "_.webp" : ""}));
+}
+
+// "/images/g/AbCdEf/s-l1600.jpg" is the variant at most 1600 pixels wide.
+std::optional<GURL> GetSmallerEbayImageUrl(const GURL& url, int width) {
+  std::string_view name = GetLastPathSegment(url);
+  size_t dot = name.find('.');
+  if (!base::StartsWith(name, "s-l") || dot == std::string_view::npos) {
+    return std::nullopt;
+  }
+  int current_width = ParseLeadingNumber(name.substr(3));
+  int new_width = PickWidth(kEbayImageWidths, width);
+  if (!current_width || current_width <= new_width) {
+    return std::nullopt;
+  }
+  return ReplaceLastPathSegment(
+      url, base::StrCat({"s-l", base::NumberToString(new_width),
+                         name.substr(dot)}));
+}
+
+}  // namespace
+
+bool IsMarketplaceSearchPage(mojom::Marketplace marketplace, const GURL& url) {
+  std::string_view path = url.path_piece();
+  switch (marketplace) {
+    case mojom::Marketplace::kAmazon:
+      return path == "/s" || base::StartsWith(path, "/s/");
+    case mojom::Marketplace::kAliExpress:
+      return base::StartsWith(path, "/w/") ||
+             base::StartsWith(path, "/wholesale");
+    case mojom::Marketplace::kEbay:
+      return base::StartsWith(path, "/sch/");
+    case mojom::Marketplace::kUnknown:
+      return false;
+  }
+}
+
+std::optional<GURL> GetSmallerImageUrl(mojom::Marketplace marketplace,
+                                       const GURL& url,
+                                       int width) {
+  const MarketplaceInfo* info = GetMarketplaceInfo(marketplace);
+  if (!info || !IsImageOrigin(*info, url)) {
+    return std::nullopt;
+  }
+  switch (marketplace) {
+    case mojom::Marketplace::kAmazon:
+      return GetSmallerAmazonImageUrl(url, width);
+    case mojom::Marketplace::kAliExpress:
+      return GetSmallerAliExpressImageUrl(url, width);
+    case mojom::Marketplace::kEbay:
+      return GetSmallerEbayImageUrl(url, width);
+    case mojom::Marketplace::kUnknown:
+      return std::nullopt;
+  }
+}
+
+}  // namespace safe_deal
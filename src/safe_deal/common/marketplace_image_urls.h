@@ -0,0 +1,32 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_MARKETPLACE_IMAGE_URLS_H_
+#define SAFE_DEAL_COMMON_MARKETPLACE_IMAGE_URLS_H_
+
+#include <optional>
+
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+// Widest a search result image is shown, in CSS pixels, on the desktop
+// layouts of the supported marketplaces.
+inline constexpr int kSearchResultImageWidth = 300;
+
+// Returns true if |url|, a page on |marketplace|, lists search results.
+bool IsMarketplaceSearchPage(mojom::Marketplace marketplace, const GURL& url);
+
+// Returns the URL of the smallest variant of |url|, an image on one of
+// |marketplace|'s CDNs, that is at least |width| pixels wide. Returns nullopt
+// if |url| is not a CDN image whose size can be changed, or if it is not
+// larger than that variant already; images are only ever made smaller.
+std::optional<GURL> GetSmallerImageUrl(mojom::Marketplace marketplace,
+                                       const GURL& url,
+                                       int width);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_MARKETPLACE_IMAGE_URLS_H_
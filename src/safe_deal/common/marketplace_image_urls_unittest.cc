@@ -0,0 +1,178 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/marketplace_image_urls.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "base/strings/strcat.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+namespace {
+
+using mojom::Marketplace;
+
+// Returns the spec of the smaller variant of |url|, or "" if there is none.
+std::string GetSmallerImage(Marketplace marketplace,
+                            std::string_view url,
+                            int width = kSearchResultImageWidth) {
+  std::optional<GURL> smaller =
+      GetSmallerImageUrl(marketplace, GURL(url), width);
+  return smaller ? smaller->spec() : std::string();
+}
+
+// Returns the URL of the product image |name| on Amazon's CDN.
+std::string AmazonImage(std::string_view name) {
+  return base::StrCat({"https://m.media-amazon.com/images/I/", name});
+}
+
+TEST(MarketplaceImageUrlsTest, IsMarketplaceSearchPage) {
+  EXPECT_TRUE(IsMarketplaceSearchPage(
+      Marketplace::kAmazon, GURL("https://www.amazon.com/s?k=usb+c+cable")));
+  EXPECT_TRUE(IsMarketplaceSearchPage(
+      Marketplace::kAmazon,
+      GURL("https://www.amazon.de/s/ref=nb_sb_noss?field-keywords=kabel")));
+  EXPECT_FALSE(IsMarketplaceSearchPage(
+      Marketplace::kAmazon, GURL("https://www.amazon.com/dp/B0CHX1W1XY")));
+  EXPECT_FALSE(IsMarketplaceSearchPage(
+      Marketplace::kAmazon, GURL("https://www.amazon.com/stores/Anker")));
+
+  EXPECT_TRUE(IsMarketplaceSearchPage(
+      Marketplace::kAliExpress,
+      GURL("https://www.aliexpress.com/w/wholesale-usb-c-cable.html")));
+  EXPECT_TRUE(IsMarketplaceSearchPage(
+      Marketplace::kAliExpress,
+      GURL("https://www.aliexpress.com/wholesale?SearchText=usb+c+cable")));
+  EXPECT_FALSE(IsMarketplaceSearchPage(
+      Marketplace::kAliExpress,
+      GURL("https://www.aliexpress.com/item/1005006141584125.html")));
+
+  EXPECT_TRUE(IsMarketplaceSearchPage(
+      Marketplace::kEbay,
+      GURL("https://www.ebay.com/sch/i.html?_nkw=usb+c+cable")));
+  EXPECT_FALSE(IsMarketplaceSearchPage(
+      Marketplace::kEbay, GURL("https://www.ebay.com/itm/256123456789")));
+
+  EXPECT_FALSE(IsMarketplaceSearchPage(Marketplace::kUnknown,
+                                       GURL("https://example.com/s")));
+}
+
+TEST(MarketplaceImageUrlsTest, Amazon) {
+  EXPECT_EQ(AmazonImage("71x3Z6QWqLL._AC_UL300_.jpg"),
+            GetSmallerImage(Marketplace::kAmazon,
+                            AmazonImage("71x3Z6QWqLL._AC_SX679_.jpg")));
+  EXPECT_EQ(AmazonImage("61bK6PMOC3L._AC_UL300_.jpg"),
+            GetSmallerImage(Marketplace::kAmazon,
+                            AmazonImage("61bK6PMOC3L._AC_SL1500_.jpg")));
+  // The original image has no modifiers.
+  EXPECT_EQ(AmazonImage("71x3Z6QWqLL._AC_UL300_.jpg"),
+            GetSmallerImage(Marketplace::kAmazon,
+                            AmazonImage("71x3Z6QWqLL.jpg")));
+  EXPECT_EQ(AmazonImage("71x3Z6QWqLL._AC_UL640_.jpg"),
+            GetSmallerImage(Marketplace::kAmazon,
+                            AmazonImage("71x3Z6QWqLL._AC_UL1500_.jpg"), 640));
+  // Search results are already small enough.
+  EXPECT_EQ("",
+            GetSmallerImage(Marketplace::kAmazon,
+                            AmazonImage("71x3Z6QWqLL._AC_UL320_.jpg"), 320));
+  EXPECT_EQ("", GetSmallerImage(Marketplace::kAmazon,
+                                AmazonImage("71x3Z6QWqLL._AC_UY218_.jpg")));
+}
+
+// A crop is in pixels of the image it applies to, so cropped images keep
+// their size.
+TEST(MarketplaceImageUrlsTest, AmazonCrop) {
+  EXPECT_EQ("", GetSmallerImage(
+                    Marketplace::kAmazon,
+                    AmazonImage("41Jm8o5TjPL._SX1500_CR0,0,1500,1000_.jpg")));
+  EXPECT_EQ("", GetSmallerImage(
+                    Marketplace::kAmazon,
+                    AmazonImage("51Qz5Ov1qDL._CR0,0,1200,1200_SX600_.jpg")));
+  EXPECT_EQ("", GetSmallerImage(
+                    Marketplace::kAmazon,
+                    AmazonImage("41Jm8o5TjPL._CR120,0,760,760_.jpg")));
+}
+
+TEST(MarketplaceImageUrlsTest, AliExpress) {
+  EXPECT_EQ(
+      "https://ae01.alicdn.com/kf/S5c3b0d5a1b2c4d6e8f0a1b2c3d4e5f6gH.jpg_"
+      "350x350.jpg_.webp",
+      GetSmallerImage(Marketplace::kAliExpress,
+                      "https://ae01.alicdn.com/kf/"
+                      "S5c3b0d5a1b2c4d6e8f0a1b2c3d4e5f6gH.jpg_640x640q75.jpg_"
+                      ".webp"));
+  EXPECT_EQ(
+      "https://ae-pic-a1.aliexpress-media.com/kf/"
+      "Hd2b3e0f6a7c94e3c8b1f5e0d9a2c7b4eK.png_350x350.png",
+      GetSmallerImage(Marketplace::kAliExpress,
+                      "https://ae-pic-a1.aliexpress-media.com/kf/"
+                      "Hd2b3e0f6a7c94e3c8b1f5e0d9a2c7b4eK.png_960x960.png"));
+  // The original image has no size.
+  EXPECT_EQ(
+      "https://ae01.alicdn.com/kf/HTB1rW2vXfjsK1Rjy1Xaq6zispXa8.jpg_"
+      "350x350.jpg",
+      GetSmallerImage(
+          Marketplace::kAliExpress,
+          "https://ae01.alicdn.com/kf/HTB1rW2vXfjsK1Rjy1Xaq6zispXa8.jpg"));
+  EXPECT_EQ("", GetSmallerImage(Marketplace::kAliExpress,
+                                "https://ae01.alicdn.com/kf/"
+                                "S5c3b0d5a1b2c4d6e8f0a1b2c3d4e5f6gH.jpg_"
+                                "220x220q75.jpg_.webp"));
+  EXPECT_EQ("", GetSmallerImage(Marketplace::kAliExpress,
+                                "https://ae01.alicdn.com/images/eng/wholesale/"
+                                "icon/aliexpress.ico"));
+}
+
+TEST(MarketplaceImageUrlsTest, Ebay) {
+  EXPECT_EQ("https://i.ebayimg.com/images/g/2mEAAOSwXYZlZ1aB/s-l300.jpg",
+            GetSmallerImage(
+                Marketplace::kEbay,
+                "https://i.ebayimg.com/images/g/2mEAAOSwXYZlZ1aB/s-l1600.jpg"));
+  EXPECT_EQ("https://i.ebayimg.com/images/g/2mEAAOSwXYZlZ1aB/s-l300.webp",
+            GetSmallerImage(
+                Marketplace::kEbay,
+                "https://i.ebayimg.com/images/g/2mEAAOSwXYZlZ1aB/s-l500.webp"));
+  EXPECT_EQ(
+      "https://i.ebayimg.com/images/g/2mEAAOSwXYZlZ1aB/s-l1200.jpg",
+      GetSmallerImage(
+          Marketplace::kEbay,
+          "https://i.ebayimg.com/images/g/2mEAAOSwXYZlZ1aB/s-l1600.jpg", 1000));
+  EXPECT_EQ("", GetSmallerImage(Marketplace::kEbay,
+                                "https://i.ebayimg.com/thumbs/images/g/"
+                                "2mEAAOSwXYZlZ1aB/s-l225.jpg"));
+  EXPECT_EQ("", GetSmallerImage(Marketplace::kEbay,
+                                "https://i.ebayimg.com/00/s/MTYwMFgxNjAw/z/"
+                                "2mEAAOSwXYZlZ1aB/$_57.JPG"));
+}
+
+TEST(MarketplaceImageUrlsTest, OnlyMarketplaceCdns) {
+  constexpr char kAmazonImage[] =
+      "https://m.media-amazon.com/images/I/71x3Z6QWqLL._AC_SX679_.jpg";
+  EXPECT_EQ("", GetSmallerImage(Marketplace::kEbay, kAmazonImage));
+  EXPECT_EQ("", GetSmallerImage(Marketplace::kUnknown, kAmazonImage));
+  EXPECT_EQ("", GetSmallerImage(
+                    Marketplace::kAmazon,
+                    "http://m.media-amazon.com/images/I/71x3Z6QWqLL._AC_SX679_"
+                    ".jpg"));
+  EXPECT_EQ("", GetSmallerImage(
+                    Marketplace::kAmazon,
+                    "https://m.media-amazon.com:8443/images/I/71x3Z6QWqLL._AC_"
+                    "SX679_.jpg"));
+  EXPECT_EQ("", GetSmallerImage(Marketplace::kAmazon,
+                                "https://m.media-amazon.com.example/images/I/"
+                                "71x3Z6QWqLL._AC_SX679_.jpg"));
+  // Amazon's CDN also serves site graphics, which have no variants.
+  EXPECT_EQ("", GetSmallerImage(Marketplace::kAmazon,
+                                "https://m.media-amazon.com/images/G/01/"
+                                "gno/sprites/nav-sprite-global-1x.png"));
+}
+
+}  // namespace
+
+}  // namespace safe_deal
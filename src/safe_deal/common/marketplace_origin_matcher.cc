@@ -0,0 +1,61 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/marketplace_origin_matcher.h"
+
+#include <utility>
+#include <vector>
+
+#include "safe_deal/common/safe_deal_constants.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+// static
+const MarketplaceOriginMatcher& MarketplaceOriginMatcher::GetInstance() {
+  static base::NoDestructor<MarketplaceOriginMatcher> instance;
+  return *instance;
+}
+
+MarketplaceOriginMatcher::MarketplaceOriginMatcher() {
+  std::vector<std::pair<std::string_view, mojom::Marketplace>> domains;
+  for (const MarketplaceInfo& info : GetMarketplaces()) {
+    for (const char* domain : info.domains) {
+      domains.emplace_back(domain, info.marketplace);
+    }
+  }
+  domains_ = base::flat_map<std::string_view, mojom::Marketplace>(
+      std::move(domains));
+}
+
+MarketplaceOriginMatcher::~MarketplaceOriginMatcher() = default;
+
+mojom::Marketplace MarketplaceOriginMatcher::Match(const GURL& url) const {
+  if (!url.SchemeIsHTTPOrHTTPS()) {
+    return mojom::Marketplace::kUnknown;
+  }
+  return MatchHost(url.host_piece());
+}
+
+mojom::Marketplace MarketplaceOriginMatcher::MatchHost(
+    std::string_view host) const {
+  if (!host.empty() && host.back() == '.') {
+    host.remove_suffix(1);
+  }
+  // Try the host and each of its parent domains, longest first.
+  while (!host.empty()) {
+    auto it = domains_.find(host);
+    if (it != domains_.end()) {
+      return it->second;
+    }
+    size_t dot = host.find('.');
+    if (dot == std::string_view::npos) {
+      break;
+    }
+    host.remove_prefix(dot + 1);
+  }
+  return mojom::Marketplace::kUnknown;
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,50 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_MARKETPLACE_ORIGIN_MATCHER_H_
+#define SAFE_DEAL_COMMON_MARKETPLACE_ORIGIN_MATCHER_H_
+
+#include <string_view>
+
+#include "base/containers/flat_map.h"
+#include "base/no_destructor.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+
+class GURL;
+
+namespace safe_deal {
+
+// Matches URLs against the marketplace domains of safe_deal_constants.h on
+// hot paths such as every navigation. The domains are indexed once, so a
+// match costs one lookup per label of the host instead of a comparison with
+// every domain. Thread safe.
+class MarketplaceOriginMatcher {
+ public:
+  static const MarketplaceOriginMatcher& GetInstance();
+
+  MarketplaceOriginMatcher(const MarketplaceOriginMatcher&) = delete;
+  MarketplaceOriginMatcher& operator=(const MarketplaceOriginMatcher&) =
+      delete;
+
+  // Returns the marketplace of |url|, or kUnknown if it is not an HTTP(S)
+  // URL of a marketplace.
+  mojom::Marketplace Match(const GURL& url) const;
+
+  // Same as GetMarketplaceForHost() for a canonicalized, i.e. lower case,
+  // |host|.
+  mojom::Marketplace MatchHost(std::string_view host) const;
+
+ private:
+  friend class base::NoDestructor<MarketplaceOriginMatcher>;
+
+  MarketplaceOriginMatcher();
+  ~MarketplaceOriginMatcher();
+
+  // Registrable domain to marketplace.
+  base::flat_map<std::string_view, mojom::Marketplace> domains_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_MARKETPLACE_ORIGIN_MATCHER_H_
@@ -0,0 +1,161 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/page_arena.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "safe_deal/common/safe_deal_partition.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr size_t kChunkSize = 64 * 1024;
+
+std::atomic<size_t> g_total_committed_bytes{0};
+
+}  // namespace
+
+struct PageArena::Chunk {
+  // Partition memory this arena owns.
+  RAW_PTR_EXCLUSION Chunk* next;
+  size_t size;
+
+  char* begin() { return reinterpret_cast<char*>(this + 1); }
+  char* end() { return reinterpret_cast<char*>(this) + size; }
+};
+
+PageArena::PageArena() {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+PageArena::~PageArena() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FreeChunksAfter(nullptr);
+}
+
+void* PageArena::Allocate(size_t size, size_t alignment) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(base::bits::IsPowerOfTwo(alignment));
+  char* data = base::bits::AlignUp(next_, alignment);
+  if (!next_ || size > static_cast<size_t>(end_ - std::min(data, end_))) {
+    // The rest of the chunk is lost, at most what the allocation would have
+    // left of it.
+    AddChunk(size + alignment);
+    data = base::bits::AlignUp(next_, alignment);
+  }
+  next_ = data + size;
+  last_ = data;
+  allocated_bytes_ += size;
+  return data;
+}
+
+void PageArena::Shrink(const void* data, size_t used) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK_EQ(data, last_);
+  const char* const new_next = last_ + used;
+  DCHECK_LE(new_next, next_);
+  allocated_bytes_ -= static_cast<size_t>(next_ - new_next);
+  next_ = const_cast<char*>(new_next);
+}
+
+std::string_view PageArena::CopyString(std::string_view value) {
+  if (value.empty()) {
+    return std::string_view();
+  }
+  char* data = static_cast<char*>(Allocate(value.size(), 1));
+  memcpy(data, value.data(), value.size());
+  return std::string_view(data, value.size());
+}
+
+PageArena::Mark PageArena::GetMark() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  Mark mark;
+  mark.chunk = current_chunk_.get();
+  mark.next = next_;
+  mark.allocated_bytes = allocated_bytes_;
+  return mark;
+}
+
+void PageArena::RewindTo(const Mark& mark) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!mark.chunk) {
+    // Marked before the first allocation.
+    Reset();
+    return;
+  }
+  if (mark.chunk != current_chunk_) {
+    current_chunk_ = mark.chunk;
+    FreeChunksAfter(mark.chunk);
+    end_ = mark.chunk->end();
+  }
+  next_ = mark.next;
+  last_ = nullptr;
+  allocated_bytes_ = mark.allocated_bytes;
+}
+
+void PageArena::Reset() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!first_chunk_) {
+    return;
+  }
+  current_chunk_ = first_chunk_;
+  FreeChunksAfter(first_chunk_);
+  next_ = first_chunk_->begin();
+  end_ = first_chunk_->end();
+  last_ = nullptr;
+  allocated_bytes_ = 0;
+}
+
+// static
+size_t PageArena::GetTotalCommittedBytes() {
+  return g_total_committed_bytes.load(std::memory_order_relaxed);
+}
+
+void PageArena::AddChunk(size_t min_size) {
+  // Oversized allocations, such as the text of a long description, get a
+  // chunk of their own.
+  const size_t size = std::max(kChunkSize, sizeof(Chunk) + min_size);
+  Chunk* chunk = new (SafeDealPartition::Alloc(size, "PageArena"))
+      Chunk{.next = nullptr, .size = size};
+  if (current_chunk_) {
+    current_chunk_->next = chunk;
+  } else {
+    first_chunk_ = chunk;
+  }
+  current_chunk_ = chunk;
+  next_ = chunk->begin();
+  end_ = chunk->end();
+  committed_bytes_ += size;
+  g_total_committed_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void PageArena::FreeChunksAfter(Chunk* chunk) {
+  Chunk* next = chunk ? chunk->next : first_chunk_.get();
+  if (chunk) {
+    chunk->next = nullptr;
+  } else {
+    first_chunk_ = nullptr;
+    current_chunk_ = nullptr;
+    next_ = nullptr;
+    end_ = nullptr;
+    last_ = nullptr;
+  }
+  while (next) {
+    Chunk* const freed = next;
+    next = freed->next;
+    committed_bytes_ -= freed->size;
+    g_total_committed_bytes.fetch_sub(freed->size, std::memory_order_relaxed);
+    SafeDealPartition::Free(freed);
+  }
+}
+
+}  // namespace safe_deal
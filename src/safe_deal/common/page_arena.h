@@ -0,0 +1,89 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_PAGE_ARENA_H_
+#define SAFE_DEAL_COMMON_PAGE_ARENA_H_
+
+#include <stddef.h>
+
+#include <string_view>
+
+#include "base/memory/raw_ptr.h"
+#include "base/memory/raw_ptr_exclusion.h"
+#include "base/sequence_checker.h"
+
+namespace safe_deal {
+
+// Bump allocator for the scratch memory of one page load, such as the
+// attribute values read while extracting a page. Allocating is a pointer
+// bump into 64 KiB chunks taken from SafeDealPartition; nothing is freed
+// individually. Reset() frees everything at once when the frame navigates,
+// keeping the first chunk for the next page, so a page that fits in it costs
+// no allocation at all.
+//
+// Objects are not destroyed, so only trivially destructible ones may live
+// here. Sequence affine.
+class PageArena {
+ private:
+  struct Chunk;
+
+ public:
+  PageArena();
+  PageArena(const PageArena&) = delete;
+  PageArena& operator=(const PageArena&) = delete;
+  ~PageArena();
+
+  // Returns |size| bytes aligned to |alignment|, a power of two.
+  void* Allocate(size_t size, size_t alignment = alignof(max_align_t));
+
+  // Gives back the end of the last allocation, which starts at |data|, past
+  // its first |used| bytes. For buffers sized for the worst case.
+  void Shrink(const void* data, size_t used);
+
+  std::string_view CopyString(std::string_view value);
+
+  // A position in the arena, for scratch memory that is done with before
+  // the page is: RewindTo() frees everything allocated since GetMark().
+  class Mark {
+   private:
+    friend class PageArena;
+    RAW_PTR_EXCLUSION Chunk* chunk = nullptr;
+    RAW_PTR_EXCLUSION char* next = nullptr;
+    size_t allocated_bytes = 0;
+  };
+  Mark GetMark() const;
+  void RewindTo(const Mark& mark);
+
+  // Frees every allocation.
+  void Reset();
+
+  // Bytes handed out since the last Reset().
+  size_t allocated_bytes() const { return allocated_bytes_; }
+  // Bytes of the chunks, which memory-infra reports for all arenas of the
+  // process as safe_deal/partition/page_arenas.
+  size_t committed_bytes() const { return committed_bytes_; }
+
+  // Sum of committed_bytes() of every arena of the process.
+  static size_t GetTotalCommittedBytes();
+
+ private:
+  void AddChunk(size_t min_size);
+  void FreeChunksAfter(Chunk* chunk);
+
+  raw_ptr<Chunk> first_chunk_ = nullptr;
+  raw_ptr<Chunk> current_chunk_ = nullptr;
+  // Free range of |current_chunk_|. Bumped on every allocation.
+  RAW_PTR_EXCLUSION char* next_ = nullptr;
+  RAW_PTR_EXCLUSION char* end_ = nullptr;
+  // Start of the last allocation, for Shrink().
+  RAW_PTR_EXCLUSION const char* last_ = nullptr;
+  size_t allocated_bytes_ = 0;
+  size_t committed_bytes_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_PAGE_ARENA_H_
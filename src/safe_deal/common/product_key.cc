@@ -0,0 +1,36 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/product_key.h"
+
+#include <string>
+
+#include "base/containers/span.h"
+#include "base/numerics/byte_conversions.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
+#include "crypto/sha2.h"
+
+namespace safe_deal {
+
+uint64_t ComputeProductKeyHash(mojom::Marketplace marketplace,
+                               std::string_view product_id) {
+  std::string digest = crypto::SHA256HashString(base::StrCat(
+      {base::NumberToString(static_cast<int>(marketplace)), ":", product_id}));
+  return base::U64FromLittleEndian(
+      base::as_byte_span(digest).first<sizeof(uint64_t)>());
+}
+
+uint64_t ComputeSellerKeyHash(mojom::Marketplace marketplace,
+                              std::string_view seller_id) {
+  std::string digest = crypto::SHA256HashString(
+      base::StrCat({"seller:",
+                    base::NumberToString(static_cast<int>(marketplace)), ":",
+                    seller_id}));
+  uint64_t key = base::U64FromLittleEndian(
+      base::as_byte_span(digest).first<sizeof(uint64_t)>());
+  return key ? key : 1;
+}
+
+}  // namespace safe_deal
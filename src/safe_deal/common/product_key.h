@@ -0,0 +1,29 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_PRODUCT_KEY_H_
+#define SAFE_DEAL_COMMON_PRODUCT_KEY_H_
+
+#include <stdint.h>
+
+#include <string_view>
+
+#include "safe_deal/common/marketplace.mojom-shared.h"
+
+namespace safe_deal {
+
+// Returns a 64-bit hash identifying a listing across browser sessions. It is
+// persisted in Safe Deal's on-disk indexes, so the algorithm must never
+// change.
+uint64_t ComputeProductKeyHash(mojom::Marketplace marketplace,
+                               std::string_view product_id);
+
+// Returns a 64-bit hash identifying a seller, with the same stability
+// guarantee. Never zero, so it can key shared hash tables.
+uint64_t ComputeSellerKeyHash(mojom::Marketplace marketplace,
+                              std::string_view seller_id);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_PRODUCT_KEY_H_
@@ -0,0 +1,95 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/safe_deal_constants.h"
+
+#include "base/strings/string_util.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr const char* kAmazonDomains[] = {
+    "amazon.com",    "amazon.ca",     "amazon.com.mx", "amazon.com.br",
+    "amazon.co.uk",  "amazon.de",     "amazon.fr",     "amazon.it",
+    "amazon.es",     "amazon.nl",     "amazon.se",     "amazon.pl",
+    "amazon.com.be", "amazon.com.tr", "amazon.ae",     "amazon.sa",
+    "amazon.eg",     "amazon.in",     "amazon.co.jp",  "amazon.sg",
+    "amazon.com.au",
+};
+
+constexpr const char* kAliExpressDomains[] = {
+    "aliexpress.com",
+    "aliexpress.us",
+    "aliexpress.ru",
+};
+
+constexpr const char* kEbayDomains[] = {
+    "ebay.com",  "ebay.ca", "ebay.co.uk", "ebay.de", "ebay.fr",
+    "ebay.it",   "ebay.es", "ebay.nl",    "ebay.be", "ebay.at",
+    "ebay.ch",   "ebay.ie", "ebay.pl",    "ebay.com.au",
+};
+
+constexpr const char* kAmazonImageOrigins[] = {
+    "https://m.media-amazon.com",
+    "https://images-na.ssl-images-amazon.com",
+};
+
+constexpr const char* kAliExpressImageOrigins[] = {
+    "https://ae01.alicdn.com",
+    "https://ae-pic-a1.aliexpress-media.com",
+};
+
+constexpr const char* kEbayImageOrigins[] = {
+    "https://i.ebayimg.com",
+    "https://ir.ebaystatic.com",
+};
+
+constexpr MarketplaceInfo kMarketplaces[] = {
+    {mojom::Marketplace::kAmazon, "Amazon", kAmazonDomains,
+     kAmazonImageOrigins},
+    {mojom::Marketplace::kAliExpress, "AliExpress", kAliExpressDomains,
+     kAliExpressImageOrigins},
+    {mojom::Marketplace::kEbay, "eBay", kEbayDomains, kEbayImageOrigins},
+};
+
+// Returns true if |host| is |domain| or a subdomain of it.
+bool HostMatchesDomain(std::string_view host, std::string_view domain) {
+  if (!base::EndsWith(host, domain, base::CompareCase::INSENSITIVE_ASCII)) {
+    return false;
+  }
+  return host.size() == domain.size() ||
+         host[host.size() - domain.size() - 1] == '.';
+}
+
+}  // namespace
+
+base::span<const MarketplaceInfo> GetMarketplaces() {
+  return kMarketplaces;
+}
+
+const MarketplaceInfo* GetMarketplaceInfo(mojom::Marketplace marketplace) {
+  for (const MarketplaceInfo& info : kMarketplaces) {
+    if (info.marketplace == marketplace) {
+      return &info;
+    }
+  }
+  return nullptr;
+}
+
+mojom::Marketplace GetMarketplaceForHost(std::string_view host) {
+  if (!host.empty() && host.back() == '.') {
+    host.remove_suffix(1);
+  }
+  for (const MarketplaceInfo& info : kMarketplaces) {
+    for (const char* domain : info.domains) {
+      if (HostMatchesDomain(host, domain)) {
+        return info.marketplace;
+      }
+    }
+  }
+  return mojom::Marketplace::kUnknown;
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,38 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_SAFE_DEAL_CONSTANTS_H_
+#define SAFE_DEAL_COMMON_SAFE_DEAL_CONSTANTS_H_
+
+#include <string_view>
+
+#include "base/containers/span.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+
+namespace safe_deal {
+
+// Static description of a marketplace supported by the shopping assistant.
+struct MarketplaceInfo {
+  mojom::Marketplace marketplace;
+  // Human readable name, used in logs and internals pages.
+  const char* name;
+  // Registrable domains owned by the marketplace, without a leading dot.
+  base::span<const char* const> domains;
+  // Origins of the CDNs the marketplace serves product images from.
+  base::span<const char* const> image_origins;
+};
+
+// All supported marketplaces, in mojom::Marketplace order (kUnknown omitted).
+base::span<const MarketplaceInfo> GetMarketplaces();
+
+// Returns the info for |marketplace|, or nullptr for kUnknown.
+const MarketplaceInfo* GetMarketplaceInfo(mojom::Marketplace marketplace);
+
+// Returns the marketplace that owns |host|, matching whole labels so that
+// "www.amazon.co.uk" is Amazon but "notamazon.com" is not.
+mojom::Marketplace GetMarketplaceForHost(std::string_view host);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_SAFE_DEAL_CONSTANTS_H_
@@ -0,0 +1,19 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/safe_deal_extension.h"
+
+#include "extensions/common/extension.h"
+#include "extensions/common/mojom/manifest.mojom-shared.h"
+
+namespace safe_deal {
+
+bool IsSafeDealComponentExtension(const extensions::Extension& extension) {
+  return extension.location() ==
+             extensions::mojom::ManifestLocation::kComponent &&
+         extension.path().BaseName().value() ==
+             kSafeDealExtensionRootDirectory;
+}
+
+}  // namespace safe_deal
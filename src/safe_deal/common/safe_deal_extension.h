@@ -0,0 +1,30 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_SAFE_DEAL_EXTENSION_H_
+#define SAFE_DEAL_COMMON_SAFE_DEAL_EXTENSION_H_
+
+#include "base/files/file_path.h"
+
+namespace extensions {
+class Extension;
+}  // namespace extensions
+
+namespace safe_deal {
+
+// Directory of the Safe Deal component extension under DIR_RESOURCES. Must
+// match safe_deal_extension_root_directory in extension_resources.gni.
+inline constexpr base::FilePath::CharType kSafeDealExtensionRootDirectory[] =
+    FILE_PATH_LITERAL("safe_deal_extension");
+
+// Returns true if |extension| is the Safe Deal component extension. Only
+// Chrome itself loads component extensions, and it loads the Safe Deal one
+// from its own root directory, so the check gives the same answer in the
+// browser and in renderers, which know the extension's path but not
+// DIR_RESOURCES.
+bool IsSafeDealComponentExtension(const extensions::Extension& extension);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_SAFE_DEAL_EXTENSION_H_
@@ -0,0 +1,53 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/safe_deal_features.h"
+
+namespace safe_deal::features {
+
+BASE_FEATURE(kSafeDealBinaryApi,
+             "SafeDealBinaryApi",
+             base::FEATURE_ENABLED_BY_DEFAULT);
+
+BASE_FEATURE(kSafeDealExtension,
+             "SafeDealExtension",
+             base::FEATURE_ENABLED_BY_DEFAULT);
+
+BASE_FEATURE(kSafeDealHttpsUpgradeIndex,
+             "SafeDealHttpsUpgradeIndex",
+             base::FEATURE_ENABLED_BY_DEFAULT);
+
+BASE_FEATURE(kSafeDealLazyActivation,
+             "SafeDealLazyActivation",
+             base::FEATURE_ENABLED_BY_DEFAULT);
+
+BASE_FEATURE(kSafeDealLeanShopping,
+             "SafeDealLeanShopping",
+             base::FEATURE_ENABLED_BY_DEFAULT);
+
+BASE_FEATURE(kSafeDealMemoryBudget,
+             "SafeDealMemoryBudget",
+             base::FEATURE_ENABLED_BY_DEFAULT);
+
+const base::FeatureParam<int> kMemoryBudgetCeilingKiB{
+    &kSafeDealMemoryBudget, "ceiling_kib", 4096};
+
+BASE_FEATURE(kSafeDealProductMatching,
+             "SafeDealProductMatching",
+             base::FEATURE_ENABLED_BY_DEFAULT);
+
+BASE_FEATURE(kSafeDealReviewVerdicts,
+             "SafeDealReviewVerdicts",
+             base::FEATURE_ENABLED_BY_DEFAULT);
+
+BASE_FEATURE(kSafeDealShoppingPredictor,
+             "SafeDealShoppingPredictor",
+             base::FEATURE_ENABLED_BY_DEFAULT);
+
+const base::FeatureParam<double> kShoppingPredictorPrerenderThreshold{
+    &kSafeDealShoppingPredictor, "prerender_threshold", 0.5};
+const base::FeatureParam<double> kShoppingPredictorPrefetchThreshold{
+    &kSafeDealShoppingPredictor, "prefetch_threshold", 0.2};
+
+}  // namespace safe_deal::features
@@ -0,0 +1,62 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_SAFE_DEAL_FEATURES_H_
+#define SAFE_DEAL_COMMON_SAFE_DEAL_FEATURES_H_
+
+#include "base/feature_list.h"
+#include "base/metrics/field_trial_params.h"
+
+namespace safe_deal::features {
+
+// Asks the Safe Deal API for FlatBuffers responses, which are read in place
+// in the browser process, instead of JSON parsed by the data decoder.
+// JSON responses are still accepted either way.
+BASE_DECLARE_FEATURE(kSafeDealBinaryApi);
+
+// Loads the Safe Deal extension. Benchmarks disable it to measure pages
+// without the extension; the native components keep running.
+BASE_DECLARE_FEATURE(kSafeDealExtension);
+
+// Decides whether to upgrade http:// navigations from the preloaded and
+// learned HTTPS upgrade index before the network is involved.
+BASE_DECLARE_FEATURE(kSafeDealHttpsUpgradeIndex);
+
+// Loads the Safe Deal extension the first time a profile navigates to a
+// marketplace instead of at startup.
+BASE_DECLARE_FEATURE(kSafeDealLazyActivation);
+
+// Makes the lean shopping setting available. Users who turn it on get
+// smaller images on marketplace search results. Off, the setting has no
+// effect.
+BASE_DECLARE_FEATURE(kSafeDealLeanShopping);
+
+// Caps the heap memory of a profile's Safe Deal caches and evicts them under
+// memory pressure. Usage is reported either way.
+BASE_DECLARE_FEATURE(kSafeDealMemoryBudget);
+
+// The cap, in KiB, on the total of all caches of one profile.
+extern const base::FeatureParam<int> kMemoryBudgetCeilingKiB;
+
+// Indexes the title fingerprint of every product page the user views, so
+// that listings of the same item on the other marketplaces are found locally.
+BASE_DECLARE_FEATURE(kSafeDealProductMatching);
+
+// Downloads the review pages of the product pages the user views and scores
+// their reviews as the pages stream in.
+BASE_DECLARE_FEATURE(kSafeDealReviewVerdicts);
+
+// Predicts the next page of a shopping session from the links of the current
+// marketplace page and prerenders, prefetches or preconnects to it. Also the
+// kill switch of the predictor's speculation rules and preconnects.
+BASE_DECLARE_FEATURE(kSafeDealShoppingPredictor);
+
+// Smallest predicted probability of a link's page type for the link to be
+// prerendered, and for it to be prefetched.
+extern const base::FeatureParam<double> kShoppingPredictorPrerenderThreshold;
+extern const base::FeatureParam<double> kShoppingPredictorPrefetchThreshold;
+
+}  // namespace safe_deal::features
+
+#endif  // SAFE_DEAL_COMMON_SAFE_DEAL_FEATURES_H_
@@ -0,0 +1,168 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/safe_deal_memory_budget.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/auto_reset.h"
+#include "base/check.h"
+#include "base/check_op.h"
+#include "base/functional/bind.h"
+#include "base/location.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/strings/stringprintf.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/trace_event/memory_allocator_dump.h"
+#include "base/trace_event/memory_dump_manager.h"
+#include "base/trace_event/process_memory_dump.h"
+#include "base/trace_event/trace_event.h"
+
+namespace safe_deal {
+
+SafeDealMemoryBudget::SafeDealMemoryBudget(size_t ceiling,
+                                           bool enforce_ceiling)
+    : ceiling_(ceiling),
+      enforce_ceiling_(enforce_ceiling),
+      memory_pressure_listener_(
+          FROM_HERE,
+          base::BindRepeating(&SafeDealMemoryBudget::OnMemoryPressure,
+                              base::Unretained(this))) {
+  base::trace_event::MemoryDumpManager::GetInstance()
+      ->RegisterDumpProviderWithSequencedTaskRunner(
+          this, "SafeDealMemoryBudget",
+          base::SequencedTaskRunner::GetCurrentDefault(),
+          base::trace_event::MemoryDumpProvider::Options());
+}
+
+SafeDealMemoryBudget::~SafeDealMemoryBudget() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(clients_.empty());
+  base::trace_event::MemoryDumpManager::GetInstance()->UnregisterDumpProvider(
+      this);
+}
+
+void SafeDealMemoryBudget::AddClient(Client* client,
+                                     MemoryEvictionPriority priority,
+                                     const char* dump_name,
+                                     const char* label) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!evicting_);
+  auto position = std::ranges::upper_bound(clients_, priority, {},
+                                           &Registration::priority);
+  clients_.insert(position, {client, priority, dump_name, label});
+}
+
+void SafeDealMemoryBudget::RemoveClient(Client* client) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!evicting_);
+  size_t removed = std::erase_if(clients_, [client](const Registration& r) {
+    return r.client == client;
+  });
+  DCHECK_EQ(removed, 1u);
+}
+
+void SafeDealMemoryBudget::OnMemoryUsageGrew() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!evicting_);
+  if (enforce_ceiling_ && GetTotalUsage() > ceiling_) {
+    EvictTo(ceiling_);
+  }
+}
+
+size_t SafeDealMemoryBudget::GetTotalUsage() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  size_t total = 0;
+  for (const Registration& registration : clients_) {
+    total += registration.client->GetMemoryUsage();
+  }
+  return total;
+}
+
+std::vector<SafeDealMemoryBudget::ClientUsage> SafeDealMemoryBudget::GetUsage()
+    const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::vector<ClientUsage> usage;
+  usage.reserve(clients_.size());
+  for (const Registration& registration : clients_) {
+    usage.push_back(
+        {registration.label, registration.client->GetMemoryUsage()});
+  }
+  return usage;
+}
+
+bool SafeDealMemoryBudget::OnMemoryDump(
+    const base::trace_event::MemoryDumpArgs& args,
+    base::trace_event::ProcessMemoryDump* pmd) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  // Background dumps only take allowlisted names, and the per-profile
+  // suffix cannot be allowlisted.
+  if (args.level_of_detail ==
+      base::trace_event::MemoryDumpLevelOfDetail::kBackground) {
+    return true;
+  }
+  const char* system_allocator_pool_name =
+      base::trace_event::MemoryDumpManager::GetInstance()
+          ->system_allocator_pool_name();
+  for (const Registration& registration : clients_) {
+    base::trace_event::MemoryAllocatorDump* dump =
+        pmd->CreateAllocatorDump(base::StringPrintf(
+            "safe_deal/%s/0x%" PRIXPTR, registration.dump_name,
+            reinterpret_cast<uintptr_t>(this)));
+    dump->AddScalar(base::trace_event::MemoryAllocatorDump::kNameSize,
+                    base::trace_event::MemoryAllocatorDump::kUnitsBytes,
+                    registration.client->GetMemoryUsage());
+    if (system_allocator_pool_name) {
+      pmd->AddSuballocation(dump->guid(), system_allocator_pool_name);
+    }
+  }
+  return true;
+}
+
+void SafeDealMemoryBudget::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!enforce_ceiling_) {
+    return;
+  }
+  switch (level) {
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE:
+      return;
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE:
+      EvictTo(ceiling_ / 2);
+      return;
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
+      EvictTo(0);
+      return;
+  }
+}
+
+void SafeDealMemoryBudget::EvictTo(size_t target_bytes) {
+  TRACE_EVENT("safe_deal", "SafeDealMemoryBudget::EvictTo", "target_bytes",
+              target_bytes);
+  base::AutoReset<bool> evicting(&evicting_, true);
+  const size_t initial_total = GetTotalUsage();
+  size_t total = initial_total;
+  // Every client is asked once; how much evicting one frees in another, as
+  // with the shared strings, shows in the next total.
+  for (const Registration& registration : clients_) {
+    if (total <= target_bytes) {
+      break;
+    }
+    const size_t usage = registration.client->GetMemoryUsage();
+    const size_t excess = total - target_bytes;
+    registration.client->EvictMemory(usage > excess ? usage - excess : 0);
+    total = GetTotalUsage();
+  }
+  const size_t evicted = initial_total - std::min(total, initial_total);
+  base::UmaHistogramMemoryKB("SafeDeal.MemoryBudget.EvictedKB",
+                             static_cast<int>(evicted / 1024));
+}
+
+}  // namespace safe_deal
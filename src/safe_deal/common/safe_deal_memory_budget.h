@@ -0,0 +1,108 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_SAFE_DEAL_MEMORY_BUDGET_H_
+#define SAFE_DEAL_COMMON_SAFE_DEAL_MEMORY_BUDGET_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/raw_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/trace_event/memory_dump_provider.h"
+
+namespace safe_deal {
+
+// The order caches are evicted in, lowest first.
+enum class MemoryEvictionPriority {
+  // Entries that are fetched again on their next use.
+  kRefetchable,
+  // Entries learned from the profile's browsing, which are lost when evicted.
+  kLearned,
+  // Storage the other caches keep references into. Evicting them frees most
+  // of it; evicting it directly only returns the slack.
+  kShared,
+};
+
+// Accounts for the heap memory of the Safe Deal caches of a profile, which
+// register with it. When their total exceeds the ceiling, and under memory
+// pressure, the budget asks them to evict in priority order: down to the
+// ceiling when a cache grows past it, to half of it under moderate pressure,
+// and everything under critical pressure. Reports the usage of every cache
+// to memory-infra as safe_deal/<cache>. Sequence affine.
+class SafeDealMemoryBudget : public base::trace_event::MemoryDumpProvider {
+ public:
+  class Client {
+   public:
+    // Approximate heap usage, in bytes.
+    virtual size_t GetMemoryUsage() const = 0;
+
+    // Evicts until GetMemoryUsage() is at most |target_bytes|, or as close
+    // to it as the cache can get.
+    virtual void EvictMemory(size_t target_bytes) = 0;
+
+   protected:
+    virtual ~Client() = default;
+  };
+
+  struct ClientUsage {
+    const char* label;
+    size_t bytes;
+  };
+
+  // Without |enforce_ceiling|, usage is only reported and nothing is evicted.
+  SafeDealMemoryBudget(size_t ceiling, bool enforce_ceiling);
+  SafeDealMemoryBudget(const SafeDealMemoryBudget&) = delete;
+  SafeDealMemoryBudget& operator=(const SafeDealMemoryBudget&) = delete;
+  ~SafeDealMemoryBudget() override;
+
+  // Registers |client| until RemoveClient(). |dump_name| names its
+  // memory-infra dump and |label| its row on chrome://safe-deal-internals;
+  // both must be literals. Clients of equal priority are evicted in the
+  // order they were added.
+  void AddClient(Client* client,
+                 MemoryEvictionPriority priority,
+                 const char* dump_name,
+                 const char* label);
+  void RemoveClient(Client* client);
+
+  // Called by clients after they grew. Evicts down to the ceiling if the
+  // total exceeds it. Must not be called from Client::EvictMemory().
+  void OnMemoryUsageGrew();
+
+  size_t ceiling() const { return ceiling_; }
+  size_t GetTotalUsage() const;
+  std::vector<ClientUsage> GetUsage() const;
+
+  // base::trace_event::MemoryDumpProvider:
+  bool OnMemoryDump(const base::trace_event::MemoryDumpArgs& args,
+                    base::trace_event::ProcessMemoryDump* pmd) override;
+
+ private:
+  struct Registration {
+    raw_ptr<Client> client;
+    MemoryEvictionPriority priority;
+    const char* dump_name;
+    const char* label;
+  };
+
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+  void EvictTo(size_t target_bytes);
+
+  const size_t ceiling_;
+  const bool enforce_ceiling_;
+  // Sorted by priority.
+  std::vector<Registration> clients_;
+  bool evicting_ = false;
+  base::MemoryPressureListener memory_pressure_listener_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_SAFE_DEAL_MEMORY_BUDGET_H_
@@ -0,0 +1,141 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/safe_deal_partition.h"
+
+#include <new>
+
+#include "base/no_destructor.h"
+#include "base/trace_event/memory_allocator_dump.h"
+#include "base/trace_event/memory_dump_manager.h"
+#include "base/trace_event/memory_dump_provider.h"
+#include "base/trace_event/process_memory_dump.h"
+#include "partition_alloc/buildflags.h"
+#include "safe_deal/common/page_arena.h"
+
+#if PA_BUILDFLAG(USE_PARTITION_ALLOC)
+#include "partition_alloc/partition_alloc.h"
+#include "partition_alloc/partition_root.h"
+#include "partition_alloc/partition_stats.h"
+#endif
+
+namespace safe_deal {
+
+namespace {
+
+using base::trace_event::MemoryAllocatorDump;
+
+#if PA_BUILDFLAG(USE_PARTITION_ALLOC)
+
+class PartitionTotalsDumper : public partition_alloc::PartitionStatsDumper {
+ public:
+  // partition_alloc::PartitionStatsDumper:
+  void PartitionDumpTotals(
+      const char* partition_name,
+      const partition_alloc::PartitionMemoryStats* stats) override {
+    committed_bytes_ = stats->total_committed_bytes;
+    active_bytes_ = stats->total_active_bytes;
+  }
+  void PartitionsDumpBucketStats(
+      const char* partition_name,
+      const partition_alloc::PartitionBucketMemoryStats* stats) override {}
+
+  size_t committed_bytes() const { return committed_bytes_; }
+  size_t active_bytes() const { return active_bytes_; }
+
+ private:
+  size_t committed_bytes_ = 0;
+  size_t active_bytes_ = 0;
+};
+
+#endif  // PA_BUILDFLAG(USE_PARTITION_ALLOC)
+
+// Owns the partition, which lives as long as the process, and reports it.
+class Partition : public base::trace_event::MemoryDumpProvider {
+ public:
+  static Partition& Get() {
+    static base::NoDestructor<Partition> partition;
+    return *partition;
+  }
+
+  Partition(const Partition&) = delete;
+  Partition& operator=(const Partition&) = delete;
+
+  void* Alloc(size_t size, const char* type_name) {
+#if PA_BUILDFLAG(USE_PARTITION_ALLOC)
+    return allocator_.root()->Alloc(size, type_name);
+#else
+    return ::operator new(size);
+#endif
+  }
+
+  void Free(void* ptr) {
+#if PA_BUILDFLAG(USE_PARTITION_ALLOC)
+    allocator_.root()->Free(ptr);
+#else
+    ::operator delete(ptr);
+#endif
+  }
+
+  // base::trace_event::MemoryDumpProvider:
+  bool OnMemoryDump(const base::trace_event::MemoryDumpArgs& args,
+                    base::trace_event::ProcessMemoryDump* pmd) override {
+    // Background dumps only take allowlisted names.
+    if (args.level_of_detail ==
+        base::trace_event::MemoryDumpLevelOfDetail::kBackground) {
+      return true;
+    }
+    MemoryAllocatorDump* dump = pmd->CreateAllocatorDump("safe_deal/partition");
+#if PA_BUILDFLAG(USE_PARTITION_ALLOC)
+    // Totals only; the buckets are not worth the size of the dump.
+    PartitionTotalsDumper totals;
+    allocator_.root()->DumpStats("safe_deal", /*is_light_dump=*/true, &totals);
+    dump->AddScalar(MemoryAllocatorDump::kNameSize,
+                    MemoryAllocatorDump::kUnitsBytes,
+                    totals.committed_bytes());
+    dump->AddScalar("allocated_objects_size", MemoryAllocatorDump::kUnitsBytes,
+                    totals.active_bytes());
+#else
+    // The arenas and objects are in the system allocator instead.
+    const char* pool_name = base::trace_event::MemoryDumpManager::GetInstance()
+                                ->system_allocator_pool_name();
+    if (pool_name) {
+      pmd->AddSuballocation(dump->guid(), pool_name);
+    }
+#endif
+    pmd->CreateAllocatorDump("safe_deal/partition/page_arenas")
+        ->AddScalar(MemoryAllocatorDump::kNameSize,
+                    MemoryAllocatorDump::kUnitsBytes,
+                    PageArena::GetTotalCommittedBytes());
+    return true;
+  }
+
+ private:
+  friend class base::NoDestructor<Partition>;
+
+  Partition() {
+    base::trace_event::MemoryDumpManager::GetInstance()->RegisterDumpProvider(
+        this, "SafeDealPartition", nullptr);
+  }
+  ~Partition() override = default;
+
+#if PA_BUILDFLAG(USE_PARTITION_ALLOC)
+  partition_alloc::PartitionAllocator allocator_{
+      partition_alloc::PartitionOptions{}};
+#endif
+};
+
+}  // namespace
+
+// static
+void* SafeDealPartition::Alloc(size_t size, const char* type_name) {
+  return Partition::Get().Alloc(size, type_name);
+}
+
+// static
+void SafeDealPartition::Free(void* ptr) {
+  Partition::Get().Free(ptr);
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,43 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_SAFE_DEAL_PARTITION_H_
+#define SAFE_DEAL_COMMON_SAFE_DEAL_PARTITION_H_
+
+#include <stddef.h>
+
+namespace safe_deal {
+
+// The PartitionAlloc partition of the Safe Deal components, separate from
+// malloc. The per-request objects and page arenas of the renderer hot paths
+// live here, so that they neither fragment nor share pages and thread caches
+// with the rest of the process, and their memory is reported on its own, to
+// memory-infra as safe_deal/partition. Falls back to operator new in builds
+// without PartitionAlloc. Thread safe.
+class SafeDealPartition {
+ public:
+  SafeDealPartition() = delete;
+
+  // |type_name| must be a literal.
+  static void* Alloc(size_t size, const char* type_name);
+  static void Free(void* ptr);
+};
+
+}  // namespace safe_deal
+
+// Allocates instances of the class from SafeDealPartition, also through
+// std::make_unique. Put it at the top of the class declaration.
+#define SAFE_DEAL_PARTITION_ALLOCATED(type)                   \
+ public:                                                      \
+  static void* operator new(size_t size) {                    \
+    return ::safe_deal::SafeDealPartition::Alloc(size, #type); \
+  }                                                           \
+  static void operator delete(void* ptr) {                    \
+    ::safe_deal::SafeDealPartition::Free(ptr);                \
+  }                                                           \
+                                                              \
+ private:                                                     \
+  static_assert(true)
+
+#endif  // SAFE_DEAL_COMMON_SAFE_DEAL_PARTITION_H_
@@ -0,0 +1,127 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+
+#include "base/metrics/histogram_functions.h"
+#include "base/no_destructor.h"
+#include "base/trace_event/trace_event.h"
+#include "build/build_config.h"
+#include "safe_deal/common/thread_allocation_stats.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <string_view>
+
+#include "base/posix/eintr_wrapper.h"
+#include "base/strings/string_number_conversions.h"
+#endif
+
+namespace safe_deal {
+
+namespace {
+
+constinit thread_local int g_scope_depth = 0;
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+constexpr bool kCountsReads = true;
+
+// Returns the read system calls of the calling thread so far, or 0. Uses the
+// system calls directly: procfs never blocks, and base::File may not be used
+// on the UI thread. The read of one call is counted by the next.
+int64_t GetThreadReads() {
+  const int fd =
+      HANDLE_EINTR(open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC));
+  if (fd < 0) {
+    return 0;
+  }
+  char buffer[512];
+  const ssize_t length = HANDLE_EINTR(read(fd, buffer, sizeof(buffer)));
+  IGNORE_EINTR(close(fd));
+  if (length <= 0) {
+    return 0;
+  }
+  constexpr std::string_view kKey = "syscr: ";
+  std::string_view io(buffer, static_cast<size_t>(length));
+  const size_t begin = io.find(kKey);
+  if (begin == std::string_view::npos) {
+    return 0;
+  }
+  io.remove_prefix(begin + kKey.size());
+  int64_t reads = 0;
+  base::StringToInt64(io.substr(0, io.find('\n')), &reads);
+  return reads;
+}
+#else
+constexpr bool kCountsReads = false;
+
+int64_t GetThreadReads() {
+  return 0;
+}
+#endif
+
+}  // namespace
+
+SafeDealStartupMetrics::Scope::Scope(const char* name)
+    : counted_(g_scope_depth++ == 0 && GetInstance().is_counting()) {
+  TRACE_EVENT_BEGIN("safe_deal", perfetto::StaticString(name));
+  if (!counted_) {
+    return;
+  }
+  start_reads_ = GetThreadReads();
+  start_allocated_bytes_ = GetThreadAllocationStats().bytes;
+  start_ = base::TimeTicks::Now();
+}
+
+SafeDealStartupMetrics::Scope::~Scope() {
+  --g_scope_depth;
+  TRACE_EVENT_END("safe_deal");
+  if (!counted_) {
+    return;
+  }
+  SafeDealStartupMetrics& metrics = GetInstance();
+  metrics.time_us_.fetch_add(
+      (base::TimeTicks::Now() - start_).InMicroseconds(),
+      std::memory_order_relaxed);
+  // Less the read that took |start_reads_|.
+  if (int64_t reads = GetThreadReads() - start_reads_ - 1; reads > 0) {
+    metrics.reads_.fetch_add(reads, std::memory_order_relaxed);
+  }
+  metrics.allocated_bytes_.fetch_add(
+      GetThreadAllocationStats().bytes - start_allocated_bytes_,
+      std::memory_order_relaxed);
+}
+
+// static
+SafeDealStartupMetrics& SafeDealStartupMetrics::GetInstance() {
+  static base::NoDestructor<SafeDealStartupMetrics> instance;
+  return *instance;
+}
+
+SafeDealStartupMetrics::SafeDealStartupMetrics() = default;
+SafeDealStartupMetrics::~SafeDealStartupMetrics() = default;
+
+void SafeDealStartupMetrics::RecordFirstPaint() {
+  if (!counting_.exchange(false, std::memory_order_relaxed)) {
+    return;
+  }
+  // Scopes still running on other threads are left out.
+  base::UmaHistogramCustomMicrosecondsTimes(
+      "SafeDeal.Startup.TimeInSafeDeal",
+      base::Microseconds(time_us_.load(std::memory_order_relaxed)),
+      base::Microseconds(10), base::Seconds(10), 50);
+  if (kCountsReads) {
+    base::UmaHistogramCounts100000("SafeDeal.Startup.DiskReads",
+                                   reads_.load(std::memory_order_relaxed));
+  }
+  if (CanCountThreadAllocations()) {
+    base::UmaHistogramCounts1M(
+        "SafeDeal.Startup.AllocatedKiB",
+        allocated_bytes_.load(std::memory_order_relaxed) / 1024);
+  }
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,69 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_SAFE_DEAL_STARTUP_METRICS_H_
+#define SAFE_DEAL_COMMON_SAFE_DEAL_STARTUP_METRICS_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "base/time/time.h"
+
+namespace safe_deal {
+
+// What Safe Deal adds to every browser launch. Browser code that runs at
+// startup is wrapped in a Scope, which adds the wall time, the read system
+// calls and the memory allocated on its thread to process-wide totals. At the
+// first paint of a tab the totals are recorded as
+// SafeDeal.Startup.{TimeInSafeDeal,DiskReads,AllocatedKiB}, which
+// tools/bench/startup_perftest.mjs checks against a budget, and later scopes
+// cost one relaxed load.
+//
+// Nested scopes count once. Reads are counted on Linux and ChromeOS only,
+// and allocations only where PartitionAlloc is malloc; the histograms are
+// not recorded elsewhere. Allocations count malloc and operator new only
+// (see GetThreadAllocationStats()). Thread safe.
+class SafeDealStartupMetrics {
+ public:
+  class Scope {
+   public:
+    // |name| is traced in the safe_deal category and must be a literal.
+    explicit Scope(const char* name);
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope();
+
+   private:
+    const bool counted_;
+    base::TimeTicks start_;
+    int64_t start_reads_ = 0;
+    uint64_t start_allocated_bytes_ = 0;
+  };
+
+  static SafeDealStartupMetrics& GetInstance();
+
+  SafeDealStartupMetrics(const SafeDealStartupMetrics&) = delete;
+  SafeDealStartupMetrics& operator=(const SafeDealStartupMetrics&) = delete;
+
+  // Records the totals and stops counting. Only the first call records.
+  void RecordFirstPaint();
+
+  bool is_counting() const {
+    return counting_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  SafeDealStartupMetrics();
+  ~SafeDealStartupMetrics();
+
+  std::atomic<bool> counting_{true};
+  std::atomic<int64_t> time_us_{0};
+  std::atomic<int64_t> reads_{0};
+  std::atomic<uint64_t> allocated_bytes_{0};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_SAFE_DEAL_STARTUP_METRICS_H_
@@ -0,0 +1,327 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_SHARED_HASH_TABLE_H_
+#define SAFE_DEAL_COMMON_SHARED_HASH_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "base/check.h"
+#include "base/containers/span.h"
+#include "base/memory/raw_ptr.h"
+#include "base/memory/read_only_shared_memory_region.h"
+#include "base/memory/shared_memory_mapping.h"
+
+namespace safe_deal {
+
+// A fixed capacity hash table of trivially copyable records keyed by
+// non-zero 64-bit hashes, laid out in shared memory. The browser is the only
+// writer; renderers map the region read-only and look records up without
+// any IPC.
+//
+// Consistency uses a table-wide sequence lock: the writer makes the sequence
+// odd while it changes the table, and readers retry a lookup if the sequence
+// was odd or changed while they read. Writes are rare batch updates, so
+// readers almost never retry. Every word is accessed through relaxed
+// atomics, which keeps concurrent access well defined.
+namespace shared_hash_table {
+
+inline constexpr uint32_t kMagic = 0x54485344;  // "SDHT"
+
+struct Header {
+  uint32_t magic;
+  // Power of two.
+  uint32_t capacity;
+  // Number of 64-bit words per record.
+  uint32_t record_words;
+  std::atomic<uint32_t> sequence;
+};
+
+template <typename Record>
+struct Slot {
+  static constexpr size_t kRecordWords = sizeof(Record) / sizeof(uint64_t);
+
+  // Zero for empty slots.
+  std::atomic<uint64_t> key;
+  std::array<std::atomic<uint64_t>, kRecordWords> record;
+};
+
+template <typename Record>
+constexpr void CheckRecordType() {
+  static_assert(std::is_trivially_copyable_v<Record>);
+  static_assert(sizeof(Record) % sizeof(uint64_t) == 0);
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
+  static_assert(std::atomic<uint32_t>::is_always_lock_free);
+}
+
+// Returns the region size needed for |capacity| records.
+template <typename Record>
+constexpr size_t GetRegionSize(uint32_t capacity) {
+  return sizeof(Header) + size_t{capacity} * sizeof(Slot<Record>);
+}
+
+inline uint32_t GetHomeSlot(uint64_t key, uint32_t capacity) {
+  return static_cast<uint32_t>((key * 0x9e3779b97f4a7c15ull) >> 32) &
+         (capacity - 1);
+}
+
+}  // namespace shared_hash_table
+
+// Writer side. Owns the writable mapping; DuplicateReadOnlyRegion() hands
+// out handles for renderers. Not thread safe; use from one sequence.
+template <typename Record>
+class SharedHashTableWriter {
+ public:
+  // |capacity| must be a power of two. The table refuses inserts at 3/4 of
+  // capacity to keep probe sequences short.
+  explicit SharedHashTableWriter(uint32_t capacity) {
+    shared_hash_table::CheckRecordType<Record>();
+    CHECK(std::has_single_bit(capacity));
+    base::MappedReadOnlyRegion region =
+        base::ReadOnlySharedMemoryRegion::Create(
+            shared_hash_table::GetRegionSize<Record>(capacity));
+    if (!region.IsValid()) {
+      return;
+    }
+    region_ = std::move(region.region);
+    mapping_ = std::move(region.mapping);
+    header_ = mapping_.GetMemoryAs<shared_hash_table::Header>();
+    slots_ = reinterpret_cast<Slot*>(header_.get() + 1);
+    header_->magic = shared_hash_table::kMagic;
+    header_->capacity = capacity;
+    header_->record_words = Slot::kRecordWords;
+  }
+
+  SharedHashTableWriter(const SharedHashTableWriter&) = delete;
+  SharedHashTableWriter& operator=(const SharedHashTableWriter&) = delete;
+  ~SharedHashTableWriter() = default;
+
+  // False if shared memory could not be allocated; every operation is then
+  // a no-op.
+  bool IsValid() const { return mapping_.IsValid(); }
+
+  base::ReadOnlySharedMemoryRegion DuplicateReadOnlyRegion() const {
+    return region_.Duplicate();
+  }
+
+  size_t size() const { return size_; }
+
+  // Size of the shared memory region, which every reader maps.
+  size_t region_size() const { return mapping_.size(); }
+
+  // Inserts or replaces the record for |key|. Returns false if the table is
+  // full.
+  bool Insert(uint64_t key, const Record& record) {
+    DCHECK(key);
+    if (!IsValid()) {
+      return false;
+    }
+    uint32_t slot = FindSlot(key);
+    bool is_new = !slots_[slot].key.load(std::memory_order_relaxed);
+    if (is_new && (size_ + 1) * 4 > header_->capacity * 3) {
+      return false;
+    }
+    uint64_t words[Slot::kRecordWords];
+    std::memcpy(words, &record, sizeof(Record));
+
+    BeginWrite();
+    for (size_t i = 0; i < Slot::kRecordWords; ++i) {
+      slots_[slot].record[i].store(words[i], std::memory_order_relaxed);
+    }
+    slots_[slot].key.store(key, std::memory_order_relaxed);
+    EndWrite();
+    size_ += is_new;
+    return true;
+  }
+
+  // Returns the record for |key|, or nullopt if there is none. Only this
+  // writer changes the table, so reads need no sequence check.
+  std::optional<Record> Find(uint64_t key) const {
+    if (!IsValid()) {
+      return std::nullopt;
+    }
+    uint32_t slot = FindSlot(key);
+    if (!slots_[slot].key.load(std::memory_order_relaxed)) {
+      return std::nullopt;
+    }
+    uint64_t words[Slot::kRecordWords];
+    for (size_t i = 0; i < Slot::kRecordWords; ++i) {
+      words[i] = slots_[slot].record[i].load(std::memory_order_relaxed);
+    }
+    Record record;
+    std::memcpy(&record, words, sizeof(Record));
+    return record;
+  }
+
+  // Removes the record for |key|, if any.
+  void Remove(uint64_t key) {
+    if (!IsValid()) {
+      return;
+    }
+    uint32_t slot = FindSlot(key);
+    if (!slots_[slot].key.load(std::memory_order_relaxed)) {
+      return;
+    }
+    // Backward shift deletion keeps every remaining key reachable from its
+    // home slot without tombstones.
+    const uint32_t mask = header_->capacity - 1;
+    BeginWrite();
+    uint32_t hole = slot;
+    for (uint32_t next = (hole + 1) & mask;; next = (next + 1) & mask) {
+      uint64_t next_key = slots_[next].key.load(std::memory_order_relaxed);
+      if (!next_key) {
+        break;
+      }
+      uint32_t home = shared_hash_table::GetHomeSlot(next_key,
+                                                     header_->capacity);
+      // Move |next| into the hole unless its home lies cyclically in
+      // (hole, next].
+      if (((next - home) & mask) >= ((next - hole) & mask)) {
+        MoveSlot(next, hole);
+        hole = next;
+      }
+    }
+    slots_[hole].key.store(0, std::memory_order_relaxed);
+    EndWrite();
+    --size_;
+  }
+
+ private:
+  using Slot = shared_hash_table::Slot<Record>;
+
+  // Returns the slot holding |key|, or the empty slot where it would go.
+  uint32_t FindSlot(uint64_t key) const {
+    const uint32_t mask = header_->capacity - 1;
+    uint32_t slot = shared_hash_table::GetHomeSlot(key, header_->capacity);
+    while (true) {
+      uint64_t slot_key = slots_[slot].key.load(std::memory_order_relaxed);
+      if (!slot_key || slot_key == key) {
+        return slot;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+
+  void MoveSlot(uint32_t from, uint32_t to) {
+    for (size_t i = 0; i < Slot::kRecordWords; ++i) {
+      slots_[to].record[i].store(
+          slots_[from].record[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    slots_[to].key.store(slots_[from].key.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+  }
+
+  void BeginWrite() {
+    header_->sequence.store(
+        header_->sequence.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void EndWrite() {
+    header_->sequence.store(
+        header_->sequence.load(std::memory_order_relaxed) + 1,
+        std::memory_order_release);
+  }
+
+  base::ReadOnlySharedMemoryRegion region_;
+  base::WritableSharedMemoryMapping mapping_;
+  raw_ptr<shared_hash_table::Header> header_ = nullptr;
+  raw_ptr<Slot, AllowPtrArithmetic> slots_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Reader side, used by renderers. Thread safe.
+template <typename Record>
+class SharedHashTableReader {
+ public:
+  // Returns nullopt if |region| cannot be mapped or does not hold a table of
+  // |Record|.
+  static std::optional<SharedHashTableReader> Create(
+      base::ReadOnlySharedMemoryRegion region) {
+    shared_hash_table::CheckRecordType<Record>();
+    base::ReadOnlySharedMemoryMapping mapping = region.Map();
+    if (!mapping.IsValid() ||
+        mapping.size() < sizeof(shared_hash_table::Header)) {
+      return std::nullopt;
+    }
+    const auto* header = mapping.GetMemoryAs<shared_hash_table::Header>();
+    if (header->magic != shared_hash_table::kMagic ||
+        !std::has_single_bit(header->capacity) ||
+        header->record_words != Slot::kRecordWords ||
+        mapping.size() <
+            shared_hash_table::GetRegionSize<Record>(header->capacity)) {
+      return std::nullopt;
+    }
+    return SharedHashTableReader(std::move(mapping));
+  }
+
+  SharedHashTableReader(SharedHashTableReader&&) = default;
+  SharedHashTableReader& operator=(SharedHashTableReader&&) = default;
+  ~SharedHashTableReader() = default;
+
+  // Returns the record for |key|, or nullopt if there is none or the writer
+  // kept the table busy for every attempt.
+  std::optional<Record> Find(uint64_t key) const {
+    constexpr int kMaxAttempts = 64;
+    const auto* header = mapping_.GetMemoryAs<shared_hash_table::Header>();
+    const auto* slots = reinterpret_cast<const Slot*>(header + 1);
+    const uint32_t capacity = header->capacity;
+    const uint32_t mask = capacity - 1;
+
+    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+      uint32_t sequence = header->sequence.load(std::memory_order_acquire);
+      if (sequence & 1) {
+        continue;
+      }
+      std::optional<Record> result;
+      uint32_t slot = shared_hash_table::GetHomeSlot(key, capacity);
+      // The probe is bounded by the capacity in case a concurrent write
+      // leaves no empty slot visible.
+      for (uint32_t probes = 0; probes < capacity;
+           ++probes, slot = (slot + 1) & mask) {
+        uint64_t slot_key = slots[slot].key.load(std::memory_order_relaxed);
+        if (!slot_key) {
+          break;
+        }
+        if (slot_key == key) {
+          uint64_t words[Slot::kRecordWords];
+          for (size_t i = 0; i < Slot::kRecordWords; ++i) {
+            words[i] = slots[slot].record[i].load(std::memory_order_relaxed);
+          }
+          result.emplace();
+          std::memcpy(&*result, words, sizeof(Record));
+          break;
+        }
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (header->sequence.load(std::memory_order_relaxed) == sequence) {
+        return result;
+      }
+    }
+    return std::nullopt;
+  }
+
+ private:
+  using Slot = shared_hash_table::Slot<Record>;
+
+  explicit SharedHashTableReader(base::ReadOnlySharedMemoryMapping mapping)
+      : mapping_(std::move(mapping)) {}
+
+  base::ReadOnlySharedMemoryMapping mapping_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_SHARED_HASH_TABLE_H_
@@ -0,0 +1,199 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/shared_hash_table.h"
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr uint32_t kCapacity = 16;
+
+struct Record {
+  uint64_t key;
+  uint64_t value;
+  // key ^ value, to tell torn reads from real records.
+  uint64_t check;
+};
+
+struct OtherRecord {
+  uint64_t value;
+};
+
+Record MakeRecord(uint64_t key, uint64_t value) {
+  return {key, value, key ^ value};
+}
+
+// Returns |count| distinct keys whose home slot is |home|.
+std::vector<uint64_t> KeysWithHome(uint32_t home, size_t count) {
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 1; keys.size() < count; ++key) {
+    if (shared_hash_table::GetHomeSlot(key, kCapacity) == home) {
+      keys.push_back(key);
+    }
+  }
+  return keys;
+}
+
+SharedHashTableReader<Record> CreateReader(
+    const SharedHashTableWriter<Record>& writer) {
+  std::optional<SharedHashTableReader<Record>> reader =
+      SharedHashTableReader<Record>::Create(writer.DuplicateReadOnlyRegion());
+  CHECK(reader);
+  return std::move(*reader);
+}
+
+TEST(SharedHashTableTest, InsertFindReplace) {
+  SharedHashTableWriter<Record> writer(kCapacity);
+  ASSERT_TRUE(writer.IsValid());
+  SharedHashTableReader<Record> reader = CreateReader(writer);
+
+  EXPECT_FALSE(writer.Find(1));
+  EXPECT_FALSE(reader.Find(1));
+  ASSERT_TRUE(writer.Insert(1, MakeRecord(1, 10)));
+  ASSERT_TRUE(writer.Insert(2, MakeRecord(2, 20)));
+  EXPECT_EQ(2u, writer.size());
+  EXPECT_EQ(10u, writer.Find(1)->value);
+  EXPECT_EQ(20u, reader.Find(2)->value);
+
+  ASSERT_TRUE(writer.Insert(1, MakeRecord(1, 11)));
+  EXPECT_EQ(2u, writer.size());
+  EXPECT_EQ(11u, reader.Find(1)->value);
+
+  writer.Remove(1);
+  writer.Remove(1);
+  EXPECT_EQ(1u, writer.size());
+  EXPECT_FALSE(reader.Find(1));
+  EXPECT_EQ(20u, reader.Find(2)->value);
+}
+
+TEST(SharedHashTableTest, RefusesInsertsWhenThreeQuartersFull) {
+  SharedHashTableWriter<Record> writer(kCapacity);
+  for (uint64_t key = 1; key <= kCapacity * 3 / 4; ++key) {
+    ASSERT_TRUE(writer.Insert(key, MakeRecord(key, key)));
+  }
+  EXPECT_FALSE(writer.Insert(100, MakeRecord(100, 100)));
+  // Replacing an existing record still works.
+  EXPECT_TRUE(writer.Insert(1, MakeRecord(1, 2)));
+  writer.Remove(2);
+  EXPECT_TRUE(writer.Insert(100, MakeRecord(100, 100)));
+}
+
+// Removes colliding keys in every rotation of their insertion order, with
+// probe sequences that wrap around the end of the table, and checks that
+// every remaining key stays reachable.
+TEST(SharedHashTableTest, BackwardShiftDeletion) {
+  std::vector<uint64_t> keys = KeysWithHome(kCapacity - 2, 4);
+  for (uint64_t key : KeysWithHome(0, 3)) {
+    keys.push_back(key);
+  }
+  for (uint64_t key : KeysWithHome(kCapacity - 1, 2)) {
+    keys.push_back(key);
+  }
+  ASSERT_LE(keys.size() * 4, kCapacity * 3);
+
+  for (size_t rotation = 0; rotation < keys.size(); ++rotation) {
+    SharedHashTableWriter<Record> writer(kCapacity);
+    SharedHashTableReader<Record> reader = CreateReader(writer);
+    for (uint64_t key : keys) {
+      ASSERT_TRUE(writer.Insert(key, MakeRecord(key, key * 2)));
+    }
+    std::vector<uint64_t> order = keys;
+    std::rotate(order.begin(), order.begin() + rotation, order.end());
+    for (size_t removed = 0; removed < order.size(); ++removed) {
+      writer.Remove(order[removed]);
+      EXPECT_EQ(order.size() - removed - 1, writer.size());
+      for (size_t i = 0; i < order.size(); ++i) {
+        std::optional<Record> record = reader.Find(order[i]);
+        EXPECT_EQ(i > removed, record.has_value())
+            << "rotation " << rotation << " key " << order[i];
+        if (record) {
+          EXPECT_EQ(order[i] * 2, record->value);
+        }
+        EXPECT_EQ(record.has_value(), writer.Find(order[i]).has_value());
+      }
+    }
+  }
+}
+
+TEST(SharedHashTableTest, ReaderRejectsOtherTables) {
+  SharedHashTableWriter<Record> writer(kCapacity);
+  EXPECT_FALSE(SharedHashTableReader<OtherRecord>::Create(
+      writer.DuplicateReadOnlyRegion()));
+  EXPECT_FALSE(SharedHashTableReader<Record>::Create(
+      base::ReadOnlySharedMemoryRegion()));
+
+  base::MappedReadOnlyRegion zeroed = base::ReadOnlySharedMemoryRegion::Create(
+      shared_hash_table::GetRegionSize<Record>(kCapacity));
+  ASSERT_TRUE(zeroed.IsValid());
+  EXPECT_FALSE(
+      SharedHashTableReader<Record>::Create(std::move(zeroed.region)));
+}
+
+class ConcurrentReader : public base::DelegateSimpleThread::Delegate {
+ public:
+  ConcurrentReader(const SharedHashTableReader<Record>& reader,
+                   const std::vector<uint64_t>& keys,
+                   const std::atomic<bool>& done)
+      : reader_(reader), keys_(keys), done_(done) {}
+
+  // base::DelegateSimpleThread::Delegate:
+  void Run() override {
+    while (!done_.load(std::memory_order_relaxed)) {
+      for (uint64_t key : keys_) {
+        std::optional<Record> record = reader_.Find(key);
+        if (record && (record->key != key ||
+                       record->check != (record->key ^ record->value))) {
+          ++torn_reads_;
+        }
+      }
+    }
+  }
+
+  int torn_reads() const { return torn_reads_; }
+
+ private:
+  const SharedHashTableReader<Record>& reader_;
+  const std::vector<uint64_t>& keys_;
+  const std::atomic<bool>& done_;
+  int torn_reads_ = 0;
+};
+
+// Readers never see a record of another key or a half written record while
+// the writer keeps replacing records and shifting slots around.
+TEST(SharedHashTableTest, ReadersNeverSeeTornRecords) {
+  SharedHashTableWriter<Record> writer(kCapacity);
+  SharedHashTableReader<Record> reader = CreateReader(writer);
+  std::vector<uint64_t> keys = KeysWithHome(3, 6);
+  std::atomic<bool> done = false;
+
+  ConcurrentReader delegate(reader, keys, done);
+  base::DelegateSimpleThread thread(&delegate, "SharedHashTableReader");
+  thread.Start();
+  for (uint64_t value = 0; value < 20000; ++value) {
+    uint64_t key = keys[value % keys.size()];
+    if (value % 3 == 0) {
+      writer.Remove(key);
+    } else {
+      EXPECT_TRUE(writer.Insert(key, MakeRecord(key, value)));
+    }
+  }
+  done.store(true, std::memory_order_relaxed);
+  thread.Join();
+  EXPECT_EQ(0, delegate.torn_reads());
+}
+
+}  // namespace
+
+}  // namespace safe_deal
@@ -0,0 +1,201 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/string_interner.h"
+
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "base/check.h"
+#include "base/check_op.h"
+#include "base/containers/span.h"
+#include "base/hash/hash.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr uint32_t kEmptySlot = 0;
+constexpr uint32_t kRemovedSlot = std::numeric_limits<uint32_t>::max();
+
+constexpr size_t kMinTableCapacity = 64;
+
+// Small arenas are not worth compacting.
+constexpr size_t kMinCompactedArenaSize = 4096;
+
+}  // namespace
+
+StringInterner::StringInterner() : table_(kMinTableCapacity, kEmptySlot) {}
+
+StringInterner::~StringInterner() = default;
+
+InternedStringId StringInterner::Intern(std::string_view value) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  CHECK_LE(value.size(), std::numeric_limits<uint32_t>::max());
+  const uint32_t hash = Hash(value);
+  size_t slot = FindSlot(value, hash);
+  if (table_[slot] != kEmptySlot && table_[slot] != kRemovedSlot) {
+    ++entries_[table_[slot] - 1].ref_count;
+    return InternedStringId(table_[slot]);
+  }
+
+  // Keeps the table at most three quarters full, removed slots included.
+  if ((size() + removed_slots_ + 1) * 4 > table_.size() * 3) {
+    Rehash(size() * 2 + 2 > table_.size() ? table_.size() * 2
+                                          : table_.size());
+    slot = FindSlot(value, hash);
+  }
+
+  CHECK_LE(arena_.size() + value.size(), std::numeric_limits<uint32_t>::max());
+  const Entry entry = {.offset = static_cast<uint32_t>(arena_.size()),
+                       .length = static_cast<uint32_t>(value.size()),
+                       .hash = hash,
+                       .ref_count = 1};
+  arena_.append(value);
+  uint32_t id;
+  if (free_ids_.empty()) {
+    entries_.push_back(entry);
+    id = static_cast<uint32_t>(entries_.size());
+    CHECK_NE(id, kRemovedSlot);
+  } else {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+    entries_[id - 1] = entry;
+  }
+  if (table_[slot] == kRemovedSlot) {
+    --removed_slots_;
+  }
+  table_[slot] = id;
+  return InternedStringId(id);
+}
+
+void StringInterner::AddRef(InternedStringId id) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  Entry& entry = entries_[id.value() - 1];
+  DCHECK_GT(entry.ref_count, 0u);
+  ++entry.ref_count;
+}
+
+void StringInterner::Release(InternedStringId id) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  Entry& entry = entries_[id.value() - 1];
+  DCHECK_GT(entry.ref_count, 0u);
+  if (--entry.ref_count > 0) {
+    return;
+  }
+  size_t slot = FindSlot(GetString(entry), entry.hash);
+  DCHECK_EQ(table_[slot], id.value());
+  table_[slot] = kRemovedSlot;
+  ++removed_slots_;
+  dead_bytes_ += entry.length;
+  free_ids_.push_back(id.value());
+  if (dead_bytes_ * 2 > arena_.size() &&
+      arena_.size() >= kMinCompactedArenaSize) {
+    CompactArena();
+  }
+}
+
+std::string_view StringInterner::Get(InternedStringId id) const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  const Entry& entry = entries_[id.value() - 1];
+  DCHECK_GT(entry.ref_count, 0u);
+  return GetString(entry);
+}
+
+void StringInterner::Trim() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (dead_bytes_ > 0) {
+    CompactArena();
+  }
+  arena_.shrink_to_fit();
+  while (!entries_.empty() && entries_.back().ref_count == 0) {
+    entries_.pop_back();
+  }
+  std::erase_if(free_ids_,
+                [this](uint32_t id) { return id > entries_.size(); });
+  entries_.shrink_to_fit();
+  free_ids_.shrink_to_fit();
+
+  // At most half full, so that the next strings do not rehash right away.
+  size_t capacity = kMinTableCapacity;
+  while (capacity < size() * 2) {
+    capacity *= 2;
+  }
+  if (capacity < table_.size()) {
+    table_ = std::vector<uint32_t>();
+    Rehash(capacity);
+  } else if (removed_slots_ > 0) {
+    Rehash(table_.size());
+  }
+}
+
+size_t StringInterner::memory_usage() const {
+  return arena_.capacity() + entries_.capacity() * sizeof(Entry) +
+         free_ids_.capacity() * sizeof(uint32_t) +
+         table_.capacity() * sizeof(uint32_t);
+}
+
+// static
+uint32_t StringInterner::Hash(std::string_view value) {
+  return base::FastHash(base::as_byte_span(value));
+}
+
+size_t StringInterner::FindSlot(std::string_view value, uint32_t hash) const {
+  const size_t mask = table_.size() - 1;
+  std::optional<size_t> first_removed;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    const uint32_t id = table_[slot];
+    if (id == kEmptySlot) {
+      return first_removed.value_or(slot);
+    }
+    if (id == kRemovedSlot) {
+      if (!first_removed) {
+        first_removed = slot;
+      }
+      continue;
+    }
+    const Entry& entry = entries_[id - 1];
+    if (entry.hash == hash && GetString(entry) == value) {
+      return slot;
+    }
+  }
+}
+
+std::string_view StringInterner::GetString(const Entry& entry) const {
+  return std::string_view(arena_).substr(entry.offset, entry.length);
+}
+
+void StringInterner::Rehash(size_t capacity) {
+  table_.assign(capacity, kEmptySlot);
+  removed_slots_ = 0;
+  const size_t mask = capacity - 1;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (entries_[i].ref_count == 0) {
+      continue;
+    }
+    size_t slot = entries_[i].hash & mask;
+    while (table_[slot] != kEmptySlot) {
+      slot = (slot + 1) & mask;
+    }
+    table_[slot] = static_cast<uint32_t>(i + 1);
+  }
+}
+
+void StringInterner::CompactArena() {
+  std::string arena;
+  arena.reserve(arena_.size() - dead_bytes_);
+  for (Entry& entry : entries_) {
+    if (entry.ref_count == 0) {
+      continue;
+    }
+    const uint32_t offset = static_cast<uint32_t>(arena.size());
+    arena.append(GetString(entry));
+    entry.offset = offset;
+  }
+  arena_ = std::move(arena);
+  dead_bytes_ = 0;
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,99 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_STRING_INTERNER_H_
+#define SAFE_DEAL_COMMON_STRING_INTERNER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/sequence_checker.h"
+#include "base/types/strong_alias.h"
+
+namespace safe_deal {
+
+// Identifies a string of a StringInterner. Zero is never a valid id.
+using InternedStringId = base::StrongAlias<class InternedStringIdTag, uint32_t>;
+
+// Stores each distinct string once, in one contiguous arena, and refers to
+// it by a 32-bit id that stays valid while the string has references. Ids
+// are hash-consed: interning an equal string returns the same id. Caches
+// that keep many ids and marketplace identifiers pay 4 bytes per copy and
+// about 24 bytes plus the characters per distinct string, instead of a
+// std::string (32 bytes, plus a heap block for longer strings) per copy.
+//
+// Strings are reference counted and removed with their last reference. The
+// arena is compacted when more than half of it is unused, which moves the
+// characters but not the ids. Sequence affine.
+class StringInterner {
+ public:
+  StringInterner();
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+  ~StringInterner();
+
+  // Returns the id of |value| and adds a reference to it.
+  InternedStringId Intern(std::string_view value);
+
+  // Adds a reference to |id|.
+  void AddRef(InternedStringId id);
+
+  // Drops a reference to |id|. The id may be reused once its last reference
+  // is gone.
+  void Release(InternedStringId id);
+
+  // Returns the string of |id|. The view is invalidated by the next call to
+  // Intern() or Release().
+  std::string_view Get(InternedStringId id) const;
+
+  // Returns the memory of removed strings to the heap: compacts the arena,
+  // shrinks the lookup table to what the remaining strings need and drops
+  // trailing free ids.
+  void Trim();
+
+  // Number of distinct strings.
+  size_t size() const { return entries_.size() - free_ids_.size(); }
+
+  // Heap usage, including the arena and the lookup table.
+  size_t memory_usage() const;
+
+ private:
+  struct Entry {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t hash;
+    // Zero for free ids.
+    uint32_t ref_count;
+  };
+
+  static uint32_t Hash(std::string_view value);
+
+  // Returns the slot of |value| in |table_|, or the free slot to insert it
+  // in.
+  size_t FindSlot(std::string_view value, uint32_t hash) const;
+  std::string_view GetString(const Entry& entry) const;
+  void Rehash(size_t capacity);
+  void CompactArena();
+
+  std::string arena_;
+  // Bytes of |arena_| that belong to removed strings.
+  size_t dead_bytes_ = 0;
+  // Indexed by id - 1.
+  std::vector<Entry> entries_;
+  std::vector<uint32_t> free_ids_;
+  // Open addressing with linear probing over a power of two capacity. Holds
+  // ids, kEmptySlot or kRemovedSlot.
+  std::vector<uint32_t> table_;
+  size_t removed_slots_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_STRING_INTERNER_H_
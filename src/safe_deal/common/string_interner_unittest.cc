@@ -0,0 +1,161 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/string_interner.h"
+
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal {
+
+namespace {
+
+std::string MakeString(int i) {
+  return "https://www.example.com/item/" + std::to_string(i);
+}
+
+TEST(StringInternerTest, InternsEqualStringsOnce) {
+  StringInterner interner;
+  InternedStringId a = interner.Intern("B00EXAMPLE");
+  InternedStringId b = interner.Intern("1234567890");
+  InternedStringId empty = interner.Intern("");
+  EXPECT_NE(0u, a.value());
+  EXPECT_NE(0u, empty.value());
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, empty);
+  EXPECT_EQ(a, interner.Intern(std::string("B00EXAMPLE")));
+  EXPECT_EQ(empty, interner.Intern(""));
+  EXPECT_EQ(3u, interner.size());
+  EXPECT_EQ("B00EXAMPLE", interner.Get(a));
+  EXPECT_EQ("1234567890", interner.Get(b));
+  EXPECT_EQ("", interner.Get(empty));
+}
+
+TEST(StringInternerTest, RemovesStringsWithTheirLastReference) {
+  StringInterner interner;
+  InternedStringId a = interner.Intern("a");
+  interner.Intern("a");
+  interner.AddRef(a);
+  InternedStringId b = interner.Intern("b");
+
+  interner.Release(a);
+  interner.Release(a);
+  EXPECT_EQ("a", interner.Get(a));
+  EXPECT_EQ(2u, interner.size());
+  interner.Release(a);
+  EXPECT_EQ(1u, interner.size());
+  EXPECT_EQ("b", interner.Get(b));
+
+  // The freed id is reused, for another string.
+  EXPECT_EQ(a, interner.Intern("c"));
+  EXPECT_EQ("c", interner.Get(a));
+  EXPECT_NE(a, interner.Intern("a"));
+  EXPECT_EQ(3u, interner.size());
+}
+
+// Interning strings whose probe sequences cross removed slots neither loses
+// a live string nor adds it twice.
+TEST(StringInternerTest, ManyStrings) {
+  constexpr int kCount = 5000;
+  StringInterner interner;
+  std::vector<InternedStringId> ids;
+  for (int i = 0; i < kCount; ++i) {
+    ids.push_back(interner.Intern(MakeString(i)));
+  }
+  for (int i = 0; i < kCount; i += 2) {
+    interner.Release(ids[i]);
+  }
+  EXPECT_EQ(static_cast<size_t>(kCount / 2), interner.size());
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < kCount; ++i) {
+      InternedStringId id = interner.Intern(MakeString(i));
+      if (i % 2) {
+        EXPECT_EQ(ids[i], id);
+      } else {
+        ids[i] = id;
+      }
+      EXPECT_EQ(MakeString(i), interner.Get(id));
+    }
+    EXPECT_EQ(static_cast<size_t>(kCount), interner.size());
+    for (int i = 0; i < kCount; ++i) {
+      interner.Release(ids[i]);
+    }
+    EXPECT_EQ(static_cast<size_t>(kCount / 2), interner.size());
+  }
+  for (int i = 1; i < kCount; i += 2) {
+    EXPECT_EQ(MakeString(i), interner.Get(ids[i]));
+  }
+}
+
+TEST(StringInternerTest, CompactsArenaKeepingIds) {
+  StringInterner interner;
+  const std::string kLong(1000, 'x');
+  std::vector<InternedStringId> ids;
+  for (int i = 0; i < 10; ++i) {
+    ids.push_back(interner.Intern(kLong + std::to_string(i)));
+  }
+  const size_t usage = interner.memory_usage();
+  // Removing more than half of the arena compacts it.
+  for (int i = 0; i < 6; ++i) {
+    interner.Release(ids[i * 9 % 10]);
+  }
+  EXPECT_LT(interner.memory_usage(), usage - 4000);
+  for (int i : {1, 2, 3, 4}) {
+    EXPECT_EQ(kLong + std::to_string(i), interner.Get(ids[i]));
+    EXPECT_EQ(ids[i], interner.Intern(kLong + std::to_string(i)));
+  }
+}
+
+TEST(StringInternerTest, TrimDropsTrailingFreeIds) {
+  StringInterner interner;
+  InternedStringId a = interner.Intern("a");
+  InternedStringId b = interner.Intern("b");
+  InternedStringId c = interner.Intern("c");
+  interner.Release(b);
+  interner.Release(c);
+  interner.Trim();
+  EXPECT_EQ("a", interner.Get(a));
+  // Without the trailing ids, the next id is the one after |a|.
+  EXPECT_EQ(b, interner.Intern("d"));
+  EXPECT_EQ(c, interner.Intern("e"));
+  EXPECT_EQ(a, interner.Intern("a"));
+  EXPECT_EQ(3u, interner.size());
+}
+
+TEST(StringInternerTest, TrimReturnsMemory) {
+  constexpr int kCount = 10000;
+  StringInterner interner;
+  const size_t empty_usage = interner.memory_usage();
+  std::vector<InternedStringId> ids;
+  for (int i = 0; i < kCount; ++i) {
+    ids.push_back(interner.Intern(MakeString(i)));
+  }
+  const size_t full_usage = interner.memory_usage();
+  // Keep a string with a low id and one with a high id, which pins the size
+  // of the id table.
+  for (int i = 1; i < kCount - 1; ++i) {
+    interner.Release(ids[i]);
+  }
+  interner.Trim();
+  EXPECT_LT(interner.memory_usage(), full_usage / 2);
+  EXPECT_EQ(MakeString(0), interner.Get(ids[0]));
+  EXPECT_EQ(MakeString(kCount - 1), interner.Get(ids[kCount - 1]));
+  EXPECT_EQ(ids[0], interner.Intern(MakeString(0)));
+  EXPECT_EQ(ids[kCount - 1], interner.Intern(MakeString(kCount - 1)));
+
+  interner.Release(ids[kCount - 1]);
+  interner.Release(ids[kCount - 1]);
+  interner.Release(ids[0]);
+  interner.Release(ids[0]);
+  interner.Trim();
+  EXPECT_EQ(0u, interner.size());
+  EXPECT_LE(interner.memory_usage(), empty_usage);
+  EXPECT_EQ("a", interner.Get(interner.Intern("a")));
+}
+
+}  // namespace
+
+}  // namespace safe_deal
@@ -0,0 +1,29 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/common/thread_allocation_stats.h"
+
+#include "partition_alloc/buildflags.h"
+
+#if PA_BUILDFLAG(USE_PARTITION_ALLOC_AS_MALLOC)
+#include "partition_alloc/shim/allocator_shim_default_dispatch_to_partition_alloc.h"
+#endif
+
+namespace safe_deal {
+
+bool CanCountThreadAllocations() {
+  return PA_BUILDFLAG(USE_PARTITION_ALLOC_AS_MALLOC);
+}
+
+ThreadAllocationStats GetThreadAllocationStats() {
+#if PA_BUILDFLAG(USE_PARTITION_ALLOC_AS_MALLOC)
+  const partition_alloc::ThreadAllocStats stats =
+      allocator_shim::GetAllocStatsForCurrentThread();
+  return {.count = stats.alloc_count, .bytes = stats.alloc_total_size};
+#else
+  return {};
+#endif
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,36 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_COMMON_THREAD_ALLOCATION_STATS_H_
+#define SAFE_DEAL_COMMON_THREAD_ALLOCATION_STATS_H_
+
+#include <stdint.h>
+
+namespace safe_deal {
+
+// Heap allocations the calling thread made since it started, through malloc
+// and operator new, as counted by the allocator shim. Subtract two readings
+// for the allocations of the code between them.
+//
+// Only the shim is counted. Allocations from other PartitionAlloc roots,
+// such as SafeDealPartition, PageArena and Blink's partitions behind
+// WTF::String, and from Oilpan, are not. A zero count therefore says that
+// code made no malloc calls, not that code calling into Blink allocated
+// nothing.
+struct ThreadAllocationStats {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+};
+
+// False where the allocations are not counted, which is everywhere
+// PartitionAlloc is not malloc; GetThreadAllocationStats() then returns
+// zeros.
+bool CanCountThreadAllocations();
+
+// Reads a thread local; cheap enough for every request.
+ThreadAllocationStats GetThreadAllocationStats();
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_COMMON_THREAD_ALLOCATION_STATS_H_
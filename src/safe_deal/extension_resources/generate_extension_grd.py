@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+# Copyright 2024 The Safe Deal Authors
+# Use of this source code is governed by the Apache License, Version 2.0 that
+# can be found in the LICENSE file.
+"""Generates the .grd that packs the Safe Deal extension into a .pak.
+
+Every file of the unpacked extension becomes a BINDATA resource whose
+resource_path is its path under the component extension root, which is what
+ChromeComponentExtensionResourceManager looks resources up by.
+
+Resources read while the extension starts (the manifest, the strings of the
+default locale, the service worker and the content scripts) are stored
+uncompressed, so they are served straight from the memory-mapped pak. Other
+text resources are gzipped: they are rarely read, and the copy made on
+decompression is cheaper than keeping them in the binary at full size. Images
+and fonts are already compressed and stored as is.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+from xml.sax.saxutils import quoteattr
+
+COMPRESSIBLE_EXTENSIONS = {
+    '.css', '.html', '.js', '.json', '.mjs', '.svg', '.txt', '.wasm'
+}
+# Not needed at runtime.
+SKIPPED_EXTENSIONS = {'.map', '.md', '.ts'}
+
+
+def strip_comments(text):
+  """Removes the // and /* */ comments that Chrome accepts in manifests."""
+  return re.sub(r'("(?:\\.|[^"\\])*")|//[^\n]*|/\*.*?\*/',
+                lambda m: m.group(1) or '',
+                text,
+                flags=re.S)
+
+
+def startup_files(manifest):
+  files = {'manifest.json'}
+  background = manifest.get('background', {})
+  if 'service_worker' in background:
+    files.add(background['service_worker'])
+  files.update(background.get('scripts', []))
+  if 'page' in background:
+    files.add(background['page'])
+  for content_script in manifest.get('content_scripts', []):
+    files.update(content_script.get('js', []))
+    files.update(content_script.get('css', []))
+  if 'default_locale' in manifest:
+    files.add('_locales/%s/messages.json' % manifest['default_locale'])
+  return {os.path.normpath(f.lstrip('/')) for f in files}
+
+
+def resource_name(relative_path, used_names):
+  name = 'IDR_SAFE_DEAL_EXTENSION_' + re.sub(r'[^A-Z0-9]', '_',
+                                             relative_path.upper())
+  unique_name, suffix = name, 2
+  while unique_name in used_names:
+    unique_name = '%s_%d' % (name, suffix)
+    suffix += 1
+  used_names.add(unique_name)
+  return unique_name
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+  parser.add_argument('--extension-dir', required=True)
+  parser.add_argument('--root-directory',
+                      required=True,
+                      help='component extension root, under DIR_RESOURCES')
+  parser.add_argument('--output', required=True)
+  parser.add_argument('--depfile', required=True)
+  args = parser.parse_args()
+
+  manifest_path = os.path.join(args.extension_dir, 'manifest.json')
+  if not os.path.exists(manifest_path):
+    sys.exit('%s not found. Copy the Safe Deal extension into %s, see '
+             'README.md.' % (manifest_path, args.extension_dir))
+  with open(manifest_path, encoding='utf-8') as f:
+    manifest = json.loads(strip_comments(f.read()))
+  uncompressed = startup_files(manifest)
+
+  includes = []
+  # Directories are dependencies too: their timestamp changes when files are
+  # added or removed, which must regenerate the .grd.
+  dependencies = []
+  used_names = set()
+  for directory, subdirectories, files in os.walk(args.extension_dir):
+    subdirectories[:] = sorted(d for d in subdirectories
+                               if not d.startswith('.'))
+    dependencies.append(directory)
+    for filename in sorted(files):
+      extension = os.path.splitext(filename)[1].lower()
+      if filename.startswith('.') or extension in SKIPPED_EXTENSIONS:
+        continue
+      path = os.path.join(directory, filename)
+      relative_path = os.path.relpath(path, args.extension_dir).replace(
+          os.sep, '/')
+      dependencies.append(path)
+      if relative_path in uncompressed:
+        compress = 'false'
+      elif extension in COMPRESSIBLE_EXTENSIONS:
+        compress = 'gzip'
+      else:
+        compress = 'false'
+      includes.append(
+          '      <include name=%s file=%s resource_path=%s type="BINDATA" '
+          'compress="%s" />' %
+          (quoteattr(resource_name(relative_path, used_names)),
+           quoteattr(os.path.abspath(path)),
+           quoteattr(args.root_directory + '/' + relative_path), compress))
+
+  with open(args.output, 'w', encoding='utf-8') as f:
+    f.write('''<?xml version="1.0" encoding="UTF-8"?>
+<!-- Generated by %s. Do not edit. -->
+<grit latest_public_release="0" current_release="1" output_all_resource_defines="false">
+  <outputs>
+    <output filename="grit/safe_deal_extension_resources.h" type="rc_header">
+      <emit emit_type='prepend'></emit>
+    </output>
+    <output filename="grit/safe_deal_extension_resources_map.cc" type="resource_file_map_source" />
+    <output filename="grit/safe_deal_extension_resources_map.h" type="resource_map_header" />
+    <output filename="safe_deal_extension_resources.pak" type="data_package" />
+  </outputs>
+  <release seq="1">
+    <includes>
+%s
+    </includes>
+  </release>
+</grit>
+''' % (os.path.basename(__file__), '\n'.join(includes)))
+
+  with open(args.depfile, 'w', encoding='utf-8') as f:
+    f.write('%s: %s\n' % (args.output, ' '.join(
+        d.replace(' ', '\\ ') for d in dependencies)))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,353 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/https_upgrade/browser/https_upgrade_service.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/base_paths.h"
+#include "base/containers/flat_set.h"
+#include "base/files/file_util.h"
+#include "base/functional/bind.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/path_service.h"
+#include "base/task/thread_pool.h"
+#include "components/history/core/browser/history_types.h"
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+
+namespace safe_deal {
+
+namespace {
+
+using https_upgrade::HttpsUpgradeIndex;
+namespace flat = https_upgrade::flat;
+
+// See https_upgrade.gni.
+constexpr base::FilePath::CharType kPreloadFileName[] =
+    FILE_PATH_LITERAL("safe_deal_https_preload.index");
+
+constexpr base::FilePath::CharType kDirectoryName[] =
+    FILE_PATH_LITERAL("Safe Deal");
+constexpr base::FilePath::CharType kLearnedFileName[] =
+    FILE_PATH_LITERAL("HTTPS Hosts");
+
+// Coalesces the decisions of a browsing session into few writes.
+constexpr base::TimeDelta kWriteDelay = base::Seconds(30);
+
+constexpr uint32_t kUpgradeLifetimeDays = 365;
+// Short enough that a host which starts serving HTTPS is upgraded again
+// within a month.
+constexpr uint32_t kFallbackLifetimeDays = 30;
+// Confirming a decision younger than this is not worth a write.
+constexpr uint32_t kRefreshAfterDays = 7;
+// Keeps the learned file at 1 MB.
+constexpr size_t kMaxLearnedHosts = 65536;
+
+uint32_t GetDay(base::Time time) {
+  return (time - base::Time::UnixEpoch()).InDays();
+}
+
+uint32_t GetToday() {
+  return GetDay(base::Time::Now());
+}
+
+uint32_t GetAgeDays(const flat::Entry& entry, uint32_t today) {
+  // Clocks can go back.
+  return today > entry.day ? today - entry.day : 0;
+}
+
+bool IsExpired(const flat::Entry& entry, uint32_t today) {
+  if (!entry.day) {
+    return false;
+  }
+  return GetAgeDays(entry, today) >= (entry.decision == flat::kDecisionUpgrade
+                                          ? kUpgradeLifetimeDays
+                                          : kFallbackLifetimeDays);
+}
+
+// Saved entries may hold any value.
+HttpsUpgradeDecision ToDecision(flat::Decision decision) {
+  switch (decision) {
+    case flat::kDecisionUpgrade:
+      return HttpsUpgradeDecision::kUpgrade;
+    case flat::kDecisionFallback:
+      return HttpsUpgradeDecision::kFallback;
+  }
+  return HttpsUpgradeDecision::kUnknown;
+}
+
+HttpsUpgradeService::LoadedIndexes LoadIndexes(
+    const base::FilePath& preload_path,
+    const base::FilePath& learned_path) {
+  SafeDealStartupMetrics::Scope scope("LoadHttpsUpgradeIndexes");
+  HttpsUpgradeService::LoadedIndexes indexes;
+  auto preload_file = std::make_unique<base::MemoryMappedFile>();
+  bool preload_valid = preload_file->Initialize(preload_path) &&
+                       HttpsUpgradeIndex::Create(preload_file->bytes());
+  base::UmaHistogramBoolean("SafeDeal.HttpsUpgrade.PreloadValid",
+                            preload_valid);
+  if (preload_valid) {
+    indexes.preload_file = std::move(preload_file);
+  }
+
+  // The learned index is small enough to read; mapping it would keep the
+  // file from being replaced on Windows.
+  base::CreateDirectory(learned_path.DirName());
+  if (std::optional<std::vector<uint8_t>> data =
+          base::ReadFileToBytes(learned_path)) {
+    if (std::optional<HttpsUpgradeIndex> learned =
+            HttpsUpgradeIndex::Create(*data)) {
+      indexes.learned.assign(learned->entries().begin(),
+                             learned->entries().end());
+    }
+  }
+  return indexes;
+}
+
+}  // namespace
+
+HttpsUpgradeService::LoadedIndexes::LoadedIndexes() = default;
+HttpsUpgradeService::LoadedIndexes::LoadedIndexes(LoadedIndexes&&) = default;
+HttpsUpgradeService::LoadedIndexes&
+HttpsUpgradeService::LoadedIndexes::operator=(LoadedIndexes&&) = default;
+HttpsUpgradeService::LoadedIndexes::~LoadedIndexes() = default;
+
+HttpsUpgradeService::HttpsUpgradeService(base::FilePath preload_path,
+                                         const base::FilePath& profile_path,
+                                         SafeDealMemoryBudget* budget,
+                                         history::HistoryService* history)
+    : budget_(budget),
+      file_task_runner_(base::ThreadPool::CreateSequencedTaskRunner(
+          {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+           base::TaskShutdownBehavior::BLOCK_SHUTDOWN})),
+      writer_(profile_path.Append(kDirectoryName).Append(kLearnedFileName),
+              file_task_runner_,
+              kWriteDelay,
+              "SafeDealHttpsHosts") {
+  file_task_runner_->PostTaskAndReplyWithResult(
+      FROM_HERE,
+      base::BindOnce(&LoadIndexes, std::move(preload_path), writer_.path()),
+      base::BindOnce(&HttpsUpgradeService::OnLoaded,
+                     weak_factory_.GetWeakPtr()));
+  budget_->AddClient(this, MemoryEvictionPriority::kLearned,
+                     "https_upgrade_learned", "Learned HTTPS decisions");
+  if (history) {
+    history_observation_.Observe(history);
+  }
+}
+
+HttpsUpgradeService::~HttpsUpgradeService() {
+  budget_->RemoveClient(this);
+}
+
+// static
+base::FilePath HttpsUpgradeService::GetDefaultPreloadPath() {
+  base::FilePath assets_dir;
+  if (!base::PathService::Get(base::DIR_ASSETS, &assets_dir)) {
+    return base::FilePath();
+  }
+  return assets_dir.Append(kPreloadFileName);
+}
+
+HttpsUpgradeDecision HttpsUpgradeService::GetDecision(
+    std::string_view host) const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  uint64_t host_hash = https_upgrade::ComputeHostHash(host);
+  if (auto it = learned_.find(host_hash);
+      it != learned_.end() && !IsExpired(it->second, GetToday())) {
+    return ToDecision(it->second.decision);
+  }
+  if (!preload_) {
+    return HttpsUpgradeDecision::kUnknown;
+  }
+  if (const flat::Entry* entry = preload_->FindEntry(host_hash)) {
+    return ToDecision(entry->decision);
+  }
+  return preload_->MayContain(host_hash) ? HttpsUpgradeDecision::kUpgrade
+                                         : HttpsUpgradeDecision::kUnknown;
+}
+
+void HttpsUpgradeService::LearnDecision(std::string_view host,
+                                        HttpsUpgradeDecision decision) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(decision != HttpsUpgradeDecision::kUnknown);
+  const flat::Decision flat_decision =
+      decision == HttpsUpgradeDecision::kUpgrade ? flat::kDecisionUpgrade
+                                                 : flat::kDecisionFallback;
+  const uint32_t today = GetToday();
+  uint64_t host_hash = https_upgrade::ComputeHostHash(host);
+  const size_t learned_count = learned_.size();
+  flat::Entry& entry = learned_[host_hash];
+  // HTTP only hosts are not refreshed, so that they are tried over HTTPS
+  // again once the decision expires, however often they are visited.
+  if (entry.decision == flat_decision && !IsExpired(entry, today) &&
+      (flat_decision == flat::kDecisionFallback ||
+       GetAgeDays(entry, today) < kRefreshAfterDays)) {
+    return;
+  }
+  const bool grew = learned_.size() > learned_count;
+  entry = {.host_hash = host_hash, .day = today, .decision = flat_decision};
+  if (learned_.size() > kMaxLearnedHosts) {
+    // Drops the oldest quarter so that pruning stays rare.
+    PruneLearned(learned_.size() / 4);
+  }
+  writer_.ScheduleWrite(this);
+  if (grew) {
+    budget_->OnMemoryUsageGrew();
+  }
+}
+
+void HttpsUpgradeService::ClearLearnedDecisions(base::Time delete_begin) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  // Decisions only know their day, so the whole first day goes.
+  const uint32_t begin_day = delete_begin.is_null() ? 0 : GetDay(delete_begin);
+  base::EraseIf(learned_, [begin_day](const auto& item) {
+    return item.second.day >= begin_day;
+  });
+  OnLearnedDecisionsCleared();
+}
+
+void HttpsUpgradeService::ClearLearnedDecisionsForHosts(
+    const std::vector<std::string>& hosts) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  for (const std::string& host : hosts) {
+    learned_.erase(https_upgrade::ComputeHostHash(host));
+  }
+  OnLearnedDecisionsCleared();
+}
+
+size_t HttpsUpgradeService::preload_size() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return preload_file_ ? preload_file_->length() : 0;
+}
+
+void HttpsUpgradeService::Shutdown() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  history_observation_.Reset();
+  if (writer_.HasPendingWrite()) {
+    writer_.DoScheduledWrite();
+  }
+}
+
+std::optional<std::string> HttpsUpgradeService::SerializeData() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  const uint32_t today = GetToday();
+  std::vector<flat::Entry> entries;
+  entries.reserve(learned_.size());
+  for (const auto& [host_hash, entry] : learned_) {
+    if (!IsExpired(entry, today)) {
+      entries.push_back(entry);
+    }
+  }
+  std::vector<uint8_t> data =
+      https_upgrade::BuildHttpsUpgradeIndex({}, std::move(entries));
+  return std::string(data.begin(), data.end());
+}
+
+size_t HttpsUpgradeService::GetMemoryUsage() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return learned_.size() * sizeof(decltype(learned_)::value_type);
+}
+
+void HttpsUpgradeService::EvictMemory(size_t target_bytes) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  const size_t keep = target_bytes / sizeof(decltype(learned_)::value_type);
+  if (learned_.size() <= keep) {
+    return;
+  }
+  // Saves the evicted decisions if a write is pending anyway. Later writes
+  // drop them, like expired ones; they are learned again on the next
+  // navigation to their host.
+  if (writer_.HasPendingWrite()) {
+    writer_.DoScheduledWrite();
+  }
+  PruneLearned(learned_.size() - keep);
+  auto entries = std::move(learned_).extract();
+  entries.shrink_to_fit();
+  learned_.replace(std::move(entries));
+}
+
+void HttpsUpgradeService::OnHistoryDeletions(
+    history::HistoryService* history_service,
+    const history::DeletionInfo& deletion_info) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (deletion_info.IsAllHistory()) {
+    ClearLearnedDecisions(base::Time());
+    return;
+  }
+  // Hosts visited in the range may still have visits outside it, but a
+  // decision does not say which visit taught it.
+  if (deletion_info.time_range().IsValid()) {
+    ClearLearnedDecisions(deletion_info.time_range().begin());
+    return;
+  }
+  std::vector<std::string> hosts;
+  hosts.reserve(deletion_info.deleted_rows().size());
+  for (const history::URLRow& row : deletion_info.deleted_rows()) {
+    hosts.push_back(row.url().host());
+  }
+  ClearLearnedDecisionsForHosts(hosts);
+}
+
+void HttpsUpgradeService::HistoryServiceBeingDeleted(
+    history::HistoryService* history_service) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  history_observation_.Reset();
+}
+
+void HttpsUpgradeService::OnLoaded(LoadedIndexes indexes) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  loaded_ = true;
+  preload_file_ = std::move(indexes.preload_file);
+  if (preload_file_) {
+    preload_ = HttpsUpgradeIndex::Create(preload_file_->bytes());
+  }
+  base::UmaHistogramCounts100000("SafeDeal.HttpsUpgrade.LearnedHostCount",
+                                 indexes.learned.size());
+  if (discard_saved_) {
+    indexes.learned.clear();
+  }
+  // Entries learned while loading are newer, so they win.
+  std::vector<std::pair<uint64_t, flat::Entry>> saved;
+  saved.reserve(indexes.learned.size());
+  for (const flat::Entry& entry : indexes.learned) {
+    saved.emplace_back(entry.host_hash, entry);
+  }
+  learned_.insert(saved.begin(), saved.end());
+  if (learned_.size() > kMaxLearnedHosts) {
+    PruneLearned(learned_.size() / 4);
+  }
+  budget_->OnMemoryUsageGrew();
+}
+
+void HttpsUpgradeService::OnLearnedDecisionsCleared() {
+  if (!loaded_) {
+    discard_saved_ = true;
+  }
+  // The deleted decisions must not outlive the deletion on disk.
+  writer_.ScheduleWrite(this);
+  writer_.DoScheduledWrite();
+}
+
+void HttpsUpgradeService::PruneLearned(size_t count) {
+  std::vector<std::pair<uint32_t, uint64_t>> ages;
+  ages.reserve(learned_.size());
+  for (const auto& [host_hash, entry] : learned_) {
+    ages.emplace_back(entry.day, host_hash);
+  }
+  auto cutoff = ages.begin() + std::min(count, ages.size());
+  std::ranges::nth_element(ages, cutoff);
+  std::vector<uint64_t> oldest;
+  oldest.reserve(cutoff - ages.begin());
+  for (auto it = ages.begin(); it != cutoff; ++it) {
+    oldest.push_back(it->second);
+  }
+  base::flat_set<uint64_t> evicted(std::move(oldest));
+  base::EraseIf(learned_, [&evicted](const auto& item) {
+    return evicted.contains(item.first);
+  });
+}
+
+}  // namespace safe_deal
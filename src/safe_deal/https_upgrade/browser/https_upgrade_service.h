@@ -0,0 +1,151 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_HTTPS_UPGRADE_BROWSER_HTTPS_UPGRADE_SERVICE_H_
+#define SAFE_DEAL_HTTPS_UPGRADE_BROWSER_HTTPS_UPGRADE_SERVICE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/files/file_path.h"
+#include "base/files/important_file_writer.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/raw_ptr.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/scoped_observation.h"
+#include "base/sequence_checker.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "components/history/core/browser/history_service.h"
+#include "components/history/core/browser/history_service_observer.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "safe_deal/common/safe_deal_memory_budget.h"
+#include "safe_deal/https_upgrade/core/https_upgrade_index.h"
+
+namespace safe_deal {
+
+// Recorded in SafeDeal.HttpsUpgrade.Decision; do not renumber.
+enum class HttpsUpgradeDecision {
+  // Let the browser try HTTPS and fall back to HTTP if that fails.
+  kUnknown = 0,
+  // The host serves HTTPS.
+  kUpgrade = 1,
+  // The host does not serve HTTPS; load it over HTTP without trying.
+  kFallback = 2,
+  kMaxValue = kFallback,
+};
+
+// Per-profile HTTPS upgrade decisions. Combines the preloaded index shipped
+// next to the browser executable, which is memory-mapped, with decisions
+// learned from the profile's own navigations, which are kept as a sorted
+// array in memory and saved to the profile directory in the same format.
+// Lookups are synchronous and never touch the network. Learned decisions
+// win over preloaded ones and expire, so that a host that stops or starts
+// serving HTTPS is tried again. Learned decisions record which hosts were
+// visited, so they are deleted with the profile's history. They are also a
+// client of the profile's SafeDealMemoryBudget, which has the oldest evicted
+// first. UI thread only.
+class HttpsUpgradeService : public KeyedService,
+                            public base::ImportantFileWriter::DataSerializer,
+                            public SafeDealMemoryBudget::Client,
+                            public history::HistoryServiceObserver {
+ public:
+  // |budget| must outlive the service. |history| may be null, in which case
+  // learned decisions are only deleted through the Clear methods.
+  HttpsUpgradeService(base::FilePath preload_path,
+                      const base::FilePath& profile_path,
+                      SafeDealMemoryBudget* budget,
+                      history::HistoryService* history);
+  HttpsUpgradeService(const HttpsUpgradeService&) = delete;
+  HttpsUpgradeService& operator=(const HttpsUpgradeService&) = delete;
+  ~HttpsUpgradeService() override;
+
+  // Returns the default preloaded index location, next to the browser
+  // executable.
+  static base::FilePath GetDefaultPreloadPath();
+
+  // Returns kUnknown for hosts in neither index, and for all but learned
+  // hosts until the preloaded index is loaded. |host| must be canonical, as
+  // in GURL::host().
+  HttpsUpgradeDecision GetDecision(std::string_view host) const;
+
+  // Records that a navigation to |host| succeeded over HTTPS (kUpgrade) or
+  // was served over HTTP after the browser's own fallback (kFallback).
+  // Learning kFallback again does not extend an unexpired decision.
+  void LearnDecision(std::string_view host, HttpsUpgradeDecision decision);
+
+  // Deletes the decisions learned or confirmed on or after the day of
+  // |delete_begin|, or all of them for a null time, and saves the rest right
+  // away.
+  void ClearLearnedDecisions(base::Time delete_begin);
+  // Deletes the decisions learned for |hosts| and saves the rest right away.
+  void ClearLearnedDecisionsForHosts(const std::vector<std::string>& hosts);
+
+  // Size of the mapped preloaded index.
+  size_t preload_size() const;
+
+  // KeyedService:
+  void Shutdown() override;
+
+  // base::ImportantFileWriter::DataSerializer:
+  std::optional<std::string> SerializeData() override;
+
+  // SafeDealMemoryBudget::Client:
+  size_t GetMemoryUsage() const override;
+  void EvictMemory(size_t target_bytes) override;
+
+  // history::HistoryServiceObserver:
+  void OnHistoryDeletions(history::HistoryService* history_service,
+                          const history::DeletionInfo& deletion_info) override;
+  void HistoryServiceBeingDeleted(
+      history::HistoryService* history_service) override;
+
+  struct LoadedIndexes {
+    LoadedIndexes();
+    LoadedIndexes(LoadedIndexes&&);
+    LoadedIndexes& operator=(LoadedIndexes&&);
+    ~LoadedIndexes();
+
+    std::unique_ptr<base::MemoryMappedFile> preload_file;
+    std::vector<https_upgrade::flat::Entry> learned;
+  };
+
+ private:
+  void OnLoaded(LoadedIndexes indexes);
+  // Saves the learned decisions after some were deleted.
+  void OnLearnedDecisionsCleared();
+  // Drops the |count| oldest learned decisions.
+  void PruneLearned(size_t count);
+
+  const raw_ptr<SafeDealMemoryBudget> budget_;
+  const scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+  std::unique_ptr<base::MemoryMappedFile> preload_file_;
+  std::optional<https_upgrade::HttpsUpgradeIndex> preload_;
+  // Keyed by host hash. Decisions learned before the saved ones are loaded
+  // win over them.
+  base::flat_map<uint64_t, https_upgrade::flat::Entry> learned_;
+  bool loaded_ = false;
+  // Set when decisions are deleted before the saved ones are loaded, which
+  // are then dropped rather than bringing deleted decisions back.
+  bool discard_saved_ = false;
+  base::ImportantFileWriter writer_;
+  base::ScopedObservation<history::HistoryService,
+                          history::HistoryServiceObserver>
+      history_observation_{this};
+
+  SEQUENCE_CHECKER(sequence_checker_);
+  base::WeakPtrFactory<HttpsUpgradeService> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_HTTPS_UPGRADE_BROWSER_HTTPS_UPGRADE_SERVICE_H_
@@ -0,0 +1,134 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/https_upgrade/browser/https_upgrade_service.h"
+
+#include <memory>
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "components/history/core/browser/history_types.h"
+#include "components/history/core/browser/url_row.h"
+#include "safe_deal/common/safe_deal_memory_budget.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr char kHost[] = "shop.example";
+constexpr char kOtherHost[] = "deals.example";
+
+class HttpsUpgradeServiceTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    service_ = CreateService();
+    task_environment_.RunUntilIdle();
+  }
+
+  // Has no preloaded index, so only learned decisions are found.
+  std::unique_ptr<HttpsUpgradeService> CreateService() {
+    return std::make_unique<HttpsUpgradeService>(
+        temp_dir_.GetPath().AppendASCII("missing.index"), temp_dir_.GetPath(),
+        &budget_, /*history=*/nullptr);
+  }
+
+  // Saves the learned decisions and loads them into a new service.
+  void Restart() {
+    service_->Shutdown();
+    service_.reset();
+    service_ = CreateService();
+    task_environment_.RunUntilIdle();
+  }
+
+  void LearnBoth() {
+    service_->LearnDecision(kHost, HttpsUpgradeDecision::kUpgrade);
+    service_->LearnDecision(kOtherHost, HttpsUpgradeDecision::kFallback);
+  }
+
+  base::test::TaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+  base::ScopedTempDir temp_dir_;
+  SafeDealMemoryBudget budget_{/*ceiling=*/1024 * 1024,
+                               /*enforce_ceiling=*/false};
+  std::unique_ptr<HttpsUpgradeService> service_;
+};
+
+TEST_F(HttpsUpgradeServiceTest, LearnedDecisionsAreSaved) {
+  LearnBoth();
+  Restart();
+  EXPECT_EQ(HttpsUpgradeDecision::kUpgrade, service_->GetDecision(kHost));
+  EXPECT_EQ(HttpsUpgradeDecision::kFallback,
+            service_->GetDecision(kOtherHost));
+}
+
+TEST_F(HttpsUpgradeServiceTest, AllHistoryDeletion) {
+  LearnBoth();
+  service_->OnHistoryDeletions(nullptr,
+                               history::DeletionInfo::ForAllHistory());
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown, service_->GetDecision(kHost));
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown,
+            service_->GetDecision(kOtherHost));
+
+  // The deletion is saved right away, without waiting for shutdown.
+  task_environment_.RunUntilIdle();
+  service_.reset();
+  service_ = CreateService();
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown, service_->GetDecision(kHost));
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown,
+            service_->GetDecision(kOtherHost));
+}
+
+TEST_F(HttpsUpgradeServiceTest, UrlDeletion) {
+  LearnBoth();
+  service_->OnHistoryDeletions(
+      nullptr, history::DeletionInfo::ForUrls(
+                   {history::URLRow(GURL("https://shop.example/item/1"))},
+                   /*favicon_urls=*/{}));
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown, service_->GetDecision(kHost));
+  EXPECT_EQ(HttpsUpgradeDecision::kFallback,
+            service_->GetDecision(kOtherHost));
+
+  Restart();
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown, service_->GetDecision(kHost));
+  EXPECT_EQ(HttpsUpgradeDecision::kFallback,
+            service_->GetDecision(kOtherHost));
+}
+
+TEST_F(HttpsUpgradeServiceTest, ClearSince) {
+  service_->LearnDecision(kHost, HttpsUpgradeDecision::kUpgrade);
+  task_environment_.FastForwardBy(base::Days(3));
+  service_->LearnDecision(kOtherHost, HttpsUpgradeDecision::kFallback);
+
+  service_->ClearLearnedDecisions(base::Time::Now() - base::Days(1));
+  EXPECT_EQ(HttpsUpgradeDecision::kUpgrade, service_->GetDecision(kHost));
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown,
+            service_->GetDecision(kOtherHost));
+}
+
+// Saved decisions that finish loading after a deletion must not bring the
+// deleted ones back.
+TEST_F(HttpsUpgradeServiceTest, ClearBeforeLoaded) {
+  LearnBoth();
+  service_->Shutdown();
+  service_.reset();
+  service_ = CreateService();
+  service_->ClearLearnedDecisions(base::Time());
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown, service_->GetDecision(kHost));
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown,
+            service_->GetDecision(kOtherHost));
+
+  Restart();
+  EXPECT_EQ(HttpsUpgradeDecision::kUnknown, service_->GetDecision(kHost));
+}
+
+}  // namespace
+
+}  // namespace safe_deal
@@ -0,0 +1,140 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/https_upgrade/core/https_upgrade_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string>
+
+#include "base/check.h"
+#include "base/numerics/byte_conversions.h"
+#include "base/numerics/checked_math.h"
+#include "crypto/sha2.h"
+
+namespace safe_deal::https_upgrade {
+
+namespace {
+
+constexpr uint32_t kBloomBitsPerHost = 10;
+// Optimal for ten bits per host.
+constexpr uint32_t kBloomHashCount = 7;
+// Bounds the work of a lookup in a corrupt index.
+constexpr uint32_t kMaxBloomHashCount = 32;
+
+// Double hashing: probe i is at h1 + i * h2. |h2| is odd so that the probes
+// of one host are distinct.
+template <typename Function>
+void ForEachBloomBit(uint64_t host_hash,
+                     uint32_t hash_count,
+                     uint64_t bit_mask,
+                     Function function) {
+  const uint64_t h1 = host_hash & 0xffffffff;
+  const uint64_t h2 = (host_hash >> 32) | 1;
+  for (uint32_t i = 0; i < hash_count; ++i) {
+    function((h1 + i * h2) & bit_mask);
+  }
+}
+
+}  // namespace
+
+uint64_t ComputeHostHash(std::string_view host) {
+  std::string digest = crypto::SHA256HashString(host);
+  return base::U64FromLittleEndian(
+      base::as_byte_span(digest).first<sizeof(uint64_t)>());
+}
+
+// static
+std::optional<HttpsUpgradeIndex> HttpsUpgradeIndex::Create(
+    base::span<const uint8_t> data) {
+  if (data.size() < sizeof(flat::Header) ||
+      reinterpret_cast<uintptr_t>(data.data()) % alignof(uint64_t) != 0) {
+    return std::nullopt;
+  }
+  const auto* header = reinterpret_cast<const flat::Header*>(data.data());
+  base::CheckedNumeric<size_t> size = sizeof(flat::Header);
+  size += base::CheckMul(size_t{header->bloom_word_count}, sizeof(uint64_t));
+  size += base::CheckMul(size_t{header->entry_count}, sizeof(flat::Entry));
+  if (header->magic != flat::kMagic || header->version != flat::kVersion ||
+      header->total_size != data.size() || !size.IsValid() ||
+      size.ValueOrDie() != data.size() ||
+      (header->bloom_word_count &&
+       (!std::has_single_bit(header->bloom_word_count) ||
+        !header->bloom_hash_count ||
+        header->bloom_hash_count > kMaxBloomHashCount))) {
+    return std::nullopt;
+  }
+  // Sections are 8-byte aligned within a mapping that is page aligned.
+  base::span<const uint8_t> rest = data.subspan(sizeof(flat::Header));
+  base::span<const uint64_t> bloom(
+      reinterpret_cast<const uint64_t*>(rest.data()),
+      header->bloom_word_count);
+  rest = rest.subspan(bloom.size_bytes());
+  base::span<const flat::Entry> entries(
+      reinterpret_cast<const flat::Entry*>(rest.data()), header->entry_count);
+  return HttpsUpgradeIndex(bloom, header->bloom_hash_count, entries);
+}
+
+HttpsUpgradeIndex::HttpsUpgradeIndex(base::span<const uint64_t> bloom,
+                                     uint32_t bloom_hash_count,
+                                     base::span<const flat::Entry> entries)
+    : bloom_(bloom), bloom_hash_count_(bloom_hash_count), entries_(entries) {}
+
+bool HttpsUpgradeIndex::MayContain(uint64_t host_hash) const {
+  if (bloom_.empty()) {
+    return false;
+  }
+  bool contained = true;
+  ForEachBloomBit(host_hash, bloom_hash_count_, bloom_.size() * 64 - 1,
+                  [&](uint64_t bit) {
+                    contained &= (bloom_[bit / 64] >> (bit % 64)) & 1;
+                  });
+  return contained;
+}
+
+const flat::Entry* HttpsUpgradeIndex::FindEntry(uint64_t host_hash) const {
+  auto it = std::ranges::lower_bound(entries_, host_hash, {},
+                                     &flat::Entry::host_hash);
+  return it != entries_.end() && it->host_hash == host_hash ? &*it : nullptr;
+}
+
+std::vector<uint8_t> BuildHttpsUpgradeIndex(
+    base::span<const uint64_t> bloom_hosts,
+    std::vector<flat::Entry> entries) {
+  std::vector<uint64_t> bloom;
+  if (!bloom_hosts.empty()) {
+    bloom.resize(std::bit_ceil(
+        (bloom_hosts.size() * kBloomBitsPerHost + 63) / 64));
+    for (uint64_t host_hash : bloom_hosts) {
+      ForEachBloomBit(host_hash, kBloomHashCount, bloom.size() * 64 - 1,
+                      [&](uint64_t bit) {
+                        bloom[bit / 64] |= uint64_t{1} << (bit % 64);
+                      });
+    }
+  }
+  std::ranges::sort(entries, {}, &flat::Entry::host_hash);
+  DCHECK(std::ranges::adjacent_find(entries, {}, &flat::Entry::host_hash) ==
+         entries.end());
+
+  flat::Header header = {};
+  header.magic = flat::kMagic;
+  header.version = flat::kVersion;
+  header.bloom_hash_count = kBloomHashCount;
+  header.bloom_word_count = bloom.size();
+  header.entry_count = entries.size();
+  header.total_size = sizeof(header) + bloom.size() * sizeof(uint64_t) +
+                      entries.size() * sizeof(flat::Entry);
+
+  std::vector<uint8_t> data(header.total_size);
+  uint8_t* out = data.data();
+  std::memcpy(out, &header, sizeof(header));
+  out += sizeof(header);
+  std::memcpy(out, bloom.data(), bloom.size() * sizeof(uint64_t));
+  out += bloom.size() * sizeof(uint64_t);
+  std::memcpy(out, entries.data(), entries.size() * sizeof(flat::Entry));
+  return data;
+}
+
+}  // namespace safe_deal::https_upgrade
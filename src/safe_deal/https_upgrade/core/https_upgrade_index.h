@@ -0,0 +1,65 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_HTTPS_UPGRADE_CORE_HTTPS_UPGRADE_INDEX_H_
+#define SAFE_DEAL_HTTPS_UPGRADE_CORE_HTTPS_UPGRADE_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "base/containers/span.h"
+#include "safe_deal/https_upgrade/core/https_upgrade_index_format.h"
+
+namespace safe_deal::https_upgrade {
+
+// Returns a 64-bit hash of a lowercase host name. It is persisted in the
+// preloaded and learned indexes, so the algorithm must never change.
+uint64_t ComputeHostHash(std::string_view host);
+
+// Read-only view of an index in the format of https_upgrade_index_format.h.
+// Does not own the data, which is usually a memory-mapped file. Lookups
+// touch one cache line per bloom probe plus a binary search over the
+// entries, and never allocate. Thread safe.
+class HttpsUpgradeIndex {
+ public:
+  // Returns nullopt if |data| is not a valid index of the current version.
+  static std::optional<HttpsUpgradeIndex> Create(
+      base::span<const uint8_t> data);
+
+  HttpsUpgradeIndex(const HttpsUpgradeIndex&) = default;
+  HttpsUpgradeIndex& operator=(const HttpsUpgradeIndex&) = default;
+  ~HttpsUpgradeIndex() = default;
+
+  // Returns false if the host is certainly not in the bloom filter.
+  bool MayContain(uint64_t host_hash) const;
+
+  // Returns the entry for the host, or nullptr.
+  const flat::Entry* FindEntry(uint64_t host_hash) const;
+
+  base::span<const flat::Entry> entries() const { return entries_; }
+
+ private:
+  HttpsUpgradeIndex(base::span<const uint64_t> bloom,
+                    uint32_t bloom_hash_count,
+                    base::span<const flat::Entry> entries);
+
+  base::span<const uint64_t> bloom_;
+  uint32_t bloom_hash_count_;
+  base::span<const flat::Entry> entries_;
+};
+
+// Serializes an index. |bloom_hosts| are hashes of the hosts known to
+// support HTTPS; the bloom filter is sized for about 1% false positives.
+// |entries| need not be sorted and must not hold a host twice.
+std::vector<uint8_t> BuildHttpsUpgradeIndex(
+    base::span<const uint64_t> bloom_hosts,
+    std::vector<flat::Entry> entries);
+
+}  // namespace safe_deal::https_upgrade
+
+#endif  // SAFE_DEAL_HTTPS_UPGRADE_CORE_HTTPS_UPGRADE_INDEX_H_
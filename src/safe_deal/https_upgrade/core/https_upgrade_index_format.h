@@ -0,0 +1,61 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_HTTPS_UPGRADE_CORE_HTTPS_UPGRADE_INDEX_FORMAT_H_
+#define SAFE_DEAL_HTTPS_UPGRADE_CORE_HTTPS_UPGRADE_INDEX_FORMAT_H_
+
+#include <stdint.h>
+
+// Layout of an HTTPS upgrade index. The preloaded index is produced by
+// safe_deal_https_preload_compiler at build time and mapped read-only by the
+// browser; nothing in it is parsed or copied before use. All integers are
+// little endian.
+//
+//   Header
+//   uint64_t bloom[bloom_word_count]  Hosts known to support HTTPS.
+//   Entry entries[entry_count]        Sorted by host hash.
+//
+// The bloom filter holds the bulk of the list at about ten bits per host.
+// A false positive only makes the browser try HTTPS first, which it does for
+// unknown hosts anyway. Decisions that must be exact, i.e. serving a host
+// over HTTP without trying HTTPS, are entries, which store the whole hash.
+namespace safe_deal::https_upgrade::flat {
+
+inline constexpr uint32_t kMagic = 0x55484453;  // "SDHU"
+// Bump whenever the layout below changes.
+inline constexpr uint32_t kVersion = 1;
+
+enum Decision : uint8_t {
+  kDecisionUpgrade = 1,
+  kDecisionFallback = 2,
+};
+
+struct Entry {
+  uint64_t host_hash;
+  // Days since the Unix epoch when the decision was made, or 0 for
+  // decisions that do not expire.
+  uint32_t day;
+  Decision decision;
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(Entry) == 16);
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t total_size;
+  // Bit positions probed per host.
+  uint32_t bloom_hash_count;
+  // Power of two, or zero.
+  uint32_t bloom_word_count;
+  uint32_t entry_count;
+  uint32_t reserved[2];
+};
+
+static_assert(sizeof(Header) % sizeof(uint64_t) == 0);
+
+}  // namespace safe_deal::https_upgrade::flat
+
+#endif  // SAFE_DEAL_HTTPS_UPGRADE_CORE_HTTPS_UPGRADE_INDEX_FORMAT_H_
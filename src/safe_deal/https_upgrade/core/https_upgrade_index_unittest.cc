@@ -0,0 +1,168 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/https_upgrade/core/https_upgrade_index.h"
+
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "base/containers/span.h"
+#include "safe_deal/https_upgrade/core/https_upgrade_index_format.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal::https_upgrade {
+
+namespace {
+
+flat::Entry MakeEntry(uint64_t host_hash,
+                      flat::Decision decision,
+                      uint32_t day) {
+  flat::Entry entry = {};
+  entry.host_hash = host_hash;
+  entry.decision = decision;
+  entry.day = day;
+  return entry;
+}
+
+// Keeps serialized indexes 8-byte aligned, as in a mapped file.
+class AlignedIndex {
+ public:
+  explicit AlignedIndex(const std::vector<uint8_t>& data)
+      : words_((data.size() + 7) / 8), size_(data.size()) {
+    std::memcpy(words_.data(), data.data(), data.size());
+  }
+
+  base::span<const uint8_t> bytes() const {
+    return base::as_bytes(base::span(words_)).first(size_);
+  }
+
+  flat::Header& header() {
+    return *reinterpret_cast<flat::Header*>(words_.data());
+  }
+
+  std::optional<HttpsUpgradeIndex> Create() const {
+    return HttpsUpgradeIndex::Create(bytes());
+  }
+
+ private:
+  std::vector<uint64_t> words_;
+  size_t size_;
+};
+
+TEST(HttpsUpgradeIndexTest, HostHashIsStable) {
+  // Persisted in preloaded and learned indexes.
+  EXPECT_EQ(0xa5b9afeef6a679a3u, ComputeHostHash("example.com"));
+  EXPECT_EQ(0xbf3c1581a02317a6u, ComputeHostHash("www.amazon.com"));
+}
+
+TEST(HttpsUpgradeIndexTest, Empty) {
+  AlignedIndex data(BuildHttpsUpgradeIndex({}, {}));
+  std::optional<HttpsUpgradeIndex> index = data.Create();
+  ASSERT_TRUE(index);
+  EXPECT_FALSE(index->MayContain(ComputeHostHash("example.com")));
+  EXPECT_FALSE(index->FindEntry(ComputeHostHash("example.com")));
+  EXPECT_TRUE(index->entries().empty());
+}
+
+TEST(HttpsUpgradeIndexTest, BloomFilter) {
+  std::vector<uint64_t> hosts;
+  for (int i = 0; i < 2000; ++i) {
+    hosts.push_back(ComputeHostHash("host" + std::to_string(i) + ".com"));
+  }
+  AlignedIndex data(BuildHttpsUpgradeIndex(hosts, {}));
+  std::optional<HttpsUpgradeIndex> index = data.Create();
+  ASSERT_TRUE(index);
+  for (uint64_t host : hosts) {
+    EXPECT_TRUE(index->MayContain(host));
+  }
+  int false_positives = 0;
+  for (int i = 0; i < 10000; ++i) {
+    false_positives += index->MayContain(
+        ComputeHostHash("other" + std::to_string(i) + ".com"));
+  }
+  // About 1% is expected; the bloom is rounded up to a power of two.
+  EXPECT_LT(false_positives, 300);
+}
+
+TEST(HttpsUpgradeIndexTest, Entries) {
+  const uint64_t kUpgrade = ComputeHostHash("shop.example");
+  const uint64_t kFallback = ComputeHostHash("legacy.example");
+  AlignedIndex data(BuildHttpsUpgradeIndex(
+      {}, {MakeEntry(kUpgrade, flat::kDecisionUpgrade, 0),
+           MakeEntry(kFallback, flat::kDecisionFallback, 19800),
+           MakeEntry(1, flat::kDecisionUpgrade, 0),
+           MakeEntry(~uint64_t{0}, flat::kDecisionFallback, 0)}));
+  std::optional<HttpsUpgradeIndex> index = data.Create();
+  ASSERT_TRUE(index);
+  ASSERT_EQ(4u, index->entries().size());
+
+  const flat::Entry* entry = index->FindEntry(kFallback);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(flat::kDecisionFallback, entry->decision);
+  EXPECT_EQ(19800u, entry->day);
+  entry = index->FindEntry(kUpgrade);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(flat::kDecisionUpgrade, entry->decision);
+  EXPECT_TRUE(index->FindEntry(1));
+  EXPECT_TRUE(index->FindEntry(~uint64_t{0}));
+  EXPECT_FALSE(index->FindEntry(0));
+  EXPECT_FALSE(index->FindEntry(2));
+  EXPECT_FALSE(index->FindEntry(ComputeHostHash("other.example")));
+  // Entries are not in the bloom filter.
+  EXPECT_FALSE(index->MayContain(kUpgrade));
+}
+
+TEST(HttpsUpgradeIndexTest, RejectsInvalidData) {
+  const uint64_t kHosts[] = {ComputeHostHash("example.com")};
+  const std::vector<uint8_t> valid = BuildHttpsUpgradeIndex(
+      kHosts, {MakeEntry(ComputeHostHash("example.org"),
+                         flat::kDecisionFallback, 1)});
+  ASSERT_TRUE(AlignedIndex(valid).Create());
+
+  EXPECT_FALSE(HttpsUpgradeIndex::Create({}));
+  EXPECT_FALSE(AlignedIndex(std::vector<uint8_t>(valid.begin(),
+                                                  valid.end() - 1))
+                   .Create());
+  std::vector<uint8_t> longer = valid;
+  longer.resize(valid.size() + sizeof(flat::Entry));
+  EXPECT_FALSE(AlignedIndex(longer).Create());
+
+  // Misaligned.
+  std::vector<uint64_t> words(valid.size() / 8 + 1);
+  auto misaligned = base::as_writable_bytes(base::span(words)).subspan(4);
+  std::memcpy(misaligned.data(), valid.data(), valid.size());
+  EXPECT_FALSE(HttpsUpgradeIndex::Create(misaligned.first(valid.size())));
+
+  struct {
+    const char* name;
+    void (*corrupt)(flat::Header&);
+  } kCorruptions[] = {
+      {"magic", [](flat::Header& h) { h.magic ^= 1; }},
+      {"version", [](flat::Header& h) { ++h.version; }},
+      {"total size", [](flat::Header& h) { h.total_size += 16; }},
+      {"entry count", [](flat::Header& h) { ++h.entry_count; }},
+      {"huge entry count",
+       [](flat::Header& h) { h.entry_count = 0xffffffff; }},
+      {"bloom size",
+       [](flat::Header& h) {
+         // The same total size with a bloom that is not a power of two.
+         h.bloom_word_count = 3;
+         h.entry_count = 0;
+       }},
+      {"no bloom hashes", [](flat::Header& h) { h.bloom_hash_count = 0; }},
+      {"too many bloom hashes",
+       [](flat::Header& h) { h.bloom_hash_count = 0xffffffff; }},
+  };
+  for (const auto& corruption : kCorruptions) {
+    AlignedIndex data(valid);
+    corruption.corrupt(data.header());
+    EXPECT_FALSE(data.Create()) << corruption.name;
+  }
+}
+
+}  // namespace
+
+}  // namespace safe_deal::https_upgrade
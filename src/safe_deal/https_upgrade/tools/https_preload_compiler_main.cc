@@ -0,0 +1,99 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Compiles host lists into the preloaded index read by HttpsUpgradeService.
+//
+// Usage: safe_deal_https_preload_compiler --output=<index> <list>...
+
+#include <stdio.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/containers/flat_set.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "safe_deal/https_upgrade/core/https_upgrade_index.h"
+
+namespace {
+
+constexpr char kOutputSwitch[] = "output";
+
+struct HostLists {
+  base::flat_set<uint64_t> https_hosts;
+  base::flat_set<uint64_t> http_only_hosts;
+};
+
+bool AddHostList(const base::FilePath& path, HostLists& lists) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents)) {
+    fprintf(stderr, "Cannot read %s\n", path.AsUTF8Unsafe().c_str());
+    return false;
+  }
+  for (std::string_view line : base::SplitStringPiece(
+           contents, "\r\n", base::TRIM_WHITESPACE,
+           base::SPLIT_WANT_NONEMPTY)) {
+    if (line.starts_with('#')) {
+      continue;
+    }
+    bool http_only = line.starts_with('!');
+    if (http_only) {
+      line.remove_prefix(1);
+    }
+    if (line.empty() || base::ToLowerASCII(line) != line) {
+      fprintf(stderr, "%s: invalid host \"%s\"\n",
+              path.AsUTF8Unsafe().c_str(), std::string(line).c_str());
+      return false;
+    }
+    uint64_t host_hash = safe_deal::https_upgrade::ComputeHostHash(line);
+    (http_only ? lists.http_only_hosts : lists.https_hosts).insert(host_hash);
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+  base::FilePath output = command_line.GetSwitchValuePath(kOutputSwitch);
+  std::vector<base::CommandLine::StringType> inputs = command_line.GetArgs();
+  if (output.empty() || inputs.empty()) {
+    fprintf(stderr, "Usage: %s --output=<index> <host list>...\n",
+            command_line.GetProgram().AsUTF8Unsafe().c_str());
+    return 1;
+  }
+
+  HostLists lists;
+  for (const base::CommandLine::StringType& input : inputs) {
+    if (!AddHostList(base::FilePath(input), lists)) {
+      return 1;
+    }
+  }
+
+  // An exception wins over the same host listed as HTTPS.
+  std::vector<safe_deal::https_upgrade::flat::Entry> entries;
+  for (uint64_t host_hash : lists.http_only_hosts) {
+    lists.https_hosts.erase(host_hash);
+    entries.push_back(
+        {.host_hash = host_hash,
+         .decision = safe_deal::https_upgrade::flat::kDecisionFallback});
+  }
+  std::vector<uint64_t> https_hosts = std::move(lists.https_hosts).extract();
+  std::vector<uint8_t> index = safe_deal::https_upgrade::BuildHttpsUpgradeIndex(
+      https_hosts, std::move(entries));
+  if (!base::WriteFile(output, index)) {
+    fprintf(stderr, "Cannot write %s\n", output.AsUTF8Unsafe().c_str());
+    return 1;
+  }
+  printf("Compiled %zu HTTPS and %zu HTTP-only hosts into %zu bytes\n",
+         https_hosts.size(), lists.http_only_hosts.size(),
+         index.size());
+  return 0;
+}
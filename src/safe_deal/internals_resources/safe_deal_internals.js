@@ -0,0 +1,75 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+import {sendWithPromise} from 'chrome://resources/js/cr.js';
+
+const REFRESH_INTERVAL_MS = 2000;
+
+function formatNumber(value, digits) {
+  return value === undefined ? '-' : value.toFixed(digits);
+}
+
+function formatBytes(bytes) {
+  if (bytes < 1024) {
+    return `${bytes} B`;
+  }
+  if (bytes < 1024 * 1024) {
+    return `${(bytes / 1024).toFixed(1)} KB`;
+  }
+  return `${(bytes / (1024 * 1024)).toFixed(1)} MB`;
+}
+
+// Replaces the rows of the table body |id|. The first cell of each row shows
+// the label and names the histogram in its tooltip.
+function fillTable(id, entries, cells) {
+  const body = document.getElementById(id);
+  body.replaceChildren(...entries.map(entry => {
+    const row = document.createElement('tr');
+    const label = document.createElement('td');
+    label.textContent = entry.label;
+    if (entry.histogram) {
+      label.title = entry.histogram;
+    }
+    row.appendChild(label);
+    for (const text of cells(entry)) {
+      const cell = document.createElement('td');
+      cell.textContent = text;
+      row.appendChild(cell);
+    }
+    return row;
+  }));
+}
+
+async function refresh() {
+  const stats = await sendWithPromise('getSafeDealStats');
+  fillTable(
+      'latencies', stats.latencies,
+      entry =>
+          [entry.count, formatNumber(entry.p50, 3),
+           formatNumber(entry.p95, 3), formatNumber(entry.p99, 3)]);
+  fillTable(
+      'rates', stats.rates,
+      entry =>
+          [entry.count,
+           entry.rate === undefined ? '-' :
+                                      `${(entry.rate * 100).toFixed(1)}%`]);
+  fillTable('memory', stats.memory, entry => [formatBytes(entry.bytes)]);
+  await refreshSettings();
+  setTimeout(refresh, REFRESH_INTERVAL_MS);
+}
+
+async function refreshSettings() {
+  const settings = await sendWithPromise('getSafeDealSettings');
+  let leanShopping = settings.leanShopping ? 'On' : 'Off';
+  if (!settings.leanShoppingAvailable) {
+    leanShopping += ' (disabled by SafeDealLeanShopping)';
+  }
+  document.getElementById('lean-shopping').textContent = leanShopping;
+}
+
+document.addEventListener('DOMContentLoaded', () => {
+  document.getElementById('refresh-interval').textContent =
+      REFRESH_INTERVAL_MS / 1000;
+  refresh();
+});
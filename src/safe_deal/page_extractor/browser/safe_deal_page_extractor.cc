@@ -0,0 +1,85 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/page_extractor/browser/safe_deal_page_extractor.h"
+
+#include <utility>
+
+#include "content/public/browser/render_frame_host.h"
+#include "mojo/public/cpp/bindings/message.h"
+#include "safe_deal/common/safe_deal_constants.h"
+#include "url/origin.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Mirrors the truncation applied by the renderer side parser.
+constexpr size_t kMaxStringLength = 512;
+
+bool IsValid(const mojom::ProductData& product) {
+  return product.title.size() <= kMaxStringLength &&
+         product.seller_id.size() <= kMaxStringLength &&
+         product.product_id.size() <= kMaxStringLength &&
+         product.currency_code.size() <= 3 && product.rating_x100 <= 500 &&
+         product.price_micros >= -1;
+}
+
+}  // namespace
+
+DOCUMENT_USER_DATA_KEY_IMPL(SafeDealPageExtractor);
+
+SafeDealPageExtractor::SafeDealPageExtractor(
+    content::RenderFrameHost* render_frame_host,
+    mojom::Marketplace marketplace,
+    ProductExtractedCallback callback)
+    : DocumentUserData(render_frame_host),
+      marketplace_(marketplace),
+      callback_(std::move(callback)) {}
+
+SafeDealPageExtractor::~SafeDealPageExtractor() = default;
+
+// static
+void SafeDealPageExtractor::BindReceiver(
+    ProductExtractedCallback callback,
+    content::RenderFrameHost* render_frame_host,
+    mojo::PendingReceiver<mojom::PageExtractorHost> receiver) {
+  if (render_frame_host->GetParentOrOuterDocument()) {
+    return;
+  }
+  const url::Origin& origin = render_frame_host->GetLastCommittedOrigin();
+  if (origin.scheme() != url::kHttpsScheme) {
+    return;
+  }
+  mojom::Marketplace marketplace = GetMarketplaceForHost(origin.host());
+  if (marketplace == mojom::Marketplace::kUnknown) {
+    return;
+  }
+  SafeDealPageExtractor* extractor =
+      GetOrCreateForCurrentDocument(render_frame_host, marketplace,
+                                    std::move(callback));
+  extractor->receiver_.reset();
+  extractor->receiver_.Bind(std::move(receiver));
+}
+
+void SafeDealPageExtractor::OnProductExtracted(mojom::ProductDataPtr product) {
+  // The renderer is not trusted to pick the marketplace; it must agree with
+  // the origin the browser committed.
+  if (product->marketplace != marketplace_) {
+    mojo::ReportBadMessage("Invalid Safe Deal marketplace");
+    return;
+  }
+  // Everything else comes from page content, so a value out of range is
+  // dropped rather than taken as a bad message, which would let any page get
+  // its renderer killed.
+  if (!IsValid(*product)) {
+    return;
+  }
+  product_ = std::move(product);
+  if (callback_) {
+    callback_.Run(&render_frame_host(), *product_);
+  }
+}
+
+}  // namespace safe_deal
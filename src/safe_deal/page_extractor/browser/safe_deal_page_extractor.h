@@ -0,0 +1,68 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PAGE_EXTRACTOR_BROWSER_SAFE_DEAL_PAGE_EXTRACTOR_H_
+#define SAFE_DEAL_PAGE_EXTRACTOR_BROWSER_SAFE_DEAL_PAGE_EXTRACTOR_H_
+
+#include "base/functional/callback.h"
+#include "content/public/browser/document_user_data.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/receiver.h"
+#include "safe_deal/page_extractor/common/page_extractor.mojom.h"
+
+namespace content {
+class RenderFrameHost;
+}  // namespace content
+
+namespace safe_deal {
+
+// Browser side of product extraction for one marketplace document. The
+// renderer parses the page and sends a mojom::ProductData; this class
+// validates it against the document's origin and keeps the latest copy, so
+// the shopping assistant can read structured data instead of scraping the DOM
+// from a content script.
+class SafeDealPageExtractor
+    : public content::DocumentUserData<SafeDealPageExtractor>,
+      public mojom::PageExtractorHost {
+ public:
+  SafeDealPageExtractor(const SafeDealPageExtractor&) = delete;
+  SafeDealPageExtractor& operator=(const SafeDealPageExtractor&) = delete;
+  ~SafeDealPageExtractor() override;
+
+  // Run on the UI thread for every validated product report.
+  using ProductExtractedCallback =
+      base::RepeatingCallback<void(content::RenderFrameHost*,
+                                   const mojom::ProductData&)>;
+
+  // Binds |receiver| for the current document of |render_frame_host|.
+  // Requests from frames that are not on a supported marketplace are dropped.
+  static void BindReceiver(
+      ProductExtractedCallback callback,
+      content::RenderFrameHost* render_frame_host,
+      mojo::PendingReceiver<mojom::PageExtractorHost> receiver);
+
+  // Returns the most recent product reported for the document, or nullptr if
+  // none was reported yet.
+  const mojom::ProductData* product() const { return product_.get(); }
+
+  // mojom::PageExtractorHost:
+  void OnProductExtracted(mojom::ProductDataPtr product) override;
+
+ private:
+  friend DocumentUserData;
+  DOCUMENT_USER_DATA_KEY_DECL();
+
+  SafeDealPageExtractor(content::RenderFrameHost* render_frame_host,
+                        mojom::Marketplace marketplace,
+                        ProductExtractedCallback callback);
+
+  const mojom::Marketplace marketplace_;
+  const ProductExtractedCallback callback_;
+  mojo::Receiver<mojom::PageExtractorHost> receiver_{this};
+  mojom::ProductDataPtr product_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PAGE_EXTRACTOR_BROWSER_SAFE_DEAL_PAGE_EXTRACTOR_H_
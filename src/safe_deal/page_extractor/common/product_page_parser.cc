@@ -0,0 +1,131 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/page_extractor/common/product_page_parser.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include "base/strings/string_util.h"
+#include "safe_deal/page_extractor/common/product_value_parsers.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Upper bound on the length of free-form strings sent to the browser.
+constexpr size_t kMaxStringLength = 512;
+
+// Cuts at a character boundary so that the result stays valid UTF-8, which
+// mojo strings must be.
+std::string Truncate(std::string value) {
+  if (value.size() > kMaxStringLength) {
+    std::string truncated;
+    base::TruncateUTF8ToByteSize(value, kMaxStringLength, &truncated);
+    return truncated;
+  }
+  return value;
+}
+
+}  // namespace
+
+ProductPageParser::ProductPageParser(mojom::Marketplace marketplace,
+                                     const GURL& page_url)
+    : selectors_(GetCompiledSelectors(marketplace)),
+      page_url_(page_url),
+      product_(mojom::ProductData::New()) {
+  best_index_by_field_.fill(kNoSelectorSpec);
+  first_index_by_field_.fill(kNoSelectorSpec);
+  for (size_t i = 0; i < selectors_->spec_count(); ++i) {
+    uint8_t& first = first_index_by_field_[static_cast<size_t>(
+        selectors_->spec(i).field)];
+    if (first == kNoSelectorSpec) {
+      first = static_cast<uint8_t>(i);
+    }
+  }
+  product_->marketplace = marketplace;
+  product_->product_id = ExtractProductIdFromUrl(marketplace, page_url);
+}
+
+ProductPageParser::~ProductPageParser() = default;
+
+int ProductPageParser::MatchElement(const ElementAttributes& element) const {
+  return selectors_->Match(element, best_index_by_field_);
+}
+
+void ProductPageParser::ConsumeValue(int index, std::string_view raw_value) {
+  const SelectorSpec& selector = spec(index);
+  std::string text;
+  switch (selector.source) {
+    case ValueSource::kText:
+    case ValueSource::kContentAttribute:
+    case ValueSource::kValueAttribute:
+    case ValueSource::kTitleAttribute:
+      text = NormalizeText(raw_value);
+      break;
+    case ValueSource::kHrefQueryParameter:
+      text = GetQueryParameter(page_url_.Resolve(raw_value), selector.argument);
+      break;
+    case ValueSource::kHrefPathSegment:
+      text =
+          GetPathSegmentAfter(page_url_.Resolve(raw_value), selector.argument);
+      break;
+  }
+  if (text.empty()) {
+    return;
+  }
+
+  switch (selector.field) {
+    case ProductField::kTitle:
+      product_->title = Truncate(std::move(text));
+      break;
+    case ProductField::kSellerId:
+      product_->seller_id = Truncate(std::move(text));
+      break;
+    case ProductField::kPrice: {
+      std::optional<ParsedPrice> price = ParsePrice(text);
+      if (!price) {
+        return;
+      }
+      product_->price_micros = price->micros;
+      product_->currency_code = std::move(price->currency_code);
+      break;
+    }
+    case ProductField::kRating: {
+      std::optional<uint16_t> rating = ParseRating(text);
+      if (!rating) {
+        return;
+      }
+      product_->rating_x100 = *rating;
+      break;
+    }
+    case ProductField::kReviewCount: {
+      std::optional<uint32_t> count = ParseCount(text);
+      if (!count) {
+        return;
+      }
+      product_->review_count = *count;
+      break;
+    }
+  }
+  best_index_by_field_[static_cast<size_t>(selector.field)] =
+      static_cast<uint8_t>(index);
+}
+
+bool ProductPageParser::IsComplete() const {
+  return best_index_by_field_ == first_index_by_field_;
+}
+
+bool ProductPageParser::HasProductFields() const {
+  return std::ranges::any_of(best_index_by_field_, [](uint8_t index) {
+    return index != kNoSelectorSpec;
+  });
+}
+
+mojom::ProductDataPtr ProductPageParser::TakeProductData() {
+  return std::move(product_);
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,65 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PAGE_EXTRACTOR_COMMON_PRODUCT_PAGE_PARSER_H_
+#define SAFE_DEAL_PAGE_EXTRACTOR_COMMON_PRODUCT_PAGE_PARSER_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <string_view>
+
+#include "base/memory/raw_ref.h"
+#include "safe_deal/page_extractor/common/page_extractor.mojom.h"
+#include "safe_deal/page_extractor/common/product_selectors.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+// Accumulates a mojom::ProductData from a stream of elements. The caller walks
+// the document once, in document order, and for every element:
+//
+//   int spec = parser.MatchElement(attributes);
+//   if (spec >= 0)
+//     parser.ConsumeValue(spec, <value read from spec's ValueSource>);
+//
+// Reading element text is the expensive part of extraction, so the parser
+// only asks for values of elements that can still improve the result, and the
+// walk can stop as soon as IsComplete() returns true.
+class ProductPageParser {
+ public:
+  ProductPageParser(mojom::Marketplace marketplace, const GURL& page_url);
+  ProductPageParser(const ProductPageParser&) = delete;
+  ProductPageParser& operator=(const ProductPageParser&) = delete;
+  ~ProductPageParser();
+
+  // Returns the index of the selector whose value should be read from the
+  // element, or -1 if the element is not interesting.
+  int MatchElement(const ElementAttributes& element) const;
+
+  const SelectorSpec& spec(int index) const { return selectors_->spec(index); }
+
+  // Records the raw value read for selector |index|. Values that fail to parse
+  // are ignored, leaving the field open for less preferred selectors.
+  void ConsumeValue(int index, std::string_view raw_value);
+
+  // True once every field has been produced by its most preferred selector.
+  bool IsComplete() const;
+
+  // True if at least one field besides the URL derived product id was found.
+  bool HasProductFields() const;
+
+  mojom::ProductDataPtr TakeProductData();
+
+ private:
+  const raw_ref<const CompiledSelectors> selectors_;
+  const GURL page_url_;
+  std::array<uint8_t, kProductFieldCount> best_index_by_field_;
+  std::array<uint8_t, kProductFieldCount> first_index_by_field_;
+  mojom::ProductDataPtr product_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PAGE_EXTRACTOR_COMMON_PRODUCT_PAGE_PARSER_H_
@@ -0,0 +1,186 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/page_extractor/common/product_selectors.h"
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "base/check_op.h"
+#include "base/no_destructor.h"
+#include "base/strings/string_util.h"
+
+namespace safe_deal {
+
+namespace {
+
+using enum ProductField;
+using enum SelectorKind;
+using enum ValueSource;
+
+// schema.org microdata, tried after the marketplace specific selectors.
+constexpr SelectorSpec kMicrodataSelectors[] = {
+    {kTitle, kItemprop, "name", kText},
+    {kPrice, kItemprop, "price", kContentAttribute},
+    {kRating, kItemprop, "ratingValue", kContentAttribute},
+    {kReviewCount, kItemprop, "reviewCount", kContentAttribute},
+    {kReviewCount, kItemprop, "ratingCount", kContentAttribute},
+};
+
+constexpr SelectorSpec kAmazonSelectors[] = {
+    {kTitle, kId, "productTitle", kText},
+    {kSellerId, kId, "sellerProfileTriggerId", kHrefQueryParameter, "seller"},
+    {kSellerId, kId, "merchantID", kValueAttribute},
+    {kPrice, kClass, "a-offscreen", kText},
+    {kPrice, kId, "priceblock_ourprice", kText},
+    {kPrice, kId, "priceblock_dealprice", kText},
+    {kRating, kId, "acrPopover", kTitleAttribute},
+    {kReviewCount, kId, "acrCustomerReviewText", kText},
+};
+
+constexpr SelectorSpec kAliExpressSelectors[] = {
+    {kTitle, kExtraAttribute, "product-title", kText},
+    {kSellerId, kExtraAttribute, "store-name", kHrefPathSegment, "/store/"},
+    {kPrice, kClass, "product-price-current", kText},
+    {kPrice, kClass, "product-price-value", kText},
+    {kRating, kClass, "reviewer--rating--xrWWFzx", kText},
+    {kRating, kClass, "overview-rating-average", kText},
+    {kReviewCount, kClass, "reviewer--reviews--cx7Zs_V", kText},
+    {kReviewCount, kClass, "product-reviewer-reviews", kText},
+};
+
+constexpr SelectorSpec kEbaySelectors[] = {
+    {kTitle, kClass, "x-item-title__mainTitle", kText},
+    {kSellerId, kExtraAttribute, "str-title", kHrefPathSegment, "/str/"},
+    {kSellerId, kClass, "x-sellercard-atf__info__about-seller",
+     kHrefPathSegment, "/usr/"},
+    {kPrice, kClass, "x-price-primary", kText},
+    {kRating, kClass, "ebay-review-start-rating", kText},
+    {kReviewCount, kClass, "ebay-reviews-count", kText},
+};
+
+using SelectorTables =
+    std::array<CompiledSelectors,
+               static_cast<size_t>(mojom::Marketplace::kMaxValue) + 1>;
+
+SelectorTables BuildSelectorTables() {
+  SelectorTables tables;
+  tables[static_cast<size_t>(mojom::Marketplace::kAmazon)] =
+      CompiledSelectors(std::string_view(), kAmazonSelectors);
+  tables[static_cast<size_t>(mojom::Marketplace::kAliExpress)] =
+      CompiledSelectors("data-pl", kAliExpressSelectors);
+  tables[static_cast<size_t>(mojom::Marketplace::kEbay)] =
+      CompiledSelectors("data-testid", kEbaySelectors);
+  return tables;
+}
+
+const SelectorTables& GetSelectorTables() {
+  static const base::NoDestructor<SelectorTables> tables(
+      BuildSelectorTables());
+  return *tables;
+}
+
+}  // namespace
+
+CompiledSelectors::CompiledSelectors() = default;
+
+CompiledSelectors::CompiledSelectors(std::string_view extra_attribute,
+                                     base::span<const SelectorSpec> specs)
+    : extra_attribute_(extra_attribute) {
+  specs_.reserve(specs.size() + std::size(kMicrodataSelectors));
+  specs_.insert(specs_.end(), specs.begin(), specs.end());
+  specs_.insert(specs_.end(), std::begin(kMicrodataSelectors),
+                std::end(kMicrodataSelectors));
+  CHECK_LT(specs_.size(), kNoSelectorSpec);
+
+  std::array<std::vector<std::pair<std::string_view, SpecIndices>>,
+             std::tuple_size_v<decltype(maps_)>>
+      entries;
+  for (size_t i = 0; i < specs_.size(); ++i) {
+    auto& kind_entries = entries[static_cast<size_t>(specs_[i].kind)];
+    auto it = std::ranges::find(
+        kind_entries, std::string_view(specs_[i].match),
+        &std::pair<std::string_view, SpecIndices>::first);
+    if (it == kind_entries.end()) {
+      kind_entries.emplace_back(specs_[i].match, SpecIndices());
+      it = std::prev(kind_entries.end());
+    }
+    it->second.push_back(static_cast<uint8_t>(i));
+  }
+  for (size_t kind = 0; kind < maps_.size(); ++kind) {
+    maps_[kind] = Map(std::move(entries[kind]));
+  }
+}
+
+CompiledSelectors::CompiledSelectors(CompiledSelectors&&) = default;
+CompiledSelectors& CompiledSelectors::operator=(CompiledSelectors&&) = default;
+CompiledSelectors::~CompiledSelectors() = default;
+
+int CompiledSelectors::Match(
+    const ElementAttributes& element,
+    const std::array<uint8_t, kProductFieldCount>& best_index_by_field) const {
+  int result = -1;
+  if (!element.id.empty()) {
+    MatchKey(kId, element.id, best_index_by_field, &result);
+  }
+  if (!element.itemprop.empty()) {
+    MatchKey(kItemprop, element.itemprop, best_index_by_field, &result);
+  }
+  if (!element.extra_attribute.empty()) {
+    MatchKey(kExtraAttribute, element.extra_attribute, best_index_by_field,
+             &result);
+  }
+  // Walk the class list in place rather than splitting it into a vector.
+  std::string_view classes = element.class_name;
+  while (!classes.empty()) {
+    size_t begin = 0;
+    while (begin < classes.size() && base::IsAsciiWhitespace(classes[begin])) {
+      ++begin;
+    }
+    size_t end = begin;
+    while (end < classes.size() && !base::IsAsciiWhitespace(classes[end])) {
+      ++end;
+    }
+    if (end > begin) {
+      MatchKey(kClass, classes.substr(begin, end - begin), best_index_by_field,
+               &result);
+    }
+    classes.remove_prefix(end);
+  }
+  return result;
+}
+
+void CompiledSelectors::MatchKey(
+    SelectorKind kind,
+    std::string_view key,
+    const std::array<uint8_t, kProductFieldCount>& best,
+    int* result) const {
+  const Map& map = maps_[static_cast<size_t>(kind)];
+  auto it = map.find(key);
+  if (it == map.end()) {
+    return;
+  }
+  for (uint8_t index : it->second) {
+    if (*result != -1 && index >= *result) {
+      return;
+    }
+    if (index < best[static_cast<size_t>(specs_[index].field)]) {
+      *result = index;
+      return;
+    }
+  }
+}
+
+void PrecompileSelectors() {
+  GetSelectorTables();
+}
+
+const CompiledSelectors& GetCompiledSelectors(mojom::Marketplace marketplace) {
+  return GetSelectorTables()[static_cast<size_t>(marketplace)];
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,129 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PAGE_EXTRACTOR_COMMON_PRODUCT_SELECTORS_H_
+#define SAFE_DEAL_PAGE_EXTRACTOR_COMMON_PRODUCT_SELECTORS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <string_view>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/containers/span.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "third_party/abseil-cpp/absl/container/inlined_vector.h"
+
+namespace safe_deal {
+
+enum class ProductField : uint8_t {
+  kTitle,
+  kSellerId,
+  kPrice,
+  kRating,
+  kReviewCount,
+  kMaxValue = kReviewCount,
+};
+
+inline constexpr size_t kProductFieldCount =
+    static_cast<size_t>(ProductField::kMaxValue) + 1;
+
+// The element property a selector keys on. Selectors are deliberately limited
+// to exact matches on a handful of attributes so that matching an element is a
+// few hash lookups instead of a CSS or regex evaluation.
+enum class SelectorKind : uint8_t {
+  kId,
+  kClass,
+  kItemprop,
+  // The marketplace specific attribute named by
+  // CompiledSelectors::extra_attribute(), e.g. "data-pl" on AliExpress.
+  kExtraAttribute,
+  kMaxValue = kExtraAttribute,
+};
+
+// Where the raw value of a matched element is read from.
+enum class ValueSource : uint8_t {
+  kText,
+  kContentAttribute,
+  kValueAttribute,
+  kTitleAttribute,
+  // The element's href, reduced to the query parameter or path segment named
+  // by SelectorSpec::argument.
+  kHrefQueryParameter,
+  kHrefPathSegment,
+};
+
+// Sentinel for "no selector has produced this field yet".
+inline constexpr uint8_t kNoSelectorSpec = 0xff;
+
+struct SelectorSpec {
+  ProductField field;
+  SelectorKind kind;
+  const char* match;
+  ValueSource source;
+  const char* argument = nullptr;
+};
+
+// The attributes of an element that selectors can key on. Views are only
+// valid for the duration of the match.
+struct ElementAttributes {
+  std::string_view id;
+  std::string_view class_name;
+  std::string_view itemprop;
+  std::string_view extra_attribute;
+};
+
+// Selector table for one marketplace, compiled into per-kind lookup maps.
+// Specs are ordered by preference; a lower index wins when several selectors
+// produce the same field. Generic schema.org microdata selectors are appended
+// after the marketplace specific ones.
+class CompiledSelectors {
+ public:
+  using SpecIndices = absl::InlinedVector<uint8_t, 2>;
+
+  CompiledSelectors();
+  CompiledSelectors(std::string_view extra_attribute,
+                    base::span<const SelectorSpec> specs);
+  CompiledSelectors(const CompiledSelectors&) = delete;
+  CompiledSelectors& operator=(const CompiledSelectors&) = delete;
+  CompiledSelectors(CompiledSelectors&&);
+  CompiledSelectors& operator=(CompiledSelectors&&);
+  ~CompiledSelectors();
+
+  // Returns the index of the most preferred spec matching |element| whose
+  // index is lower than |best_index_by_field| for its field, or -1.
+  int Match(const ElementAttributes& element,
+            const std::array<uint8_t, kProductFieldCount>& best_index_by_field)
+      const;
+
+  const SelectorSpec& spec(size_t index) const { return specs_[index]; }
+  size_t spec_count() const { return specs_.size(); }
+  std::string_view extra_attribute() const { return extra_attribute_; }
+
+ private:
+  using Map = base::flat_map<std::string_view, SpecIndices, std::less<>>;
+
+  void MatchKey(SelectorKind kind,
+                std::string_view key,
+                const std::array<uint8_t, kProductFieldCount>& best,
+                int* result) const;
+
+  std::string_view extra_attribute_;
+  std::vector<SelectorSpec> specs_;
+  std::array<Map, static_cast<size_t>(SelectorKind::kMaxValue) + 1> maps_;
+};
+
+// Builds the selector tables of every marketplace. Called once when the
+// renderer starts so that the first page load does not pay for it; later
+// calls are no-ops.
+void PrecompileSelectors();
+
+// Returns the compiled selectors of |marketplace|. kUnknown has none.
+const CompiledSelectors& GetCompiledSelectors(mojom::Marketplace marketplace);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PAGE_EXTRACTOR_COMMON_PRODUCT_SELECTORS_H_
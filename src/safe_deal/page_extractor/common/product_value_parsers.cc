@@ -0,0 +1,307 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/page_extractor/common/product_value_parsers.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "base/strings/escape.h"
+#include "base/strings/string_util.h"
+#include "third_party/abseil-cpp/absl/container/inlined_vector.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Prices above this are treated as parse errors rather than overflowing the
+// fixed point representation.
+constexpr int kMaxIntegerDigits = 12;
+constexpr int64_t kMicrosPerUnit = 1'000'000;
+
+struct CurrencyToken {
+  const char* token;
+  const char* code;
+};
+
+// Longer tokens come first so that "US $" wins over "$".
+constexpr CurrencyToken kCurrencyTokens[] = {
+    {"US $", "USD"}, {"US$", "USD"},  {"C $", "CAD"},  {"CA$", "CAD"},
+    {"AU $", "AUD"}, {"A$", "AUD"},   {"MX$", "MXN"},  {"R$", "BRL"},
+    {"S$", "SGD"},   {"\xC2\xA3", "GBP"},  // £
+    {"\xE2\x82\xAC", "EUR"},                // €
+    {"\xC2\xA5", "JPY"},                    // ¥
+    {"\xEF\xBF\xA5", "JPY"},                // Fullwidth ¥
+    {"\xE2\x82\xB9", "INR"},                // ₹
+    {"\xE2\x82\xBA", "TRY"},                // ₺
+    {"z\xC5\x82", "PLN"},                   // zł
+    {"$", "USD"},
+};
+
+bool IsSeparator(char c) {
+  return c == '.' || c == ',';
+}
+
+// Returns the three letter ISO code at the start of a word in |text|, if any.
+std::string_view FindIsoCode(std::string_view text) {
+  for (size_t i = 0; i + 3 <= text.size(); ++i) {
+    if ((i > 0 && base::IsAsciiAlpha(text[i - 1])) ||
+        (i + 3 < text.size() && base::IsAsciiAlpha(text[i + 3]))) {
+      continue;
+    }
+    if (base::IsAsciiUpper(text[i]) && base::IsAsciiUpper(text[i + 1]) &&
+        base::IsAsciiUpper(text[i + 2])) {
+      return text.substr(i, 3);
+    }
+  }
+  return {};
+}
+
+std::string DetectCurrency(std::string_view text) {
+  std::string_view iso = FindIsoCode(text);
+  if (!iso.empty()) {
+    return std::string(iso);
+  }
+  for (const CurrencyToken& currency : kCurrencyTokens) {
+    if (text.find(currency.token) != std::string_view::npos) {
+      return currency.code;
+    }
+  }
+  return std::string();
+}
+
+// Returns the span of |text| that holds the first number, including digit
+// separators, or an empty view.
+std::string_view FindNumber(std::string_view text) {
+  size_t begin = 0;
+  while (begin < text.size() && !base::IsAsciiDigit(text[begin])) {
+    ++begin;
+  }
+  size_t end = begin;
+  while (end < text.size() &&
+         (base::IsAsciiDigit(text[end]) ||
+          (IsSeparator(text[end]) && end + 1 < text.size() &&
+           base::IsAsciiDigit(text[end + 1])))) {
+    ++end;
+  }
+  return text.substr(begin, end - begin);
+}
+
+bool IsAllDigits(std::string_view text) {
+  return !text.empty() && std::ranges::all_of(text, [](char c) {
+           return base::IsAsciiDigit(c);
+         });
+}
+
+// Numeric listing ids fit in 64 bits. Longer digit runs are not listings, and
+// are dropped rather than sent to the browser.
+constexpr size_t kMaxNumericIdLength = 20;
+
+bool IsNumericId(std::string_view text) {
+  return text.size() <= kMaxNumericIdLength && IsAllDigits(text);
+}
+
+// Product ids are in the first few path segments; later ones are dropped so
+// that splitting the path never allocates.
+constexpr size_t kMaxPathSegments = 8;
+
+using PathSegmentList = absl::InlinedVector<std::string_view, kMaxPathSegments>;
+
+PathSegmentList PathSegments(const GURL& url) {
+  PathSegmentList segments;
+  std::string_view path = url.path_piece();
+  while (!path.empty() && segments.size() < kMaxPathSegments) {
+    size_t end = path.find('/');
+    std::string_view segment = path.substr(0, end);
+    if (!segment.empty()) {
+      segments.push_back(segment);
+    }
+    if (end == std::string_view::npos) {
+      break;
+    }
+    path.remove_prefix(end + 1);
+  }
+  return segments;
+}
+
+}  // namespace
+
+std::optional<ParsedPrice> ParsePrice(std::string_view text) {
+  std::string_view number = FindNumber(text);
+  if (number.empty()) {
+    return std::nullopt;
+  }
+
+  // A trailing separator followed by one or two digits is the decimal point;
+  // anything else ("1,299", "1.299") is digit grouping.
+  size_t decimal_pos = std::string_view::npos;
+  size_t last_separator = number.find_last_of(".,");
+  if (last_separator != std::string_view::npos) {
+    size_t fraction_digits = number.size() - last_separator - 1;
+    if (fraction_digits == 1 || fraction_digits == 2) {
+      decimal_pos = last_separator;
+    }
+  }
+
+  int64_t units = 0;
+  int integer_digits = 0;
+  std::string_view integer_part = number.substr(0, decimal_pos);
+  for (char c : integer_part) {
+    if (IsSeparator(c)) {
+      continue;
+    }
+    if (++integer_digits > kMaxIntegerDigits) {
+      return std::nullopt;
+    }
+    units = units * 10 + (c - '0');
+  }
+
+  int64_t fraction_micros = 0;
+  if (decimal_pos != std::string_view::npos) {
+    int64_t scale = kMicrosPerUnit / 10;
+    for (char c : number.substr(decimal_pos + 1)) {
+      fraction_micros += (c - '0') * scale;
+      scale /= 10;
+    }
+  }
+
+  ParsedPrice price;
+  price.micros = units * kMicrosPerUnit + fraction_micros;
+  price.currency_code = DetectCurrency(text);
+  return price;
+}
+
+std::optional<uint16_t> ParseRating(std::string_view text) {
+  std::string_view number = FindNumber(text);
+  if (number.empty()) {
+    return std::nullopt;
+  }
+  int value = 0;
+  size_t i = 0;
+  for (; i < number.size() && base::IsAsciiDigit(number[i]); ++i) {
+    value = value * 10 + (number[i] - '0');
+    if (value > 5) {
+      return std::nullopt;
+    }
+  }
+  value *= 100;
+  if (i < number.size() && IsSeparator(number[i])) {
+    int scale = 10;
+    for (++i; i < number.size() && base::IsAsciiDigit(number[i]) && scale;
+         ++i) {
+      value += (number[i] - '0') * scale;
+      scale /= 10;
+    }
+  }
+  if (value > 500) {
+    return std::nullopt;
+  }
+  return static_cast<uint16_t>(value);
+}
+
+std::optional<uint32_t> ParseCount(std::string_view text) {
+  std::string_view number = FindNumber(text);
+  if (number.empty()) {
+    return std::nullopt;
+  }
+  uint64_t value = 0;
+  for (char c : number) {
+    if (IsSeparator(c)) {
+      continue;
+    }
+    value = value * 10 + (c - '0');
+    if (value > std::numeric_limits<uint32_t>::max()) {
+      return std::nullopt;
+    }
+  }
+  return static_cast<uint32_t>(value);
+}
+
+std::string ExtractProductIdFromUrl(mojom::Marketplace marketplace,
+                                    const GURL& url) {
+  PathSegmentList segments = PathSegments(url);
+  switch (marketplace) {
+    case mojom::Marketplace::kAmazon:
+      // /dp/<ASIN>, /gp/product/<ASIN> and /gp/aw/d/<ASIN>.
+      for (size_t i = 0; i + 1 < segments.size(); ++i) {
+        if (segments[i] == "dp" || segments[i] == "product" ||
+            segments[i] == "d") {
+          std::string_view asin = segments[i + 1];
+          if (asin.size() == 10 &&
+              std::ranges::all_of(asin, [](char c) {
+                return base::IsAsciiAlphaNumeric(c);
+              })) {
+            return base::ToUpperASCII(asin);
+          }
+        }
+      }
+      return std::string();
+    case mojom::Marketplace::kAliExpress:
+      // /item/<id>.html
+      for (size_t i = 0; i + 1 < segments.size(); ++i) {
+        if (segments[i] == "item") {
+          std::string_view id = segments[i + 1];
+          if (base::EndsWith(id, ".html")) {
+            id.remove_suffix(5);
+          }
+          if (IsNumericId(id)) {
+            return std::string(id);
+          }
+        }
+      }
+      return std::string();
+    case mojom::Marketplace::kEbay:
+      // /itm/<id> and /itm/<slug>/<id>.
+      if (segments.size() >= 2 && segments[0] == "itm") {
+        for (size_t i = segments.size() - 1; i >= 1; --i) {
+          if (IsNumericId(segments[i])) {
+            return std::string(segments[i]);
+          }
+        }
+      }
+      return std::string();
+    case mojom::Marketplace::kUnknown:
+      return std::string();
+  }
+}
+
+std::string GetQueryParameter(const GURL& url, std::string_view name) {
+  std::string_view query = url.query_piece();
+  while (!query.empty()) {
+    size_t end = query.find('&');
+    std::string_view pair = query.substr(0, end);
+    query.remove_prefix(end == std::string_view::npos ? query.size()
+                                                       : end + 1);
+    size_t equals = pair.find('=');
+    if (pair.substr(0, equals) != name) {
+      continue;
+    }
+    if (equals == std::string_view::npos) {
+      return std::string();
+    }
+    return base::UnescapeURLComponent(
+        pair.substr(equals + 1),
+        base::UnescapeRule::SPACES |
+            base::UnescapeRule::URL_SPECIAL_CHARS_EXCEPT_PATH_SEPARATORS);
+  }
+  return std::string();
+}
+
+std::string GetPathSegmentAfter(const GURL& url, std::string_view prefix) {
+  std::string_view path = url.path_piece();
+  size_t pos = path.find(prefix);
+  if (pos == std::string_view::npos) {
+    return std::string();
+  }
+  std::string_view rest = path.substr(pos + prefix.size());
+  return std::string(rest.substr(0, rest.find('/')));
+}
+
+std::string NormalizeText(std::string_view text) {
+  return base::CollapseWhitespaceASCII(
+      text, /*trim_sequences_with_line_breaks=*/false);
+}
+
+}  // namespace safe_deal
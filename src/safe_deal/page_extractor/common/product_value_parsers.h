@@ -0,0 +1,60 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PAGE_EXTRACTOR_COMMON_PRODUCT_VALUE_PARSERS_H_
+#define SAFE_DEAL_PAGE_EXTRACTOR_COMMON_PRODUCT_VALUE_PARSERS_H_
+
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "safe_deal/common/marketplace.mojom-shared.h"
+
+class GURL;
+
+namespace safe_deal {
+
+// Hand written parsers for the localized strings found on marketplace pages.
+// They run on every extracted field, so none of them use regular expressions
+// or allocate beyond the returned value.
+
+struct ParsedPrice {
+  int64_t micros = 0;
+  // ISO 4217 code, empty when the text carries no recognizable currency.
+  std::string currency_code;
+};
+
+// Parses strings such as "$1,299.99", "US $12.34", "EUR 9,99" or "1.299,00 €".
+// The decimal separator is inferred from the last separator in the number.
+std::optional<ParsedPrice> ParsePrice(std::string_view text);
+
+// Parses the first decimal number in |text| as a star rating out of five, e.g.
+// "4.5 out of 5 stars" or "4,7 von 5 Sternen". Returns the rating * 100.
+std::optional<uint16_t> ParseRating(std::string_view text);
+
+// Parses the first integer in |text|, ignoring digit grouping, e.g.
+// "1,234 ratings" or "(12.345)".
+std::optional<uint32_t> ParseCount(std::string_view text);
+
+// Returns the listing id encoded in a product page URL, such as the ASIN in
+// "/dp/B0C1234567" or the item id in "/itm/1234567890", or an empty string.
+// Ids are at most 20 characters long.
+std::string ExtractProductIdFromUrl(mojom::Marketplace marketplace,
+                                    const GURL& url);
+
+// Returns the value of query parameter |name| in |url|, or an empty string.
+std::string GetQueryParameter(const GURL& url, std::string_view name);
+
+// Returns the path segment that follows |prefix| in |url|, e.g. "acme" for
+// prefix "/str/" and "https://www.ebay.com/str/acme?_trksid=1".
+std::string GetPathSegmentAfter(const GURL& url, std::string_view prefix);
+
+// Collapses runs of whitespace and trims both ends.
+std::string NormalizeText(std::string_view text);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PAGE_EXTRACTOR_COMMON_PRODUCT_VALUE_PARSERS_H_
@@ -0,0 +1,77 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/page_extractor/common/product_value_parsers.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+namespace {
+
+using mojom::Marketplace;
+
+TEST(ProductValueParsersTest, ExtractProductIdFromUrl) {
+  EXPECT_EQ("B0CHX1W1XY",
+            ExtractProductIdFromUrl(
+                Marketplace::kAmazon,
+                GURL("https://www.amazon.com/Anker-Cable/dp/b0chx1w1xy")));
+  EXPECT_EQ("B0CHX1W1XY",
+            ExtractProductIdFromUrl(
+                Marketplace::kAmazon,
+                GURL("https://www.amazon.com/gp/product/B0CHX1W1XY?th=1")));
+  EXPECT_EQ("", ExtractProductIdFromUrl(
+                    Marketplace::kAmazon,
+                    GURL("https://www.amazon.com/dp/B0CHX1W1XY1")));
+
+  EXPECT_EQ("1005006141584125",
+            ExtractProductIdFromUrl(
+                Marketplace::kAliExpress,
+                GURL("https://www.aliexpress.com/item/1005006141584125.html")));
+  EXPECT_EQ("", ExtractProductIdFromUrl(
+                    Marketplace::kAliExpress,
+                    GURL("https://www.aliexpress.com/item/10050a.html")));
+
+  EXPECT_EQ("256123456789",
+            ExtractProductIdFromUrl(
+                Marketplace::kEbay,
+                GURL("https://www.ebay.com/itm/usb-c-cable/256123456789")));
+  EXPECT_EQ("256123456789",
+            ExtractProductIdFromUrl(
+                Marketplace::kEbay,
+                GURL("https://www.ebay.com/itm/256123456789")));
+
+  EXPECT_EQ("", ExtractProductIdFromUrl(
+                    Marketplace::kUnknown,
+                    GURL("https://www.ebay.com/itm/256123456789")));
+}
+
+// Any page can navigate to a URL with a long digit run, which must not make
+// it into the id sent to the browser.
+TEST(ProductValueParsersTest, ExtractProductIdFromUrlLength) {
+  const std::string max_id(20, '9');
+  const std::string long_id(21, '9');
+  EXPECT_EQ(max_id, ExtractProductIdFromUrl(
+                        Marketplace::kAliExpress,
+                        GURL("https://www.aliexpress.com/item/" + max_id +
+                             ".html")));
+  EXPECT_EQ("", ExtractProductIdFromUrl(
+                    Marketplace::kAliExpress,
+                    GURL("https://www.aliexpress.com/item/" + long_id +
+                         ".html")));
+  EXPECT_EQ(max_id, ExtractProductIdFromUrl(
+                        Marketplace::kEbay,
+                        GURL("https://www.ebay.com/itm/" + max_id)));
+  const std::string huge_id(4096, '1');
+  EXPECT_EQ("", ExtractProductIdFromUrl(
+                    Marketplace::kEbay, GURL("https://www.ebay.com/itm/" +
+                                             huge_id)));
+}
+
+}  // namespace
+
+}  // namespace safe_deal
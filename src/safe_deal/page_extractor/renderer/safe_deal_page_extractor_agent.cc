@@ -0,0 +1,260 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/page_extractor/renderer/safe_deal_page_extractor_agent.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+#include "base/metrics/histogram_functions.h"
+#include "base/third_party/icu/icu_utf.h"
+#include "base/timer/elapsed_timer.h"
+#include "base/trace_event/trace_event.h"
+#include "content/public/renderer/render_frame.h"
+#include "safe_deal/common/page_arena.h"
+#include "safe_deal/common/safe_deal_constants.h"
+#include "safe_deal/common/thread_allocation_stats.h"
+#include "safe_deal/page_extractor/common/product_page_parser.h"
+#include "third_party/blink/public/platform/browser_interface_broker_proxy.h"
+#include "third_party/blink/public/platform/web_string.h"
+#include "third_party/blink/public/web/web_document.h"
+#include "third_party/blink/public/web/web_element.h"
+#include "third_party/blink/public/web/web_local_frame.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Bounds the walk on pathological documents. Product pages on the supported
+// marketplaces stay well below this.
+constexpr size_t kMaxVisitedElements = 100'000;
+
+// Tag and attribute names, created once per walk rather than per element.
+struct ElementNames {
+  const blink::WebString script = blink::WebString::FromASCII("script");
+  const blink::WebString style = blink::WebString::FromASCII("style");
+  const blink::WebString noscript = blink::WebString::FromASCII("noscript");
+  const blink::WebString template_tag = blink::WebString::FromASCII("template");
+  const blink::WebString svg = blink::WebString::FromASCII("svg");
+  const blink::WebString a = blink::WebString::FromASCII("a");
+  const blink::WebString id = blink::WebString::FromASCII("id");
+  const blink::WebString class_name = blink::WebString::FromASCII("class");
+  const blink::WebString itemprop = blink::WebString::FromASCII("itemprop");
+  const blink::WebString content = blink::WebString::FromASCII("content");
+  const blink::WebString value = blink::WebString::FromASCII("value");
+  const blink::WebString title = blink::WebString::FromASCII("title");
+  const blink::WebString href = blink::WebString::FromASCII("href");
+  // Empty for marketplaces without one.
+  blink::WebString extra_attribute;
+};
+
+// Returns |value| as UTF-8 in |arena|. Unpaired surrogates become U+FFFD,
+// as with WebString::Utf8().
+std::string_view ToUtf8(const blink::WebString& value, PageArena& arena) {
+  const size_t length = value.length();
+  if (length == 0) {
+    return std::string_view();
+  }
+  // Latin-1 characters take at most 2 bytes, UTF-16 code units 3.
+  const size_t max_size = length * (value.Is8Bit() ? 2 : 3);
+  uint8_t* const buffer = static_cast<uint8_t*>(arena.Allocate(max_size, 1));
+  size_t size = 0;
+  if (value.Is8Bit()) {
+    const blink::WebLChar* data = value.Data8();
+    for (size_t i = 0; i < length; ++i) {
+      CBU8_APPEND_UNSAFE(buffer, size, data[i]);
+    }
+  } else {
+    const blink::WebUChar* data = value.Data16();
+    for (size_t i = 0; i < length;) {
+      base_icu::UChar32 code_point;
+      CBU16_NEXT(data, i, length, code_point);
+      if (CBU_IS_SURROGATE(code_point)) {
+        code_point = 0xfffd;
+      }
+      CBU8_APPEND_UNSAFE(buffer, size, code_point);
+    }
+  }
+  arena.Shrink(buffer, size);
+  return std::string_view(reinterpret_cast<const char*>(buffer), size);
+}
+
+std::string_view GetAttributeUtf8(const blink::WebElement& element,
+                                  const blink::WebString& name,
+                                  PageArena& arena) {
+  return ToUtf8(element.GetAttribute(name), arena);
+}
+
+// Subtrees that can never hold product data.
+bool ShouldSkipSubtree(const blink::WebElement& element,
+                       const ElementNames& names) {
+  return element.HasHTMLTagName(names.script) ||
+         element.HasHTMLTagName(names.style) ||
+         element.HasHTMLTagName(names.noscript) ||
+         element.HasHTMLTagName(names.template_tag) ||
+         element.HasHTMLTagName(names.svg);
+}
+
+// Returns the node after |node| in a pre-order traversal of |root|, skipping
+// the children of |node| unless |descend| is set.
+blink::WebNode NextNode(const blink::WebNode& node,
+                        const blink::WebNode& root,
+                        bool descend) {
+  if (descend) {
+    blink::WebNode child = node.FirstChild();
+    if (!child.IsNull()) {
+      return child;
+    }
+  }
+  for (blink::WebNode current = node; !current.IsNull() && current != root;
+       current = current.ParentNode()) {
+    blink::WebNode sibling = current.NextSibling();
+    if (!sibling.IsNull()) {
+      return sibling;
+    }
+  }
+  return blink::WebNode();
+}
+
+std::string_view ReadValue(const blink::WebElement& element,
+                           const SelectorSpec& spec,
+                           const ElementNames& names,
+                           PageArena& arena) {
+  switch (spec.source) {
+    case ValueSource::kText:
+      return ToUtf8(element.TextContent(), arena);
+    case ValueSource::kContentAttribute:
+      return GetAttributeUtf8(element, names.content, arena);
+    case ValueSource::kValueAttribute:
+      return GetAttributeUtf8(element, names.value, arena);
+    case ValueSource::kTitleAttribute:
+      return GetAttributeUtf8(element, names.title, arena);
+    case ValueSource::kHrefQueryParameter:
+    case ValueSource::kHrefPathSegment: {
+      // Sellers are usually linked from a child anchor of the matched node.
+      if (element.HasHTMLTagName(names.a)) {
+        return GetAttributeUtf8(element, names.href, arena);
+      }
+      blink::WebElementCollection anchors =
+          element.GetElementsByHTMLTagName(names.a);
+      blink::WebElement anchor = anchors.FirstItem();
+      return anchor.IsNull() ? std::string_view()
+                             : GetAttributeUtf8(anchor, names.href, arena);
+    }
+  }
+}
+
+}  // namespace
+
+SafeDealPageExtractorAgent::SafeDealPageExtractorAgent(
+    content::RenderFrame* render_frame)
+    : content::RenderFrameObserver(render_frame) {}
+
+SafeDealPageExtractorAgent::~SafeDealPageExtractorAgent() = default;
+
+void SafeDealPageExtractorAgent::DidCommitProvisionalLoad(
+    ui::PageTransition transition) {
+  // The browser side is per document; a new document needs a new pipe.
+  host_.reset();
+  extracted_ = false;
+  arena_.Reset();
+}
+
+void SafeDealPageExtractorAgent::DidFinishLoad() {
+  if (extracted_ || !render_frame()->IsMainFrame()) {
+    return;
+  }
+  extracted_ = true;
+  ExtractProduct();
+}
+
+void SafeDealPageExtractorAgent::OnDestruct() {
+  delete this;
+}
+
+void SafeDealPageExtractorAgent::ExtractProduct() {
+  blink::WebDocument document = render_frame()->GetWebFrame()->GetDocument();
+  GURL url = document.Url();
+  if (!url.SchemeIs(url::kHttpsScheme)) {
+    return;
+  }
+  mojom::Marketplace marketplace = GetMarketplaceForHost(url.host_piece());
+  if (marketplace == mojom::Marketplace::kUnknown) {
+    return;
+  }
+
+  TRACE_EVENT("safe_deal", "SafeDealPageExtractorAgent::ExtractProduct");
+  base::ElapsedTimer timer;
+  ProductPageParser parser(marketplace, url);
+  ElementNames names;
+  names.extra_attribute = blink::WebString::FromUTF8(
+      GetCompiledSelectors(marketplace).extra_attribute());
+  const blink::WebNode root = document.DocumentElement();
+
+  // The walk itself should not call malloc; only the values the parser keeps
+  // do. Reported for tools/bench/allocation_benchmark.mjs. What Blink
+  // allocates on its own heaps to answer the walk is not counted; see
+  // GetThreadAllocationStats().
+  const uint64_t walk_allocations_start = GetThreadAllocationStats().count;
+  uint64_t value_allocations = 0;
+  size_t visited = 0;
+  blink::WebNode node = root;
+  while (!node.IsNull() && !parser.IsComplete() &&
+         visited++ < kMaxVisitedElements) {
+    if (!node.IsElementNode()) {
+      node = NextNode(node, root, /*descend=*/false);
+      continue;
+    }
+    blink::WebElement element = node.To<blink::WebElement>();
+    if (ShouldSkipSubtree(element, names)) {
+      node = NextNode(node, root, /*descend=*/false);
+      continue;
+    }
+
+    // The values are done with once the parser has seen them.
+    const PageArena::Mark mark = arena_.GetMark();
+    ElementAttributes attributes = {
+        .id = GetAttributeUtf8(element, names.id, arena_),
+        .class_name = GetAttributeUtf8(element, names.class_name, arena_),
+        .itemprop = GetAttributeUtf8(element, names.itemprop, arena_)};
+    if (!names.extra_attribute.IsEmpty()) {
+      attributes.extra_attribute =
+          GetAttributeUtf8(element, names.extra_attribute, arena_);
+    }
+    int spec = parser.MatchElement(attributes);
+    if (spec >= 0) {
+      std::string_view value =
+          ReadValue(element, parser.spec(spec), names, arena_);
+      const uint64_t value_allocations_start = GetThreadAllocationStats().count;
+      parser.ConsumeValue(spec, value);
+      value_allocations +=
+          GetThreadAllocationStats().count - value_allocations_start;
+    }
+    arena_.RewindTo(mark);
+    node = NextNode(node, root, /*descend=*/true);
+  }
+  TRACE_EVENT_INSTANT("safe_deal", "SafeDealHeapAllocations", "path",
+                      "PageExtractor.Walk", "counted",
+                      CanCountThreadAllocations(), "units", visited,
+                      "allocations",
+                      GetThreadAllocationStats().count -
+                          walk_allocations_start - value_allocations);
+  base::UmaHistogramCustomMicrosecondsTimes(
+      "SafeDeal.PageExtractor.ExtractionTime", timer.Elapsed(),
+      base::Microseconds(10), base::Seconds(1), 50);
+
+  if (!parser.HasProductFields()) {
+    return;
+  }
+  if (!host_.is_bound()) {
+    render_frame()->GetBrowserInterfaceBroker().GetInterface(
+        host_.BindNewPipeAndPassReceiver());
+  }
+  host_->OnProductExtracted(parser.TakeProductData());
+}
+
+}  // namespace safe_deal
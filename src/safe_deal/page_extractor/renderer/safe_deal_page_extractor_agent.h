@@ -0,0 +1,44 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PAGE_EXTRACTOR_RENDERER_SAFE_DEAL_PAGE_EXTRACTOR_AGENT_H_
+#define SAFE_DEAL_PAGE_EXTRACTOR_RENDERER_SAFE_DEAL_PAGE_EXTRACTOR_AGENT_H_
+
+#include "content/public/renderer/render_frame_observer.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "safe_deal/common/page_arena.h"
+#include "safe_deal/page_extractor/common/page_extractor.mojom.h"
+
+namespace safe_deal {
+
+// Extracts product data from main frame marketplace documents once they have
+// finished loading and reports it to the browser. The DOM is walked once, in
+// document order, and only elements matched by the precompiled selectors have
+// their text read. Owns itself and is destroyed with the RenderFrame.
+class SafeDealPageExtractorAgent : public content::RenderFrameObserver {
+ public:
+  explicit SafeDealPageExtractorAgent(content::RenderFrame* render_frame);
+  SafeDealPageExtractorAgent(const SafeDealPageExtractorAgent&) = delete;
+  SafeDealPageExtractorAgent& operator=(const SafeDealPageExtractorAgent&) =
+      delete;
+  ~SafeDealPageExtractorAgent() override;
+
+  // content::RenderFrameObserver:
+  void DidCommitProvisionalLoad(ui::PageTransition transition) override;
+  void DidFinishLoad() override;
+  void OnDestruct() override;
+
+ private:
+  void ExtractProduct();
+
+  mojo::Remote<mojom::PageExtractorHost> host_;
+  bool extracted_ = false;
+  // Attribute values and element text read during extraction, freed when
+  // the frame commits the next document.
+  PageArena arena_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PAGE_EXTRACTOR_RENDERER_SAFE_DEAL_PAGE_EXTRACTOR_AGENT_H_
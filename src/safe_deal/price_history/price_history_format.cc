@@ -0,0 +1,149 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/price_history/price_history_format.h"
+
+#include <string.h>
+
+#include "base/check_op.h"
+#include "base/hash/hash.h"
+
+namespace safe_deal::price_history {
+
+namespace {
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void AppendVarint(uint64_t value, std::vector<uint8_t>& out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+// Reads a varint from the front of |data|, advancing it. Returns false on
+// truncated or overlong input.
+bool ReadVarint(base::span<const uint8_t>& data, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (data.empty()) {
+      return false;
+    }
+    uint8_t byte = data.front();
+    data = data.subspan(1u);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if |column| holds exactly |count| varints.
+bool IsValidColumn(base::span<const uint8_t> column, size_t count) {
+  uint64_t ignored;
+  for (size_t i = 0; i < count; ++i) {
+    if (!ReadVarint(column, ignored)) {
+      return false;
+    }
+  }
+  return column.empty();
+}
+
+}  // namespace
+
+std::vector<uint8_t> EncodeBlock(uint64_t product_hash,
+                                 uint64_t previous_block_offset,
+                                 base::span<const EncodedPoint> points) {
+  CHECK(!points.empty());
+  CHECK_LE(points.size(), kMaxPointsPerBlock);
+
+  // Deltas are taken against the previous point; the first point's deltas are
+  // zero since its absolute values live in the header.
+  std::vector<uint8_t> timestamps;
+  std::vector<uint8_t> prices;
+  EncodedPoint previous = points.front();
+  for (const EncodedPoint& point : points) {
+    DCHECK_GE(point.time, previous.time);
+    AppendVarint(static_cast<uint64_t>(point.time - previous.time), timestamps);
+    AppendVarint(ZigZagEncode(point.price_micros - previous.price_micros),
+                 prices);
+    previous = point;
+  }
+
+  BlockHeader header = {};
+  header.product_hash = product_hash;
+  header.previous_block_offset = previous_block_offset;
+  header.first_time = points.front().time;
+  header.last_time = points.back().time;
+  header.first_price_micros = points.front().price_micros;
+  header.point_count = static_cast<uint16_t>(points.size());
+  header.timestamp_bytes = static_cast<uint32_t>(timestamps.size());
+  header.price_bytes = static_cast<uint32_t>(prices.size());
+
+  std::vector<uint8_t> block(sizeof(BlockHeader));
+  block.insert(block.end(), timestamps.begin(), timestamps.end());
+  block.insert(block.end(), prices.begin(), prices.end());
+  header.checksum = base::PersistentHash(
+      base::span(block).subspan(sizeof(BlockHeader)));
+  memcpy(block.data(), &header, sizeof(header));
+  return block;
+}
+
+std::optional<BlockHeader> ReadBlockHeader(base::span<const uint8_t> data) {
+  if (data.size() < sizeof(BlockHeader)) {
+    return std::nullopt;
+  }
+  BlockHeader header;
+  memcpy(&header, data.data(), sizeof(header));
+  if (header.point_count == 0 || header.point_count > kMaxPointsPerBlock ||
+      header.last_time < header.first_time ||
+      data.size() - sizeof(BlockHeader) <
+          static_cast<uint64_t>(header.timestamp_bytes) + header.price_bytes) {
+    return std::nullopt;
+  }
+  base::span<const uint8_t> columns = data.subspan(
+      sizeof(BlockHeader), size_t{header.timestamp_bytes} + header.price_bytes);
+  if (base::PersistentHash(columns) != header.checksum ||
+      !IsValidColumn(columns.first(header.timestamp_bytes),
+                     header.point_count) ||
+      !IsValidColumn(columns.subspan(header.timestamp_bytes),
+                     header.point_count)) {
+    return std::nullopt;
+  }
+  return header;
+}
+
+size_t GetBlockSize(const BlockHeader& header) {
+  return sizeof(BlockHeader) + header.timestamp_bytes + header.price_bytes;
+}
+
+void DecodeBlock(const BlockHeader& header,
+                 base::span<const uint8_t> data,
+                 std::vector<EncodedPoint>& points) {
+  base::span<const uint8_t> timestamps =
+      data.subspan(sizeof(BlockHeader), header.timestamp_bytes);
+  base::span<const uint8_t> prices = data.subspan(
+      sizeof(BlockHeader) + header.timestamp_bytes, header.price_bytes);
+  EncodedPoint point = {header.first_time, header.first_price_micros};
+  for (size_t i = 0; i < header.point_count; ++i) {
+    uint64_t time_delta = 0;
+    uint64_t price_delta = 0;
+    ReadVarint(timestamps, time_delta);
+    ReadVarint(prices, price_delta);
+    point.time += static_cast<int64_t>(time_delta);
+    point.price_micros += ZigZagDecode(price_delta);
+    points.push_back(point);
+  }
+}
+
+}  // namespace safe_deal::price_history
@@ -0,0 +1,112 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRICE_HISTORY_PRICE_HISTORY_FORMAT_H_
+#define SAFE_DEAL_PRICE_HISTORY_PRICE_HISTORY_FORMAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+#include <vector>
+
+#include "base/containers/span.h"
+
+// On-disk layout of the price history store. All integers are little endian.
+//
+// The data file is append-only: a DataFileHeader followed by blocks. Each
+// block holds consecutive points of one product in two columns, delta
+// encoded timestamps followed by delta encoded prices, and points back at the
+// product's previous block, so reading a product walks its chain from newest
+// to oldest and stops as soon as a block ends before the requested range.
+//
+// The index file is a sorted array of IndexEntry keyed by product hash that
+// points at the newest block of every product. It is rewritten atomically and
+// covers the data file up to IndexFileHeader::data_file_length; blocks after
+// that are picked up by scanning only the tail of the data file on open.
+namespace safe_deal::price_history {
+
+inline constexpr uint32_t kDataFileMagic = 0x48504453;   // "SDPH"
+inline constexpr uint32_t kIndexFileMagic = 0x49504453;  // "SDPI"
+
+// Bump when the layout changes. Files with another version are discarded.
+inline constexpr uint32_t kFormatVersion = 1;
+
+// Points are buffered in memory and written as one block per product; this
+// bounds the size of a block.
+inline constexpr size_t kMaxPointsPerBlock = 256;
+
+#pragma pack(push, 1)
+
+struct DataFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t reserved;
+};
+
+struct BlockHeader {
+  uint64_t product_hash;
+  // Offset of the product's previous block, or 0 if this is the first one.
+  uint64_t previous_block_offset;
+  // Seconds since the Unix epoch of the first and last point.
+  int64_t first_time;
+  int64_t last_time;
+  int64_t first_price_micros;
+  uint16_t point_count;
+  uint16_t reserved;
+  // Sizes of the timestamp and price columns that follow the header.
+  uint32_t timestamp_bytes;
+  uint32_t price_bytes;
+  // base::PersistentHash() of the two columns.
+  uint32_t checksum;
+};
+
+struct IndexFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t data_file_length;
+  uint64_t entry_count;
+};
+
+struct IndexEntry {
+  uint64_t product_hash;
+  uint64_t last_block_offset;
+  int64_t last_time;
+  int64_t last_price_micros;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(DataFileHeader) == 16);
+static_assert(sizeof(BlockHeader) == 56);
+static_assert(sizeof(IndexFileHeader) == 24);
+static_assert(sizeof(IndexEntry) == 32);
+
+struct EncodedPoint {
+  int64_t time;
+  int64_t price_micros;
+};
+
+// Encodes |points|, which must be non-empty, sorted by time and at most
+// kMaxPointsPerBlock long, into a complete block.
+std::vector<uint8_t> EncodeBlock(uint64_t product_hash,
+                                 uint64_t previous_block_offset,
+                                 base::span<const EncodedPoint> points);
+
+// Validates the block at the start of |data| and returns its header, or
+// nullopt if it is truncated or corrupt. |data| may extend past the block.
+std::optional<BlockHeader> ReadBlockHeader(base::span<const uint8_t> data);
+
+// Returns the total size of the block described by |header|.
+size_t GetBlockSize(const BlockHeader& header);
+
+// Appends the points of a block previously validated by ReadBlockHeader() to
+// |points|.
+void DecodeBlock(const BlockHeader& header,
+                 base::span<const uint8_t> data,
+                 std::vector<EncodedPoint>& points);
+
+}  // namespace safe_deal::price_history
+
+#endif  // SAFE_DEAL_PRICE_HISTORY_PRICE_HISTORY_FORMAT_H_
@@ -0,0 +1,151 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/price_history/price_history_format.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal::price_history {
+
+namespace {
+
+constexpr uint64_t kProductHash = 0x1234567890abcdef;
+
+std::vector<EncodedPoint> MakePoints() {
+  // Prices that go down as well as up, and deltas that need several varint
+  // bytes.
+  return {{1700000000, 19'990'000},
+          {1700000060, 17'500'000},
+          {1700086400, 17'500'001},
+          {1800000000, 1'000'000'000'000},
+          {1800000000, 0}};
+}
+
+void ExpectPointsEq(const std::vector<EncodedPoint>& expected,
+                    const std::vector<EncodedPoint>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].time, actual[i].time) << i;
+    EXPECT_EQ(expected[i].price_micros, actual[i].price_micros) << i;
+  }
+}
+
+BlockHeader GetHeader(const std::vector<uint8_t>& block) {
+  BlockHeader header;
+  memcpy(&header, block.data(), sizeof(header));
+  return header;
+}
+
+void SetHeader(const BlockHeader& header, std::vector<uint8_t>& block) {
+  memcpy(block.data(), &header, sizeof(header));
+}
+
+TEST(PriceHistoryFormatTest, RoundTrip) {
+  const std::vector<EncodedPoint> points = MakePoints();
+  std::vector<uint8_t> block = EncodeBlock(kProductHash, 4096, points);
+
+  std::optional<BlockHeader> header = ReadBlockHeader(block);
+  ASSERT_TRUE(header);
+  EXPECT_EQ(kProductHash, header->product_hash);
+  EXPECT_EQ(4096u, header->previous_block_offset);
+  EXPECT_EQ(points.front().time, header->first_time);
+  EXPECT_EQ(points.back().time, header->last_time);
+  EXPECT_EQ(points.size(), header->point_count);
+  EXPECT_EQ(block.size(), GetBlockSize(*header));
+
+  std::vector<EncodedPoint> decoded;
+  DecodeBlock(*header, block, decoded);
+  ExpectPointsEq(points, decoded);
+}
+
+TEST(PriceHistoryFormatTest, FullBlockRoundTrips) {
+  std::vector<EncodedPoint> points;
+  for (size_t i = 0; i < kMaxPointsPerBlock; ++i) {
+    points.push_back({static_cast<int64_t>(1700000000 + i * 3600),
+                      static_cast<int64_t>(i % 2 ? 5'000'000 : 4'990'000)});
+  }
+  std::vector<uint8_t> block = EncodeBlock(kProductHash, 0, points);
+  std::optional<BlockHeader> header = ReadBlockHeader(block);
+  ASSERT_TRUE(header);
+  std::vector<EncodedPoint> decoded;
+  DecodeBlock(*header, block, decoded);
+  ExpectPointsEq(points, decoded);
+}
+
+TEST(PriceHistoryFormatTest, AllowsTrailingData) {
+  std::vector<uint8_t> block = EncodeBlock(kProductHash, 0, MakePoints());
+  const size_t block_size = block.size();
+  // The next block, or garbage from a torn write.
+  block.insert(block.end(), 100, 0xff);
+  std::optional<BlockHeader> header = ReadBlockHeader(block);
+  ASSERT_TRUE(header);
+  EXPECT_EQ(block_size, GetBlockSize(*header));
+}
+
+TEST(PriceHistoryFormatTest, RejectsTruncatedBlocks) {
+  std::vector<uint8_t> block = EncodeBlock(kProductHash, 0, MakePoints());
+  for (size_t size = 0; size < block.size(); ++size) {
+    EXPECT_FALSE(ReadBlockHeader(base::span(block).first(size))) << size;
+  }
+}
+
+TEST(PriceHistoryFormatTest, RejectsCorruptColumns) {
+  const std::vector<uint8_t> block =
+      EncodeBlock(kProductHash, 0, MakePoints());
+  for (size_t i = sizeof(BlockHeader); i < block.size(); ++i) {
+    std::vector<uint8_t> corrupt = block;
+    corrupt[i] ^= 0x01;
+    EXPECT_FALSE(ReadBlockHeader(corrupt)) << i;
+  }
+}
+
+TEST(PriceHistoryFormatTest, RejectsInconsistentHeaders) {
+  const std::vector<uint8_t> block =
+      EncodeBlock(kProductHash, 0, MakePoints());
+
+  std::vector<uint8_t> corrupt = block;
+  BlockHeader header = GetHeader(block);
+  header.point_count = 0;
+  SetHeader(header, corrupt);
+  EXPECT_FALSE(ReadBlockHeader(corrupt));
+
+  // The columns hold fewer varints than claimed.
+  header = GetHeader(block);
+  ++header.point_count;
+  SetHeader(header, corrupt);
+  EXPECT_FALSE(ReadBlockHeader(corrupt));
+
+  header = GetHeader(block);
+  header.point_count = kMaxPointsPerBlock + 1;
+  SetHeader(header, corrupt);
+  EXPECT_FALSE(ReadBlockHeader(corrupt));
+
+  header = GetHeader(block);
+  header.last_time = header.first_time - 1;
+  SetHeader(header, corrupt);
+  EXPECT_FALSE(ReadBlockHeader(corrupt));
+
+  // Column sizes past the end of the data, including ones that overflow when
+  // added.
+  header = GetHeader(block);
+  header.price_bytes = 0xffffffff;
+  header.timestamp_bytes = 0xffffffff;
+  SetHeader(header, corrupt);
+  EXPECT_FALSE(ReadBlockHeader(corrupt));
+
+  // Moving the boundary between the columns keeps the checksum valid.
+  header = GetHeader(block);
+  ++header.timestamp_bytes;
+  --header.price_bytes;
+  SetHeader(header, corrupt);
+  EXPECT_FALSE(ReadBlockHeader(corrupt));
+}
+
+}  // namespace
+
+}  // namespace safe_deal::price_history
@@ -0,0 +1,89 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/price_history/price_history_service.h"
+
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/task/thread_pool.h"
+#include "safe_deal/common/product_key.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr base::FilePath::CharType kDirectoryName[] =
+    FILE_PATH_LITERAL("Safe Deal");
+
+constexpr base::TimeDelta kFlushDelay = base::Seconds(30);
+
+}  // namespace
+
+PriceHistoryService::PriceHistoryService(const base::FilePath& profile_path)
+    : store_(base::ThreadPool::CreateSequencedTaskRunner(
+                 {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+                  base::TaskShutdownBehavior::BLOCK_SHUTDOWN}),
+             profile_path.Append(kDirectoryName)) {
+  store_.AsyncCall(&PriceHistoryStore::Init);
+}
+
+PriceHistoryService::~PriceHistoryService() = default;
+
+void PriceHistoryService::RecordPrice(mojom::Marketplace marketplace,
+                                      std::string_view product_id,
+                                      base::Time time,
+                                      int64_t price_micros) {
+  if (product_id.empty() || price_micros < 0) {
+    return;
+  }
+  store_.AsyncCall(&PriceHistoryStore::AddPoint)
+      .WithArgs(ComputeProductKeyHash(marketplace, product_id), time,
+                price_micros);
+  if (!flush_timer_.IsRunning()) {
+    flush_timer_.Start(FROM_HERE, kFlushDelay,
+                       base::BindOnce(
+                           [](base::SequenceBound<PriceHistoryStore>* store) {
+                             store->AsyncCall(&PriceHistoryStore::Flush);
+                           },
+                           base::Unretained(&store_)));
+  }
+}
+
+void PriceHistoryService::GetPriceHistory(mojom::Marketplace marketplace,
+                                          std::string_view product_id,
+                                          base::Time begin,
+                                          GetPriceHistoryCallback callback) {
+  store_.AsyncCall(&PriceHistoryStore::GetPoints)
+      .WithArgs(ComputeProductKeyHash(marketplace, product_id), begin)
+      .Then(std::move(callback));
+}
+
+void PriceHistoryService::GetPriceHistoryOnStoreSequence(
+    mojom::Marketplace marketplace,
+    std::string_view product_id,
+    base::Time begin,
+    GetPriceHistoryCallback callback) {
+  store_.PostTaskWithThisObject(base::BindOnce(
+      [](uint64_t product_hash, base::Time begin,
+         GetPriceHistoryCallback callback, PriceHistoryStore* store) {
+        std::move(callback).Run(store->GetPoints(product_hash, begin));
+      },
+      ComputeProductKeyHash(marketplace, product_id), begin,
+      std::move(callback)));
+}
+
+void PriceHistoryService::GetMappedBytes(
+    base::OnceCallback<void(size_t)> callback) {
+  store_.AsyncCall(&PriceHistoryStore::mapped_bytes).Then(std::move(callback));
+}
+
+void PriceHistoryService::Shutdown() {
+  flush_timer_.Stop();
+  // Destroying the store on its sequence flushes it. BLOCK_SHUTDOWN keeps
+  // the browser alive until that is done.
+  store_.Reset();
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,71 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRICE_HISTORY_PRICE_HISTORY_SERVICE_H_
+#define SAFE_DEAL_PRICE_HISTORY_PRICE_HISTORY_SERVICE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/functional/callback.h"
+#include "base/threading/sequence_bound.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/price_history/price_history_store.h"
+
+namespace safe_deal {
+
+// Profile keyed front end of PriceHistoryStore. The store lives on a
+// dedicated blocking sequence; all methods here must be called on the UI
+// thread and never block.
+class PriceHistoryService : public KeyedService {
+ public:
+  using GetPriceHistoryCallback =
+      base::OnceCallback<void(std::vector<PricePoint>)>;
+
+  explicit PriceHistoryService(const base::FilePath& profile_path);
+  PriceHistoryService(const PriceHistoryService&) = delete;
+  PriceHistoryService& operator=(const PriceHistoryService&) = delete;
+  ~PriceHistoryService() override;
+
+  // Records the price of a listing seen at |time|.
+  void RecordPrice(mojom::Marketplace marketplace,
+                   std::string_view product_id,
+                   base::Time time,
+                   int64_t price_micros);
+
+  // Replies with the points recorded for the listing since |begin|.
+  void GetPriceHistory(mojom::Marketplace marketplace,
+                       std::string_view product_id,
+                       base::Time begin,
+                       GetPriceHistoryCallback callback);
+
+  // As GetPriceHistory(), but runs |callback| on the store's sequence, for
+  // callers that continue in the background, like SafeDealPipeline stages.
+  void GetPriceHistoryOnStoreSequence(mojom::Marketplace marketplace,
+                                      std::string_view product_id,
+                                      base::Time begin,
+                                      GetPriceHistoryCallback callback);
+
+  // Replies with how much of the history files is currently mapped.
+  void GetMappedBytes(base::OnceCallback<void(size_t)> callback);
+
+  // KeyedService:
+  void Shutdown() override;
+
+ private:
+  base::SequenceBound<PriceHistoryStore> store_;
+  // Coalesces writes so that a burst of page loads costs one append.
+  base::OneShotTimer flush_timer_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRICE_HISTORY_PRICE_HISTORY_SERVICE_H_
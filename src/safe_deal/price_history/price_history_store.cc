@@ -0,0 +1,411 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/price_history/price_history_store.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/containers/adapters.h"
+#include "base/containers/span.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/logging.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/strings/string_view_util.h"
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+
+namespace safe_deal {
+
+using price_history::BlockHeader;
+using price_history::DataFileHeader;
+using price_history::EncodedPoint;
+using price_history::IndexEntry;
+using price_history::IndexFileHeader;
+
+namespace {
+
+constexpr base::FilePath::CharType kDataFileName[] =
+    FILE_PATH_LITERAL("PriceHistory");
+constexpr base::FilePath::CharType kIndexFileName[] =
+    FILE_PATH_LITERAL("PriceHistory.index");
+
+// Saving the index rewrites it entirely, so it is only done once this many
+// products were written since the last save, and on shutdown.
+constexpr size_t kIndexRewriteThreshold = 512;
+
+template <typename T>
+T ReadStruct(base::span<const uint8_t> bytes, size_t offset) {
+  T value;
+  memcpy(&value, bytes.subspan(offset, sizeof(T)).data(), sizeof(T));
+  return value;
+}
+
+template <typename T>
+void AppendStruct(const T& value, std::vector<uint8_t>& out) {
+  auto bytes = base::byte_span_from_ref(value);
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+}  // namespace
+
+PriceHistoryStore::PriceHistoryStore(const base::FilePath& directory)
+    : data_path_(directory.Append(kDataFileName)),
+      index_path_(directory.Append(kIndexFileName)) {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+PriceHistoryStore::~PriceHistoryStore() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!initialized_) {
+    return;
+  }
+  Flush();
+  if (!unindexed_heads_.empty()) {
+    WriteIndex();
+  }
+}
+
+bool PriceHistoryStore::Init() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  SafeDealStartupMetrics::Scope scope("PriceHistoryStore::Init");
+  if (!base::CreateDirectory(data_path_.DirName()) || !OpenDataFile()) {
+    return false;
+  }
+  LoadIndex();
+  ScanDataFileFrom(indexed_data_length_);
+  initialized_ = true;
+  return true;
+}
+
+bool PriceHistoryStore::OpenDataFile() {
+  data_file_.Initialize(data_path_, base::File::FLAG_OPEN_ALWAYS |
+                                        base::File::FLAG_READ |
+                                        base::File::FLAG_APPEND);
+  if (!data_file_.IsValid()) {
+    LOG(ERROR) << "Failed to open " << data_path_ << ": "
+               << base::File::ErrorToString(data_file_.error_details());
+    return false;
+  }
+
+  int64_t length = data_file_.GetLength();
+  DataFileHeader header = {};
+  if (length >= static_cast<int64_t>(sizeof(header))) {
+    data_file_.Read(0, base::byte_span_from_ref(header));
+  }
+  if (length < static_cast<int64_t>(sizeof(header)) ||
+      header.magic != price_history::kDataFileMagic ||
+      header.version != price_history::kFormatVersion) {
+    if (length > 0) {
+      LOG(WARNING) << "Discarding incompatible price history " << data_path_;
+    }
+    base::DeleteFile(index_path_);
+    header = {.magic = price_history::kDataFileMagic,
+              .version = price_history::kFormatVersion};
+    if (!data_file_.SetLength(0) ||
+        !data_file_.WriteAtCurrentPosAndCheck(
+            base::byte_span_from_ref(header))) {
+      return false;
+    }
+    length = sizeof(header);
+  }
+  data_file_length_ = static_cast<uint64_t>(length);
+  return EnsureDataMapped(data_file_length_);
+}
+
+void PriceHistoryStore::LoadIndex() {
+  indexed_data_length_ = sizeof(DataFileHeader);
+  index_entry_count_ = 0;
+  index_mapping_.reset();
+
+  auto mapping = std::make_unique<base::MemoryMappedFile>();
+  if (!base::PathExists(index_path_) || !mapping->Initialize(index_path_)) {
+    return;
+  }
+  base::span<const uint8_t> bytes = mapping->bytes();
+  if (bytes.size() < sizeof(IndexFileHeader)) {
+    return;
+  }
+  auto header = ReadStruct<IndexFileHeader>(bytes, 0);
+  if (header.magic != price_history::kIndexFileMagic ||
+      header.version != price_history::kFormatVersion ||
+      header.data_file_length < sizeof(DataFileHeader) ||
+      header.data_file_length > data_file_length_ ||
+      (bytes.size() - sizeof(IndexFileHeader)) / sizeof(IndexEntry) <
+          header.entry_count) {
+    // A stale index is recovered by rescanning the whole data file.
+    LOG(WARNING) << "Ignoring invalid price history index";
+    return;
+  }
+  indexed_data_length_ = header.data_file_length;
+  index_entry_count_ = static_cast<size_t>(header.entry_count);
+  index_mapping_ = std::move(mapping);
+}
+
+void PriceHistoryStore::ScanDataFileFrom(uint64_t offset) {
+  base::span<const uint8_t> bytes = data_mapping_->bytes();
+  std::vector<EncodedPoint> points;
+  size_t scanned_blocks = 0;
+  while (offset < data_file_length_) {
+    std::optional<BlockHeader> header =
+        price_history::ReadBlockHeader(bytes.subspan(offset));
+    if (!header) {
+      LOG(WARNING) << "Truncating torn price history block at " << offset;
+      data_file_.SetLength(static_cast<int64_t>(offset));
+      data_file_length_ = offset;
+      break;
+    }
+    points.clear();
+    price_history::DecodeBlock(*header, bytes.subspan(offset), points);
+    unindexed_heads_.insert_or_assign(
+        header->product_hash,
+        ProductHead{offset, header->last_time, points.back().price_micros});
+    offset += price_history::GetBlockSize(*header);
+    ++scanned_blocks;
+  }
+  base::UmaHistogramCounts10000("SafeDeal.PriceHistory.BlocksScannedOnOpen",
+                                scanned_blocks);
+}
+
+bool PriceHistoryStore::EnsureDataMapped(uint64_t end) {
+  if (data_mapping_ && data_mapping_->length() >= end) {
+    return true;
+  }
+  // Appends go through |data_file_|; remap to see them. The previous mapping
+  // stays valid until replaced.
+  auto mapping = std::make_unique<base::MemoryMappedFile>();
+  if (!mapping->Initialize(data_path_) || mapping->length() < end) {
+    return false;
+  }
+  data_mapping_ = std::move(mapping);
+  return true;
+}
+
+std::optional<IndexEntry> PriceHistoryStore::FindIndexEntry(
+    uint64_t product_hash) const {
+  if (!index_mapping_) {
+    return std::nullopt;
+  }
+  base::span<const uint8_t> entries =
+      index_mapping_->bytes().subspan(sizeof(IndexFileHeader));
+  size_t low = 0;
+  size_t high = index_entry_count_;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    auto entry = ReadStruct<IndexEntry>(entries, mid * sizeof(IndexEntry));
+    if (entry.product_hash == product_hash) {
+      return entry;
+    }
+    if (entry.product_hash < product_hash) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<PriceHistoryStore::ProductHead> PriceHistoryStore::FindHead(
+    uint64_t product_hash) {
+  auto it = unindexed_heads_.find(product_hash);
+  if (it != unindexed_heads_.end()) {
+    return it->second;
+  }
+  std::optional<IndexEntry> entry = FindIndexEntry(product_hash);
+  if (!entry) {
+    return std::nullopt;
+  }
+  return ProductHead{entry->last_block_offset, entry->last_time,
+                     entry->last_price_micros};
+}
+
+void PriceHistoryStore::AddPoint(uint64_t product_hash,
+                                 base::Time time,
+                                 int64_t price_micros) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!initialized_) {
+    return;
+  }
+  EncodedPoint point = {time.ToTimeT(), price_micros};
+  std::vector<EncodedPoint>& pending = pending_[product_hash];
+  std::optional<EncodedPoint> last;
+  if (!pending.empty()) {
+    last = pending.back();
+  } else if (std::optional<ProductHead> head = FindHead(product_hash)) {
+    last = EncodedPoint{head->last_time, head->last_price_micros};
+  }
+  if (last && (point.time < last->time ||
+               point.price_micros == last->price_micros)) {
+    if (pending.empty()) {
+      pending_.erase(product_hash);
+    }
+    return;
+  }
+  pending.push_back(point);
+}
+
+std::vector<PricePoint> PriceHistoryStore::GetPoints(uint64_t product_hash,
+                                                     base::Time begin) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::vector<PricePoint> result;
+  if (!initialized_) {
+    return result;
+  }
+  const int64_t begin_time = begin.ToTimeT();
+
+  // Walk the chain newest to oldest, then emit the blocks in reverse.
+  std::vector<std::vector<EncodedPoint>> blocks;
+  std::optional<ProductHead> head = FindHead(product_hash);
+  uint64_t offset = head ? head->last_block_offset : 0;
+  if (!EnsureDataMapped(data_file_length_)) {
+    offset = 0;
+  }
+  while (offset != 0 && offset < data_file_length_) {
+    base::span<const uint8_t> data = data_mapping_->bytes().subspan(offset);
+    std::optional<BlockHeader> header = price_history::ReadBlockHeader(data);
+    if (!header || header->product_hash != product_hash) {
+      LOG(WARNING) << "Corrupt price history chain";
+      break;
+    }
+    if (header->last_time < begin_time) {
+      break;
+    }
+    price_history::DecodeBlock(*header, data, blocks.emplace_back());
+    // Chains only point backwards; anything else is corruption.
+    if (header->previous_block_offset >= offset) {
+      break;
+    }
+    offset = header->previous_block_offset;
+  }
+
+  auto append = [&](const EncodedPoint& point) {
+    if (point.time >= begin_time) {
+      result.push_back(
+          {base::Time::FromTimeT(point.time), point.price_micros});
+    }
+  };
+  for (auto& block : base::Reversed(blocks)) {
+    std::ranges::for_each(block, append);
+  }
+  auto pending = pending_.find(product_hash);
+  if (pending != pending_.end()) {
+    std::ranges::for_each(pending->second, append);
+  }
+  return result;
+}
+
+void PriceHistoryStore::Flush() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!initialized_ || pending_.empty()) {
+    return;
+  }
+  for (auto& [product_hash, points] : pending_) {
+    std::optional<ProductHead> head = FindHead(product_hash);
+    uint64_t previous_offset = head ? head->last_block_offset : 0;
+    base::span<const EncodedPoint> remaining(points);
+    while (!remaining.empty()) {
+      auto chunk = remaining.first(
+          std::min(remaining.size(), price_history::kMaxPointsPerBlock));
+      remaining = remaining.subspan(chunk.size());
+      std::vector<uint8_t> block =
+          price_history::EncodeBlock(product_hash, previous_offset, chunk);
+      if (!data_file_.WriteAtCurrentPosAndCheck(block)) {
+        LOG(ERROR) << "Failed to append to " << data_path_;
+        pending_.clear();
+        // Cut off whatever part of the block made it out. The file is opened
+        // for appending, so the next block then starts at
+        // |data_file_length_|, where the chains will look for it.
+        if (!data_file_.SetLength(static_cast<int64_t>(data_file_length_))) {
+          // Blocks appended after the torn one would be cut off with it by
+          // the next open, so stop like a failed Init().
+          initialized_ = false;
+        }
+        return;
+      }
+      previous_offset = data_file_length_;
+      data_file_length_ += block.size();
+      unindexed_heads_.insert_or_assign(
+          product_hash, ProductHead{previous_offset, chunk.back().time,
+                                    chunk.back().price_micros});
+    }
+  }
+  pending_.clear();
+  if (unindexed_heads_.size() >= kIndexRewriteThreshold) {
+    WriteIndex();
+  }
+}
+
+void PriceHistoryStore::WriteIndex() {
+  // Merge the mapped index with the heads written since.
+  std::vector<uint8_t> buffer;
+  buffer.reserve(sizeof(IndexFileHeader) +
+                 (index_entry_count_ + unindexed_heads_.size()) *
+                     sizeof(IndexEntry));
+  buffer.resize(sizeof(IndexFileHeader));
+  size_t entry_count = 0;
+  auto append = [&](const IndexEntry& entry) {
+    AppendStruct(entry, buffer);
+    ++entry_count;
+  };
+
+  base::span<const uint8_t> old_entries;
+  if (index_mapping_) {
+    old_entries = index_mapping_->bytes().subspan(sizeof(IndexFileHeader));
+  }
+  size_t old_index = 0;
+  for (const auto& [product_hash, head] : unindexed_heads_) {
+    for (; old_index < index_entry_count_; ++old_index) {
+      auto entry =
+          ReadStruct<IndexEntry>(old_entries, old_index * sizeof(IndexEntry));
+      if (entry.product_hash >= product_hash) {
+        // Replaced by the newer head below.
+        old_index += entry.product_hash == product_hash;
+        break;
+      }
+      append(entry);
+    }
+    append({product_hash, head.last_block_offset, head.last_time,
+            head.last_price_micros});
+  }
+  for (; old_index < index_entry_count_; ++old_index) {
+    append(ReadStruct<IndexEntry>(old_entries, old_index * sizeof(IndexEntry)));
+  }
+
+  IndexFileHeader header = {.magic = price_history::kIndexFileMagic,
+                            .version = price_history::kFormatVersion,
+                            .data_file_length = data_file_length_,
+                            .entry_count = entry_count};
+  memcpy(buffer.data(), &header, sizeof(header));
+
+  // Windows cannot replace a file that is mapped.
+  index_mapping_.reset();
+  if (!base::ImportantFileWriter::WriteFileAtomically(
+          index_path_, base::as_string_view(buffer),
+          "SafeDealPriceHistoryIndex")) {
+    LOG(ERROR) << "Failed to write " << index_path_;
+  }
+  unindexed_heads_.clear();
+  LoadIndex();
+  // If the index could not be written or read back, rebuild the in-memory
+  // heads from the data file so no product is lost.
+  if (indexed_data_length_ != data_file_length_) {
+    if (!EnsureDataMapped(data_file_length_)) {
+      // The heads cannot be rebuilt, so stop like a failed Init(). The next
+      // open rescans the data file.
+      LOG(ERROR) << "Failed to map " << data_path_;
+      initialized_ = false;
+      return;
+    }
+    ScanDataFileFrom(indexed_data_length_);
+  }
+}
+
+size_t PriceHistoryStore::mapped_bytes() const {
+  return (data_mapping_ ? data_mapping_->length() : 0) +
+         (index_mapping_ ? index_mapping_->length() : 0);
+}
+
+}  // namespace safe_deal
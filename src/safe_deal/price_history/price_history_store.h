@@ -0,0 +1,104 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRICE_HISTORY_PRICE_HISTORY_STORE_H_
+#define SAFE_DEAL_PRICE_HISTORY_PRICE_HISTORY_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+#include "safe_deal/price_history/price_history_format.h"
+
+namespace safe_deal {
+
+struct PricePoint {
+  base::Time time;
+  int64_t price_micros;
+};
+
+// Per-profile price history backed by the append-only files described in
+// price_history_format.h. Opening the store maps the index and scans only the
+// blocks written since the index was last saved, so its cost does not grow
+// with the amount of history. Performs blocking I/O and must live on a
+// sequence that allows it.
+class PriceHistoryStore {
+ public:
+  explicit PriceHistoryStore(const base::FilePath& directory);
+  PriceHistoryStore(const PriceHistoryStore&) = delete;
+  PriceHistoryStore& operator=(const PriceHistoryStore&) = delete;
+  // Flushes buffered points and saves the index.
+  ~PriceHistoryStore();
+
+  // Opens or creates the store. Files written with another format version
+  // are discarded. Returns false if the directory is unusable, in which case
+  // every other method is a no-op. So are they once the data file cannot be
+  // written or mapped anymore.
+  bool Init();
+
+  // Buffers a point for |product_hash|. Points older than the product's
+  // newest point are dropped, as are repeats of the newest price.
+  void AddPoint(uint64_t product_hash, base::Time time, int64_t price_micros);
+
+  // Returns the points of |product_hash| at or after |begin|, oldest first,
+  // including points not flushed yet.
+  std::vector<PricePoint> GetPoints(uint64_t product_hash, base::Time begin);
+
+  // Writes buffered points to the data file, and rewrites the index once
+  // enough products were updated since it was last saved.
+  void Flush();
+
+  size_t mapped_bytes() const;
+
+ private:
+  struct ProductHead {
+    uint64_t last_block_offset;
+    int64_t last_time;
+    int64_t last_price_micros;
+  };
+
+  bool OpenDataFile();
+  void LoadIndex();
+  // Picks up blocks appended after the index was saved and truncates a torn
+  // trailing block, if any.
+  void ScanDataFileFrom(uint64_t offset);
+  // Ensures [0, |end|) of the data file is mapped.
+  bool EnsureDataMapped(uint64_t end);
+  std::optional<price_history::IndexEntry> FindIndexEntry(
+      uint64_t product_hash) const;
+  std::optional<ProductHead> FindHead(uint64_t product_hash);
+  void WriteIndex();
+
+  const base::FilePath data_path_;
+  const base::FilePath index_path_;
+  bool initialized_ = false;
+
+  base::File data_file_;
+  uint64_t data_file_length_ = 0;
+  std::unique_ptr<base::MemoryMappedFile> data_mapping_;
+
+  std::unique_ptr<base::MemoryMappedFile> index_mapping_;
+  size_t index_entry_count_ = 0;
+  uint64_t indexed_data_length_ = 0;
+
+  // Newest block of products written since the index was saved.
+  base::flat_map<uint64_t, ProductHead> unindexed_heads_;
+  // Points not written to the data file yet, per product.
+  base::flat_map<uint64_t, std::vector<price_history::EncodedPoint>> pending_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRICE_HISTORY_PRICE_HISTORY_STORE_H_
@@ -0,0 +1,220 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/price_history/price_history_store.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "build/build_config.h"
+#include "safe_deal/price_history/price_history_format.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#if BUILDFLAG(IS_POSIX)
+#include <signal.h>
+#include <sys/resource.h>
+#endif
+
+namespace safe_deal {
+
+namespace {
+
+constexpr uint64_t kProduct = 1;
+constexpr uint64_t kOtherProduct = 2;
+
+base::Time Hour(int hour) {
+  return base::Time::FromTimeT(1700000000 + hour * 3600);
+}
+
+class PriceHistoryStoreTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  std::unique_ptr<PriceHistoryStore> Open() {
+    auto store = std::make_unique<PriceHistoryStore>(temp_dir_.GetPath());
+    EXPECT_TRUE(store->Init());
+    return store;
+  }
+
+  base::FilePath data_path() const {
+    return temp_dir_.GetPath().AppendASCII("PriceHistory");
+  }
+  base::FilePath index_path() const {
+    return temp_dir_.GetPath().AppendASCII("PriceHistory.index");
+  }
+
+  int64_t GetDataFileSize() const {
+    return base::GetFileSize(data_path()).value_or(-1);
+  }
+
+  static std::vector<int64_t> GetPrices(PriceHistoryStore& store,
+                                        uint64_t product) {
+    std::vector<int64_t> prices;
+    for (const PricePoint& point : store.GetPoints(product, base::Time())) {
+      prices.push_back(point.price_micros);
+    }
+    return prices;
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(PriceHistoryStoreTest, DropsOlderPointsAndRepeatedPrices) {
+  auto store = Open();
+  store->AddPoint(kProduct, Hour(1), 100);
+  store->AddPoint(kProduct, Hour(2), 100);
+  store->AddPoint(kProduct, Hour(3), 90);
+  store->AddPoint(kProduct, Hour(2), 80);
+  EXPECT_EQ((std::vector<int64_t>{100, 90}), GetPrices(*store, kProduct));
+
+  // Also against the newest point on disk.
+  store->Flush();
+  store->AddPoint(kProduct, Hour(4), 90);
+  store->AddPoint(kProduct, Hour(1), 70);
+  EXPECT_EQ((std::vector<int64_t>{100, 90}), GetPrices(*store, kProduct));
+}
+
+TEST_F(PriceHistoryStoreTest, PointsSurviveReopening) {
+  {
+    auto store = Open();
+    store->AddPoint(kProduct, Hour(1), 100);
+    store->AddPoint(kOtherProduct, Hour(1), 500);
+    store->Flush();
+    store->AddPoint(kProduct, Hour(2), 90);
+  }
+  auto store = Open();
+  EXPECT_EQ((std::vector<int64_t>{100, 90}), GetPrices(*store, kProduct));
+  EXPECT_EQ((std::vector<int64_t>{500}), GetPrices(*store, kOtherProduct));
+
+  std::vector<PricePoint> points = store->GetPoints(kProduct, Hour(2));
+  ASSERT_EQ(1u, points.size());
+  EXPECT_EQ(Hour(2), points[0].time);
+}
+
+TEST_F(PriceHistoryStoreTest, SpansSeveralBlocks) {
+  const int count =
+      static_cast<int>(price_history::kMaxPointsPerBlock) * 2 + 10;
+  {
+    auto store = Open();
+    for (int i = 0; i < count; ++i) {
+      store->AddPoint(kProduct, Hour(i), 1000 + i);
+    }
+  }
+  auto store = Open();
+  std::vector<int64_t> prices = GetPrices(*store, kProduct);
+  ASSERT_EQ(static_cast<size_t>(count), prices.size());
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(1000 + i, prices[i]);
+  }
+  EXPECT_EQ(10u, store->GetPoints(kProduct, Hour(count - 10)).size());
+}
+
+TEST_F(PriceHistoryStoreTest, TruncatesTornTrailingBlock) {
+  {
+    auto store = Open();
+    store->AddPoint(kProduct, Hour(1), 100);
+  }
+  const int64_t size = GetDataFileSize();
+
+  // A block of which only part was written before a crash, after the index
+  // was saved.
+  std::vector<uint8_t> block = price_history::EncodeBlock(
+      kProduct, sizeof(price_history::DataFileHeader),
+      std::vector<price_history::EncodedPoint>{{1700000000 + 7200, 90}});
+  block.resize(block.size() - 1);
+  ASSERT_TRUE(base::AppendToFile(data_path(), block));
+
+  {
+    auto store = Open();
+    EXPECT_EQ(size, GetDataFileSize());
+    EXPECT_EQ((std::vector<int64_t>{100}), GetPrices(*store, kProduct));
+    // Appends continue where the last complete block ends.
+    store->AddPoint(kProduct, Hour(3), 80);
+  }
+  auto store = Open();
+  EXPECT_EQ((std::vector<int64_t>{100, 80}), GetPrices(*store, kProduct));
+}
+
+#if BUILDFLAG(IS_POSIX)
+// Makes writes that would grow files past |max_size| bytes write up to there
+// and then fail, like a full disk.
+class ScopedFileSizeLimit {
+ public:
+  explicit ScopedFileSizeLimit(int64_t max_size) {
+    old_handler_ = signal(SIGXFSZ, SIG_IGN);
+    getrlimit(RLIMIT_FSIZE, &old_limit_);
+    struct rlimit limit = old_limit_;
+    limit.rlim_cur = static_cast<rlim_t>(max_size);
+    EXPECT_EQ(0, setrlimit(RLIMIT_FSIZE, &limit));
+  }
+  ScopedFileSizeLimit(const ScopedFileSizeLimit&) = delete;
+  ScopedFileSizeLimit& operator=(const ScopedFileSizeLimit&) = delete;
+  ~ScopedFileSizeLimit() {
+    setrlimit(RLIMIT_FSIZE, &old_limit_);
+    signal(SIGXFSZ, old_handler_);
+  }
+
+ private:
+  struct rlimit old_limit_;
+  void (*old_handler_)(int);
+};
+
+TEST_F(PriceHistoryStoreTest, RecoversFromPartialWrite) {
+  auto store = Open();
+  store->AddPoint(kProduct, Hour(1), 100);
+  store->Flush();
+  const int64_t size = GetDataFileSize();
+
+  {
+    ScopedFileSizeLimit limit(size + 1);
+    store->AddPoint(kProduct, Hour(2), 90);
+    store->Flush();
+  }
+  // The byte that made it out is gone, and the point with it.
+  EXPECT_EQ(size, GetDataFileSize());
+  EXPECT_EQ((std::vector<int64_t>{100}), GetPrices(*store, kProduct));
+
+  // Later blocks chain on from the last complete one.
+  store->AddPoint(kProduct, Hour(3), 80);
+  store->Flush();
+  EXPECT_EQ((std::vector<int64_t>{100, 80}), GetPrices(*store, kProduct));
+  store.reset();
+  store = Open();
+  EXPECT_EQ((std::vector<int64_t>{100, 80}), GetPrices(*store, kProduct));
+}
+#endif  // BUILDFLAG(IS_POSIX)
+
+TEST_F(PriceHistoryStoreTest, RescansWithoutIndex) {
+  {
+    auto store = Open();
+    store->AddPoint(kProduct, Hour(1), 100);
+    store->Flush();
+    store->AddPoint(kProduct, Hour(2), 90);
+  }
+  ASSERT_TRUE(base::WriteFile(index_path(), "not an index"));
+  {
+    auto store = Open();
+    EXPECT_EQ((std::vector<int64_t>{100, 90}), GetPrices(*store, kProduct));
+  }
+  ASSERT_TRUE(base::DeleteFile(index_path()));
+  auto store = Open();
+  EXPECT_EQ((std::vector<int64_t>{100, 90}), GetPrices(*store, kProduct));
+}
+
+TEST_F(PriceHistoryStoreTest, DiscardsIncompatibleDataFile) {
+  ASSERT_TRUE(base::WriteFile(data_path(), "SDPH but not version 1"));
+  auto store = Open();
+  EXPECT_TRUE(store->GetPoints(kProduct, base::Time()).empty());
+  EXPECT_EQ(static_cast<int64_t>(sizeof(price_history::DataFileHeader)),
+            GetDataFileSize());
+  store->AddPoint(kProduct, Hour(1), 100);
+  EXPECT_EQ((std::vector<int64_t>{100}), GetPrices(*store, kProduct));
+}
+
+}  // namespace
+
+}  // namespace safe_deal
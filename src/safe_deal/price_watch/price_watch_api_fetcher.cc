@@ -0,0 +1,197 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/price_watch/price_watch_api_fetcher.h"
+
+#include <stdint.h>
+
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/json/json_writer.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/values.h"
+#include "components/compression/compression_utils.h"
+#include "net/base/load_flags.h"
+#include "net/traffic_annotation/network_traffic_annotation.h"
+#include "safe_deal/api/safe_deal_api.h"
+#include "safe_deal/common/safe_deal_constants.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/cpp/shared_url_loader_factory.h"
+#include "services/network/public/cpp/simple_url_loader.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr char kBatchCheckPath[] = "v1/prices:batchCheck";
+
+// Bodies smaller than this fit in a packet or two either way.
+constexpr size_t kMinCompressedBodySize = 1024;
+
+// Only changed listings are sent back, so even a full batch is small.
+constexpr size_t kMaxResponseSize = 1024 * 1024;
+
+constexpr net::NetworkTrafficAnnotationTag kTrafficAnnotation =
+    net::DefineNetworkTrafficAnnotation("safe_deal_price_watch", R"(
+        semantics {
+          sender: "Safe Deal Price Watch"
+          description:
+            "Checks whether the price of listings on the user's watchlist "
+            "changed, so the shopping assistant can alert the user to price "
+            "drops."
+          trigger:
+            "Periodically, for the watched listings whose last check is old "
+            "enough. Checks are less frequent on battery power."
+          data:
+            "The marketplace, the public ids of the watched listings and the "
+            "prices the browser last saw for them."
+          destination: OTHER
+          destination_other: "The Safe Deal API."
+        }
+        policy {
+          cookies_allowed: NO
+          setting: "Removing all listings from the watchlist."
+          policy_exception_justification: "Not implemented."
+        })");
+
+// int64 fields are strings in the API's JSON, as in the proto3 JSON mapping.
+std::optional<PriceWatchFetcher::Results> ParseResults(
+    const base::Value& value) {
+  const base::Value::Dict* dict = value.GetIfDict();
+  if (!dict) {
+    return std::nullopt;
+  }
+  const base::Value::List* changed = dict->FindList("changed");
+  if (!changed) {
+    // Nothing changed.
+    return PriceWatchFetcher::Results();
+  }
+  std::vector<std::pair<std::string, int64_t>> results;
+  results.reserve(changed->size());
+  for (const base::Value& product : *changed) {
+    const base::Value::Dict* product_dict = product.GetIfDict();
+    const std::string* product_id =
+        product_dict ? product_dict->FindString("productId") : nullptr;
+    if (!product_id) {
+      continue;
+    }
+    int64_t price_micros = -1;
+    if (const std::string* price = product_dict->FindString("priceMicros");
+        price && !base::StringToInt64(*price, &price_micros)) {
+      continue;
+    }
+    results.emplace_back(*product_id, price_micros < 0 ? -1 : price_micros);
+  }
+  return PriceWatchFetcher::Results(std::move(results));
+}
+
+std::optional<PriceWatchFetcher::Results> ParseResults(
+    const api::fb::Response* response) {
+  const api::fb::PriceBatchCheckResponse* batch =
+      response ? response->payload_as_PriceBatchCheckResponse() : nullptr;
+  if (!batch) {
+    return std::nullopt;
+  }
+  std::vector<std::pair<std::string, int64_t>> results;
+  if (const auto* changed = batch->changed()) {
+    results.reserve(changed->size());
+    for (const api::fb::PriceChange* product : *changed) {
+      const int64_t price_micros = product->price_micros();
+      results.emplace_back(product->product_id()->str(),
+                           price_micros < 0 ? -1 : price_micros);
+    }
+  }
+  return PriceWatchFetcher::Results(std::move(results));
+}
+
+}  // namespace
+
+PriceWatchApiFetcher::PriceWatchApiFetcher(
+    scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory)
+    : url_loader_factory_(std::move(url_loader_factory)) {}
+
+PriceWatchApiFetcher::~PriceWatchApiFetcher() = default;
+
+void PriceWatchApiFetcher::Fetch(mojom::Marketplace marketplace,
+                                 std::vector<PriceCheck> checks,
+                                 FetchCallback callback) {
+  const MarketplaceInfo* info = GetMarketplaceInfo(marketplace);
+  if (!info) {
+    std::move(callback).Run(std::nullopt);
+    return;
+  }
+  base::Value::List products;
+  for (PriceCheck& check : checks) {
+    base::Value::Dict product;
+    product.Set("productId", std::move(check.product_id));
+    if (check.known_price_micros >= 0) {
+      product.Set("knownPriceMicros",
+                  base::NumberToString(check.known_price_micros));
+    }
+    products.Append(std::move(product));
+  }
+  base::Value::Dict request_body;
+  request_body.Set("marketplace", base::ToLowerASCII(info->name));
+  request_body.Set("products", std::move(products));
+  request_body.Set("changedOnly", true);
+  std::string body;
+  base::JSONWriter::Write(request_body, &body);
+
+  auto request = std::make_unique<network::ResourceRequest>();
+  request->url = GetSafeDealApiUrl(kBatchCheckPath);
+  request->method = "POST";
+  request->credentials_mode = network::mojom::CredentialsMode::kOmit;
+  request->load_flags = net::LOAD_DISABLE_CACHE;
+  request->headers.SetHeader("Accept", GetSafeDealApiAcceptHeader());
+  std::string compressed;
+  if (body.size() >= kMinCompressedBodySize &&
+      compression::GzipCompress(body, &compressed)) {
+    request->headers.SetHeader("Content-Encoding", "gzip");
+    body = std::move(compressed);
+  }
+  loaders_.push_front(network::SimpleURLLoader::Create(std::move(request),
+                                                       kTrafficAnnotation));
+  network::SimpleURLLoader* loader = loaders_.front().get();
+  loader->AttachStringForUpload(body, "application/json");
+  loader->DownloadToString(
+      url_loader_factory_.get(),
+      base::BindOnce(&PriceWatchApiFetcher::OnResponse,
+                     weak_factory_.GetWeakPtr(), loaders_.begin(),
+                     std::move(callback)),
+      kMaxResponseSize);
+}
+
+void PriceWatchApiFetcher::OnResponse(LoaderList::iterator loader,
+                                      FetchCallback callback,
+                                      std::optional<std::string> body) {
+  const network::mojom::URLResponseHead* response_info =
+      (*loader)->ResponseInfo();
+  const bool is_flatbuffer =
+      response_info &&
+      response_info->mime_type == kSafeDealApiFlatBuffersMimeType;
+  loaders_.erase(loader);
+  if (!body) {
+    std::move(callback).Run(std::nullopt);
+    return;
+  }
+  if (is_flatbuffer) {
+    std::move(callback).Run(ParseResults(GetSafeDealApiResponse(*body)));
+    return;
+  }
+  data_decoder::DataDecoder::ParseJsonIsolated(
+      *body, base::BindOnce(&PriceWatchApiFetcher::OnParsed,
+                            weak_factory_.GetWeakPtr(), std::move(callback)));
+}
+
+void PriceWatchApiFetcher::OnParsed(
+    FetchCallback callback,
+    data_decoder::DataDecoder::ValueOrError result) {
+  std::move(callback).Run(result.has_value() ? ParseResults(*result)
+                                             : std::nullopt);
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,61 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRICE_WATCH_PRICE_WATCH_API_FETCHER_H_
+#define SAFE_DEAL_PRICE_WATCH_PRICE_WATCH_API_FETCHER_H_
+
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "safe_deal/price_watch/price_watch_fetcher.h"
+#include "services/data_decoder/public/cpp/data_decoder.h"
+
+namespace network {
+class SharedURLLoaderFactory;
+class SimpleURLLoader;
+}  // namespace network
+
+namespace safe_deal {
+
+// Checks prices with the Safe Deal API's batch endpoint, asking for the
+// changed listings only. Large request bodies are gzipped. All requests go
+// to the same origin through one URL loader factory without credentials, so
+// the network service multiplexes them over a single HTTP/2 or HTTP/3
+// connection. FlatBuffers responses are read in place; JSON responses, the
+// fallback, are parsed out of process by the data decoder service.
+class PriceWatchApiFetcher : public PriceWatchFetcher {
+ public:
+  explicit PriceWatchApiFetcher(
+      scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory);
+  PriceWatchApiFetcher(const PriceWatchApiFetcher&) = delete;
+  PriceWatchApiFetcher& operator=(const PriceWatchApiFetcher&) = delete;
+  ~PriceWatchApiFetcher() override;
+
+  // PriceWatchFetcher:
+  void Fetch(mojom::Marketplace marketplace,
+             std::vector<PriceCheck> checks,
+             FetchCallback callback) override;
+
+ private:
+  using LoaderList = std::list<std::unique_ptr<network::SimpleURLLoader>>;
+
+  void OnResponse(LoaderList::iterator loader,
+                  FetchCallback callback,
+                  std::optional<std::string> body);
+  void OnParsed(FetchCallback callback,
+                data_decoder::DataDecoder::ValueOrError result);
+
+  const scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory_;
+  LoaderList loaders_;
+  base::WeakPtrFactory<PriceWatchApiFetcher> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRICE_WATCH_PRICE_WATCH_API_FETCHER_H_
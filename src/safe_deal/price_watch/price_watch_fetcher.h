@@ -0,0 +1,46 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRICE_WATCH_PRICE_WATCH_FETCHER_H_
+#define SAFE_DEAL_PRICE_WATCH_PRICE_WATCH_FETCHER_H_
+
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/functional/callback.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+
+namespace safe_deal {
+
+// A watched listing and the price the browser last saw for it.
+struct PriceCheck {
+  std::string product_id;
+  // -1 if no price is known, e.g. the listing was unavailable.
+  int64_t known_price_micros = -1;
+};
+
+// Checks the current price of several listings of one marketplace in a
+// single request.
+class PriceWatchFetcher {
+ public:
+  // Current prices by product id, -1 for listings that are no longer
+  // available. Only listings whose price differs from the known one need to
+  // be present. nullopt if the request failed.
+  using Results = base::flat_map<std::string, int64_t>;
+  using FetchCallback = base::OnceCallback<void(std::optional<Results>)>;
+
+  virtual ~PriceWatchFetcher() = default;
+
+  virtual void Fetch(mojom::Marketplace marketplace,
+                     std::vector<PriceCheck> checks,
+                     FetchCallback callback) = 0;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRICE_WATCH_PRICE_WATCH_FETCHER_H_
@@ -0,0 +1,282 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/price_watch/price_watch_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/power_monitor/power_monitor.h"
+#include "base/rand_util.h"
+#include "safe_deal/common/product_key.h"
+#include "safe_deal/price_history/price_history_service.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr size_t kMaxBatchSize = 500;
+
+constexpr base::TimeDelta kCheckInterval = base::Hours(6);
+constexpr int kBatteryIntervalMultiplier = 4;
+// Listings due within this fraction of the interval are checked early, with
+// the one that is due.
+constexpr int kCoalescingDivisor = 4;
+constexpr double kMaxJitter = 0.1;
+
+constexpr net::BackoffEntry::Policy kBackoffPolicy = {
+    .num_errors_to_ignore = 0,
+    .initial_delay_ms = 5 * 60 * 1000,
+    .multiply_factor = 2.0,
+    .jitter_factor = 0.2,
+    .maximum_backoff_ms = 6 * 60 * 60 * 1000,
+    .entry_lifetime_ms = -1,
+    .always_use_initial_delay = false,
+};
+
+double DrawJitter() {
+  return base::RandDouble() * 2 * kMaxJitter + 1 - kMaxJitter;
+}
+
+}  // namespace
+
+PriceWatchScheduler::PriceWatchScheduler(
+    std::unique_ptr<PriceWatchFetcher> fetcher,
+    PriceHistoryService* price_history,
+    StringInterner* strings)
+    : fetcher_(std::move(fetcher)),
+      price_history_(price_history),
+      strings_(strings),
+      backoff_(&kBackoffPolicy) {
+  on_battery_power_ =
+      base::PowerMonitor::GetInstance()
+          ->AddPowerStateObserverAndReturnBatteryPowerStatus(this) ==
+      base::PowerStateObserver::BatteryPowerStatus::kBatteryPower;
+}
+
+PriceWatchScheduler::~PriceWatchScheduler() {
+  base::PowerMonitor::GetInstance()->RemovePowerStateObserver(this);
+}
+
+void PriceWatchScheduler::Watch(mojom::Marketplace marketplace,
+                                std::string_view product_id,
+                                int64_t known_price_micros,
+                                base::Time last_check) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!fetcher_ || product_id.empty()) {
+    return;
+  }
+  uint64_t key = ComputeProductKeyHash(marketplace, product_id);
+  if (auto it = watched_.find(key); it != watched_.end()) {
+    it->second.known_price_micros = known_price_micros;
+    it->second.last_check = std::max(it->second.last_check, last_check);
+  } else {
+    watched_.emplace(key, WatchedProduct{marketplace,
+                                         strings_->Intern(product_id),
+                                         known_price_micros, last_check,
+                                         DrawJitter()});
+  }
+  ScheduleNextCheck();
+}
+
+void PriceWatchScheduler::Unwatch(mojom::Marketplace marketplace,
+                                  std::string_view product_id) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  auto it = watched_.find(ComputeProductKeyHash(marketplace, product_id));
+  if (it == watched_.end()) {
+    return;
+  }
+  strings_->Release(it->second.product_id);
+  watched_.erase(it);
+  ScheduleNextCheck();
+}
+
+void PriceWatchScheduler::OnPriceSeen(mojom::Marketplace marketplace,
+                                      std::string_view product_id,
+                                      int64_t price_micros) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  auto it = watched_.find(ComputeProductKeyHash(marketplace, product_id));
+  if (it == watched_.end()) {
+    return;
+  }
+  WatchedProduct& product = it->second;
+  product.last_check = base::Time::Now();
+  int64_t old_price_micros =
+      std::exchange(product.known_price_micros, price_micros);
+  ScheduleNextCheck();
+  // The page recorded the price in the history already. Copied, as observers
+  // may unwatch the listing.
+  if (old_price_micros != price_micros) {
+    NotifyPriceChanged(marketplace, std::string(product_id), old_price_micros,
+                       price_micros);
+  }
+}
+
+void PriceWatchScheduler::AddObserver(Observer* observer) {
+  observers_.AddObserver(observer);
+}
+
+void PriceWatchScheduler::RemoveObserver(Observer* observer) {
+  observers_.RemoveObserver(observer);
+}
+
+void PriceWatchScheduler::Shutdown() {
+  check_timer_.Stop();
+  // Drops the requests in flight.
+  fetcher_.reset();
+  price_history_ = nullptr;
+  for (const auto& [key, product] : watched_) {
+    strings_->Release(product.product_id);
+  }
+  watched_.clear();
+}
+
+void PriceWatchScheduler::OnBatteryPowerStatusChange(
+    base::PowerStateObserver::BatteryPowerStatus battery_power_status) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  on_battery_power_ =
+      battery_power_status ==
+      base::PowerStateObserver::BatteryPowerStatus::kBatteryPower;
+  ScheduleNextCheck();
+}
+
+base::TimeDelta PriceWatchScheduler::GetCheckInterval() const {
+  return on_battery_power_ ? kCheckInterval * kBatteryIntervalMultiplier
+                           : kCheckInterval;
+}
+
+base::Time PriceWatchScheduler::GetDueTime(
+    const WatchedProduct& product) const {
+  return product.last_check + GetCheckInterval() * product.jitter;
+}
+
+void PriceWatchScheduler::ScheduleNextCheck() {
+  std::optional<base::Time> next_check;
+  for (const auto& [key, product] : watched_) {
+    if (!product.in_flight) {
+      next_check = std::min(next_check.value_or(base::Time::Max()),
+                            GetDueTime(product));
+    }
+  }
+  if (!next_check) {
+    check_timer_.Stop();
+    return;
+  }
+  next_check = std::max(*next_check,
+                        base::Time::Now() + backoff_.GetTimeUntilRelease());
+  if (check_timer_.IsRunning() &&
+      check_timer_.desired_run_time() == *next_check) {
+    return;
+  }
+  check_timer_.Start(FROM_HERE, *next_check,
+                     base::BindOnce(&PriceWatchScheduler::CheckDueProducts,
+                                    base::Unretained(this)));
+}
+
+void PriceWatchScheduler::CheckDueProducts() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  const base::Time horizon =
+      base::Time::Now() + GetCheckInterval() / kCoalescingDivisor;
+  base::flat_map<mojom::Marketplace,
+                 std::pair<std::vector<uint64_t>, std::vector<PriceCheck>>>
+      batches;
+  for (auto& [key, product] : watched_) {
+    if (product.in_flight || GetDueTime(product) > horizon) {
+      continue;
+    }
+    auto& [keys, checks] = batches[product.marketplace];
+    keys.push_back(key);
+    checks.push_back({std::string(strings_->Get(product.product_id)),
+                      product.known_price_micros});
+    product.in_flight = true;
+  }
+
+  // Sent back to back, so that the batches share one connection.
+  for (auto& [marketplace, batch] : batches) {
+    auto& [keys, checks] = batch;
+    for (size_t begin = 0; begin < checks.size(); begin += kMaxBatchSize) {
+      size_t end = std::min(begin + kMaxBatchSize, checks.size());
+      base::UmaHistogramCounts1000("SafeDeal.PriceWatch.BatchSize",
+                                   end - begin);
+      fetcher_->Fetch(
+          marketplace,
+          std::vector<PriceCheck>(checks.begin() + begin,
+                                  checks.begin() + end),
+          base::BindOnce(&PriceWatchScheduler::OnChecked,
+                         weak_factory_.GetWeakPtr(), marketplace,
+                         std::vector<uint64_t>(keys.begin() + begin,
+                                               keys.begin() + end)));
+    }
+  }
+  ScheduleNextCheck();
+}
+
+void PriceWatchScheduler::OnChecked(
+    mojom::Marketplace marketplace,
+    std::vector<uint64_t> keys,
+    std::optional<PriceWatchFetcher::Results> results) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::UmaHistogramBoolean("SafeDeal.PriceWatch.CheckSucceeded",
+                            results.has_value());
+  backoff_.InformOfRequest(results.has_value());
+  struct Change {
+    std::string product_id;
+    int64_t old_price_micros;
+    int64_t new_price_micros;
+  };
+  std::vector<Change> changes;
+  const base::Time now = base::Time::Now();
+  for (uint64_t key : keys) {
+    auto it = watched_.find(key);
+    if (it == watched_.end()) {
+      // Unwatched while in flight.
+      continue;
+    }
+    WatchedProduct& product = it->second;
+    product.in_flight = false;
+    if (!results) {
+      // Due again once the backoff expires.
+      continue;
+    }
+    product.last_check = now;
+    product.jitter = DrawJitter();
+    const std::string_view product_id = strings_->Get(product.product_id);
+    auto result = results->find(product_id);
+    if (result == results->end() ||
+        result->second == product.known_price_micros) {
+      continue;
+    }
+    changes.push_back({std::string(product_id), product.known_price_micros,
+                       result->second});
+    product.known_price_micros = result->second;
+    if (price_history_ && result->second >= 0) {
+      price_history_->RecordPrice(marketplace, product_id, now,
+                                  result->second);
+    }
+  }
+  if (results) {
+    base::UmaHistogramCounts1000("SafeDeal.PriceWatch.ChangedCount",
+                                 changes.size());
+  }
+  // Observers may change the watchlist, so they are told last.
+  for (const Change& change : changes) {
+    NotifyPriceChanged(marketplace, change.product_id, change.old_price_micros,
+                       change.new_price_micros);
+  }
+  ScheduleNextCheck();
+}
+
+void PriceWatchScheduler::NotifyPriceChanged(mojom::Marketplace marketplace,
+                                             const std::string& product_id,
+                                             int64_t old_price_micros,
+                                             int64_t new_price_micros) {
+  for (Observer& observer : observers_) {
+    observer.OnPriceChanged(marketplace, product_id, old_price_micros,
+                            new_price_micros);
+  }
+}
+
+}  // namespace safe_deal
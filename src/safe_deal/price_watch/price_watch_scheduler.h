@@ -0,0 +1,138 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRICE_WATCH_PRICE_WATCH_SCHEDULER_H_
+#define SAFE_DEAL_PRICE_WATCH_PRICE_WATCH_SCHEDULER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/memory/raw_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/observer_list.h"
+#include "base/observer_list_types.h"
+#include "base/power_monitor/power_observer.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+#include "base/timer/wall_clock_timer.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "net/base/backoff_entry.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/common/string_interner.h"
+#include "safe_deal/price_watch/price_watch_fetcher.h"
+
+namespace safe_deal {
+
+class PriceHistoryService;
+
+// Checks the prices of the listings on the profile's watchlist. Every
+// listing is due a few hours after its last check, with some jitter so that
+// listings added together drift apart. When the first one is due, every
+// listing due within the next quarter interval is checked along with it, in
+// one request per marketplace, so that a watchlist of hundreds of listings
+// costs a handful of wakeups a day. On battery power the interval is four
+// times longer. Listings seen on a product page count as checked.
+//
+// New prices are recorded in PriceHistoryService and reported to observers.
+// The watchlist itself is kept by the caller, which adds the listings again
+// at startup. Product ids are kept in the profile's StringInterner. UI thread
+// only.
+class PriceWatchScheduler : public KeyedService,
+                            public base::PowerStateObserver {
+ public:
+  class Observer : public base::CheckedObserver {
+   public:
+    // |old_price_micros| or |new_price_micros| is -1 if the listing was or
+    // became unavailable.
+    virtual void OnPriceChanged(mojom::Marketplace marketplace,
+                                const std::string& product_id,
+                                int64_t old_price_micros,
+                                int64_t new_price_micros) = 0;
+  };
+
+  // |strings| must outlive the scheduler.
+  PriceWatchScheduler(std::unique_ptr<PriceWatchFetcher> fetcher,
+                      PriceHistoryService* price_history,
+                      StringInterner* strings);
+  PriceWatchScheduler(const PriceWatchScheduler&) = delete;
+  PriceWatchScheduler& operator=(const PriceWatchScheduler&) = delete;
+  ~PriceWatchScheduler() override;
+
+  // Starts watching the listing, whose price was |known_price_micros| at
+  // |last_check|. A listing that is already watched is updated.
+  void Watch(mojom::Marketplace marketplace,
+             std::string_view product_id,
+             int64_t known_price_micros,
+             base::Time last_check);
+  void Unwatch(mojom::Marketplace marketplace, std::string_view product_id);
+
+  // Reports the price shown on the listing's page. Postpones its next check
+  // if the listing is watched.
+  void OnPriceSeen(mojom::Marketplace marketplace,
+                   std::string_view product_id,
+                   int64_t price_micros);
+
+  size_t watched_count() const { return watched_.size(); }
+
+  void AddObserver(Observer* observer);
+  void RemoveObserver(Observer* observer);
+
+  // KeyedService:
+  void Shutdown() override;
+
+  // base::PowerStateObserver:
+  void OnBatteryPowerStatusChange(
+      base::PowerStateObserver::BatteryPowerStatus battery_power_status)
+      override;
+
+ private:
+  struct WatchedProduct {
+    mojom::Marketplace marketplace;
+    // Holds a reference.
+    InternedStringId product_id;
+    int64_t known_price_micros;
+    base::Time last_check;
+    // Scales the check interval of this listing, redrawn after each check.
+    double jitter;
+    bool in_flight = false;
+  };
+
+  base::TimeDelta GetCheckInterval() const;
+  base::Time GetDueTime(const WatchedProduct& product) const;
+  void ScheduleNextCheck();
+  void CheckDueProducts();
+  void OnChecked(mojom::Marketplace marketplace,
+                 std::vector<uint64_t> keys,
+                 std::optional<PriceWatchFetcher::Results> results);
+  void NotifyPriceChanged(mojom::Marketplace marketplace,
+                          const std::string& product_id,
+                          int64_t old_price_micros,
+                          int64_t new_price_micros);
+
+  std::unique_ptr<PriceWatchFetcher> fetcher_;
+  raw_ptr<PriceHistoryService> price_history_;
+  const raw_ptr<StringInterner> strings_;
+  base::flat_map<uint64_t, WatchedProduct> watched_;
+  bool on_battery_power_ = false;
+  // Delays all checks after failed requests.
+  net::BackoffEntry backoff_;
+  // Runs at the wall clock time the next listing is due, also after the
+  // device slept through it.
+  base::WallClockTimer check_timer_;
+  base::ObserverList<Observer> observers_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+  base::WeakPtrFactory<PriceWatchScheduler> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRICE_WATCH_PRICE_WATCH_SCHEDULER_H_
@@ -0,0 +1,98 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/product_cache/browser/product_cache.h"
+
+#include <iterator>
+#include <optional>
+
+#include "base/trace_event/trace_event.h"
+
+namespace safe_deal {
+
+ProductCache::ProductCache()
+    : keys_(base::HashingLRUCacheSet<uint64_t>::NO_AUTO_EVICT),
+      table_(kProductTableCapacity) {}
+
+ProductCache::~ProductCache() = default;
+
+void ProductCache::Put(mojom::Marketplace marketplace,
+                       std::string_view product_id,
+                       const ProductRecord& record) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  TRACE_EVENT("safe_deal", "ProductCache::Put");
+  if (!table_.IsValid()) {
+    return;
+  }
+  uint64_t key = ComputeProductTableKey(marketplace, product_id);
+  ProductRecord updated = record;
+  if (std::optional<ProductRecord> existing = table_.Find(key)) {
+    updated.reviews_scored = existing->reviews_scored;
+    updated.likely_fake_reviews = existing->likely_fake_reviews;
+    updated.review_verdict_complete = existing->review_verdict_complete;
+    updated.lowest_recent_price_micros = existing->lowest_recent_price_micros;
+    updated.cheapest_match_price_micros =
+        existing->cheapest_match_price_micros;
+    updated.cheapest_match_marketplace = existing->cheapest_match_marketplace;
+  }
+  Insert(key, updated);
+}
+
+void ProductCache::SetReviewVerdict(mojom::Marketplace marketplace,
+                                    std::string_view product_id,
+                                    uint16_t reviews_scored,
+                                    uint16_t likely_fake_reviews,
+                                    bool complete) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!table_.IsValid()) {
+    return;
+  }
+  uint64_t key = ComputeProductTableKey(marketplace, product_id);
+  ProductRecord record = table_.Find(key).value_or(ProductRecord());
+  record.reviews_scored = reviews_scored;
+  record.likely_fake_reviews = likely_fake_reviews;
+  record.review_verdict_complete = complete;
+  Insert(key, record);
+}
+
+void ProductCache::SetPriceComparison(
+    mojom::Marketplace marketplace,
+    std::string_view product_id,
+    int64_t lowest_recent_price_micros,
+    mojom::Marketplace cheapest_match_marketplace,
+    int64_t cheapest_match_price_micros) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!table_.IsValid()) {
+    return;
+  }
+  uint64_t key = ComputeProductTableKey(marketplace, product_id);
+  ProductRecord record = table_.Find(key).value_or(ProductRecord());
+  record.lowest_recent_price_micros = lowest_recent_price_micros;
+  record.cheapest_match_price_micros = cheapest_match_price_micros;
+  record.cheapest_match_marketplace =
+      static_cast<uint8_t>(cheapest_match_marketplace);
+  Insert(key, record);
+}
+
+base::ReadOnlySharedMemoryRegion ProductCache::DuplicateTableRegion() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return table_.DuplicateReadOnlyRegion();
+}
+
+void ProductCache::Insert(uint64_t key, const ProductRecord& record) {
+  keys_.Put(key);
+  // The table refuses inserts once it is three quarters full. |key| is the
+  // most recent entry, so it is never the one evicted.
+  while (!table_.Insert(key, record) && keys_.size() > 1) {
+    EvictOldest();
+  }
+}
+
+void ProductCache::EvictOldest() {
+  auto oldest = std::prev(keys_.end());
+  table_.Remove(*oldest);
+  keys_.Erase(oldest);
+}
+
+}  // namespace safe_deal
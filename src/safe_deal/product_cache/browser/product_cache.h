@@ -0,0 +1,80 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRODUCT_CACHE_BROWSER_PRODUCT_CACHE_H_
+#define SAFE_DEAL_PRODUCT_CACHE_BROWSER_PRODUCT_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+#include "base/containers/lru_cache.h"
+#include "base/memory/read_only_shared_memory_region.h"
+#include "base/sequence_checker.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/common/shared_hash_table.h"
+#include "safe_deal/product_cache/common/product_record.h"
+
+namespace safe_deal {
+
+// Per-profile table of the listings the profile has seen, in read-only
+// shared memory that renderers of the profile map. Content scripts read it
+// through ProductTableBindings instead of asking the extension background
+// for product data the browser already has. Least recently updated listings
+// are evicted once the table is full. UI thread only.
+class ProductCache : public KeyedService {
+ public:
+  ProductCache();
+  ProductCache(const ProductCache&) = delete;
+  ProductCache& operator=(const ProductCache&) = delete;
+  ~ProductCache() override;
+
+  // Inserts or replaces the record of the listing. The review verdict and
+  // price comparison of a listing already in the table are kept.
+  void Put(mojom::Marketplace marketplace,
+           std::string_view product_id,
+           const ProductRecord& record);
+
+  // Sets the review verdict fields of the listing's record, adding an
+  // otherwise empty record if the listing is not in the table.
+  void SetReviewVerdict(mojom::Marketplace marketplace,
+                        std::string_view product_id,
+                        uint16_t reviews_scored,
+                        uint16_t likely_fake_reviews,
+                        bool complete);
+
+  // Sets the price comparison fields of the listing's record, adding an
+  // otherwise empty record if the listing is not in the table.
+  void SetPriceComparison(mojom::Marketplace marketplace,
+                          std::string_view product_id,
+                          int64_t lowest_recent_price_micros,
+                          mojom::Marketplace cheapest_match_marketplace,
+                          int64_t cheapest_match_price_micros);
+
+  // Returns a handle to the table renderers read, or an invalid region if
+  // shared memory could not be allocated.
+  base::ReadOnlySharedMemoryRegion DuplicateTableRegion() const;
+
+  size_t size() const { return table_.size(); }
+
+  // Size of the shared memory table, mapped by every renderer of the
+  // profile.
+  size_t table_size() const { return table_.region_size(); }
+
+ private:
+  void Insert(uint64_t key, const ProductRecord& record);
+  void EvictOldest();
+
+  // Keys of the listings in the table, most recently updated first.
+  base::HashingLRUCacheSet<uint64_t> keys_;
+  SharedHashTableWriter<ProductRecord> table_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRODUCT_CACHE_BROWSER_PRODUCT_CACHE_H_
@@ -0,0 +1,65 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRODUCT_CACHE_COMMON_PRODUCT_RECORD_H_
+#define SAFE_DEAL_PRODUCT_CACHE_COMMON_PRODUCT_RECORD_H_
+
+#include <stdint.h>
+
+#include <string_view>
+
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/common/product_key.h"
+
+namespace safe_deal {
+
+// Metadata of one listing the browser has seen, as extracted from its
+// product page and kept current by price checks. Stored as is in the shared
+// memory table read by renderers, so it must stay trivially copyable and a
+// multiple of 8 bytes.
+struct ProductRecord {
+  // Price in millionths of a currency unit, or -1 if unknown.
+  int64_t price_micros = -1;
+  // Seconds since the Unix epoch when the price was last seen.
+  int64_t price_time = 0;
+  // Lowest price in the listing's recent price history, or -1 if unknown.
+  int64_t lowest_recent_price_micros = -1;
+  // Lowest price of the same item on another marketplace, in the same
+  // currency, or -1 if none is known.
+  int64_t cheapest_match_price_micros = -1;
+  // ComputeSellerKeyHash() of the seller, or 0 if unknown.
+  uint64_t seller_key = 0;
+  uint32_t review_count = 0;
+  // Average rating multiplied by 100, e.g. 4.5 stars is 450.
+  uint16_t rating_x100 = 0;
+  // Reviews of the listing the review scorer has scored, and how many of
+  // them are likely fake. Grows while the review pages stream in.
+  uint16_t reviews_scored = 0;
+  uint16_t likely_fake_reviews = 0;
+  // ISO 4217 code, not NUL terminated; all zero if unknown.
+  char currency_code[3] = {};
+  // Whether every review page that was fetched has been scored.
+  bool review_verdict_complete = false;
+  // mojom::Marketplace of the listing |cheapest_match_price_micros| is from.
+  uint8_t cheapest_match_marketplace = 0;
+  uint8_t reserved = 0;
+};
+
+static_assert(sizeof(ProductRecord) == 56);
+
+// Records in the shared table; a power of two. Also bounds the number of
+// products cached in the browser.
+inline constexpr uint32_t kProductTableCapacity = 8192;
+
+// Key of the listing in the shared table. Shared hash tables reserve 0 for
+// empty slots.
+inline uint64_t ComputeProductTableKey(mojom::Marketplace marketplace,
+                                       std::string_view product_id) {
+  uint64_t key = ComputeProductKeyHash(marketplace, product_id);
+  return key ? key : 1;
+}
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRODUCT_CACHE_COMMON_PRODUCT_RECORD_H_
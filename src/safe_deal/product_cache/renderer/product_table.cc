@@ -0,0 +1,40 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/product_cache/renderer/product_table.h"
+
+#include <utility>
+
+namespace safe_deal {
+
+// static
+ProductTable& ProductTable::GetInstance() {
+  static base::NoDestructor<ProductTable> instance;
+  return *instance;
+}
+
+ProductTable::ProductTable() = default;
+ProductTable::~ProductTable() = default;
+
+void ProductTable::SetRegion(base::ReadOnlySharedMemoryRegion region) {
+  std::optional<SharedHashTableReader<ProductRecord>> reader =
+      SharedHashTableReader<ProductRecord>::Create(std::move(region));
+  base::AutoLock lock(lock_);
+  reader_ = std::move(reader);
+}
+
+std::optional<ProductRecord> ProductTable::Find(
+    mojom::Marketplace marketplace,
+    std::string_view product_id) const {
+  uint64_t key = ComputeProductTableKey(marketplace, product_id);
+  // Readers never block the browser; the lock only guards against the table
+  // being replaced.
+  base::AutoLock lock(lock_);
+  if (!reader_) {
+    return std::nullopt;
+  }
+  return reader_->Find(key);
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,52 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRODUCT_CACHE_RENDERER_PRODUCT_TABLE_H_
+#define SAFE_DEAL_PRODUCT_CACHE_RENDERER_PRODUCT_TABLE_H_
+
+#include <optional>
+#include <string_view>
+
+#include "base/memory/read_only_shared_memory_region.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/common/shared_hash_table.h"
+#include "safe_deal/product_cache/common/product_record.h"
+
+namespace safe_deal {
+
+// Read-only view of the product cache of the profile the render process
+// belongs to. A miss means the profile has not seen the listing, or has
+// evicted it.
+class ProductTable {
+ public:
+  static ProductTable& GetInstance();
+
+  ProductTable(const ProductTable&) = delete;
+  ProductTable& operator=(const ProductTable&) = delete;
+
+  // Maps |region|, replacing the current table.
+  void SetRegion(base::ReadOnlySharedMemoryRegion region);
+
+  // Returns nullopt if the listing is not in the table or no table has been
+  // received.
+  std::optional<ProductRecord> Find(mojom::Marketplace marketplace,
+                                    std::string_view product_id) const;
+
+ private:
+  friend class base::NoDestructor<ProductTable>;
+
+  ProductTable();
+  ~ProductTable();
+
+  mutable base::Lock lock_;
+  std::optional<SharedHashTableReader<ProductRecord>> reader_
+      GUARDED_BY(lock_);
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRODUCT_CACHE_RENDERER_PRODUCT_TABLE_H_
@@ -0,0 +1,175 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/product_cache/renderer/product_table_bindings.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "content/public/common/isolated_world_ids.h"
+#include "content/public/renderer/render_frame.h"
+#include "extensions/common/extension.h"
+#include "extensions/common/mojom/context_type.mojom.h"
+#include "extensions/common/mojom/manifest.mojom-shared.h"
+#include "extensions/renderer/script_context.h"
+#include "extensions/renderer/script_context_set.h"
+#include "gin/arguments.h"
+#include "gin/data_object_builder.h"
+#include "gin/handle.h"
+#include "gin/object_template_builder.h"
+#include "gin/wrappable.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/common/safe_deal_constants.h"
+#include "safe_deal/product_cache/common/product_record.h"
+#include "safe_deal/product_cache/renderer/product_table.h"
+#include "third_party/blink/public/web/web_document.h"
+#include "third_party/blink/public/web/web_local_frame.h"
+#include "url/gurl.h"
+#include "v8/include/v8-context.h"
+#include "v8/include/v8-object.h"
+#include "v8/include/v8-primitive.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr char kGlobalName[] = "safeDealProducts";
+
+// The code fills all three characters, so it is not NUL terminated unless
+// unknown.
+std::string GetCurrencyCode(const ProductRecord& record) {
+  std::string_view code(record.currency_code, sizeof(record.currency_code));
+  return std::string(code.substr(0, code.find('\0')));
+}
+
+v8::Local<v8::Value> GetPrice(v8::Isolate* isolate, int64_t price_micros) {
+  return price_micros >= 0 ? v8::Number::New(isolate, price_micros / 1e6)
+                           : v8::Null(isolate).As<v8::Value>();
+}
+
+// The |safeDealProducts| object of one script context.
+class ProductTableObject : public gin::Wrappable<ProductTableObject> {
+ public:
+  static gin::WrapperInfo kWrapperInfo;
+
+  explicit ProductTableObject(mojom::Marketplace marketplace)
+      : marketplace_(marketplace) {}
+  ProductTableObject(const ProductTableObject&) = delete;
+  ProductTableObject& operator=(const ProductTableObject&) = delete;
+
+  // gin::Wrappable:
+  gin::ObjectTemplateBuilder GetObjectTemplateBuilder(
+      v8::Isolate* isolate) override {
+    return gin::Wrappable<ProductTableObject>::GetObjectTemplateBuilder(
+               isolate)
+        .SetMethod("get", &ProductTableObject::Get);
+  }
+
+ private:
+  ~ProductTableObject() override = default;
+
+  v8::Local<v8::Value> Get(gin::Arguments* args) {
+    v8::Isolate* isolate = args->isolate();
+    std::string product_id;
+    if (!args->GetNext(&product_id)) {
+      args->ThrowTypeError("productId must be a string");
+      return v8::Null(isolate);
+    }
+    std::optional<ProductRecord> record =
+        ProductTable::GetInstance().Find(marketplace_, product_id);
+    if (!record) {
+      return v8::Null(isolate);
+    }
+    v8::Local<v8::Value> review_verdict = v8::Null(isolate);
+    if (record->reviews_scored || record->review_verdict_complete) {
+      review_verdict = gin::DataObjectBuilder(isolate)
+                           .Set("scored", uint32_t{record->reviews_scored})
+                           .Set("likelyFake",
+                                uint32_t{record->likely_fake_reviews})
+                           .Set("complete", record->review_verdict_complete)
+                           .Build();
+    }
+    v8::Local<v8::Value> cheapest_elsewhere = v8::Null(isolate);
+    const MarketplaceInfo* match_marketplace = GetMarketplaceInfo(
+        static_cast<mojom::Marketplace>(record->cheapest_match_marketplace));
+    if (match_marketplace && record->cheapest_match_price_micros >= 0) {
+      cheapest_elsewhere =
+          gin::DataObjectBuilder(isolate)
+              .Set("marketplace", std::string(match_marketplace->name))
+              .Set("price",
+                   GetPrice(isolate, record->cheapest_match_price_micros))
+              .Build();
+    }
+    return gin::DataObjectBuilder(isolate)
+        .Set("price", GetPrice(isolate, record->price_micros))
+        .Set("currencyCode", GetCurrencyCode(*record))
+        .Set("priceTime", record->price_time * 1000.0)
+        .Set("rating", record->rating_x100 / 100.0)
+        .Set("reviewCount", record->review_count)
+        .Set("reviewVerdict", review_verdict)
+        .Set("lowestRecentPrice",
+             GetPrice(isolate, record->lowest_recent_price_micros))
+        .Set("cheapestElsewhere", cheapest_elsewhere)
+        .Build();
+  }
+
+  const mojom::Marketplace marketplace_;
+};
+
+gin::WrapperInfo ProductTableObject::kWrapperInfo = {gin::kEmbedderNativeGin};
+
+bool IsComponentContentScript(v8::Local<v8::Context> v8_context) {
+  extensions::ScriptContext* context =
+      extensions::ScriptContextSet::GetContextByV8Context(v8_context);
+  return context &&
+         context->context_type() ==
+             extensions::mojom::ContextType::kContentScript &&
+         context->extension() &&
+         context->extension()->location() ==
+             extensions::mojom::ManifestLocation::kComponent;
+}
+
+}  // namespace
+
+ProductTableBindings::ProductTableBindings(content::RenderFrame* render_frame)
+    : content::RenderFrameObserver(render_frame) {}
+
+ProductTableBindings::~ProductTableBindings() = default;
+
+void ProductTableBindings::DidCreateScriptContext(
+    v8::Local<v8::Context> v8_context,
+    int32_t world_id) {
+  // Content scripts run in isolated worlds; the page never gets the object.
+  if (world_id == content::ISOLATED_WORLD_ID_GLOBAL ||
+      !IsComponentContentScript(v8_context)) {
+    return;
+  }
+  GURL url = render_frame()->GetWebFrame()->GetDocument().Url();
+  if (!url.SchemeIs(url::kHttpsScheme)) {
+    return;
+  }
+  mojom::Marketplace marketplace = GetMarketplaceForHost(url.host_piece());
+  if (marketplace == mojom::Marketplace::kUnknown) {
+    return;
+  }
+
+  v8::Isolate* isolate = v8_context->GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(v8_context);
+  gin::Handle<ProductTableObject> object =
+      gin::CreateHandle(isolate, new ProductTableObject(marketplace));
+  if (object.IsEmpty()) {
+    return;
+  }
+  v8_context->Global()
+      ->Set(v8_context, gin::StringToV8(isolate, kGlobalName), object.ToV8())
+      .Check();
+}
+
+void ProductTableBindings::OnDestruct() {
+  delete this;
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,51 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRODUCT_CACHE_RENDERER_PRODUCT_TABLE_BINDINGS_H_
+#define SAFE_DEAL_PRODUCT_CACHE_RENDERER_PRODUCT_TABLE_BINDINGS_H_
+
+#include <stdint.h>
+
+#include "content/public/renderer/render_frame_observer.h"
+#include "v8/include/v8-forward.h"
+
+namespace safe_deal {
+
+// Exposes ProductTable to the content scripts of component extensions on
+// marketplace pages, as a global in their isolated world:
+//
+//   safeDealProducts.get(productId)
+//
+// returns {price, currencyCode, priceTime, rating, reviewCount,
+// reviewVerdict, lowestRecentPrice, cheapestElsewhere} for a listing of the
+// page's marketplace, or null if the profile has not seen it. |price| and
+// |lowestRecentPrice| are in currency units, or null if unknown, and
+// |priceTime| is in milliseconds since the Unix epoch. |reviewVerdict| is
+// {scored, likelyFake, complete}, or null before the first reviews are
+// scored; it grows while the listing's review pages stream in, so content
+// scripts can show a verdict early and refine it. |cheapestElsewhere| is
+// {marketplace, price} of the cheapest listing of the same item found on
+// another marketplace, or null. Lookups read shared memory
+// synchronously, so content scripts need no message round trip to the
+// extension background for product data the browser already has.
+//
+// Must be created after the extension system's frame observers, which
+// create the script contexts this checks. Owns itself and is destroyed with
+// the RenderFrame.
+class ProductTableBindings : public content::RenderFrameObserver {
+ public:
+  explicit ProductTableBindings(content::RenderFrame* render_frame);
+  ProductTableBindings(const ProductTableBindings&) = delete;
+  ProductTableBindings& operator=(const ProductTableBindings&) = delete;
+  ~ProductTableBindings() override;
+
+  // content::RenderFrameObserver:
+  void DidCreateScriptContext(v8::Local<v8::Context> context,
+                              int32_t world_id) override;
+  void OnDestruct() override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRODUCT_CACHE_RENDERER_PRODUCT_TABLE_BINDINGS_H_
@@ -0,0 +1,156 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/product_matching/product_fingerprint.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "base/check_op.h"
+#include "base/containers/fixed_flat_set.h"
+#include "base/containers/flat_set.h"
+#include "base/hash/hash.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_util.h"
+
+namespace safe_deal::product_matching {
+
+namespace {
+
+// Titles with fewer words match too many other products.
+constexpr size_t kMinWords = 3;
+
+// Words in most titles, or that sellers add to any listing.
+constexpr auto kStopWords = base::MakeFixedFlatSet<std::string_view>({
+    "a",    "an",   "and",  "best",     "by",  "for", "free",
+    "hot",  "in",   "new",  "of",       "on",  "or",  "sale",
+    "the",  "to",   "with", "shipping", "pcs", "pc",  "set",
+});
+
+// Units that follow a number, as in "128 GB" or "6.1 in".
+constexpr auto kUnits = base::MakeFixedFlatSet<std::string_view>({
+    "cm", "ft", "g",  "gb", "ghz", "hz", "in", "inch", "kg", "l",  "lb",
+    "m",  "mah", "mb", "ml", "mm", "oz", "pack", "tb",  "v",  "w",
+});
+
+// Salts that keep the kinds of features apart.
+enum FeatureKind : uint64_t {
+  kWord = 1,
+  kWordPair = 2,
+  kAttribute = 3,
+};
+
+bool IsNumber(std::string_view word) {
+  return !word.empty() && base::IsAsciiDigit(word.front()) &&
+         std::ranges::all_of(word, [](char c) {
+           return base::IsAsciiDigit(c) || c == '.' || c == ',';
+         });
+}
+
+bool IsAttribute(std::string_view word) {
+  return std::ranges::any_of(word, base::IsAsciiDigit<char>);
+}
+
+// SplitMix64 finalizer, for independent hash functions from one feature
+// hash.
+uint64_t Mix(uint64_t value) {
+  value += 0x9e3779b97f4a7c15ull;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+uint64_t HashFeature(FeatureKind kind, std::string_view feature) {
+  return Mix((uint64_t{base::PersistentHash(feature)} << 8) | kind);
+}
+
+}  // namespace
+
+std::vector<std::string> NormalizeTitle(std::string_view title) {
+  // Split on ASCII punctuation and space. Other scripts are kept whole; their
+  // words are still separated by spaces on every supported marketplace.
+  std::vector<std::string> tokens;
+  std::string token;
+  for (size_t i = 0; i <= title.size(); ++i) {
+    const char c = i < title.size() ? title[i] : ' ';
+    const bool decimal_point = (c == '.' || c == ',') && !token.empty() &&
+                               base::IsAsciiDigit(token.back()) &&
+                               i + 1 < title.size() &&
+                               base::IsAsciiDigit(title[i + 1]);
+    if (base::IsAsciiAlphaNumeric(c) || static_cast<unsigned char>(c) >= 0x80 ||
+        decimal_point) {
+      token.push_back(base::ToLowerASCII(c));
+      continue;
+    }
+    if (!token.empty()) {
+      tokens.push_back(std::move(token));
+      token.clear();
+    }
+  }
+
+  std::vector<std::string> words;
+  words.reserve(tokens.size());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (IsNumber(tokens[i]) && i + 1 < tokens.size() &&
+        kUnits.contains(tokens[i + 1])) {
+      words.push_back(tokens[i] + tokens[i + 1]);
+      ++i;
+      continue;
+    }
+    if (!kStopWords.contains(tokens[i])) {
+      words.push_back(std::move(tokens[i]));
+    }
+  }
+  return words;
+}
+
+std::optional<Signature> ComputeSignature(std::string_view title) {
+  std::vector<std::string> words = NormalizeTitle(title);
+  if (words.size() < kMinWords) {
+    return std::nullopt;
+  }
+  std::vector<uint64_t> features;
+  features.reserve(words.size() * 3);
+  for (size_t i = 0; i < words.size(); ++i) {
+    features.push_back(HashFeature(kWord, words[i]));
+    if (i + 1 < words.size()) {
+      features.push_back(
+          HashFeature(kWordPair, base::StrCat({words[i], " ", words[i + 1]})));
+    }
+    if (IsAttribute(words[i])) {
+      features.push_back(HashFeature(kAttribute, words[i]));
+    }
+  }
+  base::flat_set<uint64_t> unique_features(std::move(features));
+
+  Signature signature;
+  for (size_t i = 0; i < kSignatureSize; ++i) {
+    uint64_t min_hash = std::numeric_limits<uint64_t>::max();
+    for (uint64_t feature : unique_features) {
+      min_hash = std::min(min_hash, Mix(feature ^ (i * 0xd6e8feb86659fd93ull)));
+    }
+    signature[i] = static_cast<uint16_t>(min_hash);
+  }
+  return signature;
+}
+
+uint32_t GetBandKey(const Signature& signature, size_t band) {
+  DCHECK_LT(band, kBandCount);
+  uint64_t value = band;
+  for (size_t row = 0; row < kRowsPerBand; ++row) {
+    value = (value << 16) | signature[band * kRowsPerBand + row];
+  }
+  const uint32_t key = static_cast<uint32_t>(Mix(value) >> 32);
+  return key ? key : 1;
+}
+
+double EstimateSimilarity(const Signature& a, const Signature& b) {
+  size_t equal = 0;
+  for (size_t i = 0; i < kSignatureSize; ++i) {
+    equal += a[i] == b[i];
+  }
+  return static_cast<double>(equal) / kSignatureSize;
+}
+
+}  // namespace safe_deal::product_matching
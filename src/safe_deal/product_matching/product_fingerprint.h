@@ -0,0 +1,62 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_FINGERPRINT_H_
+#define SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_FINGERPRINT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// MinHash fingerprints of product titles, so that listings of the same item
+// on different marketplaces can be found by locality sensitive hashing.
+//
+// A title is lowercased and split into words. Numbers are joined with the
+// unit that follows them ("128 GB" becomes "128gb"), and words with digits,
+// typically capacities, sizes and model numbers, are attribute keys. The
+// features of a title are its words, its adjacent word pairs, and its
+// attribute keys once more, so that two listings that share the model number
+// but differ in wording still match while "128gb" and "256gb" variants of a
+// phone are told apart.
+//
+// Fingerprints are stored on disk; the algorithm must not change without
+// bumping product_matching::kFormatVersion.
+namespace safe_deal::product_matching {
+
+// Number of MinHash values per fingerprint. Only the low 16 bits of each are
+// kept, which is enough to estimate similarity between titles.
+inline constexpr size_t kSignatureSize = 60;
+
+// The signature is split into bands of kRowsPerBand values. Two titles are
+// candidates if all values of one band agree, which for 20 bands of 3 rows
+// happens to titles with a Jaccard similarity of 0.5 nine times in ten, and
+// to titles with a similarity of 0.2 about one time in seven.
+inline constexpr size_t kBandCount = 20;
+inline constexpr size_t kRowsPerBand = kSignatureSize / kBandCount;
+
+using Signature = std::array<uint16_t, kSignatureSize>;
+
+// Returns the normalized words of |title|, attribute keys included.
+std::vector<std::string> NormalizeTitle(std::string_view title);
+
+// Returns the fingerprint of |title|, or nullopt if it has too few words to
+// tell products apart.
+std::optional<Signature> ComputeSignature(std::string_view title);
+
+// Returns the non-zero key of band |band| of |signature|. Keys of different
+// bands differ, so all bands can share one table.
+uint32_t GetBandKey(const Signature& signature, size_t band);
+
+// Returns the share of equal values of |a| and |b|, an estimate of the
+// Jaccard similarity of their features.
+double EstimateSimilarity(const Signature& a, const Signature& b);
+
+}  // namespace safe_deal::product_matching
+
+#endif  // SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_FINGERPRINT_H_
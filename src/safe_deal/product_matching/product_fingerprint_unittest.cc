@@ -0,0 +1,86 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/product_matching/product_fingerprint.h"
+
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/check.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal::product_matching {
+
+namespace {
+
+Signature GetSignature(std::string_view title) {
+  std::optional<Signature> signature = ComputeSignature(title);
+  CHECK(signature) << title;
+  return *signature;
+}
+
+TEST(ProductFingerprintTest, NormalizeTitle) {
+  EXPECT_EQ((std::vector<std::string>{"apple", "iphone", "15", "pro", "128gb",
+                                      "black"}),
+            NormalizeTitle("Apple iPhone 15 Pro 128 GB - Black, NEW!"));
+  EXPECT_EQ((std::vector<std::string>{"samsung", "6.1in", "display", "1,5l",
+                                      "bottle"}),
+            NormalizeTitle("Samsung 6.1 in. display / 1,5 L bottle."));
+  // A number without a unit stays a word, and so do units without a number.
+  EXPECT_EQ((std::vector<std::string>{"2", "x", "usb", "c", "cable", "m"}),
+            NormalizeTitle("2 x USB-C cable (M)"));
+  // Other scripts are kept whole.
+  EXPECT_EQ((std::vector<std::string>{"\xC3\x89" "couteurs", "bluetooth"}),
+            NormalizeTitle("\xC3\x89" "couteurs Bluetooth"));
+}
+
+TEST(ProductFingerprintTest, ShortTitlesHaveNoSignature) {
+  EXPECT_FALSE(ComputeSignature(""));
+  EXPECT_FALSE(ComputeSignature("Apple iPhone"));
+  // Stop words do not count.
+  EXPECT_FALSE(ComputeSignature("The new iPhone for sale"));
+  EXPECT_TRUE(ComputeSignature("Apple iPhone 15"));
+}
+
+TEST(ProductFingerprintTest, Similarity) {
+  const Signature listing = GetSignature("Apple iPhone 15 Pro 128GB Black");
+  EXPECT_EQ(listing, GetSignature("APPLE iPhone 15 Pro, 128 GB (Black)"));
+  EXPECT_EQ(1.0, EstimateSimilarity(listing, listing));
+
+  const double reworded = EstimateSimilarity(
+      listing, GetSignature("iPhone 15 Pro 128 GB Black Apple Smartphone"));
+  const double other_capacity = EstimateSimilarity(
+      listing, GetSignature("Apple iPhone 15 Pro 256GB Black"));
+  const double other_product = EstimateSimilarity(
+      listing, GetSignature("Stainless steel chef knife 8 inch"));
+  EXPECT_GT(reworded, 0.5);
+  EXPECT_LT(other_capacity, reworded);
+  EXPECT_LT(other_product, 0.2);
+}
+
+TEST(ProductFingerprintTest, BandKeys) {
+  const Signature signature = GetSignature("Apple iPhone 15 Pro 128GB Black");
+  std::set<uint32_t> keys;
+  for (size_t band = 0; band < kBandCount; ++band) {
+    uint32_t key = GetBandKey(signature, band);
+    EXPECT_NE(0u, key);
+    keys.insert(key);
+  }
+  EXPECT_EQ(kBandCount, keys.size());
+
+  // Equal bands of different signatures have equal keys.
+  Signature other = signature;
+  other[0] ^= 1;
+  EXPECT_NE(GetBandKey(signature, 0), GetBandKey(other, 0));
+  for (size_t band = 1; band < kBandCount; ++band) {
+    EXPECT_EQ(GetBandKey(signature, band), GetBandKey(other, band));
+  }
+}
+
+}  // namespace
+
+}  // namespace safe_deal::product_matching
@@ -0,0 +1,90 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_MATCHING_FORMAT_H_
+#define SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_MATCHING_FORMAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "safe_deal/product_matching/product_fingerprint.h"
+
+// On-disk layout of the product matching index, a single file mapped read
+// write. All integers are little endian.
+//
+// The file is a FileHeader, a ring of kCapacity ProductEntry and a table of
+// kBucketCount Bucket. Products are written to the next slot of the ring,
+// replacing the oldest one once it is full. Every product has one bucket per
+// band of its signature; buckets are probed linearly from the band key
+// modulo kBucketCount, and several products may share a band key.
+//
+// Buckets are updated in place, so a crash can leave them out of step with
+// the entries. FileHeader::dirty is set while the file is open; a file that
+// was not closed cleanly gets its buckets rebuilt from the entries.
+namespace safe_deal::product_matching {
+
+inline constexpr uint32_t kFileMagic = 0x4d504453;  // "SDPM"
+
+// Bump when the layout or the fingerprint algorithm changes. Files with
+// another version are discarded.
+inline constexpr uint32_t kFormatVersion = 1;
+
+inline constexpr uint32_t kCapacity = 8192;
+// Keeps the table at most 5/8 full with every slot in use.
+inline constexpr uint32_t kBucketCount = 262144;
+static_assert(kCapacity * kBandCount * 8 <= kBucketCount * 5);
+
+// Longer ids are not indexed; no supported marketplace uses them.
+inline constexpr size_t kMaxProductIdLength = 27;
+
+#pragma pack(push, 1)
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t capacity;
+  uint32_t bucket_count;
+  // Slot the next new product is written to.
+  uint32_t next_slot;
+  uint32_t product_count;
+  uint32_t dirty;
+  uint32_t reserved;
+};
+
+struct ProductEntry {
+  // ComputeProductKeyHash() of the listing, or 0 if the slot is empty.
+  uint64_t product_key;
+  // -1 if the listing had no price.
+  int64_t price_micros;
+  // Seconds since the Unix epoch the listing was last seen.
+  int64_t seen_time;
+  uint16_t signature[kSignatureSize];
+  uint8_t marketplace;
+  uint8_t product_id_length;
+  char product_id[kMaxProductIdLength];
+  // ISO 4217 code, zero filled if unknown.
+  char currency_code[3];
+};
+
+struct Bucket {
+  // GetBandKey() of one band of the product, or 0 if the bucket is empty.
+  uint32_t band_key;
+  uint32_t slot;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 32);
+static_assert(sizeof(ProductEntry) == 176);
+static_assert(sizeof(Bucket) == 8);
+
+inline constexpr size_t kEntriesOffset = sizeof(FileHeader);
+inline constexpr size_t kBucketsOffset =
+    kEntriesOffset + kCapacity * sizeof(ProductEntry);
+inline constexpr size_t kFileSize =
+    kBucketsOffset + kBucketCount * sizeof(Bucket);
+
+}  // namespace safe_deal::product_matching
+
+#endif  // SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_MATCHING_FORMAT_H_
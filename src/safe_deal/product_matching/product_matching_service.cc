@@ -0,0 +1,82 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/product_matching/product_matching_service.h"
+
+#include <string>
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/task/thread_pool.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr base::FilePath::CharType kDirectoryName[] =
+    FILE_PATH_LITERAL("Safe Deal");
+
+}  // namespace
+
+ProductMatchingService::ProductMatchingService(
+    const base::FilePath& profile_path)
+    : store_(base::ThreadPool::CreateSequencedTaskRunner(
+                 {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+                  base::TaskShutdownBehavior::BLOCK_SHUTDOWN}),
+             profile_path.Append(kDirectoryName)) {
+  store_.AsyncCall(&ProductMatchingStore::Init);
+}
+
+ProductMatchingService::~ProductMatchingService() = default;
+
+void ProductMatchingService::AddProduct(mojom::Marketplace marketplace,
+                                        std::string_view product_id,
+                                        std::string_view title,
+                                        int64_t price_micros,
+                                        std::string_view currency_code,
+                                        base::Time time) {
+  if (product_id.empty() || title.empty()) {
+    return;
+  }
+  store_.AsyncCall(&ProductMatchingStore::AddProduct)
+      .WithArgs(marketplace, std::string(product_id), std::string(title),
+                price_micros, std::string(currency_code), time);
+}
+
+void ProductMatchingService::FindMatches(mojom::Marketplace marketplace,
+                                         std::string_view title,
+                                         size_t max_results,
+                                         FindMatchesCallback callback) {
+  store_.AsyncCall(&ProductMatchingStore::FindMatches)
+      .WithArgs(marketplace, std::string(title), max_results)
+      .Then(std::move(callback));
+}
+
+void ProductMatchingService::FindMatchesOnStoreSequence(
+    mojom::Marketplace marketplace,
+    std::string_view title,
+    size_t max_results,
+    FindMatchesCallback callback) {
+  store_.PostTaskWithThisObject(base::BindOnce(
+      [](mojom::Marketplace marketplace, const std::string& title,
+         size_t max_results, FindMatchesCallback callback,
+         ProductMatchingStore* store) {
+        std::move(callback).Run(
+            store->FindMatches(marketplace, title, max_results));
+      },
+      marketplace, std::string(title), max_results, std::move(callback)));
+}
+
+void ProductMatchingService::GetMappedBytes(
+    base::OnceCallback<void(size_t)> callback) {
+  store_.AsyncCall(&ProductMatchingStore::mapped_bytes)
+      .Then(std::move(callback));
+}
+
+void ProductMatchingService::Shutdown() {
+  // Destroying the store on its sequence marks the file closed cleanly.
+  store_.Reset();
+}
+
+}  // namespace safe_deal
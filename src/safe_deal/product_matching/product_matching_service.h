@@ -0,0 +1,72 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_MATCHING_SERVICE_H_
+#define SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_MATCHING_SERVICE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/functional/callback.h"
+#include "base/threading/sequence_bound.h"
+#include "base/time/time.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/product_matching/product_matching_store.h"
+
+namespace safe_deal {
+
+// Profile keyed front end of ProductMatchingStore. The store lives on a
+// dedicated blocking sequence; all methods here must be called on the UI
+// thread and never block.
+class ProductMatchingService : public KeyedService {
+ public:
+  using FindMatchesCallback =
+      base::OnceCallback<void(std::vector<ProductMatch>)>;
+
+  explicit ProductMatchingService(const base::FilePath& profile_path);
+  ProductMatchingService(const ProductMatchingService&) = delete;
+  ProductMatchingService& operator=(const ProductMatchingService&) = delete;
+  ~ProductMatchingService() override;
+
+  // Indexes a listing seen at |time|, so that it is offered as a match on
+  // the other marketplaces.
+  void AddProduct(mojom::Marketplace marketplace,
+                  std::string_view product_id,
+                  std::string_view title,
+                  int64_t price_micros,
+                  std::string_view currency_code,
+                  base::Time time);
+
+  // Replies with up to |max_results| listings on other marketplaces that are
+  // likely the item titled |title|, most similar first.
+  void FindMatches(mojom::Marketplace marketplace,
+                   std::string_view title,
+                   size_t max_results,
+                   FindMatchesCallback callback);
+
+  // As FindMatches(), but runs |callback| on the store's sequence, for
+  // callers that continue in the background, like SafeDealPipeline stages.
+  void FindMatchesOnStoreSequence(mojom::Marketplace marketplace,
+                                  std::string_view title,
+                                  size_t max_results,
+                                  FindMatchesCallback callback);
+
+  // Replies with how much of the index file is mapped.
+  void GetMappedBytes(base::OnceCallback<void(size_t)> callback);
+
+  // KeyedService:
+  void Shutdown() override;
+
+ private:
+  base::SequenceBound<ProductMatchingStore> store_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_MATCHING_SERVICE_H_
@@ -0,0 +1,335 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/product_matching/product_matching_store.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include "base/containers/flat_set.h"
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/trace_event/trace_event.h"
+#include "safe_deal/common/product_key.h"
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+#include "safe_deal/product_matching/product_fingerprint.h"
+
+namespace safe_deal {
+
+using product_matching::Bucket;
+using product_matching::FileHeader;
+using product_matching::ProductEntry;
+using product_matching::Signature;
+
+namespace {
+
+constexpr base::FilePath::CharType kFileName[] =
+    FILE_PATH_LITERAL("ProductMatching");
+
+// Candidates that share a band but fewer features than this are chance
+// collisions, typically listings of the same brand.
+constexpr double kMinSimilarity = 0.4;
+
+// The entries are packed; copy the signature out rather than binding a
+// reference to it.
+Signature GetSignature(const ProductEntry& entry) {
+  Signature signature;
+  memcpy(signature.data(), entry.signature, sizeof(entry.signature));
+  return signature;
+}
+
+}  // namespace
+
+ProductMatchingStore::ProductMatchingStore(const base::FilePath& directory)
+    : path_(directory.Append(kFileName)) {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+ProductMatchingStore::~ProductMatchingStore() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!initialized_) {
+    return;
+  }
+  header_->dirty = 0;
+  // The mapping is written back when it is unmapped.
+  header_ = nullptr;
+  entries_ = nullptr;
+  buckets_ = nullptr;
+}
+
+bool ProductMatchingStore::Init() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  SafeDealStartupMetrics::Scope scope("ProductMatchingStore::Init");
+  if (!base::CreateDirectory(path_.DirName()) || !OpenFile()) {
+    return false;
+  }
+  LoadEntries(/*rebuild_buckets=*/header_->dirty != 0);
+  header_->dirty = 1;
+  initialized_ = true;
+  return true;
+}
+
+bool ProductMatchingStore::OpenFile() {
+  base::File file(path_, base::File::FLAG_OPEN_ALWAYS | base::File::FLAG_READ |
+                             base::File::FLAG_WRITE);
+  if (!file.IsValid()) {
+    LOG(ERROR) << "Failed to open " << path_ << ": "
+               << base::File::ErrorToString(file.error_details());
+    return false;
+  }
+
+  const int64_t length = file.GetLength();
+  FileHeader header = {};
+  if (length >= static_cast<int64_t>(sizeof(header))) {
+    file.Read(0, base::byte_span_from_ref(header));
+  }
+  if (length != static_cast<int64_t>(product_matching::kFileSize) ||
+      header.magic != product_matching::kFileMagic ||
+      header.version != product_matching::kFormatVersion ||
+      header.capacity != product_matching::kCapacity ||
+      header.bucket_count != product_matching::kBucketCount ||
+      header.next_slot >= product_matching::kCapacity) {
+    if (length > 0) {
+      LOG(WARNING) << "Discarding incompatible product matching index "
+                   << path_;
+    }
+    // Truncating first zero fills every entry and bucket.
+    header = {.magic = product_matching::kFileMagic,
+              .version = product_matching::kFormatVersion,
+              .capacity = product_matching::kCapacity,
+              .bucket_count = product_matching::kBucketCount};
+    if (!file.SetLength(0) ||
+        !file.SetLength(static_cast<int64_t>(product_matching::kFileSize)) ||
+        !file.WriteAndCheck(0, base::byte_span_from_ref(header))) {
+      return false;
+    }
+  }
+
+  mapping_ = std::make_unique<base::MemoryMappedFile>();
+  if (!mapping_->Initialize(std::move(file),
+                            base::MemoryMappedFile::Region::kWholeFile,
+                            base::MemoryMappedFile::READ_WRITE) ||
+      mapping_->length() != product_matching::kFileSize) {
+    mapping_.reset();
+    return false;
+  }
+  uint8_t* data = mapping_->data();
+  header_ = reinterpret_cast<FileHeader*>(data);
+  entries_ = reinterpret_cast<ProductEntry*>(
+      data + product_matching::kEntriesOffset);
+  buckets_ =
+      reinterpret_cast<Bucket*>(data + product_matching::kBucketsOffset);
+  return true;
+}
+
+void ProductMatchingStore::LoadEntries(bool rebuild_buckets) {
+  if (rebuild_buckets) {
+    LOG(WARNING) << "Rebuilding product matching index after unclean exit";
+  }
+  slots_by_key_.clear();
+  slots_by_key_.reserve(product_matching::kCapacity);
+  for (uint32_t slot = 0; slot < product_matching::kCapacity; ++slot) {
+    ProductEntry& entry = entries_[slot];
+    if (!entry.product_key) {
+      continue;
+    }
+    if (entry.product_id_length == 0 ||
+        entry.product_id_length > product_matching::kMaxProductIdLength ||
+        !slots_by_key_.try_emplace(entry.product_key, slot).second) {
+      // Torn by a crash. Its buckets, if any, are dropped by the rebuild.
+      entry = {};
+      rebuild_buckets = true;
+    }
+  }
+  if (rebuild_buckets) {
+    memset(buckets_.get(), 0, product_matching::kBucketCount * sizeof(Bucket));
+    for (const auto& [key, slot] : slots_by_key_) {
+      InsertBands(slot);
+    }
+  }
+  header_->product_count = static_cast<uint32_t>(slots_by_key_.size());
+}
+
+uint32_t ProductMatchingStore::GetHomeBucket(uint32_t band_key) const {
+  return band_key & (product_matching::kBucketCount - 1);
+}
+
+void ProductMatchingStore::InsertBands(uint32_t slot) {
+  const uint32_t mask = product_matching::kBucketCount - 1;
+  const Signature signature = GetSignature(entries_[slot]);
+  for (size_t band = 0; band < product_matching::kBandCount; ++band) {
+    const uint32_t band_key = product_matching::GetBandKey(signature, band);
+    uint32_t bucket = GetHomeBucket(band_key);
+    while (buckets_[bucket].band_key) {
+      bucket = (bucket + 1) & mask;
+    }
+    buckets_[bucket] = {band_key, slot};
+  }
+}
+
+void ProductMatchingStore::RemoveBands(uint32_t slot) {
+  const uint32_t mask = product_matching::kBucketCount - 1;
+  const Signature signature = GetSignature(entries_[slot]);
+  for (size_t band = 0; band < product_matching::kBandCount; ++band) {
+    const uint32_t band_key = product_matching::GetBandKey(signature, band);
+    uint32_t hole = GetHomeBucket(band_key);
+    while (buckets_[hole].band_key &&
+           (buckets_[hole].band_key != band_key ||
+            buckets_[hole].slot != slot)) {
+      hole = (hole + 1) & mask;
+    }
+    if (!buckets_[hole].band_key) {
+      continue;
+    }
+    // Backward shift deletion, as in SharedHashTableWriter::Remove().
+    for (uint32_t next = (hole + 1) & mask; buckets_[next].band_key;
+         next = (next + 1) & mask) {
+      const uint32_t home = GetHomeBucket(buckets_[next].band_key);
+      if (((next - home) & mask) >= ((next - hole) & mask)) {
+        buckets_[hole] = buckets_[next];
+        hole = next;
+      }
+    }
+    buckets_[hole] = {};
+  }
+}
+
+void ProductMatchingStore::AddProduct(mojom::Marketplace marketplace,
+                                      std::string_view product_id,
+                                      std::string_view title,
+                                      int64_t price_micros,
+                                      std::string_view currency_code,
+                                      base::Time time) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!initialized_ || product_id.empty() ||
+      product_id.size() > product_matching::kMaxProductIdLength) {
+    return;
+  }
+  std::optional<Signature> signature =
+      product_matching::ComputeSignature(title);
+  if (!signature) {
+    return;
+  }
+
+  const uint64_t key = ComputeProductKeyHash(marketplace, product_id);
+  uint32_t slot;
+  bool bands_changed = true;
+  auto it = slots_by_key_.find(key);
+  if (it != slots_by_key_.end()) {
+    // Seen before; only a retitled listing moves between buckets.
+    slot = it->second;
+    bands_changed = GetSignature(entries_[slot]) != *signature;
+    if (bands_changed) {
+      RemoveBands(slot);
+    }
+  } else {
+    slot = header_->next_slot;
+    header_->next_slot = (slot + 1) % product_matching::kCapacity;
+    if (uint64_t evicted_key = entries_[slot].product_key) {
+      RemoveBands(slot);
+      slots_by_key_.erase(evicted_key);
+    } else {
+      ++header_->product_count;
+    }
+    slots_by_key_.emplace(key, slot);
+  }
+
+  ProductEntry entry = {};
+  entry.product_key = key;
+  entry.price_micros = price_micros;
+  entry.seen_time = time.ToTimeT();
+  memcpy(entry.signature, signature->data(), sizeof(entry.signature));
+  entry.marketplace = static_cast<uint8_t>(marketplace);
+  entry.product_id_length = static_cast<uint8_t>(product_id.size());
+  std::ranges::copy(product_id, entry.product_id);
+  std::ranges::copy(currency_code.substr(0, sizeof(entry.currency_code)),
+                    entry.currency_code);
+  entries_[slot] = entry;
+  if (bands_changed) {
+    InsertBands(slot);
+  }
+}
+
+std::vector<ProductMatch> ProductMatchingStore::FindMatches(
+    mojom::Marketplace marketplace,
+    std::string_view title,
+    size_t max_results) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  TRACE_EVENT("safe_deal", "ProductMatchingStore::FindMatches");
+  const base::TimeTicks start = base::TimeTicks::Now();
+  std::vector<ProductMatch> matches;
+  if (!initialized_ || max_results == 0) {
+    return matches;
+  }
+  std::optional<Signature> signature =
+      product_matching::ComputeSignature(title);
+  if (!signature) {
+    return matches;
+  }
+
+  const uint32_t mask = product_matching::kBucketCount - 1;
+  std::vector<uint32_t> candidates;
+  for (size_t band = 0; band < product_matching::kBandCount; ++band) {
+    const uint32_t band_key = product_matching::GetBandKey(*signature, band);
+    for (uint32_t bucket = GetHomeBucket(band_key); buckets_[bucket].band_key;
+         bucket = (bucket + 1) & mask) {
+      if (buckets_[bucket].band_key == band_key) {
+        candidates.push_back(buckets_[bucket].slot);
+      }
+    }
+  }
+
+  for (uint32_t slot : base::flat_set<uint32_t>(std::move(candidates))) {
+    if (slot >= product_matching::kCapacity) {
+      continue;
+    }
+    const ProductEntry& entry = entries_[slot];
+    const auto entry_marketplace =
+        static_cast<mojom::Marketplace>(entry.marketplace);
+    if (!entry.product_key || entry_marketplace == marketplace ||
+        !mojom::IsKnownEnumValue(entry_marketplace)) {
+      continue;
+    }
+    const double similarity =
+        product_matching::EstimateSimilarity(*signature, GetSignature(entry));
+    if (similarity < kMinSimilarity) {
+      continue;
+    }
+    const std::string_view currency_code(
+        entry.currency_code,
+        strnlen(entry.currency_code, sizeof(entry.currency_code)));
+    matches.push_back(
+        {entry_marketplace,
+         std::string(entry.product_id, entry.product_id_length),
+         entry.price_micros, std::string(currency_code),
+         base::Time::FromTimeT(entry.seen_time), similarity});
+  }
+  std::ranges::sort(matches, std::ranges::greater(), &ProductMatch::similarity);
+  if (matches.size() > max_results) {
+    matches.resize(max_results);
+  }
+
+  base::UmaHistogramCustomMicrosecondsTimes(
+      "SafeDeal.ProductMatching.LookupTime", base::TimeTicks::Now() - start,
+      base::Microseconds(10), base::Seconds(10), 50);
+  return matches;
+}
+
+size_t ProductMatchingStore::product_count() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return initialized_ ? header_->product_count : 0;
+}
+
+size_t ProductMatchingStore::mapped_bytes() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return mapping_ ? mapping_->length() : 0;
+}
+
+}  // namespace safe_deal
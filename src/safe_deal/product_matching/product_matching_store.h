@@ -0,0 +1,103 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_MATCHING_STORE_H_
+#define SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_MATCHING_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/raw_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/product_matching/product_matching_format.h"
+#include "third_party/abseil-cpp/absl/container/flat_hash_map.h"
+
+namespace safe_deal {
+
+// A listing on another marketplace that is likely the same item.
+struct ProductMatch {
+  mojom::Marketplace marketplace;
+  std::string product_id;
+  // -1 if the listing had no price.
+  int64_t price_micros;
+  // Empty if unknown.
+  std::string currency_code;
+  base::Time seen_time;
+  // Estimated share of title features the listings have in common.
+  double similarity;
+};
+
+// Per-profile index of the listings seen recently, keyed by locality
+// sensitive hashes of their titles, in the file described in
+// product_matching_format.h. The file is mapped read write, so opening it
+// costs nothing beyond rebuilding the key map, and a lookup probes one bucket
+// run per band without copying anything. Performs blocking I/O and must live
+// on a sequence that allows it.
+class ProductMatchingStore {
+ public:
+  explicit ProductMatchingStore(const base::FilePath& directory);
+  ProductMatchingStore(const ProductMatchingStore&) = delete;
+  ProductMatchingStore& operator=(const ProductMatchingStore&) = delete;
+  // Marks the file as closed cleanly.
+  ~ProductMatchingStore();
+
+  // Opens or creates the index. Files written with another format version
+  // are discarded. Returns false if the file is unusable, in which case every
+  // other method is a no-op.
+  bool Init();
+
+  // Indexes the listing, or updates it if it is already indexed. Listings
+  // whose title is too short to fingerprint are ignored.
+  void AddProduct(mojom::Marketplace marketplace,
+                  std::string_view product_id,
+                  std::string_view title,
+                  int64_t price_micros,
+                  std::string_view currency_code,
+                  base::Time time);
+
+  // Returns up to |max_results| listings on marketplaces other than
+  // |marketplace| whose title is similar to |title|, most similar first.
+  std::vector<ProductMatch> FindMatches(mojom::Marketplace marketplace,
+                                        std::string_view title,
+                                        size_t max_results);
+
+  size_t product_count() const;
+  size_t mapped_bytes() const;
+
+ private:
+  bool OpenFile();
+  // Rebuilds |slots_by_key_|, and the buckets if the file was not closed
+  // cleanly.
+  void LoadEntries(bool rebuild_buckets);
+  void InsertBands(uint32_t slot);
+  void RemoveBands(uint32_t slot);
+  uint32_t GetHomeBucket(uint32_t band_key) const;
+
+  const base::FilePath path_;
+  bool initialized_ = false;
+
+  std::unique_ptr<base::MemoryMappedFile> mapping_;
+  raw_ptr<product_matching::FileHeader> header_ = nullptr;
+  raw_ptr<product_matching::ProductEntry, AllowPtrArithmetic> entries_ =
+      nullptr;
+  raw_ptr<product_matching::Bucket, AllowPtrArithmetic> buckets_ = nullptr;
+
+  // Slot of every indexed listing, by product key.
+  absl::flat_hash_map<uint64_t, uint32_t> slots_by_key_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_PRODUCT_MATCHING_PRODUCT_MATCHING_STORE_H_
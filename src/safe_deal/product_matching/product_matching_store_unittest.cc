@@ -0,0 +1,225 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/product_matching/product_matching_store.h"
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "safe_deal/product_matching/product_matching_format.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal {
+
+namespace {
+
+using mojom::Marketplace;
+
+constexpr char kTitle[] = "Apple iPhone 15 Pro 128GB Black";
+constexpr char kSimilarTitle[] = "iPhone 15 Pro 128 GB Black Apple Smartphone";
+constexpr char kOtherTitle[] = "Stainless steel chef knife 8 inch";
+
+base::Time SeenTime() {
+  return base::Time::FromTimeT(1700000000);
+}
+
+// A title that shares no words with the title of any other |i|.
+std::string UniqueTitle(int i) {
+  const std::string number = base::NumberToString(i);
+  return "item" + number + " part" + number + " kind" + number;
+}
+
+class ProductMatchingStoreTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  std::unique_ptr<ProductMatchingStore> Open() {
+    auto store = std::make_unique<ProductMatchingStore>(temp_dir_.GetPath());
+    EXPECT_TRUE(store->Init());
+    return store;
+  }
+
+  base::FilePath file_path() const {
+    return temp_dir_.GetPath().AppendASCII("ProductMatching");
+  }
+
+  // Writes |data| over the closed index file at |offset|.
+  void Overwrite(size_t offset, base::span<const uint8_t> data) {
+    base::File file(file_path(), base::File::FLAG_OPEN |
+                                     base::File::FLAG_READ |
+                                     base::File::FLAG_WRITE);
+    ASSERT_TRUE(file.WriteAndCheck(static_cast<int64_t>(offset), data));
+  }
+
+  static std::vector<std::string> FindIds(ProductMatchingStore& store,
+                                          Marketplace marketplace,
+                                          std::string_view title) {
+    std::vector<std::string> ids;
+    for (const ProductMatch& match :
+         store.FindMatches(marketplace, title, /*max_results=*/10)) {
+      ids.push_back(match.product_id);
+    }
+    return ids;
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(ProductMatchingStoreTest, FindsListingsOnOtherMarketplaces) {
+  auto store = Open();
+  store->AddProduct(Marketplace::kAmazon, "B0CHX1W1XY", kTitle, 999'000'000,
+                    "USD", SeenTime());
+  EXPECT_EQ(1u, store->product_count());
+
+  std::vector<ProductMatch> matches =
+      store->FindMatches(Marketplace::kEbay, kSimilarTitle, 5);
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ(Marketplace::kAmazon, matches[0].marketplace);
+  EXPECT_EQ("B0CHX1W1XY", matches[0].product_id);
+  EXPECT_EQ(999'000'000, matches[0].price_micros);
+  EXPECT_EQ("USD", matches[0].currency_code);
+  EXPECT_EQ(SeenTime(), matches[0].seen_time);
+  EXPECT_GT(matches[0].similarity, 0.5);
+
+  EXPECT_TRUE(FindIds(*store, Marketplace::kAmazon, kSimilarTitle).empty());
+  EXPECT_TRUE(FindIds(*store, Marketplace::kEbay, kOtherTitle).empty());
+  EXPECT_TRUE(FindIds(*store, Marketplace::kEbay, "iPhone").empty());
+}
+
+TEST_F(ProductMatchingStoreTest, MostSimilarFirst) {
+  auto store = Open();
+  const base::Time time = SeenTime();
+  store->AddProduct(Marketplace::kEbay, "1", kSimilarTitle, -1, "", time);
+  store->AddProduct(Marketplace::kAliExpress, "2", kTitle, 1, "", time);
+  store->AddProduct(Marketplace::kEbay, "3", kOtherTitle, 1, "", time);
+  EXPECT_EQ((std::vector<std::string>{"2", "1"}),
+            FindIds(*store, Marketplace::kAmazon, kTitle));
+  std::vector<ProductMatch> matches =
+      store->FindMatches(Marketplace::kAmazon, kTitle, 1);
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ("2", matches[0].product_id);
+  EXPECT_EQ(1.0, matches[0].similarity);
+  EXPECT_EQ("", matches[0].currency_code);
+}
+
+TEST_F(ProductMatchingStoreTest, UpdatesListings) {
+  auto store = Open();
+  const base::Time time = SeenTime();
+  store->AddProduct(Marketplace::kAmazon, "A", kTitle, 100, "USD", time);
+  store->AddProduct(Marketplace::kAmazon, "A", kTitle, 90, "USD", time);
+  std::vector<ProductMatch> matches =
+      store->FindMatches(Marketplace::kEbay, kTitle, 5);
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ(90, matches[0].price_micros);
+
+  // A retitled listing moves to the buckets of its new title.
+  store->AddProduct(Marketplace::kAmazon, "A", kOtherTitle, 80, "USD", time);
+  EXPECT_EQ(1u, store->product_count());
+  EXPECT_TRUE(FindIds(*store, Marketplace::kEbay, kTitle).empty());
+  EXPECT_EQ((std::vector<std::string>{"A"}),
+            FindIds(*store, Marketplace::kEbay, kOtherTitle));
+
+  // The same id on another marketplace is another listing.
+  store->AddProduct(Marketplace::kEbay, "A", kTitle, 70, "USD", time);
+  EXPECT_EQ(2u, store->product_count());
+}
+
+TEST_F(ProductMatchingStoreTest, IgnoresUnindexableListings) {
+  auto store = Open();
+  store->AddProduct(Marketplace::kAmazon, "", kTitle, 1, "", SeenTime());
+  store->AddProduct(Marketplace::kAmazon,
+                    std::string(product_matching::kMaxProductIdLength + 1, '1'),
+                    kTitle, 1, "", SeenTime());
+  store->AddProduct(Marketplace::kAmazon, "B", "iPhone", 1, "", SeenTime());
+  EXPECT_EQ(0u, store->product_count());
+}
+
+TEST_F(ProductMatchingStoreTest, SurvivesReopening) {
+  Open()->AddProduct(Marketplace::kAmazon, "A", kTitle, 1, "EUR", SeenTime());
+  auto store = Open();
+  EXPECT_EQ(1u, store->product_count());
+  EXPECT_EQ((std::vector<std::string>{"A"}),
+            FindIds(*store, Marketplace::kEbay, kSimilarTitle));
+  EXPECT_EQ(product_matching::kFileSize, store->mapped_bytes());
+}
+
+TEST_F(ProductMatchingStoreTest, RebuildsBucketsAfterUncleanExit) {
+  Open()->AddProduct(Marketplace::kAmazon, "A", kTitle, 1, "", SeenTime());
+
+  // Buckets lost by a crash, with the file still marked open.
+  Overwrite(product_matching::kBucketsOffset,
+            std::vector<uint8_t>(product_matching::kBucketCount *
+                                 sizeof(product_matching::Bucket)));
+  const uint32_t kDirty = 1;
+  Overwrite(offsetof(product_matching::FileHeader, dirty),
+            base::byte_span_from_ref(kDirty));
+
+  auto store = Open();
+  EXPECT_EQ((std::vector<std::string>{"A"}),
+            FindIds(*store, Marketplace::kEbay, kTitle));
+}
+
+TEST_F(ProductMatchingStoreTest, DropsTornEntries) {
+  {
+    auto store = Open();
+    store->AddProduct(Marketplace::kAmazon, "A", kTitle, 1, "", SeenTime());
+    store->AddProduct(Marketplace::kAmazon, "B", kOtherTitle, 1, "",
+                      SeenTime());
+  }
+  // The first entry lost its id, in a file that was closed cleanly.
+  const uint8_t kZero = 0;
+  Overwrite(product_matching::kEntriesOffset +
+                offsetof(product_matching::ProductEntry, product_id_length),
+            base::byte_span_from_ref(kZero));
+
+  auto store = Open();
+  EXPECT_EQ(1u, store->product_count());
+  EXPECT_TRUE(FindIds(*store, Marketplace::kEbay, kTitle).empty());
+  EXPECT_EQ((std::vector<std::string>{"B"}),
+            FindIds(*store, Marketplace::kEbay, kOtherTitle));
+}
+
+TEST_F(ProductMatchingStoreTest, EvictsOldestListings) {
+  constexpr int kEvicted = 10;
+  constexpr int kCount = product_matching::kCapacity + kEvicted;
+  auto store = Open();
+  for (int i = 0; i < kCount; ++i) {
+    store->AddProduct(Marketplace::kAmazon, base::NumberToString(i),
+                      UniqueTitle(i), i, "", SeenTime());
+  }
+  EXPECT_EQ(product_matching::kCapacity, store->product_count());
+  for (int i = 0; i < kCount; ++i) {
+    std::vector<std::string> ids =
+        FindIds(*store, Marketplace::kEbay, UniqueTitle(i));
+    if (i < kEvicted) {
+      EXPECT_TRUE(ids.empty()) << i;
+    } else {
+      EXPECT_EQ(std::vector<std::string>{base::NumberToString(i)}, ids) << i;
+    }
+  }
+}
+
+TEST_F(ProductMatchingStoreTest, DiscardsIncompatibleFile) {
+  ASSERT_TRUE(base::WriteFile(file_path(), "SDPM but not version 1"));
+  auto store = Open();
+  EXPECT_EQ(0u, store->product_count());
+  EXPECT_EQ(static_cast<int64_t>(product_matching::kFileSize),
+            base::GetFileSize(file_path()).value_or(-1));
+  store->AddProduct(Marketplace::kAmazon, "A", kTitle, 1, "", SeenTime());
+  EXPECT_EQ((std::vector<std::string>{"A"}),
+            FindIds(*store, Marketplace::kEbay, kTitle));
+}
+
+}  // namespace
+
+}  // namespace safe_deal
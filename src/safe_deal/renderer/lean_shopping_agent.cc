@@ -0,0 +1,95 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/renderer/lean_shopping_agent.h"
+
+#include <optional>
+
+#include "base/metrics/histogram_functions.h"
+#include "base/numerics/safe_conversions.h"
+#include "content/public/renderer/render_frame.h"
+#include "safe_deal/common/marketplace_image_urls.h"
+#include "safe_deal/common/safe_deal_constants.h"
+#include "services/network/public/mojom/fetch_api.mojom-shared.h"
+#include "third_party/blink/public/platform/web_url.h"
+#include "third_party/blink/public/platform/web_url_request.h"
+#include "third_party/blink/public/web/web_document.h"
+#include "third_party/blink/public/web/web_frame_widget.h"
+#include "third_party/blink/public/web/web_local_frame.h"
+#include "ui/display/screen_info.h"
+#include "url/gurl.h"
+#include "url/url_constants.h"
+
+namespace safe_deal {
+
+namespace {
+
+bool g_enabled = false;
+
+}  // namespace
+
+// static
+void LeanShoppingAgent::SetEnabled(bool enabled) {
+  g_enabled = enabled;
+}
+
+LeanShoppingAgent::LeanShoppingAgent(content::RenderFrame* render_frame)
+    : content::RenderFrameObserver(render_frame) {}
+
+LeanShoppingAgent::~LeanShoppingAgent() = default;
+
+void LeanShoppingAgent::DidCommitProvisionalLoad(
+    ui::PageTransition transition) {
+  RecordSmallerImages();
+  marketplace_ = mojom::Marketplace::kUnknown;
+  search_image_width_ = 0;
+  if (!g_enabled) {
+    return;
+  }
+  GURL url = render_frame()->GetWebFrame()->GetDocument().Url();
+  if (!url.SchemeIs(url::kHttpsScheme)) {
+    return;
+  }
+  marketplace_ = GetMarketplaceForHost(url.host_piece());
+  if (marketplace_ != mojom::Marketplace::kUnknown &&
+      IsMarketplaceSearchPage(marketplace_, url)) {
+    float device_scale_factor = render_frame()
+                                    ->GetWebFrame()
+                                    ->FrameWidget()
+                                    ->GetOriginalScreenInfo()
+                                    .device_scale_factor;
+    search_image_width_ =
+        base::ClampCeil(kSearchResultImageWidth * device_scale_factor);
+  }
+}
+
+void LeanShoppingAgent::WillSendRequest(blink::WebURLRequest& request,
+                                        ForRedirect for_redirect) {
+  if (!search_image_width_ || for_redirect.value() ||
+      request.GetRequestDestination() !=
+          network::mojom::RequestDestination::kImage) {
+    return;
+  }
+  std::optional<GURL> smaller_url =
+      GetSmallerImageUrl(marketplace_, request.Url(), search_image_width_);
+  if (smaller_url) {
+    request.SetUrl(*smaller_url);
+    ++smaller_images_;
+  }
+}
+
+void LeanShoppingAgent::OnDestruct() {
+  RecordSmallerImages();
+  delete this;
+}
+
+void LeanShoppingAgent::RecordSmallerImages() {
+  if (search_image_width_) {
+    base::UmaHistogramCounts1000("SafeDeal.LeanShopping.SmallerImages",
+                                 smaller_images_);
+  }
+  smaller_images_ = 0;
+}
+
+}  // namespace safe_deal
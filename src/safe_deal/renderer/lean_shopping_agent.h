@@ -0,0 +1,52 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_RENDERER_LEAN_SHOPPING_AGENT_H_
+#define SAFE_DEAL_RENDERER_LEAN_SHOPPING_AGENT_H_
+
+#include "content/public/renderer/render_frame_observer.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+
+namespace safe_deal {
+
+// Lean shopping for the main frame marketplace documents of a profile that
+// has it on: search result images are requested from the smaller variants
+// their CDNs serve. Requests are rewritten as they are sent, so images the
+// preload scanner finds are covered too. Owns itself and is destroyed with
+// the RenderFrame.
+class LeanShoppingAgent : public content::RenderFrameObserver {
+ public:
+  // Sets whether documents committed from now on use lean shopping. The
+  // setting is per profile, hence per renderer process. Render main thread
+  // only.
+  static void SetEnabled(bool enabled);
+
+  explicit LeanShoppingAgent(content::RenderFrame* render_frame);
+  LeanShoppingAgent(const LeanShoppingAgent&) = delete;
+  LeanShoppingAgent& operator=(const LeanShoppingAgent&) = delete;
+  ~LeanShoppingAgent() override;
+
+  // content::RenderFrameObserver:
+  void DidCommitProvisionalLoad(ui::PageTransition transition) override;
+  void WillSendRequest(blink::WebURLRequest& request,
+                       ForRedirect for_redirect) override;
+  void OnDestruct() override;
+
+ private:
+  // Records how many images the search page that is going away requested
+  // smaller.
+  void RecordSmallerImages();
+
+  // The marketplace of the current document, kUnknown if lean shopping does
+  // not apply to it.
+  mojom::Marketplace marketplace_ = mojom::Marketplace::kUnknown;
+  // Width, in device pixels, search result images are requested at; 0 if the
+  // current document is not a search page.
+  int search_image_width_ = 0;
+  int smaller_images_ = 0;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_RENDERER_LEAN_SHOPPING_AGENT_H_
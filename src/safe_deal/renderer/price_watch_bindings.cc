@@ -0,0 +1,265 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/renderer/price_watch_bindings.h"
+
+#include <cmath>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/strings/string_util.h"
+#include "base/time/time.h"
+#include "content/public/common/isolated_world_ids.h"
+#include "content/public/renderer/render_frame.h"
+#include "gin/arguments.h"
+#include "gin/data_object_builder.h"
+#include "gin/handle.h"
+#include "gin/object_template_builder.h"
+#include "gin/wrappable.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/receiver.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "safe_deal/common/price_watch.mojom.h"
+#include "safe_deal/common/safe_deal_constants.h"
+#include "safe_deal/renderer/safe_deal_extension_page.h"
+#include "third_party/blink/public/platform/browser_interface_broker_proxy.h"
+#include "v8/include/v8-context.h"
+#include "v8/include/v8-exception.h"
+#include "v8/include/v8-function.h"
+#include "v8/include/v8-microtask-queue.h"
+#include "v8/include/v8-object.h"
+#include "v8/include/v8-persistent-handle.h"
+#include "v8/include/v8-primitive.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr char kGlobalName[] = "safeDealPriceWatch";
+
+// Prices are integers that JavaScript numbers hold exactly.
+constexpr double kMaxPriceMicros = 9007199254740991.0;  // 2^53 - 1
+
+std::optional<mojom::Marketplace> MarketplaceFromName(
+    const std::string& name) {
+  for (const MarketplaceInfo& info : GetMarketplaces()) {
+    if (base::ToLowerASCII(info.name) == name) {
+      return info.marketplace;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+// The |safeDealPriceWatch| object of one script context.
+class PriceWatchObject : public gin::Wrappable<PriceWatchObject>,
+                         public mojom::PriceWatchObserver {
+ public:
+  static gin::WrapperInfo kWrapperInfo;
+
+  PriceWatchObject(v8::Isolate* isolate,
+                   mojo::PendingRemote<mojom::PriceWatchHost> host)
+      : isolate_(isolate), host_(std::move(host)) {}
+  PriceWatchObject(const PriceWatchObject&) = delete;
+  PriceWatchObject& operator=(const PriceWatchObject&) = delete;
+
+  // gin::Wrappable:
+  gin::ObjectTemplateBuilder GetObjectTemplateBuilder(
+      v8::Isolate* isolate) override {
+    return gin::Wrappable<PriceWatchObject>::GetObjectTemplateBuilder(isolate)
+        .SetMethod("watch", &PriceWatchObject::Watch)
+        .SetMethod("unwatch", &PriceWatchObject::Unwatch)
+        .SetMethod("onPriceChanged",
+                   &PriceWatchObject::AddPriceChangedListener);
+  }
+
+  // mojom::PriceWatchObserver:
+  void OnPriceChanged(mojom::Marketplace marketplace,
+                      const std::string& product_id,
+                      int64_t old_price_micros,
+                      int64_t new_price_micros) override {
+    const MarketplaceInfo* info = GetMarketplaceInfo(marketplace);
+    if (!info || listeners_.empty()) {
+      return;
+    }
+    v8::HandleScope handle_scope(isolate_);
+    v8::Local<v8::Context> context =
+        listeners_.front().Get(isolate_)->GetCreationContextChecked();
+    v8::Context::Scope context_scope(context);
+    // Runs outside of script, so the microtasks the listeners queue are run
+    // here.
+    v8::MicrotasksScope microtasks_scope(context,
+                                         v8::MicrotasksScope::kRunMicrotasks);
+    v8::Local<v8::Value> change =
+        gin::DataObjectBuilder(isolate_)
+            .Set("marketplace", base::ToLowerASCII(info->name))
+            .Set("productId", product_id)
+            .Set("oldPriceMicros", static_cast<double>(old_price_micros))
+            .Set("newPriceMicros", static_cast<double>(new_price_micros))
+            .Build();
+    // A listener may add listeners, so call the ones present now.
+    std::vector<v8::Local<v8::Function>> listeners;
+    for (const v8::Global<v8::Function>& listener : listeners_) {
+      listeners.push_back(listener.Get(isolate_));
+    }
+    for (v8::Local<v8::Function> listener : listeners) {
+      // An exception in one listener goes to the console and does not stop
+      // the rest.
+      v8::TryCatch try_catch(isolate_);
+      try_catch.SetVerbose(true);
+      std::ignore = listener->Call(context, v8::Undefined(isolate_),
+                                   /*argc=*/1, &change);
+    }
+  }
+
+  // Drops the listeners and the pipes. The context is going away, and the
+  // listeners would otherwise keep it alive.
+  void Release() {
+    listeners_.clear();
+    observer_receiver_.reset();
+    host_.reset();
+  }
+
+  base::WeakPtr<PriceWatchObject> GetWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+ private:
+  ~PriceWatchObject() override = default;
+
+  void Watch(gin::Arguments* args) {
+    mojom::Marketplace marketplace;
+    std::string product_id;
+    if (!GetListing(args, &marketplace, &product_id)) {
+      return;
+    }
+    double known_price_micros = 0;
+    double last_check = 0;
+    if (!args->GetNext(&known_price_micros) ||
+        !(known_price_micros >= -1 && known_price_micros <= kMaxPriceMicros) ||
+        std::floor(known_price_micros) != known_price_micros) {
+      args->ThrowTypeError("knownPriceMicros must be an integer >= -1");
+      return;
+    }
+    if (!args->GetNext(&last_check) || !std::isfinite(last_check)) {
+      args->ThrowTypeError("lastCheck must be a number");
+      return;
+    }
+    if (host_) {
+      host_->Watch(marketplace, product_id,
+                   static_cast<int64_t>(known_price_micros),
+                   base::Time::FromMillisecondsSinceUnixEpoch(last_check));
+    }
+  }
+
+  void Unwatch(gin::Arguments* args) {
+    mojom::Marketplace marketplace;
+    std::string product_id;
+    if (!GetListing(args, &marketplace, &product_id)) {
+      return;
+    }
+    if (host_) {
+      host_->Unwatch(marketplace, product_id);
+    }
+  }
+
+  void AddPriceChangedListener(gin::Arguments* args) {
+    v8::Local<v8::Function> listener;
+    if (!args->GetNext(&listener)) {
+      args->ThrowTypeError("listener must be a function");
+      return;
+    }
+    if (!host_) {
+      return;
+    }
+    // The browser only sends changes once someone listens.
+    if (!observer_receiver_.is_bound()) {
+      host_->AddObserver(observer_receiver_.BindNewPipeAndPassRemote());
+    }
+    listeners_.emplace_back(isolate_, listener);
+  }
+
+  // Reads the marketplace and product id that start the arguments of
+  // watch() and unwatch(), throwing on ones the browser would reject.
+  bool GetListing(gin::Arguments* args,
+                  mojom::Marketplace* marketplace,
+                  std::string* product_id) {
+    std::string name;
+    std::optional<mojom::Marketplace> parsed;
+    if (!args->GetNext(&name) || !(parsed = MarketplaceFromName(name))) {
+      args->ThrowTypeError("Unknown marketplace");
+      return false;
+    }
+    if (!args->GetNext(product_id) || product_id->empty() ||
+        product_id->size() > mojom::kMaxWatchedProductIdLength) {
+      args->ThrowTypeError("Invalid productId");
+      return false;
+    }
+    *marketplace = *parsed;
+    return true;
+  }
+
+  const raw_ptr<v8::Isolate> isolate_;
+  mojo::Remote<mojom::PriceWatchHost> host_;
+  mojo::Receiver<mojom::PriceWatchObserver> observer_receiver_{this};
+  std::vector<v8::Global<v8::Function>> listeners_;
+  base::WeakPtrFactory<PriceWatchObject> weak_factory_{this};
+};
+
+gin::WrapperInfo PriceWatchObject::kWrapperInfo = {gin::kEmbedderNativeGin};
+
+PriceWatchBindings::PriceWatchBindings(content::RenderFrame* render_frame)
+    : content::RenderFrameObserver(render_frame) {}
+
+PriceWatchBindings::~PriceWatchBindings() = default;
+
+void PriceWatchBindings::DidCreateScriptContext(
+    v8::Local<v8::Context> v8_context,
+    int32_t world_id) {
+  // Extension pages run in the main world of their frame.
+  if (world_id != content::ISOLATED_WORLD_ID_GLOBAL ||
+      !IsSafeDealExtensionPage(v8_context)) {
+    return;
+  }
+
+  mojo::PendingRemote<mojom::PriceWatchHost> host;
+  render_frame()->GetBrowserInterfaceBroker().GetInterface(
+      host.InitWithNewPipeAndPassReceiver());
+
+  v8::Isolate* isolate = v8_context->GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(v8_context);
+  auto* object = new PriceWatchObject(isolate, std::move(host));
+  gin::Handle<PriceWatchObject> handle = gin::CreateHandle(isolate, object);
+  if (handle.IsEmpty()) {
+    return;
+  }
+  object_ = object->GetWeakPtr();
+  v8_context->Global()
+      ->Set(v8_context, gin::StringToV8(isolate, kGlobalName), handle.ToV8())
+      .Check();
+}
+
+void PriceWatchBindings::WillReleaseScriptContext(
+    v8::Local<v8::Context> context,
+    int32_t world_id) {
+  if (world_id != content::ISOLATED_WORLD_ID_GLOBAL) {
+    return;
+  }
+  if (object_) {
+    object_->Release();
+  }
+  object_.reset();
+}
+
+void PriceWatchBindings::OnDestruct() {
+  delete this;
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,59 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_RENDERER_PRICE_WATCH_BINDINGS_H_
+#define SAFE_DEAL_RENDERER_PRICE_WATCH_BINDINGS_H_
+
+#include <stdint.h>
+
+#include "base/memory/weak_ptr.h"
+#include "content/public/renderer/render_frame_observer.h"
+#include "v8/include/v8-forward.h"
+
+namespace safe_deal {
+
+class PriceWatchObject;
+
+// Lets the pages of the Safe Deal component extension put listings on the
+// profile's price watchlist and hear about price changes, as a global:
+//
+//   safeDealPriceWatch.watch(marketplace, productId, knownPriceMicros,
+//                            lastCheck)
+//   safeDealPriceWatch.unwatch(marketplace, productId)
+//   safeDealPriceWatch.onPriceChanged(listener)
+//
+// |marketplace| is "amazon", "aliexpress" or "ebay", |knownPriceMicros| is -1
+// if the price is unknown, and |lastCheck| is in milliseconds since the
+// epoch. The watchlist lives in the browser only while the profile is open,
+// so the extension keeps its own copy and watches it again when one of its
+// pages opens. Listeners get {marketplace, productId,
+// oldPriceMicros, newPriceMicros} while the page is open. PriceWatchHost
+// answers the same pages.
+//
+// Must be created after the extension system's frame observers, which
+// create the script contexts this checks. Owns itself and is destroyed with
+// the RenderFrame.
+class PriceWatchBindings : public content::RenderFrameObserver {
+ public:
+  explicit PriceWatchBindings(content::RenderFrame* render_frame);
+  PriceWatchBindings(const PriceWatchBindings&) = delete;
+  PriceWatchBindings& operator=(const PriceWatchBindings&) = delete;
+  ~PriceWatchBindings() override;
+
+  // content::RenderFrameObserver:
+  void DidCreateScriptContext(v8::Local<v8::Context> context,
+                              int32_t world_id) override;
+  void WillReleaseScriptContext(v8::Local<v8::Context> context,
+                                int32_t world_id) override;
+  void OnDestruct() override;
+
+ private:
+  // The object of the main world's current context. Its listeners hold the
+  // context alive, so they are dropped when the context is released.
+  base::WeakPtr<PriceWatchObject> object_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_RENDERER_PRICE_WATCH_BINDINGS_H_
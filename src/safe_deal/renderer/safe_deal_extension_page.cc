@@ -0,0 +1,25 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/renderer/safe_deal_extension_page.h"
+
+#include "extensions/common/extension.h"
+#include "extensions/common/mojom/context_type.mojom.h"
+#include "extensions/renderer/script_context.h"
+#include "extensions/renderer/script_context_set.h"
+#include "safe_deal/common/safe_deal_extension.h"
+
+namespace safe_deal {
+
+bool IsSafeDealExtensionPage(v8::Local<v8::Context> context) {
+  extensions::ScriptContext* script_context =
+      extensions::ScriptContextSet::GetContextByV8Context(context);
+  return script_context &&
+         script_context->context_type() ==
+             extensions::mojom::ContextType::kPrivilegedExtension &&
+         script_context->extension() &&
+         IsSafeDealComponentExtension(*script_context->extension());
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,20 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_RENDERER_SAFE_DEAL_EXTENSION_PAGE_H_
+#define SAFE_DEAL_RENDERER_SAFE_DEAL_EXTENSION_PAGE_H_
+
+#include "v8/include/v8-forward.h"
+
+namespace safe_deal {
+
+// Returns true if |context| is the script context of one of the Safe Deal
+// extension's pages. The browser binds the interfaces meant for the
+// extension for the same pages only (see IsSafeDealExtensionDocument()), so
+// globals installed for them get answers.
+bool IsSafeDealExtensionPage(v8::Local<v8::Context> context);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_RENDERER_SAFE_DEAL_EXTENSION_PAGE_H_
@@ -0,0 +1,48 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/renderer/safe_deal_renderer_configuration.h"
+
+#include <memory>
+#include <utility>
+
+#include "mojo/public/cpp/bindings/self_owned_receiver.h"
+#include "safe_deal/product_cache/renderer/product_table.h"
+#include "safe_deal/renderer/lean_shopping_agent.h"
+#include "safe_deal/seller_reputation/renderer/seller_reputation_table.h"
+#include "safe_deal/url_filter/renderer/url_filter_ruleset_dealer.h"
+
+namespace safe_deal {
+
+// static
+void SafeDealRendererConfiguration::Create(
+    mojo::PendingReceiver<mojom::SafeDealRendererConfiguration> receiver) {
+  mojo::MakeSelfOwnedReceiver(std::make_unique<SafeDealRendererConfiguration>(),
+                              std::move(receiver));
+}
+
+SafeDealRendererConfiguration::SafeDealRendererConfiguration() = default;
+SafeDealRendererConfiguration::~SafeDealRendererConfiguration() = default;
+
+void SafeDealRendererConfiguration::SetUrlFilterRuleset(
+    base::File ruleset_file) {
+  url_filter::UrlFilterRulesetDealer::GetInstance().SetRulesetFile(
+      std::move(ruleset_file));
+}
+
+void SafeDealRendererConfiguration::SetSellerReputationTable(
+    base::ReadOnlySharedMemoryRegion table) {
+  SellerReputationTable::GetInstance().SetRegion(std::move(table));
+}
+
+void SafeDealRendererConfiguration::SetProductTable(
+    base::ReadOnlySharedMemoryRegion table) {
+  ProductTable::GetInstance().SetRegion(std::move(table));
+}
+
+void SafeDealRendererConfiguration::SetLeanShoppingEnabled(bool enabled) {
+  LeanShoppingAgent::SetEnabled(enabled);
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,38 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_RENDERER_SAFE_DEAL_RENDERER_CONFIGURATION_H_
+#define SAFE_DEAL_RENDERER_SAFE_DEAL_RENDERER_CONFIGURATION_H_
+
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "safe_deal/common/safe_deal_renderer.mojom.h"
+
+namespace safe_deal {
+
+// Receives process-wide data from the browser on the render main thread and
+// hands it to the components that use it.
+class SafeDealRendererConfiguration
+    : public mojom::SafeDealRendererConfiguration {
+ public:
+  static void Create(
+      mojo::PendingReceiver<mojom::SafeDealRendererConfiguration> receiver);
+
+  SafeDealRendererConfiguration();
+  SafeDealRendererConfiguration(const SafeDealRendererConfiguration&) =
+      delete;
+  SafeDealRendererConfiguration& operator=(
+      const SafeDealRendererConfiguration&) = delete;
+  ~SafeDealRendererConfiguration() override;
+
+  // mojom::SafeDealRendererConfiguration:
+  void SetUrlFilterRuleset(base::File ruleset_file) override;
+  void SetSellerReputationTable(
+      base::ReadOnlySharedMemoryRegion table) override;
+  void SetProductTable(base::ReadOnlySharedMemoryRegion table) override;
+  void SetLeanShoppingEnabled(bool enabled) override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_RENDERER_SAFE_DEAL_RENDERER_CONFIGURATION_H_
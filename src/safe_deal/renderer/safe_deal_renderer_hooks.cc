@@ -0,0 +1,59 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/renderer/safe_deal_renderer_hooks.h"
+
+#include <utility>
+
+#include "base/feature_list.h"
+#include "base/functional/bind.h"
+#include "base/task/sequenced_task_runner.h"
+#include "content/public/renderer/render_frame.h"
+#include "mojo/public/cpp/bindings/binder_map.h"
+#include "safe_deal/common/safe_deal_features.h"
+#include "safe_deal/page_extractor/common/product_selectors.h"
+#include "safe_deal/page_extractor/renderer/safe_deal_page_extractor_agent.h"
+#include "safe_deal/product_cache/renderer/product_table_bindings.h"
+#include "safe_deal/renderer/lean_shopping_agent.h"
+#include "safe_deal/renderer/price_watch_bindings.h"
+#include "safe_deal/renderer/safe_deal_renderer_configuration.h"
+#include "safe_deal/renderer/safe_deal_settings_bindings.h"
+#include "safe_deal/renderer/shopping_speculation_agent.h"
+#include "safe_deal/url_filter/renderer/url_filter_throttle.h"
+
+namespace safe_deal {
+
+void OnRenderThreadStarted() {
+  PrecompileSelectors();
+}
+
+void OnRenderFrameCreated(content::RenderFrame* render_frame) {
+  if (render_frame->IsMainFrame()) {
+    new SafeDealPageExtractorAgent(render_frame);
+    if (base::FeatureList::IsEnabled(features::kSafeDealShoppingPredictor)) {
+      new ShoppingSpeculationAgent(render_frame);
+    }
+    if (base::FeatureList::IsEnabled(features::kSafeDealLeanShopping)) {
+      new LeanShoppingAgent(render_frame);
+    }
+  }
+  new ProductTableBindings(render_frame);
+  new SafeDealSettingsBindings(render_frame);
+  new PriceWatchBindings(render_frame);
+}
+
+void ExposeInterfacesToBrowser(mojo::BinderMap* binders) {
+  binders->Add<mojom::SafeDealRendererConfiguration>(
+      base::BindRepeating(&SafeDealRendererConfiguration::Create),
+      base::SequencedTaskRunner::GetCurrentDefault());
+}
+
+void AddURLLoaderThrottles(
+    std::vector<std::unique_ptr<blink::URLLoaderThrottle>>& throttles) {
+  if (auto throttle = url_filter::UrlFilterThrottle::MaybeCreate()) {
+    throttles.push_back(std::move(throttle));
+  }
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,42 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_RENDERER_SAFE_DEAL_RENDERER_HOOKS_H_
+#define SAFE_DEAL_RENDERER_SAFE_DEAL_RENDERER_HOOKS_H_
+
+#include <memory>
+#include <vector>
+
+namespace blink {
+class URLLoaderThrottle;
+}  // namespace blink
+
+namespace content {
+class RenderFrame;
+}  // namespace content
+
+namespace mojo {
+class BinderMap;
+}  // namespace mojo
+
+namespace safe_deal {
+
+// Called from ChromeContentRendererClient::RenderThreadStarted().
+void OnRenderThreadStarted();
+
+// Called from ChromeContentRendererClient::RenderFrameCreated(), after
+// ChromeExtensionsRendererClient::RenderFrameCreated().
+void OnRenderFrameCreated(content::RenderFrame* render_frame);
+
+// Called from ChromeContentRendererClient::ExposeInterfacesToBrowser().
+void ExposeInterfacesToBrowser(mojo::BinderMap* binders);
+
+// Called from URLLoaderThrottleProviderImpl::CreateThrottles(), on whichever
+// thread the request is made.
+void AddURLLoaderThrottles(
+    std::vector<std::unique_ptr<blink::URLLoaderThrottle>>& throttles);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_RENDERER_SAFE_DEAL_RENDERER_HOOKS_H_
@@ -0,0 +1,162 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/renderer/safe_deal_settings_bindings.h"
+
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/memory/raw_ptr.h"
+#include "content/public/common/isolated_world_ids.h"
+#include "content/public/renderer/render_frame.h"
+#include "gin/arguments.h"
+#include "gin/data_object_builder.h"
+#include "gin/handle.h"
+#include "gin/object_template_builder.h"
+#include "gin/wrappable.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "safe_deal/common/safe_deal_settings.mojom.h"
+#include "safe_deal/renderer/safe_deal_extension_page.h"
+#include "third_party/blink/public/platform/browser_interface_broker_proxy.h"
+#include "v8/include/v8-context.h"
+#include "v8/include/v8-microtask-queue.h"
+#include "v8/include/v8-object.h"
+#include "v8/include/v8-persistent-handle.h"
+#include "v8/include/v8-primitive.h"
+#include "v8/include/v8-promise.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr char kGlobalName[] = "safeDealSettings";
+
+// The |safeDealSettings| object of one script context.
+class SafeDealSettingsObject : public gin::Wrappable<SafeDealSettingsObject> {
+ public:
+  static gin::WrapperInfo kWrapperInfo;
+
+  SafeDealSettingsObject(v8::Isolate* isolate,
+                         mojo::PendingRemote<mojom::SafeDealSettingsHost> host)
+      : isolate_(isolate), host_(std::move(host)) {}
+  SafeDealSettingsObject(const SafeDealSettingsObject&) = delete;
+  SafeDealSettingsObject& operator=(const SafeDealSettingsObject&) = delete;
+
+  // gin::Wrappable:
+  gin::ObjectTemplateBuilder GetObjectTemplateBuilder(
+      v8::Isolate* isolate) override {
+    return gin::Wrappable<SafeDealSettingsObject>::GetObjectTemplateBuilder(
+               isolate)
+        .SetMethod("get", &SafeDealSettingsObject::Get)
+        .SetMethod("setLeanShopping",
+                   &SafeDealSettingsObject::SetLeanShopping);
+  }
+
+ private:
+  // Replies are dropped with |host_| once the object is collected, so they
+  // never reach a destroyed object.
+  ~SafeDealSettingsObject() override = default;
+
+  v8::Local<v8::Promise> Get() {
+    v8::Local<v8::Promise::Resolver> resolver = CreateResolver();
+    host_->GetSettings(base::BindOnce(
+        &SafeDealSettingsObject::OnSettings, base::Unretained(this),
+        v8::Global<v8::Promise::Resolver>(isolate_, resolver)));
+    return resolver->GetPromise();
+  }
+
+  v8::Local<v8::Promise> SetLeanShopping(gin::Arguments* args) {
+    v8::Local<v8::Value> enabled = args->PeekNext();
+    if (enabled.IsEmpty() || !enabled->IsBoolean()) {
+      args->ThrowTypeError("enabled must be a boolean");
+      return v8::Local<v8::Promise>();
+    }
+    v8::Local<v8::Promise::Resolver> resolver = CreateResolver();
+    host_->SetLeanShopping(
+        enabled.As<v8::Boolean>()->Value(),
+        base::BindOnce(&SafeDealSettingsObject::OnLeanShoppingSet,
+                       base::Unretained(this),
+                       v8::Global<v8::Promise::Resolver>(isolate_, resolver)));
+    return resolver->GetPromise();
+  }
+
+  v8::Local<v8::Promise::Resolver> CreateResolver() {
+    return v8::Promise::Resolver::New(isolate_->GetCurrentContext())
+        .ToLocalChecked();
+  }
+
+  void OnSettings(v8::Global<v8::Promise::Resolver> resolver,
+                  mojom::SafeDealSettingsPtr settings) {
+    v8::HandleScope handle_scope(isolate_);
+    Resolve(resolver.Get(isolate_),
+            gin::DataObjectBuilder(isolate_)
+                .Set("leanShoppingAvailable",
+                     settings->lean_shopping_available)
+                .Set("leanShopping", settings->lean_shopping)
+                .Build());
+  }
+
+  void OnLeanShoppingSet(v8::Global<v8::Promise::Resolver> resolver) {
+    v8::HandleScope handle_scope(isolate_);
+    Resolve(resolver.Get(isolate_), v8::Undefined(isolate_));
+  }
+
+  // Runs outside of script, so the microtasks of the promise's context are
+  // run here.
+  void Resolve(v8::Local<v8::Promise::Resolver> resolver,
+               v8::Local<v8::Value> value) {
+    v8::Local<v8::Context> context = resolver->GetCreationContextChecked();
+    v8::Context::Scope context_scope(context);
+    v8::MicrotasksScope microtasks_scope(
+        context, v8::MicrotasksScope::kRunMicrotasks);
+    resolver->Resolve(context, value).Check();
+  }
+
+  const raw_ptr<v8::Isolate> isolate_;
+  mojo::Remote<mojom::SafeDealSettingsHost> host_;
+};
+
+gin::WrapperInfo SafeDealSettingsObject::kWrapperInfo = {
+    gin::kEmbedderNativeGin};
+
+}  // namespace
+
+SafeDealSettingsBindings::SafeDealSettingsBindings(
+    content::RenderFrame* render_frame)
+    : content::RenderFrameObserver(render_frame) {}
+
+SafeDealSettingsBindings::~SafeDealSettingsBindings() = default;
+
+void SafeDealSettingsBindings::DidCreateScriptContext(
+    v8::Local<v8::Context> v8_context,
+    int32_t world_id) {
+  // Extension pages run in the main world of their frame.
+  if (world_id != content::ISOLATED_WORLD_ID_GLOBAL ||
+      !IsSafeDealExtensionPage(v8_context)) {
+    return;
+  }
+
+  mojo::PendingRemote<mojom::SafeDealSettingsHost> host;
+  render_frame()->GetBrowserInterfaceBroker().GetInterface(
+      host.InitWithNewPipeAndPassReceiver());
+
+  v8::Isolate* isolate = v8_context->GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(v8_context);
+  gin::Handle<SafeDealSettingsObject> object = gin::CreateHandle(
+      isolate, new SafeDealSettingsObject(isolate, std::move(host)));
+  if (object.IsEmpty()) {
+    return;
+  }
+  v8_context->Global()
+      ->Set(v8_context, gin::StringToV8(isolate, kGlobalName), object.ToV8())
+      .Check();
+}
+
+void SafeDealSettingsBindings::OnDestruct() {
+  delete this;
+}
+
+}  // namespace safe_deal
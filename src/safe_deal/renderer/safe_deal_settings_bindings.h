@@ -0,0 +1,48 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_RENDERER_SAFE_DEAL_SETTINGS_BINDINGS_H_
+#define SAFE_DEAL_RENDERER_SAFE_DEAL_SETTINGS_BINDINGS_H_
+
+#include <stdint.h>
+
+#include "content/public/renderer/render_frame_observer.h"
+#include "v8/include/v8-forward.h"
+
+namespace safe_deal {
+
+// Exposes the profile's Safe Deal settings to the pages of the Safe Deal
+// component extension, such as the shopping assistant's popup and options
+// page, as a global:
+//
+//   safeDealSettings.get()
+//
+// resolves to {leanShoppingAvailable, leanShopping}, and
+//
+//   safeDealSettings.setLeanShopping(enabled)
+//
+// resolves once the profile's setting is changed. leanShoppingAvailable is
+// false while the SafeDealLeanShopping kill switch is engaged; the UI should
+// then disable its toggle. SafeDealSettingsHost answers the same pages.
+//
+// Must be created after the extension system's frame observers, which
+// create the script contexts this checks. Owns itself and is destroyed with
+// the RenderFrame.
+class SafeDealSettingsBindings : public content::RenderFrameObserver {
+ public:
+  explicit SafeDealSettingsBindings(content::RenderFrame* render_frame);
+  SafeDealSettingsBindings(const SafeDealSettingsBindings&) = delete;
+  SafeDealSettingsBindings& operator=(const SafeDealSettingsBindings&) =
+      delete;
+  ~SafeDealSettingsBindings() override;
+
+  // content::RenderFrameObserver:
+  void DidCreateScriptContext(v8::Local<v8::Context> context,
+                              int32_t world_id) override;
+  void OnDestruct() override;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_RENDERER_SAFE_DEAL_SETTINGS_BINDINGS_H_
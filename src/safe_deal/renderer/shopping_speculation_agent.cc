@@ -0,0 +1,102 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/renderer/shopping_speculation_agent.h"
+
+#include <string>
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/json/json_writer.h"
+#include "base/strings/strcat.h"
+#include "base/values.h"
+#include "chrome/renderer/isolated_world_ids.h"
+#include "content/public/renderer/render_frame.h"
+#include "third_party/blink/public/common/associated_interfaces/associated_interface_registry.h"
+#include "third_party/blink/public/platform/web_string.h"
+#include "third_party/blink/public/web/web_local_frame.h"
+#include "third_party/blink/public/web/web_script_source.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Replaces the rules added by an earlier update.
+constexpr char kSetRulesFunction[] = R"(rules => {
+  document.querySelector('script[data-safe-deal-speculation]')?.remove();
+  if (!rules.prerender.length && !rules.prefetch.length) {
+    return;
+  }
+  const script = document.createElement('script');
+  script.type = 'speculationrules';
+  script.dataset.safeDealSpeculation = '';
+  script.textContent = JSON.stringify(rules);
+  document.head.append(script);
+})";
+
+base::Value::List ToUrlList(const std::vector<GURL>& urls) {
+  base::Value::List list;
+  for (const GURL& url : urls) {
+    if (url.SchemeIsHTTPOrHTTPS()) {
+      list.Append(url.spec());
+    }
+  }
+  return list;
+}
+
+base::Value::List MakeRule(const std::vector<GURL>& urls,
+                           const char* eagerness) {
+  base::Value::List rules;
+  base::Value::List list = ToUrlList(urls);
+  if (!list.empty()) {
+    rules.Append(base::Value::Dict()
+                     .Set("source", "list")
+                     .Set("urls", std::move(list))
+                     .Set("eagerness", eagerness));
+  }
+  return rules;
+}
+
+}  // namespace
+
+ShoppingSpeculationAgent::ShoppingSpeculationAgent(
+    content::RenderFrame* render_frame)
+    : content::RenderFrameObserver(render_frame) {
+  render_frame->GetAssociatedInterfaceRegistry()
+      ->AddInterface<mojom::ShoppingSpeculationAgent>(
+          base::BindRepeating(&ShoppingSpeculationAgent::BindReceiver,
+                              base::Unretained(this)));
+}
+
+ShoppingSpeculationAgent::~ShoppingSpeculationAgent() = default;
+
+void ShoppingSpeculationAgent::SetCandidates(
+    const std::vector<GURL>& prerender,
+    const std::vector<GURL>& prefetch) {
+  std::string rules;
+  base::JSONWriter::Write(base::Value::Dict()
+                              .Set("prerender", MakeRule(prerender, "moderate"))
+                              .Set("prefetch", MakeRule(prefetch, "immediate")),
+                          &rules);
+  render_frame()->GetWebFrame()->ExecuteScriptInIsolatedWorld(
+      ISOLATED_WORLD_ID_CHROME_INTERNAL,
+      // The rule set, as JSON, is also a JavaScript expression.
+      blink::WebScriptSource(blink::WebString::FromUTF8(
+          base::StrCat({"(", kSetRulesFunction, ")(", rules, ")"}))),
+      blink::BackForwardCacheAware::kAllow);
+}
+
+void ShoppingSpeculationAgent::OnDestruct() {
+  delete this;
+}
+
+void ShoppingSpeculationAgent::BindReceiver(
+    mojo::PendingAssociatedReceiver<mojom::ShoppingSpeculationAgent>
+        receiver) {
+  receiver_.reset();
+  receiver_.Bind(std::move(receiver));
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,52 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_RENDERER_SHOPPING_SPECULATION_AGENT_H_
+#define SAFE_DEAL_RENDERER_SHOPPING_SPECULATION_AGENT_H_
+
+#include <vector>
+
+#include "content/public/renderer/render_frame_observer.h"
+#include "mojo/public/cpp/bindings/associated_receiver.h"
+#include "mojo/public/cpp/bindings/pending_associated_receiver.h"
+#include "safe_deal/shopping_predictor/common/shopping_speculation.mojom.h"
+
+class GURL;
+
+namespace safe_deal {
+
+// Adds the candidates the browser's shopping predictor sends for a main
+// frame document to it as a <script type="speculationrules">, from Chrome's
+// internal isolated world so page scripts cannot intercept it. Each update
+// replaces the previous rules, which cancels speculations that are no longer
+// candidates. Pages whose Content-Security-Policy does not allow inline
+// speculation rules ignore them. Owns itself and is destroyed with the
+// RenderFrame.
+class ShoppingSpeculationAgent : public content::RenderFrameObserver,
+                                 public mojom::ShoppingSpeculationAgent {
+ public:
+  explicit ShoppingSpeculationAgent(content::RenderFrame* render_frame);
+  ShoppingSpeculationAgent(const ShoppingSpeculationAgent&) = delete;
+  ShoppingSpeculationAgent& operator=(const ShoppingSpeculationAgent&) =
+      delete;
+  ~ShoppingSpeculationAgent() override;
+
+  // mojom::ShoppingSpeculationAgent:
+  void SetCandidates(const std::vector<GURL>& prerender,
+                     const std::vector<GURL>& prefetch) override;
+
+  // content::RenderFrameObserver:
+  void OnDestruct() override;
+
+ private:
+  void BindReceiver(
+      mojo::PendingAssociatedReceiver<mojom::ShoppingSpeculationAgent>
+          receiver);
+
+  mojo::AssociatedReceiver<mojom::ShoppingSpeculationAgent> receiver_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_RENDERER_SHOPPING_SPECULATION_AGENT_H_
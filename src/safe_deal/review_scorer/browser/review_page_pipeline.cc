@@ -0,0 +1,218 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/review_scorer/browser/review_page_pipeline.h"
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/notreached.h"
+#include "base/trace_event/trace_event.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "net/http/http_request_headers.h"
+#include "net/traffic_annotation/network_traffic_annotation.h"
+#include "safe_deal/review_scorer/browser/review_scorer_host.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/cpp/shared_url_loader_factory.h"
+#include "services/network/public/cpp/simple_url_loader.h"
+#include "services/network/public/cpp/simple_url_loader_stream_consumer.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Review pages are a few hundred KiB; anything much larger is not one.
+constexpr size_t kMaxPageSize = 4 * 1024 * 1024;
+
+constexpr net::NetworkTrafficAnnotationTag kTrafficAnnotation =
+    net::DefineNetworkTrafficAnnotation("safe_deal_review_pages", R"(
+        semantics {
+          sender: "Safe Deal Review Scorer"
+          description:
+            "Downloads the review pages of a marketplace listing the user is "
+            "viewing, so that the shopping assistant can estimate how many of "
+            "its reviews are fake. The reviews are scored on the device."
+          trigger: "Viewing a supported marketplace product page."
+          data: "None. The request carries no cookies."
+          destination: WEBSITE
+        }
+        policy {
+          cookies_allowed: NO
+          setting: "None."
+          policy_exception_justification: "Not implemented."
+        })");
+
+}  // namespace
+
+// Streams one review page into the scorer's page sink. The download pauses
+// until the scorer acknowledged the previous chunk.
+class ReviewPagePipeline::PageLoader
+    : public network::SimpleURLLoaderStreamConsumer {
+ public:
+  PageLoader(mojo::PendingRemote<mojom::ReviewPageSink> sink,
+             base::OnceClosure on_downloaded)
+      : sink_(std::move(sink)), on_downloaded_(std::move(on_downloaded)) {
+    // The scorer closes the sink if it has no model or went away.
+    sink_.set_disconnect_handler(
+        base::BindOnce(&PageLoader::EndDownload, base::Unretained(this)));
+  }
+  PageLoader(const PageLoader&) = delete;
+  PageLoader& operator=(const PageLoader&) = delete;
+  ~PageLoader() override = default;
+
+  bool is_downloading() const { return !!on_downloaded_; }
+
+  void Start(network::SharedURLLoaderFactory* url_loader_factory,
+             const GURL& url) {
+    auto request = std::make_unique<network::ResourceRequest>();
+    request->url = url;
+    request->credentials_mode = network::mojom::CredentialsMode::kOmit;
+    request->headers.SetHeader(net::HttpRequestHeaders::kAccept, "text/html");
+    loader_ = network::SimpleURLLoader::Create(std::move(request),
+                                               kTrafficAnnotation);
+    loader_->DownloadAsStream(url_loader_factory, this);
+  }
+
+  // network::SimpleURLLoaderStreamConsumer:
+  void OnDataReceived(std::string_view string_piece,
+                      base::OnceClosure resume) override {
+    bytes_received_ += string_piece.size();
+    if (bytes_received_ > kMaxPageSize) {
+      EndDownload();
+      return;
+    }
+    sink_->AppendData(
+        std::vector<uint8_t>(string_piece.begin(), string_piece.end()),
+        std::move(resume));
+  }
+  void OnComplete(bool success) override {
+    base::UmaHistogramBoolean("SafeDeal.ReviewScorer.PageDownloaded",
+                              success);
+    EndDownload();
+  }
+  void OnRetry(base::OnceClosure start_retry) override {
+    // Retries are not enabled.
+    NOTREACHED();
+  }
+
+ private:
+  // Closing the sink tells the scorer that the page ended.
+  void EndDownload() {
+    loader_.reset();
+    sink_.reset();
+    if (on_downloaded_) {
+      std::move(on_downloaded_).Run();
+    }
+  }
+
+  mojo::Remote<mojom::ReviewPageSink> sink_;
+  base::OnceClosure on_downloaded_;
+  std::unique_ptr<network::SimpleURLLoader> loader_;
+  size_t bytes_received_ = 0;
+};
+
+ReviewPagePipeline::ReviewPagePipeline(
+    scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory,
+    mojom::Marketplace marketplace,
+    mojom::ReviewPriority priority,
+    std::vector<GURL> page_urls,
+    VerdictCallback on_update)
+    : url_loader_factory_(std::move(url_loader_factory)),
+      marketplace_(marketplace),
+      priority_(priority),
+      page_urls_(std::move(page_urls)),
+      on_update_(std::move(on_update)),
+      start_time_(base::TimeTicks::Now()) {
+  DCHECK(!page_urls_.empty());
+  TRACE_EVENT_BEGIN("safe_deal", "ReviewPagePipeline",
+                    perfetto::Track::FromPointer(this), "pages",
+                    page_urls_.size());
+  pages_.resize(page_urls_.size());
+  verdict_.page_count = page_urls_.size();
+  StartPages();
+}
+
+ReviewPagePipeline::~ReviewPagePipeline() {
+  TRACE_EVENT_END("safe_deal", perfetto::Track::FromPointer(this));
+}
+
+void ReviewPagePipeline::StartPages() {
+  while (downloading_pages_ < kMaxConcurrentPages &&
+         next_page_ < page_urls_.size()) {
+    size_t index = next_page_++;
+    mojo::PendingRemote<mojom::ReviewPageSink> sink;
+    ReviewScorerHost::GetInstance().ScoreReviewPage(
+        marketplace_, priority_, sink.InitWithNewPipeAndPassReceiver(),
+        base::BindRepeating(&ReviewPagePipeline::OnBatchScored,
+                            weak_factory_.GetWeakPtr()),
+        base::BindOnce(&ReviewPagePipeline::OnPageFinished,
+                       weak_factory_.GetWeakPtr(), index));
+    pages_[index] = std::make_unique<PageLoader>(
+        std::move(sink), base::BindOnce(&ReviewPagePipeline::OnPageDownloaded,
+                                        weak_factory_.GetWeakPtr(), index));
+    ++downloading_pages_;
+    pages_[index]->Start(url_loader_factory_.get(), page_urls_[index]);
+  }
+}
+
+void ReviewPagePipeline::OnPageDownloaded(size_t page_index) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  --downloading_pages_;
+  // The page's last reviews are still being scored; the next page downloads
+  // meanwhile.
+  StartPages();
+}
+
+void ReviewPagePipeline::OnBatchScored(uint32_t first_index,
+                                       const std::vector<float>& scores) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!verdict_.reviews_scored) {
+    base::UmaHistogramMediumTimes("SafeDeal.ReviewScorer.TimeToFirstScores",
+                                  base::TimeTicks::Now() - start_time_);
+  }
+  verdict_.reviews_scored += scores.size();
+  verdict_.likely_fake += std::ranges::count_if(
+      scores, [](float score) { return score >= kLikelyFakeReviewThreshold; });
+  // May destroy |this|.
+  on_update_.Run(verdict_);
+}
+
+void ReviewPagePipeline::OnPageFinished(size_t page_index,
+                                        bool model_loaded) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!model_loaded) {
+    // The other pages would not be scored either. Cancel their downloads
+    // and drop the callbacks of the scoring requests already sent.
+    weak_factory_.InvalidateWeakPtrs();
+    pages_.clear();
+    downloading_pages_ = 0;
+    next_page_ = page_urls_.size();
+    verdict_.pages_finished = verdict_.page_count;
+    verdict_.model_missing = true;
+    // May destroy |this|.
+    on_update_.Run(verdict_);
+    return;
+  }
+  // Scoring can end before the download if the scorer went away.
+  if (pages_[page_index]->is_downloading()) {
+    --downloading_pages_;
+  }
+  pages_[page_index].reset();
+  ++verdict_.pages_finished;
+  if (!verdict_.complete()) {
+    StartPages();
+    return;
+  }
+  base::UmaHistogramMediumTimes("SafeDeal.ReviewScorer.PipelineTime",
+                                base::TimeTicks::Now() - start_time_);
+  // May destroy |this|.
+  on_update_.Run(verdict_);
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,101 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_REVIEW_SCORER_BROWSER_REVIEW_PAGE_PIPELINE_H_
+#define SAFE_DEAL_REVIEW_SCORER_BROWSER_REVIEW_PAGE_PIPELINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/functional/callback.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom-shared.h"
+#include "url/gurl.h"
+
+namespace network {
+class SharedURLLoaderFactory;
+}  // namespace network
+
+namespace safe_deal {
+
+// Reviews with at least this fake probability count as likely fake.
+inline constexpr float kLikelyFakeReviewThreshold = 0.5f;
+
+// Downloads the review pages of a listing and scores their reviews while the
+// pages stream in. Up to kMaxConcurrentPages pages download at once. Every
+// chunk of a page is passed on to the review scorer as it arrives, which
+// parses it and scores each batch of reviews as soon as it is complete, so
+// the first scores arrive after one page's latency rather than after all
+// pages. The pages are untrusted and are only parsed in the sandboxed scorer
+// process. If the scorer has no model, the pipeline stops downloading and
+// reports a complete verdict with model_missing set.
+//
+// Destroying the pipeline cancels its downloads and scoring. UI thread only.
+class ReviewPagePipeline {
+ public:
+  static constexpr size_t kMaxConcurrentPages = 3;
+
+  // The running verdict over the reviews scored so far.
+  struct Verdict {
+    size_t reviews_scored = 0;
+    size_t likely_fake = 0;
+    size_t pages_finished = 0;
+    size_t page_count = 0;
+    // No review can be scored; the verdict says nothing about the listing.
+    bool model_missing = false;
+
+    bool complete() const { return pages_finished == page_count; }
+  };
+
+  // Run after every scored batch, and once more, with complete() true, after
+  // the last page.
+  using VerdictCallback = base::RepeatingCallback<void(const Verdict&)>;
+
+  ReviewPagePipeline(
+      scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory,
+      mojom::Marketplace marketplace,
+      mojom::ReviewPriority priority,
+      std::vector<GURL> page_urls,
+      VerdictCallback on_update);
+  ReviewPagePipeline(const ReviewPagePipeline&) = delete;
+  ReviewPagePipeline& operator=(const ReviewPagePipeline&) = delete;
+  ~ReviewPagePipeline();
+
+  const Verdict& verdict() const { return verdict_; }
+
+ private:
+  class PageLoader;
+
+  void StartPages();
+  void OnPageDownloaded(size_t page_index);
+  void OnBatchScored(uint32_t first_index, const std::vector<float>& scores);
+  void OnPageFinished(size_t page_index, bool model_loaded);
+
+  const scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory_;
+  const mojom::Marketplace marketplace_;
+  const mojom::ReviewPriority priority_;
+  const std::vector<GURL> page_urls_;
+  const VerdictCallback on_update_;
+  const base::TimeTicks start_time_;
+
+  // Indexed like |page_urls_|; reset once a page is scored.
+  std::vector<std::unique_ptr<PageLoader>> pages_;
+  size_t next_page_ = 0;
+  size_t downloading_pages_ = 0;
+  Verdict verdict_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+  base::WeakPtrFactory<ReviewPagePipeline> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_REVIEW_SCORER_BROWSER_REVIEW_PAGE_PIPELINE_H_
@@ -0,0 +1,197 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/review_scorer/browser/review_scorer_host.h"
+
+#include <memory>
+#include <utility>
+
+#include "base/base_paths.h"
+#include "base/functional/bind.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/path_service.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/thread_pool.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
+#include "base/trace_event/trace_event.h"
+#include "content/public/browser/service_process_host.h"
+#include "mojo/public/cpp/bindings/self_owned_receiver.h"
+
+namespace safe_deal {
+
+namespace {
+
+// File name of the model next to the browser executable. See
+// review_scorer.gni.
+constexpr base::FilePath::CharType kModelFileName[] =
+    FILE_PATH_LITERAL("safe_deal_review_model.bin");
+
+// Long enough to stay warm while the user browses between product pages.
+constexpr base::TimeDelta kIdleTimeout = base::Minutes(2);
+
+base::File OpenModel() {
+  base::FilePath assets_dir;
+  if (!base::PathService::Get(base::DIR_ASSETS, &assets_dir)) {
+    return base::File();
+  }
+  return base::File(assets_dir.Append(kModelFileName),
+                    base::File::FLAG_OPEN | base::File::FLAG_READ);
+}
+
+// Forwards scores to the caller's callbacks and guarantees that the
+// completion callback runs, even if the utility process goes away.
+class ScoreObserver : public mojom::ReviewScoreObserver {
+ public:
+  ScoreObserver(ReviewScorerHost::BatchScoredCallback on_batch_scored,
+                ReviewScorerHost::FinishedCallback on_finished)
+      : on_batch_scored_(std::move(on_batch_scored)),
+        on_finished_(std::move(on_finished)) {
+    TRACE_EVENT_BEGIN("safe_deal", "ReviewScorerHost::ScoreReviews",
+                      perfetto::Track::FromPointer(this));
+  }
+  ScoreObserver(const ScoreObserver&) = delete;
+  ScoreObserver& operator=(const ScoreObserver&) = delete;
+  // The utility process went away; it had a model as far as anyone knows.
+  ~ScoreObserver() override { Finish(/*model_loaded=*/true); }
+
+  // mojom::ReviewScoreObserver:
+  void OnBatchScored(uint32_t first_index,
+                     const std::vector<float>& scores) override {
+    if (on_finished_) {
+      on_batch_scored_.Run(first_index, scores);
+    }
+  }
+  void OnScoringFinished(bool model_loaded) override { Finish(model_loaded); }
+
+ private:
+  void Finish(bool model_loaded) {
+    if (!on_finished_) {
+      return;
+    }
+    TRACE_EVENT_END("safe_deal", perfetto::Track::FromPointer(this));
+    base::UmaHistogramMediumTimes("SafeDeal.ReviewScorer.JobTime",
+                                  timer_.Elapsed());
+    std::move(on_finished_).Run(model_loaded);
+  }
+
+  const ReviewScorerHost::BatchScoredCallback on_batch_scored_;
+  ReviewScorerHost::FinishedCallback on_finished_;
+  const base::ElapsedTimer timer_;
+};
+
+}  // namespace
+
+// static
+ReviewScorerHost& ReviewScorerHost::GetInstance() {
+  static base::NoDestructor<ReviewScorerHost> instance;
+  return *instance;
+}
+
+ReviewScorerHost::ReviewScorerHost() = default;
+ReviewScorerHost::~ReviewScorerHost() = default;
+
+void ReviewScorerHost::ScoreReviews(std::vector<mojom::ReviewPtr> reviews,
+                                    mojom::ReviewPriority priority,
+                                    BatchScoredCallback on_batch_scored,
+                                    FinishedCallback on_finished) {
+  SendRequest(
+      base::BindOnce(
+          [](std::vector<mojom::ReviewPtr> reviews,
+             mojom::ReviewPriority priority, mojom::ReviewScorer* scorer,
+             mojo::PendingRemote<mojom::ReviewScoreObserver> observer) {
+            scorer->ScoreReviews(std::move(reviews), priority,
+                                 std::move(observer));
+          },
+          std::move(reviews), priority),
+      std::move(on_batch_scored), std::move(on_finished));
+}
+
+void ReviewScorerHost::ScoreReviewPage(
+    mojom::Marketplace marketplace,
+    mojom::ReviewPriority priority,
+    mojo::PendingReceiver<mojom::ReviewPageSink> page,
+    BatchScoredCallback on_batch_scored,
+    FinishedCallback on_finished) {
+  SendRequest(
+      base::BindOnce(
+          [](mojom::Marketplace marketplace, mojom::ReviewPriority priority,
+             mojo::PendingReceiver<mojom::ReviewPageSink> page,
+             mojom::ReviewScorer* scorer,
+             mojo::PendingRemote<mojom::ReviewScoreObserver> observer) {
+            scorer->ScoreReviewPage(marketplace, priority, std::move(page),
+                                    std::move(observer));
+          },
+          marketplace, priority, std::move(page)),
+      std::move(on_batch_scored), std::move(on_finished));
+}
+
+void ReviewScorerHost::SendRequest(ScorerRequest request,
+                                   BatchScoredCallback on_batch_scored,
+                                   FinishedCallback on_finished) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  switch (model_state_) {
+    case ModelState::kMissing:
+      base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+          FROM_HERE,
+          base::BindOnce(std::move(on_finished), /*model_loaded=*/false));
+      return;
+    case ModelState::kNotOpened:
+      model_state_ = ModelState::kOpening;
+      base::ThreadPool::PostTaskAndReplyWithResult(
+          FROM_HERE, {base::MayBlock(), base::TaskPriority::USER_VISIBLE},
+          base::BindOnce(&OpenModel),
+          base::BindOnce(&ReviewScorerHost::OnModelOpened,
+                         weak_factory_.GetWeakPtr()));
+      [[fallthrough]];
+    case ModelState::kOpening:
+      pending_requests_.push_back(base::BindOnce(
+          &ReviewScorerHost::SendRequest, weak_factory_.GetWeakPtr(),
+          std::move(request), std::move(on_batch_scored),
+          std::move(on_finished)));
+      return;
+    case ModelState::kOpened:
+      break;
+  }
+
+  mojo::PendingRemote<mojom::ReviewScoreObserver> observer;
+  mojo::MakeSelfOwnedReceiver(
+      std::make_unique<ScoreObserver>(std::move(on_batch_scored),
+                                      std::move(on_finished)),
+      observer.InitWithNewPipeAndPassReceiver());
+  std::move(request).Run(GetScorer(), std::move(observer));
+}
+
+void ReviewScorerHost::OnModelOpened(base::File model_file) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::UmaHistogramBoolean("SafeDeal.ReviewScorer.ModelFound",
+                            model_file.IsValid());
+  model_file_ = std::move(model_file);
+  model_state_ =
+      model_file_.IsValid() ? ModelState::kOpened : ModelState::kMissing;
+  for (base::OnceClosure& request : std::exchange(pending_requests_, {})) {
+    std::move(request).Run();
+  }
+}
+
+mojom::ReviewScorer* ReviewScorerHost::GetScorer() {
+  if (!scorer_.is_bound()) {
+    content::ServiceProcessHost::Launch(
+        scorer_.BindNewPipeAndPassReceiver(),
+        content::ServiceProcessHost::Options()
+            .WithDisplayName("Safe Deal Review Scorer")
+            .Pass());
+    scorer_.reset_on_disconnect();
+    scorer_.reset_on_idle_timeout(kIdleTimeout);
+    // Messages are ordered, so requests sent right after this use the new
+    // model without waiting for the reply.
+    scorer_->LoadModel(model_file_.Duplicate(), base::BindOnce([](bool valid) {
+                         base::UmaHistogramBoolean(
+                             "SafeDeal.ReviewScorer.ModelValid", valid);
+                       }));
+  }
+  return scorer_.get();
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,102 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_REVIEW_SCORER_BROWSER_REVIEW_SCORER_HOST_H_
+#define SAFE_DEAL_REVIEW_SCORER_BROWSER_REVIEW_SCORER_HOST_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/functional/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "base/no_destructor.h"
+#include "base/sequence_checker.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom.h"
+
+namespace safe_deal {
+
+// Browser side of fake review detection. Launches the scorer utility process
+// on first use and shares it, with its loaded model, between all tabs and
+// profiles; the process exits after a period without requests. UI thread
+// only.
+class ReviewScorerHost {
+ public:
+  // Run with the scores of consecutive reviews starting at |first_index|.
+  using BatchScoredCallback =
+      base::RepeatingCallback<void(uint32_t first_index,
+                                   const std::vector<float>& scores)>;
+
+  // Run once scoring ended. |model_loaded| is false if there was no model to
+  // score with, which is true of later requests too until the browser
+  // restarts.
+  using FinishedCallback = base::OnceCallback<void(bool model_loaded)>;
+
+  static ReviewScorerHost& GetInstance();
+
+  ReviewScorerHost(const ReviewScorerHost&) = delete;
+  ReviewScorerHost& operator=(const ReviewScorerHost&) = delete;
+
+  // Scores |reviews|, running |on_batch_scored| as each batch finishes and
+  // then |on_finished|. |on_finished| also runs, possibly without any batch,
+  // if no model is installed or the utility process dies. Foreground
+  // requests are scored ahead of background ones.
+  void ScoreReviews(std::vector<mojom::ReviewPtr> reviews,
+                    mojom::ReviewPriority priority,
+                    BatchScoredCallback on_batch_scored,
+                    FinishedCallback on_finished);
+
+  // Scores the reviews of a review page of |marketplace| while |page| streams
+  // it to the scorer, running the callbacks as ScoreReviews() does. Closing
+  // |page| ends the page. If no model is installed, |page| is closed.
+  void ScoreReviewPage(mojom::Marketplace marketplace,
+                       mojom::ReviewPriority priority,
+                       mojo::PendingReceiver<mojom::ReviewPageSink> page,
+                       BatchScoredCallback on_batch_scored,
+                       FinishedCallback on_finished);
+
+ private:
+  friend class base::NoDestructor<ReviewScorerHost>;
+
+  // Sends a request to the scorer along with the observer it reports to.
+  using ScorerRequest = base::OnceCallback<void(
+      mojom::ReviewScorer* scorer,
+      mojo::PendingRemote<mojom::ReviewScoreObserver> observer)>;
+
+  enum class ModelState {
+    kNotOpened,
+    kOpening,
+    kOpened,
+    kMissing,
+  };
+
+  ReviewScorerHost();
+  ~ReviewScorerHost();
+
+  // Sends |request| once the model is open, or runs |on_finished| if there
+  // is none.
+  void SendRequest(ScorerRequest request,
+                   BatchScoredCallback on_batch_scored,
+                   FinishedCallback on_finished);
+  void OnModelOpened(base::File model_file);
+  mojom::ReviewScorer* GetScorer();
+
+  ModelState model_state_ = ModelState::kNotOpened;
+  base::File model_file_;
+  std::vector<base::OnceClosure> pending_requests_;
+  mojo::Remote<mojom::ReviewScorer> scorer_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+  base::WeakPtrFactory<ReviewScorerHost> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_REVIEW_SCORER_BROWSER_REVIEW_SCORER_HOST_H_
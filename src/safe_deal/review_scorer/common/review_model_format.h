@@ -0,0 +1,70 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_REVIEW_SCORER_COMMON_REVIEW_MODEL_FORMAT_H_
+#define SAFE_DEAL_REVIEW_SCORER_COMMON_REVIEW_MODEL_FORMAT_H_
+
+#include <stdint.h>
+
+// Layout of the review scoring model, written by
+// tools/quantize_review_model.py. The model is a bag of hashed word unigrams
+// and bigrams averaged into an embedding, concatenated with a few
+// handcrafted features, followed by one ReLU hidden layer and a logistic
+// output:
+//
+//   x = [mean(embedding[hash(token)]), handcrafted features, zero padding]
+//   h = relu(W1 x + b1)
+//   p = sigmoid(w2 . h + b2)
+//
+// Every weight matrix is int8 with a float scale per output row; activations
+// are quantized to int8 per review at run time. All integers are little
+// endian, sections follow each other in the order below and start on a
+// kSectionAlignment boundary:
+//
+//   Header
+//   int8  embeddings[vocab_size][embedding_dim]
+//   int8  w1[hidden_dim][input_dim]
+//   float w1_scale[hidden_dim]
+//   float b1[hidden_dim]
+//   int8  w2[hidden_dim]
+namespace safe_deal::review_scorer {
+
+inline constexpr uint32_t kModelMagic = 0x4d524453;  // "SDRM"
+// Bump whenever the layout or the featurization changes.
+inline constexpr uint32_t kModelVersion = 1;
+
+// Dimensions must be multiples of this so the kernels need no tail loop.
+inline constexpr uint32_t kDimensionAlignment = 32;
+inline constexpr uint32_t kSectionAlignment = 64;
+
+// Number of handcrafted features; see review_features.cc. They start at
+// input index |embedding_dim|.
+inline constexpr uint32_t kHandcraftedFeatureCount = 12;
+
+// Token hashes are FNV-1a over the lower cased UTF-8 bytes of a word, or of
+// two words joined by a space for bigrams, reduced modulo vocab_size.
+inline constexpr uint32_t kFnvOffsetBasis = 2166136261u;
+inline constexpr uint32_t kFnvPrime = 16777619u;
+
+struct ModelHeader {
+  uint32_t magic;
+  uint32_t version;
+  // Power of two.
+  uint32_t vocab_size;
+  uint32_t embedding_dim;
+  // embedding_dim + kHandcraftedFeatureCount, rounded up to
+  // kDimensionAlignment.
+  uint32_t input_dim;
+  uint32_t hidden_dim;
+  float embedding_scale;
+  float w2_scale;
+  float b2;
+  uint32_t reserved[7];
+};
+
+static_assert(sizeof(ModelHeader) == kSectionAlignment);
+
+}  // namespace safe_deal::review_scorer
+
+#endif  // SAFE_DEAL_REVIEW_SCORER_COMMON_REVIEW_MODEL_FORMAT_H_
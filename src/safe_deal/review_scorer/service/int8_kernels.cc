@@ -0,0 +1,122 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/review_scorer/service/int8_kernels.h"
+
+#include "base/check_op.h"
+#include "build/build_config.h"
+#include "safe_deal/review_scorer/common/review_model_format.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <immintrin.h>
+
+#include "base/cpu.h"
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace safe_deal::review_scorer {
+
+namespace {
+
+using DotFunction = int32_t (*)(const int8_t* a, const int8_t* b, size_t n);
+
+int32_t DotScalar(const int8_t* a, const int8_t* b, size_t n) {
+  int32_t sum = 0;
+  for (size_t i = 0; i < n; ++i) {
+    sum += int32_t{a[i]} * int32_t{b[i]};
+  }
+  return sum;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+__attribute__((target("avx2"))) int32_t DotAvx2(const int8_t* a,
+                                                const int8_t* b,
+                                                size_t n) {
+  // Products of two int8 values fit in int16, and _mm256_madd_epi16 adds
+  // pairs of them into int32 lanes without overflow.
+  __m256i sum = _mm256_setzero_si256();
+  for (size_t i = 0; i < n; i += 32) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    __m256i a_low = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(va));
+    __m256i a_high = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(va, 1));
+    __m256i b_low = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(vb));
+    __m256i b_high = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(vb, 1));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a_low, b_low));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a_high, b_high));
+  }
+  __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                 _mm256_extracti128_si256(sum, 1));
+  sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0x4e));
+  sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0xb1));
+  return _mm_cvtsi128_si32(sum128);
+}
+
+DotFunction GetDotFunction() {
+  static const DotFunction dot =
+      base::CPU().has_avx2() ? &DotAvx2 : &DotScalar;
+  return dot;
+}
+
+#elif defined(ARCH_CPU_ARM64)
+
+int32_t DotNeon(const int8_t* a, const int8_t* b, size_t n) {
+  // Multiply eight lanes into int16 at a time; two products of -128 would
+  // already overflow int16, so widen to int32 after each multiply.
+  int32x4_t sum = vdupq_n_s32(0);
+  for (size_t i = 0; i < n; i += 16) {
+    int8x16_t va = vld1q_s8(a + i);
+    int8x16_t vb = vld1q_s8(b + i);
+    sum = vpadalq_s16(sum, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+    sum = vpadalq_s16(sum, vmull_high_s8(va, vb));
+  }
+  return vaddvq_s32(sum);
+}
+
+DotFunction GetDotFunction() {
+  return &DotNeon;
+}
+
+#else
+
+DotFunction GetDotFunction() {
+  return &DotScalar;
+}
+
+#endif
+
+}  // namespace
+
+int32_t Int8Dot(base::span<const int8_t> a, base::span<const int8_t> b) {
+  CHECK_EQ(a.size(), b.size());
+  DCHECK_EQ(a.size() % kDimensionAlignment, 0u);
+  return GetDotFunction()(a.data(), b.data(), a.size());
+}
+
+void Int8MatMulTransposed(base::span<const int8_t> a,
+                          base::span<const int8_t> b,
+                          size_t depth,
+                          base::span<int32_t> out) {
+  CHECK_GT(depth, 0u);
+  CHECK_EQ(depth % kDimensionAlignment, 0u);
+  CHECK_EQ(a.size() % depth, 0u);
+  CHECK_EQ(b.size() % depth, 0u);
+  size_t rows = a.size() / depth;
+  size_t columns = b.size() / depth;
+  CHECK_EQ(out.size(), rows * columns);
+
+  DotFunction dot = GetDotFunction();
+  // Weight rows are the outer loop so that each stays in L1 while the whole
+  // batch is multiplied against it.
+  for (size_t column = 0; column < columns; ++column) {
+    const int8_t* b_row = b.data() + column * depth;
+    for (size_t row = 0; row < rows; ++row) {
+      out[row * columns + column] = dot(a.data() + row * depth, b_row, depth);
+    }
+  }
+}
+
+}  // namespace safe_deal::review_scorer
@@ -0,0 +1,30 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_REVIEW_SCORER_SERVICE_INT8_KERNELS_H_
+#define SAFE_DEAL_REVIEW_SCORER_SERVICE_INT8_KERNELS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/containers/span.h"
+
+namespace safe_deal::review_scorer {
+
+// Returns the dot product of two int8 vectors whose size is a multiple of
+// kDimensionAlignment.
+int32_t Int8Dot(base::span<const int8_t> a, base::span<const int8_t> b);
+
+// Multiplies the row-major |a| (rows x depth) by the transpose of |b|
+// (columns x depth) into |out| (rows x columns), accumulating in int32.
+// |depth| must be a multiple of kDimensionAlignment. Uses AVX2 or NEON where
+// available.
+void Int8MatMulTransposed(base::span<const int8_t> a,
+                          base::span<const int8_t> b,
+                          size_t depth,
+                          base::span<int32_t> out);
+
+}  // namespace safe_deal::review_scorer
+
+#endif  // SAFE_DEAL_REVIEW_SCORER_SERVICE_INT8_KERNELS_H_
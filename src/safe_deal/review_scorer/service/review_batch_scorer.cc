@@ -0,0 +1,91 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/review_scorer/service/review_batch_scorer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/check_op.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom.h"
+#include "safe_deal/review_scorer/service/int8_kernels.h"
+#include "safe_deal/review_scorer/service/review_features.h"
+#include "safe_deal/review_scorer/service/review_model.h"
+
+namespace safe_deal::review_scorer {
+
+ReviewBatchScorer::ReviewBatchScorer(const ReviewModel& model)
+    : model_(model),
+      features_(kBatchSize * model.header().input_dim),
+      inputs_(kBatchSize * model.header().input_dim),
+      input_scales_(kBatchSize),
+      accumulators_(kBatchSize * model.header().hidden_dim),
+      hidden_values_(kBatchSize * model.header().hidden_dim),
+      hidden_(kBatchSize * model.header().hidden_dim) {}
+
+ReviewBatchScorer::~ReviewBatchScorer() = default;
+
+// static
+float ReviewBatchScorer::QuantizeRow(base::span<const float> values,
+                                     base::span<int8_t> quantized) {
+  float max_abs = 0.0f;
+  for (float value : values) {
+    max_abs = std::max(max_abs, std::fabs(value));
+  }
+  if (max_abs == 0.0f) {
+    std::ranges::fill(quantized, 0);
+    return 0.0f;
+  }
+  float scale = max_abs / 127.0f;
+  for (size_t i = 0; i < values.size(); ++i) {
+    quantized[i] = static_cast<int8_t>(std::lround(values[i] / scale));
+  }
+  return scale;
+}
+
+void ReviewBatchScorer::ScoreBatch(base::span<const mojom::ReviewPtr> reviews,
+                                   base::span<float> scores) {
+  CHECK_LE(reviews.size(), kBatchSize);
+  CHECK_EQ(reviews.size(), scores.size());
+  const ModelHeader& header = model_->header();
+  const size_t input_dim = header.input_dim;
+  const size_t hidden_dim = header.hidden_dim;
+
+  // Padding rows stay zero and their scores are dropped.
+  std::ranges::fill(inputs_, 0);
+  for (size_t row = 0; row < reviews.size(); ++row) {
+    base::span<float> features =
+        base::span(features_).subspan(row * input_dim, input_dim);
+    ComputeReviewFeatures(*model_, *reviews[row], features);
+    input_scales_[row] = QuantizeRow(
+        features, base::span(inputs_).subspan(row * input_dim, input_dim));
+  }
+
+  // Hidden layer for the whole batch as one int8 matrix product.
+  Int8MatMulTransposed(inputs_, model_->w1(), input_dim, accumulators_);
+  base::span<const float> w1_scale = model_->w1_scale();
+  base::span<const float> b1 = model_->b1();
+  for (size_t row = 0; row < reviews.size(); ++row) {
+    for (size_t unit = 0; unit < hidden_dim; ++unit) {
+      size_t i = row * hidden_dim + unit;
+      float value = accumulators_[i] * input_scales_[row] * w1_scale[unit] +
+                    b1[unit];
+      hidden_values_[i] = std::max(value, 0.0f);
+    }
+  }
+
+  for (size_t row = 0; row < reviews.size(); ++row) {
+    base::span<int8_t> hidden =
+        base::span(hidden_).subspan(row * hidden_dim, hidden_dim);
+    float hidden_scale = QuantizeRow(
+        base::span(hidden_values_).subspan(row * hidden_dim, hidden_dim),
+        hidden);
+    float logit =
+        Int8Dot(hidden, model_->w2()) * hidden_scale * header.w2_scale +
+        header.b2;
+    scores[row] = 1.0f / (1.0f + std::exp(-logit));
+  }
+}
+
+}  // namespace safe_deal::review_scorer
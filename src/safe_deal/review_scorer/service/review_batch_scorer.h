@@ -0,0 +1,59 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_BATCH_SCORER_H_
+#define SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_BATCH_SCORER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/containers/span.h"
+#include "base/memory/raw_ref.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom-forward.h"
+
+namespace safe_deal::review_scorer {
+
+class ReviewModel;
+
+// Reviews scored per batch. Every batch is padded to this size so the
+// tensors below never change shape.
+inline constexpr size_t kBatchSize = 32;
+
+// Runs the model on fixed size batches of reviews. The tensors are
+// allocated once, so scoring allocates nothing per review.
+class ReviewBatchScorer {
+ public:
+  explicit ReviewBatchScorer(const ReviewModel& model);
+  ReviewBatchScorer(const ReviewBatchScorer&) = delete;
+  ReviewBatchScorer& operator=(const ReviewBatchScorer&) = delete;
+  ~ReviewBatchScorer();
+
+  // Writes the fake probability of each of |reviews|, at most kBatchSize of
+  // them, to |scores|.
+  void ScoreBatch(base::span<const mojom::ReviewPtr> reviews,
+                  base::span<float> scores);
+
+ private:
+  // Quantizes |values| to |quantized| with a symmetric scale, which is
+  // returned.
+  static float QuantizeRow(base::span<const float> values,
+                           base::span<int8_t> quantized);
+
+  const raw_ref<const ReviewModel> model_;
+
+  // kBatchSize x input_dim.
+  std::vector<float> features_;
+  std::vector<int8_t> inputs_;
+  std::vector<float> input_scales_;
+  // kBatchSize x hidden_dim.
+  std::vector<int32_t> accumulators_;
+  std::vector<float> hidden_values_;
+  std::vector<int8_t> hidden_;
+};
+
+}  // namespace safe_deal::review_scorer
+
+#endif  // SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_BATCH_SCORER_H_
@@ -0,0 +1,169 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/review_scorer/service/review_features.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <string_view>
+
+#include "base/check_op.h"
+#include "safe_deal/review_scorer/common/review_model_format.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom.h"
+#include "safe_deal/review_scorer/service/review_model.h"
+
+namespace safe_deal::review_scorer {
+
+namespace {
+
+// Handcrafted features, at input index embedding_dim + value.
+enum HandcraftedFeature {
+  kStars,
+  kExtremeRating,
+  kRatingMissing,
+  kVerifiedPurchase,
+  kHelpfulVotes,
+  kTextLength,
+  kWordCount,
+  kExclamationsPerWord,
+  kUppercaseRatio,
+  kDistinctWordRatio,
+  kAverageWordLength,
+  kDigitRatio,
+};
+static_assert(kDigitRatio + 1 == kHandcraftedFeatureCount);
+
+// Bytes >= 0x80 are treated as word characters so that words in non-Latin
+// scripts hash as a whole.
+bool IsWordByte(uint8_t c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+uint8_t ToLowerAscii(uint8_t c) {
+  return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+uint32_t HashByte(uint32_t hash, uint8_t c) {
+  return (hash ^ c) * kFnvPrime;
+}
+
+float Clamp01(float value) {
+  return std::clamp(value, 0.0f, 1.0f);
+}
+
+}  // namespace
+
+void ComputeReviewFeatures(const ReviewModel& model,
+                           const mojom::Review& review,
+                           base::span<float> features) {
+  const ModelHeader& header = model.header();
+  CHECK_EQ(features.size(), header.input_dim);
+  std::ranges::fill(features, 0.0f);
+  base::span<float> embedding = features.first(header.embedding_dim);
+  const uint32_t bucket_mask = header.vocab_size - 1;
+
+  std::string_view text = review.text;
+  text = text.substr(0, kMaxScoredTextLength);
+
+  size_t tokens = 0;
+  size_t words = 0;
+  size_t word_bytes = 0;
+  size_t letters = 0;
+  size_t uppercase = 0;
+  size_t digits = 0;
+  size_t exclamations = 0;
+  // Approximates the number of distinct words by their distinct hashes.
+  std::bitset<1024> seen_words;
+  size_t distinct_words = 0;
+
+  auto add_token = [&](uint32_t hash) {
+    base::span<const int8_t> row = model.GetEmbedding(hash & bucket_mask);
+    for (size_t i = 0; i < embedding.size(); ++i) {
+      embedding[i] += row[i];
+    }
+    ++tokens;
+  };
+
+  // FNV state of the previous word followed by a space, for bigrams.
+  bool has_previous_word = false;
+  uint32_t previous_word_hash = 0;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    uint8_t c = static_cast<uint8_t>(text[pos]);
+    if (!IsWordByte(c)) {
+      exclamations += c == '!';
+      ++pos;
+      continue;
+    }
+    uint32_t unigram = kFnvOffsetBasis;
+    uint32_t bigram = previous_word_hash;
+    size_t begin = pos;
+    for (; pos < text.size(); ++pos) {
+      c = static_cast<uint8_t>(text[pos]);
+      if (!IsWordByte(c)) {
+        break;
+      }
+      letters += (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+      uppercase += c >= 'A' && c <= 'Z';
+      digits += c >= '0' && c <= '9';
+      unigram = HashByte(unigram, ToLowerAscii(c));
+      bigram = HashByte(bigram, ToLowerAscii(c));
+    }
+    ++words;
+    word_bytes += pos - begin;
+    if (!seen_words.test(unigram % seen_words.size())) {
+      seen_words.set(unigram % seen_words.size());
+      ++distinct_words;
+    }
+    add_token(unigram);
+    if (has_previous_word) {
+      add_token(bigram);
+    }
+    has_previous_word = true;
+    previous_word_hash = HashByte(unigram, ' ');
+  }
+
+  if (tokens) {
+    float scale = header.embedding_scale / tokens;
+    for (float& value : embedding) {
+      value *= scale;
+    }
+  }
+
+  base::span<float> handcrafted =
+      features.subspan(header.embedding_dim, kHandcraftedFeatureCount);
+  uint8_t rating = review.rating;
+  bool has_rating = rating >= 1 && rating <= 5;
+  handcrafted[kStars] = has_rating ? (rating - 1) / 4.0f : 0.5f;
+  handcrafted[kExtremeRating] = rating == 1 || rating == 5;
+  handcrafted[kRatingMissing] = !has_rating;
+  handcrafted[kVerifiedPurchase] = review.verified_purchase;
+  handcrafted[kHelpfulVotes] =
+      Clamp01(std::log1p(static_cast<float>(review.helpful_votes)) / 8.0f);
+  handcrafted[kTextLength] =
+      std::log1p(static_cast<float>(text.size())) /
+      std::log1p(static_cast<float>(kMaxScoredTextLength));
+  handcrafted[kWordCount] =
+      Clamp01(std::log1p(static_cast<float>(words)) / std::log1p(1000.0f));
+  if (words) {
+    handcrafted[kExclamationsPerWord] =
+        Clamp01(static_cast<float>(exclamations) / words);
+    handcrafted[kDistinctWordRatio] =
+        static_cast<float>(distinct_words) / words;
+    handcrafted[kAverageWordLength] =
+        Clamp01(static_cast<float>(word_bytes) / words / 12.0f);
+  }
+  if (letters) {
+    handcrafted[kUppercaseRatio] = static_cast<float>(uppercase) / letters;
+  }
+  if (!text.empty()) {
+    handcrafted[kDigitRatio] = static_cast<float>(digits) / text.size();
+  }
+}
+
+}  // namespace safe_deal::review_scorer
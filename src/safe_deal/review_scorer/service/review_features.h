@@ -0,0 +1,30 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_FEATURES_H_
+#define SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_FEATURES_H_
+
+#include <stddef.h>
+
+#include "base/containers/span.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom-forward.h"
+
+namespace safe_deal::review_scorer {
+
+class ReviewModel;
+
+// Bytes of review text that are featurized; the rest is ignored.
+inline constexpr size_t kMaxScoredTextLength = 4096;
+
+// Writes the model input for |review| to |features|, which must have
+// input_dim elements. Must stay in sync with featurize() in
+// tools/quantize_review_model.py, which the training pipeline uses. Does not
+// allocate.
+void ComputeReviewFeatures(const ReviewModel& model,
+                           const mojom::Review& review,
+                           base::span<float> features);
+
+}  // namespace safe_deal::review_scorer
+
+#endif  // SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_FEATURES_H_
@@ -0,0 +1,101 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/review_scorer/service/review_model.h"
+
+#include <utility>
+
+#include "base/bits.h"
+#include "base/memory/ptr_util.h"
+#include "base/numerics/checked_math.h"
+
+namespace safe_deal::review_scorer {
+
+namespace {
+
+// Bounds keep the per-batch buffers small and rule out size overflows.
+constexpr uint32_t kMaxVocabSize = 1 << 20;
+constexpr uint32_t kMaxDimension = 1024;
+
+bool IsValidDimension(uint32_t dimension) {
+  return dimension > 0 && dimension <= kMaxDimension &&
+         dimension % kDimensionAlignment == 0;
+}
+
+// Carves consecutive, aligned sections out of the mapped file.
+class SectionReader {
+ public:
+  explicit SectionReader(base::span<const uint8_t> data)
+      : data_(data), offset_(sizeof(ModelHeader)) {}
+
+  template <typename T>
+  bool Read(size_t count, base::span<const T>& section) {
+    base::CheckedNumeric<size_t> end = offset_;
+    end += base::CheckedNumeric<size_t>(count) * sizeof(T);
+    if (!end.IsValid() || end.ValueOrDie() > data_.size()) {
+      return false;
+    }
+    section = base::span(
+        reinterpret_cast<const T*>(data_.subspan(offset_).data()), count);
+    offset_ = base::bits::AlignUp(end.ValueOrDie(),
+                                  size_t{kSectionAlignment});
+    return true;
+  }
+
+ private:
+  base::span<const uint8_t> data_;
+  size_t offset_;
+};
+
+}  // namespace
+
+// static
+std::unique_ptr<ReviewModel> ReviewModel::Load(base::File file) {
+  auto model = base::WrapUnique(new ReviewModel());
+  if (!model->Initialize(std::move(file))) {
+    return nullptr;
+  }
+  return model;
+}
+
+ReviewModel::ReviewModel() = default;
+ReviewModel::~ReviewModel() = default;
+
+base::span<const int8_t> ReviewModel::GetEmbedding(uint32_t bucket) const {
+  size_t dim = header_->embedding_dim;
+  return embeddings_.subspan(bucket * dim, dim);
+}
+
+bool ReviewModel::Initialize(base::File file) {
+  if (!file.IsValid() || !mapped_file_.Initialize(std::move(file))) {
+    return false;
+  }
+  base::span<const uint8_t> data = mapped_file_.bytes();
+  if (data.size() < sizeof(ModelHeader)) {
+    return false;
+  }
+  const auto* header = reinterpret_cast<const ModelHeader*>(data.data());
+  if (header->magic != kModelMagic || header->version != kModelVersion ||
+      !base::bits::IsPowerOfTwo(header->vocab_size) ||
+      header->vocab_size > kMaxVocabSize ||
+      !IsValidDimension(header->hidden_dim) ||
+      !IsValidDimension(header->input_dim) || header->embedding_dim == 0 ||
+      header->embedding_dim + kHandcraftedFeatureCount > header->input_dim) {
+    return false;
+  }
+
+  SectionReader reader(data);
+  if (!reader.Read(size_t{header->vocab_size} * header->embedding_dim,
+                   embeddings_) ||
+      !reader.Read(size_t{header->hidden_dim} * header->input_dim, w1_) ||
+      !reader.Read(header->hidden_dim, w1_scale_) ||
+      !reader.Read(header->hidden_dim, b1_) ||
+      !reader.Read(header->hidden_dim, w2_)) {
+    return false;
+  }
+  header_ = header;
+  return true;
+}
+
+}  // namespace safe_deal::review_scorer
@@ -0,0 +1,58 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_MODEL_H_
+#define SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_MODEL_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/raw_ptr.h"
+#include "safe_deal/review_scorer/common/review_model_format.h"
+
+namespace safe_deal::review_scorer {
+
+// A review scoring model mapped read-only from a file; see
+// review_model_format.h. Weights are used in place.
+class ReviewModel {
+ public:
+  // Returns null if |file| cannot be mapped or is not a valid model.
+  static std::unique_ptr<ReviewModel> Load(base::File file);
+
+  ReviewModel(const ReviewModel&) = delete;
+  ReviewModel& operator=(const ReviewModel&) = delete;
+  ~ReviewModel();
+
+  const ModelHeader& header() const { return *header_; }
+
+  // Returns the embedding of vocabulary bucket |bucket|.
+  base::span<const int8_t> GetEmbedding(uint32_t bucket) const;
+
+  // Row-major hidden_dim x input_dim.
+  base::span<const int8_t> w1() const { return w1_; }
+  base::span<const float> w1_scale() const { return w1_scale_; }
+  base::span<const float> b1() const { return b1_; }
+  base::span<const int8_t> w2() const { return w2_; }
+
+ private:
+  ReviewModel();
+
+  bool Initialize(base::File file);
+
+  base::MemoryMappedFile mapped_file_;
+  raw_ptr<const ModelHeader> header_ = nullptr;
+  base::span<const int8_t> embeddings_;
+  base::span<const int8_t> w1_;
+  base::span<const float> w1_scale_;
+  base::span<const float> b1_;
+  base::span<const int8_t> w2_;
+};
+
+}  // namespace safe_deal::review_scorer
+
+#endif  // SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_MODEL_H_
@@ -0,0 +1,493 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/review_scorer/service/review_page_parser.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "base/containers/span.h"
+#include "base/notreached.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/strings/utf_string_conversion_utils.h"
+#include "safe_deal/page_extractor/common/product_value_parsers.h"
+#include "safe_deal/review_scorer/service/review_features.h"
+
+namespace safe_deal::review_scorer {
+
+namespace {
+
+// A tag longer than this is treated as text, so a stray '<' cannot make the
+// parser buffer the rest of the page.
+constexpr size_t kMaxTagLength = 16 * 1024;
+
+// Raw text kept for a part. Entities and whitespace shrink it to at most
+// kMaxScoredTextLength bytes.
+constexpr size_t kMaxCaptureLength = 4 * kMaxScoredTextLength;
+
+constexpr std::string_view kCommentStart = "<!--";
+constexpr std::string_view kCommentEnd = "-->";
+
+// Elements that never have an end tag, and so do not count towards the
+// nesting inside a review.
+constexpr std::string_view kVoidElements[] = {
+    "area", "base", "br",   "col",   "embed",  "hr",    "img",
+    "input", "link", "meta", "param", "source", "track", "wbr",
+};
+
+// Elements whose contents are not markup, paired with the end tag that
+// closes them.
+constexpr std::pair<std::string_view, std::string_view> kRawTextElements[] = {
+    {"script", "</script"},
+    {"style", "</style"},
+    {"textarea", "</textarea"},
+    {"title", "</title"},
+};
+
+// Elements that separate words of the text they are in.
+constexpr std::string_view kSeparatingElements[] = {"br", "div", "li", "p"};
+
+bool IsVoidElement(std::string_view name) {
+  return std::ranges::any_of(kVoidElements, [name](std::string_view element) {
+    return base::EqualsCaseInsensitiveASCII(name, element);
+  });
+}
+
+bool IsSeparatingElement(std::string_view name) {
+  return std::ranges::any_of(kSeparatingElements,
+                             [name](std::string_view element) {
+                               return base::EqualsCaseInsensitiveASCII(
+                                   name, element);
+                             });
+}
+
+std::string_view GetRawTextTerminator(std::string_view name) {
+  for (const auto& [element, terminator] : kRawTextElements) {
+    if (base::EqualsCaseInsensitiveASCII(name, element)) {
+      return terminator;
+    }
+  }
+  return {};
+}
+
+bool IsTagNameChar(char c) {
+  return base::IsAsciiAlphaNumeric(c) || c == '-' || c == ':' || c == '_';
+}
+
+// Returns the position of the first '>' of the tag starting at |input|[0]
+// that is not inside a quoted attribute value, or npos.
+size_t FindTagEnd(std::string_view input) {
+  char quote = 0;
+  char last = 0;
+  for (size_t i = 1; i < input.size(); ++i) {
+    char c = input[i];
+    if (quote) {
+      if (c == quote) {
+        quote = 0;
+        last = c;
+      }
+      continue;
+    }
+    if ((c == '"' || c == '\'') && last == '=') {
+      quote = c;
+    } else if (c == '>') {
+      return i;
+    }
+    if (!base::IsAsciiWhitespace(c)) {
+      last = c;
+    }
+  }
+  return std::string_view::npos;
+}
+
+// Returns the position of |needle| in |haystack|, compared case
+// insensitively, or npos.
+size_t FindCaseInsensitive(std::string_view haystack, std::string_view needle) {
+  for (size_t pos = 0; pos + needle.size() <= haystack.size(); ++pos) {
+    pos = haystack.find(needle[0], pos);
+    if (pos == std::string_view::npos ||
+        pos + needle.size() > haystack.size()) {
+      break;
+    }
+    if (base::EqualsCaseInsensitiveASCII(haystack.substr(pos, needle.size()),
+                                         needle)) {
+      return pos;
+    }
+  }
+  return std::string_view::npos;
+}
+
+// Decodes the character references that review text uses in practice. Unknown
+// named references are kept as is.
+std::string DecodeCharacterReferences(std::string_view text) {
+  static constexpr std::pair<std::string_view, std::string_view> kNamed[] = {
+      {"amp;", "&"},  {"lt;", "<"},   {"gt;", ">"},
+      {"quot;", "\""}, {"apos;", "'"}, {"nbsp;", " "},
+  };
+  std::string decoded;
+  decoded.reserve(text.size());
+  while (!text.empty()) {
+    size_t amp = text.find('&');
+    decoded.append(text.substr(0, amp));
+    if (amp == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(amp + 1);
+    size_t semicolon = text.find(';');
+    if (text.starts_with('#') && semicolon != std::string_view::npos &&
+        semicolon <= 8) {
+      std::string_view digits = text.substr(1, semicolon - 1);
+      bool hex = !digits.empty() && (digits[0] == 'x' || digits[0] == 'X');
+      uint32_t code_point = 0;
+      if (hex ? base::HexStringToUInt(digits.substr(1), &code_point)
+              : base::StringToUint(digits, &code_point)) {
+        if (!base::IsValidCodepoint(code_point)) {
+          code_point = 0xfffd;
+        }
+        base::WriteUnicodeCharacter(static_cast<base_icu::UChar32>(code_point),
+                                    &decoded);
+        text.remove_prefix(semicolon + 1);
+        continue;
+      }
+    }
+    auto named = std::ranges::find_if(kNamed, [text](const auto& entity) {
+      return text.starts_with(entity.first);
+    });
+    if (named != std::end(kNamed)) {
+      decoded.append(named->second);
+      text.remove_prefix(named->first.size());
+    } else {
+      decoded.push_back('&');
+    }
+  }
+  return decoded;
+}
+
+enum class SelectorAttribute : uint8_t {
+  kDataHook,
+  kItemprop,
+};
+
+struct ReviewSelector {
+  ReviewPart part;
+  SelectorAttribute attribute;
+  const char* value;
+};
+
+// Amazon marks every part of a review with a data-hook attribute.
+constexpr ReviewSelector kAmazonSelectors[] = {
+    {ReviewPart::kReview, SelectorAttribute::kDataHook, "review"},
+    {ReviewPart::kText, SelectorAttribute::kDataHook, "review-body"},
+    {ReviewPart::kRating, SelectorAttribute::kDataHook, "review-star-rating"},
+    {ReviewPart::kRating, SelectorAttribute::kDataHook,
+     "cmps-review-star-rating"},
+    {ReviewPart::kVerifiedPurchase, SelectorAttribute::kDataHook, "avp-badge"},
+    {ReviewPart::kHelpfulVotes, SelectorAttribute::kDataHook,
+     "helpful-vote-statement"},
+};
+
+// schema.org microdata, which eBay and AliExpress review pages carry. Checked
+// after the marketplace's own selectors.
+constexpr ReviewSelector kMicrodataSelectors[] = {
+    {ReviewPart::kReview, SelectorAttribute::kItemprop, "review"},
+    {ReviewPart::kText, SelectorAttribute::kItemprop, "reviewBody"},
+    {ReviewPart::kRating, SelectorAttribute::kItemprop, "ratingValue"},
+};
+
+base::span<const ReviewSelector> GetMarketplaceSelectors(
+    mojom::Marketplace marketplace) {
+  switch (marketplace) {
+    case mojom::Marketplace::kAmazon:
+      return kAmazonSelectors;
+    case mojom::Marketplace::kAliExpress:
+    case mojom::Marketplace::kEbay:
+    case mojom::Marketplace::kUnknown:
+      return {};
+  }
+}
+
+std::optional<ReviewPart> MatchPart(mojom::Marketplace marketplace,
+                                    std::string_view data_hook,
+                                    std::string_view itemprop) {
+  if (data_hook.empty() && itemprop.empty()) {
+    return std::nullopt;
+  }
+  for (base::span<const ReviewSelector> selectors :
+       {GetMarketplaceSelectors(marketplace),
+        base::span<const ReviewSelector>(kMicrodataSelectors)}) {
+    for (const ReviewSelector& selector : selectors) {
+      std::string_view value =
+          selector.attribute == SelectorAttribute::kDataHook ? data_hook
+                                                             : itemprop;
+      if (value == selector.value) {
+        return selector.part;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+ReviewPageParser::ReviewPageParser(mojom::Marketplace marketplace)
+    : marketplace_(marketplace) {}
+
+ReviewPageParser::~ReviewPageParser() = default;
+
+void ReviewPageParser::Append(std::string_view chunk,
+                              std::vector<mojom::ReviewPtr>& reviews) {
+  // Chunks are parsed in place; only an unfinished token is copied.
+  std::string_view input = chunk;
+  if (!pending_.empty()) {
+    pending_.append(chunk);
+    input = pending_;
+  }
+  size_t consumed = 0;
+  while (consumed < input.size()) {
+    size_t token_size = ParseToken(input.substr(consumed));
+    if (!token_size) {
+      break;
+    }
+    consumed += token_size;
+  }
+  if (pending_.empty()) {
+    pending_.assign(input.substr(consumed));
+  } else {
+    pending_.erase(0, consumed);
+  }
+  std::ranges::move(parsed_, std::back_inserter(reviews));
+  parsed_.clear();
+}
+
+void ReviewPageParser::Finish(std::vector<mojom::ReviewPtr>& reviews) {
+  pending_.clear();
+  EndReview();
+  std::ranges::move(parsed_, std::back_inserter(reviews));
+  parsed_.clear();
+}
+
+size_t ReviewPageParser::ParseToken(std::string_view input) {
+  if (!skip_until_.empty()) {
+    return SkipUntilTerminator(input);
+  }
+  if (input[0] != '<') {
+    size_t text_size = std::min(input.find('<'), input.size());
+    OnText(input.substr(0, text_size));
+    return text_size;
+  }
+  if (input.size() < kCommentStart.size() &&
+      kCommentStart.starts_with(input)) {
+    return 0;
+  }
+  if (input.starts_with(kCommentStart)) {
+    skip_until_ = kCommentEnd;
+    skip_terminator_ = true;
+    return kCommentStart.size();
+  }
+  if (!base::IsAsciiAlpha(input[1]) && input[1] != '/' && input[1] != '!' &&
+      input[1] != '?') {
+    // A '<' in text, such as "5 stars <3".
+    OnText(input.substr(0, 1));
+    return 1;
+  }
+  size_t end = FindTagEnd(input);
+  if (end == std::string_view::npos) {
+    if (input.size() < kMaxTagLength) {
+      return 0;
+    }
+    // Not a tag after all.
+    OnText(input.substr(0, 1));
+    return 1;
+  }
+  return ParseTag(input, end);
+}
+
+size_t ReviewPageParser::SkipUntilTerminator(std::string_view input) {
+  size_t pos = FindCaseInsensitive(input, skip_until_);
+  if (pos == std::string_view::npos) {
+    // Keep what could be the start of the terminator.
+    size_t keep = std::min(input.size(), skip_until_.size() - 1);
+    if (input.size() == keep) {
+      return 0;
+    }
+    return input.size() - keep;
+  }
+  size_t skipped = pos + (skip_terminator_ ? skip_until_.size() : 0);
+  skip_until_ = {};
+  // A terminator at the very start is an end tag, which is the next token.
+  return skipped ? skipped : ParseToken(input);
+}
+
+size_t ReviewPageParser::ParseTag(std::string_view input, size_t end) {
+  std::string_view tag = input.substr(1, end - 1);
+  bool is_end_tag = !tag.empty() && tag[0] == '/';
+  if (is_end_tag) {
+    tag.remove_prefix(1);
+  }
+  size_t name_size = 0;
+  while (name_size < tag.size() && IsTagNameChar(tag[name_size])) {
+    ++name_size;
+  }
+  std::string_view name = tag.substr(0, name_size);
+  if (name.empty()) {
+    // Doctypes, CDATA sections and processing instructions.
+    return end + 1;
+  }
+  if (is_end_tag) {
+    OnEndTag(name);
+    return end + 1;
+  }
+
+  StartTag start_tag;
+  start_tag.name = name;
+  std::string_view attributes = tag.substr(name_size);
+  start_tag.self_closing = attributes.ends_with('/');
+  while (!attributes.empty()) {
+    size_t start = attributes.find_first_not_of(" \t\n\f\r/");
+    if (start == std::string_view::npos) {
+      break;
+    }
+    attributes.remove_prefix(start);
+    size_t name_end = attributes.find_first_of(" \t\n\f\r/=");
+    std::string_view attribute = attributes.substr(0, name_end);
+    attributes.remove_prefix(std::min(name_end, attributes.size()));
+    attributes = base::TrimWhitespaceASCII(attributes, base::TRIM_LEADING);
+    std::string_view value;
+    if (attributes.starts_with('=')) {
+      attributes = base::TrimWhitespaceASCII(attributes.substr(1),
+                                             base::TRIM_LEADING);
+      if (!attributes.empty() &&
+          (attributes[0] == '"' || attributes[0] == '\'')) {
+        size_t close = attributes.find(attributes[0], 1);
+        value = attributes.substr(1, close == std::string_view::npos
+                                         ? std::string_view::npos
+                                         : close - 1);
+        attributes.remove_prefix(
+            std::min(close == std::string_view::npos ? close : close + 1,
+                     attributes.size()));
+      } else {
+        size_t value_end = attributes.find_first_of(" \t\n\f\r");
+        value = attributes.substr(0, value_end);
+        attributes.remove_prefix(std::min(value_end, attributes.size()));
+      }
+    }
+    if (base::EqualsCaseInsensitiveASCII(attribute, "data-hook")) {
+      start_tag.data_hook = value;
+    } else if (base::EqualsCaseInsensitiveASCII(attribute, "itemprop")) {
+      start_tag.itemprop = value;
+    } else if (base::EqualsCaseInsensitiveASCII(attribute, "content")) {
+      start_tag.content = value;
+    }
+  }
+  OnStartTag(start_tag);
+
+  if (std::string_view terminator = GetRawTextTerminator(name);
+      !terminator.empty() && !start_tag.self_closing) {
+    skip_until_ = terminator;
+    skip_terminator_ = false;
+  }
+  return end + 1;
+}
+
+void ReviewPageParser::OnStartTag(const StartTag& tag) {
+  if (capture_part_ && IsSeparatingElement(tag.name)) {
+    OnText(" ");
+  }
+  std::optional<ReviewPart> part =
+      MatchPart(marketplace_, tag.data_hook, tag.itemprop);
+  if (part == ReviewPart::kReview) {
+    EndReview();
+    StartReview();
+  } else if (review_ && part == ReviewPart::kVerifiedPurchase) {
+    review_->verified_purchase = true;
+  } else if (review_ && part && !capture_part_) {
+    if (tag.content) {
+      capture_part_ = part;
+      EndCapture(*tag.content);
+    } else {
+      capture_part_ = part;
+      capture_depth_ = review_depth_ + 1;
+    }
+  }
+  if (review_ && !tag.self_closing && !IsVoidElement(tag.name)) {
+    ++review_depth_;
+  }
+  if (capture_part_ && review_depth_ < capture_depth_) {
+    // Void or self-closing part element, which has no text.
+    EndCapture({});
+  }
+}
+
+void ReviewPageParser::OnEndTag(std::string_view name) {
+  if (!review_ || IsVoidElement(name)) {
+    return;
+  }
+  --review_depth_;
+  if (capture_part_ && review_depth_ < capture_depth_) {
+    EndCapture(capture_);
+  }
+  if (!review_depth_) {
+    EndReview();
+  }
+}
+
+void ReviewPageParser::OnText(std::string_view text) {
+  if (!capture_part_ || capture_.size() >= kMaxCaptureLength) {
+    return;
+  }
+  capture_.append(text.substr(0, kMaxCaptureLength - capture_.size()));
+}
+
+void ReviewPageParser::StartReview() {
+  if (review_count_ >= kMaxReviewsPerPage) {
+    return;
+  }
+  review_ = mojom::Review::New();
+  review_depth_ = 0;
+}
+
+void ReviewPageParser::EndCapture(std::string_view content) {
+  std::string value = NormalizeText(DecodeCharacterReferences(content));
+  switch (*capture_part_) {
+    case ReviewPart::kText:
+      base::TruncateUTF8ToByteSize(value, kMaxScoredTextLength,
+                                   &review_->text);
+      break;
+    case ReviewPart::kRating:
+      if (std::optional<uint16_t> rating = ParseRating(value)) {
+        review_->rating =
+            static_cast<uint8_t>(std::clamp((*rating + 50) / 100, 1, 5));
+      }
+      break;
+    case ReviewPart::kHelpfulVotes:
+      // "One person found this helpful" has no digits.
+      review_->helpful_votes =
+          ParseCount(value).value_or(value.empty() ? 0 : 1);
+      break;
+    case ReviewPart::kReview:
+    case ReviewPart::kVerifiedPurchase:
+      NOTREACHED();
+  }
+  capture_part_.reset();
+  capture_.clear();
+}
+
+void ReviewPageParser::EndReview() {
+  if (!review_) {
+    return;
+  }
+  if (capture_part_) {
+    EndCapture(capture_);
+  }
+  if (!review_->text.empty()) {
+    parsed_.push_back(std::move(review_));
+    ++review_count_;
+  }
+  review_.reset();
+  review_depth_ = 0;
+}
+
+}  // namespace safe_deal::review_scorer
@@ -0,0 +1,108 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_PAGE_PARSER_H_
+#define SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_PAGE_PARSER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom.h"
+
+namespace safe_deal::review_scorer {
+
+// Pages with more reviews than this are cut off; marketplaces show 10 to 50
+// per page.
+inline constexpr size_t kMaxReviewsPerPage = 100;
+
+// The elements of a review page the parser reads.
+enum class ReviewPart : uint8_t {
+  kReview,
+  kText,
+  kRating,
+  kVerifiedPurchase,
+  kHelpfulVotes,
+};
+
+// Extracts the reviews of a marketplace review page from its HTML as it
+// downloads. This is not an HTML parser: it tokenizes tags just far enough to
+// find the elements holding a review and its parts by one attribute value,
+// the way the page extractor's selectors do, and counts element nesting only
+// inside a review. A review ends when its element is closed, when the next
+// review starts, or with the page, so markup that leaves elements open
+// merges nothing worse than one review's parts.
+//
+// Input is consumed as it arrives. Only an unfinished tag and the raw text
+// of the part being read, at most a few KiB, are kept between chunks.
+class ReviewPageParser {
+ public:
+  explicit ReviewPageParser(mojom::Marketplace marketplace);
+  ReviewPageParser(const ReviewPageParser&) = delete;
+  ReviewPageParser& operator=(const ReviewPageParser&) = delete;
+  ~ReviewPageParser();
+
+  // Parses |chunk|, appending every review that ended in it to |reviews|.
+  void Append(std::string_view chunk, std::vector<mojom::ReviewPtr>& reviews);
+
+  // Ends the page, appending the review in progress if it has text.
+  void Finish(std::vector<mojom::ReviewPtr>& reviews);
+
+ private:
+  // Attributes of a start tag that selectors and values are read from.
+  struct StartTag {
+    std::string_view name;
+    std::string_view data_hook;
+    std::string_view itemprop;
+    std::optional<std::string_view> content;
+    bool self_closing = false;
+  };
+
+  // Consumes the next token at the start of |input| and returns its size, or
+  // returns 0 if |input| ends inside the token.
+  size_t ParseToken(std::string_view input);
+  size_t SkipUntilTerminator(std::string_view input);
+  size_t ParseTag(std::string_view input, size_t end);
+
+  void OnStartTag(const StartTag& tag);
+  void OnEndTag(std::string_view name);
+  void OnText(std::string_view text);
+
+  void StartReview();
+  void EndCapture(std::string_view content);
+  void EndReview();
+
+  const mojom::Marketplace marketplace_;
+
+  // Unconsumed end of the previous chunk.
+  std::string pending_;
+  // While set, input up to this case insensitive string is skipped. Used for
+  // comments and for the contents of script and style elements.
+  std::string_view skip_until_;
+  // Whether the terminator itself is skipped too. End tags are not, so they
+  // go through OnEndTag().
+  bool skip_terminator_ = false;
+
+  // The review being read, if any, and the number of its elements, itself
+  // included, that are still open.
+  mojom::ReviewPtr review_;
+  size_t review_depth_ = 0;
+  // The part being read from element text, and the review depth its element
+  // was opened at.
+  std::optional<ReviewPart> capture_part_;
+  size_t capture_depth_ = 0;
+  std::string capture_;
+
+  std::vector<mojom::ReviewPtr> parsed_;
+  size_t review_count_ = 0;
+};
+
+}  // namespace safe_deal::review_scorer
+
+#endif  // SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_PAGE_PARSER_H_
@@ -0,0 +1,207 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/review_scorer/service/review_page_parser.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "safe_deal/review_scorer/common/review_scorer.mojom.h"
+#include "safe_deal/review_scorer/service/review_features.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal::review_scorer {
+
+namespace {
+
+using mojom::Marketplace;
+
+// Feeds |html| to a parser in chunks of |chunk_size| bytes.
+std::vector<mojom::ReviewPtr> Parse(Marketplace marketplace,
+                                    std::string_view html,
+                                    size_t chunk_size) {
+  ReviewPageParser parser(marketplace);
+  std::vector<mojom::ReviewPtr> reviews;
+  for (size_t pos = 0; pos < html.size(); pos += chunk_size) {
+    parser.Append(html.substr(pos, chunk_size), reviews);
+  }
+  parser.Finish(reviews);
+  return reviews;
+}
+
+std::vector<mojom::ReviewPtr> Parse(Marketplace marketplace,
+                                    std::string_view html) {
+  return Parse(marketplace, html, html.size());
+}
+
+std::vector<std::string> GetTexts(
+    const std::vector<mojom::ReviewPtr>& reviews) {
+  std::vector<std::string> texts;
+  for (const mojom::ReviewPtr& review : reviews) {
+    texts.push_back(review->text);
+  }
+  return texts;
+}
+
+// Expects every way of splitting |html| into chunks to give the reviews of
+// parsing it whole.
+void ExpectSameForEveryChunkSize(Marketplace marketplace,
+                                 std::string_view html) {
+  std::vector<mojom::ReviewPtr> expected = Parse(marketplace, html);
+  for (size_t chunk_size = 1; chunk_size < html.size(); ++chunk_size) {
+    std::vector<mojom::ReviewPtr> reviews =
+        Parse(marketplace, html, chunk_size);
+    ASSERT_EQ(expected.size(), reviews.size()) << "chunk size " << chunk_size;
+    for (size_t i = 0; i < reviews.size(); ++i) {
+      EXPECT_TRUE(expected[i].Equals(reviews[i]))
+          << "chunk size " << chunk_size << " review " << i;
+    }
+  }
+}
+
+constexpr std::string_view kAmazonPage = R"(<!DOCTYPE html>
+<html><head><title>Customer reviews: <div data-hook="review"></title>
+<script>var s = '<div data-hook="review-body">not a review</div>';</script>
+</head><body>
+<div id="cm_cr-review_list" class="a-section a-spacing-none">
+<div id="R1EXAMPLE" data-hook="review" class="a-section review aok-relative">
+  <div class="a-row"><a data-hook="review-title" href="/gp/customer-reviews/R1EXAMPLE"><span>Great value</span></a>
+  <i data-hook="review-star-rating" class="a-icon a-icon-star a-star-4"><span class="a-icon-alt">4.0 out of 5 stars</span></i></div>
+  <div class="a-row"><a href="/dp/B00EXAMPLE"><span data-hook="avp-badge" class="a-size-mini">Verified Purchase</span></a></div>
+  <span data-hook="review-body" class="a-size-base review-text"><span>Works&nbsp;great &amp; costs little.<br>Would buy
+  again &#x263A;<!-- </span></div> --></span></span>
+  <span data-hook="helpful-vote-statement" class="a-size-base">1,024 people found this helpful</span>
+</div>
+<div id="R2EXAMPLE" data-hook="review" class="a-section review">
+  <i data-hook="cmps-review-star-rating"><span>1,0 von 5 Sternen</span></i>
+  <span data-hook="review-body"><SCRIPT type="text/javascript">document.write("</span>");</SCRIPT><span>Broke after a week, 5 stars <3 for the seller</span></span>
+  <span data-hook="helpful-vote-statement">One person found this helpful</span>
+</div>
+<div data-hook="review"><span data-hook="review-body">   </span></div>
+</div>
+</body></html>)";
+
+TEST(ReviewPageParserTest, AmazonPage) {
+  std::vector<mojom::ReviewPtr> reviews =
+      Parse(Marketplace::kAmazon, kAmazonPage);
+  ASSERT_EQ(2u, reviews.size());
+
+  EXPECT_EQ(
+      "Works great & costs little. Would buy again "
+      "\xE2\x98\xBA",
+      reviews[0]->text);
+  EXPECT_EQ(4, reviews[0]->rating);
+  EXPECT_TRUE(reviews[0]->verified_purchase);
+  EXPECT_EQ(1024u, reviews[0]->helpful_votes);
+
+  EXPECT_EQ("Broke after a week, 5 stars <3 for the seller", reviews[1]->text);
+  EXPECT_EQ(1, reviews[1]->rating);
+  EXPECT_FALSE(reviews[1]->verified_purchase);
+  EXPECT_EQ(1u, reviews[1]->helpful_votes);
+}
+
+TEST(ReviewPageParserTest, AmazonPageInEveryChunkSize) {
+  ExpectSameForEveryChunkSize(Marketplace::kAmazon, kAmazonPage);
+}
+
+constexpr std::string_view kMicrodataPage = R"(<html><body>
+<div itemprop="review" itemscope itemtype="https://schema.org/Review">
+  <div itemprop="reviewRating" itemscope><meta itemprop="ratingValue" content="5"><span>5 out of 5</span></div>
+  <p itemprop=reviewBody>Fast shipping,
+     item as described.</p>
+  <p>Sold by a top rated seller</p>
+</div>
+<div itemprop="review" itemscope>
+  <span itemprop="ratingValue">2</span>
+  <div itemprop="reviewBody">Smaller than it looks<img src="a.jpg"><br/>but it works</div>
+</div>
+</body></html>)";
+
+TEST(ReviewPageParserTest, Microdata) {
+  for (Marketplace marketplace :
+       {Marketplace::kEbay, Marketplace::kAliExpress, Marketplace::kAmazon}) {
+    std::vector<mojom::ReviewPtr> reviews = Parse(marketplace, kMicrodataPage);
+    ASSERT_EQ(2u, reviews.size());
+    EXPECT_EQ("Fast shipping, item as described.", reviews[0]->text);
+    EXPECT_EQ(5, reviews[0]->rating);
+    EXPECT_EQ("Smaller than it looks but it works", reviews[1]->text);
+    EXPECT_EQ(2, reviews[1]->rating);
+  }
+  ExpectSameForEveryChunkSize(Marketplace::kEbay, kMicrodataPage);
+}
+
+TEST(ReviewPageParserTest, AmazonSelectorsOnlyOnAmazon) {
+  EXPECT_TRUE(Parse(Marketplace::kEbay, kAmazonPage).empty());
+}
+
+// A review ends with its own element; nested, void and self-closing
+// elements inside it do not end it early.
+TEST(ReviewPageParserTest, ReviewNesting) {
+  std::vector<mojom::ReviewPtr> reviews =
+      Parse(Marketplace::kAmazon,
+            "<div data-hook=review><div><img src=x><input type=hidden>"
+            "<div/><span data-hook=review-body>Inside <b>it</b></span>"
+            "<br></div><span data-hook=review-star-rating>3</span></div>"
+            "<span data-hook=review-body>Outside</span>"
+            "<span data-hook=review-star-rating>5</span>");
+  ASSERT_EQ(1u, reviews.size());
+  EXPECT_EQ("Inside it", reviews[0]->text);
+  EXPECT_EQ(3, reviews[0]->rating);
+}
+
+// Markup that never closes a review ends it at the next review or at the
+// end of the page.
+TEST(ReviewPageParserTest, UnclosedReviews) {
+  std::vector<mojom::ReviewPtr> reviews =
+      Parse(Marketplace::kAmazon,
+            "<div data-hook=review><p data-hook=review-body>First"
+            "<div data-hook=review><p data-hook=review-body>Second");
+  EXPECT_EQ((std::vector<std::string>{"First", "Second"}), GetTexts(reviews));
+}
+
+TEST(ReviewPageParserTest, CharacterReferences) {
+  std::vector<mojom::ReviewPtr> reviews =
+      Parse(Marketplace::kAmazon,
+            "<div data-hook=review><p data-hook=review-body>"
+            "&lt;b&gt; &quot;ok&quot; &#39;fine&apos; &#128077; &#xD800; "
+            "&copy; &#12345678; AT&T</p></div>");
+  ASSERT_EQ(1u, reviews.size());
+  EXPECT_EQ(
+      "<b> \"ok\" 'fine' \xF0\x9F\x91\x8D \xEF\xBF\xBD &copy; &#12345678; "
+      "AT&T",
+      reviews[0]->text);
+}
+
+TEST(ReviewPageParserTest, LimitsTextAndReviews) {
+  std::string html;
+  for (size_t i = 0; i < kMaxReviewsPerPage + 10; ++i) {
+    html += "<div data-hook=review><p data-hook=review-body>Review " +
+            std::to_string(i) + "</p></div>";
+  }
+  html += "<div data-hook=review><p data-hook=review-body>" +
+          std::string(3 * kMaxScoredTextLength, 'x');
+  std::vector<mojom::ReviewPtr> reviews = Parse(Marketplace::kAmazon, html);
+  ASSERT_EQ(kMaxReviewsPerPage, reviews.size());
+  EXPECT_EQ("Review 0", reviews.front()->text);
+
+  reviews = Parse(Marketplace::kAmazon,
+                  html.substr(html.rfind("<div data-hook=review>")), 1000);
+  ASSERT_EQ(1u, reviews.size());
+  EXPECT_EQ(kMaxScoredTextLength, reviews[0]->text.size());
+}
+
+// An unterminated tag is only buffered up to a limit, after which its '<'
+// is text.
+TEST(ReviewPageParserTest, UnterminatedTag) {
+  std::string html = "<div data-hook=review><p data-hook=review-body>a <b \"" +
+                     std::string(20 * 1024, 'y');
+  std::vector<mojom::ReviewPtr> reviews = Parse(Marketplace::kAmazon, html, 512);
+  ASSERT_EQ(1u, reviews.size());
+  EXPECT_TRUE(reviews[0]->text.starts_with("a <b \"yyy"));
+}
+
+}  // namespace
+
+}  // namespace safe_deal::review_scorer
@@ -0,0 +1,225 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/review_scorer/service/review_scorer_impl.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/containers/span.h"
+#include "base/functional/bind.h"
+#include "base/memory/raw_ref.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/timer/elapsed_timer.h"
+#include "base/trace_event/trace_event.h"
+#include "safe_deal/review_scorer/service/review_batch_scorer.h"
+#include "safe_deal/review_scorer/service/review_model.h"
+#include "safe_deal/review_scorer/service/review_page_parser.h"
+
+namespace safe_deal {
+
+// Receives the page of a ScoreReviewPage() request and parses it into the
+// reviews of its job.
+class ReviewScorerImpl::PageJob : public mojom::ReviewPageSink {
+ public:
+  PageJob(mojom::Marketplace marketplace,
+          mojo::PendingReceiver<mojom::ReviewPageSink> receiver,
+          std::vector<mojom::ReviewPtr>& reviews,
+          base::RepeatingClosure on_updated)
+      : parser_(marketplace),
+        receiver_(this, std::move(receiver)),
+        reviews_(reviews),
+        on_updated_(std::move(on_updated)) {
+    receiver_.set_disconnect_handler(
+        base::BindOnce(&PageJob::OnPageEnded, base::Unretained(this)));
+  }
+  PageJob(const PageJob&) = delete;
+  PageJob& operator=(const PageJob&) = delete;
+  ~PageJob() override = default;
+
+  bool ended() const { return ended_; }
+
+  // Asks for the next chunk once fewer than two batches of the page wait to
+  // be scored.
+  void MaybeRequestData(size_t unscored_reviews) {
+    if (request_data_ && unscored_reviews < 2 * review_scorer::kBatchSize) {
+      std::move(request_data_).Run();
+    }
+  }
+
+  // mojom::ReviewPageSink:
+  void AppendData(const std::vector<uint8_t>& chunk,
+                  AppendDataCallback callback) override {
+    parser_.Append(base::as_string_view(base::span(chunk)), *reviews_);
+    request_data_ = std::move(callback);
+    on_updated_.Run();
+  }
+
+ private:
+  void OnPageEnded() {
+    receiver_.reset();
+    parser_.Finish(*reviews_);
+    ended_ = true;
+    on_updated_.Run();
+  }
+
+  review_scorer::ReviewPageParser parser_;
+  // Declared before |receiver_| so that it is dropped after the pipe closed.
+  AppendDataCallback request_data_;
+  mojo::Receiver<mojom::ReviewPageSink> receiver_;
+  const raw_ref<std::vector<mojom::ReviewPtr>> reviews_;
+  const base::RepeatingClosure on_updated_;
+  bool ended_ = false;
+};
+
+struct ReviewScorerImpl::Job {
+  size_t unscored_reviews() const { return reviews.size() - next_index; }
+
+  // Whether all reviews of the job are known.
+  bool IsComplete() const { return !page || page->ended(); }
+
+  std::vector<mojom::ReviewPtr> reviews;
+  mojom::ReviewPriority priority;
+  mojo::Remote<mojom::ReviewScoreObserver> observer;
+  size_t next_index = 0;
+  // Set for ScoreReviewPage() requests.
+  std::unique_ptr<PageJob> page;
+};
+
+ReviewScorerImpl::ReviewScorerImpl(
+    mojo::PendingReceiver<mojom::ReviewScorer> receiver)
+    : receiver_(this, std::move(receiver)) {}
+
+ReviewScorerImpl::~ReviewScorerImpl() = default;
+
+void ReviewScorerImpl::LoadModel(base::File model,
+                                 LoadModelCallback callback) {
+  // Jobs hold no pointers into the model, so it can be swapped between
+  // batches.
+  batch_scorer_.reset();
+  model_ = review_scorer::ReviewModel::Load(std::move(model));
+  if (model_) {
+    batch_scorer_ =
+        std::make_unique<review_scorer::ReviewBatchScorer>(*model_);
+  }
+  std::move(callback).Run(!!model_);
+}
+
+void ReviewScorerImpl::ScoreReviews(
+    std::vector<mojom::ReviewPtr> reviews,
+    mojom::ReviewPriority priority,
+    mojo::PendingRemote<mojom::ReviewScoreObserver> observer) {
+  auto job = std::make_unique<Job>();
+  job->reviews = std::move(reviews);
+  job->priority = priority;
+  job->observer.Bind(std::move(observer));
+  EnqueueJob(std::move(job));
+  ScheduleNextBatch();
+}
+
+void ReviewScorerImpl::ScoreReviewPage(
+    mojom::Marketplace marketplace,
+    mojom::ReviewPriority priority,
+    mojo::PendingReceiver<mojom::ReviewPageSink> page,
+    mojo::PendingRemote<mojom::ReviewScoreObserver> observer) {
+  auto job = std::make_unique<Job>();
+  job->priority = priority;
+  job->observer.Bind(std::move(observer));
+  job->page = std::make_unique<PageJob>(
+      marketplace, std::move(page), job->reviews,
+      base::BindRepeating(&ReviewScorerImpl::OnPageJobUpdated,
+                          weak_factory_.GetWeakPtr(),
+                          base::Unretained(job.get())));
+  EnqueueJob(std::move(job));
+  ScheduleNextBatch();
+}
+
+void ReviewScorerImpl::EnqueueJob(std::unique_ptr<Job> job) {
+  bool ready = !batch_scorer_ || !job->observer.is_connected() ||
+               job->IsComplete() ||
+               job->unscored_reviews() >= review_scorer::kBatchSize;
+  if (ready) {
+    GetJobs(job->priority).push_back(std::move(job));
+  } else {
+    parked_jobs_.push_back(std::move(job));
+  }
+}
+
+void ReviewScorerImpl::OnPageJobUpdated(Job* job) {
+  job->page->MaybeRequestData(job->unscored_reviews());
+  auto parked = std::ranges::find_if(
+      parked_jobs_,
+      [job](const std::unique_ptr<Job>& parked_job) {
+        return parked_job.get() == job;
+      });
+  if (parked == parked_jobs_.end()) {
+    // Already queued.
+    return;
+  }
+  std::unique_ptr<Job> parked_job = std::move(*parked);
+  parked_jobs_.erase(parked);
+  EnqueueJob(std::move(parked_job));
+  ScheduleNextBatch();
+}
+
+void ReviewScorerImpl::ScheduleNextBatch() {
+  if (batch_scheduled_ ||
+      (foreground_jobs_.empty() && background_jobs_.empty())) {
+    return;
+  }
+  // One batch per task keeps the receiver responsive to new requests.
+  batch_scheduled_ = true;
+  base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(&ReviewScorerImpl::ScoreNextBatch,
+                                weak_factory_.GetWeakPtr()));
+}
+
+void ReviewScorerImpl::ScoreNextBatch() {
+  batch_scheduled_ = false;
+  base::circular_deque<std::unique_ptr<Job>>& jobs =
+      foreground_jobs_.empty() ? background_jobs_ : foreground_jobs_;
+  std::unique_ptr<Job> job = std::move(jobs.front());
+  jobs.pop_front();
+
+  // Pages that were closed are not scored any further.
+  bool done = !batch_scorer_ || !job->observer.is_connected() ||
+              (job->IsComplete() && !job->unscored_reviews());
+  if (!done && job->unscored_reviews()) {
+    size_t count =
+        std::min(review_scorer::kBatchSize, job->unscored_reviews());
+    std::vector<float> scores(count);
+    {
+      TRACE_EVENT("safe_deal", "ReviewScorerImpl::ScoreBatch", "reviews",
+                  count);
+      base::ElapsedTimer timer;
+      batch_scorer_->ScoreBatch(
+          base::span(job->reviews).subspan(job->next_index, count), scores);
+      base::UmaHistogramCustomMicrosecondsTimes(
+          "SafeDeal.ReviewScorer.BatchTime", timer.Elapsed(),
+          base::Microseconds(10), base::Seconds(1), 50);
+    }
+    job->observer->OnBatchScored(job->next_index, std::move(scores));
+    job->next_index += count;
+    done = job->IsComplete() && !job->unscored_reviews();
+    if (job->page) {
+      job->page->MaybeRequestData(job->unscored_reviews());
+    }
+  }
+
+  if (done) {
+    job->observer->OnScoringFinished(!!batch_scorer_);
+  } else {
+    EnqueueJob(std::move(job));
+  }
+  ScheduleNextBatch();
+}
+
+base::circular_deque<std::unique_ptr<ReviewScorerImpl::Job>>&
+ReviewScorerImpl::GetJobs(mojom::ReviewPriority priority) {
+  return priority == mojom::ReviewPriority::kForeground ? foreground_jobs_
+                                                        : background_jobs_;
+}
+
+}  // namespace safe_deal
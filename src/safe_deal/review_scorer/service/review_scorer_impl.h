@@ -0,0 +1,79 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_SCORER_IMPL_H_
+#define SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_SCORER_IMPL_H_
+
+#include <memory>
+#include <vector>
+
+#include "base/containers/circular_deque.h"
+#include "base/memory/weak_ptr.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/receiver.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "safe_deal/review_scorer/common/review_scorer.mojom.h"
+
+namespace safe_deal {
+
+namespace review_scorer {
+class ReviewBatchScorer;
+class ReviewModel;
+}  // namespace review_scorer
+
+// Implementation of mojom::ReviewScorer in the utility process. Requests from
+// all tabs share the loaded model and are interleaved one batch at a time, so
+// a page with thousands of reviews does not hold up the first batch of
+// another. Background requests only get a batch while no foreground request
+// is waiting. Review pages are parsed as they arrive, and a page's request
+// waits outside the queues until it has a full batch or the page has ended.
+class ReviewScorerImpl : public mojom::ReviewScorer {
+ public:
+  explicit ReviewScorerImpl(
+      mojo::PendingReceiver<mojom::ReviewScorer> receiver);
+  ReviewScorerImpl(const ReviewScorerImpl&) = delete;
+  ReviewScorerImpl& operator=(const ReviewScorerImpl&) = delete;
+  ~ReviewScorerImpl() override;
+
+  // mojom::ReviewScorer:
+  void LoadModel(base::File model, LoadModelCallback callback) override;
+  void ScoreReviews(
+      std::vector<mojom::ReviewPtr> reviews,
+      mojom::ReviewPriority priority,
+      mojo::PendingRemote<mojom::ReviewScoreObserver> observer) override;
+  void ScoreReviewPage(
+      mojom::Marketplace marketplace,
+      mojom::ReviewPriority priority,
+      mojo::PendingReceiver<mojom::ReviewPageSink> page,
+      mojo::PendingRemote<mojom::ReviewScoreObserver> observer) override;
+
+ private:
+  struct Job;
+  class PageJob;
+
+  // Queues |job| if it has a batch to score or is done, and parks it
+  // otherwise.
+  void EnqueueJob(std::unique_ptr<Job> job);
+  // Called by a parked page job when it got reviews or its page ended.
+  void OnPageJobUpdated(Job* job);
+  void ScheduleNextBatch();
+  void ScoreNextBatch();
+  base::circular_deque<std::unique_ptr<Job>>& GetJobs(
+      mojom::ReviewPriority priority);
+
+  mojo::Receiver<mojom::ReviewScorer> receiver_;
+  std::unique_ptr<review_scorer::ReviewModel> model_;
+  std::unique_ptr<review_scorer::ReviewBatchScorer> batch_scorer_;
+  base::circular_deque<std::unique_ptr<Job>> foreground_jobs_;
+  base::circular_deque<std::unique_ptr<Job>> background_jobs_;
+  // Page jobs waiting for more of their page.
+  std::vector<std::unique_ptr<Job>> parked_jobs_;
+  bool batch_scheduled_ = false;
+
+  base::WeakPtrFactory<ReviewScorerImpl> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_REVIEW_SCORER_SERVICE_REVIEW_SCORER_IMPL_H_
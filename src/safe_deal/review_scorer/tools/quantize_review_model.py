@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+# Copyright 2024 The Safe Deal Authors
+# Use of this source code is governed by the Apache License, Version 2.0 that
+# can be found in the LICENSE file.
+"""Quantizes a trained fake review model for the Safe Deal review scorer.
+
+The input is a JSON file with float weights:
+
+  {
+    "embeddings": [[...], ...],  # vocab_size x embedding_dim
+    "w1": [[...], ...],          # hidden_dim x (embedding_dim + 12)
+    "b1": [...],                 # hidden_dim
+    "w2": [...],                 # hidden_dim
+    "b2": 0.0
+  }
+
+and the output is the binary format described in
+safe_deal/review_scorer/common/review_model_format.h. featurize() is the
+reference for the input features and must be used by the training pipeline
+so that training and inference agree.
+"""
+
+import argparse
+import json
+import math
+import struct
+import sys
+
+MODEL_MAGIC = 0x4d524453
+MODEL_VERSION = 1
+DIMENSION_ALIGNMENT = 32
+SECTION_ALIGNMENT = 64
+HANDCRAFTED_FEATURE_COUNT = 12
+MAX_SCORED_TEXT_LENGTH = 4096
+FNV_OFFSET_BASIS = 2166136261
+FNV_PRIME = 16777619
+
+
+def _fnv(hash_value, data):
+  for byte in data:
+    hash_value = ((hash_value ^ byte) * FNV_PRIME) & 0xffffffff
+  return hash_value
+
+
+def _is_word_byte(byte):
+  return (0x30 <= byte <= 0x39 or 0x41 <= byte <= 0x5a or
+          0x61 <= byte <= 0x7a or byte >= 0x80)
+
+
+def tokenize(text):
+  """Returns the token hashes of a review, before the modulo."""
+  data = text.encode('utf-8')[:MAX_SCORED_TEXT_LENGTH]
+  words = []
+  word = bytearray()
+  for byte in data + b' ':
+    if _is_word_byte(byte):
+      word.append(byte + 32 if 0x41 <= byte <= 0x5a else byte)
+    elif word:
+      words.append(bytes(word))
+      word = bytearray()
+  hashes = []
+  for i, current in enumerate(words):
+    hashes.append(_fnv(FNV_OFFSET_BASIS, current))
+    if i > 0:
+      hashes.append(_fnv(FNV_OFFSET_BASIS, words[i - 1] + b' ' + current))
+  return hashes, words, data
+
+
+def handcrafted_features(text, rating, verified_purchase, helpful_votes):
+  """Mirrors ComputeReviewFeatures() in review_features.cc."""
+  _, words, data = tokenize(text)
+  letters = sum(1 for b in data if 0x41 <= b <= 0x5a or 0x61 <= b <= 0x7a)
+  uppercase = sum(1 for b in data if 0x41 <= b <= 0x5a)
+  digits = sum(1 for b in data if 0x30 <= b <= 0x39)
+  exclamations = data.count(b'!')
+  distinct = len({_fnv(FNV_OFFSET_BASIS, w) % 1024 for w in words})
+  has_rating = 1 <= rating <= 5
+  clamp = lambda value: min(max(value, 0.0), 1.0)
+  features = [
+      (rating - 1) / 4.0 if has_rating else 0.5,
+      float(rating in (1, 5)),
+      float(not has_rating),
+      float(verified_purchase),
+      clamp(math.log1p(helpful_votes) / 8.0),
+      math.log1p(len(data)) / math.log1p(MAX_SCORED_TEXT_LENGTH),
+      clamp(math.log1p(len(words)) / math.log1p(1000.0)),
+      clamp(exclamations / len(words)) if words else 0.0,
+      uppercase / letters if letters else 0.0,
+      distinct / len(words) if words else 0.0,
+      clamp(sum(len(w) for w in words) / len(words) / 12.0) if words else 0.0,
+      digits / len(data) if data else 0.0,
+  ]
+  assert len(features) == HANDCRAFTED_FEATURE_COUNT
+  return features
+
+
+def featurize(text, rating, verified_purchase, helpful_votes, vocab_size):
+  """Returns (vocabulary buckets, handcrafted features) for a review.
+
+  The model input is the mean of the embeddings of the buckets, followed by
+  the handcrafted features.
+  """
+  hashes, _, _ = tokenize(text)
+  buckets = [h & (vocab_size - 1) for h in hashes]
+  return buckets, handcrafted_features(text, rating, verified_purchase,
+                                       helpful_votes)
+
+
+def _quantize(values):
+  """Symmetric int8 quantization. Returns (int8 values, scale)."""
+  max_abs = max((abs(v) for v in values), default=0.0)
+  scale = max_abs / 127.0 if max_abs else 1.0
+  return [max(-127, min(127, round(v / scale))) for v in values], scale
+
+
+def _align(output, alignment=SECTION_ALIGNMENT):
+  output.extend(b'\0' * (-len(output) % alignment))
+
+
+def _round_up(value, alignment):
+  return (value + alignment - 1) // alignment * alignment
+
+
+def build_model(weights):
+  embeddings = weights['embeddings']
+  vocab_size = len(embeddings)
+  embedding_dim = len(embeddings[0])
+  hidden_dim = len(weights['w1'])
+  if vocab_size & (vocab_size - 1):
+    raise ValueError('vocab_size must be a power of two')
+  if hidden_dim % DIMENSION_ALIGNMENT:
+    raise ValueError('hidden_dim must be a multiple of %d' %
+                     DIMENSION_ALIGNMENT)
+  input_dim = _round_up(embedding_dim + HANDCRAFTED_FEATURE_COUNT,
+                        DIMENSION_ALIGNMENT)
+
+  flat_embeddings, embedding_scale = _quantize(
+      [v for row in embeddings for v in row])
+  w2, w2_scale = _quantize(weights['w2'])
+
+  output = bytearray(
+      struct.pack('<6I3f7I', MODEL_MAGIC, MODEL_VERSION, vocab_size,
+                  embedding_dim, input_dim, hidden_dim, embedding_scale,
+                  w2_scale, weights['b2'], *([0] * 7)))
+  assert len(output) == SECTION_ALIGNMENT
+  output.extend(struct.pack('<%db' % len(flat_embeddings), *flat_embeddings))
+  _align(output)
+  w1_scales = []
+  for row in weights['w1']:
+    if len(row) != embedding_dim + HANDCRAFTED_FEATURE_COUNT:
+      raise ValueError('w1 rows must have embedding_dim + %d columns' %
+                       HANDCRAFTED_FEATURE_COUNT)
+    quantized, scale = _quantize(row)
+    quantized += [0] * (input_dim - len(quantized))
+    output.extend(struct.pack('<%db' % input_dim, *quantized))
+    w1_scales.append(scale)
+  _align(output)
+  output.extend(struct.pack('<%df' % hidden_dim, *w1_scales))
+  _align(output)
+  output.extend(struct.pack('<%df' % hidden_dim, *weights['b1']))
+  _align(output)
+  output.extend(struct.pack('<%db' % hidden_dim, *w2))
+  return bytes(output)
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+  parser.add_argument('input', help='JSON file with float weights')
+  parser.add_argument('output', help='Quantized model to write')
+  args = parser.parse_args()
+
+  with open(args.input) as f:
+    weights = json.load(f)
+  try:
+    model = build_model(weights)
+  except (KeyError, ValueError) as e:
+    print('Invalid model: %s' % e, file=sys.stderr)
+    return 1
+  with open(args.output, 'wb') as f:
+    f.write(model)
+  print('Wrote %d bytes' % len(model))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,194 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/seller_reputation/browser/seller_reputation_api_fetcher.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/json/json_writer.h"
+#include "base/strings/string_util.h"
+#include "base/values.h"
+#include "net/base/load_flags.h"
+#include "net/traffic_annotation/network_traffic_annotation.h"
+#include "safe_deal/api/safe_deal_api.h"
+#include "safe_deal/common/safe_deal_constants.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/cpp/shared_url_loader_factory.h"
+#include "services/network/public/cpp/simple_url_loader.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr char kBatchGetPath[] = "v1/sellers:batchGet";
+
+// A response for the largest batch the cache sends is well under this.
+constexpr size_t kMaxResponseSize = 1024 * 1024;
+
+constexpr net::NetworkTrafficAnnotationTag kTrafficAnnotation =
+    net::DefineNetworkTrafficAnnotation("safe_deal_seller_reputation", R"(
+        semantics {
+          sender: "Safe Deal Seller Reputation"
+          description:
+            "Looks up the reputation of marketplace sellers whose listings "
+            "the user is viewing, so the shopping assistant can warn about "
+            "untrustworthy sellers."
+          trigger:
+            "Viewing a supported marketplace page that lists sellers not in "
+            "the local cache, or periodic refresh of recently viewed "
+            "sellers."
+          data: "The marketplace and the public seller ids shown on the page."
+          destination: OTHER
+          destination_other: "The Safe Deal API."
+        }
+        policy {
+          cookies_allowed: NO
+          setting: "None."
+          policy_exception_justification: "Not implemented."
+        })");
+
+uint8_t GetFlags(bool top_rated, bool new_seller, bool high_risk) {
+  return (top_rated ? kSellerFlagTopRated : 0) |
+         (new_seller ? kSellerFlagNewSeller : 0) |
+         (high_risk ? kSellerFlagHighRisk : 0);
+}
+
+std::optional<SellerReputationFetcher::Results> ParseResults(
+    const base::Value& value) {
+  const base::Value::Dict* dict = value.GetIfDict();
+  const base::Value::List* sellers =
+      dict ? dict->FindList("sellers") : nullptr;
+  if (!sellers) {
+    return std::nullopt;
+  }
+  std::vector<std::pair<std::string, SellerReputation>> results;
+  results.reserve(sellers->size());
+  for (const base::Value& seller : *sellers) {
+    const base::Value::Dict* seller_dict = seller.GetIfDict();
+    const std::string* seller_id =
+        seller_dict ? seller_dict->FindString("sellerId") : nullptr;
+    if (!seller_id) {
+      continue;
+    }
+    SellerReputation reputation;
+    reputation.trust_score = static_cast<uint8_t>(
+        std::clamp(seller_dict->FindInt("trustScore").value_or(0), 0, 100));
+    reputation.positive_feedback_x100 = static_cast<uint16_t>(std::clamp(
+        seller_dict->FindDouble("positiveFeedback").value_or(0) * 100, 0.0,
+        10000.0));
+    reputation.feedback_count = static_cast<uint32_t>(
+        std::max(seller_dict->FindInt("feedbackCount").value_or(0), 0));
+    reputation.age_days = static_cast<uint32_t>(
+        std::max(seller_dict->FindInt("ageDays").value_or(0), 0));
+    reputation.flags =
+        GetFlags(seller_dict->FindBool("topRated").value_or(false),
+                 seller_dict->FindBool("newSeller").value_or(false),
+                 seller_dict->FindBool("highRisk").value_or(false));
+    results.emplace_back(*seller_id, reputation);
+  }
+  return SellerReputationFetcher::Results(std::move(results));
+}
+
+std::optional<SellerReputationFetcher::Results> ParseResults(
+    const api::fb::Response* response) {
+  const api::fb::SellerBatchGetResponse* batch =
+      response ? response->payload_as_SellerBatchGetResponse() : nullptr;
+  if (!batch) {
+    return std::nullopt;
+  }
+  std::vector<std::pair<std::string, SellerReputation>> results;
+  if (const auto* sellers = batch->sellers()) {
+    results.reserve(sellers->size());
+    for (const api::fb::SellerReputation* seller : *sellers) {
+      SellerReputation reputation;
+      reputation.trust_score = std::min<uint8_t>(seller->trust_score(), 100);
+      reputation.positive_feedback_x100 =
+          std::min<uint16_t>(seller->positive_feedback_x100(), 10000);
+      reputation.feedback_count = seller->feedback_count();
+      reputation.age_days = seller->age_days();
+      reputation.flags = GetFlags(seller->top_rated(), seller->new_seller(),
+                                  seller->high_risk());
+      results.emplace_back(seller->seller_id()->str(), reputation);
+    }
+  }
+  return SellerReputationFetcher::Results(std::move(results));
+}
+
+}  // namespace
+
+SellerReputationApiFetcher::SellerReputationApiFetcher(
+    scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory)
+    : url_loader_factory_(std::move(url_loader_factory)) {}
+
+SellerReputationApiFetcher::~SellerReputationApiFetcher() = default;
+
+void SellerReputationApiFetcher::Fetch(mojom::Marketplace marketplace,
+                                       std::vector<std::string> seller_ids,
+                                       FetchCallback callback) {
+  const MarketplaceInfo* info = GetMarketplaceInfo(marketplace);
+  if (!info) {
+    std::move(callback).Run(std::nullopt);
+    return;
+  }
+  base::Value::List ids;
+  for (std::string& seller_id : seller_ids) {
+    ids.Append(std::move(seller_id));
+  }
+  base::Value::Dict request_body;
+  request_body.Set("marketplace", base::ToLowerASCII(info->name));
+  request_body.Set("sellerIds", std::move(ids));
+  std::string body;
+  base::JSONWriter::Write(request_body, &body);
+
+  auto request = std::make_unique<network::ResourceRequest>();
+  request->url = GetSafeDealApiUrl(kBatchGetPath);
+  request->method = "POST";
+  request->credentials_mode = network::mojom::CredentialsMode::kOmit;
+  request->load_flags = net::LOAD_DISABLE_CACHE;
+  request->headers.SetHeader("Accept", GetSafeDealApiAcceptHeader());
+  loaders_.push_front(network::SimpleURLLoader::Create(std::move(request),
+                                                       kTrafficAnnotation));
+  network::SimpleURLLoader* loader = loaders_.front().get();
+  loader->AttachStringForUpload(body, "application/json");
+  loader->DownloadToString(
+      url_loader_factory_.get(),
+      base::BindOnce(&SellerReputationApiFetcher::OnResponse,
+                     weak_factory_.GetWeakPtr(), loaders_.begin(),
+                     std::move(callback)),
+      kMaxResponseSize);
+}
+
+void SellerReputationApiFetcher::OnResponse(LoaderList::iterator loader,
+                                            FetchCallback callback,
+                                            std::optional<std::string> body) {
+  const network::mojom::URLResponseHead* response_info =
+      (*loader)->ResponseInfo();
+  const bool is_flatbuffer =
+      response_info &&
+      response_info->mime_type == kSafeDealApiFlatBuffersMimeType;
+  loaders_.erase(loader);
+  if (!body) {
+    std::move(callback).Run(std::nullopt);
+    return;
+  }
+  if (is_flatbuffer) {
+    std::move(callback).Run(ParseResults(GetSafeDealApiResponse(*body)));
+    return;
+  }
+  data_decoder::DataDecoder::ParseJsonIsolated(
+      *body, base::BindOnce(&SellerReputationApiFetcher::OnParsed,
+                            weak_factory_.GetWeakPtr(), std::move(callback)));
+}
+
+void SellerReputationApiFetcher::OnParsed(
+    FetchCallback callback,
+    data_decoder::DataDecoder::ValueOrError result) {
+  std::move(callback).Run(result.has_value() ? ParseResults(*result)
+                                             : std::nullopt);
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,59 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_SELLER_REPUTATION_BROWSER_SELLER_REPUTATION_API_FETCHER_H_
+#define SAFE_DEAL_SELLER_REPUTATION_BROWSER_SELLER_REPUTATION_API_FETCHER_H_
+
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "safe_deal/seller_reputation/browser/seller_reputation_fetcher.h"
+#include "services/data_decoder/public/cpp/data_decoder.h"
+
+namespace network {
+class SharedURLLoaderFactory;
+class SimpleURLLoader;
+}  // namespace network
+
+namespace safe_deal {
+
+// Fetches reputations from the Safe Deal API's batch endpoint. FlatBuffers
+// responses are read in place; JSON responses, the fallback, are parsed out
+// of process by the data decoder service.
+class SellerReputationApiFetcher : public SellerReputationFetcher {
+ public:
+  explicit SellerReputationApiFetcher(
+      scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory);
+  SellerReputationApiFetcher(const SellerReputationApiFetcher&) = delete;
+  SellerReputationApiFetcher& operator=(const SellerReputationApiFetcher&) =
+      delete;
+  ~SellerReputationApiFetcher() override;
+
+  // SellerReputationFetcher:
+  void Fetch(mojom::Marketplace marketplace,
+             std::vector<std::string> seller_ids,
+             FetchCallback callback) override;
+
+ private:
+  using LoaderList = std::list<std::unique_ptr<network::SimpleURLLoader>>;
+
+  void OnResponse(LoaderList::iterator loader,
+                  FetchCallback callback,
+                  std::optional<std::string> body);
+  void OnParsed(FetchCallback callback,
+                data_decoder::DataDecoder::ValueOrError result);
+
+  const scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory_;
+  LoaderList loaders_;
+  base::WeakPtrFactory<SellerReputationApiFetcher> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_SELLER_REPUTATION_BROWSER_SELLER_REPUTATION_API_FETCHER_H_
@@ -0,0 +1,293 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/seller_reputation/browser/seller_reputation_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/trace_event/trace_event.h"
+#include "safe_deal/common/product_key.h"
+
+namespace safe_deal {
+
+namespace {
+
+constexpr size_t kMaxSellerIdLength = 256;
+constexpr size_t kMaxBatchSize = 100;
+
+// Per distinct string in a StringInterner, besides its characters.
+constexpr size_t kInternedStringOverhead = 24;
+
+// Gives the other tabs loading at the same time a chance to add their
+// sellers to the batch.
+constexpr base::TimeDelta kBatchDelay = base::Milliseconds(50);
+
+constexpr base::TimeDelta kTimeToLive = base::Hours(6);
+constexpr base::TimeDelta kNotFoundTimeToLive = base::Hours(1);
+// Entries used since the last refresh are fetched again when they have less
+// than this left to live.
+constexpr base::TimeDelta kRefreshAhead = base::Hours(1);
+constexpr base::TimeDelta kRefreshInterval = base::Minutes(15);
+
+base::TimeDelta GetTimeToLive(const SellerReputation& reputation) {
+  return (reputation.flags & kSellerFlagNotFound) ? kNotFoundTimeToLive
+                                                  : kTimeToLive;
+}
+
+}  // namespace
+
+SellerReputationCache::PendingLookup::PendingLookup() = default;
+SellerReputationCache::PendingLookup::PendingLookup(PendingLookup&&) =
+    default;
+SellerReputationCache::PendingLookup&
+SellerReputationCache::PendingLookup::operator=(PendingLookup&&) = default;
+SellerReputationCache::PendingLookup::~PendingLookup() = default;
+
+SellerReputationCache::SellerReputationCache(
+    std::unique_ptr<SellerReputationFetcher> fetcher,
+    StringInterner* strings,
+    SafeDealMemoryBudget* budget)
+    : fetcher_(std::move(fetcher)),
+      strings_(strings),
+      budget_(budget),
+      entries_(base::HashingLRUCache<uint64_t, Entry>::NO_AUTO_EVICT),
+      table_(kSellerReputationTableCapacity) {
+  refresh_timer_.Start(
+      FROM_HERE, kRefreshInterval,
+      base::BindRepeating(&SellerReputationCache::RefreshExpiringEntries,
+                          base::Unretained(this)));
+  budget_->AddClient(this, MemoryEvictionPriority::kRefetchable,
+                     "seller_reputation", "Seller reputation cache");
+}
+
+SellerReputationCache::~SellerReputationCache() {
+  budget_->RemoveClient(this);
+}
+
+void SellerReputationCache::GetReputation(mojom::Marketplace marketplace,
+                                          std::string_view seller_id,
+                                          ReputationCallback callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  TRACE_EVENT("safe_deal", "SellerReputationCache::GetReputation");
+  // Measures what the caller sees, including the batching delay and the
+  // fetch for misses.
+  callback = base::BindOnce(
+      [](base::TimeTicks start, ReputationCallback callback,
+         std::optional<SellerReputation> reputation) {
+        base::UmaHistogramCustomMicrosecondsTimes(
+            "SafeDeal.SellerReputation.LookupTime",
+            base::TimeTicks::Now() - start, base::Microseconds(10),
+            base::Seconds(10), 50);
+        std::move(callback).Run(std::move(reputation));
+      },
+      base::TimeTicks::Now(), std::move(callback));
+  if (!fetcher_ || seller_id.empty() ||
+      seller_id.size() > kMaxSellerIdLength) {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE, base::BindOnce(std::move(callback), std::nullopt));
+    return;
+  }
+
+  uint64_t key = ComputeSellerKeyHash(marketplace, seller_id);
+  auto it = entries_.Get(key);
+  if (it != entries_.end() &&
+      base::TimeTicks::Now() - it->second.fetch_time <
+          GetTimeToLive(it->second.reputation)) {
+    base::UmaHistogramBoolean("SafeDeal.SellerReputation.CacheHit", true);
+    it->second.used = true;
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE,
+        base::BindOnce(std::move(callback), it->second.reputation));
+    return;
+  }
+  base::UmaHistogramBoolean("SafeDeal.SellerReputation.CacheHit", false);
+
+  auto [pending, inserted] = in_flight_.try_emplace(key);
+  pending->second.callbacks.push_back(std::move(callback));
+  if (inserted) {
+    Enqueue(key, marketplace, strings_->Intern(seller_id));
+  }
+}
+
+base::ReadOnlySharedMemoryRegion SellerReputationCache::DuplicateTableRegion()
+    const {
+  return table_.DuplicateReadOnlyRegion();
+}
+
+void SellerReputationCache::Shutdown() {
+  batch_timer_.Stop();
+  refresh_timer_.Stop();
+  // Drops the requests in flight along with their callbacks.
+  fetcher_.reset();
+  in_flight_.clear();
+  for (const auto& [marketplace, seller_ids] : queued_) {
+    for (InternedStringId seller_id : seller_ids) {
+      strings_->Release(seller_id);
+    }
+  }
+  queued_.clear();
+}
+
+size_t SellerReputationCache::GetMemoryUsage() const {
+  return memory_usage_;
+}
+
+void SellerReputationCache::EvictMemory(size_t target_bytes) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  while (memory_usage_ > target_bytes && !entries_.empty()) {
+    EvictOldest();
+  }
+}
+
+size_t SellerReputationCache::EstimateMemoryUsage(const Entry& entry) const {
+  // The LRU list node and the hash index entry cost about as much again as
+  // the entry itself. Seller ids are rarely shared with other caches, so the
+  // interned copy is counted too.
+  return 2 * sizeof(Entry) + kInternedStringOverhead +
+         strings_->Get(entry.seller_id).size();
+}
+
+void SellerReputationCache::Enqueue(uint64_t key,
+                                    mojom::Marketplace marketplace,
+                                    InternedStringId seller_id) {
+  DCHECK(in_flight_.contains(key));
+  std::vector<InternedStringId>& queue = queued_[marketplace];
+  queue.push_back(seller_id);
+  if (queue.size() >= kMaxBatchSize) {
+    SendBatches();
+  } else if (!batch_timer_.IsRunning()) {
+    batch_timer_.Start(FROM_HERE, kBatchDelay,
+                       base::BindOnce(&SellerReputationCache::SendBatches,
+                                      base::Unretained(this)));
+  }
+}
+
+void SellerReputationCache::SendBatches() {
+  batch_timer_.Stop();
+  for (auto& [marketplace, seller_ids] : std::exchange(queued_, {})) {
+    for (size_t begin = 0; begin < seller_ids.size();
+         begin += kMaxBatchSize) {
+      size_t end = std::min(begin + kMaxBatchSize, seller_ids.size());
+      std::vector<std::string> batch;
+      batch.reserve(end - begin);
+      for (size_t i = begin; i < end; ++i) {
+        batch.emplace_back(strings_->Get(seller_ids[i]));
+      }
+      base::UmaHistogramCounts100("SafeDeal.SellerReputation.BatchSize",
+                                  batch.size());
+      fetcher_->Fetch(marketplace, batch,
+                      base::BindOnce(&SellerReputationCache::OnFetched,
+                                     weak_factory_.GetWeakPtr(), marketplace,
+                                     batch));
+    }
+    // The batches hold copies until the fetch completes.
+    for (InternedStringId seller_id : seller_ids) {
+      strings_->Release(seller_id);
+    }
+  }
+}
+
+void SellerReputationCache::OnFetched(
+    mojom::Marketplace marketplace,
+    std::vector<std::string> seller_ids,
+    std::optional<SellerReputationFetcher::Results> results) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::UmaHistogramBoolean("SafeDeal.SellerReputation.FetchSucceeded",
+                            results.has_value());
+  for (const std::string& seller_id : seller_ids) {
+    uint64_t key = ComputeSellerKeyHash(marketplace, seller_id);
+    std::optional<SellerReputation> reputation;
+    if (results) {
+      auto result = results->find(seller_id);
+      reputation = result != results->end()
+                       ? result->second
+                       : SellerReputation{.flags = kSellerFlagNotFound};
+      Store(key, marketplace, seller_id, *reputation);
+    } else if (auto it = entries_.Peek(key); it != entries_.end()) {
+      // Serve a stale entry rather than nothing while the backend is down.
+      reputation = it->second.reputation;
+    }
+
+    auto pending = in_flight_.find(key);
+    if (pending == in_flight_.end()) {
+      continue;
+    }
+    std::vector<ReputationCallback> callbacks =
+        std::move(pending->second.callbacks);
+    in_flight_.erase(pending);
+    for (ReputationCallback& callback : callbacks) {
+      std::move(callback).Run(reputation);
+    }
+  }
+}
+
+void SellerReputationCache::Store(uint64_t key,
+                                  mojom::Marketplace marketplace,
+                                  std::string_view seller_id,
+                                  const SellerReputation& reputation) {
+  // Interned first, so that a refreshed seller keeps its id.
+  InternedStringId id = strings_->Intern(seller_id);
+  if (auto it = entries_.Peek(key); it != entries_.end()) {
+    Erase(it);
+  }
+  auto it = entries_.Put(
+      key, Entry{marketplace, id, reputation, base::TimeTicks::Now()});
+  memory_usage_ += EstimateMemoryUsage(it->second);
+
+  // The table refuses inserts once it is three quarters full.
+  while (table_.IsValid() && !table_.Insert(key, reputation) &&
+         entries_.size() > 1) {
+    EvictOldest();
+  }
+  // May evict this entry too.
+  budget_->OnMemoryUsageGrew();
+}
+
+void SellerReputationCache::EvictOldest() {
+  auto oldest = std::prev(entries_.end());
+  table_.Remove(oldest->first);
+  Erase(oldest);
+}
+
+base::HashingLRUCache<uint64_t, SellerReputationCache::Entry>::iterator
+SellerReputationCache::Erase(
+    base::HashingLRUCache<uint64_t, Entry>::iterator it) {
+  memory_usage_ -= EstimateMemoryUsage(it->second);
+  strings_->Release(it->second.seller_id);
+  return entries_.Erase(it);
+}
+
+void SellerReputationCache::RefreshExpiringEntries() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::TimeTicks now = base::TimeTicks::Now();
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    Entry& entry = it->second;
+    base::TimeDelta time_left =
+        GetTimeToLive(entry.reputation) - (now - entry.fetch_time);
+    if (time_left >= kRefreshAhead) {
+      ++it;
+      continue;
+    }
+    if (!entry.used) {
+      if (time_left.is_negative()) {
+        // Nobody looked at it for a whole refresh interval; stop serving
+        // it to renderers.
+        table_.Remove(it->first);
+        it = Erase(it);
+        continue;
+      }
+    } else if (in_flight_.try_emplace(it->first).second) {
+      strings_->AddRef(entry.seller_id);
+      Enqueue(it->first, entry.marketplace, entry.seller_id);
+      entry.used = false;
+    }
+    ++it;
+  }
+}
+
+}  // namespace safe_deal
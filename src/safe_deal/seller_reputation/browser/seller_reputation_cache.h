@@ -0,0 +1,145 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_SELLER_REPUTATION_BROWSER_SELLER_REPUTATION_CACHE_H_
+#define SAFE_DEAL_SELLER_REPUTATION_BROWSER_SELLER_REPUTATION_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/containers/lru_cache.h"
+#include "base/functional/callback.h"
+#include "base/memory/raw_ptr.h"
+#include "base/memory/read_only_shared_memory_region.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/common/safe_deal_memory_budget.h"
+#include "safe_deal/common/shared_hash_table.h"
+#include "safe_deal/common/string_interner.h"
+#include "safe_deal/seller_reputation/browser/seller_reputation_fetcher.h"
+#include "safe_deal/seller_reputation/common/seller_reputation.h"
+
+namespace safe_deal {
+
+// Per-profile cache of seller reputations, shared by all tabs of the
+// profile. Lookups for the same seller are coalesced into one fetch, misses
+// from all tabs are sent in batches of up to 100 sellers per marketplace,
+// and recently used entries are refreshed in the background before they
+// expire. The cache is a client of the profile's SafeDealMemoryBudget, which
+// has it evict least recently used entries first.
+//
+// Every cached entry is mirrored into a read-only shared memory table that
+// renderers of the profile map, so they can read reputations without a Mojo
+// round trip. Seller ids are kept in the profile's StringInterner. UI thread
+// only.
+class SellerReputationCache : public KeyedService,
+                              public SafeDealMemoryBudget::Client {
+ public:
+  using ReputationCallback =
+      base::OnceCallback<void(std::optional<SellerReputation>)>;
+
+  // |strings| and |budget| must outlive the cache.
+  SellerReputationCache(std::unique_ptr<SellerReputationFetcher> fetcher,
+                        StringInterner* strings,
+                        SafeDealMemoryBudget* budget);
+  SellerReputationCache(const SellerReputationCache&) = delete;
+  SellerReputationCache& operator=(const SellerReputationCache&) = delete;
+  ~SellerReputationCache() override;
+
+  // Runs |callback| with the reputation of the seller, fetching it if it is
+  // not cached or has expired. Runs it with nullopt if the seller cannot be
+  // looked up; sellers unknown to the backend have kSellerFlagNotFound set.
+  void GetReputation(mojom::Marketplace marketplace,
+                     std::string_view seller_id,
+                     ReputationCallback callback);
+
+  // Returns a handle to the table renderers read, or an invalid region if
+  // shared memory could not be allocated.
+  base::ReadOnlySharedMemoryRegion DuplicateTableRegion() const;
+
+  // Size of the shared memory table, mapped by every renderer of the
+  // profile.
+  size_t table_size() const { return table_.region_size(); }
+
+  // KeyedService:
+  void Shutdown() override;
+
+  // SafeDealMemoryBudget::Client:
+  size_t GetMemoryUsage() const override;
+  void EvictMemory(size_t target_bytes) override;
+
+ private:
+  struct Entry {
+    mojom::Marketplace marketplace;
+    // Holds a reference.
+    InternedStringId seller_id;
+    SellerReputation reputation;
+    base::TimeTicks fetch_time;
+    // Whether the entry was read since the last refresh, i.e. whether
+    // refreshing it is worth a request.
+    bool used = true;
+  };
+
+  struct PendingLookup {
+    PendingLookup();
+    PendingLookup(PendingLookup&&);
+    PendingLookup& operator=(PendingLookup&&);
+    ~PendingLookup();
+
+    std::vector<ReputationCallback> callbacks;
+  };
+
+  size_t EstimateMemoryUsage(const Entry& entry) const;
+
+  // Queues the seller for the next batch, taking over a reference to
+  // |seller_id|.
+  void Enqueue(uint64_t key,
+               mojom::Marketplace marketplace,
+               InternedStringId seller_id);
+  void SendBatches();
+  void OnFetched(mojom::Marketplace marketplace,
+                 std::vector<std::string> seller_ids,
+                 std::optional<SellerReputationFetcher::Results> results);
+  void Store(uint64_t key,
+             mojom::Marketplace marketplace,
+             std::string_view seller_id,
+             const SellerReputation& reputation);
+  void EvictOldest();
+  base::HashingLRUCache<uint64_t, Entry>::iterator Erase(
+      base::HashingLRUCache<uint64_t, Entry>::iterator it);
+  void RefreshExpiringEntries();
+
+  std::unique_ptr<SellerReputationFetcher> fetcher_;
+  const raw_ptr<StringInterner> strings_;
+  const raw_ptr<SafeDealMemoryBudget> budget_;
+  base::HashingLRUCache<uint64_t, Entry> entries_;
+  size_t memory_usage_ = 0;
+  SharedHashTableWriter<SellerReputation> table_;
+
+  // Callbacks waiting for sellers that are queued or being fetched.
+  base::flat_map<uint64_t, PendingLookup> in_flight_;
+  // Seller ids waiting for the next batch, per marketplace. Each holds a
+  // reference.
+  base::flat_map<mojom::Marketplace, std::vector<InternedStringId>> queued_;
+  base::OneShotTimer batch_timer_;
+  base::RepeatingTimer refresh_timer_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+  base::WeakPtrFactory<SellerReputationCache> weak_factory_{this};
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_SELLER_REPUTATION_BROWSER_SELLER_REPUTATION_CACHE_H_
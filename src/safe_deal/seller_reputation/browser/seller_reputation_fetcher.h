@@ -0,0 +1,37 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_SELLER_REPUTATION_BROWSER_SELLER_REPUTATION_FETCHER_H_
+#define SAFE_DEAL_SELLER_REPUTATION_BROWSER_SELLER_REPUTATION_FETCHER_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/functional/callback.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/seller_reputation/common/seller_reputation.h"
+
+namespace safe_deal {
+
+// Looks up the reputation of several sellers of one marketplace in a single
+// request.
+class SellerReputationFetcher {
+ public:
+  // Reputations by seller id. Sellers missing from a successful response are
+  // unknown to the backend. nullopt if the request failed.
+  using Results = base::flat_map<std::string, SellerReputation>;
+  using FetchCallback = base::OnceCallback<void(std::optional<Results>)>;
+
+  virtual ~SellerReputationFetcher() = default;
+
+  virtual void Fetch(mojom::Marketplace marketplace,
+                     std::vector<std::string> seller_ids,
+                     FetchCallback callback) = 0;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_SELLER_REPUTATION_BROWSER_SELLER_REPUTATION_FETCHER_H_
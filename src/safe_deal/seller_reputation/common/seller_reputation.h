@@ -0,0 +1,45 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_SELLER_REPUTATION_COMMON_SELLER_REPUTATION_H_
+#define SAFE_DEAL_SELLER_REPUTATION_COMMON_SELLER_REPUTATION_H_
+
+#include <stdint.h>
+
+namespace safe_deal {
+
+enum SellerFlag : uint8_t {
+  kSellerFlagTopRated = 1 << 0,
+  kSellerFlagNewSeller = 1 << 1,
+  kSellerFlagHighRisk = 1 << 2,
+  // The Safe Deal API does not know the seller. Cached like any other
+  // answer, so renderers can tell it apart from "not fetched yet".
+  kSellerFlagNotFound = 1 << 7,
+};
+
+// Reputation of one seller as reported by the Safe Deal API. Stored as is in
+// the shared memory table read by renderers, so it must stay trivially
+// copyable and a multiple of 8 bytes.
+struct SellerReputation {
+  // 0 to 100; higher is more trustworthy.
+  uint8_t trust_score = 0;
+  // Combination of SellerFlag values.
+  uint8_t flags = 0;
+  // Share of positive feedback multiplied by 100, e.g. 98.5% is 9850.
+  uint16_t positive_feedback_x100 = 0;
+  uint32_t feedback_count = 0;
+  // Days since the seller joined the marketplace, or 0 if unknown.
+  uint32_t age_days = 0;
+  uint32_t reserved = 0;
+};
+
+static_assert(sizeof(SellerReputation) == 16);
+
+// Records in the shared table; a power of two. Also bounds the number of
+// sellers cached in the browser.
+inline constexpr uint32_t kSellerReputationTableCapacity = 8192;
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_SELLER_REPUTATION_COMMON_SELLER_REPUTATION_H_
@@ -0,0 +1,43 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/seller_reputation/renderer/seller_reputation_table.h"
+
+#include <utility>
+
+#include "safe_deal/common/product_key.h"
+
+namespace safe_deal {
+
+// static
+SellerReputationTable& SellerReputationTable::GetInstance() {
+  static base::NoDestructor<SellerReputationTable> instance;
+  return *instance;
+}
+
+SellerReputationTable::SellerReputationTable() = default;
+SellerReputationTable::~SellerReputationTable() = default;
+
+void SellerReputationTable::SetRegion(
+    base::ReadOnlySharedMemoryRegion region) {
+  std::optional<SharedHashTableReader<SellerReputation>> reader =
+      SharedHashTableReader<SellerReputation>::Create(std::move(region));
+  base::AutoLock lock(lock_);
+  reader_ = std::move(reader);
+}
+
+std::optional<SellerReputation> SellerReputationTable::Find(
+    mojom::Marketplace marketplace,
+    std::string_view seller_id) const {
+  uint64_t key = ComputeSellerKeyHash(marketplace, seller_id);
+  // Readers never block the browser; the lock only guards against the table
+  // being replaced.
+  base::AutoLock lock(lock_);
+  if (!reader_) {
+    return std::nullopt;
+  }
+  return reader_->Find(key);
+}
+
+}  // namespace safe_deal
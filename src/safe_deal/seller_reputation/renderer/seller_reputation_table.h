@@ -0,0 +1,53 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_SELLER_REPUTATION_RENDERER_SELLER_REPUTATION_TABLE_H_
+#define SAFE_DEAL_SELLER_REPUTATION_RENDERER_SELLER_REPUTATION_TABLE_H_
+
+#include <optional>
+#include <string_view>
+
+#include "base/memory/read_only_shared_memory_region.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/common/shared_hash_table.h"
+#include "safe_deal/seller_reputation/common/seller_reputation.h"
+
+namespace safe_deal {
+
+// Read-only view of the seller reputation cache of the profile the render
+// process belongs to. The browser keeps the table up to date, so lookups
+// never leave the process; a miss only means the browser has not fetched
+// the seller yet.
+class SellerReputationTable {
+ public:
+  static SellerReputationTable& GetInstance();
+
+  SellerReputationTable(const SellerReputationTable&) = delete;
+  SellerReputationTable& operator=(const SellerReputationTable&) = delete;
+
+  // Maps |region|, replacing the current table.
+  void SetRegion(base::ReadOnlySharedMemoryRegion region);
+
+  // Returns nullopt if the seller is not in the table or no table has been
+  // received.
+  std::optional<SellerReputation> Find(mojom::Marketplace marketplace,
+                                       std::string_view seller_id) const;
+
+ private:
+  friend class base::NoDestructor<SellerReputationTable>;
+
+  SellerReputationTable();
+  ~SellerReputationTable();
+
+  mutable base::Lock lock_;
+  std::optional<SharedHashTableReader<SellerReputation>> reader_
+      GUARDED_BY(lock_);
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_SELLER_REPUTATION_RENDERER_SELLER_REPUTATION_TABLE_H_
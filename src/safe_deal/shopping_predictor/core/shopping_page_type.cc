@@ -0,0 +1,98 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/shopping_predictor/core/shopping_page_type.h"
+
+#include <string_view>
+
+#include "base/containers/span.h"
+#include "base/strings/string_util.h"
+#include "url/gurl.h"
+
+namespace safe_deal {
+
+namespace {
+
+enum class Match {
+  kExact,
+  kPrefix,
+  // For paths with a title slug in front.
+  kAnywhere,
+};
+
+struct PathRule {
+  const char* path;
+  Match match;
+  ShoppingPageType type;
+};
+
+// More specific rules come first: review pages are below product paths on
+// some marketplaces.
+constexpr PathRule kAmazonRules[] = {
+    {"/product-reviews/", Match::kAnywhere, ShoppingPageType::kReviews},
+    {"/gp/customer-reviews/", Match::kPrefix, ShoppingPageType::kReviews},
+    {"/dp/", Match::kAnywhere, ShoppingPageType::kProduct},
+    {"/gp/product/", Match::kPrefix, ShoppingPageType::kProduct},
+    {"/gp/aw/d/", Match::kPrefix, ShoppingPageType::kProduct},
+    {"/sp", Match::kExact, ShoppingPageType::kSeller},
+    {"/stores/", Match::kPrefix, ShoppingPageType::kSeller},
+    {"/s", Match::kExact, ShoppingPageType::kSearch},
+    {"/s/", Match::kPrefix, ShoppingPageType::kSearch},
+};
+
+constexpr PathRule kAliExpressRules[] = {
+    {"/store/feedback-score/", Match::kPrefix, ShoppingPageType::kReviews},
+    {"/item/", Match::kPrefix, ShoppingPageType::kProduct},
+    {"/store/", Match::kPrefix, ShoppingPageType::kSeller},
+    {"/w/wholesale-", Match::kPrefix, ShoppingPageType::kSearch},
+    {"/wholesale", Match::kPrefix, ShoppingPageType::kSearch},
+};
+
+constexpr PathRule kEbayRules[] = {
+    {"/urw/", Match::kPrefix, ShoppingPageType::kReviews},
+    {"/fdbk/", Match::kPrefix, ShoppingPageType::kReviews},
+    {"/itm/", Match::kPrefix, ShoppingPageType::kProduct},
+    {"/str/", Match::kPrefix, ShoppingPageType::kSeller},
+    {"/usr/", Match::kPrefix, ShoppingPageType::kSeller},
+    {"/sch/", Match::kPrefix, ShoppingPageType::kSearch},
+};
+
+base::span<const PathRule> GetRules(mojom::Marketplace marketplace) {
+  switch (marketplace) {
+    case mojom::Marketplace::kAmazon:
+      return kAmazonRules;
+    case mojom::Marketplace::kAliExpress:
+      return kAliExpressRules;
+    case mojom::Marketplace::kEbay:
+      return kEbayRules;
+    case mojom::Marketplace::kUnknown:
+      return {};
+  }
+}
+
+bool Matches(const PathRule& rule, std::string_view path) {
+  switch (rule.match) {
+    case Match::kExact:
+      return path == rule.path;
+    case Match::kPrefix:
+      return base::StartsWith(path, rule.path);
+    case Match::kAnywhere:
+      return path.find(rule.path) != std::string_view::npos;
+  }
+}
+
+}  // namespace
+
+ShoppingPageType ClassifyShoppingPage(mojom::Marketplace marketplace,
+                                      const GURL& url) {
+  std::string_view path = url.path_piece();
+  for (const PathRule& rule : GetRules(marketplace)) {
+    if (Matches(rule, path)) {
+      return rule.type;
+    }
+  }
+  return ShoppingPageType::kOther;
+}
+
+}  // namespace safe_deal
@@ -0,0 +1,36 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_SHOPPING_PREDICTOR_CORE_SHOPPING_PAGE_TYPE_H_
+#define SAFE_DEAL_SHOPPING_PREDICTOR_CORE_SHOPPING_PAGE_TYPE_H_
+
+#include <stddef.h>
+
+#include "safe_deal/common/marketplace.mojom-shared.h"
+
+class GURL;
+
+namespace safe_deal {
+
+// The steps of a shopping session. Recorded in histograms; do not renumber.
+enum class ShoppingPageType {
+  kOther = 0,
+  kSearch = 1,
+  kProduct = 2,
+  kSeller = 3,
+  kReviews = 4,
+  kMaxValue = kReviews,
+};
+
+inline constexpr size_t kShoppingPageTypeCount =
+    static_cast<size_t>(ShoppingPageType::kMaxValue) + 1;
+
+// Classifies a page of |marketplace| from the path and query of |url| alone,
+// so that links can be classified before they are followed.
+ShoppingPageType ClassifyShoppingPage(mojom::Marketplace marketplace,
+                                      const GURL& url);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_SHOPPING_PREDICTOR_CORE_SHOPPING_PAGE_TYPE_H_
@@ -0,0 +1,81 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/shopping_predictor/core/shopping_transition_model.h"
+
+#include "base/check_op.h"
+
+namespace safe_deal {
+
+namespace {
+
+// Every transition scales the earlier counts of its row by this, so the
+// model mostly reflects the last 50 or so navigations from a page type.
+constexpr float kDecay = 0.98f;
+
+// The prior counts as this many navigations from every page type.
+constexpr float kPriorWeight = 4.0f;
+
+// Share of the next page types after each page type, in ShoppingPageType
+// order: other, search, product, seller, reviews.
+constexpr float kPrior[kShoppingPageTypeCount][kShoppingPageTypeCount] = {
+    /*kOther=*/{0.4f, 0.3f, 0.2f, 0.05f, 0.05f},
+    /*kSearch=*/{0.05f, 0.25f, 0.65f, 0.03f, 0.02f},
+    /*kProduct=*/{0.1f, 0.2f, 0.3f, 0.15f, 0.25f},
+    /*kSeller=*/{0.1f, 0.1f, 0.6f, 0.1f, 0.1f},
+    /*kReviews=*/{0.1f, 0.1f, 0.6f, 0.1f, 0.1f},
+};
+
+}  // namespace
+
+ShoppingTransitionModel::ShoppingTransitionModel() {
+  for (Matrix& matrix : matrices_) {
+    for (size_t from = 0; from < kShoppingPageTypeCount; ++from) {
+      Row& row = matrix[from];
+      row.total = 0;
+      for (size_t to = 0; to < kShoppingPageTypeCount; ++to) {
+        row.counts[to] = kPrior[from][to] * kPriorWeight;
+        row.total += row.counts[to];
+      }
+    }
+  }
+}
+
+ShoppingTransitionModel::~ShoppingTransitionModel() = default;
+
+void ShoppingTransitionModel::RecordTransition(mojom::Marketplace marketplace,
+                                               ShoppingPageType from,
+                                               ShoppingPageType to) {
+  Row& row = GetRow(marketplace, from);
+  for (float& count : row.counts) {
+    count *= kDecay;
+  }
+  row.counts[static_cast<size_t>(to)] += 1;
+  row.total = row.total * kDecay + 1;
+}
+
+double ShoppingTransitionModel::GetProbability(mojom::Marketplace marketplace,
+                                               ShoppingPageType from,
+                                               ShoppingPageType to) const {
+  const Row& row = GetRow(marketplace, from);
+  return row.counts[static_cast<size_t>(to)] / row.total;
+}
+
+ShoppingTransitionModel::Row& ShoppingTransitionModel::GetRow(
+    mojom::Marketplace marketplace,
+    ShoppingPageType from) {
+  DCHECK_LT(static_cast<size_t>(marketplace), kMarketplaceCount);
+  return matrices_[static_cast<size_t>(marketplace)]
+                  [static_cast<size_t>(from)];
+}
+
+const ShoppingTransitionModel::Row& ShoppingTransitionModel::GetRow(
+    mojom::Marketplace marketplace,
+    ShoppingPageType from) const {
+  DCHECK_LT(static_cast<size_t>(marketplace), kMarketplaceCount);
+  return matrices_[static_cast<size_t>(marketplace)]
+                  [static_cast<size_t>(from)];
+}
+
+}  // namespace safe_deal
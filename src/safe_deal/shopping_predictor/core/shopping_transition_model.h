@@ -0,0 +1,61 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_SHOPPING_PREDICTOR_CORE_SHOPPING_TRANSITION_MODEL_H_
+#define SAFE_DEAL_SHOPPING_PREDICTOR_CORE_SHOPPING_TRANSITION_MODEL_H_
+
+#include <stddef.h>
+
+#include <array>
+
+#include "safe_deal/common/marketplace.mojom-shared.h"
+#include "safe_deal/shopping_predictor/core/shopping_page_type.h"
+
+namespace safe_deal {
+
+// Learns how likely each type of marketplace page is to follow another in
+// the user's shopping sessions, e.g. how often a search leads to a product
+// page, separately for every marketplace. Starts from a prior that follows
+// the usual search, product, seller, reviews path, and weighs recent
+// transitions more, so a model of a few hundred bytes adapts to the user
+// within a few sessions.
+class ShoppingTransitionModel {
+ public:
+  ShoppingTransitionModel();
+  ShoppingTransitionModel(const ShoppingTransitionModel&) = delete;
+  ShoppingTransitionModel& operator=(const ShoppingTransitionModel&) = delete;
+  ~ShoppingTransitionModel();
+
+  // Records a navigation from a |from| page to a |to| page of |marketplace|.
+  void RecordTransition(mojom::Marketplace marketplace,
+                        ShoppingPageType from,
+                        ShoppingPageType to);
+
+  // Returns the estimated probability that the page after a |from| page of
+  // |marketplace| is a |to| page.
+  double GetProbability(mojom::Marketplace marketplace,
+                        ShoppingPageType from,
+                        ShoppingPageType to) const;
+
+ private:
+  static constexpr size_t kMarketplaceCount =
+      static_cast<size_t>(mojom::Marketplace::kMaxValue) + 1;
+
+  // Decayed transition counts to every page type, and their sum.
+  struct Row {
+    std::array<float, kShoppingPageTypeCount> counts;
+    float total;
+  };
+  using Matrix = std::array<Row, kShoppingPageTypeCount>;
+
+  Row& GetRow(mojom::Marketplace marketplace, ShoppingPageType from);
+  const Row& GetRow(mojom::Marketplace marketplace,
+                    ShoppingPageType from) const;
+
+  std::array<Matrix, kMarketplaceCount> matrices_;
+};
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_SHOPPING_PREDICTOR_CORE_SHOPPING_TRANSITION_MODEL_H_
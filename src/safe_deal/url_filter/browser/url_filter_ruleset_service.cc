@@ -0,0 +1,94 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/browser/url_filter_ruleset_service.h"
+
+#include <utility>
+
+#include "base/base_paths.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/path_service.h"
+#include "base/task/thread_pool.h"
+#include "safe_deal/common/safe_deal_startup_metrics.h"
+#include "safe_deal/url_filter/core/memory_mapped_ruleset.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+constexpr base::FilePath::CharType kRulesetFileName[] =
+    FILE_PATH_LITERAL("safe_deal_url_filter.ruleset");  // See url_filter.gni.
+
+UrlFilterRulesetService::LoadedRuleset OpenAndVerifyRuleset(
+    const base::FilePath& path) {
+  SafeDealStartupMetrics::Scope scope("OpenAndVerifyRuleset");
+  base::File file(path, base::File::FLAG_OPEN | base::File::FLAG_READ);
+  base::File duplicate = file.Duplicate();
+  scoped_refptr<MemoryMappedRuleset> ruleset =
+      MemoryMappedRuleset::Create(std::move(duplicate));
+  bool valid =
+      ruleset && UrlRulesetMatcher::VerifyChecksum(ruleset->data());
+  base::UmaHistogramBoolean("SafeDeal.UrlFilter.RulesetValid", valid);
+  if (!valid) {
+    return {};
+  }
+  base::UmaHistogramCounts1M("SafeDeal.UrlFilter.RuleCount",
+                             ruleset->matcher().rule_count());
+  return {std::move(file), ruleset->data().size()};
+}
+
+}  // namespace
+
+UrlFilterRulesetService::LoadedRuleset::LoadedRuleset() = default;
+UrlFilterRulesetService::LoadedRuleset::LoadedRuleset(base::File file,
+                                                      size_t size)
+    : file(std::move(file)), size(size) {}
+UrlFilterRulesetService::LoadedRuleset::LoadedRuleset(LoadedRuleset&&) =
+    default;
+UrlFilterRulesetService::LoadedRuleset&
+UrlFilterRulesetService::LoadedRuleset::operator=(LoadedRuleset&&) = default;
+UrlFilterRulesetService::LoadedRuleset::~LoadedRuleset() = default;
+
+UrlFilterRulesetService::UrlFilterRulesetService(base::FilePath ruleset_path)
+    : ruleset_path_(std::move(ruleset_path)) {}
+
+UrlFilterRulesetService::~UrlFilterRulesetService() = default;
+
+// static
+base::FilePath UrlFilterRulesetService::GetDefaultRulesetPath() {
+  base::FilePath assets_dir;
+  if (!base::PathService::Get(base::DIR_ASSETS, &assets_dir)) {
+    return base::FilePath();
+  }
+  return assets_dir.Append(kRulesetFileName);
+}
+
+void UrlFilterRulesetService::Load(base::OnceClosure on_ready) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE,
+      {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+       base::TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+      base::BindOnce(&OpenAndVerifyRuleset, ruleset_path_),
+      base::BindOnce(&UrlFilterRulesetService::OnLoaded,
+                     weak_factory_.GetWeakPtr(), std::move(on_ready)));
+}
+
+base::File UrlFilterRulesetService::DuplicateRulesetFile() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return ruleset_file_.IsValid() ? ruleset_file_.Duplicate() : base::File();
+}
+
+void UrlFilterRulesetService::OnLoaded(base::OnceClosure on_ready,
+                                       LoadedRuleset ruleset) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!ruleset.file.IsValid()) {
+    return;
+  }
+  ruleset_file_ = std::move(ruleset.file);
+  ruleset_size_ = ruleset.size;
+  std::move(on_ready).Run();
+}
+
+}  // namespace safe_deal::url_filter
@@ -0,0 +1,69 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_BROWSER_URL_FILTER_RULESET_SERVICE_H_
+#define SAFE_DEAL_URL_FILTER_BROWSER_URL_FILTER_RULESET_SERVICE_H_
+
+#include <stddef.h>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/functional/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+
+namespace safe_deal::url_filter {
+
+// Opens the compiled ruleset shipped with the browser and verifies its
+// checksum once, off the UI thread, so that renderers can map it without
+// reading it. Lives on the UI thread.
+class UrlFilterRulesetService {
+ public:
+  explicit UrlFilterRulesetService(base::FilePath ruleset_path);
+  UrlFilterRulesetService(const UrlFilterRulesetService&) = delete;
+  UrlFilterRulesetService& operator=(const UrlFilterRulesetService&) = delete;
+  ~UrlFilterRulesetService();
+
+  // Returns the default ruleset location, next to the browser executable.
+  static base::FilePath GetDefaultRulesetPath();
+
+  // Loads the ruleset in the background and runs |on_ready| if it is valid.
+  void Load(base::OnceClosure on_ready);
+
+  bool is_ready() const { return ruleset_file_.IsValid(); }
+
+  // Size of the ruleset, which every renderer maps. 0 until it is ready.
+  size_t ruleset_size() const { return ruleset_size_; }
+
+  // Returns a read-only handle to the verified ruleset for a renderer, or an
+  // invalid file if it is not ready.
+  base::File DuplicateRulesetFile() const;
+
+  // The result of loading the ruleset in the background. |file| is invalid if
+  // the ruleset is missing or corrupt.
+  struct LoadedRuleset {
+    LoadedRuleset();
+    LoadedRuleset(base::File file, size_t size);
+    LoadedRuleset(LoadedRuleset&&);
+    LoadedRuleset& operator=(LoadedRuleset&&);
+    ~LoadedRuleset();
+
+    base::File file;
+    size_t size = 0;
+  };
+
+ private:
+  void OnLoaded(base::OnceClosure on_ready, LoadedRuleset ruleset);
+
+  const base::FilePath ruleset_path_;
+  base::File ruleset_file_;
+  size_t ruleset_size_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+  base::WeakPtrFactory<UrlFilterRulesetService> weak_factory_{this};
+};
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_BROWSER_URL_FILTER_RULESET_SERVICE_H_
@@ -0,0 +1,224 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/filter_rule_parser.h"
+
+#include <utility>
+
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "safe_deal/url_filter/core/url_filter_types.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+struct ElementTypeOption {
+  std::string_view name;
+  uint16_t type;
+};
+
+constexpr ElementTypeOption kElementTypeOptions[] = {
+    {"other", kElementTypeOther},
+    {"script", kElementTypeScript},
+    {"image", kElementTypeImage},
+    {"stylesheet", kElementTypeStylesheet},
+    {"object", kElementTypeObject},
+    {"object-subrequest", kElementTypeObject},
+    {"xmlhttprequest", kElementTypeXmlHttpRequest},
+    {"subdocument", kElementTypeSubdocument},
+    {"font", kElementTypeFont},
+    {"media", kElementTypeMedia},
+    {"websocket", kElementTypeWebSocket},
+    {"ping", kElementTypePing},
+};
+
+// Options that only make sense for cosmetic filtering, popup blocking or
+// request rewriting. Rules using them are skipped rather than being applied
+// with the wrong meaning.
+constexpr std::string_view kUnsupportedOptions[] = {
+    "csp",         "document",    "elemhide", "generichide",
+    "genericblock", "header",     "permissions", "popup",
+    "redirect",    "redirect-rule", "removeparam", "replace",
+    "rewrite",     "urltransform",
+};
+
+bool IsCosmeticRule(std::string_view line) {
+  return line.find("##") != std::string_view::npos ||
+         line.find("#@#") != std::string_view::npos ||
+         line.find("#?#") != std::string_view::npos ||
+         line.find("#$#") != std::string_view::npos;
+}
+
+ParseResult ParseOptions(std::string_view options, FilterRule& rule) {
+  uint16_t included_types = 0;
+  uint16_t excluded_types = 0;
+  bool match_case = false;
+
+  for (std::string_view option : base::SplitStringPiece(
+           options, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    bool inverted = option.front() == '~';
+    if (inverted) {
+      option.remove_prefix(1);
+    }
+    std::string name = base::ToLowerASCII(option.substr(0, option.find('=')));
+
+    if (name == "domain") {
+      if (inverted || option.size() <= name.size() + 1) {
+        return ParseResult::kInvalid;
+      }
+      for (std::string_view domain : base::SplitStringPiece(
+               option.substr(name.size() + 1), "|", base::TRIM_WHITESPACE,
+               base::SPLIT_WANT_NONEMPTY)) {
+        bool excluded = domain.front() == '~';
+        if (excluded) {
+          domain.remove_prefix(1);
+        }
+        if (domain.empty()) {
+          return ParseResult::kInvalid;
+        }
+        (excluded ? rule.exclude_domains : rule.include_domains)
+            .push_back(base::ToLowerASCII(domain));
+      }
+      continue;
+    }
+    if (name == "third-party" || name == "3p") {
+      rule.flags |= inverted ? kRuleFlagFirstParty : kRuleFlagThirdParty;
+      continue;
+    }
+    if (name == "first-party" || name == "1p") {
+      rule.flags |= inverted ? kRuleFlagThirdParty : kRuleFlagFirstParty;
+      continue;
+    }
+    if (name == "match-case") {
+      match_case = !inverted;
+      continue;
+    }
+    if (name == "important") {
+      // Exceptions always win in this matcher; the rule still applies.
+      continue;
+    }
+
+    bool known_type = false;
+    for (const ElementTypeOption& type : kElementTypeOptions) {
+      if (name == type.name) {
+        (inverted ? excluded_types : included_types) |= type.type;
+        known_type = true;
+        break;
+      }
+    }
+    if (known_type) {
+      continue;
+    }
+    for (std::string_view unsupported : kUnsupportedOptions) {
+      if (name == unsupported) {
+        return ParseResult::kUnsupported;
+      }
+    }
+    return ParseResult::kInvalid;
+  }
+
+  if ((rule.flags & kRuleFlagFirstParty) &&
+      (rule.flags & kRuleFlagThirdParty)) {
+    return ParseResult::kInvalid;
+  }
+  uint16_t types = included_types ? included_types : uint16_t{kElementTypeAll};
+  rule.element_types = types & ~excluded_types;
+  if (!rule.element_types) {
+    return ParseResult::kInvalid;
+  }
+  if (match_case) {
+    rule.flags |= kRuleFlagMatchCase;
+  }
+  return ParseResult::kRule;
+}
+
+}  // namespace
+
+FilterRule::FilterRule() = default;
+FilterRule::FilterRule(const FilterRule&) = default;
+FilterRule::FilterRule(FilterRule&&) = default;
+FilterRule& FilterRule::operator=(const FilterRule&) = default;
+FilterRule& FilterRule::operator=(FilterRule&&) = default;
+FilterRule::~FilterRule() = default;
+
+ParseResult ParseFilterRule(std::string_view line, FilterRule& rule) {
+  line = base::TrimWhitespaceASCII(line, base::TRIM_ALL);
+  if (line.empty() || line.front() == '!' || line.front() == '[') {
+    return ParseResult::kIgnored;
+  }
+  if (IsCosmeticRule(line)) {
+    return ParseResult::kUnsupported;
+  }
+
+  FilterRule result;
+  if (base::StartsWith(line, "@@")) {
+    result.flags |= kRuleFlagException;
+    line.remove_prefix(2);
+  }
+
+  std::string_view pattern = line;
+  size_t options_pos = line.rfind('$');
+  // "/ads$/" is a regular expression, not a pattern with options.
+  if (options_pos != std::string_view::npos &&
+      !(line.front() == '/' && line.back() == '/')) {
+    pattern = line.substr(0, options_pos);
+    ParseResult options_result =
+        ParseOptions(line.substr(options_pos + 1), result);
+    if (options_result != ParseResult::kRule) {
+      return options_result;
+    }
+  } else {
+    result.element_types = kElementTypeAll;
+  }
+
+  if (pattern.size() > 1 && pattern.front() == '/' && pattern.back() == '/') {
+    return ParseResult::kUnsupported;
+  }
+  if (base::StartsWith(pattern, "||")) {
+    result.flags |= kRuleFlagAnchorSubdomain;
+    pattern.remove_prefix(2);
+  } else if (base::StartsWith(pattern, "|")) {
+    result.flags |= kRuleFlagAnchorLeft;
+    pattern.remove_prefix(1);
+  }
+  if (base::EndsWith(pattern, "|")) {
+    result.flags |= kRuleFlagAnchorRight;
+    pattern.remove_suffix(1);
+  }
+
+  // Leading and trailing wildcards are implied unless anchored, and runs of
+  // wildcards are equivalent to one.
+  std::string normalized;
+  normalized.reserve(pattern.size());
+  for (char c : pattern) {
+    if (c == '*' && !normalized.empty() && normalized.back() == '*') {
+      continue;
+    }
+    normalized.push_back(c);
+  }
+  if (!(result.flags & (kRuleFlagAnchorLeft | kRuleFlagAnchorSubdomain))) {
+    while (!normalized.empty() && normalized.front() == '*') {
+      normalized.erase(normalized.begin());
+    }
+  }
+  if (!(result.flags & kRuleFlagAnchorRight)) {
+    while (!normalized.empty() && normalized.back() == '*') {
+      normalized.pop_back();
+    }
+  }
+  if (normalized.empty() && result.include_domains.empty() &&
+      !(result.flags & kRuleFlagException)) {
+    // A rule that blocks everything everywhere is almost certainly a typo.
+    return ParseResult::kInvalid;
+  }
+  if (!(result.flags & kRuleFlagMatchCase)) {
+    normalized = base::ToLowerASCII(normalized);
+  }
+  result.pattern = std::move(normalized);
+  rule = std::move(result);
+  return ParseResult::kRule;
+}
+
+}  // namespace safe_deal::url_filter
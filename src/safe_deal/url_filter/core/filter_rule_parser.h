@@ -0,0 +1,53 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_CORE_FILTER_RULE_PARSER_H_
+#define SAFE_DEAL_URL_FILTER_CORE_FILTER_RULE_PARSER_H_
+
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace safe_deal::url_filter {
+
+// A network rule in EasyList (Adblock Plus) syntax, e.g.
+// "||ads.example.com^$script,third-party,domain=example.org|~shop.org".
+// Only used when compiling rulesets; the browser never parses text lists.
+struct FilterRule {
+  FilterRule();
+  FilterRule(const FilterRule&);
+  FilterRule(FilterRule&&);
+  FilterRule& operator=(const FilterRule&);
+  FilterRule& operator=(FilterRule&&);
+  ~FilterRule();
+
+  // Pattern without anchors, lower cased unless the rule is $match-case.
+  std::string pattern;
+  // Combination of RuleFlag values.
+  uint8_t flags = 0;
+  // Combination of ElementType values.
+  uint16_t element_types = 0;
+  std::vector<std::string> include_domains;
+  std::vector<std::string> exclude_domains;
+};
+
+enum class ParseResult {
+  kRule,
+  // Comments, blank lines and the "[Adblock Plus 2.0]" header.
+  kIgnored,
+  // Element hiding, regular expression, and rules with options such as
+  // $redirect or $csp that a blocking matcher cannot honor.
+  kUnsupported,
+  kInvalid,
+};
+
+// Parses one line of a filter list. |rule| is only written for kRule.
+ParseResult ParseFilterRule(std::string_view line, FilterRule& rule);
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_CORE_FILTER_RULE_PARSER_H_
@@ -0,0 +1,94 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/filter_rule_parser.h"
+
+#include <string>
+#include <vector>
+
+#include "safe_deal/url_filter/core/url_filter_types.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+ParseResult Parse(std::string_view line) {
+  FilterRule rule;
+  return ParseFilterRule(line, rule);
+}
+
+TEST(FilterRuleParserTest, Anchors) {
+  FilterRule rule;
+  ASSERT_EQ(ParseResult::kRule,
+            ParseFilterRule("||Ads.Example.com^", rule));
+  EXPECT_EQ("ads.example.com^", rule.pattern);
+  EXPECT_EQ(kRuleFlagAnchorSubdomain, rule.flags);
+  EXPECT_EQ(kElementTypeAll, rule.element_types);
+
+  ASSERT_EQ(ParseResult::kRule, ParseFilterRule("|https://x.com/*.gif|", rule));
+  EXPECT_EQ("https://x.com/*.gif", rule.pattern);
+  EXPECT_EQ(kRuleFlagAnchorLeft | kRuleFlagAnchorRight, rule.flags);
+}
+
+TEST(FilterRuleParserTest, Wildcards) {
+  FilterRule rule;
+  ASSERT_EQ(ParseResult::kRule, ParseFilterRule("**/banner/***/ad**", rule));
+  EXPECT_EQ("/banner/*/ad", rule.pattern);
+  // Anchored ends keep their wildcard.
+  ASSERT_EQ(ParseResult::kRule, ParseFilterRule("|*ad*|", rule));
+  EXPECT_EQ("*ad*", rule.pattern);
+}
+
+TEST(FilterRuleParserTest, Options) {
+  FilterRule rule;
+  ASSERT_EQ(ParseResult::kRule,
+            ParseFilterRule("@@||cdn.com/Ads^$script,image,third-party,"
+                            "match-case,domain=shop.com|~Checkout.shop.com",
+                            rule));
+  EXPECT_EQ("cdn.com/Ads^", rule.pattern);
+  EXPECT_EQ(kRuleFlagException | kRuleFlagAnchorSubdomain |
+                kRuleFlagThirdParty | kRuleFlagMatchCase,
+            rule.flags);
+  EXPECT_EQ(kElementTypeScript | kElementTypeImage, rule.element_types);
+  EXPECT_EQ(std::vector<std::string>{"shop.com"}, rule.include_domains);
+  EXPECT_EQ(std::vector<std::string>{"checkout.shop.com"},
+            rule.exclude_domains);
+
+  ASSERT_EQ(ParseResult::kRule, ParseFilterRule("/ads^$~third-party", rule));
+  EXPECT_EQ(kRuleFlagFirstParty, rule.flags);
+  ASSERT_EQ(ParseResult::kRule, ParseFilterRule("/ads^$~image", rule));
+  EXPECT_EQ(kElementTypeAll & ~kElementTypeImage, rule.element_types);
+}
+
+TEST(FilterRuleParserTest, IgnoredAndUnsupported) {
+  EXPECT_EQ(ParseResult::kIgnored, Parse(""));
+  EXPECT_EQ(ParseResult::kIgnored, Parse("  "));
+  EXPECT_EQ(ParseResult::kIgnored, Parse("! comment"));
+  EXPECT_EQ(ParseResult::kIgnored, Parse("[Adblock Plus 2.0]"));
+  EXPECT_EQ(ParseResult::kUnsupported, Parse("example.com##.ad"));
+  EXPECT_EQ(ParseResult::kUnsupported, Parse("example.com#@#.ad"));
+  EXPECT_EQ(ParseResult::kUnsupported, Parse("/ads?[0-9]/"));
+  EXPECT_EQ(ParseResult::kUnsupported, Parse("/ads$/"));
+  EXPECT_EQ(ParseResult::kUnsupported, Parse("||x.com^$redirect=noop.js"));
+  EXPECT_EQ(ParseResult::kUnsupported, Parse("||x.com^$popup"));
+}
+
+TEST(FilterRuleParserTest, Invalid) {
+  EXPECT_EQ(ParseResult::kInvalid, Parse("/ads^$unknown-option"));
+  EXPECT_EQ(ParseResult::kInvalid, Parse("/ads^$third-party,first-party"));
+  EXPECT_EQ(ParseResult::kInvalid, Parse("/ads^$domain="));
+  EXPECT_EQ(ParseResult::kInvalid, Parse("/ads^$domain=a.com|~"));
+  EXPECT_EQ(ParseResult::kInvalid, Parse("/ads^$~domain=a.com"));
+  EXPECT_EQ(ParseResult::kInvalid, Parse("/ads^$image,~image"));
+  // Rules that would block everything.
+  EXPECT_EQ(ParseResult::kInvalid, Parse("*"));
+  EXPECT_EQ(ParseResult::kInvalid, Parse("$script"));
+  EXPECT_EQ(ParseResult::kRule, Parse("$script,domain=a.com"));
+  EXPECT_EQ(ParseResult::kRule, Parse("@@*$image"));
+}
+
+}  // namespace
+
+}  // namespace safe_deal::url_filter
@@ -0,0 +1,105 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_CORE_FLAT_RULESET_FORMAT_H_
+#define SAFE_DEAL_URL_FILTER_CORE_FLAT_RULESET_FORMAT_H_
+
+#include <stdint.h>
+
+// Layout of a compiled ruleset. The file is produced offline by
+// safe_deal_url_filter_compiler and mapped read-only by every process that
+// matches requests; nothing in it needs to be parsed or copied before use.
+// All integers are little endian and every section is 4-byte aligned.
+// Offsets are relative to the start of the file.
+//
+// Rules are split into a blocking and an allowlist index. Within an index
+// each rule is reachable through exactly one of:
+//  - the token table, keyed by the hash of the rarest token the rule
+//    guarantees will appear as a whole token in any URL it matches;
+//  - the fingerprint table, keyed by the first three bytes of the rule's
+//    longest literal, for rules without such a token. A Teddy style
+//    nibble-mask prefilter over the URL finds the offsets worth looking up;
+//  - the fallback list, checked for every request, for rules that have
+//    neither. The compiler keeps this list short.
+namespace safe_deal::url_filter::flat {
+
+inline constexpr uint32_t kMagic = 0x46554453;  // "SDUF"
+// Bump whenever the layout below changes.
+inline constexpr uint32_t kVersion = 1;
+
+// Number of Teddy buckets; each bit of a mask byte is one bucket.
+inline constexpr int kTeddyBuckets = 8;
+// Bytes of a literal covered by a fingerprint.
+inline constexpr int kFingerprintLength = 3;
+
+struct Rule {
+  uint32_t pattern_offset;
+  uint16_t pattern_length;
+  // Combination of RuleFlag values.
+  uint8_t flags;
+  uint8_t reserved;
+  // Combination of ElementType values.
+  uint16_t element_types;
+  uint8_t include_domain_count;
+  uint8_t exclude_domain_count;
+  // Index into the domain hash array; include domains come first.
+  uint32_t domains_index;
+};
+
+// Open addressing hash table bucket. |key| is zero for empty buckets.
+struct HashBucket {
+  uint32_t key;
+  // Range of the rule list array holding the bucket's rule indices.
+  uint32_t list_index;
+  uint32_t list_length;
+};
+
+// Nibble masks for the Teddy prefilter: for byte position i of a
+// fingerprint, bit b of low[i][n] is set if some fingerprint in bucket b has
+// a low nibble n at position i, and likewise for high nibbles.
+struct TeddyMasks {
+  uint8_t low[kFingerprintLength][16];
+  uint8_t high[kFingerprintLength][16];
+};
+
+struct Index {
+  uint32_t token_table_offset;
+  // Power of two, or zero.
+  uint32_t token_table_size;
+  uint32_t fingerprint_table_offset;
+  uint32_t fingerprint_table_size;
+  TeddyMasks teddy;
+  uint32_t fallback_list_index;
+  uint32_t fallback_list_length;
+};
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t total_size;
+  // base::PersistentHash() of everything after the header.
+  uint32_t checksum;
+
+  uint32_t rules_offset;
+  uint32_t rule_count;
+  uint32_t pattern_pool_offset;
+  uint32_t pattern_pool_size;
+  uint32_t domain_hashes_offset;
+  uint32_t domain_hash_count;
+  uint32_t rule_lists_offset;
+  uint32_t rule_list_entry_count;
+
+  Index block_index;
+  Index allow_index;
+};
+
+static_assert(sizeof(Rule) == 16);
+static_assert(sizeof(HashBucket) == 12);
+static_assert(sizeof(TeddyMasks) == 96);
+static_assert(sizeof(Index) == 120);
+static_assert(sizeof(Header) == 288);
+
+}  // namespace safe_deal::url_filter::flat
+
+#endif  // SAFE_DEAL_URL_FILTER_CORE_FLAT_RULESET_FORMAT_H_
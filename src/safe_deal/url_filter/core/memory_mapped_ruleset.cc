@@ -0,0 +1,32 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/memory_mapped_ruleset.h"
+
+#include <utility>
+
+namespace safe_deal::url_filter {
+
+// static
+scoped_refptr<MemoryMappedRuleset> MemoryMappedRuleset::Create(
+    base::File file) {
+  if (!file.IsValid()) {
+    return nullptr;
+  }
+  scoped_refptr<MemoryMappedRuleset> ruleset =
+      base::WrapRefCounted(new MemoryMappedRuleset());
+  if (!ruleset->mapped_file_.Initialize(std::move(file))) {
+    return nullptr;
+  }
+  ruleset->matcher_ = UrlRulesetMatcher::Create(ruleset->data());
+  if (!ruleset->matcher_) {
+    return nullptr;
+  }
+  return ruleset;
+}
+
+MemoryMappedRuleset::MemoryMappedRuleset() = default;
+MemoryMappedRuleset::~MemoryMappedRuleset() = default;
+
+}  // namespace safe_deal::url_filter
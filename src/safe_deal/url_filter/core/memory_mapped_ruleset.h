@@ -0,0 +1,45 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_CORE_MEMORY_MAPPED_RULESET_H_
+#define SAFE_DEAL_URL_FILTER_CORE_MEMORY_MAPPED_RULESET_H_
+
+#include "base/files/file.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/ref_counted.h"
+#include "safe_deal/url_filter/core/url_ruleset_matcher.h"
+
+namespace safe_deal::url_filter {
+
+// A compiled ruleset mapped read-only from a file, together with its
+// matcher. Shared between the threads that create URL loader throttles;
+// pages are faulted in on demand, so an unused ruleset costs address space
+// only.
+class MemoryMappedRuleset
+    : public base::RefCountedThreadSafe<MemoryMappedRuleset> {
+ public:
+  // Maps |file|. Returns null if it cannot be mapped or is not a ruleset of
+  // the current version. The checksum is not verified; see
+  // UrlRulesetMatcher::VerifyChecksum().
+  static scoped_refptr<MemoryMappedRuleset> Create(base::File file);
+
+  MemoryMappedRuleset(const MemoryMappedRuleset&) = delete;
+  MemoryMappedRuleset& operator=(const MemoryMappedRuleset&) = delete;
+
+  base::span<const uint8_t> data() const { return mapped_file_.bytes(); }
+  const UrlRulesetMatcher& matcher() const { return *matcher_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<MemoryMappedRuleset>;
+
+  MemoryMappedRuleset();
+  ~MemoryMappedRuleset();
+
+  base::MemoryMappedFile mapped_file_;
+  std::optional<UrlRulesetMatcher> matcher_;
+};
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_CORE_MEMORY_MAPPED_RULESET_H_
@@ -0,0 +1,267 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/ruleset_builder.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <map>
+#include <string_view>
+
+#include "base/containers/span.h"
+#include "base/hash/hash.h"
+#include "base/numerics/safe_conversions.h"
+#include "safe_deal/url_filter/core/flat_ruleset_format.h"
+#include "safe_deal/url_filter/core/teddy_prefilter.h"
+#include "safe_deal/url_filter/core/url_filter_types.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+// Tokens this short are looked up for every URL anyway, but are so common
+// that keying rules by them makes those lookups expensive.
+constexpr size_t kMinTokenLength = 2;
+
+struct TokenCandidate {
+  uint32_t hash;
+  size_t length;
+};
+
+// Returns the tokens of |rule| that appear as whole tokens in every URL the
+// rule matches: runs of token characters not adjacent to a wildcard, or to
+// an open pattern end.
+std::vector<TokenCandidate> GetRuleTokens(const FilterRule& rule) {
+  std::vector<TokenCandidate> tokens;
+  std::string_view pattern = rule.pattern;
+  size_t pos = 0;
+  while (pos < pattern.size()) {
+    if (!IsTokenChar(pattern[pos])) {
+      ++pos;
+      continue;
+    }
+    size_t begin = pos;
+    while (pos < pattern.size() && IsTokenChar(pattern[pos])) {
+      ++pos;
+    }
+    bool left_bounded =
+        begin > 0 ? pattern[begin - 1] != '*'
+                  : (rule.flags &
+                     (kRuleFlagAnchorLeft | kRuleFlagAnchorSubdomain)) != 0;
+    bool right_bounded = pos < pattern.size()
+                             ? pattern[pos] != '*'
+                             : (rule.flags & kRuleFlagAnchorRight) != 0;
+    if (left_bounded && right_bounded && pos - begin >= kMinTokenLength) {
+      tokens.push_back(
+          {HashToken(pattern.data() + begin, pos - begin), pos - begin});
+    }
+  }
+  return tokens;
+}
+
+// Returns the fingerprint key of the longest literal run of |rule|, or zero
+// if it has none long enough.
+uint32_t GetRuleFingerprint(const FilterRule& rule) {
+  std::string_view pattern = rule.pattern;
+  size_t best_begin = 0;
+  size_t best_length = 0;
+  size_t pos = 0;
+  while (pos < pattern.size()) {
+    if (pattern[pos] == '*' || pattern[pos] == '^') {
+      ++pos;
+      continue;
+    }
+    size_t begin = pos;
+    while (pos < pattern.size() && pattern[pos] != '*' && pattern[pos] != '^') {
+      ++pos;
+    }
+    if (pos - begin > best_length) {
+      best_begin = begin;
+      best_length = pos - begin;
+    }
+  }
+  if (best_length < static_cast<size_t>(flat::kFingerprintLength)) {
+    return 0;
+  }
+  return MakeFingerprintKey(pattern.data() + best_begin);
+}
+
+// Rules of one index grouped by how they are reached.
+struct IndexContents {
+  std::map<uint32_t, std::vector<uint32_t>> token_buckets;
+  std::map<uint32_t, std::vector<uint32_t>> fingerprint_buckets;
+  std::vector<uint32_t> fallback;
+};
+
+void AssignRulesToIndex(const std::vector<FilterRule>& rules,
+                        const std::vector<uint32_t>& rule_indices,
+                        IndexContents& contents) {
+  std::vector<std::vector<TokenCandidate>> rule_tokens;
+  rule_tokens.reserve(rule_indices.size());
+  std::map<uint32_t, size_t> token_counts;
+  for (uint32_t rule_index : rule_indices) {
+    rule_tokens.push_back(GetRuleTokens(rules[rule_index]));
+    for (const TokenCandidate& token : rule_tokens.back()) {
+      ++token_counts[token.hash];
+    }
+  }
+
+  for (size_t i = 0; i < rule_indices.size(); ++i) {
+    const std::vector<TokenCandidate>& tokens = rule_tokens[i];
+    if (!tokens.empty()) {
+      // The rarest token keeps buckets short; longer tokens break ties since
+      // they are less likely to occur in unrelated URLs.
+      const TokenCandidate& best = *std::ranges::min_element(
+          tokens, [&](const TokenCandidate& a, const TokenCandidate& b) {
+            size_t a_count = token_counts[a.hash];
+            size_t b_count = token_counts[b.hash];
+            return a_count != b_count ? a_count < b_count
+                                      : a.length > b.length;
+          });
+      contents.token_buckets[best.hash].push_back(rule_indices[i]);
+      continue;
+    }
+    if (uint32_t fingerprint = GetRuleFingerprint(rules[rule_indices[i]])) {
+      contents.fingerprint_buckets[fingerprint].push_back(rule_indices[i]);
+      continue;
+    }
+    contents.fallback.push_back(rule_indices[i]);
+  }
+}
+
+template <typename T>
+void AppendSection(std::vector<uint8_t>& output,
+                   base::span<const T> values,
+                   uint32_t& offset) {
+  offset = base::checked_cast<uint32_t>(output.size());
+  base::span<const uint8_t> bytes = base::as_bytes(values);
+  output.insert(output.end(), bytes.begin(), bytes.end());
+  output.resize((output.size() + 3) & ~size_t{3});
+}
+
+// Appends the rule lists of |buckets| to |rule_lists| and returns an open
+// addressing table over them, sized to stay at most half full.
+std::vector<flat::HashBucket> BuildHashTable(
+    const std::map<uint32_t, std::vector<uint32_t>>& buckets,
+    std::vector<uint32_t>& rule_lists) {
+  if (buckets.empty()) {
+    return {};
+  }
+  uint32_t size = std::bit_ceil(
+      base::checked_cast<uint32_t>(buckets.size() * 2));
+  uint32_t mask = size - 1;
+  std::vector<flat::HashBucket> table(size);
+  for (const auto& [key, list] : buckets) {
+    uint32_t slot = (key * 2654435761u) & mask;
+    while (table[slot].key) {
+      slot = (slot + 1) & mask;
+    }
+    table[slot] = {key, base::checked_cast<uint32_t>(rule_lists.size()),
+                   base::checked_cast<uint32_t>(list.size())};
+    rule_lists.insert(rule_lists.end(), list.begin(), list.end());
+  }
+  return table;
+}
+
+}  // namespace
+
+RulesetBuilder::RulesetBuilder() = default;
+RulesetBuilder::~RulesetBuilder() = default;
+
+bool RulesetBuilder::AddRule(const FilterRule& rule) {
+  constexpr size_t kMaxDomains = std::numeric_limits<uint8_t>::max();
+  if (rule.pattern.size() > std::numeric_limits<uint16_t>::max() ||
+      rule.include_domains.size() > kMaxDomains ||
+      rule.exclude_domains.size() > kMaxDomains) {
+    return false;
+  }
+  rules_.push_back(rule);
+  return true;
+}
+
+std::vector<uint8_t> RulesetBuilder::Build() const {
+  std::vector<flat::Rule> rules;
+  std::vector<char> patterns;
+  std::vector<uint32_t> domain_hashes;
+  std::vector<uint32_t> block_rules;
+  std::vector<uint32_t> allow_rules;
+  rules.reserve(rules_.size());
+  for (const FilterRule& rule : rules_) {
+    flat::Rule& flat_rule = rules.emplace_back();
+    flat_rule.pattern_offset = base::checked_cast<uint32_t>(patterns.size());
+    flat_rule.pattern_length = base::checked_cast<uint16_t>(rule.pattern.size());
+    flat_rule.flags = rule.flags;
+    flat_rule.element_types = rule.element_types;
+    flat_rule.include_domain_count =
+        base::checked_cast<uint8_t>(rule.include_domains.size());
+    flat_rule.exclude_domain_count =
+        base::checked_cast<uint8_t>(rule.exclude_domains.size());
+    flat_rule.domains_index = base::checked_cast<uint32_t>(domain_hashes.size());
+    patterns.insert(patterns.end(), rule.pattern.begin(), rule.pattern.end());
+    for (const auto* domains : {&rule.include_domains, &rule.exclude_domains}) {
+      for (const std::string& domain : *domains) {
+        domain_hashes.push_back(HashToken(domain.data(), domain.size()));
+      }
+    }
+    ((rule.flags & kRuleFlagException) ? allow_rules : block_rules)
+        .push_back(base::checked_cast<uint32_t>(rules.size() - 1));
+  }
+
+  std::vector<uint8_t> output(sizeof(flat::Header));
+  flat::Header header = {};
+  header.magic = flat::kMagic;
+  header.version = flat::kVersion;
+
+  std::vector<uint32_t> rule_lists;
+  std::vector<flat::HashBucket> tables[4];
+  for (int i = 0; i < 2; ++i) {
+    IndexContents contents;
+    AssignRulesToIndex(rules_, i == 0 ? block_rules : allow_rules, contents);
+    flat::Index& index = i == 0 ? header.block_index : header.allow_index;
+    tables[2 * i] = BuildHashTable(contents.token_buckets, rule_lists);
+    tables[2 * i + 1] = BuildHashTable(contents.fingerprint_buckets, rule_lists);
+    index.token_table_size = tables[2 * i].size();
+    index.fingerprint_table_size = tables[2 * i + 1].size();
+    for (const auto& [key, list] : contents.fingerprint_buckets) {
+      AddFingerprintToTeddyMasks(key, GetTeddyBucket(key), index.teddy);
+    }
+    index.fallback_list_index = base::checked_cast<uint32_t>(rule_lists.size());
+    index.fallback_list_length =
+        base::checked_cast<uint32_t>(contents.fallback.size());
+    rule_lists.insert(rule_lists.end(), contents.fallback.begin(),
+                      contents.fallback.end());
+  }
+
+  header.rule_count = base::checked_cast<uint32_t>(rules.size());
+  AppendSection(output, base::span<const flat::Rule>(rules),
+                header.rules_offset);
+  header.domain_hash_count = base::checked_cast<uint32_t>(domain_hashes.size());
+  AppendSection(output, base::span<const uint32_t>(domain_hashes),
+                header.domain_hashes_offset);
+  header.rule_list_entry_count =
+      base::checked_cast<uint32_t>(rule_lists.size());
+  AppendSection(output, base::span<const uint32_t>(rule_lists),
+                header.rule_lists_offset);
+  AppendSection(output, base::span<const flat::HashBucket>(tables[0]),
+                header.block_index.token_table_offset);
+  AppendSection(output, base::span<const flat::HashBucket>(tables[1]),
+                header.block_index.fingerprint_table_offset);
+  AppendSection(output, base::span<const flat::HashBucket>(tables[2]),
+                header.allow_index.token_table_offset);
+  AppendSection(output, base::span<const flat::HashBucket>(tables[3]),
+                header.allow_index.fingerprint_table_offset);
+  header.pattern_pool_size = base::checked_cast<uint32_t>(patterns.size());
+  AppendSection(output, base::span<const char>(patterns),
+                header.pattern_pool_offset);
+
+  header.total_size = base::checked_cast<uint32_t>(output.size());
+  header.checksum =
+      base::PersistentHash(base::span(output).subspan(sizeof(flat::Header)));
+  base::span(output).first(sizeof(flat::Header))
+      .copy_from(base::byte_span_from_ref(header));
+  return output;
+}
+
+}  // namespace safe_deal::url_filter
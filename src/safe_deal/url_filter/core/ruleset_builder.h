@@ -0,0 +1,41 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_CORE_RULESET_BUILDER_H_
+#define SAFE_DEAL_URL_FILTER_CORE_RULESET_BUILDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "safe_deal/url_filter/core/filter_rule_parser.h"
+
+namespace safe_deal::url_filter {
+
+// Compiles parsed filter rules into the format read by UrlRulesetMatcher.
+// Used by safe_deal_url_filter_compiler at build time only.
+class RulesetBuilder {
+ public:
+  RulesetBuilder();
+  RulesetBuilder(const RulesetBuilder&) = delete;
+  RulesetBuilder& operator=(const RulesetBuilder&) = delete;
+  ~RulesetBuilder();
+
+  // Returns false, dropping the rule, if it does not fit the compiled format,
+  // e.g. because it lists more than 255 domains.
+  bool AddRule(const FilterRule& rule);
+
+  // Serializes every rule added so far.
+  std::vector<uint8_t> Build() const;
+
+  size_t rule_count() const { return rules_.size(); }
+
+ private:
+  std::vector<FilterRule> rules_;
+};
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_CORE_RULESET_BUILDER_H_
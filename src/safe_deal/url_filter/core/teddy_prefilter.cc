@@ -0,0 +1,180 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/teddy_prefilter.h"
+
+#include "build/build_config.h"
+#include "safe_deal/url_filter/core/url_filter_types.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <immintrin.h>
+
+#include "base/cpu.h"
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+using flat::kFingerprintLength;
+
+constexpr size_t kBlockSize = 16;
+
+uint8_t CandidateBucketsAt(const flat::TeddyMasks& masks, const char* data) {
+  uint8_t buckets = 0xff;
+  for (int i = 0; i < kFingerprintLength; ++i) {
+    uint8_t c = static_cast<uint8_t>(ToLowerAscii(data[i]));
+    buckets &= masks.low[i][c & 0x0f] & masks.high[i][c >> 4];
+  }
+  return buckets;
+}
+
+size_t FindCandidateScalar(const flat::TeddyMasks& masks,
+                           std::string_view text,
+                           size_t from) {
+  for (size_t pos = from; pos + kFingerprintLength <= text.size(); ++pos) {
+    if (CandidateBucketsAt(masks, text.data() + pos)) {
+      return pos;
+    }
+  }
+  return std::string_view::npos;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+__attribute__((target("ssse3"))) size_t FindCandidateSsse3(
+    const flat::TeddyMasks& masks,
+    std::string_view text,
+    size_t from) {
+  const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+  const __m128i upper_a = _mm_set1_epi8('A' - 1);
+  const __m128i upper_z = _mm_set1_epi8('Z' + 1);
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  __m128i low[kFingerprintLength];
+  __m128i high[kFingerprintLength];
+  for (int i = 0; i < kFingerprintLength; ++i) {
+    low[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks.low[i]));
+    high[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks.high[i]));
+  }
+
+  size_t pos = from;
+  // Each step reads kBlockSize + kFingerprintLength - 1 bytes.
+  while (pos + kBlockSize + kFingerprintLength - 1 <= text.size()) {
+    __m128i buckets = _mm_set1_epi8(static_cast<char>(0xff));
+    for (int i = 0; i < kFingerprintLength; ++i) {
+      __m128i bytes = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(text.data() + pos + i));
+      __m128i is_upper = _mm_and_si128(_mm_cmpgt_epi8(bytes, upper_a),
+                                       _mm_cmplt_epi8(bytes, upper_z));
+      bytes = _mm_or_si128(bytes, _mm_and_si128(is_upper, case_bit));
+      __m128i low_nibbles = _mm_and_si128(bytes, nibble_mask);
+      __m128i high_nibbles =
+          _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble_mask);
+      buckets = _mm_and_si128(
+          buckets, _mm_and_si128(_mm_shuffle_epi8(low[i], low_nibbles),
+                                 _mm_shuffle_epi8(high[i], high_nibbles)));
+    }
+    int empty =
+        _mm_movemask_epi8(_mm_cmpeq_epi8(buckets, _mm_setzero_si128()));
+    int candidates = ~empty & 0xffff;
+    if (candidates) {
+      return pos + __builtin_ctz(candidates);
+    }
+    pos += kBlockSize;
+  }
+  return FindCandidateScalar(masks, text, pos);
+}
+
+bool HasSsse3() {
+  static const bool has_ssse3 = base::CPU().has_ssse3();
+  return has_ssse3;
+}
+
+#elif defined(ARCH_CPU_ARM64)
+
+size_t FindCandidateNeon(const flat::TeddyMasks& masks,
+                         std::string_view text,
+                         size_t from) {
+  const uint8x16_t nibble_mask = vdupq_n_u8(0x0f);
+  const uint8x16_t upper_a = vdupq_n_u8('A');
+  const uint8x16_t letters = vdupq_n_u8('Z' - 'A');
+  const uint8x16_t case_bit = vdupq_n_u8(0x20);
+  uint8x16_t low[kFingerprintLength];
+  uint8x16_t high[kFingerprintLength];
+  for (int i = 0; i < kFingerprintLength; ++i) {
+    low[i] = vld1q_u8(masks.low[i]);
+    high[i] = vld1q_u8(masks.high[i]);
+  }
+
+  size_t pos = from;
+  while (pos + kBlockSize + kFingerprintLength - 1 <= text.size()) {
+    uint8x16_t buckets = vdupq_n_u8(0xff);
+    for (int i = 0; i < kFingerprintLength; ++i) {
+      uint8x16_t bytes = vld1q_u8(
+          reinterpret_cast<const uint8_t*>(text.data() + pos + i));
+      uint8x16_t is_upper = vcleq_u8(vsubq_u8(bytes, upper_a), letters);
+      bytes = vorrq_u8(bytes, vandq_u8(is_upper, case_bit));
+      buckets = vandq_u8(
+          buckets,
+          vandq_u8(vqtbl1q_u8(low[i], vandq_u8(bytes, nibble_mask)),
+                   vqtbl1q_u8(high[i], vshrq_n_u8(bytes, 4))));
+    }
+    if (vmaxvq_u8(buckets)) {
+      // Rare enough that locating the lane with scalar code is cheaper than
+      // emulating movemask.
+      return FindCandidateScalar(
+          masks, text.substr(0, pos + kBlockSize + kFingerprintLength - 1),
+          pos);
+    }
+    pos += kBlockSize;
+  }
+  return FindCandidateScalar(masks, text, pos);
+}
+
+#endif
+
+}  // namespace
+
+uint32_t MakeFingerprintKey(const char* data) {
+  uint32_t key = 0;
+  for (int i = 0; i < kFingerprintLength; ++i) {
+    key |= static_cast<uint32_t>(static_cast<uint8_t>(ToLowerAscii(data[i])))
+           << (8 * i);
+  }
+  // Zero marks empty hash buckets.
+  return key | 0x01000000u;
+}
+
+int GetTeddyBucket(uint32_t key) {
+  return static_cast<int>((key * 2654435761u) >> 29);
+}
+
+void AddFingerprintToTeddyMasks(uint32_t key,
+                                int bucket,
+                                flat::TeddyMasks& masks) {
+  for (int i = 0; i < kFingerprintLength; ++i) {
+    uint8_t c = static_cast<uint8_t>(key >> (8 * i));
+    masks.low[i][c & 0x0f] |= 1 << bucket;
+    masks.high[i][c >> 4] |= 1 << bucket;
+  }
+}
+
+size_t FindTeddyCandidate(const flat::TeddyMasks& masks,
+                          std::string_view text,
+                          size_t from) {
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (HasSsse3()) {
+    return FindCandidateSsse3(masks, text, from);
+  }
+  return FindCandidateScalar(masks, text, from);
+#elif defined(ARCH_CPU_ARM64)
+  return FindCandidateNeon(masks, text, from);
+#else
+  return FindCandidateScalar(masks, text, from);
+#endif
+}
+
+}  // namespace safe_deal::url_filter
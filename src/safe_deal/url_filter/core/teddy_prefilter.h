@@ -0,0 +1,40 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_CORE_TEDDY_PREFILTER_H_
+#define SAFE_DEAL_URL_FILTER_CORE_TEDDY_PREFILTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+#include "safe_deal/url_filter/core/flat_ruleset_format.h"
+
+namespace safe_deal::url_filter {
+
+// Packs the first kFingerprintLength bytes at |data|, lower cased, into a
+// non-zero hash table key.
+uint32_t MakeFingerprintKey(const char* data);
+
+// Adds |key| to Teddy bucket |bucket| of |masks|.
+void AddFingerprintToTeddyMasks(uint32_t key,
+                                int bucket,
+                                flat::TeddyMasks& masks);
+
+// Returns the Teddy bucket a fingerprint key belongs to.
+int GetTeddyBucket(uint32_t key);
+
+// Scans |text| from |from| for the next offset where a fingerprint added to
+// |masks| may start, comparing case-insensitively. Returns the offset, or
+// std::string_view::npos. Sixteen offsets are tested per step using SSSE3 or
+// NEON byte shuffles where available. False positives are possible and must
+// be confirmed by an exact lookup; false negatives are not.
+size_t FindTeddyCandidate(const flat::TeddyMasks& masks,
+                          std::string_view text,
+                          size_t from);
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_CORE_TEDDY_PREFILTER_H_
@@ -0,0 +1,117 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/teddy_prefilter.h"
+
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "safe_deal/url_filter/core/flat_ruleset_format.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+constexpr size_t kNotFound = std::string_view::npos;
+
+class TeddyPrefilterTest : public testing::Test {
+ protected:
+  void Add(std::string_view literal) {
+    uint32_t key = MakeFingerprintKey(literal.data());
+    keys_.insert(key);
+    AddFingerprintToTeddyMasks(key, GetTeddyBucket(key), masks_);
+  }
+
+  // The first offset at or after |from| where an added fingerprint starts.
+  size_t FindExact(std::string_view text, size_t from) const {
+    for (size_t pos = from; pos + flat::kFingerprintLength <= text.size();
+         ++pos) {
+      if (keys_.contains(MakeFingerprintKey(text.data() + pos))) {
+        return pos;
+      }
+    }
+    return kNotFound;
+  }
+
+  // Checks the candidates from every start offset of |text|: never past the
+  // next real fingerprint, and never one that does not fit.
+  void ExpectNoFalseNegatives(std::string_view text) {
+    for (size_t from = 0; from <= text.size(); ++from) {
+      size_t candidate = FindTeddyCandidate(masks_, text, from);
+      EXPECT_LE(candidate, FindExact(text, from)) << text << " from " << from;
+      if (candidate != kNotFound) {
+        EXPECT_GE(candidate, from);
+        EXPECT_LE(candidate + flat::kFingerprintLength, text.size());
+      }
+    }
+  }
+
+  flat::TeddyMasks masks_ = {};
+  std::set<uint32_t> keys_;
+};
+
+TEST_F(TeddyPrefilterTest, FingerprintKeys) {
+  EXPECT_EQ(MakeFingerprintKey("abc"), MakeFingerprintKey("ABC"));
+  EXPECT_NE(MakeFingerprintKey("abc"), MakeFingerprintKey("abd"));
+  EXPECT_NE(0u, MakeFingerprintKey("\0\0\0"));
+  for (std::string_view literal : {"abc", "zzz", "%2f", "\x80\xff\x01"}) {
+    int bucket = GetTeddyBucket(MakeFingerprintKey(literal.data()));
+    EXPECT_GE(bucket, 0);
+    EXPECT_LT(bucket, flat::kTeddyBuckets);
+  }
+}
+
+TEST_F(TeddyPrefilterTest, EmptyMasksFindNothing) {
+  const std::string text(100, 'a');
+  for (size_t from = 0; from <= text.size(); ++from) {
+    EXPECT_EQ(kNotFound, FindTeddyCandidate(masks_, text, from));
+  }
+}
+
+TEST_F(TeddyPrefilterTest, ShortText) {
+  Add("ads");
+  EXPECT_EQ(kNotFound, FindTeddyCandidate(masks_, "", 0));
+  EXPECT_EQ(kNotFound, FindTeddyCandidate(masks_, "ad", 0));
+  EXPECT_EQ(0u, FindTeddyCandidate(masks_, "ads", 0));
+  EXPECT_EQ(kNotFound, FindTeddyCandidate(masks_, "ads", 1));
+}
+
+TEST_F(TeddyPrefilterTest, FindsLiteralsAtEveryOffset) {
+  const std::string_view kLiterals[] = {"ads", "trk", "pix", "utm", "gcl",
+                                        "fbc", "x_y", "%2f", "b/q", "a.b"};
+  for (std::string_view literal : kLiterals) {
+    Add(literal);
+  }
+  // Every offset around the 16-byte steps, with filler that shares bytes with
+  // the literals and with upper case letters.
+  for (std::string_view literal : kLiterals) {
+    for (size_t length = 3; length <= 50; ++length) {
+      for (size_t pos = 0; pos + literal.size() <= length; ++pos) {
+        std::string text(length, 'a');
+        text.replace(pos, literal.size(), literal);
+        ExpectNoFalseNegatives(text);
+        for (char& c : text) {
+          c = static_cast<char>(c >= 'a' && c <= 'z' ? c - 32 : c);
+        }
+        ExpectNoFalseNegatives(text);
+      }
+    }
+  }
+}
+
+TEST_F(TeddyPrefilterTest, Urls) {
+  Add("ads");
+  Add("pix");
+  Add("doubleclick");
+  ExpectNoFalseNegatives(
+      "https://www.example.com/search?q=shoes&utm_source=ADS&x=1");
+  ExpectNoFalseNegatives("https://stats.doubleclick.net/pixel.gif?\x80\xff");
+  ExpectNoFalseNegatives("https://example.com/nothing/to/see/here/at/all");
+}
+
+}  // namespace
+
+}  // namespace safe_deal::url_filter
@@ -0,0 +1,82 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_CORE_URL_FILTER_TYPES_H_
+#define SAFE_DEAL_URL_FILTER_CORE_URL_FILTER_TYPES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace safe_deal::url_filter {
+
+// Request types a rule can be restricted to, as a bit mask.
+enum ElementType : uint16_t {
+  kElementTypeNone = 0,
+  kElementTypeOther = 1 << 0,
+  kElementTypeScript = 1 << 1,
+  kElementTypeImage = 1 << 2,
+  kElementTypeStylesheet = 1 << 3,
+  kElementTypeObject = 1 << 4,
+  kElementTypeXmlHttpRequest = 1 << 5,
+  kElementTypeSubdocument = 1 << 6,
+  kElementTypeFont = 1 << 7,
+  kElementTypeMedia = 1 << 8,
+  kElementTypeWebSocket = 1 << 9,
+  kElementTypePing = 1 << 10,
+  kElementTypeAll = (1 << 11) - 1,
+};
+
+// Flags stored with every compiled rule.
+enum RuleFlag : uint8_t {
+  kRuleFlagException = 1 << 0,
+  // "|" at the start: the pattern matches from the start of the URL.
+  kRuleFlagAnchorLeft = 1 << 1,
+  // "||" at the start: the pattern matches from the start of a host label.
+  kRuleFlagAnchorSubdomain = 1 << 2,
+  // "|" at the end: the pattern matches up to the end of the URL.
+  kRuleFlagAnchorRight = 1 << 3,
+  kRuleFlagMatchCase = 1 << 4,
+  kRuleFlagFirstParty = 1 << 5,
+  kRuleFlagThirdParty = 1 << 6,
+};
+
+// Characters that make up URL tokens. Anything else separates tokens.
+constexpr bool IsTokenChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '%';
+}
+
+// The "^" placeholder matches any separator character or the end of the URL.
+constexpr bool IsSeparatorChar(char c) {
+  return !IsTokenChar(c) && c != '_' && c != '-' && c != '.';
+}
+
+constexpr char ToLowerAscii(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+// 32-bit FNV-1a over lower cased bytes. Zero is reserved for empty hash table
+// buckets, so it is never returned.
+class TokenHasher {
+ public:
+  constexpr void Add(char c) {
+    hash_ = (hash_ ^ static_cast<uint8_t>(ToLowerAscii(c))) * 16777619u;
+  }
+  constexpr uint32_t Finish() const { return hash_ ? hash_ : 1; }
+
+ private:
+  uint32_t hash_ = 2166136261u;
+};
+
+constexpr uint32_t HashToken(const char* data, size_t length) {
+  TokenHasher hasher;
+  for (size_t i = 0; i < length; ++i) {
+    hasher.Add(data[i]);
+  }
+  return hasher.Finish();
+}
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_CORE_URL_FILTER_TYPES_H_
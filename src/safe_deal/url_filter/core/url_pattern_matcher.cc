@@ -0,0 +1,142 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/url_pattern_matcher.h"
+
+#include <algorithm>
+
+#include "safe_deal/url_filter/core/url_filter_types.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+constexpr size_t kNoMatch = std::string_view::npos;
+
+// Matches |segment|, which contains no "*", at |pos|. Returns the offset just
+// past the match, or kNoMatch.
+size_t MatchSegmentAt(std::string_view url,
+                      size_t pos,
+                      std::string_view segment,
+                      bool match_case) {
+  for (size_t i = 0; i < segment.size(); ++i) {
+    size_t url_pos = pos + i;
+    if (segment[i] == '^') {
+      if (url_pos == url.size()) {
+        // The end of the URL counts as one trailing separator.
+        return i + 1 == segment.size() ? url_pos : kNoMatch;
+      }
+      if (!IsSeparatorChar(url[url_pos])) {
+        return kNoMatch;
+      }
+      continue;
+    }
+    if (url_pos >= url.size()) {
+      return kNoMatch;
+    }
+    char c = match_case ? url[url_pos] : ToLowerAscii(url[url_pos]);
+    if (c != segment[i]) {
+      return kNoMatch;
+    }
+  }
+  return pos + segment.size();
+}
+
+// Finds the leftmost match of |segment| at or after |from|. On success sets
+// |end| to the offset past the match and returns its start.
+size_t FindSegment(std::string_view url,
+                   size_t from,
+                   std::string_view segment,
+                   bool match_case,
+                   size_t& end) {
+  for (size_t pos = from; pos <= url.size(); ++pos) {
+    end = MatchSegmentAt(url, pos, segment, match_case);
+    if (end != kNoMatch) {
+      return pos;
+    }
+  }
+  return kNoMatch;
+}
+
+// Matches the segments of |pattern| after the first one, which ended at
+// |pos|, greedily from left to right.
+bool MatchRemainingSegments(std::string_view url,
+                            size_t pos,
+                            std::string_view rest,
+                            bool anchor_right,
+                            bool match_case) {
+  while (!rest.empty()) {
+    size_t star = rest.find('*');
+    std::string_view segment = rest.substr(0, star);
+    bool is_last = star == std::string_view::npos;
+    rest = is_last ? std::string_view() : rest.substr(star + 1);
+
+    if (is_last && anchor_right) {
+      // The last segment has to end exactly at the end of the URL. A trailing
+      // "^" may match the virtual end separator, so try both alignments.
+      for (size_t start : {url.size() - std::min(url.size(), segment.size()),
+                           url.size() + 1 - std::min(url.size() + 1,
+                                                     segment.size())}) {
+        if (start >= pos &&
+            MatchSegmentAt(url, start, segment, match_case) == url.size()) {
+          return true;
+        }
+      }
+      return false;
+    }
+    size_t end = 0;
+    if (FindSegment(url, pos, segment, match_case, end) == kNoMatch) {
+      return false;
+    }
+    pos = end;
+  }
+  // The pattern ended in "*", which matches any remainder.
+  return true;
+}
+
+}  // namespace
+
+bool MatchesUrlPattern(std::string_view url,
+                       HostRange host,
+                       std::string_view pattern,
+                       uint8_t flags) {
+  const bool match_case = flags & kRuleFlagMatchCase;
+  const bool anchor_right = flags & kRuleFlagAnchorRight;
+
+  size_t star = pattern.find('*');
+  std::string_view first = pattern.substr(0, star);
+  std::string_view rest = star == std::string_view::npos
+                              ? std::string_view()
+                              : pattern.substr(star + 1);
+  bool single_segment = star == std::string_view::npos;
+
+  auto match_from = [&](size_t start) {
+    size_t end = MatchSegmentAt(url, start, first, match_case);
+    if (end == kNoMatch) {
+      return false;
+    }
+    if (single_segment) {
+      return !anchor_right || end == url.size();
+    }
+    return MatchRemainingSegments(url, end, rest, anchor_right, match_case);
+  };
+
+  if (flags & kRuleFlagAnchorLeft) {
+    return match_from(0);
+  }
+  if (flags & kRuleFlagAnchorSubdomain) {
+    // "||" matches at the start of the host or of any of its labels.
+    for (size_t pos = host.begin; pos < host.end; ++pos) {
+      if ((pos == host.begin || url[pos - 1] == '.') && match_from(pos)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // Without a left anchor, matching every segment at its leftmost position
+  // is enough: moving an earlier segment right never helps a later one.
+  return MatchRemainingSegments(url, 0, pattern, anchor_right, match_case);
+}
+
+}  // namespace safe_deal::url_filter
@@ -0,0 +1,33 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_CORE_URL_PATTERN_MATCHER_H_
+#define SAFE_DEAL_URL_FILTER_CORE_URL_PATTERN_MATCHER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+namespace safe_deal::url_filter {
+
+// Offsets of the host within a URL spec.
+struct HostRange {
+  size_t begin = 0;
+  size_t end = 0;
+};
+
+// Returns true if |url| matches |pattern|, an EasyList pattern stripped of its
+// anchors, which are passed as RuleFlag values in |flags|. "*" matches any
+// run of characters and "^" a separator or the end of the URL. The pattern is
+// expected to be lower cased unless kRuleFlagMatchCase is set. Does not
+// allocate.
+bool MatchesUrlPattern(std::string_view url,
+                       HostRange host,
+                       std::string_view pattern,
+                       uint8_t flags);
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_CORE_URL_PATTERN_MATCHER_H_
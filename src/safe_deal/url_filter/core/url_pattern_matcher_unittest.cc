@@ -0,0 +1,109 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/url_pattern_matcher.h"
+
+#include <string_view>
+
+#include "safe_deal/url_filter/core/url_filter_types.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+bool Matches(std::string_view url, std::string_view pattern, uint8_t flags) {
+  size_t begin = url.find("://") + 3;
+  size_t end = url.find_first_of(":/?#", begin);
+  HostRange host = {begin, end == std::string_view::npos ? url.size() : end};
+  return MatchesUrlPattern(url, host, pattern, flags);
+}
+
+bool Matches(std::string_view url, std::string_view pattern) {
+  return Matches(url, pattern, 0);
+}
+
+TEST(UrlPatternMatcherTest, Substring) {
+  EXPECT_TRUE(Matches("https://example.com/ads/banner.js", "ads"));
+  EXPECT_TRUE(Matches("https://example.com/uploads/", "ads"));
+  EXPECT_FALSE(Matches("https://example.com/a-d-s/", "ads"));
+  EXPECT_TRUE(Matches("https://example.com/", "https://example.com/"));
+  EXPECT_FALSE(Matches("https://example.com", "https://example.com/"));
+}
+
+TEST(UrlPatternMatcherTest, Separator) {
+  EXPECT_TRUE(Matches("https://example.com/ads/x", "/ads^"));
+  EXPECT_TRUE(Matches("https://example.com/ads?x=1", "/ads^"));
+  EXPECT_TRUE(Matches("https://example.com/ads:8080", "/ads^"));
+  // The end of the URL is a separator too.
+  EXPECT_TRUE(Matches("https://example.com/ads", "/ads^"));
+  EXPECT_FALSE(Matches("https://example.com/adsx", "/ads^"));
+  // "_", "-", "." and "%" are not separators.
+  EXPECT_FALSE(Matches("https://example.com/ads.js", "/ads^"));
+  EXPECT_FALSE(Matches("https://example.com/ads-1", "/ads^"));
+  EXPECT_FALSE(Matches("https://example.com/ads_1", "/ads^"));
+  EXPECT_FALSE(Matches("https://example.com/ads%20", "/ads^"));
+  // Only one separator can match the end.
+  EXPECT_FALSE(Matches("https://example.com/ads", "/ads^^"));
+}
+
+TEST(UrlPatternMatcherTest, Wildcards) {
+  EXPECT_TRUE(Matches("https://example.com/banner_728x90.gif", "banner*.gif"));
+  EXPECT_TRUE(Matches("https://example.com/banner.gif", "banner*.gif"));
+  EXPECT_FALSE(Matches("https://example.com/gif/banner", "banner*.gif"));
+  EXPECT_TRUE(Matches("https://a.com/x/y/z/track", "/x/*/*/track"));
+  EXPECT_FALSE(Matches("https://a.com/x/y/track", "/x/*/*/track"));
+  // A later segment is found after an earlier one that matched first.
+  EXPECT_TRUE(Matches("https://a.com/ad/ad/pixel", "ad/*pixel"));
+}
+
+TEST(UrlPatternMatcherTest, LeftAnchor) {
+  EXPECT_TRUE(
+      Matches("https://ads.example.com/", "https://ads.", kRuleFlagAnchorLeft));
+  EXPECT_FALSE(Matches("https://example.com/?u=https://ads.", "https://ads.",
+                       kRuleFlagAnchorLeft));
+}
+
+TEST(UrlPatternMatcherTest, SubdomainAnchor) {
+  constexpr uint8_t kFlags = kRuleFlagAnchorSubdomain;
+  EXPECT_TRUE(Matches("https://ads.example.com/x", "ads.example.com^", kFlags));
+  EXPECT_TRUE(
+      Matches("https://cdn.ads.example.com/x", "ads.example.com^", kFlags));
+  EXPECT_TRUE(Matches("https://ads.example.com", "ads.example.com^", kFlags));
+  EXPECT_FALSE(
+      Matches("https://badads.example.com/", "ads.example.com^", kFlags));
+  EXPECT_FALSE(Matches("https://example.com/?ads.example.com/",
+                       "ads.example.com^", kFlags));
+  EXPECT_FALSE(
+      Matches("https://ads.example.com.evil/", "ads.example.com^", kFlags));
+  // The pattern may continue past the host.
+  EXPECT_TRUE(
+      Matches("https://www.example.com/ads/1", "example.com/ads/", kFlags));
+}
+
+TEST(UrlPatternMatcherTest, RightAnchor) {
+  constexpr uint8_t kFlags = kRuleFlagAnchorRight;
+  EXPECT_TRUE(Matches("https://example.com/a.gif", ".gif", kFlags));
+  EXPECT_FALSE(Matches("https://example.com/a.gif?x", ".gif", kFlags));
+  EXPECT_TRUE(Matches("https://example.com/ads/track", "ads*track^", kFlags));
+  EXPECT_TRUE(Matches("https://example.com/ads/track/", "ads*track^", kFlags));
+  EXPECT_FALSE(
+      Matches("https://example.com/ads/track/x", "ads*track^", kFlags));
+  EXPECT_TRUE(Matches("https://example.com/x.gif", "https://example.com/x.gif",
+                      kRuleFlagAnchorLeft | kFlags));
+  EXPECT_FALSE(Matches("https://example.com/x.gif2",
+                       "https://example.com/x.gif",
+                       kRuleFlagAnchorLeft | kFlags));
+}
+
+TEST(UrlPatternMatcherTest, Case) {
+  EXPECT_TRUE(Matches("https://example.com/ADS/", "/ads/"));
+  EXPECT_TRUE(Matches("https://example.com/Ads/", "/Ads/", kRuleFlagMatchCase));
+  EXPECT_FALSE(
+      Matches("https://example.com/ads/", "/Ads/", kRuleFlagMatchCase));
+}
+
+}  // namespace
+
+}  // namespace safe_deal::url_filter
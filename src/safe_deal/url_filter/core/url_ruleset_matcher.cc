@@ -0,0 +1,343 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/url_ruleset_matcher.h"
+
+#include <array>
+#include <string_view>
+
+#include "base/check.h"
+#include "base/hash/hash.h"
+#include "base/numerics/checked_math.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "safe_deal/url_filter/core/teddy_prefilter.h"
+#include "safe_deal/url_filter/core/url_pattern_matcher.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+// Initiator hosts deeper than this only have their top labels compared
+// against $domain options.
+constexpr size_t kMaxDomainLabels = 16;
+
+bool IsRangeValid(base::span<const uint8_t> data,
+                  uint32_t offset,
+                  uint32_t count,
+                  size_t element_size) {
+  base::CheckedNumeric<size_t> end = offset;
+  end += base::CheckedNumeric<size_t>(count) * element_size;
+  return offset % 4 == 0 && end.IsValid() && end.ValueOrDie() <= data.size();
+}
+
+bool IsIndexValid(base::span<const uint8_t> data,
+                  const flat::Index& index,
+                  uint32_t rule_list_entry_count) {
+  auto is_power_of_two = [](uint32_t size) {
+    return (size & (size - 1)) == 0;
+  };
+  base::CheckedNumeric<uint32_t> fallback_end = index.fallback_list_index;
+  fallback_end += index.fallback_list_length;
+  return is_power_of_two(index.token_table_size) &&
+         is_power_of_two(index.fingerprint_table_size) &&
+         IsRangeValid(data, index.token_table_offset, index.token_table_size,
+                      sizeof(flat::HashBucket)) &&
+         IsRangeValid(data, index.fingerprint_table_offset,
+                      index.fingerprint_table_size,
+                      sizeof(flat::HashBucket)) &&
+         fallback_end.IsValid() &&
+         fallback_end.ValueOrDie() <= rule_list_entry_count;
+}
+
+template <typename T>
+base::span<const T> SectionAsSpan(base::span<const uint8_t> data,
+                                  uint32_t offset,
+                                  uint32_t count) {
+  // Sections are 4-byte aligned within a mapping that is page aligned.
+  return base::span(
+      reinterpret_cast<const T*>(data.subspan(offset).data()), count);
+}
+
+}  // namespace
+
+// Per-request state, computed lazily on the stack so that requests that hit
+// no candidate rules pay nothing for it.
+class UrlRulesetMatcher::RequestContext {
+ public:
+  RequestContext(const GURL& url,
+                 const url::Origin* initiator,
+                 ElementType type)
+      : url_(url),
+        spec_(url.possibly_invalid_spec()),
+        initiator_(initiator),
+        type_(type) {
+    const url::Component& host = url.parsed_for_possibly_invalid_spec().host;
+    if (host.is_nonempty()) {
+      host_ = {static_cast<size_t>(host.begin),
+               static_cast<size_t>(host.end())};
+    }
+  }
+
+  std::string_view spec() const { return spec_; }
+  HostRange host() const { return host_; }
+  ElementType type() const { return type_; }
+  bool is_browser_initiated() const { return !initiator_; }
+  bool has_initiator() const { return initiator_ && !initiator_->opaque(); }
+
+  // Opaque initiators are third party to every URL. Must not be called for
+  // browser initiated requests, which are neither.
+  bool IsThirdParty() {
+    DCHECK(!is_browser_initiated());
+    if (!is_third_party_) {
+      is_third_party_ =
+          !has_initiator() ||
+          !net::registry_controlled_domains::SameDomainOrHost(
+              url_, *initiator_,
+              net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+    }
+    return *is_third_party_;
+  }
+
+  // Hashes of the initiator host and each of its parent domains.
+  base::span<const uint32_t> InitiatorDomainHashes() {
+    if (!domain_hashes_computed_) {
+      domain_hashes_computed_ = true;
+      if (has_initiator()) {
+        std::string_view host = initiator_->host();
+        while (!host.empty() && domain_hash_count_ < kMaxDomainLabels) {
+          domain_hashes_[domain_hash_count_++] =
+              HashToken(host.data(), host.size());
+          size_t dot = host.find('.');
+          host = dot == std::string_view::npos ? std::string_view()
+                                               : host.substr(dot + 1);
+        }
+      }
+    }
+    return base::span(domain_hashes_).first(domain_hash_count_);
+  }
+
+ private:
+  const GURL& url_;
+  const std::string_view spec_;
+  const raw_ptr<const url::Origin> initiator_;
+  const ElementType type_;
+  HostRange host_;
+  std::optional<bool> is_third_party_;
+  bool domain_hashes_computed_ = false;
+  size_t domain_hash_count_ = 0;
+  std::array<uint32_t, kMaxDomainLabels> domain_hashes_;
+};
+
+// static
+std::optional<UrlRulesetMatcher> UrlRulesetMatcher::Create(
+    base::span<const uint8_t> data) {
+  if (data.size() < sizeof(flat::Header) ||
+      reinterpret_cast<uintptr_t>(data.data()) % 4 != 0) {
+    return std::nullopt;
+  }
+  const auto* header = reinterpret_cast<const flat::Header*>(data.data());
+  if (header->magic != flat::kMagic || header->version != flat::kVersion ||
+      header->total_size != data.size() ||
+      !IsRangeValid(data, header->rules_offset, header->rule_count,
+                    sizeof(flat::Rule)) ||
+      !IsRangeValid(data, header->pattern_pool_offset,
+                    header->pattern_pool_size, 1) ||
+      !IsRangeValid(data, header->domain_hashes_offset,
+                    header->domain_hash_count, sizeof(uint32_t)) ||
+      !IsRangeValid(data, header->rule_lists_offset,
+                    header->rule_list_entry_count, sizeof(uint32_t)) ||
+      !IsIndexValid(data, header->block_index,
+                    header->rule_list_entry_count) ||
+      !IsIndexValid(data, header->allow_index,
+                    header->rule_list_entry_count)) {
+    return std::nullopt;
+  }
+  return UrlRulesetMatcher(data);
+}
+
+// static
+bool UrlRulesetMatcher::VerifyChecksum(base::span<const uint8_t> data) {
+  if (data.size() < sizeof(flat::Header)) {
+    return false;
+  }
+  const auto* header = reinterpret_cast<const flat::Header*>(data.data());
+  return base::PersistentHash(data.subspan(sizeof(flat::Header))) ==
+         header->checksum;
+}
+
+UrlRulesetMatcher::UrlRulesetMatcher(base::span<const uint8_t> data)
+    : data_(data),
+      header_(reinterpret_cast<const flat::Header*>(data.data())),
+      rules_(SectionAsSpan<flat::Rule>(data,
+                                       header_->rules_offset,
+                                       header_->rule_count)),
+      patterns_(SectionAsSpan<char>(data,
+                                    header_->pattern_pool_offset,
+                                    header_->pattern_pool_size)),
+      domain_hashes_(SectionAsSpan<uint32_t>(data,
+                                             header_->domain_hashes_offset,
+                                             header_->domain_hash_count)),
+      rule_lists_(SectionAsSpan<uint32_t>(data,
+                                          header_->rule_lists_offset,
+                                          header_->rule_list_entry_count)) {}
+
+UrlRulesetMatcher::UrlRulesetMatcher(const UrlRulesetMatcher&) = default;
+UrlRulesetMatcher& UrlRulesetMatcher::operator=(const UrlRulesetMatcher&) =
+    default;
+UrlRulesetMatcher::~UrlRulesetMatcher() = default;
+
+bool UrlRulesetMatcher::ShouldBlock(const GURL& url,
+                                    const url::Origin* initiator,
+                                    ElementType type) const {
+  if (!url.is_valid() ||
+      (!url.SchemeIsHTTPOrHTTPS() && !url.SchemeIsWSOrWSS())) {
+    return false;
+  }
+  RequestContext context(url, initiator, type);
+  return FindMatch(header_->block_index, context) &&
+         !FindMatch(header_->allow_index, context);
+}
+
+const flat::Rule* UrlRulesetMatcher::FindMatch(const flat::Index& index,
+                                               RequestContext& context) const {
+  std::string_view spec = context.spec();
+
+  // Rules keyed by a token: look up every token of the URL.
+  if (index.token_table_size) {
+    size_t pos = 0;
+    while (pos < spec.size()) {
+      while (pos < spec.size() && !IsTokenChar(spec[pos])) {
+        ++pos;
+      }
+      TokenHasher hasher;
+      size_t begin = pos;
+      while (pos < spec.size() && IsTokenChar(spec[pos])) {
+        hasher.Add(spec[pos++]);
+      }
+      if (pos == begin) {
+        break;
+      }
+      if (const flat::HashBucket* bucket =
+              FindBucket(index.token_table_offset, index.token_table_size,
+                         hasher.Finish())) {
+        if (const flat::Rule* rule = MatchList(
+                bucket->list_index, bucket->list_length, context)) {
+          return rule;
+        }
+      }
+    }
+  }
+
+  // Rules keyed by a literal fingerprint: only offsets that pass the Teddy
+  // prefilter are looked up.
+  if (index.fingerprint_table_size) {
+    for (size_t pos = FindTeddyCandidate(index.teddy, spec, 0);
+         pos != std::string_view::npos;
+         pos = FindTeddyCandidate(index.teddy, spec, pos + 1)) {
+      if (const flat::HashBucket* bucket = FindBucket(
+              index.fingerprint_table_offset, index.fingerprint_table_size,
+              MakeFingerprintKey(spec.data() + pos))) {
+        if (const flat::Rule* rule = MatchList(
+                bucket->list_index, bucket->list_length, context)) {
+          return rule;
+        }
+      }
+    }
+  }
+
+  return MatchList(index.fallback_list_index, index.fallback_list_length,
+                   context);
+}
+
+const flat::Rule* UrlRulesetMatcher::MatchList(uint32_t list_index,
+                                               uint32_t list_length,
+                                               RequestContext& context) const {
+  if (uint64_t{list_index} + list_length > rule_lists_.size()) {
+    return nullptr;
+  }
+  for (uint32_t rule_index : rule_lists_.subspan(list_index, list_length)) {
+    if (rule_index < rules_.size() &&
+        RuleMatches(rules_[rule_index], context)) {
+      return &rules_[rule_index];
+    }
+  }
+  return nullptr;
+}
+
+bool UrlRulesetMatcher::RuleMatches(const flat::Rule& rule,
+                                    RequestContext& context) const {
+  // Cheapest checks first; the pattern is only compared at the end.
+  if (!(rule.element_types & context.type())) {
+    return false;
+  }
+  if ((rule.flags & (kRuleFlagFirstParty | kRuleFlagThirdParty)) ||
+      rule.include_domain_count || rule.exclude_domain_count) {
+    // There is no document for the party or the domain to be judged by.
+    if (context.is_browser_initiated()) {
+      return false;
+    }
+  }
+  if (rule.flags & (kRuleFlagFirstParty | kRuleFlagThirdParty)) {
+    bool third_party = context.IsThirdParty();
+    if ((rule.flags & kRuleFlagThirdParty) ? !third_party : third_party) {
+      return false;
+    }
+  }
+  if (rule.include_domain_count || rule.exclude_domain_count) {
+    size_t domain_count =
+        size_t{rule.include_domain_count} + rule.exclude_domain_count;
+    if (uint64_t{rule.domains_index} + domain_count > domain_hashes_.size()) {
+      return false;
+    }
+    base::span<const uint32_t> domains =
+        domain_hashes_.subspan(rule.domains_index, domain_count);
+    base::span<const uint32_t> initiator = context.InitiatorDomainHashes();
+    auto contains_any = [&](base::span<const uint32_t> list) {
+      for (uint32_t hash : initiator) {
+        for (uint32_t domain : list) {
+          if (hash == domain) {
+            return true;
+          }
+        }
+      }
+      return false;
+    };
+    if (rule.include_domain_count &&
+        !contains_any(domains.first(rule.include_domain_count))) {
+      return false;
+    }
+    if (contains_any(domains.subspan(rule.include_domain_count))) {
+      return false;
+    }
+  }
+  if (uint64_t{rule.pattern_offset} + rule.pattern_length > patterns_.size()) {
+    return false;
+  }
+  std::string_view pattern(patterns_.data() + rule.pattern_offset,
+                           rule.pattern_length);
+  return MatchesUrlPattern(context.spec(), context.host(), pattern, rule.flags);
+}
+
+const flat::HashBucket* UrlRulesetMatcher::FindBucket(uint32_t table_offset,
+                                                      uint32_t table_size,
+                                                      uint32_t key) const {
+  base::span<const flat::HashBucket> table =
+      SectionAsSpan<flat::HashBucket>(data_, table_offset, table_size);
+  uint32_t mask = table_size - 1;
+  for (uint32_t slot = (key * 2654435761u) & mask, probes = 0;
+       probes < table_size; slot = (slot + 1) & mask, ++probes) {
+    const flat::HashBucket& bucket = table[slot];
+    if (bucket.key == key) {
+      return &bucket;
+    }
+    if (bucket.key == 0) {
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace safe_deal::url_filter
@@ -0,0 +1,81 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_CORE_URL_RULESET_MATCHER_H_
+#define SAFE_DEAL_URL_FILTER_CORE_URL_RULESET_MATCHER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+
+#include "base/containers/span.h"
+#include "base/memory/raw_ptr.h"
+#include "safe_deal/url_filter/core/flat_ruleset_format.h"
+#include "safe_deal/url_filter/core/url_filter_types.h"
+
+class GURL;
+
+namespace url {
+class Origin;
+}  // namespace url
+
+namespace safe_deal::url_filter {
+
+// Matches requests against a compiled ruleset (see flat_ruleset_format.h)
+// in place. Matching is read-only, thread-safe and does not allocate.
+class UrlRulesetMatcher {
+ public:
+  // Checks the header and section bounds of |data|, which must outlive the
+  // matcher, in constant time. Returns nullopt if |data| is not a ruleset of
+  // the current version.
+  static std::optional<UrlRulesetMatcher> Create(
+      base::span<const uint8_t> data);
+
+  // Verifies the ruleset checksum. This reads the whole ruleset, so the
+  // browser does it once before handing a ruleset to other processes instead
+  // of every process doing it on startup.
+  static bool VerifyChecksum(base::span<const uint8_t> data);
+
+  UrlRulesetMatcher(const UrlRulesetMatcher&);
+  UrlRulesetMatcher& operator=(const UrlRulesetMatcher&);
+  ~UrlRulesetMatcher();
+
+  // Returns true if a blocking rule matches a request for |url| of |type|
+  // made by |initiator| and no exception rule does. |initiator| is null for
+  // browser initiated requests, which rules with $domain, $first-party or
+  // $third-party options never match. An opaque |initiator| is third party
+  // to every URL and in none of the $domain domains.
+  bool ShouldBlock(const GURL& url,
+                   const url::Origin* initiator,
+                   ElementType type) const;
+
+  size_t rule_count() const { return rules_.size(); }
+
+ private:
+  class RequestContext;
+
+  explicit UrlRulesetMatcher(base::span<const uint8_t> data);
+
+  const flat::Rule* FindMatch(const flat::Index& index,
+                              RequestContext& context) const;
+  const flat::Rule* MatchList(uint32_t list_index,
+                              uint32_t list_length,
+                              RequestContext& context) const;
+  bool RuleMatches(const flat::Rule& rule, RequestContext& context) const;
+  const flat::HashBucket* FindBucket(uint32_t table_offset,
+                                     uint32_t table_size,
+                                     uint32_t key) const;
+
+  base::span<const uint8_t> data_;
+  raw_ptr<const flat::Header> header_;
+  base::span<const flat::Rule> rules_;
+  base::span<const char> patterns_;
+  base::span<const uint32_t> domain_hashes_;
+  base::span<const uint32_t> rule_lists_;
+};
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_CORE_URL_RULESET_MATCHER_H_
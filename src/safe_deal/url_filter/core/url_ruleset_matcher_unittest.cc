@@ -0,0 +1,276 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/core/url_ruleset_matcher.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "safe_deal/url_filter/core/filter_rule_parser.h"
+#include "safe_deal/url_filter/core/flat_ruleset_format.h"
+#include "safe_deal/url_filter/core/ruleset_builder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+std::vector<uint8_t> BuildRuleset(
+    std::initializer_list<std::string_view> lines) {
+  RulesetBuilder builder;
+  for (std::string_view line : lines) {
+    FilterRule rule;
+    EXPECT_EQ(ParseResult::kRule, ParseFilterRule(line, rule)) << line;
+    EXPECT_TRUE(builder.AddRule(rule)) << line;
+  }
+  return builder.Build();
+}
+
+flat::Header GetHeader(const std::vector<uint8_t>& data) {
+  flat::Header header;
+  memcpy(&header, data.data(), sizeof(header));
+  return header;
+}
+
+void SetHeader(const flat::Header& header, std::vector<uint8_t>& data) {
+  memcpy(data.data(), &header, sizeof(header));
+}
+
+url::Origin Origin(std::string_view url) {
+  return url::Origin::Create(GURL(url));
+}
+
+class UrlRulesetMatcherTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    data_ = BuildRuleset({
+        // Reached through the token table.
+        "||ads.example.com^",
+        "@@||ads.example.com/allowed^",
+        "/banner/*/img^",
+        // No whole token: through the fingerprint table.
+        "trackpixel",
+        // Neither: on the fallback list.
+        "^x^$script",
+        "||img-ads.net^$image",
+        "||tracker.net^$third-party",
+        "||self-ads.net^$~third-party",
+        "||widget.com^$domain=shop.com|~checkout.shop.com",
+        "||cdn-ads.net^$domain=~shop.com",
+    });
+    matcher_ = UrlRulesetMatcher::Create(data_);
+    ASSERT_TRUE(matcher_);
+  }
+
+  bool Blocks(std::string_view url,
+              const url::Origin* initiator,
+              ElementType type = kElementTypeScript) const {
+    return matcher_->ShouldBlock(GURL(url), initiator, type);
+  }
+
+  const url::Origin news_ = Origin("https://news.example.org");
+  std::vector<uint8_t> data_;
+  std::optional<UrlRulesetMatcher> matcher_;
+};
+
+TEST_F(UrlRulesetMatcherTest, ValidRuleset) {
+  EXPECT_TRUE(UrlRulesetMatcher::VerifyChecksum(data_));
+  EXPECT_EQ(10u, matcher_->rule_count());
+}
+
+TEST_F(UrlRulesetMatcherTest, TokenRules) {
+  EXPECT_TRUE(Blocks("https://ads.example.com/x.js", &news_));
+  EXPECT_TRUE(Blocks("https://cdn.ads.example.com/x.js", &news_));
+  EXPECT_FALSE(Blocks("https://notads.example.com/x.js", &news_));
+  EXPECT_TRUE(Blocks("https://site.com/banner/728/img?x", &news_));
+  EXPECT_FALSE(Blocks("https://site.com/banner/728/img.png", &news_));
+}
+
+TEST_F(UrlRulesetMatcherTest, ExceptionRules) {
+  EXPECT_FALSE(Blocks("https://ads.example.com/allowed/x.js", &news_));
+  EXPECT_TRUE(Blocks("https://ads.example.com/allowedx.js", &news_));
+}
+
+TEST_F(UrlRulesetMatcherTest, FingerprintRules) {
+  EXPECT_TRUE(Blocks("https://cdn.com/img/trackpixel.gif", &news_));
+  EXPECT_TRUE(Blocks("https://cdn.com/img/MyTrackPixels", &news_));
+  EXPECT_FALSE(Blocks("https://cdn.com/track/pixel", &news_));
+}
+
+TEST_F(UrlRulesetMatcherTest, FallbackRules) {
+  EXPECT_TRUE(Blocks("https://cdn.com/x/y.js", &news_));
+  EXPECT_FALSE(Blocks("https://cdn.com/x/y.png", &news_, kElementTypeImage));
+  EXPECT_FALSE(Blocks("https://cdn.com/xy/y.js", &news_));
+}
+
+TEST_F(UrlRulesetMatcherTest, ElementTypes) {
+  EXPECT_TRUE(Blocks("https://img-ads.net/1.png", &news_, kElementTypeImage));
+  EXPECT_FALSE(Blocks("https://img-ads.net/1.js", &news_, kElementTypeScript));
+}
+
+TEST_F(UrlRulesetMatcherTest, Party) {
+  EXPECT_TRUE(Blocks("https://tracker.net/t.js", &news_));
+  const url::Origin same_site = Origin("https://www.tracker.net");
+  EXPECT_FALSE(Blocks("https://tracker.net/t.js", &same_site));
+
+  const url::Origin self = Origin("https://shop.self-ads.net");
+  EXPECT_TRUE(Blocks("https://self-ads.net/a.js", &self));
+  EXPECT_FALSE(Blocks("https://self-ads.net/a.js", &news_));
+}
+
+TEST_F(UrlRulesetMatcherTest, Domains) {
+  const url::Origin shop = Origin("https://shop.com");
+  const url::Origin www_shop = Origin("https://www.shop.com");
+  const url::Origin checkout = Origin("https://checkout.shop.com");
+  EXPECT_TRUE(Blocks("https://widget.com/w.js", &shop));
+  EXPECT_TRUE(Blocks("https://widget.com/w.js", &www_shop));
+  EXPECT_FALSE(Blocks("https://widget.com/w.js", &checkout));
+  EXPECT_FALSE(Blocks("https://widget.com/w.js", &news_));
+
+  EXPECT_FALSE(Blocks("https://cdn-ads.net/a.js", &www_shop));
+  EXPECT_TRUE(Blocks("https://cdn-ads.net/a.js", &news_));
+}
+
+TEST_F(UrlRulesetMatcherTest, BrowserInitiatedRequests) {
+  EXPECT_TRUE(Blocks("https://ads.example.com/x.js", nullptr));
+  // Rules that depend on the document making the request never match.
+  EXPECT_FALSE(Blocks("https://tracker.net/t.js", nullptr));
+  EXPECT_FALSE(Blocks("https://self-ads.net/a.js", nullptr));
+  EXPECT_FALSE(Blocks("https://widget.com/w.js", nullptr));
+  EXPECT_FALSE(Blocks("https://cdn-ads.net/a.js", nullptr));
+}
+
+TEST_F(UrlRulesetMatcherTest, OpaqueInitiator) {
+  const url::Origin opaque;
+  EXPECT_TRUE(Blocks("https://tracker.net/t.js", &opaque));
+  EXPECT_FALSE(Blocks("https://self-ads.net/a.js", &opaque));
+  EXPECT_FALSE(Blocks("https://widget.com/w.js", &opaque));
+  EXPECT_TRUE(Blocks("https://cdn-ads.net/a.js", &opaque));
+}
+
+TEST_F(UrlRulesetMatcherTest, OnlyHttpAndWebSockets) {
+  EXPECT_TRUE(Blocks("wss://ads.example.com/socket", &news_,
+                     kElementTypeWebSocket));
+  EXPECT_FALSE(Blocks("ftp://ads.example.com/x.js", &news_));
+  EXPECT_FALSE(Blocks("data:text/javascript,ads.example.com", &news_));
+  EXPECT_FALSE(Blocks("not a url", &news_));
+}
+
+TEST(UrlRulesetMatcherFormatTest, EmptyRuleset) {
+  std::vector<uint8_t> data = BuildRuleset({});
+  std::optional<UrlRulesetMatcher> matcher = UrlRulesetMatcher::Create(data);
+  ASSERT_TRUE(matcher);
+  EXPECT_FALSE(matcher->ShouldBlock(GURL("https://ads.example.com/"), nullptr,
+                                    kElementTypeScript));
+}
+
+TEST(UrlRulesetMatcherFormatTest, RejectsTruncatedData) {
+  const std::vector<uint8_t> data = BuildRuleset({"||ads.example.com^"});
+  for (size_t size : {size_t{0}, sizeof(flat::Header) - 1,
+                      sizeof(flat::Header), data.size() - 4}) {
+    EXPECT_FALSE(UrlRulesetMatcher::Create(base::span(data).first(size)))
+        << size;
+  }
+}
+
+TEST(UrlRulesetMatcherFormatTest, RejectsMisalignedData) {
+  const std::vector<uint8_t> data = BuildRuleset({"||ads.example.com^"});
+  std::vector<uint8_t> buffer(data.size() + 1);
+  std::ranges::copy(data, buffer.begin() + 1);
+  EXPECT_FALSE(UrlRulesetMatcher::Create(base::span(buffer).subspan(1u)));
+}
+
+TEST(UrlRulesetMatcherFormatTest, RejectsInvalidHeaders) {
+  const std::vector<uint8_t> data =
+      BuildRuleset({"||ads.example.com^", "trackpixel", "^x^"});
+  auto expect_rejected = [&](auto modify) {
+    std::vector<uint8_t> corrupt = data;
+    flat::Header header = GetHeader(corrupt);
+    modify(header);
+    SetHeader(header, corrupt);
+    EXPECT_FALSE(UrlRulesetMatcher::Create(corrupt));
+  };
+  expect_rejected([](flat::Header& header) { ++header.magic; });
+  expect_rejected([](flat::Header& header) { ++header.version; });
+  expect_rejected([](flat::Header& header) { header.total_size += 4; });
+  expect_rejected(
+      [](flat::Header& header) { header.rules_offset = header.total_size; });
+  expect_rejected([](flat::Header& header) { header.rules_offset += 2; });
+  expect_rejected([](flat::Header& header) { header.rule_count = 1 << 30; });
+  expect_rejected(
+      [](flat::Header& header) { header.pattern_pool_size = 0xffffffff; });
+  expect_rejected(
+      [](flat::Header& header) { header.domain_hash_count = 0x40000000; });
+  expect_rejected([](flat::Header& header) {
+    header.rule_list_entry_count = 0xffffffff;
+  });
+  expect_rejected(
+      [](flat::Header& header) { header.block_index.token_table_size = 3; });
+  expect_rejected([](flat::Header& header) {
+    header.block_index.fingerprint_table_size = 1 << 30;
+  });
+  expect_rejected([](flat::Header& header) {
+    header.allow_index.fallback_list_length = 1;
+  });
+  expect_rejected([](flat::Header& header) {
+    header.block_index.fallback_list_index = 0xffffffff;
+    header.block_index.fallback_list_length = 2;
+  });
+}
+
+TEST(UrlRulesetMatcherFormatTest, ChecksumCoversEverythingAfterTheHeader) {
+  const std::vector<uint8_t> data = BuildRuleset({"||ads.example.com^"});
+  for (size_t i = sizeof(flat::Header); i < data.size(); ++i) {
+    std::vector<uint8_t> corrupt = data;
+    corrupt[i] ^= 0x80;
+    EXPECT_FALSE(UrlRulesetMatcher::VerifyChecksum(corrupt)) << i;
+  }
+}
+
+TEST(UrlRulesetMatcherFormatTest, SurvivesCorruptSections) {
+  // A ruleset whose header is valid but whose contents are not must not be
+  // read out of bounds; Create() does not verify the checksum.
+  std::vector<uint8_t> data = BuildRuleset(
+      {"||ads.example.com^", "trackpixel", "^x^$domain=a.com"});
+  const flat::Header header = GetHeader(data);
+  std::vector<uint8_t> corrupt = data;
+  for (size_t i = sizeof(flat::Header); i < corrupt.size(); ++i) {
+    corrupt[i] = 0xff;
+  }
+  std::optional<UrlRulesetMatcher> matcher = UrlRulesetMatcher::Create(corrupt);
+  ASSERT_TRUE(matcher);
+  EXPECT_EQ(header.rule_count, matcher->rule_count());
+  const url::Origin initiator = Origin("https://a.com");
+  for (const char* url : {"https://ads.example.com/x/trackpixel",
+                          "https://a.com/x/"}) {
+    EXPECT_FALSE(
+        matcher->ShouldBlock(GURL(url), &initiator, kElementTypeScript));
+  }
+}
+
+TEST(RulesetBuilderTest, RejectsRulesThatDoNotFit) {
+  RulesetBuilder builder;
+  FilterRule rule;
+  ASSERT_EQ(ParseResult::kRule, ParseFilterRule("/ads^", rule));
+  EXPECT_TRUE(builder.AddRule(rule));
+
+  FilterRule many_domains = rule;
+  many_domains.include_domains.assign(256, "a.com");
+  EXPECT_FALSE(builder.AddRule(many_domains));
+  FilterRule long_pattern = rule;
+  long_pattern.pattern.assign(70000, 'a');
+  EXPECT_FALSE(builder.AddRule(long_pattern));
+  EXPECT_EQ(1u, builder.rule_count());
+}
+
+}  // namespace
+
+}  // namespace safe_deal::url_filter
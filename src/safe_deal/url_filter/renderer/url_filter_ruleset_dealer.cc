@@ -0,0 +1,35 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/renderer/url_filter_ruleset_dealer.h"
+
+#include <utility>
+
+namespace safe_deal::url_filter {
+
+// static
+UrlFilterRulesetDealer& UrlFilterRulesetDealer::GetInstance() {
+  static base::NoDestructor<UrlFilterRulesetDealer> instance;
+  return *instance;
+}
+
+UrlFilterRulesetDealer::UrlFilterRulesetDealer() = default;
+UrlFilterRulesetDealer::~UrlFilterRulesetDealer() = default;
+
+void UrlFilterRulesetDealer::SetRulesetFile(base::File file) {
+  // Mapping and validating the header is constant time, so this is fine on
+  // the main thread. The browser verified the checksum before sending it.
+  scoped_refptr<const MemoryMappedRuleset> ruleset =
+      MemoryMappedRuleset::Create(std::move(file));
+  base::AutoLock lock(lock_);
+  ruleset_ = std::move(ruleset);
+}
+
+scoped_refptr<const MemoryMappedRuleset> UrlFilterRulesetDealer::GetRuleset()
+    const {
+  base::AutoLock lock(lock_);
+  return ruleset_;
+}
+
+}  // namespace safe_deal::url_filter
@@ -0,0 +1,46 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_RENDERER_URL_FILTER_RULESET_DEALER_H_
+#define SAFE_DEAL_URL_FILTER_RENDERER_URL_FILTER_RULESET_DEALER_H_
+
+#include "base/files/file.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "safe_deal/url_filter/core/memory_mapped_ruleset.h"
+
+namespace safe_deal::url_filter {
+
+// Holds the ruleset of a render process. It is set on the main thread when
+// the browser sends it and read from every thread that creates URL loader
+// throttles, including worker threads.
+class UrlFilterRulesetDealer {
+ public:
+  static UrlFilterRulesetDealer& GetInstance();
+
+  UrlFilterRulesetDealer(const UrlFilterRulesetDealer&) = delete;
+  UrlFilterRulesetDealer& operator=(const UrlFilterRulesetDealer&) = delete;
+
+  // Maps |file|, replacing the current ruleset. Requests already in flight
+  // keep the ruleset they started with.
+  void SetRulesetFile(base::File file);
+
+  // Returns null until a ruleset has been received.
+  scoped_refptr<const MemoryMappedRuleset> GetRuleset() const;
+
+ private:
+  friend class base::NoDestructor<UrlFilterRulesetDealer>;
+
+  UrlFilterRulesetDealer();
+  ~UrlFilterRulesetDealer();
+
+  mutable base::Lock lock_;
+  scoped_refptr<const MemoryMappedRuleset> ruleset_ GUARDED_BY(lock_);
+};
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_RENDERER_URL_FILTER_RULESET_DEALER_H_
@@ -0,0 +1,124 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/url_filter/renderer/url_filter_throttle.h"
+
+#include <utility>
+
+#include "base/metrics/histogram_functions.h"
+#include "base/timer/elapsed_timer.h"
+#include "base/trace_event/trace_event.h"
+#include "net/base/net_errors.h"
+#include "net/url_request/redirect_info.h"
+#include "safe_deal/common/thread_allocation_stats.h"
+#include "safe_deal/url_filter/renderer/url_filter_ruleset_dealer.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/mojom/fetch_api.mojom-shared.h"
+
+namespace safe_deal::url_filter {
+
+namespace {
+
+ElementType GetElementType(network::mojom::RequestDestination destination) {
+  using network::mojom::RequestDestination;
+  switch (destination) {
+    case RequestDestination::kScript:
+    case RequestDestination::kWorker:
+    case RequestDestination::kSharedWorker:
+    case RequestDestination::kServiceWorker:
+    case RequestDestination::kAudioWorklet:
+    case RequestDestination::kPaintWorklet:
+      return kElementTypeScript;
+    case RequestDestination::kImage:
+      return kElementTypeImage;
+    case RequestDestination::kStyle:
+    case RequestDestination::kXslt:
+      return kElementTypeStylesheet;
+    case RequestDestination::kEmbed:
+    case RequestDestination::kObject:
+      return kElementTypeObject;
+    case RequestDestination::kEmpty:
+      return kElementTypeXmlHttpRequest;
+    case RequestDestination::kIframe:
+    case RequestDestination::kFrame:
+    case RequestDestination::kFencedframe:
+      return kElementTypeSubdocument;
+    case RequestDestination::kFont:
+      return kElementTypeFont;
+    case RequestDestination::kAudio:
+    case RequestDestination::kVideo:
+    case RequestDestination::kTrack:
+      return kElementTypeMedia;
+    default:
+      return kElementTypeOther;
+  }
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<UrlFilterThrottle> UrlFilterThrottle::MaybeCreate() {
+  scoped_refptr<const MemoryMappedRuleset> ruleset =
+      UrlFilterRulesetDealer::GetInstance().GetRuleset();
+  if (!ruleset) {
+    return nullptr;
+  }
+  return std::make_unique<UrlFilterThrottle>(std::move(ruleset));
+}
+
+UrlFilterThrottle::UrlFilterThrottle(
+    scoped_refptr<const MemoryMappedRuleset> ruleset)
+    : ruleset_(std::move(ruleset)) {}
+
+UrlFilterThrottle::~UrlFilterThrottle() = default;
+
+void UrlFilterThrottle::WillStartRequest(network::ResourceRequest* request,
+                                         bool* defer) {
+  initiator_ = request->request_initiator;
+  element_type_ = request->keepalive &&
+                          request->destination ==
+                              network::mojom::RequestDestination::kEmpty
+                      ? kElementTypePing
+                      : GetElementType(request->destination);
+  MaybeCancel(request->url);
+}
+
+void UrlFilterThrottle::WillRedirectRequest(
+    net::RedirectInfo* redirect_info,
+    const network::mojom::URLResponseHead& response_head,
+    bool* defer,
+    std::vector<std::string>* to_be_removed_request_headers,
+    net::HttpRequestHeaders* modified_request_headers,
+    net::HttpRequestHeaders* modified_cors_exempt_request_headers) {
+  MaybeCancel(redirect_info->new_url);
+}
+
+const char* UrlFilterThrottle::NameForLoggingWillStartRequest() {
+  return "SafeDealUrlFilterThrottle";
+}
+
+void UrlFilterThrottle::MaybeCancel(const GURL& url) {
+  TRACE_EVENT("safe_deal", "UrlFilterThrottle::MaybeCancel");
+  base::ElapsedTimer timer;
+  const uint64_t allocations_start = GetThreadAllocationStats().count;
+  bool block = ruleset_->matcher().ShouldBlock(
+      url, initiator_ ? &*initiator_ : nullptr, element_type_);
+  const base::TimeDelta elapsed = timer.Elapsed();
+  // Matching must not call malloc; checked by
+  // tools/bench/allocation_benchmark.mjs.
+  TRACE_EVENT_INSTANT("safe_deal", "SafeDealHeapAllocations", "path",
+                      "UrlFilter.Match", "counted", CanCountThreadAllocations(),
+                      "units", 1, "allocations",
+                      GetThreadAllocationStats().count - allocations_start);
+  base::UmaHistogramCustomMicrosecondsTimes(
+      "SafeDeal.UrlFilter.MatchTime", elapsed, base::Microseconds(1),
+      base::Milliseconds(10), 50);
+  base::UmaHistogramBoolean("SafeDeal.UrlFilter.Blocked", block);
+  if (block) {
+    delegate_->CancelWithError(net::ERR_BLOCKED_BY_CLIENT,
+                               NameForLoggingWillStartRequest());
+  }
+}
+
+}  // namespace safe_deal::url_filter
@@ -0,0 +1,59 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_URL_FILTER_RENDERER_URL_FILTER_THROTTLE_H_
+#define SAFE_DEAL_URL_FILTER_RENDERER_URL_FILTER_THROTTLE_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_refptr.h"
+#include "safe_deal/common/safe_deal_partition.h"
+#include "safe_deal/url_filter/core/memory_mapped_ruleset.h"
+#include "third_party/blink/public/common/loader/url_loader_throttle.h"
+#include "url/origin.h"
+
+namespace safe_deal::url_filter {
+
+// Cancels subresource requests, and the redirects they follow, that the
+// ruleset blocks with net::ERR_BLOCKED_BY_CLIENT.
+// Created for every subresource request, so lives in SafeDealPartition.
+class UrlFilterThrottle : public blink::URLLoaderThrottle {
+  SAFE_DEAL_PARTITION_ALLOCATED(UrlFilterThrottle);
+
+ public:
+  // Returns null if no ruleset has been received yet.
+  static std::unique_ptr<UrlFilterThrottle> MaybeCreate();
+
+  explicit UrlFilterThrottle(
+      scoped_refptr<const MemoryMappedRuleset> ruleset);
+  UrlFilterThrottle(const UrlFilterThrottle&) = delete;
+  UrlFilterThrottle& operator=(const UrlFilterThrottle&) = delete;
+  ~UrlFilterThrottle() override;
+
+  // blink::URLLoaderThrottle:
+  void WillStartRequest(network::ResourceRequest* request,
+                        bool* defer) override;
+  void WillRedirectRequest(
+      net::RedirectInfo* redirect_info,
+      const network::mojom::URLResponseHead& response_head,
+      bool* defer,
+      std::vector<std::string>* to_be_removed_request_headers,
+      net::HttpRequestHeaders* modified_request_headers,
+      net::HttpRequestHeaders* modified_cors_exempt_request_headers) override;
+  const char* NameForLoggingWillStartRequest() override;
+
+ private:
+  void MaybeCancel(const GURL& url);
+
+  const scoped_refptr<const MemoryMappedRuleset> ruleset_;
+  std::optional<url::Origin> initiator_;
+  ElementType element_type_ = kElementTypeOther;
+};
+
+}  // namespace safe_deal::url_filter
+
+#endif  // SAFE_DEAL_URL_FILTER_RENDERER_URL_FILTER_THROTTLE_H_
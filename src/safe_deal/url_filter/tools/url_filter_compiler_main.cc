@@ -0,0 +1,98 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Compiles EasyList style filter lists into a ruleset for UrlRulesetMatcher.
+//
+// Usage: safe_deal_url_filter_compiler --output=<ruleset> <list>...
+
+#include <stdio.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_split.h"
+#include "safe_deal/url_filter/core/filter_rule_parser.h"
+#include "safe_deal/url_filter/core/ruleset_builder.h"
+
+namespace {
+
+constexpr char kOutputSwitch[] = "output";
+
+struct CompileStats {
+  size_t rules = 0;
+  size_t ignored = 0;
+  size_t unsupported = 0;
+  size_t invalid = 0;
+};
+
+bool AddFilterList(const base::FilePath& path,
+                   safe_deal::url_filter::RulesetBuilder& builder,
+                   CompileStats& stats) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents)) {
+    fprintf(stderr, "Cannot read %s\n", path.AsUTF8Unsafe().c_str());
+    return false;
+  }
+  for (std::string_view line : base::SplitStringPiece(
+           contents, "\r\n", base::KEEP_WHITESPACE,
+           base::SPLIT_WANT_NONEMPTY)) {
+    safe_deal::url_filter::FilterRule rule;
+    switch (safe_deal::url_filter::ParseFilterRule(line, rule)) {
+      case safe_deal::url_filter::ParseResult::kRule:
+        if (builder.AddRule(rule)) {
+          ++stats.rules;
+        } else {
+          ++stats.unsupported;
+        }
+        break;
+      case safe_deal::url_filter::ParseResult::kIgnored:
+        ++stats.ignored;
+        break;
+      case safe_deal::url_filter::ParseResult::kUnsupported:
+        ++stats.unsupported;
+        break;
+      case safe_deal::url_filter::ParseResult::kInvalid:
+        ++stats.invalid;
+        break;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+  base::FilePath output = command_line.GetSwitchValuePath(kOutputSwitch);
+  std::vector<base::CommandLine::StringType> inputs = command_line.GetArgs();
+  if (output.empty() || inputs.empty()) {
+    fprintf(stderr,
+            "Usage: %s --output=<ruleset> <filter list>...\n",
+            command_line.GetProgram().AsUTF8Unsafe().c_str());
+    return 1;
+  }
+
+  safe_deal::url_filter::RulesetBuilder builder;
+  CompileStats stats;
+  for (const base::CommandLine::StringType& input : inputs) {
+    if (!AddFilterList(base::FilePath(input), builder, stats)) {
+      return 1;
+    }
+  }
+
+  std::vector<uint8_t> ruleset = builder.Build();
+  if (!base::WriteFile(output, ruleset)) {
+    fprintf(stderr, "Cannot write %s\n", output.AsUTF8Unsafe().c_str());
+    return 1;
+  }
+  printf("Compiled %zu rules into %zu bytes (%zu unsupported, %zu invalid)\n",
+         stats.rules, ruleset.size(), stats.unsupported, stats.invalid);
+  return 0;
+}
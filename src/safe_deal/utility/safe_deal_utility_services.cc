@@ -0,0 +1,27 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#include "safe_deal/utility/safe_deal_utility_services.h"
+
+#include <memory>
+#include <utility>
+
+#include "mojo/public/cpp/bindings/service_factory.h"
+#include "safe_deal/review_scorer/service/review_scorer_impl.h"
+
+namespace safe_deal {
+
+namespace {
+
+auto RunReviewScorer(mojo::PendingReceiver<mojom::ReviewScorer> receiver) {
+  return std::make_unique<ReviewScorerImpl>(std::move(receiver));
+}
+
+}  // namespace
+
+void RegisterSafeDealUtilityServices(mojo::ServiceFactory& services) {
+  services.Add(RunReviewScorer);
+}
+
+}  // namespace safe_deal
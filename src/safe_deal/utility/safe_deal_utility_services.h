@@ -0,0 +1,20 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+#ifndef SAFE_DEAL_UTILITY_SAFE_DEAL_UTILITY_SERVICES_H_
+#define SAFE_DEAL_UTILITY_SAFE_DEAL_UTILITY_SERVICES_H_
+
+namespace mojo {
+class ServiceFactory;
+}  // namespace mojo
+
+namespace safe_deal {
+
+// Registers the Safe Deal services that run in utility processes. Called
+// from RegisterMainThreadServices() in chrome/utility/services.cc.
+void RegisterSafeDealUtilityServices(mojo::ServiceFactory& services);
+
+}  // namespace safe_deal
+
+#endif  // SAFE_DEAL_UTILITY_SAFE_DEAL_UTILITY_SERVICES_H_
@@ -0,0 +1,440 @@
+#!/usr/bin/env python3
+# Copyright 2024 The Safe Deal Authors
+# Use of this source code is governed by the Apache License, Version 2.0 that
+# can be found in the LICENSE file.
+"""Prebuilt output directories, shared between CI and developer machines.
+
+tools/build.sh runs, when $SAFE_DEAL_ARTIFACT_CACHE is set,
+
+  artifact_cache.py fetch --out-dir=out/Default chrome     # before autoninja
+  artifact_cache.py publish --out-dir=out/Default chrome   # after a build
+
+where publish is record, which only remembers the key of the build, unless
+$SAFE_DEAL_ARTIFACT_CACHE_PUBLISH is 1.
+
+An artifact is a whole output directory after building a target, object
+files and linked binaries included, stored under a content hash of
+everything the build depends on:
+
+  - the Chromium revision, which pins every dependency through DEPS,
+  - the GN args, and the contents of the PGO profile they name, if any,
+  - the Safe Deal patch: the changes to Chromium's tracked files and the
+    contents of the sources tools/build.sh mirrors into the checkout,
+  - the target and the host platform.
+
+fetch replaces the output directory with the artifact when one exists for
+the current key. The files ninja checks for the target, as listed by
+`ninja -t inputs` and `ninja -t deps` from the restored directory, then get
+the Chromium commit time as their modification time wherever they are
+newer, so that ninja sees the restored outputs as up to date: they are the same files a build of these
+sources produced, and they were built after that commit. The autoninja run
+that follows has nothing to do, and later edits rebuild incrementally as
+usual. A directory whose recorded key is current is kept as it is. publish
+uploads the output directory unless its key is stored already; CI
+publishes, developers usually only fetch.
+
+$SAFE_DEAL_ARTIFACT_CACHE is a directory, e.g. a network mount, an http(s)://
+URL that answers GET and PUT, with $SAFE_DEAL_ARTIFACT_CACHE_TOKEN as bearer
+token if set, or a gs:// bucket, accessed with gcloud. Artifacts are tar
+archives compressed with zstd, which must be installed.
+"""
+
+import argparse
+import hashlib
+import os
+import platform
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import urllib.error
+import urllib.request
+
+STATE_DIR = 'safe_deal_build'
+KEY_FILE = 'artifact_key.txt'
+# Bump when the archive layout or the key inputs change.
+FORMAT_VERSION = 1
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+PROJECT_ROOT = os.path.dirname(TOOLS_DIR)
+OVERLAY_DIR = os.path.join(PROJECT_ROOT, 'src')
+
+PGO_DATA_PATH = re.compile(r'^pgo_data_path\s*=\s*"//([^"]+)"', re.MULTILINE)
+
+CHUNK_SIZE = 1 << 20
+
+
+def git(src_dir, *args):
+  return subprocess.run(['git', '-C', src_dir] + list(args),
+                        check=True,
+                        capture_output=True).stdout
+
+
+def hash_file(path, digest):
+  with open(path, 'rb') as f:
+    for chunk in iter(lambda: f.read(CHUNK_SIZE), b''):
+      digest.update(chunk)
+
+
+def hash_overlay():
+  """Hashes the sources tools/build.sh mirrors into the checkout."""
+  digest = hashlib.sha256()
+  for root, dirs, files in os.walk(OVERLAY_DIR):
+    dirs.sort()
+    for name in sorted(files):
+      path = os.path.join(root, name)
+      digest.update(os.path.relpath(path, OVERLAY_DIR).encode() + b'\0')
+      hash_file(path, digest)
+  return digest.hexdigest()
+
+
+def normalize_args(args):
+  """Drops comments, blank lines and order from args.gn."""
+  lines = []
+  for line in args.splitlines():
+    line = line.split('#', 1)[0].strip()
+    if line:
+      lines.append(re.sub(r'\s*=\s*', ' = ', line))
+  return '\n'.join(sorted(lines))
+
+
+def compute_key(src_dir, out_dir, target):
+  """Returns the key of the build and the inputs it was computed from."""
+  args_path = os.path.join(out_dir, 'args.gn')
+  args = ''
+  if os.path.exists(args_path):
+    with open(args_path) as f:
+      args = f.read()
+  patch = hashlib.sha256(git(src_dir, 'diff', '--binary', 'HEAD'))
+  inputs = [
+      'format %d' % FORMAT_VERSION,
+      'chromium %s' % git(src_dir, 'rev-parse', 'HEAD').decode().strip(),
+      'args %s' % hashlib.sha256(normalize_args(args).encode()).hexdigest(),
+      'chromium_patch %s' % patch.hexdigest(),
+      'overlay %s' % hash_overlay(),
+      'target %s' % target,
+      'host %s-%s' % (platform.system(), platform.machine()),
+  ]
+  match = PGO_DATA_PATH.search(args)
+  if match:
+    profile = hashlib.sha256()
+    hash_file(os.path.join(src_dir, match.group(1)), profile)
+    inputs.append('pgo_profile %s' % profile.hexdigest())
+  description = '\n'.join(inputs) + '\n'
+  return hashlib.sha256(description.encode()).hexdigest(), description
+
+
+class LocalStore(object):
+
+  def __init__(self, root):
+    self.root = root
+
+  def _path(self, name):
+    return os.path.join(self.root, name)
+
+  def exists(self, name):
+    return os.path.exists(self._path(name))
+
+  def get(self, name, dest):
+    if not self.exists(name):
+      return False
+    shutil.copyfile(self._path(name), dest)
+    return True
+
+  def put(self, name, src):
+    path = self._path(name)
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    # Readers never see a partial archive.
+    partial = '%s.%d.partial' % (path, os.getpid())
+    shutil.copyfile(src, partial)
+    os.replace(partial, path)
+
+
+class HttpStore(object):
+
+  def __init__(self, base_url):
+    self.base_url = base_url.rstrip('/')
+    self.headers = {}
+    token = os.environ.get('SAFE_DEAL_ARTIFACT_CACHE_TOKEN')
+    if token:
+      self.headers['Authorization'] = 'Bearer %s' % token
+
+  def _request(self, name, method, **kwargs):
+    return urllib.request.Request('%s/%s' % (self.base_url, name),
+                                  method=method,
+                                  headers=dict(self.headers),
+                                  **kwargs)
+
+  def exists(self, name):
+    try:
+      with urllib.request.urlopen(self._request(name, 'HEAD')):
+        return True
+    except urllib.error.HTTPError as e:
+      if e.code == 404:
+        return False
+      raise
+
+  def get(self, name, dest):
+    try:
+      with urllib.request.urlopen(self._request(name, 'GET')) as response, \
+          open(dest, 'wb') as f:
+        shutil.copyfileobj(response, f, CHUNK_SIZE)
+      return True
+    except urllib.error.HTTPError as e:
+      if e.code == 404:
+        return False
+      raise
+
+  def put(self, name, src):
+    with open(src, 'rb') as f:
+      request = self._request(name, 'PUT', data=f)
+      request.add_header('Content-Length', str(os.path.getsize(src)))
+      request.add_header('Content-Type', 'application/zstd')
+      urllib.request.urlopen(request).close()
+
+
+class GcsStore(object):
+
+  def __init__(self, base_url):
+    self.base_url = base_url.rstrip('/')
+
+  def _gcloud(self, *args):
+    return subprocess.run(['gcloud', 'storage'] + list(args),
+                          capture_output=True)
+
+  def exists(self, name):
+    return self._gcloud('ls', '%s/%s' % (self.base_url, name)).returncode == 0
+
+  def get(self, name, dest):
+    return self._gcloud('cp', '%s/%s' % (self.base_url, name),
+                        dest).returncode == 0
+
+  def put(self, name, src):
+    result = self._gcloud('cp', src, '%s/%s' % (self.base_url, name))
+    if result.returncode:
+      raise RuntimeError(result.stderr.decode(errors='replace'))
+
+
+def open_store():
+  location = os.environ.get('SAFE_DEAL_ARTIFACT_CACHE')
+  if not location:
+    sys.exit('SAFE_DEAL_ARTIFACT_CACHE is not set.')
+  if location.startswith(('http://', 'https://')):
+    return HttpStore(location)
+  if location.startswith('gs://'):
+    return GcsStore(location)
+  if location.startswith('file://'):
+    location = location[len('file://'):]
+  return LocalStore(location)
+
+
+def archive_name(key):
+  return '%s/%s.tar.zst' % (key[:2], key)
+
+
+def read_stored_key(out_dir):
+  path = os.path.join(out_dir, STATE_DIR, KEY_FILE)
+  if not os.path.exists(path):
+    return None
+  with open(path) as f:
+    return f.readline().strip()
+
+
+def write_stored_key(out_dir, key, description):
+  state_dir = os.path.join(out_dir, STATE_DIR)
+  os.makedirs(state_dir, exist_ok=True)
+  with open(os.path.join(state_dir, KEY_FILE), 'w') as f:
+    f.write('%s\n%s' % (key, description))
+
+
+def ninja_checked_files(out_dir, target):
+  """Yields the files ninja compares with the outputs of |target|.
+
+  These are the inputs of the build graph, generated ones included, the
+  headers the compiler reported in .ninja_deps and the files gn read, which
+  ninja checks to decide whether to regenerate build.ninja. Paths are
+  relative to |out_dir|. Nothing is yielded when ninja cannot list them,
+  e.g. for a siso build.
+  """
+  commands = [['ninja', '-C', out_dir, '-t', 'inputs', target],
+              ['ninja', '-C', out_dir, '-t', 'deps']]
+  for command in commands:
+    try:
+      ninja = subprocess.Popen(command,
+                               stdout=subprocess.PIPE,
+                               stderr=subprocess.DEVNULL,
+                               text=True)
+    except OSError:
+      return
+    with ninja:
+      for line in ninja.stdout:
+        # -t deps prints each output with its dependencies indented below.
+        if command[-1] == 'deps' and not line.startswith(' '):
+          continue
+        path = line.strip()
+        if path:
+          yield path
+  gn_deps = os.path.join(out_dir, 'build.ninja.d')
+  if os.path.exists(gn_deps):
+    with open(gn_deps) as f:
+      # "build.ninja build.ninja.stamp: ../../BUILD.gn ../../base/BUILD.gn..."
+      yield from f.read().partition(':')[2].split()
+
+
+def reset_source_times(src_dir, out_dir, target, commit_time):
+  """Sets the files ninja checks newer than the commit to the commit time.
+
+  Only files in the checkout and outside |out_dir| are touched, so the
+  outputs keep their times, while files under out/ that the build reads,
+  such as the PGO profile, are reset too.
+  """
+  src_root = os.path.join(os.path.realpath(src_dir), '')
+  out_dir = os.path.realpath(out_dir)
+  out_root = os.path.join(out_dir, '')
+  seen = set()
+  reset = 0
+  for relative in ninja_checked_files(out_dir, target):
+    if relative in seen:
+      continue
+    seen.add(relative)
+    path = os.path.normpath(os.path.join(out_dir, relative))
+    if not path.startswith(src_root) or path.startswith(out_root):
+      continue
+    try:
+      if os.stat(path).st_mtime > commit_time:
+        os.utime(path, (commit_time, commit_time))
+        reset += 1
+    except OSError:
+      pass
+  return reset
+
+
+def fetch(args):
+  src_dir = os.getcwd()
+  out_dir = os.path.abspath(args.out_dir)
+  if not shutil.which('zstd'):
+    print('zstd is not installed; not using the artifact cache.')
+    return 0
+  key, description = compute_key(src_dir, out_dir, args.target)
+  if read_stored_key(out_dir) == key:
+    print('%s was built from these sources already.' % args.out_dir)
+    return 0
+
+  store = open_store()
+  parent = os.path.dirname(out_dir)
+  with tempfile.TemporaryDirectory(dir=parent, prefix='.artifact_') as tmp:
+    archive = os.path.join(tmp, 'artifact.tar.zst')
+    print('Looking up artifact %s...' % key[:16])
+    if not store.get(archive_name(key), archive):
+      print('No artifact for these sources; building.')
+      return 0
+    print('Extracting the artifact into %s...' % args.out_dir)
+    extracted = os.path.join(tmp, 'out')
+    os.mkdir(extracted)
+    zstd = subprocess.Popen(['zstd', '-dc', archive], stdout=subprocess.PIPE)
+    subprocess.run(['tar', '-xf', '-', '-C', extracted],
+                   stdin=zstd.stdout,
+                   check=True)
+    if zstd.wait():
+      sys.exit('could not decompress the artifact')
+
+    # The build report's history stays with the directory it describes.
+    state_dir = os.path.join(out_dir, STATE_DIR)
+    if os.path.isdir(state_dir):
+      shutil.move(state_dir, os.path.join(extracted, STATE_DIR))
+    if os.path.exists(out_dir):
+      shutil.move(out_dir, os.path.join(tmp, 'previous'))
+    os.rename(extracted, out_dir)
+
+  commit_time = int(git(src_dir, 'log', '-1', '--format=%ct', 'HEAD'))
+  print('Resetting the times of newer sources so ninja keeps the outputs...')
+  reset = reset_source_times(src_dir, out_dir, args.target, commit_time)
+  print('Reset %d files.' % reset)
+  write_stored_key(out_dir, key, description)
+  return 0
+
+
+def record(args):
+  key, description = compute_key(os.getcwd(), os.path.abspath(args.out_dir),
+                                 args.target)
+  write_stored_key(os.path.abspath(args.out_dir), key, description)
+  return 0
+
+
+def publish(args):
+  src_dir = os.getcwd()
+  out_dir = os.path.abspath(args.out_dir)
+  if not shutil.which('zstd'):
+    print('zstd is not installed; not publishing.')
+    return 0
+  key, description = compute_key(src_dir, out_dir, args.target)
+  write_stored_key(out_dir, key, description)
+  store = open_store()
+  name = archive_name(key)
+  if store.exists(name):
+    print('Artifact %s is published already.' % key[:16])
+    return 0
+
+  with tempfile.TemporaryDirectory(dir=os.path.dirname(out_dir),
+                                   prefix='.artifact_') as tmp:
+    archive = os.path.join(tmp, 'artifact.tar.zst')
+    print('Archiving %s...' % args.out_dir)
+    with open(archive, 'wb') as f:
+      tar = subprocess.Popen(
+          ['tar', '-cf', '-', '--exclude=./%s' % STATE_DIR, '-C', out_dir, '.'],
+          stdout=subprocess.PIPE)
+      subprocess.run(['zstd', '-T0', '-3', '-q', '-c'],
+                     stdin=tar.stdout,
+                     stdout=f,
+                     check=True)
+      if tar.wait():
+        sys.exit('could not archive %s' % args.out_dir)
+    print('Publishing artifact %s (%d MiB)...' %
+          (key[:16], os.path.getsize(archive) >> 20))
+    store.put(name, archive)
+  return 0
+
+
+def print_key(args):
+  key, description = compute_key(os.getcwd(), os.path.abspath(args.out_dir),
+                                 args.target)
+  print('%s\n%s' % (key, description), end='')
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+  subparsers = parser.add_subparsers(dest='command', required=True)
+
+  fetch_parser = subparsers.add_parser(
+      'fetch', help='restore the output directory from the cache')
+  fetch_parser.add_argument('--out-dir', required=True)
+  fetch_parser.add_argument('target', help='target that will be built')
+  fetch_parser.set_defaults(func=fetch)
+
+  publish_parser = subparsers.add_parser(
+      'publish', help='upload the output directory to the cache')
+  publish_parser.add_argument('--out-dir', required=True)
+  publish_parser.add_argument('target', help='target that was built')
+  publish_parser.set_defaults(func=publish)
+
+  record_parser = subparsers.add_parser(
+      'record',
+      help='remember what the output directory was built from, so that '
+      'fetch keeps it')
+  record_parser.add_argument('--out-dir', required=True)
+  record_parser.add_argument('target', help='target that was built')
+  record_parser.set_defaults(func=record)
+
+  key_parser = subparsers.add_parser(
+      'key', help='print the key of the output directory and its inputs')
+  key_parser.add_argument('--out-dir', required=True)
+  key_parser.add_argument('target')
+  key_parser.set_defaults(func=print_key)
+
+  args = parser.parse_args()
+  return args.func(args) or 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
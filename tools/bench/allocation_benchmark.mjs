@@ -0,0 +1,145 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Checks that the per-request hot paths of the renderer make no malloc
+// calls:
+//
+//   yarn bench allocations --chrome=chromium/src/out/Release/chrome
+//
+// Loads every story of marketplace_stories.mjs from its Web Page Replay
+// archive (record them with `yarn bench --record`) with the safe_deal trace
+// category on, and reads the SafeDealHeapAllocations events the browser
+// emits with the malloc calls counted on the thread:
+//  - UrlFilter.Match: one per subresource request matched against the
+//    ruleset.
+//  - PageExtractor.Walk: one per extraction, over every element visited,
+//    leaving out the values the parser keeps.
+// Exits with 1 if any path called malloc. Allocations are only counted with
+// PartitionAlloc as malloc, which release builds use; without it the
+// benchmark fails rather than passing on zeros.
+//
+// Only malloc and operator new are counted. Allocations Blink makes on its
+// own heaps, Oilpan and the PartitionAlloc partitions behind WTF::String,
+// are not, so for PageExtractor.Walk this checks Safe Deal's side of the
+// walk, not the DOM calls it makes.
+
+import { existsSync } from 'node:fs';
+import path from 'node:path';
+import { fileURLToPath } from 'node:url';
+import { parseArgs } from 'node:util';
+
+import { Browser } from './cdp_pipe.mjs';
+import { STORIES } from './marketplace_stories.mjs';
+import { WebPageReplay } from './wpr.mjs';
+
+const BENCH_DIR = path.dirname(fileURLToPath(import.meta.url));
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+// Returns the SafeDealHeapAllocations events of one load of |story|.
+async function loadStory(options, story) {
+  const browser = await Browser.launch(options.chrome, [...options.chromeArgs, 'about:blank']);
+  try {
+    const { targetInfos } = await browser.send('Target.getTargets');
+    const page = targetInfos.find((target) => target.type === 'page');
+    const { sessionId } = await browser.send('Target.attachToTarget', {
+      targetId: page.targetId,
+      flatten: true,
+    });
+    await browser.send('Page.enable', {}, sessionId);
+
+    const events = [];
+    const removeListener = browser.on('Tracing.dataCollected', ({ value }) => events.push(...value));
+    await browser.send('Tracing.start', {
+      traceConfig: { includedCategories: ['safe_deal'], recordMode: 'recordAsMuchAsPossible' },
+      transferMode: 'ReportEvents',
+    });
+    const loaded = browser.waitForEvent(
+      'Page.loadEventFired',
+      (params, eventSessionId) => eventSessionId === sessionId,
+      60000,
+    );
+    await browser.send('Page.navigate', { url: story.url }, sessionId);
+    await loaded;
+    await sleep(options.settleMs);
+    const complete = browser.waitForEvent('Tracing.tracingComplete');
+    await browser.send('Tracing.end');
+    await complete;
+    removeListener();
+    return events.filter((e) => e.name === 'SafeDealHeapAllocations');
+  } finally {
+    await browser.close();
+  }
+}
+
+async function main() {
+  const { values } = parseArgs({
+    options: {
+      chrome: { type: 'string', default: 'chromium/src/out/Release/chrome' },
+      story: { type: 'string', multiple: true },
+      'settle-ms': { type: 'string', default: '2000' },
+      'wpr-dir': { type: 'string', default: 'chromium/src/third_party/catapult/web_page_replay_go' },
+      'archive-dir': { type: 'string', default: path.join(BENCH_DIR, 'archives') },
+    },
+  });
+  const stories = values.story
+    ? STORIES.filter((story) => values.story.includes(story.name))
+    : STORIES;
+  const archiveFor = (story) => path.join(values['archive-dir'], `${story.name}.wprgo`);
+  const missing = stories.filter((story) => !existsSync(archiveFor(story)));
+  if (!stories.length || missing.length) {
+    throw new Error(`no archive for ${missing.map((s) => s.name)}; record them with yarn bench --record`);
+  }
+
+  const options = { chrome: values.chrome, settleMs: Number(values['settle-ms']) };
+  const wpr = WebPageReplay.build(values['wpr-dir']);
+  options.chromeArgs = wpr.chromeArgs();
+  // path -> { calls, units, allocations, worst: { story, allocations } }
+  const totals = new Map();
+  let counted = true;
+  try {
+    for (const story of stories) {
+      process.stdout.write(`${story.name}\n`);
+      await wpr.start('replay', archiveFor(story));
+      for (const { args } of await loadStory(options, story)) {
+        counted &&= Boolean(args.counted);
+        const total = totals.get(args.path) ??
+          { calls: 0, units: 0, allocations: 0, worst: { story: '', allocations: 0 } };
+        total.calls += 1;
+        total.units += args.units;
+        total.allocations += args.allocations;
+        if (args.allocations > total.worst.allocations) {
+          total.worst = { story: story.name, allocations: args.allocations };
+        }
+        totals.set(args.path, total);
+      }
+      await wpr.stop();
+    }
+  } finally {
+    await wpr.dispose();
+  }
+
+  if (!counted || !totals.size) {
+    console.error('\nThis browser does not count allocations; build it with PartitionAlloc as malloc.');
+    process.exit(1);
+  }
+  console.log(`\n${'path'.padEnd(22)}${'calls'.padStart(8)}${'units'.padStart(10)}` +
+    `${'allocations'.padStart(13)}${'per unit'.padStart(10)}`);
+  let failed = false;
+  for (const [name, total] of [...totals].sort()) {
+    failed ||= total.allocations > 0;
+    console.log(`${name.padEnd(22)}${String(total.calls).padStart(8)}${String(total.units).padStart(10)}` +
+      `${String(total.allocations).padStart(13)}${(total.allocations / total.units).toFixed(3).padStart(10)}` +
+      `${total.allocations ? `   worst ${total.worst.allocations} on ${total.worst.story}` : ''}`);
+  }
+  if (failed) {
+    console.error('\nA hot path called malloc.');
+    process.exit(1);
+  }
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,34 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Runs one of the benchmarks, the page load benchmark by default:
+//
+//   yarn bench [page-load | startup | startup-perftest | allocations] [options]
+//
+// Options are passed on; see the benchmark for the ones it takes.
+
+import path from 'node:path';
+import { fileURLToPath, pathToFileURL } from 'node:url';
+
+const BENCH_DIR = path.dirname(fileURLToPath(import.meta.url));
+
+const BENCHMARKS = {
+  'page-load': 'page_load_benchmark.mjs',
+  startup: 'startup_benchmark.mjs',
+  'startup-perftest': 'startup_perftest.mjs',
+  allocations: 'allocation_benchmark.mjs',
+};
+
+let [name, ...args] = process.argv.slice(2);
+if (name === undefined || name.startsWith('-')) {
+  args = process.argv.slice(2);
+  name = 'page-load';
+}
+if (!(name in BENCHMARKS)) {
+  console.error(`unknown benchmark ${name}; one of ${Object.keys(BENCHMARKS).join(', ')}`);
+  process.exit(1);
+}
+// The benchmarks parse process.argv and take no positional arguments.
+process.argv = [process.argv[0], path.join(BENCH_DIR, BENCHMARKS[name]), ...args];
+await import(pathToFileURL(process.argv[1]).href);
@@ -0,0 +1,213 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Minimal Chrome DevTools Protocol client over --remote-debugging-pipe, so
+// the benchmarks need neither a WebSocket library nor a free port.
+
+import { execFileSync, spawn } from 'node:child_process';
+import { mkdtempSync, rmSync } from 'node:fs';
+import { tmpdir } from 'node:os';
+import path from 'node:path';
+
+export class Browser {
+  // Starts |chrome| with |args|. Resolves once the pipe answers.
+  static async launch(chrome, args = [], { userDataDir } = {}) {
+    const ownsUserDataDir = !userDataDir;
+    userDataDir ??= mkdtempSync(path.join(tmpdir(), 'safe_deal_bench_'));
+    const process = spawn(
+      chrome,
+      [
+        '--remote-debugging-pipe',
+        `--user-data-dir=${userDataDir}`,
+        '--no-first-run',
+        '--no-default-browser-check',
+        '--disable-background-networking',
+        ...args,
+      ],
+      // Chrome reads commands from fd 3 and writes replies to fd 4.
+      { stdio: ['ignore', 'ignore', 'pipe', 'pipe', 'pipe'] },
+    );
+    const browser = new Browser(process, ownsUserDataDir ? userDataDir : null);
+    await browser.send('Browser.getVersion');
+    return browser;
+  }
+
+  constructor(process, temporaryUserDataDir) {
+    this.process = process;
+    this.temporaryUserDataDir = temporaryUserDataDir;
+    this.nextId = 1;
+    this.pending = new Map();
+    this.listeners = new Map();
+    this.buffer = '';
+    this.stderr = '';
+    this.exited = new Promise((resolve) => {
+      process.once('exit', resolve);
+      process.once('error', resolve);
+    });
+    process.stderr.on('data', (data) => {
+      this.stderr = (this.stderr + data).slice(-4096);
+    });
+    process.stdio[4].on('data', (data) => this.onData(data));
+    // Write errors surface as the exit of the process.
+    process.stdio[3].on('error', () => {});
+    const rejectPending = (error) => {
+      for (const { reject } of this.pending.values()) {
+        reject(error);
+      }
+      this.pending.clear();
+    };
+    process.once('error', rejectPending);
+    process.once('exit', (code) => {
+      rejectPending(new Error(`chrome exited with ${code}: ${this.stderr}`));
+    });
+  }
+
+  get pid() {
+    return this.process.pid;
+  }
+
+  // Sends a CDP command and resolves with its result.
+  send(method, params = {}, sessionId = undefined) {
+    const id = this.nextId++;
+    const message = { id, method, params };
+    if (sessionId) {
+      message.sessionId = sessionId;
+    }
+    return new Promise((resolve, reject) => {
+      this.pending.set(id, { resolve, reject });
+      this.process.stdio[3].write(JSON.stringify(message) + '\0');
+    });
+  }
+
+  // Runs |listener| with the params and session of every |method| event.
+  // Returns a function that removes it.
+  on(method, listener) {
+    if (!this.listeners.has(method)) {
+      this.listeners.set(method, new Set());
+    }
+    this.listeners.get(method).add(listener);
+    return () => this.listeners.get(method)?.delete(listener);
+  }
+
+  // Resolves with the params of the next |method| event matching |filter|.
+  waitForEvent(method, filter = () => true, timeoutMs = 30000) {
+    return new Promise((resolve, reject) => {
+      const timer = setTimeout(() => {
+        remove();
+        reject(new Error(`timed out waiting for ${method}`));
+      }, timeoutMs);
+      const removeListener = this.on(method, (params, sessionId) => {
+        if (filter(params, sessionId)) {
+          remove();
+          resolve(params);
+        }
+      });
+      const remove = () => {
+        clearTimeout(timer);
+        removeListener();
+      };
+    });
+  }
+
+  onData(data) {
+    this.buffer += data;
+    let end;
+    while ((end = this.buffer.indexOf('\0')) !== -1) {
+      const message = JSON.parse(this.buffer.slice(0, end));
+      this.buffer = this.buffer.slice(end + 1);
+      if (message.id !== undefined) {
+        const pending = this.pending.get(message.id);
+        this.pending.delete(message.id);
+        if (message.error) {
+          pending?.reject(new Error(message.error.message));
+        } else {
+          pending?.resolve(message.result);
+        }
+      } else {
+        for (const listener of this.listeners.get(message.method) ?? []) {
+          listener(message.params, message.sessionId);
+        }
+      }
+    }
+  }
+
+  // Returns the histogram |name|, or null if nothing was recorded yet.
+  async getHistogram(name) {
+    try {
+      return (await this.send('Browser.getHistogram', { name })).histogram;
+    } catch {
+      return null;
+    }
+  }
+
+  async close() {
+    try {
+      await Promise.race([
+        this.send('Browser.close'),
+        new Promise((resolve) => setTimeout(resolve, 10000)),
+      ]);
+    } catch {
+      // The browser may exit before it answers.
+    }
+    const timeout = setTimeout(() => this.process.kill('SIGKILL'), 10000);
+    await this.exited;
+    clearTimeout(timeout);
+    if (this.temporaryUserDataDir) {
+      rmSync(this.temporaryUserDataDir, { recursive: true, force: true });
+    }
+  }
+}
+
+// Polls until |predicate| resolves truthy and returns its value.
+export async function poll(predicate, { intervalMs = 50, timeoutMs = 30000 } = {}) {
+  const deadline = Date.now() + timeoutMs;
+  for (;;) {
+    const value = await predicate();
+    if (value) {
+      return value;
+    }
+    if (Date.now() > deadline) {
+      throw new Error('timed out');
+    }
+    await new Promise((resolve) => setTimeout(resolve, intervalMs));
+  }
+}
+
+export function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  const middle = sorted.length >> 1;
+  return sorted.length % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+}
+
+export function percentile(values, p) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.min(sorted.length - 1, Math.floor((p / 100) * sorted.length))];
+}
+
+// Sum of the resident set sizes of |rootPid| and its descendants whose
+// command line matches |filter|, in KiB.
+export function processTreeRssKiB(rootPid, filter = () => true) {
+  const output = execFileSync('ps', ['-A', '-o', 'pid=,ppid=,rss=,args='], { encoding: 'utf8' });
+  const children = new Map();
+  const processes = new Map();
+  for (const line of output.trim().split('\n')) {
+    const [pid, ppid, kib, ...args] = line.trim().split(/\s+/);
+    processes.set(Number(pid), { kib: Number(kib), args: args.join(' ') });
+    if (!children.has(Number(ppid))) {
+      children.set(Number(ppid), []);
+    }
+    children.get(Number(ppid)).push(Number(pid));
+  }
+  let total = 0;
+  const stack = [rootPid];
+  while (stack.length) {
+    const pid = stack.pop();
+    const info = processes.get(pid);
+    if (info && filter(info.args)) {
+      total += info.kib;
+    }
+    stack.push(...(children.get(pid) ?? []));
+  }
+  return total;
+}
@@ -0,0 +1,16 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Pages of the page load benchmark. Each story is replayed from
+// archives/<name>.wprgo; record it again with --record after changing its
+// URL.
+
+export const STORIES = [
+  { name: 'amazon_search', url: 'https://www.amazon.com/s?k=usb+c+charger' },
+  { name: 'amazon_product', url: 'https://www.amazon.com/dp/B09B8V1LZ3' },
+  { name: 'aliexpress_search', url: 'https://www.aliexpress.com/w/wholesale-phone-case.html' },
+  { name: 'aliexpress_product', url: 'https://www.aliexpress.com/item/1005004128591656.html' },
+  { name: 'ebay_search', url: 'https://www.ebay.com/sch/i.html?_nkw=mechanical+keyboard' },
+  { name: 'ebay_product', url: 'https://www.ebay.com/itm/266262250606' },
+];
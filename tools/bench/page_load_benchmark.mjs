@@ -0,0 +1,334 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Compares marketplace page loads with and without the Safe Deal extension:
+//
+//   node tools/bench/page_load_benchmark.mjs --chrome=chromium/src/out/Release/chrome
+//
+// The search and product pages in marketplace_stories.mjs are replayed with
+// Web Page Replay from archives/, so results only change when the browser
+// does. Record the archives once with --record; that needs network access.
+//
+// Every run loads one story in a new browser with a new profile. Reported per
+// story and mode, as the median of --runs runs:
+//  - LCP: start time of the last largest-contentful-paint entry.
+//  - INP: the longest of a fixed sequence of clicks and key presses on a part
+//    of the page that is not a link or a control. Interactions shorter than
+//    16 ms are not reported by the browser, so 0 means all of them were.
+//  - Safe Deal main thread time: union of the time renderer main threads spent
+//    in chrome-extension:// scripts and in the native components (the
+//    safe_deal trace category).
+//  - Peak renderer memory: highest total resident memory of all renderer
+//    processes, sampled during the load.
+
+import { existsSync, mkdirSync, writeFileSync } from 'node:fs';
+import path from 'node:path';
+import { fileURLToPath } from 'node:url';
+import { parseArgs } from 'node:util';
+
+import { Browser, median, processTreeRssKiB } from './cdp_pipe.mjs';
+import { STORIES } from './marketplace_stories.mjs';
+import { WebPageReplay } from './wpr.mjs';
+
+const BENCH_DIR = path.dirname(fileURLToPath(import.meta.url));
+
+const MODES = {
+  without: ['--disable-features=SafeDealExtension'],
+  with: ['--enable-features=SafeDealExtension'],
+};
+
+const MEMORY_SAMPLE_INTERVAL_MS = 200;
+
+// Runs in the main world of every document before its own scripts.
+const OBSERVER_SCRIPT = `(() => {
+  const metrics = { lcp: undefined, interactions: new Map() };
+  Object.defineProperty(window, '__safeDealBench', { value: metrics });
+  new PerformanceObserver((list) => {
+    for (const entry of list.getEntries()) {
+      metrics.lcp = entry.startTime;
+    }
+  }).observe({ type: 'largest-contentful-paint', buffered: true });
+  new PerformanceObserver((list) => {
+    for (const entry of list.getEntries()) {
+      if (entry.interactionId) {
+        metrics.interactions.set(entry.interactionId,
+            Math.max(metrics.interactions.get(entry.interactionId) ?? 0, entry.duration));
+      }
+    }
+  }).observe({ type: 'event', durationThreshold: 16, buffered: true });
+})()`;
+
+const READ_METRICS_SCRIPT = `({
+  lcp: __safeDealBench.lcp,
+  inp: Math.max(0, ...__safeDealBench.interactions.values()),
+})`;
+
+// Finds a point of the viewport where a click neither follows a link nor
+// operates a control.
+const NEUTRAL_POINT_SCRIPT = `(() => {
+  const interactive = 'a, button, input, select, textarea, label, summary, ' +
+      '[onclick], [role=button], [role=link], [tabindex]';
+  for (let y = 40; y < innerHeight; y += 40) {
+    for (let x = 20; x < innerWidth; x += 40) {
+      const element = document.elementFromPoint(x, y);
+      if (element && !element.closest(interactive)) {
+        return { x, y };
+      }
+    }
+  }
+  return null;
+})()`;
+
+const TRACE_CATEGORIES = ['devtools.timeline', 'safe_deal'];
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+async function evaluate(browser, sessionId, expression) {
+  const { result, exceptionDetails } = await browser.send(
+    'Runtime.evaluate',
+    { expression, returnByValue: true },
+    sessionId,
+  );
+  if (exceptionDetails) {
+    throw new Error(`${expression}: ${exceptionDetails.text}`);
+  }
+  return result.value;
+}
+
+async function interact(browser, sessionId) {
+  const point = await evaluate(browser, sessionId, NEUTRAL_POINT_SCRIPT);
+  if (point) {
+    for (let i = 0; i < 3; ++i) {
+      for (const type of ['mousePressed', 'mouseReleased']) {
+        await browser.send(
+          'Input.dispatchMouseEvent',
+          { type, ...point, button: 'left', clickCount: 1 },
+          sessionId,
+        );
+      }
+      await sleep(300);
+    }
+  }
+  for (let i = 0; i < 3; ++i) {
+    for (const type of ['keyDown', 'keyUp']) {
+      await browser.send(
+        'Input.dispatchKeyEvent',
+        { type, key: 'Tab', code: 'Tab', windowsVirtualKeyCode: 9 },
+        sessionId,
+      );
+    }
+    await sleep(300);
+  }
+}
+
+async function startTrace(browser) {
+  const events = [];
+  const removeListener = browser.on('Tracing.dataCollected', ({ value }) => events.push(...value));
+  await browser.send('Tracing.start', {
+    traceConfig: { includedCategories: TRACE_CATEGORIES, recordMode: 'recordAsMuchAsPossible' },
+    transferMode: 'ReportEvents',
+  });
+  return async () => {
+    const complete = browser.waitForEvent('Tracing.tracingComplete');
+    await browser.send('Tracing.end');
+    await complete;
+    removeListener();
+    return events;
+  };
+}
+
+// Time in ms during which a renderer main thread ran Safe Deal code. Nested
+// and overlapping events are counted once.
+function safeDealMainThreadMs(events) {
+  const mainThreads = new Set(
+    events
+      .filter((e) => e.ph === 'M' && e.name === 'thread_name' && e.args?.name === 'CrRendererMain')
+      .map((e) => `${e.pid}:${e.tid}`),
+  );
+  const intervals = new Map();
+  for (const e of events) {
+    const thread = `${e.pid}:${e.tid}`;
+    if (e.ph !== 'X' || !mainThreads.has(thread)) {
+      continue;
+    }
+    const isNative = e.cat.split(',').includes('safe_deal');
+    const isExtension = (e.args?.data?.url ?? '').startsWith('chrome-extension://');
+    if (!isNative && !isExtension) {
+      continue;
+    }
+    if (!intervals.has(thread)) {
+      intervals.set(thread, []);
+    }
+    intervals.get(thread).push([e.ts, e.ts + (e.dur ?? 0)]);
+  }
+  let totalUs = 0;
+  for (const threadIntervals of intervals.values()) {
+    threadIntervals.sort((a, b) => a[0] - b[0]);
+    let [start, end] = threadIntervals[0];
+    for (const [nextStart, nextEnd] of threadIntervals.slice(1)) {
+      if (nextStart > end) {
+        totalUs += end - start;
+        [start, end] = [nextStart, nextEnd];
+      } else {
+        end = Math.max(end, nextEnd);
+      }
+    }
+    totalUs += end - start;
+  }
+  return totalUs / 1000;
+}
+
+// Loads |story| once. Returns its metrics if |measure| is set.
+async function loadStory(options, story, modeArgs, measure) {
+  const browser = await Browser.launch(options.chrome, [...options.chromeArgs, ...modeArgs, 'about:blank']);
+  try {
+    const { targetInfos } = await browser.send('Target.getTargets');
+    const page = targetInfos.find((target) => target.type === 'page');
+    const { sessionId } = await browser.send('Target.attachToTarget', {
+      targetId: page.targetId,
+      flatten: true,
+    });
+    await browser.send('Page.enable', {}, sessionId);
+    await browser.send('Page.addScriptToEvaluateOnNewDocument', { source: OBSERVER_SCRIPT }, sessionId);
+
+    const stopTrace = measure ? await startTrace(browser) : null;
+    let peakRendererKiB = 0;
+    const sampler = setInterval(() => {
+      const kib = processTreeRssKiB(browser.pid, (args) => args.includes('--type=renderer'));
+      peakRendererKiB = Math.max(peakRendererKiB, kib);
+    }, MEMORY_SAMPLE_INTERVAL_MS);
+    try {
+      const loaded = browser.waitForEvent(
+        'Page.loadEventFired',
+        (params, eventSessionId) => eventSessionId === sessionId,
+        60000,
+      );
+      await browser.send('Page.navigate', { url: story.url }, sessionId);
+      await loaded;
+      // Content scripts run at document_idle, which may be after the load.
+      await sleep(options.settleMs);
+      await interact(browser, sessionId);
+      await sleep(500);
+    } finally {
+      clearInterval(sampler);
+    }
+    if (!measure) {
+      return null;
+    }
+
+    const { lcp, inp } = await evaluate(browser, sessionId, READ_METRICS_SCRIPT);
+    return {
+      lcpMs: lcp ?? NaN,
+      inpMs: inp,
+      safeDealMainThreadMs: safeDealMainThreadMs(await stopTrace()),
+      peakRendererMiB: peakRendererKiB / 1024,
+    };
+  } finally {
+    await browser.close();
+  }
+}
+
+const METRICS = [
+  ['LCP (ms)', 'lcpMs'],
+  ['INP (ms)', 'inpMs'],
+  ['Safe Deal main thread (ms)', 'safeDealMainThreadMs'],
+  ['peak renderer memory (MiB)', 'peakRendererMiB'],
+];
+
+function printStory(name, results) {
+  const medianOf = (mode, key) =>
+    median(results[mode].map((run) => run[key]).filter((value) => !Number.isNaN(value)));
+  console.log(`\n${name.padEnd(30)}${'without'.padStart(10)}${'with'.padStart(10)}${'delta'.padStart(10)}`);
+  for (const [label, key] of METRICS) {
+    const without = medianOf('without', key);
+    const withExtension = medianOf('with', key);
+    const delta = withExtension - without;
+    console.log(
+      `  ${label.padEnd(28)}${without.toFixed(1).padStart(10)}` +
+        `${withExtension.toFixed(1).padStart(10)}` +
+        `${((delta >= 0 ? '+' : '') + delta.toFixed(1)).padStart(10)}`,
+    );
+  }
+}
+
+async function main() {
+  const { values } = parseArgs({
+    options: {
+      chrome: { type: 'string', default: 'chromium/src/out/Release/chrome' },
+      runs: { type: 'string', default: '5' },
+      story: { type: 'string', multiple: true },
+      'settle-ms': { type: 'string', default: '2000' },
+      'wpr-dir': { type: 'string', default: 'chromium/src/third_party/catapult/web_page_replay_go' },
+      'archive-dir': { type: 'string', default: path.join(BENCH_DIR, 'archives') },
+      record: { type: 'boolean', default: false },
+      json: { type: 'string' },
+    },
+  });
+  const stories = values.story
+    ? STORIES.filter((story) => values.story.includes(story.name))
+    : STORIES;
+  if (!stories.length) {
+    throw new Error(`no story matches ${values.story}; stories: ${STORIES.map((s) => s.name)}`);
+  }
+  const options = {
+    chrome: values.chrome,
+    runs: Number(values.runs),
+    settleMs: Number(values['settle-ms']),
+  };
+  const archiveFor = (story) => path.join(values['archive-dir'], `${story.name}.wprgo`);
+  if (!values.record) {
+    const missing = stories.filter((story) => !existsSync(archiveFor(story)));
+    if (missing.length) {
+      throw new Error(
+        `no archive for ${missing.map((s) => s.name)}; record them with --record`,
+      );
+    }
+  }
+
+  const wpr = WebPageReplay.build(values['wpr-dir']);
+  options.chromeArgs = wpr.chromeArgs();
+  const results = {};
+  try {
+    if (values.record) {
+      mkdirSync(values['archive-dir'], { recursive: true });
+      for (const story of stories) {
+        console.log(`recording ${story.name}`);
+        await wpr.start('record', archiveFor(story));
+        // With the extension, so that its own requests are recorded too.
+        await loadStory(options, story, MODES.with, false);
+        await wpr.stop();
+      }
+      return;
+    }
+
+    for (const story of stories) {
+      await wpr.start('replay', archiveFor(story));
+      results[story.name] = { without: [], with: [] };
+      process.stdout.write(`${story.name}:`);
+      // Alternating the modes spreads machine noise over both.
+      for (let i = 0; i < options.runs; ++i) {
+        process.stdout.write(` ${i + 1}`);
+        for (const [mode, args] of Object.entries(MODES)) {
+          results[story.name][mode].push(await loadStory(options, story, args, true));
+        }
+      }
+      process.stdout.write('\n');
+      await wpr.stop();
+    }
+  } finally {
+    await wpr.dispose();
+  }
+
+  for (const [name, storyResults] of Object.entries(results)) {
+    printStory(name, storyResults);
+  }
+  if (values.json) {
+    writeFileSync(values.json, JSON.stringify({ chrome: options.chrome, stories: results }, null, 2));
+  }
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,120 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Compares browser startup with the Safe Deal extension loaded eagerly and
+// lazily (features::kSafeDealLazyActivation):
+//
+//   node tools/bench/startup_benchmark.mjs --chrome=chromium/src/out/Release/chrome
+//
+// Each mode gets its own profile, warmed up by a first run that is not
+// counted, and is started --runs times on a non-marketplace page. Reported
+// per mode: time to the first non-empty paint as measured by the browser
+// (Startup.FirstWebContents.NonEmptyPaint3), resident memory of all browser
+// processes once startup settled, and the number of extension service
+// workers running. With --activation-url the lazy mode also reports how
+// long the first marketplace navigation waited for the extension.
+
+import { mkdtempSync, rmSync } from 'node:fs';
+import { tmpdir } from 'node:os';
+import path from 'node:path';
+import { parseArgs } from 'node:util';
+
+import { Browser, median, percentile, poll, processTreeRssKiB } from './cdp_pipe.mjs';
+
+const MODES = {
+  eager: '--disable-features=SafeDealLazyActivation',
+  lazy: '--enable-features=SafeDealLazyActivation',
+};
+
+async function runOnce(options, modeFlag, userDataDir) {
+  const browser = await Browser.launch(options.chrome, [modeFlag, options.url], { userDataDir });
+  try {
+    const paint = await poll(() => browser.getHistogram('Startup.FirstWebContents.NonEmptyPaint3'));
+    await new Promise((resolve) => setTimeout(resolve, options.settleMs));
+    const { targetInfos } = await browser.send('Target.getTargets');
+    const result = {
+      firstPaintMs: paint.sum / paint.count,
+      rssMiB: processTreeRssKiB(browser.pid) / 1024,
+      serviceWorkers: targetInfos.filter(
+        (target) => target.type === 'service_worker' && target.url.startsWith('chrome-extension://'),
+      ).length,
+    };
+    if (options.activationUrl) {
+      await browser.send('Target.createTarget', { url: options.activationUrl });
+      const activation = await poll(
+        () => browser.getHistogram('SafeDeal.LazyActivation.ActivationTime'),
+        { timeoutMs: 10000 },
+      ).catch(() => null);
+      result.activationMs = activation ? activation.sum / activation.count : NaN;
+    }
+    return result;
+  } finally {
+    await browser.close();
+  }
+}
+
+function summarize(name, runs, key, unit) {
+  const values = runs.map((run) => run[key]).filter((value) => !Number.isNaN(value));
+  if (!values.length) {
+    return `  ${name.padEnd(26)} n/a`;
+  }
+  return `  ${name.padEnd(26)} median ${median(values).toFixed(1).padStart(8)} ${unit}` +
+    `   p90 ${percentile(values, 90).toFixed(1).padStart(8)} ${unit}`;
+}
+
+async function main() {
+  const { values } = parseArgs({
+    options: {
+      chrome: { type: 'string', default: 'chromium/src/out/Release/chrome' },
+      runs: { type: 'string', default: '10' },
+      url: { type: 'string', default: 'about:blank' },
+      'settle-ms': { type: 'string', default: '5000' },
+      'activation-url': { type: 'string' },
+    },
+  });
+  const options = {
+    chrome: values.chrome,
+    runs: Number(values.runs),
+    url: values.url,
+    settleMs: Number(values['settle-ms']),
+    activationUrl: values['activation-url'],
+  };
+
+  const results = {};
+  for (const [mode, flag] of Object.entries(MODES)) {
+    const userDataDir = mkdtempSync(path.join(tmpdir(), `safe_deal_startup_${mode}_`));
+    try {
+      process.stdout.write(`${mode}: warm-up`);
+      await runOnce({ ...options, activationUrl: undefined }, flag, userDataDir);
+      results[mode] = [];
+      for (let i = 0; i < options.runs; ++i) {
+        process.stdout.write(` ${i + 1}`);
+        results[mode].push(await runOnce(options, flag, userDataDir));
+      }
+      process.stdout.write('\n');
+    } finally {
+      rmSync(userDataDir, { recursive: true, force: true });
+    }
+  }
+
+  for (const [mode, runs] of Object.entries(results)) {
+    console.log(`\n${mode} (${MODES[mode]}):`);
+    console.log(summarize('first non-empty paint', runs, 'firstPaintMs', 'ms'));
+    console.log(summarize('resident memory', runs, 'rssMiB', 'MiB'));
+    console.log(summarize('extension service workers', runs, 'serviceWorkers', ''));
+    if (options.activationUrl && mode === 'lazy') {
+      console.log(summarize('first marketplace wait', runs, 'activationMs', 'ms'));
+    }
+  }
+
+  const delta = (key) =>
+    median(results.lazy.map((run) => run[key])) - median(results.eager.map((run) => run[key]));
+  console.log(`\nlazy - eager: first paint ${delta('firstPaintMs').toFixed(1)} ms, ` +
+    `memory ${delta('rssMiB').toFixed(1)} MiB`);
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,191 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Fails when Safe Deal makes browser startup slower than startup_budget.json
+// allows:
+//
+//   yarn bench startup-perftest --chrome=chromium/src/out/Release/chrome
+//
+// There is no test binary: this script measures the release browser itself,
+// so build `chrome` first with `tools/build.sh --release`. The browser is
+// started --runs times on a page that is not a marketplace, after a warm-up
+// run that creates the profile and is not counted. Every run reads, over the
+// DevTools pipe, the SafeDeal.Startup.* histograms the browser recorded at
+// the first paint of the page (safe_deal_startup_metrics.h):
+//  - time: wall time spent in Safe Deal code since process start, on every
+//    thread.
+//  - disk reads: read system calls made from Safe Deal code. Linux only.
+//  - allocated: memory Safe Deal code allocated through malloc and operator
+//    new, freed or not. Needs PartitionAlloc as malloc, which release builds
+//    use.
+// The medians are compared with the budget; a metric the browser does not
+// record on this platform is skipped. Exits with 1 if any median is over
+// budget, or if no baseline was recorded for a metric it measured.
+//
+// --write-budget records a baseline instead: the machine, and per metric the
+// median, its spread (1.4826 times the median absolute deviation, which
+// estimates the standard deviation of the runs) and the budget, the median
+// plus three spreads, at least 5% or 1 unit. Record it on the machine the
+// check runs on, with at least the default number of runs, and check it in
+// with the change that is meant to cost more.
+
+import { mkdtempSync, readFileSync, rmSync, writeFileSync } from 'node:fs';
+import os from 'node:os';
+import path from 'node:path';
+import { fileURLToPath } from 'node:url';
+import { parseArgs } from 'node:util';
+
+import { Browser, median, poll } from './cdp_pipe.mjs';
+
+const BENCH_DIR = path.dirname(fileURLToPath(import.meta.url));
+
+const PAGE = 'data:text/html,<p>Safe Deal startup perftest</p>';
+
+const METRICS = {
+  timeMs: {
+    label: 'time in Safe Deal',
+    histogram: 'SafeDeal.Startup.TimeInSafeDeal',
+    // Recorded in microseconds.
+    fromSum: (sum) => sum / 1000,
+    unit: 'ms',
+  },
+  diskReads: {
+    label: 'disk reads',
+    histogram: 'SafeDeal.Startup.DiskReads',
+    fromSum: (sum) => sum,
+    unit: '',
+  },
+  allocatedKiB: {
+    label: 'allocated',
+    histogram: 'SafeDeal.Startup.AllocatedKiB',
+    fromSum: (sum) => sum,
+    unit: 'KiB',
+  },
+};
+
+// See --write-budget above.
+const SPREADS = 3;
+const MIN_HEADROOM = 0.05;
+const MIN_TOLERANCE = 1;
+
+function describeMachine() {
+  const cpus = os.cpus();
+  return `${cpus[0]?.model.trim() ?? 'unknown CPU'}, ${cpus.length} threads, ` +
+    `${Math.round(os.totalmem() / 2 ** 30)} GiB, ${os.type()} ${os.release()} ${os.arch()}`;
+}
+
+// Returns the baseline entry of one metric's samples.
+function baselineOf(samples) {
+  const value = median(samples);
+  const spread = 1.4826 * median(samples.map((sample) => Math.abs(sample - value)));
+  const tolerance = Math.max(SPREADS * spread, value * MIN_HEADROOM, MIN_TOLERANCE);
+  return {
+    median: Number(value.toFixed(2)),
+    spread: Number(spread.toFixed(2)),
+    budget: Math.ceil(value + tolerance),
+  };
+}
+
+async function runOnce(chrome, userDataDir) {
+  const browser = await Browser.launch(chrome, [PAGE], { userDataDir });
+  try {
+    // All three are recorded together, the time on every platform.
+    await poll(() => browser.getHistogram(METRICS.timeMs.histogram));
+    const result = {};
+    for (const [key, metric] of Object.entries(METRICS)) {
+      const histogram = await browser.getHistogram(metric.histogram);
+      result[key] = histogram ? metric.fromSum(histogram.sum) : NaN;
+    }
+    return result;
+  } finally {
+    await browser.close();
+  }
+}
+
+async function main() {
+  const { values } = parseArgs({
+    options: {
+      chrome: { type: 'string', default: 'chromium/src/out/Release/chrome' },
+      runs: { type: 'string', default: '10' },
+      budget: { type: 'string', default: path.join(BENCH_DIR, 'startup_budget.json') },
+      'write-budget': { type: 'boolean', default: false },
+    },
+  });
+
+  const runs = [];
+  const userDataDir = mkdtempSync(path.join(os.tmpdir(), 'safe_deal_startup_perftest_'));
+  try {
+    process.stdout.write('warm-up');
+    await runOnce(values.chrome, userDataDir);
+    for (let i = 0; i < Number(values.runs); ++i) {
+      process.stdout.write(` ${i + 1}`);
+      runs.push(await runOnce(values.chrome, userDataDir));
+    }
+    process.stdout.write('\n');
+  } finally {
+    rmSync(userDataDir, { recursive: true, force: true });
+  }
+
+  const samplesOf = {};
+  for (const key of Object.keys(METRICS)) {
+    samplesOf[key] = runs.map((run) => run[key]).filter((value) => !Number.isNaN(value));
+  }
+
+  const budget = JSON.parse(readFileSync(values.budget, 'utf8'));
+  if (values['write-budget']) {
+    budget.baseline = {
+      machine: describeMachine(),
+      runs: runs.length,
+      recorded: new Date().toISOString().slice(0, 10),
+    };
+    for (const [key, samples] of Object.entries(samplesOf)) {
+      // Keeps the baseline of metrics this platform does not record.
+      if (samples.length) {
+        budget[key] = baselineOf(samples);
+      }
+    }
+    writeFileSync(values.budget, `${JSON.stringify(budget, null, 2)}\n`);
+    console.log(`wrote ${values.budget}`);
+    return;
+  }
+
+  if (budget.baseline) {
+    console.log(`baseline: ${budget.baseline.machine}, ${budget.baseline.runs} runs, ` +
+      `recorded ${budget.baseline.recorded}`);
+  }
+  let failed = false;
+  let missing = false;
+  for (const [key, metric] of Object.entries(METRICS)) {
+    if (!samplesOf[key].length) {
+      console.log(`  ${metric.label.padEnd(18)} not recorded on this platform`);
+      continue;
+    }
+    const value = median(samplesOf[key]);
+    const limit = budget[key]?.budget;
+    if (limit === undefined) {
+      missing = true;
+      console.log(`  ${metric.label.padEnd(18)} median ${value.toFixed(1).padStart(9)} ${metric.unit.padEnd(3)}` +
+        '   NO BASELINE');
+      continue;
+    }
+    const over = value > limit;
+    failed ||= over;
+    console.log(`  ${metric.label.padEnd(18)} median ${value.toFixed(1).padStart(9)} ${metric.unit.padEnd(3)}` +
+      `   budget ${String(limit).padStart(7)} ${metric.unit.padEnd(3)}` +
+      `${over ? '   OVER BUDGET' : ''}`);
+  }
+  if (missing) {
+    console.error(`\nNo baseline is recorded in ${values.budget}; record one with --write-budget.`);
+    process.exit(1);
+  }
+  if (failed) {
+    console.error(`\nSafe Deal startup is over budget; see ${values.budget}.`);
+    process.exit(1);
+  }
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
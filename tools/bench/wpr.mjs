@@ -0,0 +1,102 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Records and replays page loads with Web Page Replay from the Chromium
+// checkout (third_party/catapult/web_page_replay_go), so that benchmark runs
+// before and after a Chromium roll load byte for byte the same pages.
+
+import { execFileSync, spawn } from 'node:child_process';
+import { mkdtempSync, rmSync } from 'node:fs';
+import net from 'node:net';
+import { tmpdir } from 'node:os';
+import path from 'node:path';
+
+import { poll } from './cdp_pipe.mjs';
+
+// SPKI hash of wpr_cert.pem, which WPR serves for every HTTPS host.
+const WPR_CERT_SPKI = 'PhrPvGIaAMmd29hj8BCZOq096yj7uMpRNHpn5PDxI6I=';
+
+const HTTP_PORT = 8480;
+const HTTPS_PORT = 8443;
+
+function canConnect(port) {
+  return new Promise((resolve) => {
+    const socket = net.connect(port, '127.0.0.1');
+    socket.once('connect', () => {
+      socket.destroy();
+      resolve(true);
+    });
+    socket.once('error', () => resolve(false));
+  });
+}
+
+export class WebPageReplay {
+  // Builds the wpr binary from |wprDir| with the Go toolchain.
+  static build(wprDir) {
+    const buildDir = mkdtempSync(path.join(tmpdir(), 'safe_deal_wpr_'));
+    const binary = path.join(buildDir, 'wpr');
+    try {
+      execFileSync('go', ['build', '-o', binary, './src/wpr.go'], { cwd: wprDir, stdio: 'inherit' });
+    } catch (error) {
+      rmSync(buildDir, { recursive: true, force: true });
+      throw new Error(`could not build wpr in ${wprDir}, is Go installed? ${error.message}`);
+    }
+    return new WebPageReplay(wprDir, buildDir, binary);
+  }
+
+  constructor(wprDir, buildDir, binary) {
+    this.wprDir = wprDir;
+    this.buildDir = buildDir;
+    this.binary = binary;
+    this.server = null;
+  }
+
+  // Flags that send all of Chrome's traffic to the server and accept its
+  // certificate.
+  chromeArgs() {
+    return [
+      `--host-resolver-rules=MAP *:80 127.0.0.1:${HTTP_PORT},` +
+        `MAP *:443 127.0.0.1:${HTTPS_PORT},EXCLUDE localhost`,
+      `--ignore-certificate-errors-spki-list=${WPR_CERT_SPKI}`,
+      '--disable-quic',
+    ];
+  }
+
+  // Starts serving |archive| in 'replay' mode, or recording to it in
+  // 'record' mode.
+  async start(mode, archive) {
+    // Relative paths, such as the default certificate and the injected
+    // deterministic.js, are resolved against the WPR directory.
+    this.server = spawn(
+      this.binary,
+      [mode, `--http_port=${HTTP_PORT}`, `--https_port=${HTTPS_PORT}`, path.resolve(archive)],
+      { cwd: this.wprDir, stdio: ['ignore', 'ignore', 'inherit'] },
+    );
+    this.exited = new Promise((resolve) => this.server.once('exit', resolve));
+    await poll(
+      async () => {
+        if (this.server.exitCode !== null) {
+          throw new Error(`wpr ${mode} exited with ${this.server.exitCode}`);
+        }
+        return canConnect(HTTPS_PORT);
+      },
+      { timeoutMs: 30000 },
+    );
+  }
+
+  // Stops the server. In 'record' mode this writes the archive.
+  async stop() {
+    if (!this.server) {
+      return;
+    }
+    this.server.kill('SIGINT');
+    await this.exited;
+    this.server = null;
+  }
+
+  async dispose() {
+    await this.stop();
+    rmSync(this.buildDir, { recursive: true, force: true });
+  }
+}
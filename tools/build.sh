@@ -6,6 +6,45 @@ SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
 PROJECT_ROOT="$SCRIPT_DIR/.."
 CHROMIUM_SRC_DIR="$PROJECT_ROOT/chromium/src"
 
+usage() {
+    echo "Usage: $0 [--fast | --release | --pgo-train] [--target=<gn label>]"
+    echo
+    echo "  --fast      Incremental developer build in out/Dev: component build,"
+    echo "              no symbols, gn gen only when out/Dev was never generated"
+    echo "              and a compiler cache when one is available."
+    echo "  --release   Shipping build in out/Release: official build with ThinLTO"
+    echo "              and PGO, using the profile from --pgo-train if there is one."
+    echo "  --pgo-train Build an instrumented chrome in out/PGOInstrument, load"
+    echo "              marketplace pages with it (tools/pgo/training_urls.txt)"
+    echo "              and write the profile used by --release."
+    echo "  --target    Ninja target to build (default: chrome). Use safe_deal"
+    echo "              to compile the Safe Deal sources without linking chrome."
+}
+
+FAST=0
+RELEASE=0
+PGO_TRAIN=0
+TARGET="chrome"
+for arg in "$@"; do
+    case "$arg" in
+        --fast|--dev) FAST=1 ;;
+        --release) RELEASE=1 ;;
+        --pgo-train) PGO_TRAIN=1 ;;
+        --target=*) TARGET="${arg#--target=}" ;;
+        -h|--help) usage; exit 0 ;;
+        *) usage; exit 1 ;;
+    esac
+done
+
+if [ $((FAST + RELEASE + PGO_TRAIN)) -gt 1 ]; then
+    usage
+    exit 1
+fi
+
+if [ "$TARGET" = "safe_deal" ]; then
+    TARGET="safe_deal:safe_deal"
+fi
+
 echo "Setting up build environment..."
 
 # Verify the Chromium src directory exists
@@ -35,20 +74,170 @@ fi
 
 echo "Using Chromium source directory: $CHROMIUM_SRC_DIR"
 
-# Check if the 'out' directory exists, if not create it
-if [ ! -d "out/Default" ]; then
-  mkdir -p out/Default
+# Apply the patches to Chromium's own files. Only files whose patched
+# contents changed are written; see tools/patches.py.
+echo "Applying Chromium patches..."
+if ! python3 "$SCRIPT_DIR/patches.py" apply; then
+    echo "Error: the patches in $PROJECT_ROOT/patches do not apply cleanly."
+    echo "Patches are applied without fuzz; refresh them with"
+    echo "  python3 tools/patches.py apply --3way && python3 tools/patches.py export"
+    exit 1
+fi
+
+# Mirror the Safe Deal sources into the Chromium checkout. --checksum only
+# rewrites files whose contents changed, so ninja does not rebuild the rest.
+echo "Syncing Safe Deal sources..."
+rsync -a --checksum "$PROJECT_ROOT/src/" "$CHROMIUM_SRC_DIR/"
+
+# Prints the gn args that route compiles through the fastest backend found:
+# siso or reclient when remote execution was requested with
+# SAFE_DEAL_REMOTEEXEC (it needs credentials, so it is never guessed), else a
+# local sccache or ccache.
+compiler_cache_args() {
+    case "${SAFE_DEAL_REMOTEEXEC:-}" in
+        siso)
+            echo "use_remoteexec = true"
+            echo "use_siso = true"
+            return
+            ;;
+        reclient)
+            echo "use_remoteexec = true"
+            echo "use_siso = false"
+            return
+            ;;
+        "") ;;
+        *)
+            echo "Error: SAFE_DEAL_REMOTEEXEC must be siso or reclient" >&2
+            return 1
+            ;;
+    esac
+    if command -v sccache > /dev/null; then
+        echo "cc_wrapper = \"sccache\""
+    elif command -v ccache > /dev/null; then
+        echo "cc_wrapper = \"ccache\""
+    fi
+}
+
+# Writes args.gn of $1 from stdin and generates the directory if needed.
+# args.gn is only rewritten when it changes: its timestamp alone makes ninja
+# regenerate the whole build graph. Once generated, ninja re-runs gn by itself
+# whenever a BUILD.gn, .gni or args.gn it was generated from changed (see
+# build.ninja.d), so an explicit gn gen would only re-check an unchanged
+# graph.
+configure_incrementally() {
+    local out_dir="$1"
+    local new_args
+    new_args="$(cat)"
+    mkdir -p "$out_dir"
+    if [ ! -f "$out_dir/args.gn" ] || \
+       [ "$new_args" != "$(cat "$out_dir/args.gn")" ]; then
+        echo "Updating $out_dir/args.gn..."
+        echo "$new_args" > "$out_dir/args.gn"
+    fi
+    if [ ! -f "$out_dir/build.ninja" ]; then
+        echo "Configuring the build..."
+        gn gen "$out_dir"
+    fi
+}
+
+# Profile from `--pgo-train`, used by `--release` when present.
+SAFE_DEAL_PROFILE="out/safe_deal.profdata"
+
+if [ "$PGO_TRAIN" -eq 1 ]; then
+    OUT_DIR="out/PGOInstrument"
+    TARGET="chrome"
+    configure_incrementally "$OUT_DIR" < "$SCRIPT_DIR/args/pgo_instrument.gn"
+elif [ "$RELEASE" -eq 1 ]; then
+    OUT_DIR="out/Release"
+    {
+        cat "$SCRIPT_DIR/args/release.gn"
+        if [ -f "$SAFE_DEAL_PROFILE" ]; then
+            echo "pgo_data_path = \"//$SAFE_DEAL_PROFILE\""
+        fi
+    } | configure_incrementally "$OUT_DIR"
+    if grep -q "^pgo_data_path" "$OUT_DIR/args.gn"; then
+        echo "Optimizing with the Safe Deal profile $SAFE_DEAL_PROFILE."
+    else
+        echo "Optimizing with Chromium's profile; run --pgo-train for one tuned to Safe Deal."
+        echo "Chromium's profiles need \"checkout_pgo_profiles\": True in the custom_vars of .gclient."
+    fi
+elif [ "$FAST" -eq 1 ]; then
+    OUT_DIR="out/Dev"
+
+    # Hits across checkouts and independent of __DATE__/__TIME__.
+    export CCACHE_BASEDIR="$CHROMIUM_SRC_DIR"
+    export CCACHE_CPP2=yes
+    export CCACHE_SLOPPINESS=time_macros
+
+    # Not in the pipeline below, whose subshell would swallow the failure.
+    CACHE_ARGS="$(compiler_cache_args)" || exit 1
+    {
+        cat "$SCRIPT_DIR/args/dev.gn"
+        if [ -n "$CACHE_ARGS" ]; then
+            echo "$CACHE_ARGS"
+        fi
+    } | configure_incrementally "$OUT_DIR"
+    grep -E "^(cc_wrapper|use_siso|use_remoteexec)" "$OUT_DIR/args.gn" || \
+        echo "No compiler cache found; install ccache or sccache to speed up clean builds."
+else
+    OUT_DIR="out/Default"
+
+    # Check if the 'out' directory exists, if not create it
+    if [ ! -d "$OUT_DIR" ]; then
+      mkdir -p "$OUT_DIR"
+    fi
+
+    echo "Configuring the build..."
+    gn gen "$OUT_DIR"
 fi
 
-echo "Configuring the build..."
-gn gen out/Default
+# With SAFE_DEAL_ARTIFACT_CACHE set, a build of the same sources and args
+# published by CI replaces the output directory, which leaves ninja nothing to
+# do; see tools/artifact_cache.py.
+if [ -n "${SAFE_DEAL_ARTIFACT_CACHE:-}" ]; then
+    python3 "$SCRIPT_DIR/artifact_cache.py" fetch --out-dir="$OUT_DIR" \
+        "$TARGET" || echo "Warning: could not fetch a prebuilt $OUT_DIR."
+fi
 
-echo "Building Chromium..."
-autoninja -C out/Default chrome
+# The report compares this build with the previous ones; see
+# tools/build_report.py. Its state lives next to the build it describes.
+REPORT_DIR="$OUT_DIR/safe_deal_build"
+mkdir -p "$REPORT_DIR"
+python3 "$SCRIPT_DIR/build_report.py" snapshot --out-dir="$OUT_DIR" || \
+    echo "Warning: could not snapshot the build state."
+
+echo "Building $TARGET in $OUT_DIR..."
+BUILD_START=$SECONDS
+set +e
+autoninja -C "$OUT_DIR" "$TARGET" 2>&1 | tee "$REPORT_DIR/ninja_output.log"
+BUILD_STATUS=${PIPESTATUS[0]}
+set -e
 
-if [ $? -eq 0 ]; then
-    echo "Build completed successfully!"
+if [ "$BUILD_STATUS" -eq 0 ]; then
+    echo "Build completed successfully in $((SECONDS - BUILD_START))s!"
+    python3 "$SCRIPT_DIR/build_report.py" report --out-dir="$OUT_DIR" \
+        "$TARGET" || echo "Warning: could not write the build report."
+    echo "Build report saved to $REPORT_DIR/last_report.txt"
+    if [ -n "${SAFE_DEAL_ARTIFACT_CACHE:-}" ]; then
+        if [ "${SAFE_DEAL_ARTIFACT_CACHE_PUBLISH:-0}" = 1 ]; then
+            CACHE_COMMAND=publish
+        else
+            CACHE_COMMAND=record
+        fi
+        python3 "$SCRIPT_DIR/artifact_cache.py" "$CACHE_COMMAND" \
+            --out-dir="$OUT_DIR" "$TARGET" || \
+            echo "Warning: could not $CACHE_COMMAND the build artifacts."
+    fi
+    if [ "$PGO_TRAIN" -eq 1 ]; then
+        TRAIN_ARGS=()
+        if [ -z "${DISPLAY:-}" ] && [ -z "${WAYLAND_DISPLAY:-}" ]; then
+            TRAIN_ARGS+=(--headless)
+        fi
+        python3 "$SCRIPT_DIR/pgo/train.py" --chrome="$OUT_DIR/chrome" \
+            --output="$SAFE_DEAL_PROFILE" "${TRAIN_ARGS[@]}"
+        echo "Profile written. Run $0 --release to build with it."
+    fi
 else
-    echo "Build failed. See errors above."
+    echo "Build failed. See errors above or in $REPORT_DIR/ninja_output.log."
     exit 1
 fi
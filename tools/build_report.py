@@ -0,0 +1,443 @@
+#!/usr/bin/env python3
+# Copyright 2024 The Safe Deal Authors
+# Use of this source code is governed by the Apache License, Version 2.0 that
+# can be found in the LICENSE file.
+"""Build time report for a Chromium output directory.
+
+tools/build.sh runs
+
+  build_report.py snapshot --out-dir=out/Default   # before autoninja
+  build_report.py report --out-dir=out/Default     # after autoninja
+
+and the report covers the steps of the last ninja invocation, read from
+<out-dir>/.ninja_log:
+
+  - the slowest translation units and the targets that took longest,
+  - the critical path, the longest chain of dependent steps that ran,
+  - the hit rate of ccache or sccache during the build,
+  - regressions: Safe Deal and //chrome/browser/extensions files whose
+    compile time at least doubled since they were last compiled, which is
+    what a Chromium roll that bloats a widely included header looks like.
+
+Everything the report needs across builds is kept in
+<out-dir>/safe_deal_build/.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+STATE_DIR = 'safe_deal_build'
+SNAPSHOT = 'snapshot.json'
+TIMINGS = 'timings.json'
+LAST_REPORT = 'last_report.txt'
+
+# Files whose compile time is tracked across builds.
+WATCHED_PREFIXES = (
+    'obj/safe_deal/',
+    'obj/chrome/browser/extensions/',
+)
+REGRESSION_FACTOR = 2.0
+# Below this a doubling is noise from a busy machine.
+REGRESSION_MIN_SECONDS = 1.0
+# ninja logs whole milliseconds, so a previous compile can take 0 seconds;
+# one this fast was a compiler cache hit and is no baseline.
+REGRESSION_MIN_BASELINE_SECONDS = 0.05
+
+COMPILE_SUFFIXES = ('.o', '.obj')
+
+
+class Step(object):
+  """One command ninja ran. Commands with several outputs are one step."""
+
+  def __init__(self, start, end, outputs):
+    self.start = start
+    self.end = end
+    self.outputs = outputs
+
+  @property
+  def duration(self):
+    return self.end - self.start
+
+  @property
+  def name(self):
+    return self.outputs[0]
+
+
+def read_last_build(out_dir, log_offset=None):
+  """Returns the steps of the last build recorded in .ninja_log.
+
+  The build starts at |log_offset| when the snapshot recorded one. Ninja
+  rewrites the log when it recompacts it, though, so otherwise the build
+  starts where the end times go backwards: every build's times are relative
+  to its own start.
+  """
+  path = os.path.join(out_dir, '.ninja_log')
+  if not os.path.exists(path):
+    return []
+  builds = [[]]
+  last_end = 0
+  with open(path) as log:
+    header = log.readline()
+    if not header.startswith('# ninja log v'):
+      sys.exit('%s is not a ninja log' % path)
+    if log_offset and log_offset <= os.path.getsize(path):
+      log.seek(log_offset)
+    for line in log:
+      fields = line.rstrip('\n').split('\t')
+      if len(fields) < 5 or fields[0].startswith('#'):
+        continue
+      start, end, output, command_hash = (int(fields[0]), int(fields[1]),
+                                          fields[3], fields[4])
+      if end < last_end:
+        builds.append([])
+      last_end = end
+      builds[-1].append((start, end, output, command_hash))
+
+  # Later entries for an output replace earlier ones, e.g. when ninja
+  # restarted after regenerating build.ninja.
+  latest = {}
+  for start, end, output, command_hash in builds[-1]:
+    latest[output] = (start, end, command_hash)
+  by_command = {}
+  for output, key in latest.items():
+    by_command.setdefault(key, []).append(output)
+  return [
+      Step(start / 1000.0, end / 1000.0, sorted(outputs))
+      for (start, end, _), outputs in by_command.items()
+  ]
+
+
+def is_compile(step):
+  return step.name.endswith(COMPILE_SUFFIXES)
+
+
+def target_of(output):
+  """obj/safe_deal/browser/browser/foo.o -> //safe_deal/browser:browser"""
+  if not output.startswith('obj/'):
+    return None
+  parts = output[len('obj/'):].split('/')
+  if len(parts) < 2:
+    return None
+  return '//%s:%s' % ('/'.join(parts[:-2]), parts[-2])
+
+
+def read_graph(out_dir, targets):
+  """Returns {output: [inputs]} for |targets| from `ninja -t graph`, or None.
+
+  In the dot output files are boxes and commands with several inputs or
+  outputs are ellipses in between.
+  """
+  ninja = shutil.which('ninja')
+  if not ninja:
+    return None
+  try:
+    dot = subprocess.run([ninja, '-C', out_dir, '-t', 'graph'] + targets,
+                         check=True,
+                         capture_output=True,
+                         text=True).stdout
+  except (OSError, subprocess.CalledProcessError):
+    return None
+
+  node_re = re.compile(r'^"(0x[0-9a-f]+)" \[label="([^"]*)"(, shape=ellipse)?')
+  edge_re = re.compile(r'^"(0x[0-9a-f]+)" -> "(0x[0-9a-f]+)"')
+  files = {}
+  commands = set()
+  edges = []
+  for line in dot.splitlines():
+    match = edge_re.match(line)
+    if match:
+      edges.append(match.groups())
+      continue
+    match = node_re.match(line)
+    if match:
+      if match.group(3):
+        commands.add(match.group(1))
+      else:
+        files[match.group(1)] = match.group(2)
+
+  command_inputs = {}
+  command_outputs = {}
+  inputs = {}
+  for source, destination in edges:
+    if destination in commands:
+      command_inputs.setdefault(destination, []).append(source)
+    elif source in commands:
+      command_outputs.setdefault(source, []).append(destination)
+    else:
+      inputs.setdefault(files[destination], []).append(files[source])
+  for command, outputs in command_outputs.items():
+    for output in outputs:
+      inputs.setdefault(files[output], []).extend(
+          files[source] for source in command_inputs.get(command, []))
+  return inputs
+
+
+def critical_path(steps, graph):
+  """Returns the chain of dependent steps with the largest total duration."""
+  step_of = {}
+  for step in steps:
+    for output in step.outputs:
+      step_of[output] = step
+
+  # Longest path ending at each file; only steps that ran cost time.
+  best = {}
+  for root in graph:
+    stack = [(root, False)]
+    while stack:
+      node, expanded = stack.pop()
+      if node in best:
+        continue
+      if not expanded:
+        stack.append((node, True))
+        stack.extend((dep, False) for dep in graph.get(node, ())
+                     if dep not in best)
+        continue
+      cost = step_of[node].duration if node in step_of else 0.0
+      longest, via = 0.0, None
+      for dep in graph.get(node, ()):
+        if dep in best and best[dep][0] > longest:
+          longest, via = best[dep][0], dep
+      best[node] = (longest + cost, via)
+
+  if not best:
+    return 0.0, []
+  end = max(best, key=lambda node: best[node][0])
+  total = best[end][0]
+  chain = []
+  node = end
+  while node is not None:
+    if node in step_of and (not chain or chain[-1] is not step_of[node]):
+      chain.append(step_of[node])
+    node = best[node][1]
+  return total, list(reversed(chain))
+
+
+def cache_stats():
+  """Returns cumulative compiler cache counters, or None without a cache."""
+  if shutil.which('sccache'):
+    try:
+      stats = json.loads(
+          subprocess.run(['sccache', '--show-stats', '--stats-format=json'],
+                         check=True,
+                         capture_output=True,
+                         text=True).stdout)['stats']
+      return {
+          'tool': 'sccache',
+          'hits': sum(stats['cache_hits']['counts'].values()),
+          'misses': sum(stats['cache_misses']['counts'].values()),
+      }
+    except (OSError, subprocess.CalledProcessError, ValueError, KeyError):
+      pass
+  if shutil.which('ccache'):
+    try:
+      output = subprocess.run(['ccache', '--print-stats'],
+                              check=True,
+                              capture_output=True,
+                              text=True).stdout
+      counters = dict(
+          line.split('\t', 1) for line in output.splitlines() if '\t' in line)
+      return {
+          'tool':
+              'ccache',
+          'hits':
+              int(counters.get('direct_cache_hit', 0)) +
+              int(counters.get('preprocessed_cache_hit', 0)),
+          'misses':
+              int(counters.get('cache_miss', 0)),
+      }
+    except (OSError, subprocess.CalledProcessError, ValueError):
+      pass
+  return None
+
+
+def chromium_revision(out_dir):
+  try:
+    return subprocess.run(
+        ['git', '-C',
+         os.path.join(out_dir, '..', '..'), 'rev-parse', '--short', 'HEAD'],
+        check=True,
+        capture_output=True,
+        text=True).stdout.strip()
+  except (OSError, subprocess.CalledProcessError):
+    return 'unknown'
+
+
+def load_json(path, default):
+  try:
+    with open(path) as f:
+      return json.load(f)
+  except (OSError, ValueError):
+    return default
+
+
+def save_json(path, value):
+  with open(path, 'w') as f:
+    json.dump(value, f, indent=1, sort_keys=True)
+
+
+def find_regressions(steps, timings, revision):
+  """Compares watched compiles with |timings| and updates it in place."""
+  regressions = []
+  for step in steps:
+    if not is_compile(step) or not step.name.startswith(WATCHED_PREFIXES):
+      continue
+    previous = timings.get(step.name)
+    if (previous and
+        previous['seconds'] >= REGRESSION_MIN_BASELINE_SECONDS and
+        step.duration >= REGRESSION_MIN_SECONDS and
+        step.duration >= REGRESSION_FACTOR * previous['seconds']):
+      regressions.append((step, previous))
+    timings[step.name] = {'seconds': step.duration, 'revision': revision}
+  regressions.sort(key=lambda r: r[0].duration / r[1]['seconds'],
+                   reverse=True)
+  return regressions
+
+
+def format_seconds(seconds):
+  if seconds >= 60:
+    return '%dm%04.1fs' % (seconds // 60, seconds % 60)
+  return '%.1fs' % seconds
+
+
+def snapshot(args):
+  state_dir = os.path.join(args.out_dir, STATE_DIR)
+  os.makedirs(state_dir, exist_ok=True)
+  log_path = os.path.join(args.out_dir, '.ninja_log')
+  save_json(
+      os.path.join(state_dir, SNAPSHOT), {
+          'cache': cache_stats(),
+          'log_offset':
+              os.path.getsize(log_path) if os.path.exists(log_path) else 0,
+      })
+
+
+def report(args):
+  state_dir = os.path.join(args.out_dir, STATE_DIR)
+  os.makedirs(state_dir, exist_ok=True)
+  before = load_json(os.path.join(state_dir, SNAPSHOT), {})
+  steps = read_last_build(args.out_dir, before.get('log_offset'))
+  lines = []
+  if not steps:
+    print('No build steps in %s/.ninja_log.' % args.out_dir)
+    return 0
+
+  revision = chromium_revision(args.out_dir)
+  wall = max(s.end for s in steps) - min(s.start for s in steps)
+  busy = sum(s.duration for s in steps)
+  compiles = [s for s in steps if is_compile(s)]
+  lines.append('Build report for %s at Chromium %s, %s' %
+               (args.out_dir, revision, time.strftime('%Y-%m-%d %H:%M')))
+  lines.append('  %d steps (%d compiles) in %s wall time, %s of work, '
+               'average parallelism %.1f' %
+               (len(steps), len(compiles), format_seconds(wall),
+                format_seconds(busy), busy / wall if wall else 0))
+
+  lines.append('')
+  lines.append('Slowest translation units:')
+  for step in sorted(compiles, key=lambda s: s.duration,
+                     reverse=True)[:args.top]:
+    lines.append('  %8s  %s' % (format_seconds(step.duration), step.name))
+
+  per_target = {}
+  for step in steps:
+    target = target_of(step.name)
+    if target:
+      total, count = per_target.get(target, (0.0, 0))
+      per_target[target] = (total + step.duration, count + 1)
+  lines.append('')
+  lines.append('Slowest targets (sum of their steps):')
+  for target, (total, count) in sorted(per_target.items(),
+                                       key=lambda item: item[1][0],
+                                       reverse=True)[:args.top]:
+    lines.append('  %8s  %4d steps  %s' % (format_seconds(total), count,
+                                           target))
+
+  lines.append('')
+  graph = read_graph(args.out_dir, args.targets) if args.targets else None
+  if graph is None:
+    longest = max(steps, key=lambda s: s.duration)
+    lines.append('Critical path: unavailable (no ninja graph); at least %s '
+                 '(%s)' % (format_seconds(longest.duration), longest.name))
+  else:
+    length, chain = critical_path(steps, graph)
+    lines.append('Critical path: %s of %s wall time' %
+                 (format_seconds(length), format_seconds(wall)))
+    for step in chain[-args.top:]:
+      lines.append('  %8s  %s' % (format_seconds(step.duration), step.name))
+
+  lines.append('')
+  cache_before = before.get('cache')
+  cache_after = cache_stats()
+  if (cache_before and cache_after and
+      cache_before['tool'] == cache_after['tool']):
+    hits = cache_after['hits'] - cache_before['hits']
+    misses = cache_after['misses'] - cache_before['misses']
+    lookups = hits + misses
+    lines.append('Compiler cache (%s): %d hits, %d misses, %.0f%% hit rate' %
+                 (cache_after['tool'], hits, misses,
+                  100.0 * hits / lookups if lookups else 0))
+  else:
+    lines.append('Compiler cache: none')
+
+  timings_path = os.path.join(state_dir, TIMINGS)
+  timings = load_json(timings_path, {})
+  regressions = find_regressions(steps, timings, revision)
+  save_json(timings_path, timings)
+  lines.append('')
+  if regressions:
+    lines.append('REGRESSIONS: compile time at least doubled for %d %s:' %
+                 (len(regressions), 'file' if len(regressions) == 1 else
+                  'files'))
+    for step, previous in regressions:
+      lines.append('  %8s -> %8s (x%.1f, was at %s)  %s' %
+                   (format_seconds(previous['seconds']),
+                    format_seconds(step.duration),
+                    step.duration / previous['seconds'], previous['revision'],
+                    step.name))
+  else:
+    lines.append('No compile time regressions in watched files.')
+
+  text = '\n'.join(lines)
+  print(text)
+  with open(os.path.join(state_dir, LAST_REPORT), 'w') as f:
+    f.write(text + '\n')
+  return 1 if regressions and args.fail_on_regression else 0
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+  subparsers = parser.add_subparsers(dest='command', required=True)
+
+  snapshot_parser = subparsers.add_parser(
+      'snapshot', help='record the state to compare with before a build')
+  snapshot_parser.add_argument('--out-dir', required=True)
+  snapshot_parser.set_defaults(func=snapshot)
+
+  report_parser = subparsers.add_parser(
+      'report', help='report on the last build in the output directory')
+  report_parser.add_argument('--out-dir', required=True)
+  report_parser.add_argument('--top',
+                             type=int,
+                             default=15,
+                             help='entries per section')
+  report_parser.add_argument('--fail-on-regression',
+                             action='store_true',
+                             help='exit with 1 when a regression is found')
+  report_parser.add_argument(
+      'targets',
+      nargs='*',
+      help='targets that were built, used for the critical path')
+  report_parser.set_defaults(func=report)
+
+  args = parser.parse_args()
+  return args.func(args) or 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -9,6 +9,30 @@ set -u
 # Ensure script is executed from the tools directory
 cd "$(dirname "$0")"
 
+usage() {
+    echo "Usage: $0 [--outputs | --safe-deal | --full]"
+    echo
+    echo "  --outputs   Default. Delete what ninja built in every chromium/src/out"
+    echo "              directory but keep args.gn and the build files, so the"
+    echo "              next build needs no gn gen. Compiler caches are kept."
+    echo "  --safe-deal Delete only the Safe Deal outputs (obj/ and gen/ under"
+    echo "              safe_deal/) and the Safe Deal sources mirrored into"
+    echo "              chromium/src; the next build rebuilds those and relinks."
+    echo "  --full      Delete the Chromium checkout, depot_tools and all build"
+    echo "              output. The git cache of the parallel sync is kept."
+}
+
+MODE=outputs
+for arg in "$@"; do
+    case "$arg" in
+        --outputs) MODE=outputs ;;
+        --safe-deal) MODE=safe-deal ;;
+        --full) MODE=full ;;
+        -h|--help) usage; exit 0 ;;
+        *) usage; exit 1 ;;
+    esac
+done
+
 # ANSI color codes
 RED='\033[0;31m'
 GREEN='\033[0;32m'
@@ -44,11 +68,68 @@ safe_remove_dir() {
     fi
 }
 
-# Function to safely remove files
+# Function to safely remove files named $1 under the directories that follow.
+# Only directories known to hold them are searched, not the whole tree.
 safe_remove_files() {
-    log "Removing $1 files..."
-    find .. -name "$1" -type f -delete || warning "Failed to remove some $1 files"
-    success "$1 files removed."
+    local pattern="$1"
+    shift
+    local dirs=()
+    for dir in "$@"; do
+        [ -d "$dir" ] && dirs+=("$dir")
+    done
+    if [ ${#dirs[@]} -eq 0 ]; then
+        return
+    fi
+    log "Removing $pattern files..."
+    find "${dirs[@]}" -name "$pattern" -type f -delete || warning "Failed to remove some $pattern files"
+    success "$pattern files removed."
+}
+
+# Chromium's output directories, those gn gen was run in.
+out_dirs() {
+    for dir in ../chromium/src/out/*/; do
+        [ -f "$dir/build.ninja" ] && echo "${dir%/}"
+    done
+}
+
+# The output was removed, so the artifact cache must not keep the directory
+# as the build of its recorded key.
+forget_artifact_key() {
+    rm -f "$1/safe_deal_build/artifact_key.txt"
+}
+
+clean_outputs() {
+    local dir
+    for dir in $(out_dirs); do
+        log "Cleaning $dir..."
+        # ninja -t clean leaves args.gn, build.ninja and .ninja_log. gn
+        # clean, for siso builds, keeps args.gn only and regenerates the rest.
+        if ninja -C "$dir" -t clean > /dev/null || gn clean "$dir"; then
+            forget_artifact_key "$dir"
+            success "$dir cleaned."
+        else
+            warning "Failed to clean $dir"
+        fi
+    done
+}
+
+clean_safe_deal() {
+    local dir
+    for dir in $(out_dirs); do
+        log "Removing the Safe Deal outputs in $dir..."
+        rm -rf "$dir/obj/safe_deal" "$dir/gen/safe_deal" || warning "Failed to remove some outputs in $dir"
+        forget_artifact_key "$dir"
+    done
+    # Sources removed from src/ since the last build are otherwise left in
+    # the checkout; tools/build.sh mirrors the current ones again.
+    safe_remove_dir "../chromium/src/safe_deal"
+    success "Safe Deal outputs removed."
+}
+
+clean_full() {
+    safe_remove_dir "../chromium"
+    safe_remove_dir "../depot_tools"
+    safe_remove_dir "../out"
 }
 
 # Display welcome message
@@ -56,29 +137,19 @@ echo -e "${BLUE}======================================"
 echo "  Safe Deal - Browser Cleanup Script"
 echo "======================================${NC}"
 
-# Remove directories
-safe_remove_dir "../chromium"
-safe_remove_dir "../depot_tools"
-safe_remove_dir "../out"
-
-# Remove specific files
-safe_remove_files ".gclient"
-safe_remove_files ".gclient_entries"
-safe_remove_files "*.pyc"
-safe_remove_files "*.log"
-
-# Clean git submodules
-log "Cleaning git submodules..."
-if [ -f "../.gitmodules" ]; then
-    git submodule foreach --recursive git clean -fdx || warning "Failed to clean some submodules"
-    git submodule foreach --recursive git reset --hard || warning "Failed to reset some submodules"
-    success "Git submodules cleaned."
-else
-    warning ".gitmodules file not found. Skipping submodule cleaning."
-fi
-
-# Remove sync progress log
-safe_remove_files "sync_progress.log"
+# depot_tools provides ninja and gn
+export PATH="$PATH:$(pwd)/../depot_tools"
+
+case "$MODE" in
+    outputs) clean_outputs ;;
+    safe-deal) clean_safe_deal ;;
+    full) clean_full ;;
+esac
+
+# Remove generated files. chromium/ is deleted as a whole in --full mode.
+safe_remove_files "*.pyc" . ../src
+find . ../src -name "__pycache__" -type d -empty -delete 2>/dev/null || true
+safe_remove_files "sync_progress.log" ../chromium
 
 # Final success message
 echo -e "${GREEN}======================================"
@@ -0,0 +1,487 @@
+#!/usr/bin/env python3
+# Copyright 2024 The Safe Deal Authors
+# Use of this source code is governed by the Apache License, Version 2.0 that
+# can be found in the LICENSE file.
+"""Applies the Safe Deal patch queue to the Chromium checkout.
+
+The changes Safe Deal makes to Chromium's own files are kept as patches in
+patches/, applied in the order of patches/series. Every Chromium file
+belongs to one patch, and the Safe Deal sources themselves are mirrored into
+the checkout by tools/build.sh rather than patched in.
+
+  patches.py apply       # make chromium/src match the queue
+  patches.py reset       # restore the patched files, e.g. before a pull
+  patches.py status      # show which patches are applied
+  patches.py check       # fail unless every patch is exported and applies
+  patches.py export      # write edits made in chromium/src back to patches/
+  patches.py add NAME FILE...  # start a new patch from edited files
+
+apply can be run any number of times. It applies the queue to the checked
+out revision in a scratch index, never in the working tree, and then only
+writes the files whose contents differ from the result, so ninja rebuilds
+the files whose patch or upstream revision changed and nothing else. Files
+a patch stopped changing are restored. It refuses to overwrite a patched
+file that was edited by hand since; export such edits first, or pass
+--force to drop them.
+
+When a patch no longer applies after a roll, apply --3way merges it into
+the working tree and leaves conflict markers in the files it could not
+merge. Resolve them and run export to refresh the patch.
+
+Patches are applied with their full three lines of context and no fuzz, so
+a hunk whose context moved upstream fails rather than landing in the wrong
+place, and apply only takes patches written by export: their index lines let
+--3way find the blobs they were made against.
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+PROJECT_ROOT = os.path.dirname(TOOLS_DIR)
+PATCHES_DIR = os.path.join(PROJECT_ROOT, 'patches')
+SERIES_FILE = os.path.join(PATCHES_DIR, 'series')
+SRC_DIR = os.path.join(PROJECT_ROOT, 'chromium', 'src')
+
+# Kept in the checkout's git directory, out of `git status` and diffs.
+STATE_FILE = 'safe_deal_patches.json'
+
+PATCHED_PATH = re.compile(r'^(?:---|\+\+\+) [ab]/(.+)$', re.MULTILINE)
+FILE_DIFF = re.compile(rb'^diff --git ', re.MULTILINE)
+# diff_of() writes full blob ids.
+FULL_INDEX = re.compile(rb'^index [0-9a-f]{40}\.\.[0-9a-f]{40}\b', re.MULTILINE)
+APPLY_ARGS = ['--whitespace=nowarn']
+
+
+class PatchError(Exception):
+  pass
+
+
+def git(*args, env=None, check=True, stdin=None):
+  result = subprocess.run(['git', '-C', SRC_DIR] + list(args),
+                          env=env,
+                          input=stdin,
+                          capture_output=True)
+  if check and result.returncode:
+    raise PatchError('git %s failed:\n%s' %
+                     (args[0], result.stderr.decode(errors='replace')))
+  return result
+
+
+def sha256(data):
+  return None if data is None else hashlib.sha256(data).hexdigest()
+
+
+def read_series():
+  if not os.path.exists(SERIES_FILE):
+    return []
+  with open(SERIES_FILE) as f:
+    lines = [line.split('#', 1)[0].strip() for line in f]
+  return [line for line in lines if line]
+
+
+def read_patch(name):
+  with open(os.path.join(PATCHES_DIR, name), 'rb') as f:
+    return f.read()
+
+
+def patched_files(patch):
+  return sorted(set(PATCHED_PATH.findall(patch.decode(errors='replace'))))
+
+
+def load_queue():
+  """Returns [(name, contents, files)] in series order."""
+  queue = []
+  owners = {}
+  for name in read_series():
+    patch = read_patch(name)
+    files = patched_files(patch)
+    for path in files:
+      if path in owners:
+        raise PatchError('%s is changed by both %s and %s; a file must '
+                         'belong to one patch.' % (path, owners[path], name))
+      owners[path] = name
+    queue.append((name, patch, files))
+  return queue
+
+
+def not_exported(queue):
+  """The patches of |queue| that were not written by export."""
+  return [
+      name for name, patch, _ in queue
+      if len(FULL_INDEX.findall(patch)) != len(FILE_DIFF.findall(patch))
+  ]
+
+
+def check_exported(queue):
+  names = not_exported(queue)
+  if names:
+    raise PatchError(
+        'These patches were not written by tools/patches.py export:\n  %s\n'
+        'Make their changes in chromium/src and run export, so that they '
+        'have full context and index lines.' % '\n  '.join(names))
+
+
+def state_path():
+  path = git('rev-parse', '--git-path', STATE_FILE).stdout.decode().strip()
+  return os.path.join(SRC_DIR, path)
+
+
+def load_state():
+  try:
+    with open(state_path()) as f:
+      return json.load(f)
+  except (OSError, ValueError):
+    return {'files': {}}
+
+
+def save_state(state):
+  with open(state_path(), 'w') as f:
+    json.dump(state, f, indent=2, sort_keys=True)
+    f.write('\n')
+
+
+def read_working(path):
+  try:
+    with open(os.path.join(SRC_DIR, path), 'rb') as f:
+      return f.read()
+  except FileNotFoundError:
+    return None
+
+
+def write_working(path, contents):
+  full_path = os.path.join(SRC_DIR, path)
+  if contents is None:
+    if os.path.exists(full_path):
+      os.remove(full_path)
+    return
+  os.makedirs(os.path.dirname(full_path), exist_ok=True)
+  with open(full_path, 'wb') as f:
+    f.write(contents)
+
+
+def read_blob(revision, path, env=None):
+  result = git('cat-file', 'blob', '%s:%s' % (revision, path),
+               env=env,
+               check=False)
+  return result.stdout if result.returncode == 0 else None
+
+
+def read_pristine(paths):
+  return {path: read_blob('HEAD', path) for path in paths}
+
+
+def apply_in_scratch_index(queue):
+  """Applies |queue| on top of HEAD without touching the working tree.
+
+  Returns ({path: contents}, {patch name: error}) with the patched contents,
+  None for deleted files, of every file of the patches that applied.
+  """
+  contents = {}
+  failures = {}
+  with tempfile.TemporaryDirectory() as scratch:
+    env = dict(os.environ, GIT_INDEX_FILE=os.path.join(scratch, 'index'))
+    git('read-tree', 'HEAD', env=env)
+    for name, patch, files in queue:
+      result = git('apply', '--cached', *APPLY_ARGS, '-',
+                   env=env,
+                   check=False,
+                   stdin=patch)
+      if result.returncode:
+        failures[name] = result.stderr.decode(errors='replace').strip()
+        continue
+      for path in files:
+        contents[path] = read_blob('', path, env=env)
+  return contents, failures
+
+
+def plan(queue, state):
+  """Works out what apply would write.
+
+  Returns (desired, current, pristine, edited, failures) where |desired|
+  maps every file the queue or the last apply touched to its contents once
+  applied, and |edited| lists the files changed by hand since.
+  """
+  desired, failures = apply_in_scratch_index(queue)
+  failed_files = set()
+  for name, _, files in queue:
+    if name in failures:
+      failed_files.update(files)
+  paths = (set(desired) | set(state['files'])) - failed_files
+  pristine = read_pristine(paths | failed_files)
+  for path in paths:
+    desired.setdefault(path, pristine[path])
+  current = {path: read_working(path) for path in paths | failed_files}
+  edited = []
+  for path in sorted(paths | failed_files):
+    if current[path] in (desired.get(path), pristine[path]):
+      continue
+    if sha256(current[path]) != state['files'].get(path):
+      edited.append(path)
+  return desired, current, pristine, edited, failures
+
+
+def merge_failed_patches(queue, failures, pristine):
+  """Merges the patches that failed into the working tree, with markers."""
+  conflicted = []
+  for name, patch, files in queue:
+    if name not in failures:
+      continue
+    for path in files:
+      write_working(path, pristine[path])
+    result = git('apply', '--3way', *APPLY_ARGS, '-', check=False,
+                 stdin=patch)
+    # --3way records the merge in the index; the checkout's index stays
+    # at HEAD.
+    git('reset', '-q', 'HEAD', '--', *files, check=False)
+    if result.returncode:
+      conflicted.append(name)
+  return conflicted
+
+
+def apply(args):
+  queue = load_queue()
+  check_exported(queue)
+  state = load_state()
+  desired, current, pristine, edited, failures = plan(queue, state)
+  if edited and not args.force:
+    raise PatchError(
+        'These files were edited in chromium/src since the patches were '
+        'applied:\n  %s\nRun tools/patches.py export to keep the changes, '
+        'or apply --force to drop them.' % '\n  '.join(edited))
+
+  written = 0
+  files = {}
+  for path in sorted(desired):
+    if current[path] != desired[path]:
+      write_working(path, desired[path])
+      written += 1
+    if desired[path] != pristine[path]:
+      files[path] = sha256(desired[path])
+  # Files of patches that failed keep what the last apply wrote, unless
+  # merged below.
+  for name, _, patch_files in queue:
+    if name in failures:
+      files.update((path, state['files'][path]) for path in patch_files
+                   if path in state['files'])
+  print('Patches: %d applied, %d file(s) updated.' %
+        (len(queue) - len(failures), written))
+
+  conflicted = []
+  if failures:
+    for name, error in failures.items():
+      print('%s does not apply:\n%s' % (name, error), file=sys.stderr)
+    if args.three_way:
+      conflicted = merge_failed_patches(queue, failures, pristine)
+  save_state({'head': git('rev-parse', 'HEAD').stdout.decode().strip(),
+              'files': files})
+
+  if not failures:
+    return 0
+  if not args.three_way:
+    print('Run tools/patches.py apply --3way to merge them into the working '
+          'tree, then tools/patches.py export.', file=sys.stderr)
+  elif conflicted:
+    print('Resolve the conflicts of %s, then run tools/patches.py export.' %
+          ', '.join(conflicted), file=sys.stderr)
+  else:
+    print('Merged; run tools/patches.py export to refresh the patches.',
+          file=sys.stderr)
+  return 1
+
+
+def reset(args):
+  state = load_state()
+  paths = sorted(state['files'])
+  pristine = read_pristine(paths)
+  edited = [
+      path for path in paths
+      if read_working(path) not in (pristine[path], None) and
+      sha256(read_working(path)) != state['files'][path]
+  ]
+  if edited and not args.force:
+    raise PatchError(
+        'These files were edited in chromium/src since the patches were '
+        'applied:\n  %s\nRun tools/patches.py export to keep the changes, '
+        'or reset --force to drop them.' % '\n  '.join(edited))
+  for path in paths:
+    write_working(path, pristine[path])
+  save_state({'files': {}})
+  print('Restored %d patched file(s).' % len(paths))
+  return 0
+
+
+def status(args):
+  queue = load_queue()
+  state = load_state()
+  desired, current, _, edited, failures = plan(queue, state)
+  hand_written = set(not_exported(queue))
+  for name, _, files in queue:
+    if name in hand_written:
+      print('%-60s not exported' % name)
+    elif name in failures:
+      print('%-60s does not apply' % name)
+    elif any(current[path] != desired[path] for path in files):
+      print('%-60s not applied' % name)
+    else:
+      print('%-60s applied' % name)
+  for path in edited:
+    print('  edited by hand: %s' % path)
+  return 0
+
+
+def check(args):
+  """Fails unless the whole queue would apply to the checked out revision.
+
+  Run it before committing a change to patches/. It applies the queue like
+  apply does, in a scratch index with `git apply --cached` and no fuzz, and
+  leaves the working tree alone.
+  """
+  queue = load_queue()
+  problems = ['%s: not written by export (no index lines)' % name
+              for name in not_exported(queue)]
+  _, failures = apply_in_scratch_index(queue)
+  for name, _, _ in queue:
+    if name in failures:
+      problems.append('%s: does not apply\n    %s' %
+                      (name, failures[name].replace('\n', '\n    ')))
+  if problems:
+    raise PatchError('The patch queue does not apply to %s:\n  %s' % (
+        git('rev-parse', '--short', 'HEAD').stdout.decode().strip(),
+        '\n  '.join(problems)))
+  print('All %d patch(es) apply.' % len(queue))
+  return 0
+
+
+def diff_of(files):
+  # --full-index lets apply --3way merge the patch after a roll.
+  return git('diff', '--full-index', '--no-color', '--no-ext-diff', 'HEAD',
+             '--', *files).stdout
+
+
+def header_of(patch):
+  """The description before the first diff."""
+  index = patch.find(b'diff --git ')
+  return patch if index < 0 else patch[:index]
+
+
+def write_patch(name, header, diff):
+  with open(os.path.join(PATCHES_DIR, name), 'wb') as f:
+    f.write(header + diff)
+
+
+def record_applied():
+  """Records the working tree as the applied queue."""
+  paths = set()
+  for _, _, files in load_queue():
+    paths.update(files)
+  pristine = read_pristine(paths)
+  files = {}
+  for path in sorted(paths):
+    contents = read_working(path)
+    if contents != pristine[path]:
+      files[path] = sha256(contents)
+  save_state({'head': git('rev-parse', 'HEAD').stdout.decode().strip(),
+              'files': files})
+
+
+def export(args):
+  written = 0
+  for name, patch, files in load_queue():
+    diff = diff_of(files)
+    if not diff:
+      print('Warning: %s has no changes left; remove it from patches/series.'
+            % name, file=sys.stderr)
+    if diff == patch[len(header_of(patch)):]:
+      continue
+    write_patch(name, header_of(patch), diff)
+    written += 1
+  record_applied()
+  print('Exported %d patch(es).' % written)
+  return 0
+
+
+def add(args):
+  name = args.name if args.name.endswith('.patch') else args.name + '.patch'
+  series = read_series()
+  if name in series:
+    raise PatchError('%s is in patches/series already; use export.' % name)
+  owned = {path for _, _, files in load_queue() for path in files}
+  taken = sorted(owned.intersection(args.files))
+  if taken:
+    raise PatchError('Already in a patch: %s' % ', '.join(taken))
+  diff = diff_of(args.files)
+  if not diff:
+    raise PatchError('None of %s differ from HEAD.' % ', '.join(args.files))
+  header = (args.message or name[:-len('.patch')].replace('-', ' ')) + '\n\n'
+  write_patch(name, header.encode(), diff)
+  with open(SERIES_FILE, 'a') as f:
+    f.write(name + '\n')
+  record_applied()
+  print('Added patches/%s.' % name)
+  return 0
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+  subparsers = parser.add_subparsers(dest='command', required=True)
+
+  apply_parser = subparsers.add_parser(
+      'apply', help='make chromium/src match the patch queue')
+  apply_parser.add_argument('--3way',
+                            dest='three_way',
+                            action='store_true',
+                            help='merge patches that do not apply into the '
+                            'working tree, with conflict markers')
+  apply_parser.add_argument('--force',
+                            action='store_true',
+                            help='overwrite files edited by hand')
+  apply_parser.set_defaults(func=apply)
+
+  reset_parser = subparsers.add_parser(
+      'reset', help='restore the files the patches changed')
+  reset_parser.add_argument('--force',
+                            action='store_true',
+                            help='restore files edited by hand too')
+  reset_parser.set_defaults(func=reset)
+
+  status_parser = subparsers.add_parser(
+      'status', help='show which patches are applied')
+  status_parser.set_defaults(func=status)
+
+  check_parser = subparsers.add_parser(
+      'check', help='fail unless every patch is exported and applies')
+  check_parser.set_defaults(func=check)
+
+  export_parser = subparsers.add_parser(
+      'export', help='write the changes in chromium/src back to the patches')
+  export_parser.set_defaults(func=export)
+
+  add_parser = subparsers.add_parser(
+      'add', help='add a patch with the changes to FILEs in chromium/src')
+  add_parser.add_argument('name', help='e.g. 0008-Do-something')
+  add_parser.add_argument('files', nargs='+', metavar='FILE',
+                          help='path relative to chromium/src')
+  add_parser.add_argument('-m', '--message', help='description of the patch')
+  add_parser.set_defaults(func=add)
+
+  args = parser.parse_args()
+  if not os.path.isdir(os.path.join(SRC_DIR, '.git')):
+    print('No Chromium checkout at %s; run tools/setup.sh.' % SRC_DIR,
+          file=sys.stderr)
+    return 1
+  try:
+    return args.func(args) or 0
+  except PatchError as e:
+    print(e, file=sys.stderr)
+    return 1
+
+
+if __name__ == '__main__':
+  sys.exit(main())
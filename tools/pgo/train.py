@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+# Copyright 2024 The Safe Deal Authors
+# Use of this source code is governed by the Apache License, Version 2.0 that
+# can be found in the LICENSE file.
+"""Collects a PGO profile with an instrumented chrome.
+
+Starts out/PGOInstrument/chrome once per page of training_urls.txt, so every
+run also covers browser and Safe Deal extension startup, lets the page load
+and settle, and shuts the browser down cleanly so that every process writes
+its .profraw file. The files are merged into one .profdata with the
+llvm-profdata of the Chromium toolchain.
+
+Run through `tools/build.sh --pgo-train`, which builds the instrumented
+binary first. The first run uses a fresh profile directory and the others
+reuse it, so both cold and warm starts are represented.
+"""
+
+import argparse
+import glob
+import os
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_URLS = os.path.join(SCRIPT_DIR, 'training_urls.txt')
+DEFAULT_LLVM_PROFDATA = os.path.join('third_party', 'llvm-build',
+                                     'Release+Asserts', 'bin', 'llvm-profdata')
+SHUTDOWN_TIMEOUT_SECONDS = 60
+
+
+def read_urls(path):
+  with open(path) as f:
+    return [
+        line.strip() for line in f
+        if line.strip() and not line.lstrip().startswith('#')
+    ]
+
+
+def run_page(chrome, url, user_data_dir, profile_dir, seconds, headless):
+  command = [
+      chrome,
+      '--user-data-dir=' + user_data_dir,
+      '--no-first-run',
+      '--no-default-browser-check',
+      '--disable-background-networking',
+      # Sandboxed processes cannot write their profiles.
+      '--no-sandbox',
+  ]
+  if headless:
+    command.append('--ozone-platform=headless')
+  command.append(url)
+
+  env = dict(os.environ)
+  # %m keeps one file per binary signature and merges runs into it; %p keeps
+  # concurrent processes apart.
+  env['LLVM_PROFILE_FILE'] = os.path.join(profile_dir, 'chrome-%4m-%p.profraw')
+  process = subprocess.Popen(command, env=env)
+  try:
+    time.sleep(seconds)
+  finally:
+    # SIGTERM starts a normal shutdown, which writes the profiles; a kill
+    # would lose them.
+    process.send_signal(signal.SIGTERM)
+    try:
+      process.wait(timeout=SHUTDOWN_TIMEOUT_SECONDS)
+    except subprocess.TimeoutExpired:
+      process.kill()
+      print('Warning: %s did not shut down, its profile is lost' % url)
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+  parser.add_argument('--chrome', required=True, help='instrumented binary')
+  parser.add_argument('--output', required=True, help='.profdata to write')
+  parser.add_argument('--urls', default=DEFAULT_URLS)
+  parser.add_argument('--seconds-per-page',
+                      type=int,
+                      default=20,
+                      help='time to load and settle each page')
+  parser.add_argument('--llvm-profdata', default=DEFAULT_LLVM_PROFDATA)
+  parser.add_argument('--headless',
+                      action='store_true',
+                      help='run without a display, e.g. on a build bot')
+  args = parser.parse_args()
+
+  if not os.path.exists(args.llvm_profdata):
+    sys.exit('llvm-profdata not found at %s; run from chromium/src' %
+             args.llvm_profdata)
+  urls = read_urls(args.urls)
+  if not urls:
+    sys.exit('No URLs in %s' % args.urls)
+
+  with tempfile.TemporaryDirectory(prefix='safe_deal_pgo_') as work_dir:
+    user_data_dir = os.path.join(work_dir, 'user-data')
+    profile_dir = os.path.join(work_dir, 'profraw')
+    os.makedirs(profile_dir)
+    for index, url in enumerate(urls):
+      print('[%d/%d] %s' % (index + 1, len(urls), url))
+      run_page(args.chrome, url, user_data_dir, profile_dir,
+               args.seconds_per_page, args.headless)
+
+    profiles = glob.glob(os.path.join(profile_dir, '*.profraw'))
+    if not profiles:
+      sys.exit('No profiles were written; is %s instrumented?' % args.chrome)
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    subprocess.run([args.llvm_profdata, 'merge', '-o', args.output] + profiles,
+                   check=True)
+  print('Wrote %s from %d profiles' % (args.output, len(profiles)))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
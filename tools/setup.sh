@@ -8,6 +8,19 @@ set -u
 
 # Ensure script is executed from the tools directory
 cd "$(dirname "$0")"
+TOOLS_DIR="$(pwd)"
+
+# --parallel-sync, or SAFE_DEAL_PARALLEL_SYNC=1 on CI, syncs with
+# sync_source.mjs: parallel jobs, a git cache shared between checkouts,
+# retries, and resuming where an interrupted sync stopped.
+PARALLEL_SYNC="${SAFE_DEAL_PARALLEL_SYNC:-0}"
+for arg in "$@"; do
+    case "$arg" in
+        --parallel-sync) PARALLEL_SYNC=1 ;;
+        *) echo "Usage: $0 [--parallel-sync]"; exit 1 ;;
+    esac
+done
+SYNC_ARGS=()
 
 # ANSI color codes
 RED='\033[0;31m'
@@ -46,9 +59,9 @@ echo -e "${NC}"
 # Install necessary dependencies
 log "Installing essential dependencies..."
 if [[ "$OSTYPE" == "darwin"* ]]; then
-    brew install python3 git cmake ninja || error "Failed to install dependencies"
+    brew install python3 git cmake ninja rsync || error "Failed to install dependencies"
 elif [[ "$OSTYPE" == "linux-gnu"* ]]; then
-    sudo apt-get update && sudo apt-get install -y python3 git cmake ninja-build || error "Failed to install dependencies"
+    sudo apt-get update && sudo apt-get install -y python3 git cmake ninja-build rsync || error "Failed to install dependencies"
 else
     error "Unsupported operating system"
 fi
@@ -66,6 +79,13 @@ fi
 # Add depot_tools to PATH
 export PATH="$PATH:$(pwd)/../depot_tools"
 
+# The parallel sync runs on Node. Scripts are skipped since the postinstall
+# script is this one.
+if [ "$PARALLEL_SYNC" = 1 ] && [ ! -d "../node_modules/cli-progress" ]; then
+    log "Installing Node dependencies for the parallel sync..."
+    (cd .. && yarn install --frozen-lockfile --ignore-scripts) || error "Failed to install Node dependencies"
+fi
+
 # Function to clone Chromium repository
 clone_chromium() {
     log "Cloning Chromium repository..."
@@ -85,14 +105,23 @@ if [ -d "../chromium/src" ]; then
     echo
     if [[ $REPLY =~ ^[Yy]$ ]]; then
         log "Updating Chromium source code..."
+        python3 "$TOOLS_DIR/patches.py" reset || error "Failed to restore the patched files"
         cd ../chromium/src
         git checkout main
-        git pull origin main || error "Failed to update Chromium source code"
+        if [ "$PARALLEL_SYNC" = 1 ]; then
+            # Pulled with retries along with the sync.
+            SYNC_ARGS+=(--update)
+        else
+            git pull origin main || error "Failed to update Chromium source code"
+        fi
         cd - > /dev/null
         success "Chromium source code updated successfully."
     else
         log "Skipping Chromium source code update."
     fi
+elif [ "$PARALLEL_SYNC" = 1 ]; then
+    # sync_source.mjs clones src itself, resumably.
+    mkdir -p ../chromium
 else
     clone_chromium
 fi
@@ -119,8 +148,13 @@ for dir in "${PROBLEMATIC_DIRS[@]}"; do
 done
 
 # Sync dependencies
-log "Running gclient sync..."
-gclient sync --with_branch_heads --with_tags --no-history --nohooks || error "Failed to sync dependencies"
+if [ "$PARALLEL_SYNC" = 1 ]; then
+    log "Running parallel sync..."
+    node "$TOOLS_DIR/sync_source.mjs" --nohooks ${SYNC_ARGS[@]+"${SYNC_ARGS[@]}"} || error "Failed to sync dependencies"
+else
+    log "Running gclient sync..."
+    gclient sync --with_branch_heads --with_tags --no-history --nohooks || error "Failed to sync dependencies"
+fi
 
 # Try to apply stashed changes if any
 for dir in "${PROBLEMATIC_DIRS[@]}"; do
@@ -150,10 +184,22 @@ log "Running hooks..."
 gclient runhooks || error "Failed to run hooks"
 success "Hooks completed successfully."
 
+# Apply the Safe Deal patches to Chromium
+log "Applying Chromium patches..."
+python3 "$TOOLS_DIR/patches.py" apply || error "Failed to apply the patches; see above"
+success "Patches applied successfully."
+
+# The patches make Chromium's BUILD files depend on //safe_deal, so the Safe
+# Deal sources must be in the checkout before gn reads them. Same as
+# tools/build.sh.
+log "Syncing Safe Deal sources..."
+rsync -a --checksum "$TOOLS_DIR/../src/" "$TOOLS_DIR/../chromium/src/" || error "Failed to sync the Safe Deal sources"
+success "Safe Deal sources synced successfully."
+
 # Generate build files
 log "Generating build files..."
 cd src
-gn gen out/Default --args='is_debug=false is_component_build=false use_jumbo_build=true symbol_level=0 blink_symbol_level=0 enable_nacl=false' || error "Failed to generate build files"
+gn gen out/Default --args='is_debug=false is_component_build=false symbol_level=0 blink_symbol_level=0 enable_nacl=false' || error "Failed to generate build files"
 success "Build files generated successfully."
 
 # Display completion message
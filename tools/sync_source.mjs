@@ -0,0 +1,282 @@
+// Copyright 2024 The Safe Deal Authors
+// Use of this source code is governed by the Apache License, Version 2.0 that
+// can be found in the LICENSE file.
+
+// Checks out or updates chromium/ with parallel, resumable syncs:
+//
+//   node tools/sync_source.mjs [--update] [--nohooks] [--jobs=N] [--retries=N]
+//
+// gclient syncs --jobs dependencies at once, by default one per core, and
+// clones them from a git cache shared by every checkout on the machine
+// ($GIT_CACHE_PATH, by default ~/.cache/safe-deal-browser/git-cache), so a
+// second checkout or a CI runner with a warm cache fetches only new objects.
+//
+// Every step can be interrupted and run again. The checkout is described to
+// gclient up front instead of through `fetch`, so an interrupted first sync
+// resumes with `gclient sync` like any later one: the cache keeps what was
+// downloaded and dependencies already at their revision are skipped. A src
+// checkout whose initial clone was cut off is cloned again from the cache.
+// Failed syncs, typically network errors, are retried with backoff.
+//
+// With --update, src is first pulled from origin/main, with the files the
+// Safe Deal patches change restored for the pull. Hooks run after the sync
+// unless --nohooks is given, and the patches are applied last. gclient's output goes to
+// chromium/sync_progress.log; the terminal shows a progress bar.
+
+import { spawn, spawnSync } from 'node:child_process';
+import { appendFileSync, existsSync, mkdirSync, readFileSync, rmSync, writeFileSync } from 'node:fs';
+import { availableParallelism, homedir } from 'node:os';
+import path from 'node:path';
+import { fileURLToPath } from 'node:url';
+import { parseArgs } from 'node:util';
+
+import cliProgress from 'cli-progress';
+import ora from 'ora';
+
+const PROJECT_ROOT = path.resolve(path.dirname(fileURLToPath(import.meta.url)), '..');
+const CHROMIUM_DIR = path.join(PROJECT_ROOT, 'chromium');
+const SRC_DIR = path.join(CHROMIUM_DIR, 'src');
+const LOG_FILE = path.join(CHROMIUM_DIR, 'sync_progress.log');
+const PATCHES_SCRIPT = path.join(PROJECT_ROOT, 'tools', 'patches.py');
+
+const CHROMIUM_URL = 'https://chromium.googlesource.com/chromium/src.git';
+
+// Syncing is bound by the network and the disk more than by the CPU, but
+// past a few dozen jobs the git servers throttle.
+const MIN_JOBS = 4;
+const MAX_JOBS = 32;
+
+const FIRST_RETRY_DELAY_MS = 15 * 1000;
+const MAX_RETRY_DELAY_MS = 5 * 60 * 1000;
+
+// Lines kept to show why a command failed.
+const TAIL_LINES = 20;
+
+// gclient reports the sync as "Syncing projects:  42% (123/290)".
+const SYNC_PROGRESS = /Syncing projects:\s+\d+% \((\d+)\/(\d+)\)/;
+
+function defaultCachePath() {
+  const cacheHome = process.env.XDG_CACHE_HOME || path.join(homedir(), '.cache');
+  return path.join(cacheHome, 'safe-deal-browser', 'git-cache');
+}
+
+function defaultJobs() {
+  return Math.min(Math.max(availableParallelism(), MIN_JOBS), MAX_JOBS);
+}
+
+function sleep(ms) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+function log(message) {
+  appendFileSync(LOG_FILE, `\n=== ${new Date().toISOString()} ${message}\n`);
+}
+
+// Runs |command| in |cwd| with its output appended to the log, calling
+// |onLine| with every line and progress update. Rejects with the last lines
+// of output if it fails.
+function run(command, args, { cwd, env, onLine = () => {} }) {
+  log(`${command} ${args.join(' ')}`);
+  return new Promise((resolve, reject) => {
+    const child = spawn(command, args, { cwd, env, stdio: ['ignore', 'pipe', 'pipe'] });
+    const tail = [];
+    let partial = '';
+    const onData = (data) => {
+      const text = data.toString();
+      appendFileSync(LOG_FILE, text);
+      // Progress updates end in \r rather than \n.
+      const lines = (partial + text).split(/[\r\n]/);
+      partial = lines.pop();
+      for (const line of lines.filter(Boolean)) {
+        tail.push(line);
+        if (tail.length > TAIL_LINES) {
+          tail.shift();
+        }
+        onLine(line);
+      }
+    };
+    child.stdout.on('data', onData);
+    child.stderr.on('data', onData);
+    child.once('error', reject);
+    child.once('close', (code, signal) => {
+      if (code === 0) {
+        resolve();
+        return;
+      }
+      reject(new Error(`${command} ${args[0]} failed (${signal ?? `exit code ${code}`}):\n` +
+        tail.map((line) => `    ${line}`).join('\n')));
+    });
+  });
+}
+
+// Runs |step| until it succeeds or |retries| retries failed, waiting longer
+// after each failure.
+async function withRetries(name, retries, step) {
+  for (let attempt = 0; ; ++attempt) {
+    try {
+      return await step();
+    } catch (error) {
+      if (attempt >= retries) {
+        throw error;
+      }
+      const delayMs = Math.min(FIRST_RETRY_DELAY_MS * 2 ** attempt, MAX_RETRY_DELAY_MS);
+      console.warn(`${name} failed, retrying in ${delayMs / 1000} s (${attempt + 1}/${retries}).`);
+      console.warn(error.message);
+      await sleep(delayMs);
+    }
+  }
+}
+
+// Describes the checkout the way `fetch chromium` does, plus the cache.
+function writeGclientConfig(cachePath) {
+  const file = path.join(CHROMIUM_DIR, '.gclient');
+  if (!existsSync(file)) {
+    writeFileSync(file, [
+      'solutions = [',
+      '  {',
+      '    "name": "src",',
+      `    "url": "${CHROMIUM_URL}",`,
+      '    "managed": False,',
+      '    "custom_deps": {},',
+      '    "custom_vars": {},',
+      '  },',
+      ']',
+      `cache_dir = ${JSON.stringify(cachePath)}`,
+      '',
+    ].join('\n'));
+    return;
+  }
+  // Checkouts made by `fetch` before have no cache yet. .gclient is Python,
+  // so a later assignment wins.
+  if (!/^cache_dir\s*=/m.test(readFileSync(file, 'utf8'))) {
+    appendFileSync(file, `cache_dir = ${JSON.stringify(cachePath)}\n`);
+  }
+}
+
+// Removes a src checkout whose initial clone was interrupted, which gclient
+// cannot sync. The objects it had fetched are in the cache.
+function removeBrokenCheckout() {
+  if (!existsSync(SRC_DIR)) {
+    return;
+  }
+  const head = spawnSync('git', ['rev-parse', '--verify', '--quiet', 'HEAD'], { cwd: SRC_DIR });
+  if (head.status !== 0) {
+    console.warn(`${SRC_DIR} has no commit checked out; cloning it again from the cache.`);
+    rmSync(SRC_DIR, { recursive: true, force: true });
+  }
+}
+
+async function withSpinner(text, step) {
+  const spinner = ora({ text, isEnabled: process.stderr.isTTY }).start();
+  if (!process.stderr.isTTY) {
+    console.log(`${text}...`);
+  }
+  try {
+    await step((line) => {
+      spinner.text = `${text}: ${line.slice(0, 60)}`;
+    });
+    spinner.succeed(text);
+  } catch (error) {
+    spinner.fail(text);
+    throw error;
+  }
+}
+
+async function gclientSync(options, env) {
+  const args = ['sync', '--with_branch_heads', '--with_tags', '--no-history', `--jobs=${options.jobs}`, '--nohooks'];
+  const bar = new cliProgress.SingleBar(
+    {
+      format: 'Syncing dependencies |{bar}| {percentage}% | {value}/{total} | ETA {eta_formatted}',
+      noTTYOutput: true,
+      notTTYSchedule: 30 * 1000,
+      hideCursor: true,
+    },
+    cliProgress.Presets.shades_classic,
+  );
+  let started = false;
+  const spinner = ora({ text: 'Resolving dependencies', isEnabled: process.stderr.isTTY }).start();
+  try {
+    await run('gclient', args, {
+      cwd: CHROMIUM_DIR,
+      env,
+      onLine: (line) => {
+        const match = SYNC_PROGRESS.exec(line);
+        if (!match) {
+          return;
+        }
+        const [done, total] = [Number(match[1]), Number(match[2])];
+        if (!started) {
+          spinner.stop();
+          bar.start(total, done);
+          started = true;
+        }
+        // The total grows as DEPS of dependencies are read.
+        bar.setTotal(total);
+        bar.update(done);
+      },
+    });
+  } finally {
+    spinner.stop();
+    if (started) {
+      bar.stop();
+    }
+  }
+}
+
+async function main() {
+  const { values } = parseArgs({
+    options: {
+      update: { type: 'boolean', default: false },
+      nohooks: { type: 'boolean', default: false },
+      jobs: { type: 'string', default: String(defaultJobs()) },
+      retries: { type: 'string', default: '5' },
+      'cache-dir': { type: 'string', default: process.env.GIT_CACHE_PATH || defaultCachePath() },
+    },
+  });
+  const options = {
+    update: values.update,
+    nohooks: values.nohooks,
+    jobs: Number(values.jobs),
+    retries: Number(values.retries),
+    cachePath: path.resolve(values['cache-dir']),
+  };
+
+  mkdirSync(CHROMIUM_DIR, { recursive: true });
+  mkdirSync(options.cachePath, { recursive: true });
+  const depotTools = path.join(PROJECT_ROOT, 'depot_tools');
+  const env = {
+    ...process.env,
+    PATH: existsSync(depotTools) ? `${depotTools}${path.delimiter}${process.env.PATH}` : process.env.PATH,
+    GIT_CACHE_PATH: options.cachePath,
+  };
+  console.log(`Syncing with ${options.jobs} jobs, git cache in ${options.cachePath}.`);
+  console.log(`Full output in ${LOG_FILE}.`);
+
+  writeGclientConfig(options.cachePath);
+  removeBrokenCheckout();
+
+  if (options.update && existsSync(SRC_DIR)) {
+    await withSpinner('Restoring patched files', (onLine) =>
+      run('python3', [PATCHES_SCRIPT, 'reset'], { cwd: PROJECT_ROOT, env, onLine }));
+    await withRetries('git pull', options.retries, () =>
+      withSpinner('Pulling chromium/src from origin/main', (onLine) =>
+        run('git', ['pull', '--progress', 'origin', 'main'], { cwd: SRC_DIR, env, onLine })));
+  }
+
+  const start = Date.now();
+  await withRetries('gclient sync', options.retries, () => gclientSync(options, env));
+  console.log(`Dependencies synced in ${((Date.now() - start) / 60000).toFixed(1)} min.`);
+
+  if (!options.nohooks) {
+    await withRetries('gclient runhooks', options.retries, () =>
+      withSpinner('Running hooks', (onLine) => run('gclient', ['runhooks'], { cwd: CHROMIUM_DIR, env, onLine })));
+  }
+
+  await withSpinner('Applying Chromium patches', (onLine) =>
+    run('python3', [PATCHES_SCRIPT, 'apply'], { cwd: PROJECT_ROOT, env, onLine }));
+}
+
+main().catch((error) => {
+  console.error(error.message);
+  process.exit(1);
+});
@@ -5,12 +5,39 @@ set -e
 SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
 PROJECT_ROOT="$SCRIPT_DIR/.."
 
+# --parallel-sync, or SAFE_DEAL_PARALLEL_SYNC=1 on CI, pulls and syncs with
+# sync_source.mjs: parallel jobs, a git cache shared between checkouts,
+# retries, and resuming where an interrupted update stopped.
+PARALLEL_SYNC="${SAFE_DEAL_PARALLEL_SYNC:-0}"
+for arg in "$@"; do
+    case "$arg" in
+        --parallel-sync) PARALLEL_SYNC=1 ;;
+        *) echo "Usage: $0 [--parallel-sync]"; exit 1 ;;
+    esac
+done
+
+if [ "$PARALLEL_SYNC" = 1 ]; then
+    if [ ! -d "$PROJECT_ROOT/node_modules/cli-progress" ]; then
+        (cd "$PROJECT_ROOT" && yarn install --frozen-lockfile --ignore-scripts)
+    fi
+    node "$SCRIPT_DIR/sync_source.mjs" --update
+    echo "Update completed successfully!"
+    exit 0
+fi
+
 cd "$PROJECT_ROOT/chromium/src"
 
+# The patched files are restored for the pull and patched again after it.
+echo "Restoring patched files..."
+python3 "$SCRIPT_DIR/patches.py" reset
+
 echo "Updating Chromium source code..."
 git pull origin main
 
 echo "Syncing Chromium dependencies..."
 gclient sync
 
+echo "Applying Chromium patches..."
+python3 "$SCRIPT_DIR/patches.py" apply
+
 echo "Update completed successfully!"